@@ -19,6 +19,9 @@
 
 #include "app/db/database_factory.h"
 
+#include "app/expdata/experiment_archive.h"
+#include "app/expdata/experiment_record_index.h"
+
 #if !defined(IDI_ICON_APP)
 #define IDI_ICON_APP 101
 #endif
@@ -82,10 +85,15 @@ Application::Application(HANDLE hinst) : main_window_(nullptr) {
   }
   anx::db::DatabaseFactory::Instance();
   anx::device::DeviceComFactory::Instance();
+  /// the records are indexed in the background before the record dialog.
+  anx::expdata::ExperimentRecordIndex::Instance();
 }
 
 Application::~Application() {
   anx::device::DeviceComFactory::ReleaseInstance();
+  /// the archiver finishes the running job before the databases are closed.
+  anx::expdata::ExperimentArchiver::ReleaseInstance();
+  anx::expdata::ExperimentRecordIndex::ReleaseInstance();
   anx::db::DatabaseFactory::ReleaseInstance();
   ::CoUninitialize();
 }
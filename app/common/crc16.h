@@ -12,6 +12,7 @@
 #ifndef APP_COMMON_CRC16_H_
 #define APP_COMMON_CRC16_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace anx {
@@ -26,6 +27,86 @@ namespace common {
 
 uint16_t crc16(const uint8_t* data, uint32_t length);
 
+/// @brief the initial value of the crc16 modbus
+const uint16_t kCrc16ModbusInit = 0xFFFF;
+
+/// @brief the reflected polynomial 0x8005 of the crc16 modbus
+const uint16_t kCrc16ModbusPoly = 0xA001;
+
+/// @brief Update the crc16 modbus byte by byte with the 256 entries table
+/// @param crc the crc of the previous data, kCrc16ModbusInit at start
+/// @return the crc of the previous data and the data
+uint16_t Crc16ModbusBytewise(uint16_t crc, const uint8_t* data, size_t length);
+
+/// @brief Update the crc16 modbus eight bytes a step with the 8 x 256
+/// entries tables
+/// @param crc the crc of the previous data, kCrc16ModbusInit at start
+/// @return the crc of the previous data and the data
+uint16_t Crc16ModbusSlicing8(uint16_t crc, const uint8_t* data, size_t length);
+
+/// @brief Update the crc16 modbus with the implementation chosen by the
+/// length, the short frames go byte by byte and the long blocks go by
+/// slicing by 8.
+/// @param crc the crc of the previous data, kCrc16ModbusInit at start
+/// @return the crc of the previous data and the data
+uint16_t Crc16ModbusUpdate(uint16_t crc, const uint8_t* data, size_t length);
+
+namespace internal {
+constexpr uint16_t Crc16ModbusBits(uint16_t crc, int32_t bits) {
+  return bits == 0
+             ? crc
+             : Crc16ModbusBits(
+                   static_cast<uint16_t>((crc & 1)
+                                             ? (crc >> 1) ^ kCrc16ModbusPoly
+                                             : (crc >> 1)),
+                   bits - 1);
+}
+}  // namespace internal
+
+/// @brief the crc16 modbus at compile time, e.g. the crc of the constant
+/// command frames. bitwise and recursive, don't use it at run time.
+/// @param crc the crc of the previous data, kCrc16ModbusInit at start
+constexpr uint16_t Crc16ModbusConstexpr(const uint8_t* data,
+                                        size_t length,
+                                        uint16_t crc = kCrc16ModbusInit) {
+  return length == 0
+             ? crc
+             : Crc16ModbusConstexpr(
+                   data + 1, length - 1,
+                   internal::Crc16ModbusBits(
+                       static_cast<uint16_t>(crc ^ data[0]), 8));
+}
+
+/// @brief incremental crc16 modbus, the bytes are checksummed as they
+/// arrive, e.g. by the frame parser.
+/// @note the crc is sent low byte first in the modbus rtu frame.
+class Crc16Modbus {
+ public:
+  Crc16Modbus() : crc_(kCrc16ModbusInit) {}
+
+  /// @brief Reset to the initial value
+  void Reset() { crc_ = kCrc16ModbusInit; }
+
+  /// @brief Update the crc with the data
+  Crc16Modbus& Update(const uint8_t* data, size_t length) {
+    crc_ = Crc16ModbusUpdate(crc_, data, length);
+    return *this;
+  }
+
+  /// @brief Update the crc with one byte
+  Crc16Modbus& Update(uint8_t byte) {
+    crc_ = Crc16ModbusBytewise(crc_, &byte, 1);
+    return *this;
+  }
+
+  /// @brief Get the crc of the data updated, the state is kept so more data
+  /// can follow.
+  uint16_t Finalize() const { return crc_; }
+
+ private:
+  uint16_t crc_;
+};
+
 }  // namespace common
 }  // namespace anx
 
@@ -0,0 +1,102 @@
+/**
+ * @file latest_value.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the latest value of one writer for many readers without the lock,
+ * the readers get a consistent copy of the value by the sequence lock.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_COMMON_LATEST_VALUE_H_
+#define APP_COMMON_LATEST_VALUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+
+namespace anx {
+namespace common {
+
+////////////////////////////////////////////////////////////
+// clz LatestValue
+/// @brief the writer bumps the sequence to odd, writes the words of the value
+/// and bumps the sequence to even. the reader copies the words and retries if
+/// the sequence was odd or changed. the words are atomic so the copy racing
+/// the writer is defined, the retry drops it. e.g. the sampling thread stores
+/// the latest sample and the window reads it on the refresh.
+/// @note Store is called by one writer at a time, Load by any threads.
+template <typename T>
+class LatestValue {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "the value is copied by the words");
+
+ public:
+  LatestValue() : sequence_(0) {
+    for (size_t i = 0; i < kWords; i++) {
+      words_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  LatestValue(const LatestValue&) = delete;
+  LatestValue& operator=(const LatestValue&) = delete;
+
+ public:
+  /// @brief Store the value, the readers are not blocked
+  void Store(const T& value) {
+    uint64_t words[kWords] = {0};
+    memcpy(words, &value, sizeof(T));
+    uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) {
+      words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  /// @brief Load the latest value
+  /// @param value the copy of the value
+  /// @return true if any value is stored
+  bool Load(T* value) const {
+    uint64_t words[kWords];
+    uint64_t sequence = 0;
+    for (;;) {
+      sequence = sequence_.load(std::memory_order_acquire);
+      if ((sequence & 1) != 0) {
+        continue;
+      }
+      for (size_t i = 0; i < kWords; i++) {
+        words[i] = words_[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence) {
+        break;
+      }
+    }
+    memcpy(value, words, sizeof(T));
+    return sequence != 0;
+  }
+
+  /// @brief Get the count of the values stored
+  uint64_t version() const {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  static const size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) /
+                               sizeof(uint64_t);
+  /// @brief odd while the writer writes
+  std::atomic<uint64_t> sequence_;
+  std::atomic<uint64_t> words_[kWords];
+};
+
+}  // namespace common
+}  // namespace anx
+
+#endif  // APP_COMMON_LATEST_VALUE_H_
@@ -0,0 +1,142 @@
+/**
+ * @file latest_value_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief latest value unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/common/latest_value.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "app/common/thread.h"
+
+namespace anx {
+namespace common {
+namespace {
+/// @brief the fields are the same in one value, a torn copy has them differ
+struct Readout {
+  int64_t time_us;
+  double freq;
+  double load;
+  double position;
+  uint32_t status;
+};
+
+Readout MakeReadout(int64_t n) {
+  Readout readout;
+  readout.time_us = n;
+  readout.freq = static_cast<double>(n);
+  readout.load = static_cast<double>(n) * 2;
+  readout.position = static_cast<double>(n) * 3;
+  readout.status = static_cast<uint32_t>(n);
+  return readout;
+}
+
+bool Consistent(const Readout& readout) {
+  double n = static_cast<double>(readout.time_us);
+  return readout.freq == n && readout.load == n * 2 &&
+         readout.position == n * 3 &&
+         readout.status == static_cast<uint32_t>(readout.time_us);
+}
+
+class Writer : public Runnable {
+ public:
+  Writer(LatestValue<Readout>* value, int64_t count)
+      : value_(value), count_(count) {}
+  void run() override {
+    for (int64_t n = 1; n <= count_; n++) {
+      value_->Store(MakeReadout(n));
+    }
+  }
+
+ private:
+  LatestValue<Readout>* value_;
+  int64_t count_;
+};
+
+class Reader : public Runnable {
+ public:
+  Reader(LatestValue<Readout>* value, int64_t last)
+      : value_(value), last_(last), torn_(0), backward_(0) {}
+  void run() override {
+    int64_t previous = 0;
+    Readout readout;
+    do {
+      if (!value_->Load(&readout)) {
+        continue;
+      }
+      if (!Consistent(readout)) {
+        torn_++;
+      }
+      if (readout.time_us < previous) {
+        backward_++;
+      }
+      previous = readout.time_us;
+    } while (previous < last_);
+  }
+  int64_t torn() const { return torn_; }
+  int64_t backward() const { return backward_; }
+
+ private:
+  LatestValue<Readout>* value_;
+  int64_t last_;
+  int64_t torn_;
+  int64_t backward_;
+};
+}  // namespace
+
+TEST(LatestValueTest, EmptyUntilStored) {
+  LatestValue<Readout> value;
+  Readout readout;
+  EXPECT_FALSE(value.Load(&readout));
+  EXPECT_EQ(value.version(), 0u);
+  value.Store(MakeReadout(7));
+  ASSERT_TRUE(value.Load(&readout));
+  EXPECT_TRUE(Consistent(readout));
+  EXPECT_EQ(readout.time_us, 7);
+  value.Store(MakeReadout(8));
+  ASSERT_TRUE(value.Load(&readout));
+  EXPECT_EQ(readout.time_us, 8);
+  EXPECT_EQ(value.version(), 2u);
+}
+
+TEST(LatestValueTest, OddSizedValue) {
+  LatestValue<char[13]> value;
+  char text[13] = "hello, world";
+  value.Store(text);
+  char copy[13] = {0};
+  ASSERT_TRUE(value.Load(&copy));
+  EXPECT_STREQ(copy, "hello, world");
+}
+
+TEST(LatestValueTest, ReadersNeverSeeTornValues) {
+  const int64_t kCount = 200000;
+  LatestValue<Readout> value;
+  Writer writer(&value, kCount);
+  Reader reader1(&value, kCount);
+  Reader reader2(&value, kCount);
+  Thread reader1_thread(&reader1);
+  Thread reader2_thread(&reader2);
+  Thread writer_thread(&writer);
+  reader1_thread.start();
+  reader2_thread.start();
+  writer_thread.start();
+  writer_thread.join();
+  reader1_thread.join();
+  reader2_thread.join();
+  EXPECT_EQ(reader1.torn(), 0);
+  EXPECT_EQ(reader2.torn(), 0);
+  EXPECT_EQ(reader1.backward(), 0);
+  EXPECT_EQ(reader2.backward(), 0);
+  EXPECT_EQ(value.version(), static_cast<uint64_t>(kCount));
+}
+
+}  // namespace common
+}  // namespace anx
@@ -42,6 +42,14 @@ void Mutex::lock() {
 #endif
 }
 
+bool Mutex::try_lock() {
+#if defined(_WIN32)
+  return TryEnterCriticalSection(&mutex_) != FALSE;
+#else
+  return pthread_mutex_trylock(&mutex_) == 0;
+#endif
+}
+
 void Mutex::unlock() {
 #if defined(_WIN32)
   LeaveCriticalSection(&mutex_);
@@ -98,7 +106,7 @@ bool Condition::wait(Mutex* mutex, unsigned int timeout) {
   }
 #else
   if (timeout <= 0) {
-    pthread_cond_wait(&cond_, &mutex->mutex_);
+    return pthread_cond_wait(&cond_, &mutex->mutex_) == 0;
   } else {
     struct timespec ts;
 #if USE_MONOTONIC_CLOCK
@@ -108,6 +116,10 @@ bool Condition::wait(Mutex* mutex, unsigned int timeout) {
 #endif
     ts.tv_sec += timeout / 1000;
     ts.tv_nsec += (timeout % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+      ts.tv_sec += 1;
+      ts.tv_nsec -= 1000000000;
+    }
     int ret = pthread_cond_timedwait(&cond_, &mutex->mutex_, &ts);
     if (ret == ETIMEDOUT) {
       return false;
@@ -176,11 +188,11 @@ void Thread::join() {
 void Thread::detach() {
 #if defined(_WIN32)
   CloseHandle(thread_);
+  thread_ = nullptr;
 #else
   pthread_detach(thread_);
+  thread_ = 0;
 #endif
-
-  thread_ = nullptr;
 }
 
 bool Thread::is_current_thread() {
@@ -31,6 +31,9 @@ class Mutex {
 
   friend class Condition;
   virtual void lock();
+  /// @brief Lock the mutex if it is free
+  /// @return true if locked
+  virtual bool try_lock();
   virtual void unlock();
 
  private:
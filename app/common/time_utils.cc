@@ -49,6 +49,23 @@ int64_t GetCurrentTimeSeconds() {
   return static_cast<int64_t>(GetCurrentTimeMicros() / 1000000);
 }
 
+int64_t GetCurrentEpochMillis() {
+#if defined(_WIN32)
+  FILETIME fileTime;
+  GetSystemTimeAsFileTime(&fileTime);
+
+  ULARGE_INTEGER uli;
+  uli.LowPart = fileTime.dwLowDateTime;
+  uli.HighPart = fileTime.dwHighDateTime;
+
+  return static_cast<int64_t>((uli.QuadPart - 116444736000000000) / 10000);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
 void sleep_ms(int64_t ms) {
 #ifdef _WIN32
   Sleep((DWORD)ms);
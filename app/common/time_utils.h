@@ -26,6 +26,12 @@ int64_t GetCurrentTimeMillis();
 // get current time in seconds
 int64_t GetCurrentTimeSeconds();
 
+/// @brief get the wall clock time in milliseconds since the unix epoch.
+/// @note GetCurrentTimeMillis is the time since boot on windows, it starts
+/// again after a reboot. use this one for times stored across runs.
+/// @return the milliseconds since 1970-01-01 00:00:00 UTC
+int64_t GetCurrentEpochMillis();
+
 // sleep for milliseconds
 void sleep_ms(int64_t ms);
 
@@ -13,5 +13,27 @@
 #include "app/db/database.h"
 
 namespace anx {
-namespace db {}  // namespace db
+namespace db {
+
+DatabaseValue::DatabaseValue() : type_(kNull), integer_(0), real_(0.0) {}
+
+DatabaseValue::DatabaseValue(int32_t value)
+    : type_(kInteger), integer_(value), real_(0.0) {}
+
+DatabaseValue::DatabaseValue(int64_t value)
+    : type_(kInteger), integer_(value), real_(0.0) {}
+
+DatabaseValue::DatabaseValue(double value)
+    : type_(kReal), integer_(0), real_(value) {}
+
+DatabaseValue::DatabaseValue(const std::string& value)
+    : type_(kText), integer_(0), real_(0.0), text_(value) {}
+
+DatabaseValue::DatabaseValue(const char* value)
+    : type_(value != nullptr ? kText : kNull),
+      integer_(0),
+      real_(0.0),
+      text_(value != nullptr ? value : "") {}
+
+}  // namespace db
 }  // namespace anx
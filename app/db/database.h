@@ -13,6 +13,7 @@
 #ifndef APP_DB_DATABASE_H_
 #define APP_DB_DATABASE_H_
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -21,6 +22,25 @@
 namespace anx {
 namespace db {
 
+/// @brief value bound to a parameter of the prepared sql
+class DatabaseValue {
+ public:
+  enum Type { kNull = 0, kInteger, kReal, kText };
+
+  DatabaseValue();
+  DatabaseValue(int32_t value);             // NOLINT
+  DatabaseValue(int64_t value);             // NOLINT
+  DatabaseValue(double value);              // NOLINT
+  DatabaseValue(const std::string& value);  // NOLINT
+  DatabaseValue(const char* value);         // NOLINT
+
+ public:
+  Type type_;
+  int64_t integer_;
+  double real_;
+  std::string text_;
+};
+
 /// @brief sqlite3 database helper class
 class DatabaseInterface {
  public:
@@ -44,6 +64,25 @@ class DatabaseInterface {
   virtual bool Query(
       const std::string& sql,
       std::vector<std::map<std::string, std::string>>* result) = 0;
+
+  /// @brief Execute the sql with the parameters bound, the prepared
+  /// statement is cached by the sql
+  /// @param sql the sql with ? parameters
+  /// @param params the parameter values
+  /// @return true if execute success
+  virtual bool Execute(const std::string& sql,
+                       const std::vector<DatabaseValue>& params) = 0;
+
+  /// @brief Query the sql with the parameters bound, the prepared statement
+  /// is cached by the sql
+  /// @param sql the sql with ? parameters
+  /// @param params the parameter values
+  /// @param result the result
+  /// @return true if query success
+  virtual bool Query(
+      const std::string& sql,
+      const std::vector<DatabaseValue>& params,
+      std::vector<std::map<std::string, std::string>>* result) = 0;
 };
 }  // namespace db
 }  // namespace anx
@@ -0,0 +1,154 @@
+/**
+ * @file database_cursor.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief keyset pagination cursor for the exp data tables
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/db/database_cursor.h"
+
+#include <algorithm>
+#include <string>
+
+#include "app/common/logger.h"
+#include "app/db/database_helper.h"
+
+namespace anx {
+namespace db {
+
+DatabaseCursor::DatabaseCursor(const std::string& db_name,
+                               const std::string& table)
+    : db_name_(db_name), table_(table), first_id_(-1), last_id_(-1) {}
+
+DatabaseCursor::~DatabaseCursor() {}
+
+bool DatabaseCursor::NextPage(
+    int64_t after_id,
+    int32_t n,
+    std::vector<std::map<std::string, std::string>>* result) {
+  std::string sql_str = "SELECT * FROM ";
+  sql_str += table_;
+  sql_str += " WHERE id > ";
+  sql_str += std::to_string(after_id);
+  sql_str += " ORDER BY id ASC LIMIT ";
+  sql_str += std::to_string(n);
+  sql_str += ";";
+  return Query(sql_str, result);
+}
+
+bool DatabaseCursor::PrePage(
+    int64_t before_id,
+    int32_t n,
+    std::vector<std::map<std::string, std::string>>* result) {
+  /// @note scan backward from the key and restore the id order.
+  std::string sql_str = "SELECT * FROM (SELECT * FROM ";
+  sql_str += table_;
+  sql_str += " WHERE id < ";
+  sql_str += std::to_string(before_id);
+  sql_str += " ORDER BY id DESC LIMIT ";
+  sql_str += std::to_string(n);
+  sql_str += ") ORDER BY id ASC;";
+  return Query(sql_str, result);
+}
+
+bool DatabaseCursor::TailPage(
+    int32_t n,
+    std::vector<std::map<std::string, std::string>>* result) {
+  std::string sql_str = "SELECT * FROM (SELECT * FROM ";
+  sql_str += table_;
+  sql_str += " ORDER BY id DESC LIMIT ";
+  sql_str += std::to_string(n);
+  sql_str += ") ORDER BY id ASC;";
+  return Query(sql_str, result);
+}
+
+bool DatabaseCursor::SeekByTime(
+    double t,
+    int32_t n,
+    std::vector<std::map<std::string, std::string>>* result) {
+  int64_t id = IdOfTime(t);
+  if (id < 0) {
+    if (result != nullptr) {
+      result->clear();
+    }
+    first_id_ = last_id_ = -1;
+    return id == -1;
+  }
+  return NextPage(id - 1, n, result);
+}
+
+bool DatabaseCursor::SeekByCycle(
+    int64_t cycle,
+    int32_t n,
+    std::vector<std::map<std::string, std::string>>* result) {
+  std::string sql_str = "SELECT id FROM ";
+  sql_str += table_;
+  sql_str += " WHERE cycle >= ";
+  sql_str += std::to_string(cycle);
+  sql_str += " ORDER BY cycle ASC LIMIT 1;";
+  int64_t id = QueryId(sql_str);
+  if (id < 0) {
+    if (result != nullptr) {
+      result->clear();
+    }
+    first_id_ = last_id_ = -1;
+    return id == -1;
+  }
+  return NextPage(id - 1, n, result);
+}
+
+int64_t DatabaseCursor::IdOfTime(double t) {
+  /// @note the date index holds the rowid, the lookup doesn't touch the
+  /// table rows.
+  std::string sql_str = "SELECT id FROM ";
+  sql_str += table_;
+  sql_str += " WHERE date >= ";
+  sql_str += std::to_string(t);
+  sql_str += " ORDER BY date ASC LIMIT 1;";
+  return QueryId(sql_str);
+}
+
+int64_t DatabaseCursor::MaxId() {
+  std::string sql_str = "SELECT IFNULL(MAX(id), 0) AS id FROM ";
+  sql_str += table_;
+  sql_str += ";";
+  return QueryId(sql_str);
+}
+
+bool DatabaseCursor::Query(
+    const std::string& sql,
+    std::vector<std::map<std::string, std::string>>* result) {
+  if (result == nullptr) {
+    return false;
+  }
+  result->clear();
+  first_id_ = last_id_ = -1;
+  if (!helper::QueryDataBase(db_name_, table_, sql, result)) {
+    LOG_F(LG_ERROR) << "Failed to query: " << sql;
+    return false;
+  }
+  if (!result->empty()) {
+    first_id_ = std::stoll(result->front()["id"]);
+    last_id_ = std::stoll(result->back()["id"]);
+  }
+  return true;
+}
+
+int64_t DatabaseCursor::QueryId(const std::string& sql) {
+  std::vector<std::map<std::string, std::string>> result;
+  if (!helper::QueryDataBase(db_name_, table_, sql, &result)) {
+    LOG_F(LG_ERROR) << "Failed to query: " << sql;
+    return -2;
+  }
+  if (result.empty()) {
+    return -1;
+  }
+  return std::stoll(result[0]["id"]);
+}
+
+}  // namespace db
+}  // namespace anx
@@ -0,0 +1,112 @@
+/**
+ * @file database_cursor.h
+ * @author hhool (hhool@outlook.com)
+ * @brief keyset pagination cursor for the exp data tables
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DB_DATABASE_CURSOR_H_
+#define APP_DB_DATABASE_CURSOR_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace anx {
+namespace db {
+
+/// @brief keyset pagination cursor for the tables with the id primary key and
+/// date, cycle columns. every page is one range scan started from a key, the
+/// cost of a page doesn't depend on the page position or the table rows.
+class DatabaseCursor {
+ public:
+  /// @brief Constructor
+  /// @param db_name the database name, see helper::QueryDataBase
+  /// @param table the table name in the database
+  DatabaseCursor(const std::string& db_name, const std::string& table);
+
+  /// @brief Destructor
+  ~DatabaseCursor();
+
+ public:
+  /// @brief Get the page of rows after the id in id order
+  /// @param after_id the id before the first row of the page, 0 for the first
+  /// page
+  /// @param n the max row count of the page
+  /// @param result the rows of the page
+  /// @return true if success
+  bool NextPage(int64_t after_id,
+                int32_t n,
+                std::vector<std::map<std::string, std::string>>* result);
+
+  /// @brief Get the page of rows before the id in id order
+  /// @param before_id the id after the last row of the page
+  /// @param n the max row count of the page
+  /// @param result the rows of the page
+  /// @return true if success
+  bool PrePage(int64_t before_id,
+               int32_t n,
+               std::vector<std::map<std::string, std::string>>* result);
+
+  /// @brief Get the last page of rows in id order
+  /// @param n the max row count of the page
+  /// @param result the rows of the page
+  /// @return true if success
+  bool TailPage(int32_t n,
+                std::vector<std::map<std::string, std::string>>* result);
+
+  /// @brief Get the page of rows start from the time
+  /// @param t the time of the date column
+  /// @param n the max row count of the page
+  /// @param result the rows of the page, first row with date >= t
+  /// @return true if success
+  bool SeekByTime(double t,
+                  int32_t n,
+                  std::vector<std::map<std::string, std::string>>* result);
+
+  /// @brief Get the page of rows start from the cycle
+  /// @param cycle the cycle of the cycle column
+  /// @param n the max row count of the page
+  /// @param result the rows of the page, first row with cycle >= cycle
+  /// @return true if success
+  bool SeekByCycle(int64_t cycle,
+                   int32_t n,
+                   std::vector<std::map<std::string, std::string>>* result);
+
+  /// @brief Get the id of the first row with date >= t
+  /// @param t the time of the date column
+  /// @return the id, -1 if no row matched, -2 if failed
+  int64_t IdOfTime(double t);
+
+  /// @brief Get the max id of the table
+  /// @return the max id, 0 if the table is empty, -2 if failed
+  int64_t MaxId();
+
+  /// @brief Get the first id of the last page returned
+  int64_t first_id() const { return first_id_; }
+
+  /// @brief Get the last id of the last page returned, pass it to NextPage
+  /// for the next page
+  int64_t last_id() const { return last_id_; }
+
+ private:
+  bool Query(const std::string& sql,
+             std::vector<std::map<std::string, std::string>>* result);
+  int64_t QueryId(const std::string& sql);
+
+ private:
+  std::string db_name_;
+  std::string table_;
+  int64_t first_id_;
+  int64_t last_id_;
+};
+
+}  // namespace db
+}  // namespace anx
+
+#endif  // APP_DB_DATABASE_CURSOR_H_
@@ -23,6 +23,7 @@ namespace anx {
 namespace db {
 
 DatabaseFactory* DatabaseFactory::instance_ = nullptr;
+const int32_t DatabaseFactory::kDefaultReaderCount;
 
 DatabaseFactory* DatabaseFactory::Instance() {
   if (instance_ == nullptr) {
@@ -45,12 +46,19 @@ DatabaseFactory::~DatabaseFactory() {}
 
 std::shared_ptr<DatabaseInterface> DatabaseFactory::CreateOrGetDatabase(
     const std::string& db_name) {
+  return CreateOrGetDatabase(db_name, DatabaseOptions());
+}
+
+std::shared_ptr<DatabaseInterface> DatabaseFactory::CreateOrGetDatabase(
+    const std::string& db_name,
+    const DatabaseOptions& options) {
+  anx::common::AutoLock lock(&mutex_);
   auto iter = databases_.find(db_name);
   if (iter != databases_.end()) {
     return iter->second;
   }
 
-  auto db = std::make_shared<Database>();
+  auto db = std::make_shared<Database>(options);
   if (db->Open(db_name)) {
     databases_.insert(std::make_pair(db_name, db));
     return db;
@@ -59,19 +67,107 @@ std::shared_ptr<DatabaseInterface> DatabaseFactory::CreateOrGetDatabase(
   return nullptr;
 }
 
+std::shared_ptr<DatabasePool> DatabaseFactory::CreateOrGetDatabasePool(
+    const std::string& db_name,
+    int32_t reader_count) {
+  anx::common::AutoLock lock(&mutex_);
+  auto mirror_iter = mirrors_.find(db_name);
+  if (mirror_iter != mirrors_.end()) {
+    return mirror_iter->second->pool();
+  }
+  auto iter = pools_.find(db_name);
+  if (iter != pools_.end()) {
+    return iter->second;
+  }
+
+  auto pool =
+      std::make_shared<DatabasePool>(db_name, reader_count, DatabaseOptions());
+  if (pool->Open()) {
+    pools_.insert(std::make_pair(db_name, pool));
+    return pool;
+  }
+
+  return nullptr;
+}
+
+std::shared_ptr<DatabaseMirror> DatabaseFactory::CreateOrGetDatabaseMirror(
+    const std::string& db_name,
+    const DatabaseMirrorOptions& options) {
+  anx::common::AutoLock lock(&mutex_);
+  auto iter = mirrors_.find(db_name);
+  if (iter != mirrors_.end()) {
+    return iter->second;
+  }
+  /// @note the rows committed by the pool are in the file, the mirror loads
+  /// them and is the only writer of the file after.
+  auto pool_iter = pools_.find(db_name);
+  if (pool_iter != pools_.end()) {
+    pool_iter->second->Close();
+    pools_.erase(pool_iter);
+  }
+  auto mirror = std::make_shared<DatabaseMirror>(db_name, options);
+  if (mirror->Open()) {
+    mirrors_.insert(std::make_pair(db_name, mirror));
+    return mirror;
+  }
+
+  return nullptr;
+}
+
+std::shared_ptr<DatabaseMirror> DatabaseFactory::GetDatabaseMirror(
+    const std::string& db_name) {
+  anx::common::AutoLock lock(&mutex_);
+  auto iter = mirrors_.find(db_name);
+  if (iter != mirrors_.end()) {
+    return iter->second;
+  }
+  return nullptr;
+}
+
 void DatabaseFactory::CloseDatabase(const std::string& db_name) {
-  auto iter = databases_.find(db_name);
-  if (iter != databases_.end()) {
-    iter->second->Close();
-    databases_.erase(iter);
+  std::shared_ptr<DatabaseMirror> mirror;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    auto iter = databases_.find(db_name);
+    if (iter != databases_.end()) {
+      iter->second->Close();
+      databases_.erase(iter);
+    }
+    auto pool_iter = pools_.find(db_name);
+    if (pool_iter != pools_.end()) {
+      pool_iter->second->Close();
+      pools_.erase(pool_iter);
+    }
+    auto mirror_iter = mirrors_.find(db_name);
+    if (mirror_iter != mirrors_.end()) {
+      mirror = mirror_iter->second;
+      mirrors_.erase(mirror_iter);
+    }
+  }
+  /// the last backup is written out of the lock, the other databases are not
+  /// blocked by it.
+  if (mirror != nullptr) {
+    mirror->Close();
   }
 }
 
 void DatabaseFactory::CloseAllDatabase() {
-  for (auto& iter : databases_) {
+  std::map<std::string, std::shared_ptr<DatabaseMirror>> mirrors;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    for (auto& iter : databases_) {
+      iter.second->Close();
+    }
+    databases_.clear();
+    for (auto& iter : pools_) {
+      iter.second->Close();
+    }
+    pools_.clear();
+    mirrors.swap(mirrors_);
+  }
+  for (auto& iter : mirrors) {
     iter.second->Close();
   }
-  databases_.clear();
 }
 }  // namespace db
 }  // namespace anx
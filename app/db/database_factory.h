@@ -16,7 +16,11 @@
 #include <memory>
 #include <string>
 
+#include "app/common/thread.h"
 #include "app/db/database.h"
+#include "app/db/database_impl.h"
+#include "app/db/database_mirror.h"
+#include "app/db/database_pool.h"
 
 namespace anx {
 namespace db {
@@ -31,6 +35,8 @@ class DatabaseFactory {
   ~DatabaseFactory();
 
  public:
+  /// @note the instance is created by the application before the worker
+  /// threads start, the methods below are thread safe.
   static DatabaseFactory* Instance();
   static void ReleaseInstance();
 
@@ -47,16 +53,59 @@ class DatabaseFactory {
   std::shared_ptr<DatabaseInterface> CreateOrGetDatabase(
       const std::string& db_name);
 
-  /// @brief Close the database
+  /// @brief Create the database with the options
+  /// @param db_name the database name
+  /// @param options the options applied when the database is opened, ignored
+  /// if the database is already opened
+  /// @return the database
+  std::shared_ptr<DatabaseInterface> CreateOrGetDatabase(
+      const std::string& db_name,
+      const DatabaseOptions& options);
+
+  /// @brief Create the connection pool of the database, the pool is opened
+  /// on creation.
+  /// @param db_name the database name
+  /// @param reader_count the max reader connections of the pool
+  /// @return the pool, nullptr if failed
+  std::shared_ptr<DatabasePool> CreateOrGetDatabasePool(
+      const std::string& db_name,
+      int32_t reader_count = kDefaultReaderCount);
+
+  /// @brief Create the in-memory mirror of the database, the pool of the
+  /// database is closed and the pool of the memory is returned by
+  /// CreateOrGetDatabasePool until the database is closed.
+  /// @param db_name the database name
+  /// @param options the options of the backups, ignored if the database is
+  /// already mirrored
+  /// @return the mirror, nullptr if failed
+  std::shared_ptr<DatabaseMirror> CreateOrGetDatabaseMirror(
+      const std::string& db_name,
+      const DatabaseMirrorOptions& options);
+  /// @brief Get the in-memory mirror of the database
+  /// @param db_name the database name
+  /// @return the mirror, nullptr if the database is not mirrored
+  std::shared_ptr<DatabaseMirror> GetDatabaseMirror(const std::string& db_name);
+  /// @brief Close the database, the connection pool and the mirror of the
+  /// database, the mirror is backed up to the file before closed.
+
   /// @param db_name the database name
   void CloseDatabase(const std::string& db_name);
 
-  /// @brief Close all database
+  /// @brief Close all database and connection pools
   void CloseAllDatabase();
 
+  /// @brief the default reader connections of a pool
+  static const int32_t kDefaultReaderCount = 4;
+
  private:
+  /// @brief the mutex of the databases and the pools
+  anx::common::Mutex mutex_;
   /// @brief the databases
   std::map<std::string, std::shared_ptr<DatabaseInterface>> databases_;
+  /// @brief the connection pools
+  std::map<std::string, std::shared_ptr<DatabasePool>> pools_;
+  /// @brief the in-memory mirrors
+  std::map<std::string, std::shared_ptr<DatabaseMirror>> mirrors_;
 
   static DatabaseFactory* instance_;
 };
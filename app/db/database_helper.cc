@@ -11,13 +11,18 @@
 
 #include "app/db/database_helper.h"
 
+#include <algorithm>
 #include <cassert>
+#include <memory>
 #include <string>
 
 #include "app/common/file_utils.h"
 #include "app/common/logger.h"
 #include "app/common/module_utils.h"
+#include "app/common/thread.h"
 #include "app/db/database_factory.h"
+#include "app/db/database_mirror.h"
+#include "app/db/database_pool.h"
 
 namespace anx {
 namespace db {
@@ -34,6 +39,13 @@ const char* kTableExpDataList = "exp_data_list";
 const char* kTableSendData = "send_data";
 const char* kTableNotification = "notification";
 const char* kTableSendNotify = "send_notify";
+#if defined(_WIN32) || defined(_WIN64)
+const char* kExperimentDatabaseFolder = "db\\exp";
+#else
+const char* kExperimentDatabaseFolder = "db/exp";
+#endif
+const char* kCatalogDatabaseName = "catalog.db";
+const char* kTableExpCatalog = "exp_catalog";
 
 namespace sql {
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -50,12 +62,27 @@ const char* kInsertTableExpDataGraphSqlFormat =
     "%d, "
     "%f)";
 
+/// @brief parameters cycle, kHz, MPa, μm, state, date bound to the prepared
+/// statement
+const char* kInsertTableExpDataGraphSqlPrepared =
+    "INSERT INTO exp_data_graph (cycle, kHz, MPa, μm, state, date) VALUES (?, "
+    "?, ?, ?, ?, ?)";
+
 const char* kQueryTableExpDataGraphSqlByIdFormat =
     "SELECT * FROM exp_data_graph WHERE id >= %d AND id <= %d";
 
 const char* kQueryTableExpDataGraphSqlByTimeFormat =
     "SELECT * FROM exp_data_graph WHERE date >= %f AND date <= %f";
 
+/// @note every index holds the rowid, so the indexes on date and cycle cover
+/// the id lookup of the time range and cycle range queries.
+const char* kCreateIndexExpDataGraphDateSqlFormat =
+    "CREATE INDEX IF NOT EXISTS exp_data_graph_date ON exp_data_graph (date)";
+
+const char* kCreateIndexExpDataGraphCycleSqlFormat =
+    "CREATE INDEX IF NOT EXISTS exp_data_graph_cycle ON exp_data_graph "
+    "(cycle)";
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 /// @brief Create table exp_data_list sql format string for exp data record
 const char* kCreateTableExpDataListSqlFormat =
@@ -68,12 +95,24 @@ const char* kInsertTableExpDataListSqlFormat =
     "%f, %f, "
     "%f)";
 
+/// @brief parameters cycle, kHz, MPa, μm, date bound to the prepared
+/// statement
+const char* kInsertTableExpDataListSqlPrepared =
+    "INSERT INTO exp_data_list (cycle, kHz, MPa, μm, date) VALUES (?, ?, ?, "
+    "?, ?)";
+
 const char* kQueryTableExpDataListSqlByIdFormat =
     "SELECT * FROM exp_data_list WHERE id >= %d AND id <= %d";
 
 const char* kQueryTableExpDataListSqlByTimeFormat =
     "SELECT * FROM exp_data_list WHERE date >= %f AND date <= %f";
 
+const char* kCreateIndexExpDataListDateSqlFormat =
+    "CREATE INDEX IF NOT EXISTS exp_data_list_date ON exp_data_list (date)";
+
+const char* kCreateIndexExpDataListCycleSqlFormat =
+    "CREATE INDEX IF NOT EXISTS exp_data_list_cycle ON exp_data_list (cycle)";
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 /// @brief Create table static load sql format string for exp data record
 const char* kCreateTableSendDataSqlFormat =
@@ -118,8 +157,125 @@ const char* kQueryTableSendNotifySqlByIdFormat =
 
 const char* kQueryTableSendNotifySqlByTimeFormat =
     "SELECT * FROM send_notify WHERE date >= %f AND date <= %f";
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+/// @brief Create table exp_catalog sql format string for the experiment
+/// databases of one folder, db_name is the file name of the experiment
+/// database in the folder, start_time and end_time in milliseconds, state 0
+/// running, 1 finished.
+const char* kCreateTableExpCatalogSqlFormat =
+    "CREATE TABLE IF NOT EXISTS exp_catalog (id INTEGER PRIMARY KEY "
+    "AUTOINCREMENT, db_name TEXT UNIQUE, start_time INTEGER, end_time "
+    "INTEGER, state INTEGER)";
+
+const char* kQueryTableExpCatalogSqlFormat =
+    "SELECT * FROM exp_catalog ORDER BY start_time ASC";
 }  // namespace sql
 
+namespace {
+
+/// @brief the current experiment database name, empty if no experiment
+/// database is created.
+std::string current_experiment_db_name_;
+anx::common::Mutex current_experiment_db_mutex_;
+
+/// @brief the max databases attached to the catalog at once, sqlite default
+/// limit is 10.
+const size_t kMaxAttachedDataBase = 8;
+
+bool IsAbsolutePath(const std::string& path) {
+  if (path.empty()) {
+    return false;
+  }
+  if (path[0] == '/' || path[0] == '\\') {
+    return true;
+  }
+  return path.size() > 1 && path[1] == ':';
+}
+
+std::string QuoteSqlString(const std::string& str) {
+  std::string quoted = "'";
+  for (auto c : str) {
+    if (c == '\'') {
+      quoted += '\'';
+    }
+    quoted += c;
+  }
+  quoted += "'";
+  return quoted;
+}
+
+std::string CatalogDatabaseName(const std::string& db_folder) {
+  return db_folder + anx::common::kPathSeparator + kCatalogDatabaseName;
+}
+
+std::shared_ptr<DatabasePool> OpenDataBasePool(const std::string& db_name) {
+  std::string db_filepathname;
+  if (DatabasePathname(db_name, &db_filepathname) != 0) {
+    return nullptr;
+  }
+  return DatabaseFactory::Instance()->CreateOrGetDatabasePool(db_filepathname);
+}
+
+/// @brief Check out the writer connection of the database, the writes of all
+/// threads are serialized on it.
+PooledDatabase CheckoutWriter(const std::string& db_name) {
+  auto pool = OpenDataBasePool(db_name);
+  if (pool == nullptr) {
+    return PooledDatabase();
+  }
+  return pool->CheckoutWriter();
+}
+
+/// @brief Check out a reader connection of the database, readers run beside
+/// the writer.
+PooledDatabase CheckoutReader(const std::string& db_name) {
+  auto pool = OpenDataBasePool(db_name);
+  if (pool == nullptr) {
+    return PooledDatabase();
+  }
+  return pool->CheckoutReader();
+}
+
+PooledDatabase CheckoutCatalog(const std::string& db_folder, bool writer) {
+  std::string catalog_name = CatalogDatabaseName(db_folder);
+  auto db = CheckoutWriter(catalog_name);
+  if (!db) {
+    LOG_F(LG_ERROR) << "Failed to open catalog: " << db_folder;
+    return PooledDatabase();
+  }
+  if (!db->Execute(sql::kCreateTableExpCatalogSqlFormat)) {
+    LOG_F(LG_ERROR) << "Failed to create catalog table: " << db_folder;
+    return PooledDatabase();
+  }
+  if (writer) {
+    return db;
+  }
+  db.Return();
+  return CheckoutReader(catalog_name);
+}
+
+}  // namespace
+
+int32_t DatabasePathname(const std::string& db_name,
+                         std::string* db_filepathname) {
+  assert(db_filepathname);
+  if (db_filepathname == nullptr || db_name.empty()) {
+    return -1;
+  }
+  if (IsAbsolutePath(db_name)) {
+    *db_filepathname = db_name;
+    return 0;
+  }
+  std::string app_data_dir = anx::common::GetApplicationDataPath("anxi");
+  if (app_data_dir.empty()) {
+    LOG_F(LG_ERROR) << "Failed to get application data path";
+    return -1;
+  }
+  *db_filepathname = app_data_dir + anx::common::kPathSeparator + db_name;
+  return 0;
+}
+
 int32_t DefaultDatabasePathname(std::string* db_filepathname) {
   assert(db_filepathname);
   if (db_filepathname) {
@@ -136,15 +292,18 @@ int32_t DefaultDatabasePathname(std::string* db_filepathname) {
 }
 
 void ClearDatabaseFile(const std::string& db_name) {
-  std::string app_data_dir = anx::common::GetApplicationDataPath("anxi");
-  if (app_data_dir.empty()) {
+  std::string db_filepathname;
+  if (DatabasePathname(db_name, &db_filepathname) != 0) {
     return;
   }
-  std::string db_filepathname =
-      app_data_dir + anx::common::kPathSeparator + db_name;
-  if (anx::common::FileExists(db_filepathname)) {
-    if (!anx::common::RemoveFile(db_filepathname)) {
-      LOG_F(LG_ERROR) << "Failed to remove file: " << db_filepathname;
+  /// @note remove the WAL and shared memory file left by the WAL mode.
+  const char* suffixes[] = {"", "-wal", "-shm"};
+  for (auto suffix : suffixes) {
+    std::string file_pathname = db_filepathname + suffix;
+    if (anx::common::FileExists(file_pathname)) {
+      if (!anx::common::RemoveFile(file_pathname)) {
+        LOG_F(LG_ERROR) << "Failed to remove file: " << file_pathname;
+      }
     }
   }
 }
@@ -162,19 +321,23 @@ bool InitializeDataBase(const std::string& db_pathname,
     return false;
   }
   std::string db_filepathname;
-  DefaultDatabasePathname(&db_filepathname);
+  if (DatabasePathname(db_pathname, &db_filepathname) != 0) {
+    return false;
+  }
   if (!anx::common::MakeSureFolderPathExist(db_filepathname)) {
     LOG_F(LG_ERROR) << "Failed to make sure folder path exist: "
                     << db_filepathname;
     return false;
   }
-  auto db = DatabaseFactory::Instance()->CreateOrGetDatabase(db_filepathname);
-  if (db) {
-    for (auto& s : sql) {
-      if (!db->Execute(s)) {
-        LOG_F(LG_ERROR) << "Failed to execute sql: " << s;
-        return false;
-      }
+  auto db = CheckoutWriter(db_filepathname);
+  if (!db) {
+    LOG_F(LG_ERROR) << "Failed to open database: " << db_filepathname;
+    return false;
+  }
+  for (auto& s : sql) {
+    if (!db->Execute(s)) {
+      LOG_F(LG_ERROR) << "Failed to execute sql: " << s;
+      return false;
     }
   }
   return true;
@@ -184,17 +347,27 @@ bool QueryDataBase(const std::string& db_name,
                    const std::string& table,
                    const std::string& sql,
                    std::vector<std::map<std::string, std::string>>* result) {
-  std::string db_filepathname;
-  DefaultDatabasePathname(&db_filepathname);
-  auto db = DatabaseFactory::Instance()->CreateOrGetDatabase(db_filepathname);
+  auto db = CheckoutReader(db_name);
   if (db) {
     return db->Query(sql, result);
   }
   return false;
 }
 
+bool QueryDataBase(const std::string& db_name,
+                   const std::string& table,
+                   const std::string& sql,
+                   const std::vector<DatabaseValue>& params,
+                   std::vector<std::map<std::string, std::string>>* result) {
+  auto db = CheckoutReader(db_name);
+  if (db) {
+    return db->Query(sql, params, result);
+  }
+  return false;
+}
+
 bool ExecuteDataBase(const std::string& db_name, const std::string& sql) {
-  auto db = DatabaseFactory::Instance()->CreateOrGetDatabase(db_name);
+  auto db = CheckoutWriter(db_name);
   if (db) {
     return db->Execute(sql);
   }
@@ -204,19 +377,26 @@ bool ExecuteDataBase(const std::string& db_name, const std::string& sql) {
 bool InsertDataTable(const std::string& db_name,
                      const std::string& table,
                      const std::string& sql) {
-  std::string db_filepathname;
-  DefaultDatabasePathname(&db_filepathname);
-  auto db = DatabaseFactory::Instance()->CreateOrGetDatabase(db_filepathname);
+  auto db = CheckoutWriter(db_name);
   if (db) {
     return db->Execute(sql);
   }
   return false;
 }
 
+bool InsertDataTable(const std::string& db_name,
+                     const std::string& table,
+                     const std::string& sql,
+                     const std::vector<DatabaseValue>& params) {
+  auto db = CheckoutWriter(db_name);
+  if (db) {
+    return db->Execute(sql, params);
+  }
+  return false;
+}
+
 bool DropDataTable(const std::string& db_name, const std::string& table) {
-  std::string db_filepathname;
-  DefaultDatabasePathname(&db_filepathname);
-  auto db = DatabaseFactory::Instance()->CreateOrGetDatabase(db_filepathname);
+  auto db = CheckoutWriter(db_name);
   if (db) {
     std::string sql = "DROP TABLE " + table;
     return db->Execute(sql);
@@ -225,7 +405,247 @@ bool DropDataTable(const std::string& db_name, const std::string& table) {
 }
 
 void CloseDataBase(const std::string& db_name) {
-  DatabaseFactory::Instance()->CloseDatabase(db_name);
+  std::string db_filepathname;
+  if (DatabasePathname(db_name, &db_filepathname) != 0) {
+    return;
+  }
+  DatabaseFactory::Instance()->CloseDatabase(db_filepathname);
+}
+
+bool CreateExperimentDataTables(const std::string& db_name) {
+  auto db = CheckoutWriter(db_name);
+  if (!db) {
+    return false;
+  }
+  const char* sqls[] = {sql::kCreateTableExpDataGraphSqlFormat,
+                        sql::kCreateIndexExpDataGraphDateSqlFormat,
+                        sql::kCreateIndexExpDataGraphCycleSqlFormat,
+                        sql::kCreateTableExpDataListSqlFormat,
+                        sql::kCreateIndexExpDataListDateSqlFormat,
+                        sql::kCreateIndexExpDataListCycleSqlFormat};
+  for (auto sql_str : sqls) {
+    if (!db->Execute(sql_str)) {
+      LOG_F(LG_ERROR) << "Failed to execute sql: " << sql_str;
+      return false;
+    }
+  }
+  return true;
+}
+
+int32_t CreateExperimentDataBase(const std::string& db_folder,
+                                 int64_t start_time_ms,
+                                 std::string* db_name) {
+  if (db_name == nullptr) {
+    return -1;
+  }
+  std::string file_name = "exp_" + std::to_string(start_time_ms) + ".db";
+  std::string name = db_folder + anx::common::kPathSeparator + file_name;
+  /// @note the file of the same start time is a run of its own, e.g. after
+  /// the wall clock is set back, it is never replaced.
+  std::string db_filepathname;
+  if (DatabasePathname(name, &db_filepathname) != 0) {
+    return -2;
+  }
+  if (anx::common::FileExists(db_filepathname)) {
+    LOG_F(LG_WARN) << "Experiment database exists: " << name;
+    return -5;
+  }
+  if (OpenDataBasePool(name) == nullptr) {
+    LOG_F(LG_ERROR) << "Failed to open experiment database: " << name;
+    return -2;
+  }
+  if (!CreateExperimentDataTables(name)) {
+    LOG_F(LG_ERROR) << "Failed to create experiment tables: " << name;
+    return -3;
+  }
+  auto catalog = CheckoutCatalog(db_folder, true);
+  if (!catalog) {
+    return -4;
+  }
+  std::string sql_str = "INSERT OR REPLACE INTO ";
+  sql_str += kTableExpCatalog;
+  sql_str += " (db_name, start_time, end_time, state) VALUES (";
+  sql_str += QuoteSqlString(file_name);
+  sql_str += ", ";
+  sql_str += std::to_string(start_time_ms);
+  sql_str += ", 0, 0);";
+  if (!catalog->Execute(sql_str)) {
+    LOG_F(LG_ERROR) << "Failed to register experiment database: " << name;
+    return -4;
+  }
+  {
+    anx::common::AutoLock lock(&current_experiment_db_mutex_);
+    current_experiment_db_name_ = name;
+  }
+  *db_name = name;
+  return 0;
+}
+
+int32_t OpenExperimentDataBase(const std::string& db_folder,
+                               int64_t start_time_ms,
+                               std::string* db_name) {
+  if (db_name == nullptr) {
+    return -1;
+  }
+  std::string name = db_folder + anx::common::kPathSeparator + "exp_" +
+                     std::to_string(start_time_ms) + ".db";
+  std::string db_filepathname;
+  if (DatabasePathname(name, &db_filepathname) != 0 ||
+      !anx::common::FileExists(db_filepathname)) {
+    LOG_F(LG_ERROR) << "No experiment database: " << name;
+    return -2;
+  }
+  if (OpenDataBasePool(name) == nullptr) {
+    LOG_F(LG_ERROR) << "Failed to open experiment database: " << name;
+    return -3;
+  }
+  {
+    anx::common::AutoLock lock(&current_experiment_db_mutex_);
+    current_experiment_db_name_ = name;
+  }
+  *db_name = name;
+  return 0;
+}
+
+bool MirrorExperimentDataBase(const std::string& db_name,
+                              int32_t backup_interval_ms) {
+  std::string db_filepathname;
+  if (DatabasePathname(db_name, &db_filepathname) != 0) {
+    return false;
+  }
+  DatabaseMirrorOptions options;
+  options.backup_interval_ms = backup_interval_ms;
+  auto mirror = DatabaseFactory::Instance()->CreateOrGetDatabaseMirror(
+      db_filepathname, options);
+  if (mirror == nullptr) {
+    LOG_F(LG_ERROR) << "Failed to mirror experiment database: " << db_name;
+    return false;
+  }
+  return true;
+}
+
+bool BackupExperimentDataBase(const std::string& db_name) {
+  std::string db_filepathname;
+  if (DatabasePathname(db_name, &db_filepathname) != 0) {
+    return false;
+  }
+  auto mirror = DatabaseFactory::Instance()->GetDatabaseMirror(db_filepathname);
+  if (mirror == nullptr) {
+    return false;
+  }
+  return mirror->Backup() == 0;
+}
+
+std::string CurrentExperimentDataBase() {
+  anx::common::AutoLock lock(&current_experiment_db_mutex_);
+  if (current_experiment_db_name_.empty()) {
+    return kDefaultDatabasePathname;
+  }
+  return current_experiment_db_name_;
+}
+
+void ResetCurrentExperimentDataBase() {
+  anx::common::AutoLock lock(&current_experiment_db_mutex_);
+  current_experiment_db_name_.clear();
+}
+
+bool FinishExperimentDataBase(const std::string& db_name,
+                              int64_t end_time_ms) {
+  std::string::size_type pos = db_name.find_last_of("\\/");
+  if (pos == std::string::npos) {
+    LOG_F(LG_ERROR) << "Invalid experiment database: " << db_name;
+    return false;
+  }
+  std::string db_folder = db_name.substr(0, pos);
+  std::string file_name = db_name.substr(pos + 1);
+  auto db = CheckoutWriter(db_name);
+  if (!db) {
+    return false;
+  }
+  /// @note move all WAL frames into the database file and truncate the WAL,
+  /// after close the database file is self-contained. the mirror is backed
+  /// up to the file by the close.
+  if (!db->Execute("PRAGMA wal_checkpoint(TRUNCATE);")) {
+    LOG_F(LG_WARN) << "Failed to checkpoint: " << db_name;
+  }
+  db.Return();
+  CloseDataBase(db_name);
+
+  auto catalog = CheckoutCatalog(db_folder, true);
+  if (!catalog) {
+    return false;
+  }
+  std::string sql_str = "UPDATE ";
+  sql_str += kTableExpCatalog;
+  sql_str += " SET end_time = ";
+  sql_str += std::to_string(end_time_ms);
+  sql_str += ", state = 1 WHERE db_name = ";
+  sql_str += QuoteSqlString(file_name);
+  sql_str += ";";
+  return catalog->Execute(sql_str);
+}
+
+bool QueryExperimentCatalog(
+    const std::string& db_folder,
+    std::vector<std::map<std::string, std::string>>* result) {
+  auto catalog = CheckoutCatalog(db_folder, false);
+  if (!catalog) {
+    return false;
+  }
+  return catalog->Query(sql::kQueryTableExpCatalogSqlFormat, result);
+}
+
+bool QueryExperimentDataBases(
+    const std::string& db_folder,
+    const std::vector<std::string>& db_names,
+    const std::string& table,
+    const std::string& where,
+    std::vector<std::map<std::string, std::string>>* result) {
+  auto catalog = CheckoutCatalog(db_folder, false);
+  if (!catalog) {
+    return false;
+  }
+  std::string db_folder_pathname;
+  if (DatabasePathname(db_folder, &db_folder_pathname) != 0) {
+    return false;
+  }
+  bool ret = true;
+  for (size_t begin = 0; begin < db_names.size() && ret;
+       begin += kMaxAttachedDataBase) {
+    size_t end = std::min(db_names.size(), begin + kMaxAttachedDataBase);
+    size_t attached = begin;
+    std::string sql_str;
+    for (; attached < end; ++attached) {
+      std::string schema = "exp" + std::to_string(attached - begin);
+      std::string attach_sql = "ATTACH DATABASE ";
+      attach_sql += QuoteSqlString(db_folder_pathname +
+                                   anx::common::kPathSeparator +
+                                   db_names[attached]);
+      attach_sql += " AS " + schema + ";";
+      if (!catalog->Execute(attach_sql)) {
+        LOG_F(LG_ERROR) << "Failed to attach: " << db_names[attached];
+        ret = false;
+        break;
+      }
+      if (!sql_str.empty()) {
+        sql_str += " UNION ALL ";
+      }
+      sql_str += "SELECT " + QuoteSqlString(db_names[attached]) +
+                 " AS db_name, * FROM " + schema + "." + table;
+      if (!where.empty()) {
+        sql_str += " WHERE " + where;
+      }
+    }
+    if (ret) {
+      sql_str += ";";
+      ret = catalog->Query(sql_str, result);
+    }
+    for (size_t i = begin; i < attached; ++i) {
+      catalog->Execute("DETACH DATABASE exp" + std::to_string(i - begin) +
+                       ";");
+    }
+  }
+  return ret;
 }
 
 }  // namespace helper
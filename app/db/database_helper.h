@@ -31,17 +31,26 @@ extern const char* kTableExpDataList;
 extern const char* kTableSendData;
 extern const char* kTableNotification;
 extern const char* kTableSendNotify;
+extern const char* kExperimentDatabaseFolder;
+extern const char* kCatalogDatabaseName;
+extern const char* kTableExpCatalog;
 
 namespace sql {
 extern const char* kCreateTableExpDataGraphSqlFormat;
 extern const char* kInsertTableExpDataGraphSqlFormat;
+extern const char* kInsertTableExpDataGraphSqlPrepared;
 extern const char* kQueryTableExpDataGraphSqlByIdFormat;
 extern const char* kQueryTableExpDataGraphSqlByTimeFormat;
+extern const char* kCreateIndexExpDataGraphDateSqlFormat;
+extern const char* kCreateIndexExpDataGraphCycleSqlFormat;
 
 extern const char* kCreateTableExpDataListSqlFormat;
 extern const char* kInsertTableExpDataListSqlFormat;
+extern const char* kInsertTableExpDataListSqlPrepared;
 extern const char* kQueryTableExpDataListSqlByIdFormat;
 extern const char* kQueryTableExpDataListSqlByTimeFormat;
+extern const char* kCreateIndexExpDataListDateSqlFormat;
+extern const char* kCreateIndexExpDataListCycleSqlFormat;
 
 extern const char* kCreateTableSendDataSqlFormat;
 extern const char* kInsertTableSendDataSqlFormat;
@@ -58,6 +67,9 @@ extern const char* kInsertTableSendNotifySqlFormat;
 extern const char* kQueryTableSendNotifySqlByIdFormat;
 extern const char* kQueryTableSendNotifySqlByTimeFormat;
 
+extern const char* kCreateTableExpCatalogSqlFormat;
+extern const char* kQueryTableExpCatalogSqlFormat;
+
 }  // namespace sql
 
 /// @brief Get the default database pathname
@@ -65,6 +77,14 @@ extern const char* kQueryTableSendNotifySqlByTimeFormat;
 /// @return 0 if success, -1 if failed
 int32_t DefaultDatabasePathname(std::string* db_pathname);
 
+/// @brief Get the database pathname of the database name
+/// @param db_name the database name, absolute path or relative path of the
+/// application data path
+/// @param db_filepathname the database path name
+/// @return 0 if success, -1 if failed
+int32_t DatabasePathname(const std::string& db_name,
+                         std::string* db_filepathname);
+
 /// @brief Clear the database file and remove it
 /// @param db_name the database name
 void ClearDatabaseFile(const std::string& db_name);
@@ -86,6 +106,19 @@ bool QueryDataBase(const std::string& db_name,
                    const std::string& sql,
                    std::vector<std::map<std::string, std::string>>* result);
 
+/// @brief Query the database with the parameters bound, the prepared
+/// statement is cached by the reader connection.
+/// @param db_name the database name
+/// @param sql the sql with ? parameters
+/// @param params the parameter values
+/// @param result the result
+/// @return true if success
+bool QueryDataBase(const std::string& db_name,
+                   const std::string& table,
+                   const std::string& sql,
+                   const std::vector<DatabaseValue>& params,
+                   std::vector<std::map<std::string, std::string>>* result);
+
 /// @brief Execute the database
 /// @param db_name the database name
 /// @param sql the sql
@@ -100,6 +133,17 @@ bool InsertDataTable(const std::string& db_name,
                      const std::string& table,
                      const std::string& sql);
 
+/// @brief Insert the database table with the parameters bound, the prepared
+/// statement is cached by the writer connection.
+/// @param table the table name in the database
+/// @param sql the sql with ? parameters
+/// @param params the parameter values
+/// @return true if success
+bool InsertDataTable(const std::string& db_name,
+                     const std::string& table,
+                     const std::string& sql,
+                     const std::vector<DatabaseValue>& params);
+
 /// @brief Drop the database table
 /// @param table the table name in the database
 /// @return true if success
@@ -109,6 +153,97 @@ bool DropDataTable(const std::string& db_name, const std::string& table);
 /// @param db_name the database name
 void CloseDataBase(const std::string& db_name);
 
+/// @brief Create the exp_data_graph and exp_data_list tables with the date
+/// and cycle indexes.
+/// @param db_name the database name
+/// @return true if success
+bool CreateExperimentDataTables(const std::string& db_name);
+
+/// @brief Create a database file for one experiment run with the exp data
+/// tables, register it in the catalog of the folder and make it the current
+/// experiment database.
+/// @param db_folder the folder of the experiment databases, absolute path or
+/// relative path of the application data path, see kExperimentDatabaseFolder
+/// @param start_time_ms the start time of the experiment in milliseconds
+/// since the unix epoch, see anx::common::GetCurrentEpochMillis
+/// @param db_name the experiment database name created
+/// @return 0 if success, -1 if db_name is null, -2 if the database can't be
+/// opened, -3 if the tables can't be created, -4 if catalog register failed,
+/// -5 if the database of the start time exists, the file is kept as is
+int32_t CreateExperimentDataBase(const std::string& db_folder,
+                                 int64_t start_time_ms,
+                                 std::string* db_name);
+
+/// @brief Open the database file of the experiment run started at the time
+/// again and make it the current experiment database, e.g. to resume the run
+/// interrupted by a crash. the rows of the file are kept.
+/// @param db_folder the folder of the experiment databases
+/// @param start_time_ms the start time of the experiment in milliseconds
+/// @param db_name the experiment database name opened
+/// @return 0 if success, -1 if db_name is null, -2 if the file not exists, -3
+/// if the database can't be opened
+int32_t OpenExperimentDataBase(const std::string& db_folder,
+                               int64_t start_time_ms,
+                               std::string* db_name);
+
+/// @brief Keep the experiment database in memory for the run, the writes
+/// and the reads of the database go to the memory and the memory is backed
+/// up to the file at the interval, on BackupExperimentDataBase and on
+/// FinishExperimentDataBase.
+/// @param db_name the experiment database name
+/// @param backup_interval_ms the interval of the backups, 0 backs up only on
+/// request and on finish
+/// @return true if success
+bool MirrorExperimentDataBase(const std::string& db_name,
+                              int32_t backup_interval_ms);
+
+/// @brief Back up the memory of the experiment database to the file now,
+/// e.g. on pause.
+/// @param db_name the experiment database name
+/// @return true if success, false if failed or the database is not mirrored
+bool BackupExperimentDataBase(const std::string& db_name);
+
+/// @brief Get the current experiment database name
+/// @return the current experiment database name, the default database if no
+/// experiment database is created
+std::string CurrentExperimentDataBase();
+
+/// @brief Reset the current experiment database to the default database
+void ResetCurrentExperimentDataBase();
+
+/// @brief Finish the experiment database, back up the memory of the mirrored
+/// database, checkpoint the WAL into the database file, mark the end time in
+/// the catalog and close it. the file is
+/// not written any more and can be archived.
+/// @param db_name the experiment database name
+/// @param end_time_ms the end time of the experiment in milliseconds
+/// since the unix epoch
+/// @return true if success
+bool FinishExperimentDataBase(const std::string& db_name, int64_t end_time_ms);
+
+/// @brief Query the experiment catalog of the folder
+/// @param db_folder the folder of the experiment databases
+/// @param result the result, columns db_name, start_time, end_time, state
+/// @return true if success
+bool QueryExperimentCatalog(
+    const std::string& db_folder,
+    std::vector<std::map<std::string, std::string>>* result);
+
+/// @brief Query the table of several experiment databases at once, the
+/// databases are attached to the catalog database and the rows are unioned.
+/// @param db_folder the folder of the experiment databases
+/// @param db_names the experiment database names
+/// @param table the table name in the experiment databases
+/// @param where the where clause without WHERE keyword, may be empty
+/// @param result the result, each row with an extra column db_name
+/// @return true if success
+bool QueryExperimentDataBases(
+    const std::string& db_folder,
+    const std::vector<std::string>& db_names,
+    const std::string& table,
+    const std::string& where,
+    std::vector<std::map<std::string, std::string>>* result);
+
 }  // namespace helper
 }  // namespace db
 }  // namespace anx
@@ -14,6 +14,9 @@
 
 #include <sqlite3.h>
 
+#include <string>
+#include <vector>
+
 #include "app/common/file_utils.h"
 #include "app/common/logger.h"
 #include "app/common/module_utils.h"
@@ -22,7 +25,30 @@
 namespace anx {
 namespace db {
 
-Database::Database() : db_(nullptr) {}
+const char* kMemoryDatabaseName = ":memory:";
+
+DatabaseOptions::DatabaseOptions()
+    : journal_mode_("WAL"),
+      synchronous_("NORMAL"),
+      page_size_(4096),
+      cache_size_kib_(8192),
+      mmap_size_(64 * 1024 * 1024),
+      temp_store_memory_(true),
+      busy_timeout_ms_(5000) {}
+
+namespace {
+/// @brief the max prepared statements cached by one database connection.
+const size_t kMaxCachedStatement = 32;
+}  // namespace
+
+Database::Database()
+    : db_(nullptr), statement_cache_hits_(0), statement_cache_misses_(0) {}
+
+Database::Database(const DatabaseOptions& options)
+    : db_(nullptr),
+      options_(options),
+      statement_cache_hits_(0),
+      statement_cache_misses_(0) {}
 
 Database::~Database() {
   Close();
@@ -38,18 +64,65 @@ bool Database::Open(const std::string& db_name) {
   std::wstring w_name = anx::common::String2WString(db_name.c_str());
   name = anx::common::UnicodeToUTF8(w_name.c_str());
 #endif
-  if (!anx::common::MakeSureFolderPathExist(db_name)) {
+  if (db_name != kMemoryDatabaseName &&
+      !anx::common::MakeSureFolderPathExist(db_name)) {
     LOG_F(LG_ERROR) << "Failed to make sure folder path exist: " << db_name;
     return false;
   }
   int ret = sqlite3_open(name.c_str(), reinterpret_cast<sqlite3**>(&db_));
   if (ret != SQLITE_OK) {
+    LOG_F(LG_ERROR) << "Failed to open database: " << db_name;
+    sqlite3_close(reinterpret_cast<sqlite3*>(db_));
+    db_ = nullptr;
     return false;
   }
+  ApplyOptions();
   return true;
 }
 
+void Database::ApplyOptions() {
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  if (options_.busy_timeout_ms_ > 0) {
+    sqlite3_busy_timeout(db, options_.busy_timeout_ms_);
+  }
+  /// @note page_size must be set before journal_mode, the WAL header
+  /// fixes the page size of the file.
+  std::vector<std::string> pragmas;
+  if (options_.page_size_ > 0) {
+    pragmas.push_back("PRAGMA page_size = " +
+                      std::to_string(options_.page_size_));
+  }
+  if (!options_.journal_mode_.empty()) {
+    pragmas.push_back("PRAGMA journal_mode = " + options_.journal_mode_);
+  }
+  if (!options_.synchronous_.empty()) {
+    pragmas.push_back("PRAGMA synchronous = " + options_.synchronous_);
+  }
+  if (options_.cache_size_kib_ > 0) {
+    /// negative value is the cache size in KiB instead of pages.
+    pragmas.push_back("PRAGMA cache_size = -" +
+                      std::to_string(options_.cache_size_kib_));
+  }
+  if (options_.mmap_size_ >= 0) {
+    pragmas.push_back("PRAGMA mmap_size = " +
+                      std::to_string(options_.mmap_size_));
+  }
+  if (options_.temp_store_memory_) {
+    pragmas.push_back("PRAGMA temp_store = MEMORY");
+  }
+  for (auto& pragma : pragmas) {
+    char* err_msg = nullptr;
+    int ret = sqlite3_exec(db, pragma.c_str(), nullptr, nullptr, &err_msg);
+    if (ret != SQLITE_OK) {
+      LOG_F(LG_WARN) << "Failed to apply: " << pragma << " "
+                     << (err_msg != nullptr ? err_msg : "");
+      sqlite3_free(err_msg);
+    }
+  }
+}
+
 void Database::Close() {
+  ClearStatementCache();
   if (db_ != nullptr) {
     sqlite3_close(reinterpret_cast<sqlite3*>(db_));
     db_ = nullptr;
@@ -84,7 +157,7 @@ bool Database::Query(const std::string& sql,
                 data);
         std::map<std::string, std::string> row;
         for (int i = 0; i < col_count; ++i) {
-          row[col_names[i]] = col_values[i];
+          row[col_names[i]] = col_values[i] != nullptr ? col_values[i] : "";
         }
         result->push_back(row);
         return 0;
@@ -97,5 +170,128 @@ bool Database::Query(const std::string& sql,
   return true;
 }
 
+bool Database::Execute(const std::string& sql,
+                       const std::vector<DatabaseValue>& params) {
+  sqlite3_stmt* stmt =
+      reinterpret_cast<sqlite3_stmt*>(PrepareStatement(sql, params));
+  if (stmt == nullptr) {
+    return false;
+  }
+  int ret = SQLITE_ROW;
+  while (ret == SQLITE_ROW) {
+    ret = sqlite3_step(stmt);
+  }
+  sqlite3_reset(stmt);
+  if (ret != SQLITE_DONE) {
+    LOG_F(LG_ERROR) << "Failed to execute: " << sql << " "
+                    << sqlite3_errmsg(reinterpret_cast<sqlite3*>(db_));
+    return false;
+  }
+  return true;
+}
+
+bool Database::Query(const std::string& sql,
+                     const std::vector<DatabaseValue>& params,
+                     std::vector<std::map<std::string, std::string>>* result) {
+  if (result == nullptr) {
+    return false;
+  }
+  sqlite3_stmt* stmt =
+      reinterpret_cast<sqlite3_stmt*>(PrepareStatement(sql, params));
+  if (stmt == nullptr) {
+    return false;
+  }
+  int col_count = sqlite3_column_count(stmt);
+  int ret = sqlite3_step(stmt);
+  while (ret == SQLITE_ROW) {
+    std::map<std::string, std::string> row;
+    for (int i = 0; i < col_count; ++i) {
+      const unsigned char* value = sqlite3_column_text(stmt, i);
+      row[sqlite3_column_name(stmt, i)] =
+          value != nullptr ? reinterpret_cast<const char*>(value) : "";
+    }
+    result->push_back(row);
+    ret = sqlite3_step(stmt);
+  }
+  sqlite3_reset(stmt);
+  if (ret != SQLITE_DONE) {
+    LOG_F(LG_ERROR) << "Failed to query: " << sql << " "
+                    << sqlite3_errmsg(reinterpret_cast<sqlite3*>(db_));
+    return false;
+  }
+  return true;
+}
+
+void* Database::PrepareStatement(const std::string& sql,
+                                 const std::vector<DatabaseValue>& params) {
+  if (db_ == nullptr) {
+    return nullptr;
+  }
+  sqlite3_stmt* stmt = nullptr;
+  auto iter = statements_.find(sql);
+  if (iter != statements_.end()) {
+    stmt = reinterpret_cast<sqlite3_stmt*>(iter->second);
+    statement_lru_.remove(sql);
+    statement_lru_.push_front(sql);
+    statement_cache_hits_++;
+  } else {
+    int ret = sqlite3_prepare_v2(reinterpret_cast<sqlite3*>(db_), sql.c_str(),
+                                 -1, &stmt, nullptr);
+    if (ret != SQLITE_OK || stmt == nullptr) {
+      LOG_F(LG_ERROR) << "Failed to prepare: " << sql << " "
+                      << sqlite3_errmsg(reinterpret_cast<sqlite3*>(db_));
+      sqlite3_finalize(stmt);
+      return nullptr;
+    }
+    statement_cache_misses_++;
+    if (statements_.size() >= kMaxCachedStatement) {
+      std::string last_sql = statement_lru_.back();
+      statement_lru_.pop_back();
+      sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(statements_[last_sql]));
+      statements_.erase(last_sql);
+    }
+    statements_[sql] = stmt;
+    statement_lru_.push_front(sql);
+  }
+  sqlite3_clear_bindings(stmt);
+  if (static_cast<int>(params.size()) != sqlite3_bind_parameter_count(stmt)) {
+    LOG_F(LG_ERROR) << "Parameter count mismatch: " << sql;
+    return nullptr;
+  }
+  for (size_t i = 0; i < params.size(); i++) {
+    int index = static_cast<int>(i + 1);
+    int ret = SQLITE_OK;
+    switch (params[i].type_) {
+      case DatabaseValue::kInteger:
+        ret = sqlite3_bind_int64(stmt, index, params[i].integer_);
+        break;
+      case DatabaseValue::kReal:
+        ret = sqlite3_bind_double(stmt, index, params[i].real_);
+        break;
+      case DatabaseValue::kText:
+        ret = sqlite3_bind_text(stmt, index, params[i].text_.c_str(),
+                                static_cast<int>(params[i].text_.size()),
+                                SQLITE_TRANSIENT);
+        break;
+      default:
+        ret = sqlite3_bind_null(stmt, index);
+        break;
+    }
+    if (ret != SQLITE_OK) {
+      LOG_F(LG_ERROR) << "Failed to bind parameter " << index << ": " << sql;
+      return nullptr;
+    }
+  }
+  return stmt;
+}
+
+void Database::ClearStatementCache() {
+  for (auto& iter : statements_) {
+    sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(iter.second));
+  }
+  statements_.clear();
+  statement_lru_.clear();
+}
+
 }  // namespace db
 }  // namespace anx
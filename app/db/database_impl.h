@@ -13,6 +13,8 @@
 #ifndef APP_DB_DATABASE_IMPL_H_
 #define APP_DB_DATABASE_IMPL_H_
 
+#include <cstdint>
+#include <list>
 #include <map>
 #include <string>
 #include <vector>
@@ -22,12 +24,43 @@
 namespace anx {
 namespace db {
 
+/// @brief sqlite3 connection options, applied as pragmas right after the
+/// database file is opened.
+class DatabaseOptions {
+ public:
+  DatabaseOptions();
+
+ public:
+  /// @brief journal mode, "WAL" lets readers run beside the writer.
+  /// empty string keeps the mode stored in the file.
+  std::string journal_mode_;
+  /// @brief synchronous level, "NORMAL" is durable enough with WAL.
+  std::string synchronous_;
+  /// @brief page size in bytes, only effective for a new database file.
+  int32_t page_size_;
+  /// @brief page cache size in KiB.
+  int32_t cache_size_kib_;
+  /// @brief memory map size in bytes, 0 disables mmap I/O.
+  int64_t mmap_size_;
+  /// @brief keep temp tables and indices in memory.
+  bool temp_store_memory_;
+  /// @brief busy handler timeout in milliseconds.
+  int32_t busy_timeout_ms_;
+};
+
+/// @brief the name of the in-memory database of Open
+extern const char* kMemoryDatabaseName;
+
 /// @brief sqlite3 database helper class
 class Database : public DatabaseInterface {
  public:
   /// @brief Constructor
   Database();
 
+  /// @brief Constructor
+  /// @param options the options applied on open
+  explicit Database(const DatabaseOptions& options);
+
   /// @brief Destructor
   virtual ~Database();
 
@@ -51,9 +84,61 @@ class Database : public DatabaseInterface {
   bool Query(const std::string& sql,
              std::vector<std::map<std::string, std::string>>* result) override;
 
+  /// @brief Execute the sql with the parameters bound
+  /// @param sql the sql with ? parameters
+  /// @param params the parameter values
+  /// @return true if execute success
+  bool Execute(const std::string& sql,
+               const std::vector<DatabaseValue>& params) override;
+
+  /// @brief Query the sql with the parameters bound
+  /// @param sql the sql with ? parameters
+  /// @param params the parameter values
+  /// @param result the result
+  /// @return true if query success
+  bool Query(const std::string& sql,
+             const std::vector<DatabaseValue>& params,
+             std::vector<std::map<std::string, std::string>>* result) override;
+
+  /// @brief Get the count of the prepared statements found in the cache
+  int64_t statement_cache_hits() const { return statement_cache_hits_; }
+
+  /// @brief Get the count of the prepared statements not found in the cache
+  int64_t statement_cache_misses() const { return statement_cache_misses_; }
+
+  /// @brief Get the sqlite3 handle, e.g. for the online backup
+  /// @return the sqlite3 handle, nullptr if not opened
+  void* handle() const { return db_; }
+  /// @brief Get the options used by the database
+  /// @return the options
+  const DatabaseOptions& options() const { return options_; }
+
+ private:
+  /// @brief Apply the options as pragmas on the opened database
+  void ApplyOptions();
+
+  /// @brief Get the prepared statement of the sql from the cache or prepare
+  /// it, the statement is reset and the parameters are bound.
+  /// @param sql the sql
+  /// @param params the parameter values
+  /// @return the sqlite3_stmt, nullptr if failed
+  void* PrepareStatement(const std::string& sql,
+                         const std::vector<DatabaseValue>& params);
+
+  /// @brief Finalize all the cached statements
+  void ClearStatementCache();
+
  private:
   /// @brief the sqlite3 database
   void* db_;
+  /// @brief the options applied on open
+  DatabaseOptions options_;
+  /// @brief the prepared statements by sql
+  std::map<std::string, void*> statements_;
+  /// @brief the sql of the cached statements, the most recently used first
+  std::list<std::string> statement_lru_;
+  int64_t statement_cache_hits_;
+  int64_t statement_cache_misses_;
 };
 }  // namespace db
 }  // namespace anx
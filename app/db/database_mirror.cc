@@ -0,0 +1,224 @@
+/**
+ * @file database_mirror.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the in-memory mirror of one database file
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/db/database_mirror.h"
+
+#include <sqlite3.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace db {
+
+////////////////////////////////////////////////////////////////////////////////
+// clz DatabaseMirror
+
+DatabaseMirror::DatabaseMirror(const std::string& db_filepathname,
+                               const DatabaseMirrorOptions& options)
+    : db_filepathname_(db_filepathname),
+      options_(options),
+      backups_(0),
+      last_backup_ms_(0) {}
+
+DatabaseMirror::~DatabaseMirror() {
+  Close();
+}
+
+bool DatabaseMirror::Open() {
+  if (pool() != nullptr) {
+    return true;
+  }
+  std::unique_ptr<Database> file(new Database(DatabaseOptions()));
+  if (!file->Open(db_filepathname_)) {
+    LOG_F(LG_ERROR) << "Failed to open file: " << db_filepathname_;
+    return false;
+  }
+  /// @note the online backup needs the same page size on both sides, the
+  /// memory takes the page size of the file.
+  DatabaseOptions memory_options;
+  memory_options.journal_mode_ = "MEMORY";
+  memory_options.synchronous_ = "OFF";
+  memory_options.mmap_size_ = 0;
+  std::vector<std::map<std::string, std::string>> result;
+  if (file->Query("PRAGMA page_size;", &result) && result.size() == 1) {
+    memory_options.page_size_ = std::stoi(result[0]["page_size"]);
+  }
+  auto pool =
+      std::make_shared<DatabasePool>(kMemoryDatabaseName, 0, memory_options);
+  if (!pool->Open()) {
+    LOG_F(LG_ERROR) << "Failed to open memory: " << db_filepathname_;
+    return false;
+  }
+  {
+    /// @note the file is loaded by a connection of its own, the connections
+    /// of the backups are locked in one order only.
+    Database source;
+    auto memory = pool->CheckoutWriter();
+    sqlite3* dest = reinterpret_cast<sqlite3*>(memory->handle());
+    int rc = SQLITE_ERROR;
+    if (source.Open(db_filepathname_)) {
+      sqlite3_backup* backup = sqlite3_backup_init(
+          dest, "main", reinterpret_cast<sqlite3*>(source.handle()), "main");
+      if (backup != nullptr) {
+        sqlite3_backup_step(backup, -1);
+        rc = sqlite3_backup_finish(backup);
+      }
+    }
+    if (rc != SQLITE_OK) {
+      LOG_F(LG_ERROR) << "Failed to load file: " << db_filepathname_ << " "
+                      << sqlite3_errmsg(dest);
+      memory.Return();
+      pool->Close();
+      return false;
+    }
+  }
+  {
+    anx::common::AutoLock backup_lock(&backup_mutex_);
+    file_ = std::move(file);
+  }
+  {
+    anx::common::AutoLock lock(&mutex_);
+    pool_ = pool;
+    stop_ = false;
+  }
+  if (options_.backup_interval_ms > 0) {
+    thread_.reset(new anx::common::Thread(this));
+    thread_->start();
+  }
+  return true;
+}
+
+void DatabaseMirror::Close() {
+  interrupt();
+  if (thread_ != nullptr) {
+    thread_->join();
+    thread_.reset();
+  }
+  if (pool() == nullptr) {
+    return;
+  }
+  if (BackupPages(-1) != 0) {
+    LOG_F(LG_ERROR) << "Failed to back up on close: " << db_filepathname_;
+  }
+  std::shared_ptr<DatabasePool> pool;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    pool.swap(pool_);
+  }
+  pool->Close();
+  anx::common::AutoLock backup_lock(&backup_mutex_);
+  file_.reset();
+}
+
+int32_t DatabaseMirror::Backup() {
+  return BackupPages(-1);
+}
+
+std::shared_ptr<DatabasePool> DatabaseMirror::pool() {
+  anx::common::AutoLock lock(&mutex_);
+  return pool_;
+}
+
+int64_t DatabaseMirror::backups() {
+  anx::common::AutoLock lock(&mutex_);
+  return backups_;
+}
+
+int64_t DatabaseMirror::last_backup_ms() {
+  anx::common::AutoLock lock(&mutex_);
+  return last_backup_ms_;
+}
+
+void DatabaseMirror::interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  stop_ = true;
+  cond_.broadcast();
+}
+
+bool DatabaseMirror::is_interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  return stop_;
+}
+
+void DatabaseMirror::run() {
+  while (!WaitFor(options_.backup_interval_ms)) {
+    if (BackupPages(options_.pages_per_step) != 0) {
+      LOG_F(LG_WARN) << "Failed to back up: " << db_filepathname_;
+    }
+  }
+}
+
+int32_t DatabaseMirror::BackupPages(int32_t pages_per_step) {
+  anx::common::AutoLock backup_lock(&backup_mutex_);
+  std::shared_ptr<DatabasePool> pool = this->pool();
+  if (pool == nullptr || file_ == nullptr) {
+    return -1;
+  }
+  sqlite3* file = reinterpret_cast<sqlite3*>(file_->handle());
+  sqlite3_backup* backup = nullptr;
+  int rc = SQLITE_OK;
+  int32_t pages = 0;
+  while (rc == SQLITE_OK) {
+    /// @note the writer is held a step and released between the steps, the
+    /// rows written by the same connection meanwhile are copied by the
+    /// backup in progress without restarting it.
+    auto memory = pool->CheckoutWriter();
+    if (!memory) {
+      rc = SQLITE_BUSY;
+    } else if (backup == nullptr) {
+      backup = sqlite3_backup_init(
+          file, "main", reinterpret_cast<sqlite3*>(memory->handle()), "main");
+      rc = backup != nullptr ? SQLITE_OK : SQLITE_ERROR;
+    }
+    if (backup == nullptr) {
+      break;
+    }
+    if (rc == SQLITE_OK) {
+      rc = sqlite3_backup_step(backup,
+                               pages_per_step > 0 ? pages_per_step : -1);
+      pages = sqlite3_backup_pagecount(backup);
+    }
+    if (rc != SQLITE_OK) {
+      int finish_rc = sqlite3_backup_finish(backup);
+      backup = nullptr;
+      if (rc == SQLITE_DONE) {
+        rc = finish_rc;
+        break;
+      }
+    }
+  }
+  if (rc != SQLITE_OK) {
+    LOG_F(LG_ERROR) << "Backup failed: " << db_filepathname_ << " rc:" << rc
+                    << " " << sqlite3_errmsg(file);
+    return -2;
+  }
+  LOG_F(LG_SENSITIVE) << "Backup " << db_filepathname_ << " pages:" << pages;
+  anx::common::AutoLock lock(&mutex_);
+  backups_++;
+  last_backup_ms_ = anx::common::GetCurrentTimeMillis();
+  return 0;
+}
+
+bool DatabaseMirror::WaitFor(int32_t wait_ms) {
+  anx::common::AutoLock lock(&mutex_);
+  if (!stop_) {
+    cond_.wait(&mutex_, static_cast<unsigned int>(wait_ms));
+  }
+  return stop_;
+}
+
+}  // namespace db
+}  // namespace anx
@@ -0,0 +1,110 @@
+/**
+ * @file database_mirror.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the in-memory mirror of one database file, the writes and the reads
+ * go to the memory and the memory is backed up to the file in background.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DB_DATABASE_MIRROR_H_
+#define APP_DB_DATABASE_MIRROR_H_
+
+#include <memory>
+#include <string>
+
+#include "app/common/thread.h"
+#include "app/db/database_impl.h"
+#include "app/db/database_pool.h"
+
+namespace anx {
+namespace db {
+
+struct DatabaseMirrorOptions {
+  /// @brief the interval of the backups to the file, 0 backs up only on
+  /// Backup and Close.
+  int32_t backup_interval_ms = 5000;
+  /// @brief the pages copied a step of the background backup, the writer is
+  /// released between the steps. <= 0 copies all pages in one step.
+  int32_t pages_per_step = 256;
+};
+
+////////////////////////////////////////////////////////////
+// clz DatabaseMirror
+/// @brief the file is loaded into an in-memory database on Open. the pool of
+/// the memory has one connection shared by the writer and the readers, the
+/// queries run at the speed of the memory. the thread copies the memory to
+/// the file with the sqlite3 online backup, the file sees the pages written
+/// in large sequential writes instead of the commits of each row. the writes
+/// after the last backup are lost on a crash.
+class DatabaseMirror : public anx::common::Runnable {
+ public:
+  /// @brief Constructor
+  /// @param db_filepathname the database file path name
+  /// @param options the options of the backups
+  DatabaseMirror(const std::string& db_filepathname,
+                 const DatabaseMirrorOptions& options);
+  /// @brief Destructor, closes the mirror
+  ~DatabaseMirror() override;
+
+  DatabaseMirror(const DatabaseMirror&) = delete;
+  DatabaseMirror& operator=(const DatabaseMirror&) = delete;
+
+ public:
+  /// @brief Open the file and the memory, copy the file into the memory and
+  /// start the backup thread. the file is created if not exists.
+  /// @return true if success
+  bool Open();
+  /// @brief Stop the backup thread, copy the memory to the file and close
+  void Close();
+  /// @brief Copy all the memory to the file now, e.g. on pause.
+  /// @return 0 if success, -1 if not opened, -2 if the backup failed
+  int32_t Backup();
+
+  /// @brief Get the pool of the memory, nullptr if not opened
+  std::shared_ptr<DatabasePool> pool();
+  /// @brief Get the database file path name
+  const std::string& db_filepathname() const { return db_filepathname_; }
+  /// @brief Get the count of the backups finished
+  int64_t backups();
+  /// @brief Get the time of the last backup finished in milliseconds, 0 if
+  /// none
+  int64_t last_backup_ms();
+
+  void interrupt() override;
+  bool is_interrupt() override;
+
+ protected:
+  void run() override;
+
+ private:
+  /// @brief Copy the memory to the file
+  /// @param pages_per_step the pages a step, <= 0 for all pages in one step
+  /// @return 0 if success, -1 if not opened, -2 if the backup failed
+  int32_t BackupPages(int32_t pages_per_step);
+  /// @brief Wait for the time or the stop
+  /// @return true if stopped
+  bool WaitFor(int32_t wait_ms);
+
+ private:
+  std::string db_filepathname_;
+  DatabaseMirrorOptions options_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  std::shared_ptr<DatabasePool> pool_;
+  /// @brief the connection of the file, used by the backups only
+  std::unique_ptr<Database> file_;
+  /// @brief the backups of the thread and of the callers are serialized
+  anx::common::Mutex backup_mutex_;
+  int64_t backups_;
+  int64_t last_backup_ms_;
+};
+
+}  // namespace db
+}  // namespace anx
+
+#endif  // APP_DB_DATABASE_MIRROR_H_
@@ -0,0 +1,229 @@
+/**
+ * @file database_pool.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief sqlite3 connection pool of one database file, one writer connection
+ * and several reader connections.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/db/database_pool.h"
+
+#include <utility>
+
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace db {
+
+///////////////////////////////////////////////////////////////////////////////
+// clz PooledDatabase
+PooledDatabase::PooledDatabase() : writer_(false) {}
+
+PooledDatabase::PooledDatabase(std::shared_ptr<DatabasePool> pool,
+                               std::shared_ptr<Database> db,
+                               bool writer)
+    : pool_(pool), db_(db), writer_(writer) {}
+
+PooledDatabase::~PooledDatabase() {
+  Return();
+}
+
+PooledDatabase::PooledDatabase(PooledDatabase&& other)
+    : pool_(std::move(other.pool_)),
+      db_(std::move(other.db_)),
+      writer_(other.writer_) {}
+
+PooledDatabase& PooledDatabase::operator=(PooledDatabase&& other) {
+  if (this != &other) {
+    Return();
+    pool_ = std::move(other.pool_);
+    db_ = std::move(other.db_);
+    writer_ = other.writer_;
+  }
+  return *this;
+}
+
+void PooledDatabase::Return() {
+  if (pool_ != nullptr && db_ != nullptr) {
+    pool_->Return(db_, writer_);
+  }
+  pool_ = nullptr;
+  db_ = nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz DatabasePool
+const int32_t DatabasePool::kDefaultCheckoutTimeout;
+
+DatabasePool::DatabasePool(const std::string& db_filepathname,
+                           int32_t reader_count,
+                           const DatabaseOptions& options)
+    : db_filepathname_(db_filepathname),
+      reader_count_(reader_count > 0 ? reader_count : 0),
+      options_(options),
+      writer_busy_(false),
+      opened_reader_count_(0),
+      checkout_waits_(0),
+      closed_(true) {}
+
+DatabasePool::~DatabasePool() {
+  Close();
+}
+
+bool DatabasePool::Open() {
+  anx::common::AutoLock lock(&mutex_);
+  if (writer_ != nullptr) {
+    return true;
+  }
+  auto db = std::make_shared<Database>(options_);
+  if (!db->Open(db_filepathname_)) {
+    LOG_F(LG_ERROR) << "Failed to open writer: " << db_filepathname_;
+    return false;
+  }
+  writer_ = db;
+  writer_busy_ = false;
+  closed_ = false;
+  return true;
+}
+
+void DatabasePool::Close() {
+  anx::common::AutoLock lock(&mutex_);
+  closed_ = true;
+  if (writer_ != nullptr && !writer_busy_) {
+    writer_->Close();
+  }
+  writer_ = nullptr;
+  for (auto& reader : idle_readers_) {
+    reader->Close();
+  }
+  opened_reader_count_ -= static_cast<int32_t>(idle_readers_.size());
+  idle_readers_.clear();
+  writer_cond_.broadcast();
+  reader_cond_.broadcast();
+}
+
+PooledDatabase DatabasePool::CheckoutWriter(int32_t timeout_ms) {
+  int64_t deadline_ms =
+      timeout_ms > 0 ? anx::common::GetCurrentTimeMillis() + timeout_ms : 0;
+  anx::common::AutoLock lock(&mutex_);
+  if (!closed_ && writer_busy_) {
+    checkout_waits_++;
+  }
+  while (!closed_ && writer_busy_) {
+    if (!WaitFor(&writer_cond_, deadline_ms)) {
+      LOG_F(LG_WARN) << "Checkout writer timeout: " << db_filepathname_;
+      return PooledDatabase();
+    }
+  }
+  if (closed_ || writer_ == nullptr) {
+    return PooledDatabase();
+  }
+  writer_busy_ = true;
+  return PooledDatabase(shared_from_this(), writer_, true);
+}
+
+PooledDatabase DatabasePool::CheckoutReader(int32_t timeout_ms) {
+  if (reader_count_ == 0) {
+    return CheckoutWriter(timeout_ms);
+  }
+  int64_t deadline_ms =
+      timeout_ms > 0 ? anx::common::GetCurrentTimeMillis() + timeout_ms : 0;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (!closed_ && idle_readers_.empty() &&
+        opened_reader_count_ >= reader_count_) {
+      checkout_waits_++;
+    }
+    while (!closed_ && idle_readers_.empty() &&
+           opened_reader_count_ >= reader_count_) {
+      if (!WaitFor(&reader_cond_, deadline_ms)) {
+        LOG_F(LG_WARN) << "Checkout reader timeout: " << db_filepathname_;
+        return PooledDatabase();
+      }
+    }
+    if (closed_) {
+      return PooledDatabase();
+    }
+    if (!idle_readers_.empty()) {
+      auto db = idle_readers_.back();
+      idle_readers_.pop_back();
+      return PooledDatabase(shared_from_this(), db, false);
+    }
+    /// reserve the slot, the file is opened out of the lock so the other
+    /// checkouts and returns don't wait for it.
+    opened_reader_count_++;
+  }
+  /// @note the journal mode and page size are set by the writer, a reader
+  /// only tunes its own cache and refuses to write.
+  DatabaseOptions reader_options = options_;
+  reader_options.journal_mode_.clear();
+  reader_options.page_size_ = 0;
+  auto db = std::make_shared<Database>(reader_options);
+  bool opened = db->Open(db_filepathname_);
+  if (opened) {
+    db->Execute("PRAGMA query_only = 1;");
+  } else {
+    LOG_F(LG_ERROR) << "Failed to open reader: " << db_filepathname_;
+  }
+  anx::common::AutoLock lock(&mutex_);
+  if (!opened || closed_) {
+    /// release the slot to the waiting checkouts
+    if (opened) {
+      db->Close();
+    }
+    opened_reader_count_--;
+    reader_cond_.signal();
+    return PooledDatabase();
+  }
+  return PooledDatabase(shared_from_this(), db, false);
+}
+
+int32_t DatabasePool::opened_reader_count() {
+  anx::common::AutoLock lock(&mutex_);
+  return opened_reader_count_;
+}
+
+int64_t DatabasePool::checkout_waits() {
+  anx::common::AutoLock lock(&mutex_);
+  return checkout_waits_;
+}
+
+void DatabasePool::Return(std::shared_ptr<Database> db, bool writer) {
+  anx::common::AutoLock lock(&mutex_);
+  if (writer) {
+    if (closed_ || db != writer_) {
+      db->Close();
+    }
+    writer_busy_ = false;
+    writer_cond_.signal();
+    return;
+  }
+  if (closed_) {
+    db->Close();
+    opened_reader_count_--;
+    return;
+  }
+  idle_readers_.push_back(db);
+  reader_cond_.signal();
+}
+
+bool DatabasePool::WaitFor(anx::common::Condition* cond, int64_t deadline_ms) {
+  if (deadline_ms <= 0) {
+    cond->wait(&mutex_);
+    return true;
+  }
+  int64_t remain_ms = deadline_ms - anx::common::GetCurrentTimeMillis();
+  if (remain_ms <= 0) {
+    return false;
+  }
+  cond->wait(&mutex_, static_cast<unsigned int>(remain_ms));
+  return true;
+}
+
+}  // namespace db
+}  // namespace anx
@@ -0,0 +1,140 @@
+/**
+ * @file database_pool.h
+ * @author hhool (hhool@outlook.com)
+ * @brief sqlite3 connection pool of one database file, one writer connection
+ * and several reader connections.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DB_DATABASE_POOL_H_
+#define APP_DB_DATABASE_POOL_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/db/database_impl.h"
+
+namespace anx {
+namespace db {
+
+class DatabasePool;
+
+/// @brief the connection checked out of the pool, the connection is returned
+/// to the pool when the object is destroyed. the connection must be used by
+/// one thread at a time.
+class PooledDatabase {
+ public:
+  PooledDatabase();
+  PooledDatabase(std::shared_ptr<DatabasePool> pool,
+                 std::shared_ptr<Database> db,
+                 bool writer);
+  ~PooledDatabase();
+
+  PooledDatabase(const PooledDatabase&) = delete;
+  PooledDatabase& operator=(const PooledDatabase&) = delete;
+
+  PooledDatabase(PooledDatabase&& other);
+  PooledDatabase& operator=(PooledDatabase&& other);
+
+ public:
+  /// @brief Return the connection to the pool before destroyed
+  void Return();
+
+  Database* get() const { return db_.get(); }
+  Database* operator->() const { return db_.get(); }
+  explicit operator bool() const { return db_ != nullptr; }
+
+  /// @brief Check the connection is the writer connection
+  bool is_writer() const { return writer_; }
+
+ private:
+  std::shared_ptr<DatabasePool> pool_;
+  std::shared_ptr<Database> db_;
+  bool writer_;
+};
+
+/// @brief the connection pool of one database file. there is one writer
+/// connection, the writes are serialized on it. the reader connections are
+/// opened on demand up to the reader count, with WAL the readers don't block
+/// the writer and see the last committed data.
+class DatabasePool : public std::enable_shared_from_this<DatabasePool> {
+ public:
+  /// @brief Constructor
+  /// @param db_filepathname the database file path name
+  /// @param reader_count the max reader connections, 0 if the readers share
+  /// the writer connection, e.g. the in-memory database
+  /// @param options the options of the writer connection
+  DatabasePool(const std::string& db_filepathname,
+               int32_t reader_count,
+               const DatabaseOptions& options);
+
+  /// @brief Destructor
+  ~DatabasePool();
+
+  DatabasePool(const DatabasePool&) = delete;
+  DatabasePool& operator=(const DatabasePool&) = delete;
+
+ public:
+  /// @brief Open the writer connection, the database file is created if not
+  /// exists.
+  /// @return true if success
+  bool Open();
+
+  /// @brief Close the pool, the idle connections are closed at once, the
+  /// checked out connections are closed when returned.
+  void Close();
+
+  /// @brief Check out the writer connection, wait if it's checked out by
+  /// other thread.
+  /// @param timeout_ms the max wait time in milliseconds, <= 0 wait forever
+  /// @return the connection, empty if timeout or the pool is closed
+  PooledDatabase CheckoutWriter(int32_t timeout_ms = kDefaultCheckoutTimeout);
+
+  /// @brief Check out a reader connection, wait if all readers are checked
+  /// out. the writer connection if the readers share it.
+  /// @param timeout_ms the max wait time in milliseconds, <= 0 wait forever
+  /// @return the connection, empty if timeout, failed or the pool is closed
+  PooledDatabase CheckoutReader(int32_t timeout_ms = kDefaultCheckoutTimeout);
+
+  /// @brief Get the database file path name
+  const std::string& db_filepathname() const { return db_filepathname_; }
+
+  /// @brief Get the count of the reader connections opened
+  int32_t opened_reader_count();
+
+  /// @brief Get the count of the checkouts which had to wait
+  int64_t checkout_waits();
+
+  /// @brief the default checkout timeout in milliseconds
+  static const int32_t kDefaultCheckoutTimeout = 5000;
+
+ private:
+  friend class PooledDatabase;
+  void Return(std::shared_ptr<Database> db, bool writer);
+  bool WaitFor(anx::common::Condition* cond, int64_t deadline_ms);
+
+ private:
+  std::string db_filepathname_;
+  int32_t reader_count_;
+  DatabaseOptions options_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition writer_cond_;
+  anx::common::Condition reader_cond_;
+  std::shared_ptr<Database> writer_;
+  bool writer_busy_;
+  std::vector<std::shared_ptr<Database>> idle_readers_;
+  int32_t opened_reader_count_;
+  int64_t checkout_waits_;
+  bool closed_;
+};
+
+}  // namespace db
+}  // namespace anx
+
+#endif  // APP_DB_DATABASE_POOL_H_
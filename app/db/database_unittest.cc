@@ -11,14 +11,41 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "app/common/file_utils.h"
+#include "app/common/module_utils.h"
+#include "app/common/time_utils.h"
 #include "app/db/database.h"
+#include "app/db/database_cursor.h"
+#include "app/db/database_factory.h"
+#include "app/db/database_helper.h"
+#include "app/db/database_impl.h"
+#include "app/db/database_mirror.h"
+#include "app/db/database_pool.h"
 
 namespace anx {
 namespace db {
 class DatabaseTest : public ::testing::Test {
  protected:
-  void SetUp() override {}
-  void TearDown() override {}
+  void SetUp() override {
+    db_folder_ = anx::common::GetModuleDir() + anx::common::kPathSeparator +
+                 "db_unittest";
+  }
+  void TearDown() override {
+    DatabaseFactory::Instance()->CloseAllDatabase();
+    helper::ResetCurrentExperimentDataBase();
+  }
+
+  std::string DbName(const std::string& name) {
+    return db_folder_ + anx::common::kPathSeparator + name;
+  }
+
+  std::string db_folder_;
 };
 
 static const char* create_table_sql =
@@ -31,6 +58,511 @@ static const char* query_sql_format_by_id_range =
 static const char* query_sql_format_by_date_range =
     "SELECT * FROM amp WHERE date >= %f AND date <= %f";
 
+TEST_F(DatabaseTest, OpenWithPragmas) {
+  std::string db_name = DbName("pragma.db");
+  helper::ClearDatabaseFile(db_name);
+  Database db;
+  ASSERT_TRUE(db.Open(db_name));
+  std::vector<std::map<std::string, std::string>> result;
+  ASSERT_TRUE(db.Query("PRAGMA journal_mode;", &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["journal_mode"], "wal");
+  result.clear();
+  ASSERT_TRUE(db.Query("PRAGMA synchronous;", &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["synchronous"], "1");
+  result.clear();
+  ASSERT_TRUE(db.Query("PRAGMA temp_store;", &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["temp_store"], "2");
+  db.Close();
+  helper::ClearDatabaseFile(db_name);
+}
+
+TEST_F(DatabaseTest, OpenKeepJournalMode) {
+  std::string db_name = DbName("journal.db");
+  helper::ClearDatabaseFile(db_name);
+  DatabaseOptions options;
+  options.journal_mode_.clear();
+  Database db(options);
+  ASSERT_TRUE(db.Open(db_name));
+  std::vector<std::map<std::string, std::string>> result;
+  ASSERT_TRUE(db.Query("PRAGMA journal_mode;", &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["journal_mode"], "delete");
+  db.Close();
+  helper::ClearDatabaseFile(db_name);
+}
+
+TEST_F(DatabaseTest, QueryNullValue) {
+  std::string db_name = DbName("null.db");
+  helper::ClearDatabaseFile(db_name);
+  Database db;
+  ASSERT_TRUE(db.Open(db_name));
+  ASSERT_TRUE(db.Execute(create_table_sql));
+  ASSERT_TRUE(db.Execute("INSERT INTO amp (cycle) VALUES (1)"));
+  std::vector<std::map<std::string, std::string>> result;
+  ASSERT_TRUE(db.Query("SELECT * FROM amp", &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["cycle"], "1");
+  EXPECT_EQ(result[0]["kHz"], "");
+  db.Close();
+  helper::ClearDatabaseFile(db_name);
+}
+
+TEST_F(DatabaseTest, ExperimentDataBase) {
+  helper::ClearDatabaseFile(DbName(helper::kCatalogDatabaseName));
+  EXPECT_EQ(helper::CurrentExperimentDataBase(),
+            helper::kDefaultDatabasePathname);
+  std::string db_name;
+  ASSERT_EQ(helper::CreateExperimentDataBase(db_folder_, 1000, &db_name), 0);
+  EXPECT_EQ(db_name, DbName("exp_1000.db"));
+  EXPECT_EQ(helper::CurrentExperimentDataBase(), db_name);
+  std::string sql_str = "INSERT INTO ";
+  sql_str += helper::kTableExpDataList;
+  sql_str += " (cycle, kHz, MPa, μm, date) VALUES (1, 20.0, 1.0, 2.0, 3.0)";
+  ASSERT_TRUE(helper::InsertDataTable(db_name, helper::kTableExpDataList,
+                                      sql_str));
+  ASSERT_TRUE(helper::FinishExperimentDataBase(db_name, 2000));
+  /// the WAL is checkpointed and removed on close
+  EXPECT_FALSE(anx::common::FileExists(db_name + "-wal"));
+  /// the finished database stays the current one for the data pages
+  EXPECT_EQ(helper::CurrentExperimentDataBase(), db_name);
+
+  std::vector<std::map<std::string, std::string>> result;
+  ASSERT_TRUE(helper::QueryDataBase(db_name, helper::kTableExpDataList,
+                                    "SELECT * FROM exp_data_list", &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["cycle"], "1");
+
+  result.clear();
+  ASSERT_TRUE(helper::QueryExperimentCatalog(db_folder_, &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["db_name"], "exp_1000.db");
+  EXPECT_EQ(result[0]["start_time"], "1000");
+  EXPECT_EQ(result[0]["end_time"], "2000");
+  EXPECT_EQ(result[0]["state"], "1");
+
+  helper::ResetCurrentExperimentDataBase();
+  EXPECT_EQ(helper::CurrentExperimentDataBase(),
+            helper::kDefaultDatabasePathname);
+  DatabaseFactory::Instance()->CloseAllDatabase();
+  helper::ClearDatabaseFile(db_name);
+  helper::ClearDatabaseFile(DbName(helper::kCatalogDatabaseName));
+}
+
+TEST_F(DatabaseTest, ExperimentDataBaseKeptOnSameStartTime) {
+  helper::ClearDatabaseFile(DbName(helper::kCatalogDatabaseName));
+  std::string db_name;
+  ASSERT_EQ(helper::CreateExperimentDataBase(db_folder_, 1500, &db_name), 0);
+  std::string sql_str = "INSERT INTO ";
+  sql_str += helper::kTableExpDataList;
+  sql_str += " (cycle, kHz, MPa, μm, date) VALUES (1, 20.0, 1.0, 2.0, 3.0)";
+  ASSERT_TRUE(helper::InsertDataTable(db_name, helper::kTableExpDataList,
+                                      sql_str));
+  ASSERT_TRUE(helper::FinishExperimentDataBase(db_name, 2500));
+
+  /// the run of the same start time is not replaced
+  std::string db_name_again;
+  EXPECT_EQ(helper::CreateExperimentDataBase(db_folder_, 1500, &db_name_again),
+            -5);
+  EXPECT_TRUE(db_name_again.empty());
+  std::vector<std::map<std::string, std::string>> result;
+  ASSERT_TRUE(helper::QueryDataBase(db_name, helper::kTableExpDataList,
+                                    "SELECT * FROM exp_data_list", &result));
+  EXPECT_EQ(result.size(), 1u);
+  result.clear();
+  ASSERT_TRUE(helper::QueryExperimentCatalog(db_folder_, &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["end_time"], "2500");
+  EXPECT_EQ(result[0]["state"], "1");
+
+  helper::ResetCurrentExperimentDataBase();
+  DatabaseFactory::Instance()->CloseAllDatabase();
+  helper::ClearDatabaseFile(db_name);
+  helper::ClearDatabaseFile(DbName(helper::kCatalogDatabaseName));
+}
+
+TEST_F(DatabaseTest, QueryExperimentDataBases) {
+  helper::ClearDatabaseFile(DbName(helper::kCatalogDatabaseName));
+  /// more databases than can be attached at once
+  const int32_t kExpCount = 12;
+  std::vector<std::string> db_names;
+  std::vector<std::string> file_names;
+  for (int32_t i = 0; i < kExpCount; i++) {
+    std::string db_name;
+    ASSERT_EQ(helper::CreateExperimentDataBase(db_folder_, i, &db_name), 0);
+    for (int32_t j = 0; j <= i; j++) {
+      std::string sql_str =
+          "INSERT INTO exp_data_graph (cycle, kHz, MPa, μm, state, date) "
+          "VALUES (";
+      sql_str += std::to_string(j);
+      sql_str += ", 20.0, 1.0, 2.0, 1, 3.0)";
+      ASSERT_TRUE(helper::InsertDataTable(db_name, helper::kTableExpDataGraph,
+                                          sql_str));
+    }
+    ASSERT_TRUE(helper::FinishExperimentDataBase(db_name, i + 1));
+    db_names.push_back(db_name);
+    file_names.push_back("exp_" + std::to_string(i) + ".db");
+  }
+  std::vector<std::map<std::string, std::string>> result;
+  ASSERT_TRUE(helper::QueryExperimentDataBases(
+      db_folder_, file_names, helper::kTableExpDataGraph, "cycle = 0",
+      &result));
+  ASSERT_EQ(result.size(), static_cast<size_t>(kExpCount));
+  for (int32_t i = 0; i < kExpCount; i++) {
+    EXPECT_EQ(result[i]["db_name"], file_names[i]);
+  }
+  result.clear();
+  ASSERT_TRUE(helper::QueryExperimentDataBases(
+      db_folder_, file_names, helper::kTableExpDataGraph, "", &result));
+  EXPECT_EQ(result.size(),
+            static_cast<size_t>(kExpCount * (kExpCount + 1) / 2));
+
+  DatabaseFactory::Instance()->CloseAllDatabase();
+  for (auto& db_name : db_names) {
+    helper::ClearDatabaseFile(db_name);
+  }
+  helper::ClearDatabaseFile(DbName(helper::kCatalogDatabaseName));
+}
+
+TEST_F(DatabaseTest, CursorPages) {
+  helper::ClearDatabaseFile(DbName(helper::kCatalogDatabaseName));
+  std::string db_name;
+  ASSERT_EQ(helper::CreateExperimentDataBase(db_folder_, 3000, &db_name), 0);
+  const int32_t kRowCount = 100;
+  ASSERT_TRUE(helper::ExecuteDataBase(db_name, "BEGIN;"));
+  for (int32_t i = 1; i <= kRowCount; i++) {
+    std::string sql_str =
+        "INSERT INTO exp_data_graph (cycle, kHz, MPa, μm, state, date) "
+        "VALUES (";
+    sql_str += std::to_string(i * 10);
+    sql_str += ", 20.0, 1.0, 2.0, 1, ";
+    sql_str += std::to_string(i * 0.5);
+    sql_str += ")";
+    ASSERT_TRUE(helper::InsertDataTable(db_name, helper::kTableExpDataGraph,
+                                        sql_str));
+  }
+  ASSERT_TRUE(helper::ExecuteDataBase(db_name, "COMMIT;"));
+
+  DatabaseCursor cursor(db_name, helper::kTableExpDataGraph);
+  EXPECT_EQ(cursor.MaxId(), kRowCount);
+  std::vector<std::map<std::string, std::string>> result;
+  ASSERT_TRUE(cursor.NextPage(0, 30, &result));
+  ASSERT_EQ(result.size(), 30u);
+  EXPECT_EQ(cursor.first_id(), 1);
+  EXPECT_EQ(cursor.last_id(), 30);
+  ASSERT_TRUE(cursor.NextPage(cursor.last_id(), 30, &result));
+  EXPECT_EQ(cursor.first_id(), 31);
+  EXPECT_EQ(cursor.last_id(), 60);
+  ASSERT_TRUE(cursor.PrePage(cursor.first_id(), 30, &result));
+  EXPECT_EQ(cursor.first_id(), 1);
+  EXPECT_EQ(cursor.last_id(), 30);
+  EXPECT_EQ(result[0]["id"], "1");
+
+  ASSERT_TRUE(cursor.TailPage(30, &result));
+  ASSERT_EQ(result.size(), 30u);
+  EXPECT_EQ(cursor.first_id(), 71);
+  EXPECT_EQ(cursor.last_id(), 100);
+  ASSERT_TRUE(cursor.NextPage(cursor.last_id(), 30, &result));
+  EXPECT_TRUE(result.empty());
+
+  ASSERT_TRUE(cursor.SeekByTime(25.2, 10, &result));
+  ASSERT_EQ(result.size(), 10u);
+  EXPECT_EQ(cursor.first_id(), 51);
+  EXPECT_EQ(cursor.IdOfTime(1000.0), -1);
+  ASSERT_TRUE(cursor.SeekByTime(1000.0, 10, &result));
+  EXPECT_TRUE(result.empty());
+
+  ASSERT_TRUE(cursor.SeekByCycle(995, 10, &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(cursor.first_id(), 100);
+
+  /// the time and cycle lookups use the indexes
+  const char* plans[] = {
+      "EXPLAIN QUERY PLAN SELECT id FROM exp_data_graph WHERE date >= 1.0 "
+      "ORDER BY date ASC LIMIT 1",
+      "EXPLAIN QUERY PLAN SELECT id FROM exp_data_graph WHERE cycle >= 1 "
+      "ORDER BY cycle ASC LIMIT 1"};
+  const char* indexes[] = {"exp_data_graph_date", "exp_data_graph_cycle"};
+  for (int32_t i = 0; i < 2; i++) {
+    result.clear();
+    ASSERT_TRUE(helper::QueryDataBase(db_name, helper::kTableExpDataGraph,
+                                      plans[i], &result));
+    ASSERT_FALSE(result.empty());
+    EXPECT_NE(result[0]["detail"].find(indexes[i]), std::string::npos);
+  }
+
+  DatabaseFactory::Instance()->CloseAllDatabase();
+  helper::ClearDatabaseFile(db_name);
+  helper::ClearDatabaseFile(DbName(helper::kCatalogDatabaseName));
+}
+
+TEST_F(DatabaseTest, PreparedStatement) {
+  std::string db_name = DbName("prepared.db");
+  helper::ClearDatabaseFile(db_name);
+  Database db;
+  ASSERT_TRUE(db.Open(db_name));
+  ASSERT_TRUE(db.Execute(create_table_sql));
+  const char* insert_sql =
+      "INSERT INTO amp (cycle, kHz, MPa, μm, date) VALUES (?, ?, ?, ?, ?)";
+  for (int32_t i = 0; i < 10; i++) {
+    std::vector<DatabaseValue> params;
+    params.push_back(static_cast<int64_t>(i * 1000000000LL));
+    params.push_back(20.5);
+    params.push_back("1.5");
+    params.push_back(DatabaseValue());
+    params.push_back(0.1 * i);
+    ASSERT_TRUE(db.Execute(insert_sql, params));
+  }
+  EXPECT_EQ(db.statement_cache_misses(), 1);
+  EXPECT_EQ(db.statement_cache_hits(), 9);
+  /// parameter count mismatch
+  EXPECT_FALSE(db.Execute(insert_sql, std::vector<DatabaseValue>()));
+
+  std::vector<std::map<std::string, std::string>> result;
+  std::vector<DatabaseValue> params;
+  params.push_back(5);
+  ASSERT_TRUE(db.Query("SELECT * FROM amp WHERE id > ? ORDER BY id", params,
+                       &result));
+  ASSERT_EQ(result.size(), 5u);
+  EXPECT_EQ(result[0]["cycle"], "5000000000");
+  EXPECT_EQ(result[0]["MPa"], "1.5");
+  EXPECT_EQ(result[0]["μm"], "");
+  db.Close();
+  helper::ClearDatabaseFile(db_name);
+}
+
+TEST_F(DatabaseTest, PoolCheckout) {
+  std::string db_name = DbName("pool.db");
+  helper::ClearDatabaseFile(db_name);
+  auto pool = std::make_shared<DatabasePool>(db_name, 2, DatabaseOptions());
+  ASSERT_TRUE(pool->Open());
+  {
+    auto writer = pool->CheckoutWriter();
+    ASSERT_TRUE(writer);
+    EXPECT_TRUE(writer.is_writer());
+    EXPECT_TRUE(writer->Execute(create_table_sql));
+    /// the writer is exclusive
+    EXPECT_FALSE(pool->CheckoutWriter(50));
+    EXPECT_EQ(pool->checkout_waits(), 1);
+  }
+  EXPECT_TRUE(pool->CheckoutWriter(50));
+  {
+    auto reader0 = pool->CheckoutReader();
+    auto reader1 = pool->CheckoutReader();
+    ASSERT_TRUE(reader0);
+    ASSERT_TRUE(reader1);
+    EXPECT_EQ(pool->opened_reader_count(), 2);
+    /// all readers are checked out
+    EXPECT_FALSE(pool->CheckoutReader(50));
+    /// readers refuse to write
+    EXPECT_FALSE(reader0->Execute("INSERT INTO amp (cycle) VALUES (1)"));
+    reader1.Return();
+    EXPECT_TRUE(pool->CheckoutReader(50));
+  }
+  EXPECT_EQ(pool->opened_reader_count(), 2);
+  {
+    /// the readers opened at once don't exceed the reader count
+    auto wide = std::make_shared<DatabasePool>(db_name, 3, DatabaseOptions());
+    ASSERT_TRUE(wide->Open());
+    std::atomic<int32_t> checked_out(0);
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < 6; i++) {
+      threads.push_back(std::thread([&]() {
+        auto reader = wide->CheckoutReader(2000);
+        if (reader) {
+          checked_out++;
+        }
+      }));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(checked_out, 6);
+    EXPECT_LE(wide->opened_reader_count(), 3);
+    EXPECT_GE(wide->opened_reader_count(), 1);
+    wide->Close();
+  }
+  pool->Close();
+  EXPECT_FALSE(pool->CheckoutWriter(50));
+  EXPECT_FALSE(pool->CheckoutReader(50));
+  EXPECT_EQ(pool->opened_reader_count(), 0);
+  helper::ClearDatabaseFile(db_name);
+}
+
+TEST_F(DatabaseTest, PoolConcurrentReadWrite) {
+  std::string db_name = DbName("concurrent.db");
+  helper::ClearDatabaseFile(db_name);
+  ASSERT_TRUE(helper::ExecuteDataBase(db_name, create_table_sql));
+  const int32_t kRowCount = 400;
+  const char* insert_sql = "INSERT INTO amp (cycle, date) VALUES (?, ?)";
+  std::atomic<bool> writer_done(false);
+  std::atomic<int32_t> failures(0);
+  std::thread writer([&]() {
+    for (int32_t i = 0; i < kRowCount; i++) {
+      std::vector<DatabaseValue> params;
+      params.push_back(i);
+      params.push_back(i * 0.5);
+      if (!helper::InsertDataTable(db_name, "amp", insert_sql, params)) {
+        failures++;
+      }
+    }
+    writer_done = true;
+  });
+  std::vector<std::thread> readers;
+  for (int32_t i = 0; i < 3; i++) {
+    readers.push_back(std::thread([&]() {
+      int64_t pre_count = 0;
+      while (!writer_done) {
+        std::vector<std::map<std::string, std::string>> result;
+        if (!helper::QueryDataBase(db_name, "amp",
+                                   "SELECT COUNT(*) AS count FROM amp",
+                                   &result) ||
+            result.size() != 1) {
+          failures++;
+          continue;
+        }
+        int64_t count = std::stoll(result[0]["count"]);
+        if (count < pre_count) {
+          failures++;
+        }
+        pre_count = count;
+      }
+    }));
+  }
+  writer.join();
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(failures, 0);
+  std::vector<std::map<std::string, std::string>> result;
+  ASSERT_TRUE(helper::QueryDataBase(
+      db_name, "amp", "SELECT COUNT(*) AS count FROM amp", &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["count"], std::to_string(kRowCount));
+  helper::CloseDataBase(db_name);
+  helper::ClearDatabaseFile(db_name);
+}
+
+namespace {
+/// @brief Count the rows of the amp table in the file, read by a connection
+/// of its own.
+int64_t CountFileRows(const std::string& db_name) {
+  Database db;
+  if (!db.Open(db_name)) {
+    return -1;
+  }
+  std::vector<std::map<std::string, std::string>> result;
+  if (!db.Query("SELECT COUNT(*) AS count FROM amp", &result) ||
+      result.size() != 1) {
+    return -1;
+  }
+  return std::stoll(result[0]["count"]);
+}
+
+bool InsertRows(const std::string& db_name, int32_t begin, int32_t end) {
+  for (int32_t i = begin; i < end; i++) {
+    std::vector<DatabaseValue> params;
+    params.push_back(i);
+    params.push_back(i * 0.5);
+    if (!helper::InsertDataTable(db_name, "amp",
+                                 "INSERT INTO amp (cycle, date) VALUES (?, ?)",
+                                 params)) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+TEST_F(DatabaseTest, PoolReadersShareWriter) {
+  auto pool = std::make_shared<DatabasePool>(kMemoryDatabaseName, 0,
+                                             DatabaseOptions());
+  ASSERT_TRUE(pool->Open());
+  {
+    auto writer = pool->CheckoutWriter();
+    ASSERT_TRUE(writer);
+    EXPECT_TRUE(writer->Execute(create_table_sql));
+    /// the reader waits the writer
+    EXPECT_FALSE(pool->CheckoutReader(50));
+  }
+  auto reader = pool->CheckoutReader(50);
+  ASSERT_TRUE(reader);
+  EXPECT_TRUE(reader.is_writer());
+  std::vector<std::map<std::string, std::string>> result;
+  EXPECT_TRUE(reader->Query("SELECT * FROM amp", &result));
+  EXPECT_EQ(pool->opened_reader_count(), 0);
+  reader.Return();
+  pool->Close();
+}
+
+TEST_F(DatabaseTest, MirrorBackupOnRequestAndClose) {
+  std::string db_name = DbName("mirror.db");
+  helper::ClearDatabaseFile(db_name);
+  ASSERT_TRUE(helper::ExecuteDataBase(db_name, create_table_sql));
+  ASSERT_TRUE(InsertRows(db_name, 0, 10));
+  ASSERT_TRUE(helper::MirrorExperimentDataBase(db_name, 0));
+  EXPECT_FALSE(helper::BackupExperimentDataBase(DbName("none.db")));
+  /// the rows in the file are loaded, the new rows stay in the memory
+  ASSERT_TRUE(InsertRows(db_name, 10, 100));
+  std::vector<std::map<std::string, std::string>> result;
+  ASSERT_TRUE(helper::QueryDataBase(
+      db_name, "amp", "SELECT COUNT(*) AS count FROM amp", &result));
+  ASSERT_EQ(result.size(), 1u);
+  EXPECT_EQ(result[0]["count"], "100");
+  EXPECT_EQ(CountFileRows(db_name), 10);
+  ASSERT_TRUE(helper::BackupExperimentDataBase(db_name));
+  EXPECT_EQ(CountFileRows(db_name), 100);
+  auto mirror = DatabaseFactory::Instance()->GetDatabaseMirror(db_name);
+  ASSERT_NE(mirror, nullptr);
+  EXPECT_EQ(mirror->backups(), 1);
+  /// the close backs up the rest
+  ASSERT_TRUE(InsertRows(db_name, 100, 150));
+  helper::CloseDataBase(db_name);
+  EXPECT_EQ(DatabaseFactory::Instance()->GetDatabaseMirror(db_name), nullptr);
+  EXPECT_EQ(mirror->backups(), 2);
+  EXPECT_EQ(CountFileRows(db_name), 150);
+  /// the file is used again after the close
+  ASSERT_TRUE(InsertRows(db_name, 150, 151));
+  helper::CloseDataBase(db_name);
+  EXPECT_EQ(CountFileRows(db_name), 151);
+  helper::ClearDatabaseFile(db_name);
+}
+
+TEST_F(DatabaseTest, MirrorBackupInBackground) {
+  std::string db_name = DbName("mirror_background.db");
+  helper::ClearDatabaseFile(db_name);
+  ASSERT_TRUE(helper::ExecuteDataBase(db_name, create_table_sql));
+  helper::CloseDataBase(db_name);
+  DatabaseMirrorOptions options;
+  options.backup_interval_ms = 20;
+  options.pages_per_step = 1;
+  auto mirror =
+      DatabaseFactory::Instance()->CreateOrGetDatabaseMirror(db_name, options);
+  ASSERT_NE(mirror, nullptr);
+  EXPECT_EQ(
+      DatabaseFactory::Instance()->CreateOrGetDatabaseMirror(db_name, options),
+      mirror);
+  /// the writes go on beside the backups of one page a step
+  std::atomic<bool> done(false);
+  std::thread writer([&]() {
+    InsertRows(db_name, 0, 2000);
+    done = true;
+  });
+  while (!done || mirror->backups() < 2) {
+    anx::common::sleep_ms(5);
+  }
+  writer.join();
+  int64_t backups = mirror->backups();
+  while (mirror->backups() == backups) {
+    anx::common::sleep_ms(5);
+  }
+  EXPECT_EQ(CountFileRows(db_name), 2000);
+  EXPECT_GT(mirror->last_backup_ms(), 0);
+  helper::CloseDataBase(db_name);
+  helper::ClearDatabaseFile(db_name);
+}
 
-}  // namespace common
+}  // namespace db
 }  // namespace anx
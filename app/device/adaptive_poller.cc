@@ -0,0 +1,126 @@
+/**
+ * @file adaptive_poller.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the adaptive poll interval of the device
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/adaptive_poller.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+namespace anx {
+namespace device {
+
+namespace {
+double Clamp01(double value) {
+  return std::min(1.0, std::max(0.0, value));
+}
+}  // namespace
+
+AdaptivePoller::AdaptivePoller(const AdaptivePollerOptions& options)
+    : options_(options),
+      floor_interval_ms_(0),
+      interval_ms_(0),
+      reference_(0),
+      boost_until_ms_(0),
+      primed_(false),
+      last_ms_(0),
+      last_value_(0),
+      variance_(0),
+      slope_(0),
+      urgency_(0) {
+  if (options_.baud_rate <= 0) {
+    options_.baud_rate = 9600;
+  }
+  if (options_.line_budget <= 0 || options_.line_budget > 1) {
+    options_.line_budget = 0.5;
+  }
+  if (options_.alpha <= 0 || options_.alpha > 1) {
+    options_.alpha = 0.2;
+  }
+  /// the polls use at most the budget of the line, 10 bits a byte
+  double line_ms = std::max(0, options_.bytes_per_poll) * 10 * 1000.0 /
+                   options_.baud_rate / options_.line_budget;
+  floor_interval_ms_ = std::max(std::max(1, options_.min_interval_ms),
+                                static_cast<int32_t>(ceil(line_ms)));
+  options_.min_interval_ms = floor_interval_ms_;
+  options_.max_interval_ms =
+      std::max(options_.max_interval_ms, floor_interval_ms_);
+  interval_ms_ = options_.max_interval_ms;
+}
+
+AdaptivePoller::~AdaptivePoller() {}
+
+void AdaptivePoller::Reset(double reference) {
+  reference_ = reference;
+  primed_ = false;
+  variance_ = 0;
+  slope_ = 0;
+  urgency_ = 0;
+}
+
+void AdaptivePoller::Boost(int64_t until_ms) {
+  boost_until_ms_ = std::max(boost_until_ms_, until_ms);
+}
+
+int32_t AdaptivePoller::Update(int64_t now_ms,
+                               double value,
+                               int64_t deadline_ms) {
+  const double alpha = options_.alpha;
+  if (!primed_) {
+    primed_ = true;
+  } else {
+    /// the variance of the residuals to the trend, the drift is not noise
+    double dt_ms =
+        static_cast<double>(std::max<int64_t>(1, now_ms - last_ms_));
+    double residual = value - (last_value_ + slope_ * dt_ms);
+    variance_ += alpha * (residual * residual - variance_);
+    slope_ += alpha * ((value - last_value_) / dt_ms - slope_);
+  }
+  last_ms_ = now_ms;
+  last_value_ = value;
+
+  double urgency = 0;
+  if (options_.varying_stddev > options_.flat_stddev) {
+    urgency = Clamp01((sqrt(variance_) - options_.flat_stddev) /
+                      (options_.varying_stddev - options_.flat_stddev));
+  }
+  if (options_.limit > 0) {
+    /// the deviation now or projected over the horizon, urgent from the half
+    /// of the limit to the limit
+    double projected = value + slope_ * options_.horizon_ms;
+    double deviation = std::max(fabs(value - reference_),
+                                fabs(projected - reference_));
+    urgency = std::max(urgency, Clamp01(deviation / options_.limit * 2 - 1));
+  }
+  if (now_ms < boost_until_ms_) {
+    urgency = 1;
+  }
+  urgency_ = urgency;
+
+  int32_t range_ms = options_.max_interval_ms - options_.min_interval_ms;
+  int32_t target_ms = options_.max_interval_ms -
+                      static_cast<int32_t>(range_ms * urgency + 0.5);
+  if (target_ms < interval_ms_) {
+    interval_ms_ = target_ms;
+  } else {
+    /// slow down by half at a time, the flat signal may turn again
+    interval_ms_ = std::min(target_ms, interval_ms_ + interval_ms_ / 2 + 1);
+  }
+  int32_t next_ms = interval_ms_;
+  if (deadline_ms > now_ms && deadline_ms - now_ms < next_ms) {
+    next_ms = std::max(floor_interval_ms_,
+                       static_cast<int32_t>(deadline_ms - now_ms));
+  }
+  return next_ms;
+}
+
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,100 @@
+/**
+ * @file adaptive_poller.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the adaptive poll interval of the device, the polls are faster when
+ * the signal varies or drifts to the limit and slower when it is flat, within
+ * the share of the line budgeted for the polls.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_ADAPTIVE_POLLER_H_
+#define APP_DEVICE_ADAPTIVE_POLLER_H_
+
+#include <stdint.h>
+
+namespace anx {
+namespace device {
+
+struct AdaptivePollerOptions {
+  /// @brief the interval of the urgent signal
+  int32_t min_interval_ms = 20;
+  /// @brief the interval of the flat signal
+  int32_t max_interval_ms = 500;
+  /// @brief the bytes on the line of one poll, the requests and the responses
+  int32_t bytes_per_poll = 30;
+  /// @brief the baud rate of the line, 10 bits a byte
+  int32_t baud_rate = 9600;
+  /// @brief the max share of the line used by the polls
+  double line_budget = 0.5;
+  /// @brief the max deviation of the value from the reference, e.g. the
+  /// frequency fluctuation range, 0 disables the drift.
+  double limit = 0;
+  /// @brief the standard deviation of the flat and of the varying signal
+  double flat_stddev = 2;
+  double varying_stddev = 20;
+  /// @brief the drift is projected over the horizon to the limit
+  int32_t horizon_ms = 2000;
+  /// @brief the weight of the new value in the moving averages
+  double alpha = 0.2;
+};
+
+////////////////////////////////////////////////////////////
+// clz AdaptivePoller
+/// @brief the urgency of the signal is the max of the variability around the
+/// trend, the trend projected to the limit and the boost, e.g. at the start.
+/// the interval follows the urgency down at once and up by half at a time.
+class AdaptivePoller {
+ public:
+  explicit AdaptivePoller(const AdaptivePollerOptions& options);
+  ~AdaptivePoller();
+
+ public:
+  /// @brief Reset the averages
+  /// @param reference the value the drift is measured from
+  void Reset(double reference);
+
+  /// @brief Poll at the min interval until the time, e.g. the start and the
+  /// transitions of the clips.
+  void Boost(int64_t until_ms);
+
+  /// @brief Update with the value polled
+  /// @param now_ms the time of the poll
+  /// @param value the value polled
+  /// @param deadline_ms the next poll is not after the time, e.g. the next
+  /// transition of the clips, or at the floor interval if it is closer. 0 if
+  /// none.
+  /// @return the interval to the next poll
+  int32_t Update(int64_t now_ms, double value, int64_t deadline_ms = 0);
+
+  /// @brief Get the current interval without the deadline
+  int32_t interval_ms() const { return interval_ms_; }
+  /// @brief Get the min interval of the line budget
+  int32_t floor_interval_ms() const { return floor_interval_ms_; }
+  /// @brief Get the urgency of the last update in [0, 1]
+  double urgency() const { return urgency_; }
+
+ private:
+  AdaptivePollerOptions options_;
+  int32_t floor_interval_ms_;
+  int32_t interval_ms_;
+  double reference_;
+  int64_t boost_until_ms_;
+  /// @brief the moving averages, valid after the first update
+  bool primed_;
+  int64_t last_ms_;
+  double last_value_;
+  /// @brief the variance of the residuals to the trend
+  double variance_;
+  /// @brief the change of the value a millisecond
+  double slope_;
+  double urgency_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_ADAPTIVE_POLLER_H_
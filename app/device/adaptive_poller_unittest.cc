@@ -0,0 +1,139 @@
+/**
+ * @file adaptive_poller_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the adaptive poller unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/adaptive_poller.h"
+
+#include <gtest/gtest.h>
+
+namespace anx {
+namespace device {
+
+namespace {
+const double kReference = 20000;
+
+AdaptivePollerOptions FastLine() {
+  AdaptivePollerOptions options;
+  options.min_interval_ms = 20;
+  options.max_interval_ms = 500;
+  options.baud_rate = 115200;
+  options.limit = 500;
+  return options;
+}
+
+/// @brief Poll the values of the signal at the intervals returned
+/// @return the last interval
+template <typename Signal>
+int32_t PollFor(AdaptivePoller* poller,
+            int64_t* now_ms,
+            int64_t duration_ms,
+            Signal signal) {
+  int32_t interval_ms = poller->interval_ms();
+  int64_t end_ms = *now_ms + duration_ms;
+  while (*now_ms < end_ms) {
+    interval_ms = poller->Update(*now_ms, signal(*now_ms));
+    *now_ms += interval_ms;
+  }
+  return interval_ms;
+}
+}  // namespace
+
+TEST(AdaptivePollerTest, LineBudgetFloor) {
+  AdaptivePollerOptions options;
+  options.min_interval_ms = 5;
+  options.bytes_per_poll = 30;
+  options.baud_rate = 9600;
+  options.line_budget = 0.5;
+  /// 300 bits at 9600 baud is 31.25 ms, the half of the line
+  EXPECT_EQ(AdaptivePoller(options).floor_interval_ms(), 63);
+  options.baud_rate = 115200;
+  EXPECT_EQ(AdaptivePoller(options).floor_interval_ms(), 6);
+  options.max_interval_ms = 3;
+  AdaptivePoller poller(options);
+  EXPECT_EQ(poller.interval_ms(), 6);
+  poller.Boost(1000);
+  EXPECT_EQ(poller.Update(0, kReference), 6);
+}
+
+TEST(AdaptivePollerTest, FlatSignalSlowsDown) {
+  AdaptivePoller poller(FastLine());
+  poller.Reset(kReference);
+  int64_t now_ms = 0;
+  int32_t interval_ms =
+      PollFor(&poller, &now_ms, 10000, [](int64_t) { return kReference + 1; });
+  EXPECT_EQ(interval_ms, 500);
+  EXPECT_DOUBLE_EQ(poller.urgency(), 0);
+}
+
+TEST(AdaptivePollerTest, VaryingSignalSpeedsUp) {
+  AdaptivePoller poller(FastLine());
+  poller.Reset(kReference);
+  int64_t now_ms = 0;
+  PollFor(&poller, &now_ms, 5000, [](int64_t) { return kReference; });
+  ASSERT_EQ(poller.interval_ms(), 500);
+  /// the generator hunts around the resonance
+  int32_t sign = 1;
+  int32_t interval_ms = PollFor(&poller, &now_ms, 2000, [&sign](int64_t) {
+    sign = -sign;
+    return kReference + sign * 60.0;
+  });
+  EXPECT_EQ(interval_ms, 20);
+  EXPECT_DOUBLE_EQ(poller.urgency(), 1);
+  /// flat again, the interval grows back by half at a time
+  int32_t previous_ms = poller.interval_ms();
+  int64_t end_ms = now_ms + 10000;
+  while (now_ms < end_ms) {
+    interval_ms = poller.Update(now_ms, kReference);
+    EXPECT_LE(interval_ms, previous_ms + previous_ms / 2 + 1);
+    previous_ms = interval_ms;
+    now_ms += interval_ms;
+  }
+  EXPECT_EQ(interval_ms, 500);
+}
+
+TEST(AdaptivePollerTest, DriftTowardLimitSpeedsUp) {
+  AdaptivePoller poller(FastLine());
+  poller.Reset(kReference);
+  int64_t now_ms = 0;
+  PollFor(&poller, &now_ms, 5000, [](int64_t) { return kReference; });
+  int64_t start_ms = now_ms;
+  /// 50 Hz a second to the limit of 500 Hz, the variance is low
+  auto drift = [start_ms](int64_t t) {
+    return kReference + (t - start_ms) * 0.05;
+  };
+  int32_t interval_ms = PollFor(&poller, &now_ms, 2000, drift);
+  EXPECT_LT(poller.urgency(), 0.5);
+  EXPECT_GT(interval_ms, 250);
+  /// the projection nears the limit long before the value, at 300 Hz
+  interval_ms = PollFor(&poller, &now_ms, 4000, drift);
+  EXPECT_LT(drift(now_ms) - kReference, 350);
+  EXPECT_GT(poller.urgency(), 0.5);
+  EXPECT_LT(interval_ms, 250);
+}
+
+TEST(AdaptivePollerTest, BoostAndDeadline) {
+  AdaptivePoller poller(FastLine());
+  poller.Reset(kReference);
+  poller.Boost(1000);
+  EXPECT_EQ(poller.Update(0, kReference), 20);
+  EXPECT_EQ(poller.Update(500, kReference), 20);
+  EXPECT_GT(poller.Update(1000, kReference), 20);
+  int64_t now_ms = 1000;
+  PollFor(&poller, &now_ms, 5000, [](int64_t) { return kReference; });
+  ASSERT_EQ(poller.interval_ms(), 500);
+  /// the next clip transition in 120 ms, and closer than the floor
+  EXPECT_EQ(poller.Update(now_ms, kReference, now_ms + 120), 120);
+  EXPECT_EQ(poller.Update(now_ms, kReference, now_ms + 5), 20);
+  EXPECT_EQ(poller.Update(now_ms, kReference, now_ms - 5), 500);
+  EXPECT_EQ(poller.interval_ms(), 500);
+}
+
+}  // namespace device
+}  // namespace anx
@@ -161,14 +161,35 @@ class DeviceComInterface {
                             int32_t write_size,
                             uint8_t* read_buffer,
                             int32_t read_size) = 0;
+  /// @brief  Wait until the data can be read from the device com
+  /// @param timeout_ms  max wait time ms
+  /// @return int32_t  1 readable, 0 timeout, -1 canceled or failed, -2 not
+  /// supported and the caller polls Read
+  virtual int32_t WaitReadable(int32_t timeout_ms) { return -2; }
+  /// @brief  Wake up the thread waiting in WaitReadable
+  virtual void CancelWait() {}
 };
 
 ////////////////////////////////////////////////////////////
+/// @brief the delivery of the data events to the listener
+enum DeviceComDelivery {
+  /// @brief called on the thread of Read and Write
+  kDeviceComDeliverySync = 0,
+  /// @brief called on the thread of the listener from its queue, the slow
+  /// listener never stalls the device io, the events are dropped when the
+  /// queue is full.
+  kDeviceComDeliveryAsync = 1,
+};
+
 class DeviceComListener {
  public:
   DeviceComListener() = default;
   virtual ~DeviceComListener() = default;
 
+  /// @brief  Get the delivery of the events, read once when the listener is
+  /// added.
+  virtual DeviceComDelivery Delivery() const { return kDeviceComDeliverySync; }
+
   /// @brief  On data received
   /// @param data  data buffer
   /// @param size  data buffer size
@@ -0,0 +1,361 @@
+/**
+ * @file device_com_dispatcher.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief dispatch the data events of the device com to the listeners
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/device_com_dispatcher.h"
+
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <utility>
+
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+struct DeviceComEvent {
+  bool outgoing;
+  std::vector<uint8_t> data;
+};
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// clz DeviceComDispatcher::Subscriber
+
+class DeviceComDispatcher::Subscriber : public anx::common::Runnable {
+ public:
+  Subscriber(DeviceComInterface* device,
+             DeviceComListener* listener,
+             DeviceComDelivery delivery,
+             size_t queue_capacity)
+      : device_(device),
+        listener_(listener),
+        delivery_(delivery),
+        queue_capacity_(queue_capacity),
+        removed_(false),
+        active_(0),
+        busy_(false),
+        delivered_(0),
+        dropped_(0),
+        dropped_bytes_(0),
+        max_queued_(0) {
+    if (delivery_ == kDeviceComDeliveryAsync) {
+      thread_.reset(new anx::common::Thread(this));
+      thread_->start();
+    }
+  }
+
+  ~Subscriber() override { Stop(); }
+
+  DeviceComListener* listener() const { return listener_; }
+
+  /// @brief Deliver on the publisher thread or queue the event
+  void Publish(bool outgoing, const uint8_t* data, int32_t size) {
+    if (delivery_ == kDeviceComDeliverySync) {
+      /// the remover waits for the active deliveries
+      active_++;
+      if (!removed_) {
+        Deliver(outgoing, data, size);
+      }
+      active_--;
+      return;
+    }
+    anx::common::AutoLock lock(&mutex_);
+    if (removed_) {
+      return;
+    }
+    if (queue_.size() >= queue_capacity_) {
+      dropped_++;
+      dropped_bytes_ += size;
+      return;
+    }
+    queue_.push_back(DeviceComEvent{outgoing, std::vector<uint8_t>()});
+    queue_.back().data.assign(data, data + size);
+    if (queue_.size() > max_queued_) {
+      max_queued_ = queue_.size();
+    }
+    cond_.signal();
+  }
+
+  /// @brief Stop the delivery, wait for the active delivery unless called
+  /// from the delivery itself.
+  /// @return false if the thread of the listener is to be joined later
+  bool Remove() {
+    bool on_thread = (current_ == this);
+    {
+      anx::common::AutoLock lock(&mutex_);
+      removed_ = true;
+      dropped_ += static_cast<int64_t>(queue_.size());
+      for (auto& it : queue_) {
+        dropped_bytes_ += static_cast<int64_t>(it.data.size());
+      }
+      queue_.clear();
+      if (on_thread) {
+        /// the thread exits after the delivery returns
+        stop_ = true;
+      }
+      cond_.broadcast();
+    }
+    if (on_thread) {
+      return thread_ == nullptr;
+    }
+    while (active_ > 0) {
+      std::this_thread::yield();
+    }
+    Stop();
+    return true;
+  }
+
+  /// @brief Check the queue is empty and no event is being delivered
+  bool Idle() {
+    anx::common::AutoLock lock(&mutex_);
+    return queue_.empty() && !busy_;
+  }
+
+  void Stats(DeviceComListenerStats* stats) {
+    anx::common::AutoLock lock(&mutex_);
+    stats->delivered = delivered_;
+    stats->dropped = dropped_;
+    stats->dropped_bytes = dropped_bytes_;
+    stats->max_queued = max_queued_;
+  }
+
+  void interrupt() override {
+    anx::common::AutoLock lock(&mutex_);
+    stop_ = true;
+    cond_.broadcast();
+  }
+  bool is_interrupt() override {
+    anx::common::AutoLock lock(&mutex_);
+    return stop_;
+  }
+
+ protected:
+  void run() override {
+    current_ = this;
+    for (;;) {
+      DeviceComEvent event;
+      {
+        anx::common::AutoLock lock(&mutex_);
+        while (!stop_ && queue_.empty()) {
+          cond_.wait(&mutex_);
+        }
+        if (stop_) {
+          break;
+        }
+        event = std::move(queue_.front());
+        queue_.pop_front();
+        busy_ = true;
+      }
+      Deliver(event.outgoing, event.data.data(),
+              static_cast<int32_t>(event.data.size()));
+      anx::common::AutoLock lock(&mutex_);
+      busy_ = false;
+    }
+    current_ = nullptr;
+  }
+
+ private:
+  void Deliver(bool outgoing, const uint8_t* data, int32_t size) {
+    Subscriber* previous = current_;
+    current_ = this;
+    if (outgoing) {
+      listener_->OnDataOutgoing(device_, data, size);
+    } else {
+      listener_->OnDataReceived(device_, data, size);
+    }
+    current_ = previous;
+    anx::common::AutoLock lock(&mutex_);
+    delivered_++;
+  }
+
+  void Stop() {
+    if (thread_ == nullptr) {
+      return;
+    }
+    interrupt();
+    thread_->join();
+    thread_.reset();
+  }
+
+ private:
+  /// @brief the subscriber delivering on the current thread
+  static thread_local Subscriber* current_;
+
+  DeviceComInterface* device_;
+  DeviceComListener* listener_;
+  DeviceComDelivery delivery_;
+  size_t queue_capacity_;
+  std::atomic<bool> removed_;
+  std::atomic<int32_t> active_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  std::deque<DeviceComEvent> queue_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  bool busy_;
+  int64_t delivered_;
+  int64_t dropped_;
+  int64_t dropped_bytes_;
+  size_t max_queued_;
+};
+
+thread_local DeviceComDispatcher::Subscriber*
+    DeviceComDispatcher::Subscriber::current_ = nullptr;
+
+////////////////////////////////////////////////////////////////////////////////
+// clz DeviceComDispatcher
+
+DeviceComDispatcher::DeviceComDispatcher(DeviceComInterface* device,
+                                         size_t queue_capacity)
+    : device_(device),
+      queue_capacity_(queue_capacity),
+      subscribers_(std::make_shared<SubscriberList>()) {}
+
+DeviceComDispatcher::~DeviceComDispatcher() {
+  RemoveAll();
+  JoinRetired();
+}
+
+void DeviceComDispatcher::AddListener(DeviceComListener* listener) {
+  AddListener(listener, listener->Delivery());
+}
+
+void DeviceComDispatcher::AddListener(DeviceComListener* listener,
+                                      DeviceComDelivery delivery) {
+  LOG_F(LG_INFO) << "listener added: " << listener << " delivery:" << delivery;
+  anx::common::AutoLock lock(&mutex_);
+  std::shared_ptr<const SubscriberList> current = Snapshot();
+  for (auto& it : *current) {
+    if (it->listener() == listener) {
+      return;
+    }
+  }
+  std::shared_ptr<SubscriberList> updated =
+      std::make_shared<SubscriberList>(*current);
+  updated->push_back(std::make_shared<Subscriber>(device_, listener, delivery,
+                                                  queue_capacity_));
+  std::atomic_store(&subscribers_,
+                    std::shared_ptr<const SubscriberList>(updated));
+}
+
+void DeviceComDispatcher::RemoveListener(DeviceComListener* listener) {
+  LOG_F(LG_INFO) << "listen remove:" << listener;
+  std::shared_ptr<Subscriber> removed;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    std::shared_ptr<const SubscriberList> current = Snapshot();
+    std::shared_ptr<SubscriberList> updated =
+        std::make_shared<SubscriberList>();
+    for (auto& it : *current) {
+      if (it->listener() == listener) {
+        removed = it;
+      } else {
+        updated->push_back(it);
+      }
+    }
+    if (removed == nullptr) {
+      return;
+    }
+    std::atomic_store(&subscribers_,
+                      std::shared_ptr<const SubscriberList>(updated));
+  }
+  if (!removed->Remove()) {
+    /// removed from its own thread, joined later
+    anx::common::AutoLock lock(&mutex_);
+    retired_.push_back(removed);
+  }
+}
+
+void DeviceComDispatcher::RemoveAll() {
+  std::shared_ptr<const SubscriberList> current;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    current = Snapshot();
+    std::atomic_store(&subscribers_, std::shared_ptr<const SubscriberList>(
+                                         std::make_shared<SubscriberList>()));
+  }
+  for (auto& it : *current) {
+    if (!it->Remove()) {
+      anx::common::AutoLock lock(&mutex_);
+      retired_.push_back(it);
+    }
+  }
+}
+
+void DeviceComDispatcher::PublishReceived(const uint8_t* data, int32_t size) {
+  Publish(false, data, size);
+}
+
+void DeviceComDispatcher::PublishOutgoing(const uint8_t* data, int32_t size) {
+  Publish(true, data, size);
+}
+
+bool DeviceComDispatcher::Flush(int32_t timeout_ms) {
+  int64_t deadline_ms = anx::common::GetCurrentTimeMillis() + timeout_ms;
+  std::shared_ptr<const SubscriberList> current = Snapshot();
+  for (auto& it : *current) {
+    while (!it->Idle()) {
+      if (anx::common::GetCurrentTimeMillis() >= deadline_ms) {
+        return false;
+      }
+      anx::common::sleep_ms(1);
+    }
+  }
+  return true;
+}
+
+bool DeviceComDispatcher::GetStats(DeviceComListener* listener,
+                                   DeviceComListenerStats* stats) const {
+  std::shared_ptr<const SubscriberList> current = Snapshot();
+  for (auto& it : *current) {
+    if (it->listener() == listener) {
+      it->Stats(stats);
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t DeviceComDispatcher::size() const {
+  return Snapshot()->size();
+}
+
+void DeviceComDispatcher::Publish(bool outgoing,
+                                  const uint8_t* data,
+                                  int32_t size) {
+  if (data == nullptr || size <= 0) {
+    return;
+  }
+  std::shared_ptr<const SubscriberList> current = Snapshot();
+  for (auto& it : *current) {
+    it->Publish(outgoing, data, size);
+  }
+}
+
+std::shared_ptr<const DeviceComDispatcher::SubscriberList>
+DeviceComDispatcher::Snapshot() const {
+  return std::atomic_load(&subscribers_);
+}
+
+void DeviceComDispatcher::JoinRetired() {
+  SubscriberList retired;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    retired.swap(retired_);
+  }
+  /// the destructor joins the thread
+  retired.clear();
+}
+
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,108 @@
+/**
+ * @file device_com_dispatcher.h
+ * @author hhool (hhool@outlook.com)
+ * @brief dispatch the data events of the device com to the listeners, the
+ * listener list is copy on write and the async listeners have their queues.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_DEVICE_COM_DISPATCHER_H_
+#define APP_DEVICE_DEVICE_COM_DISPATCHER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/device/device_com.h"
+
+namespace anx {
+namespace device {
+
+/// @brief the max events queued of the async listener
+const size_t kDeviceComListenerQueueSize = 1024;
+
+/// @brief the delivery counters of the listener
+struct DeviceComListenerStats {
+  /// @brief the events delivered
+  int64_t delivered = 0;
+  /// @brief the events dropped for the queue full
+  int64_t dropped = 0;
+  int64_t dropped_bytes = 0;
+  /// @brief the max events queued
+  size_t max_queued = 0;
+};
+
+/// @brief the publisher never locks, it iterates the snapshot of the
+/// listener list. AddListener and RemoveListener copy the list and swap the
+/// snapshot. after RemoveListener returns the listener is not called any
+/// more, it may be called from the listener itself.
+class DeviceComDispatcher {
+ public:
+  /// @brief Constructor
+  /// @param device the device passed to the listeners, not owned
+  /// @param queue_capacity the max events queued of the async listener
+  explicit DeviceComDispatcher(
+      DeviceComInterface* device,
+      size_t queue_capacity = kDeviceComListenerQueueSize);
+  ~DeviceComDispatcher();
+
+  DeviceComDispatcher(const DeviceComDispatcher&) = delete;
+  DeviceComDispatcher& operator=(const DeviceComDispatcher&) = delete;
+
+ public:
+  /// @brief Add the listener with DeviceComListener::Delivery
+  void AddListener(DeviceComListener* listener);
+  /// @brief Add the listener with the delivery, the listener added is not
+  /// changed.
+  void AddListener(DeviceComListener* listener, DeviceComDelivery delivery);
+  /// @brief Remove the listener, the events queued are dropped
+  void RemoveListener(DeviceComListener* listener);
+  void RemoveAll();
+
+  /// @brief Publish the bytes received to the listeners
+  void PublishReceived(const uint8_t* data, int32_t size);
+  /// @brief Publish the bytes written to the listeners
+  void PublishOutgoing(const uint8_t* data, int32_t size);
+
+  /// @brief Wait for the events queued delivered to the async listeners
+  /// @param timeout_ms the max wait time
+  /// @return true if all delivered
+  bool Flush(int32_t timeout_ms);
+
+  /// @brief Get the delivery counters of the listener
+  /// @return true if the listener is added
+  bool GetStats(DeviceComListener* listener,
+                DeviceComListenerStats* stats) const;
+
+  /// @brief Get the count of the listeners
+  size_t size() const;
+
+ private:
+  class Subscriber;
+  typedef std::vector<std::shared_ptr<Subscriber>> SubscriberList;
+
+  void Publish(bool outgoing, const uint8_t* data, int32_t size);
+  std::shared_ptr<const SubscriberList> Snapshot() const;
+  /// @brief Join the async listeners removed from their own threads
+  void JoinRetired();
+
+ private:
+  DeviceComInterface* device_;
+  size_t queue_capacity_;
+  /// @brief serialize the writers of the list
+  anx::common::Mutex mutex_;
+  std::shared_ptr<const SubscriberList> subscribers_;
+  SubscriberList retired_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_DEVICE_COM_DISPATCHER_H_
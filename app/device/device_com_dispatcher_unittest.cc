@@ -0,0 +1,194 @@
+/**
+ * @file device_com_dispatcher_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief dispatch the data events of the device com to the listeners unit
+ * test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/device_com_dispatcher.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+class TestListener : public DeviceComListener {
+ public:
+  void OnDataReceived(DeviceComInterface* device,
+                      const uint8_t* data,
+                      int32_t size) override {
+    OnEvent(device, data, size);
+  }
+  void OnDataOutgoing(DeviceComInterface* device,
+                      const uint8_t* data,
+                      int32_t size) override {
+    outgoing_++;
+    OnEvent(device, data, size);
+  }
+
+  virtual void OnEvent(DeviceComInterface* device,
+                       const uint8_t* data,
+                       int32_t size) {
+    if (removed_) {
+      late_++;
+    }
+    if (!gate_) {
+      anx::common::sleep_ms(1);
+      while (!gate_) {
+        std::this_thread::yield();
+      }
+    }
+    device_ = device;
+    bytes_.insert(bytes_.end(), data, data + size);
+    events_++;
+  }
+
+  std::atomic<bool> gate_{true};
+  std::atomic<bool> removed_{false};
+  std::atomic<int32_t> events_{0};
+  std::atomic<int32_t> outgoing_{0};
+  std::atomic<int32_t> late_{0};
+  DeviceComInterface* device_ = nullptr;
+  std::vector<uint8_t> bytes_;
+};
+
+/// @brief the listener removes itself at the first event
+class SelfRemovingListener : public TestListener {
+ public:
+  explicit SelfRemovingListener(DeviceComDispatcher* dispatcher)
+      : dispatcher_(dispatcher) {}
+  void OnEvent(DeviceComInterface* device,
+               const uint8_t* data,
+               int32_t size) override {
+    events_++;
+    dispatcher_->RemoveListener(this);
+  }
+  DeviceComDispatcher* dispatcher_;
+};
+
+DeviceComInterface* const kDevice = reinterpret_cast<DeviceComInterface*>(1);
+}  // namespace
+
+TEST(DeviceComDispatcherTest, SyncDelivery) {
+  DeviceComDispatcher dispatcher(kDevice);
+  TestListener listener;
+  dispatcher.AddListener(&listener);
+  dispatcher.AddListener(&listener);
+  EXPECT_EQ(dispatcher.size(), 1u);
+  const uint8_t data[] = {1, 2, 3};
+  dispatcher.PublishReceived(data, 2);
+  dispatcher.PublishOutgoing(data + 2, 1);
+  dispatcher.PublishReceived(data, 0);
+  EXPECT_EQ(listener.events_, 2);
+  EXPECT_EQ(listener.outgoing_, 1);
+  EXPECT_EQ(listener.device_, kDevice);
+  EXPECT_EQ(listener.bytes_, std::vector<uint8_t>(data, data + 3));
+  DeviceComListenerStats stats;
+  ASSERT_TRUE(dispatcher.GetStats(&listener, &stats));
+  EXPECT_EQ(stats.delivered, 2);
+  EXPECT_EQ(stats.dropped, 0);
+  dispatcher.RemoveListener(&listener);
+  EXPECT_FALSE(dispatcher.GetStats(&listener, &stats));
+  dispatcher.PublishReceived(data, 3);
+  EXPECT_EQ(listener.events_, 2);
+}
+
+TEST(DeviceComDispatcherTest, SlowAsyncListenerNeverBlocks) {
+  const size_t kCapacity = 16;
+  const int32_t kEvents = 2000;
+  DeviceComDispatcher dispatcher(kDevice, kCapacity);
+  TestListener slow;
+  TestListener fast;
+  slow.gate_ = false;
+  dispatcher.AddListener(&slow, kDeviceComDeliveryAsync);
+  dispatcher.AddListener(&fast);
+  auto start = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i < kEvents; i++) {
+    uint8_t value = static_cast<uint8_t>(i);
+    dispatcher.PublishReceived(&value, 1);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  EXPECT_LT(elapsed, 500);
+  EXPECT_EQ(fast.events_, kEvents);
+
+  slow.gate_ = true;
+  ASSERT_TRUE(dispatcher.Flush(2000));
+  DeviceComListenerStats stats;
+  ASSERT_TRUE(dispatcher.GetStats(&slow, &stats));
+  EXPECT_GT(stats.dropped, 0);
+  EXPECT_EQ(stats.dropped, stats.dropped_bytes);
+  EXPECT_EQ(stats.delivered + stats.dropped, kEvents);
+  EXPECT_EQ(stats.max_queued, kCapacity);
+  EXPECT_EQ(slow.events_, stats.delivered);
+  /// the events delivered keep the order
+  for (size_t i = 1; i < slow.bytes_.size(); i++) {
+    EXPECT_LT(slow.bytes_[i - 1], slow.bytes_[i]);
+    if (slow.bytes_[i - 1] >= slow.bytes_[i]) {
+      break;
+    }
+  }
+}
+
+TEST(DeviceComDispatcherTest, RemoveWhilePublishing) {
+  DeviceComDispatcher dispatcher(kDevice);
+  std::atomic<bool> stopped(false);
+  std::thread publisher([&dispatcher, &stopped]() {
+    uint8_t value = 0;
+    while (!stopped) {
+      dispatcher.PublishReceived(&value, 1);
+    }
+  });
+  for (int32_t i = 0; i < 200; i++) {
+    TestListener sync_listener;
+    TestListener async_listener;
+    dispatcher.AddListener(&sync_listener);
+    dispatcher.AddListener(&async_listener, kDeviceComDeliveryAsync);
+    anx::common::sleep_ms(i % 2);
+    dispatcher.RemoveListener(&sync_listener);
+    dispatcher.RemoveListener(&async_listener);
+    sync_listener.removed_ = true;
+    async_listener.removed_ = true;
+    anx::common::sleep_ms(i % 2);
+    ASSERT_EQ(sync_listener.late_, 0);
+    ASSERT_EQ(async_listener.late_, 0);
+  }
+  stopped = true;
+  publisher.join();
+  EXPECT_EQ(dispatcher.size(), 0u);
+}
+
+TEST(DeviceComDispatcherTest, RemoveFromListener) {
+  DeviceComDispatcher dispatcher(kDevice);
+  SelfRemovingListener sync_listener(&dispatcher);
+  SelfRemovingListener async_listener(&dispatcher);
+  dispatcher.AddListener(&sync_listener);
+  dispatcher.AddListener(&async_listener, kDeviceComDeliveryAsync);
+  const uint8_t data[] = {1};
+  dispatcher.PublishReceived(data, 1);
+  EXPECT_EQ(sync_listener.events_, 1);
+  for (int32_t i = 0; i < 1000 && dispatcher.size() > 0; i++) {
+    anx::common::sleep_ms(1);
+  }
+  EXPECT_EQ(dispatcher.size(), 0u);
+  dispatcher.PublishReceived(data, 1);
+  EXPECT_EQ(sync_listener.events_, 1);
+  EXPECT_EQ(async_listener.events_, 1);
+}
+
+}  // namespace device
+}  // namespace anx
@@ -12,9 +12,17 @@
 
 #include "app/device/device_com_factory.h"
 
+#include <stdint.h>
+
+#include <string>
+
 #include "app/device/device_com_impl.h"
+#if !defined(_WIN32)
+#include "app/device/device_com_posix_impl.h"
+#endif
 #include "app/device/device_com_settings.h"
 #include "app/device/device_com_settings_helper.h"
+#include "app/device/device_com_tcp_impl.h"
 
 #include "third_party/CSerialPort/source/include/CSerialPort/SerialPort.h"
 #include "third_party/CSerialPort/source/include/CSerialPort/SerialPortInfo.h"
@@ -22,6 +30,42 @@
 namespace anx {
 namespace device {
 
+namespace {
+/// @brief the serial port device com, CSerialPort on windows, termios and
+/// epoll on the others.
+std::shared_ptr<DeviceComInterface> CreateComPortDevice(
+    const std::string& name) {
+#if defined(_WIN32)
+  return std::make_shared<ComPortDeviceImpl>(name);
+#else
+  return std::make_shared<ComPortDevicePosixImpl>(name);
+#endif
+}
+
+/// @brief the device com of the address type of the settings, modbus tcp
+/// for the lan address, e.g. the generator behind a modbus gateway, and the
+/// serial port for the com address.
+std::shared_ptr<DeviceComInterface> CreateDeviceComWithSettings(
+    const std::string& name,
+    const ComSettings& com_settings) {
+  ComPortDevice* com_port_device = com_settings.GetComPortDevice();
+  if (com_port_device != nullptr && com_port_device->GetComPort() != nullptr &&
+      com_port_device->GetComPort()->adrtype == 2) {
+    return std::make_shared<ComPortDeviceTcpImpl>(name);
+  }
+  return CreateComPortDevice(name);
+}
+
+/// @brief the device name of the station, e.g. ul for the default station
+/// and ul.s2 for the station 2.
+std::string StationDeviceName(int32_t station, const std::string& name) {
+  if (station == kDefaultStation) {
+    return name;
+  }
+  return name + ".s" + std::to_string(station);
+}
+}  // namespace
+
 DeviceComFactory* DeviceComFactory::instance_ = nullptr;
 ////////////////////////////////////////////////////////////////////////////////
 DeviceComFactory* DeviceComFactory::Instance() {
@@ -44,6 +88,7 @@ void DeviceComFactory::ReleaseInstance() {
 DeviceComFactory::DeviceComFactory() {}
 
 DeviceComFactory::~DeviceComFactory() {
+  anx::common::AutoLock lock(&mutex_);
   for (auto& it : device_com_map_) {
     it.second->Close();
   }
@@ -73,68 +118,112 @@ std::vector<ComPortDevice> DeviceComFactory::GetComPortDeviceList() {
 std::shared_ptr<DeviceComInterface>
 DeviceComFactory::CreateOrGetDeviceComWithType(int32_t device_com_type,
                                                DeviceComListener* listener) {
+  return CreateOrGetDeviceComWithType(kDefaultStation, device_com_type,
+                                      listener);
+}
+
+int32_t DeviceComFactory::OpenDeviceComWithType(int32_t device_com_type) {
+  return OpenDeviceComWithType(kDefaultStation, device_com_type);
+}
+
+void DeviceComFactory::CloseDeviceComWithType(int32_t device_com_type) {
+  CloseDeviceComWithType(kDefaultStation, device_com_type);
+}
+
+std::shared_ptr<DeviceComInterface>
+DeviceComFactory::CreateOrGetDeviceComWithType(int32_t station,
+                                               int32_t device_com_type,
+                                               DeviceComListener* listener) {
+  anx::common::AutoLock lock(&mutex_);
   // find the device com pointer from the ,
-  auto it = device_com_map_.find(device_com_type);
+  auto it = device_com_map_.find(DeviceComKey(station, device_com_type));
   if (it != device_com_map_.end()) {
     // add the listener to the device com
     if (listener != nullptr) {
-      ComPortDeviceImpl* device_com_impl =
-          reinterpret_cast<ComPortDeviceImpl*>(it->second.get());
-      device_com_impl->AddListener(listener);
+      it->second->AddListener(listener);
     }
     return it->second;
   }
 
   std::unique_ptr<ComSettings> com_settings =
-      LoadDeviceComSettingsDefaultResourceWithType(device_com_type);
+      LoadDeviceComSettingsDefaultResourceWithType(device_com_type, station);
   if (com_settings == nullptr) {
     return nullptr;
   }
   // create the device com pointer
   std::shared_ptr<DeviceComInterface> device_com;
   if (device_com_type == kDeviceCom_Ultrasound) {
-    device_com = std::make_shared<ComPortDeviceImpl>("ul");
+    device_com = CreateDeviceComWithSettings(StationDeviceName(station, "ul"),
+                                             *com_settings);
   } else if (device_com_type == kDeviceCom_StaticLoad) {
-    device_com = std::make_shared<ComPortDeviceImpl>("sl");
+    device_com = CreateDeviceComWithSettings(StationDeviceName(station, "sl"),
+                                             *com_settings);
   } else if (device_com_type == kDeviceLan_StaticLoad) {
-    device_com = std::make_shared<ComPortDeviceImpl>("sl2");
+    device_com = std::make_shared<ComPortDeviceTcpImpl>(
+        StationDeviceName(station, "sl2"));
   } else {
     return nullptr;
   }
 
   // add the listener to the device com
   if (listener != nullptr) {
-    ComPortDeviceImpl* device_com_impl =
-        reinterpret_cast<ComPortDeviceImpl*>(device_com.get());
-    device_com_impl->AddListener(listener);
+    device_com->AddListener(listener);
   }
   // store the device com pointer to DeviceComManager
-  device_com_map_[device_com_type] = device_com;
+  device_com_map_[DeviceComKey(station, device_com_type)] = device_com;
   return device_com;
 }
 
-int32_t DeviceComFactory::OpenDeviceComWithType(int32_t device_com_type) {
+int32_t DeviceComFactory::OpenDeviceComWithType(int32_t station,
+                                                int32_t device_com_type) {
   std::unique_ptr<ComSettings> com_settings =
-      LoadDeviceComSettingsDefaultResourceWithType(device_com_type);
+      LoadDeviceComSettingsDefaultResourceWithType(device_com_type, station);
   if (com_settings == nullptr) {
     return -1;
   }
   // find the device com pointer from the map
-  auto it = device_com_map_.find(device_com_type);
-  if (it != device_com_map_.end()) {
-    // open the device com
-    return it->second->Open(
-        *(reinterpret_cast<ComPortDevice*>(com_settings.get())));
+  std::shared_ptr<DeviceComInterface> device_com;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    auto it = device_com_map_.find(DeviceComKey(station, device_com_type));
+    if (it == device_com_map_.end()) {
+      return -2;
+    }
+    device_com = it->second;
   }
-  return -2;
+  // open the device com without the lock, a slow port of one station
+  // doesn't hold the others.
+  return device_com->Open(*com_settings->GetComPortDevice());
 }
 
-void DeviceComFactory::CloseDeviceComWithType(int32_t device_com_type) {
+void DeviceComFactory::CloseDeviceComWithType(int32_t station,
+                                              int32_t device_com_type) {
   // find the device com pointer from the map
-  auto it = device_com_map_.find(device_com_type);
-  if (it != device_com_map_.end()) {
-    // close the device com
-    it->second->Close();
+  std::shared_ptr<DeviceComInterface> device_com;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    auto it = device_com_map_.find(DeviceComKey(station, device_com_type));
+    if (it == device_com_map_.end()) {
+      return;
+    }
+    device_com = it->second;
+  }
+  // close the device com
+  device_com->Close();
+}
+
+void DeviceComFactory::ReleaseStation(int32_t station) {
+  std::vector<std::shared_ptr<DeviceComInterface>> released;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    auto it = device_com_map_.lower_bound(DeviceComKey(station, INT32_MIN));
+    while (it != device_com_map_.end() && it->first.first == station) {
+      released.push_back(it->second);
+      it = device_com_map_.erase(it);
+    }
+  }
+  for (auto& it : released) {
+    it->Close();
   }
 }
 
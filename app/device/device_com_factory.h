@@ -16,13 +16,19 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "app/common/thread.h"
 #include "app/device/device_com.h"
 
 namespace anx {
 namespace device {
 
+/// @brief the station of the single rig, the methods without the station
+/// work on it.
+const int32_t kDefaultStation = 0;
+
 class DeviceComFactory {
  public:
   DeviceComFactory();
@@ -62,13 +68,41 @@ class DeviceComFactory {
   /// @param device_com_type the device com type
   void CloseDeviceComWithType(int32_t device_com_type);
 
+ public:
+  /// @brief Create the device com of the station, each station has its own
+  /// device com of the type and its own settings file.
+  /// @param station the station id, kDefaultStation is the single rig
+  /// @param device_com_type the device com type
+  /// @return the device com pointer
+  std::shared_ptr<DeviceComInterface> CreateOrGetDeviceComWithType(
+      int32_t station,
+      int32_t device_com_type,
+      DeviceComListener* listener);
+
+  /// @brief Open the device com of the station with the device type
+  /// @return 0 if success, -1 if the settings failed, -2 if not created, the
+  /// error of Open otherwise
+  int32_t OpenDeviceComWithType(int32_t station, int32_t device_com_type);
+
+  /// @brief Close the device com of the station with the device type
+  void CloseDeviceComWithType(int32_t station, int32_t device_com_type);
+
+  /// @brief Close and release all the device coms of the station
+  void ReleaseStation(int32_t station);
+
+ private:
+  /// @brief the station id and the device com type
+  typedef std::pair<int32_t, int32_t> DeviceComKey;
+
  private:
   /// @brief the instance of the DeviceComFactory
   static DeviceComFactory* instance_;
+  /// @brief the stations are created and opened on their own threads
+  anx::common::Mutex mutex_;
   /// @brief device com interface shared pointer map list,
-  /// key is the device com type, value is the device com interface shared
-  /// pointer
-  std::map<int32_t, std::shared_ptr<DeviceComInterface>> device_com_map_;
+  /// key is the station and the device com type, value is the device com
+  /// interface shared pointer
+  std::map<DeviceComKey, std::shared_ptr<DeviceComInterface>> device_com_map_;
 
   std::map<int32_t, std::shared_ptr<DeviceComListener>>
       device_com_listener_map_;
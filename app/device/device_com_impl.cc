@@ -82,7 +82,8 @@ itas109::FlowControl toItas109FlowControl(int flow_control) {
 }
 }  // namespace
 
-ComPortDeviceImpl::ComPortDeviceImpl(std::string name) : name_(name) {
+ComPortDeviceImpl::ComPortDeviceImpl(std::string name)
+    : name_(name), dispatcher_(this) {
   std::unique_ptr<itas109::CSerialPort> native_serialport(
       new itas109::CSerialPort());
   native_serialport_ = native_serialport.release();
@@ -96,25 +97,11 @@ ComPortDeviceImpl::~ComPortDeviceImpl() {
 }
 
 void ComPortDeviceImpl::AddListener(DeviceComListener* listener) {
-  LOG_F(LG_INFO) << "listener added: " << listener;
-  // find the listener from the list
-  for (auto& it : listeners_) {
-    if (it == listener) {
-      return;
-    }
-  }
-  listeners_.push_back(listener);
+  dispatcher_.AddListener(listener);
 }
 
 void ComPortDeviceImpl::RemoveListener(DeviceComListener* listener) {
-  LOG_F(LG_INFO) << "listen remove:" << listener;
-  // find the listener from the list
-  for (auto it = listeners_.begin(); it != listeners_.end(); ++it) {
-    if (*it == listener) {
-      listeners_.erase(it);
-      return;
-    }
-  }
+  dispatcher_.RemoveListener(listener);
 }
 
 int32_t ComPortDeviceImpl::Open(const ComPortDevice& com_port) {
@@ -183,9 +170,7 @@ int32_t ComPortDeviceImpl::Read(uint8_t* buffer, int32_t size) {
       reinterpret_cast<itas109::CSerialPort*>(native_serialport_);
   int readed = native_serialport->readData(buffer, size);
   if (readed > 0) {
-    for (auto& it : listeners_) {
-      it->OnDataReceived(this, buffer, readed);
-    }
+    dispatcher_.PublishReceived(buffer, readed);
   }
   return readed;
 }
@@ -200,9 +185,7 @@ int32_t ComPortDeviceImpl::Write(const uint8_t* buffer, int32_t size) {
   int written =
       native_serialport->writeData(reinterpret_cast<const void*>(buffer), size);
   if (written > 0) {
-    for (auto& it : listeners_) {
-      it->OnDataOutgoing(this, buffer, written);
-    }
+    dispatcher_.PublishOutgoing(buffer, written);
   }
   return written;
 }
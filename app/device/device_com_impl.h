@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "app/device/device_com.h"
+#include "app/device/device_com_dispatcher.h"
 
 namespace anx {
 namespace device {
@@ -46,13 +47,15 @@ class ComPortDeviceImpl : public DeviceComInterface {
  public:
   const std::string GetName() const;
   const ComPortDevice& GetComPortDevice() const;
+  /// @brief Get the dispatcher for the delivery counters of the listeners
+  const DeviceComDispatcher& dispatcher() const { return dispatcher_; }
 
  protected:
   std::string name_;
   ComPortDevice com_port_device_;
   DeviceComListener* listener_;
   void* native_serialport_;
-  std::vector<DeviceComListener*> listeners_;
+  DeviceComDispatcher dispatcher_;
 };
 
 }  // namespace device
@@ -0,0 +1,354 @@
+/**
+ * @file device_com_posix_impl.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief device com implementation on termios and epoll
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/device_com_posix_impl.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "app/common/logger.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+speed_t ToSpeed(int32_t baud_rate) {
+  switch (baud_rate) {
+    case 1200:
+      return B1200;
+    case 2400:
+      return B2400;
+    case 4800:
+      return B4800;
+    case 9600:
+      return B9600;
+    case 19200:
+      return B19200;
+    case 38400:
+      return B38400;
+    case 57600:
+      return B57600;
+    case 115200:
+      return B115200;
+    case 230400:
+      return B230400;
+    default:
+      return B0;
+  }
+}
+
+tcflag_t ToDataBits(int32_t data_bits) {
+  switch (data_bits) {
+    case 0:
+      return CS5;
+    case 1:
+      return CS6;
+    case 2:
+      return CS7;
+    default:
+      return CS8;
+  }
+}
+
+/// @brief the parity and stop bits and flow control to termios, the same
+/// values as the itas109 conversion of ComPortDeviceImpl.
+void SetFraming(const ComAddressPort& com_adr_port, struct termios* tio) {
+  tio->c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB | CRTSCTS);
+  tio->c_iflag &= ~(IXON | IXOFF | IXANY | INPCK);
+  tio->c_cflag |= ToDataBits(com_adr_port.data_bits) | CLOCAL | CREAD;
+  switch (com_adr_port.parity) {
+    case 1:
+      tio->c_cflag |= PARENB | PARODD;
+      tio->c_iflag |= INPCK;
+      break;
+    case 2:
+      tio->c_cflag |= PARENB;
+      tio->c_iflag |= INPCK;
+      break;
+#if defined(CMSPAR)
+    case 3:
+      tio->c_cflag |= PARENB | PARODD | CMSPAR;
+      break;
+    case 4:
+      tio->c_cflag |= PARENB | CMSPAR;
+      break;
+#endif
+    default:
+      break;
+  }
+  /// no 1.5 stop bits on termios, 2 stop bits are used
+  if (com_adr_port.stop_bits == 2 || com_adr_port.stop_bits == 3) {
+    tio->c_cflag |= CSTOPB;
+  }
+  if (com_adr_port.flow_control == 1) {
+    tio->c_cflag |= CRTSCTS;
+  } else if (com_adr_port.flow_control == 2) {
+    tio->c_iflag |= IXON | IXOFF;
+  }
+}
+}  // namespace
+
+ComPortDevicePosixImpl::ComPortDevicePosixImpl(std::string name)
+    : name_(name),
+      dispatcher_(this),
+      fd_(-1),
+      epoll_fd_(-1),
+      event_fd_(-1),
+      min_bytes_(0),
+      inter_byte_timeout_ms_(0),
+      write_timeout_ms_(1000) {}
+
+ComPortDevicePosixImpl::~ComPortDevicePosixImpl() {
+  Close();
+}
+
+void ComPortDevicePosixImpl::AddListener(DeviceComListener* listener) {
+  dispatcher_.AddListener(listener);
+}
+
+void ComPortDevicePosixImpl::RemoveListener(DeviceComListener* listener) {
+  dispatcher_.RemoveListener(listener);
+}
+
+int32_t ComPortDevicePosixImpl::Open(const ComPortDevice& com_port) {
+  if (com_port.GetComPort()->adrtype != 1) {
+    LOG_F(LG_ERROR) << "adrtype is not 1";
+    return -1;
+  }
+  ComAddressPort* com_adr_port =
+      reinterpret_cast<ComAddressPort*>(com_port.GetComPort());
+  speed_t speed = ToSpeed(com_adr_port->baud_rate);
+  if (speed == B0) {
+    LOG_F(LG_ERROR) << "baud rate is invalid:" << com_adr_port->baud_rate;
+    return -1;
+  }
+  Close();
+
+  fd_ = open(com_port.GetComName().c_str(),
+             O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+  if (fd_ < 0) {
+    LOG_F(LG_ERROR) << "open failed:" << com_port.GetComName()
+                    << " errno:" << errno;
+    return -3;
+  }
+  struct termios tio;
+  if (tcgetattr(fd_, &tio) != 0) {
+    LOG_F(LG_ERROR) << "tcgetattr failed errno:" << errno;
+    Close();
+    return -3;
+  }
+  cfmakeraw(&tio);
+  SetFraming(*com_adr_port, &tio);
+  /// the port is nonblocking, VMIN and VTIME are done by ReadTimeout
+  tio.c_cc[VMIN] = 0;
+  tio.c_cc[VTIME] = 0;
+  cfsetispeed(&tio, speed);
+  cfsetospeed(&tio, speed);
+  if (tcsetattr(fd_, TCSANOW, &tio) != 0) {
+    LOG_F(LG_ERROR) << "tcsetattr failed errno:" << errno;
+    Close();
+    return -3;
+  }
+  tcflush(fd_, TCIOFLUSH);
+
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (epoll_fd_ < 0 || event_fd_ < 0) {
+    LOG_F(LG_ERROR) << "epoll or eventfd failed errno:" << errno;
+    Close();
+    return -2;
+  }
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = fd_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &event);
+  event.data.fd = event_fd_;
+  epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event_fd_, &event);
+
+  com_port_device_ = com_port;
+  return 0;
+}
+
+bool ComPortDevicePosixImpl::isOpened() {
+  return fd_ >= 0;
+}
+
+void ComPortDevicePosixImpl::Close() {
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+  }
+  if (event_fd_ >= 0) {
+    close(event_fd_);
+    event_fd_ = -1;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+int32_t ComPortDevicePosixImpl::ReadAvailable(uint8_t* buffer, int32_t size) {
+  if (fd_ < 0) {
+    return -1;
+  }
+  ssize_t readed = 0;
+  do {
+    readed = read(fd_, buffer, size);
+  } while (readed < 0 && errno == EINTR);
+  if (readed < 0) {
+    return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+  }
+  return static_cast<int32_t>(readed);
+}
+
+int32_t ComPortDevicePosixImpl::Read(uint8_t* buffer, int32_t size) {
+  int32_t readed = ReadAvailable(buffer, size);
+  if (readed > 0) {
+    dispatcher_.PublishReceived(buffer, readed);
+  }
+  return readed;
+}
+
+int32_t ComPortDevicePosixImpl::Write(const uint8_t* buffer, int32_t size) {
+  if (fd_ < 0) {
+    return -1;
+  }
+  int32_t written = 0;
+  while (written < size) {
+    ssize_t ret = write(fd_, buffer + written, size - written);
+    if (ret > 0) {
+      written += static_cast<int32_t>(ret);
+      continue;
+    }
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      LOG_F(LG_ERROR) << "write failed errno:" << errno;
+      break;
+    }
+    /// the output buffer is full, wait for writable or canceled
+    struct pollfd fds[2] = {{fd_, POLLOUT, 0}, {event_fd_, POLLIN, 0}};
+    int ready = poll(fds, 2, write_timeout_ms_);
+    if (ready <= 0 || (fds[1].revents & POLLIN) != 0) {
+      LOG_F(LG_WARN) << "write timeout or canceled";
+      break;
+    }
+  }
+  if (written > 0) {
+    dispatcher_.PublishOutgoing(buffer, written);
+  }
+  return written > 0 ? written : -1;
+}
+
+int32_t ComPortDevicePosixImpl::WriteRead(const uint8_t* write_buffer,
+                                          int32_t write_size,
+                                          uint8_t* read_buffer,
+                                          int32_t read_size) {
+  if (Write(write_buffer, write_size) != write_size) {
+    return -1;
+  }
+  int32_t timeout_ms = 1000;
+  if (com_port_device_.GetComPort() != nullptr &&
+      com_port_device_.GetComPort()->adrtype == 1) {
+    timeout_ms =
+        static_cast<ComAddressPort*>(com_port_device_.GetComPort())->timeout;
+  }
+  return ReadTimeout(read_buffer, read_size, timeout_ms);
+}
+
+int32_t ComPortDevicePosixImpl::WaitReadable(int32_t timeout_ms) {
+  if (epoll_fd_ < 0) {
+    return -1;
+  }
+  struct epoll_event events[2];
+  int ready = epoll_wait(epoll_fd_, events, 2, timeout_ms);
+  if (ready < 0) {
+    return errno == EINTR ? 0 : -1;
+  }
+  int32_t ret = 0;
+  for (int i = 0; i < ready; i++) {
+    if (events[i].data.fd == event_fd_) {
+      uint64_t value = 0;
+      ssize_t readed = read(event_fd_, &value, sizeof(value));
+      (void)readed;
+      return -1;
+    }
+    if (events[i].events & EPOLLIN) {
+      ret = 1;
+    } else if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+      ret = -1;
+    }
+  }
+  return ret;
+}
+
+void ComPortDevicePosixImpl::CancelWait() {
+  if (event_fd_ < 0) {
+    return;
+  }
+  uint64_t value = 1;
+  ssize_t written = write(event_fd_, &value, sizeof(value));
+  (void)written;
+}
+
+void ComPortDevicePosixImpl::SetInterByteTimeout(
+    int32_t min_bytes,
+    int32_t inter_byte_timeout_ms) {
+  min_bytes_ = min_bytes;
+  inter_byte_timeout_ms_ = inter_byte_timeout_ms;
+}
+
+int32_t ComPortDevicePosixImpl::ReadTimeout(uint8_t* buffer,
+                                            int32_t size,
+                                            int32_t timeout_ms) {
+  int32_t total = 0;
+  int32_t status = 0;
+  int32_t wait_ms = timeout_ms;
+  while (total < size) {
+    status = WaitReadable(wait_ms);
+    if (status <= 0) {
+      break;
+    }
+    int32_t readed = ReadAvailable(buffer + total, size - total);
+    if (readed < 0) {
+      status = -1;
+      break;
+    }
+    total += readed;
+    if (total >= min_bytes_ && inter_byte_timeout_ms_ <= 0) {
+      break;
+    }
+    wait_ms = total < min_bytes_ ? timeout_ms : inter_byte_timeout_ms_;
+  }
+  if (total > 0) {
+    dispatcher_.PublishReceived(buffer, total);
+    return total;
+  }
+  return status < 0 ? -1 : 0;
+}
+
+const std::string ComPortDevicePosixImpl::GetName() const {
+  return name_;
+}
+
+const ComPortDevice& ComPortDevicePosixImpl::GetComPortDevice() const {
+  return com_port_device_;
+}
+
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,95 @@
+/**
+ * @file device_com_posix_impl.h
+ * @author hhool (hhool@outlook.com)
+ * @brief device com implementation on termios and epoll, the bytes are read
+ * the moment they arrive instead of the timed read polling.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_DEVICE_COM_POSIX_IMPL_H_
+#define APP_DEVICE_DEVICE_COM_POSIX_IMPL_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "app/device/device_com.h"
+#include "app/device/device_com_dispatcher.h"
+
+namespace anx {
+namespace device {
+
+class ComPortDevicePosixImpl : public DeviceComInterface {
+ public:
+  ComPortDevicePosixImpl() = delete;
+  explicit ComPortDevicePosixImpl(std::string name);
+  virtual ~ComPortDevicePosixImpl();
+
+ public:
+  void AddListener(DeviceComListener* listener) override;
+  void RemoveListener(DeviceComListener* listener) override;
+
+ public:
+  /// impliment DeviceComInterface
+  int32_t Open(const ComPortDevice& com_port) override;
+  bool isOpened() override;
+  void Close() override;
+  /// @brief Read the bytes available without wait
+  int32_t Read(uint8_t* buffer, int32_t size) override;
+  /// @brief Write the bytes, wait for the port writable up to the write
+  /// timeout
+  int32_t Write(const uint8_t* buffer, int32_t size) override;
+  /// @brief Write and read the response with ReadTimeout
+  int32_t WriteRead(const uint8_t* write_buffer,
+                    int32_t write_size,
+                    uint8_t* read_buffer,
+                    int32_t read_size) override;
+  int32_t WaitReadable(int32_t timeout_ms) override;
+  void CancelWait() override;
+
+ public:
+  /// @brief Set the inter byte timeout of ReadTimeout, the termios VMIN and
+  /// VTIME on the nonblocking port.
+  /// @param min_bytes the bytes to read before the inter byte timeout counts
+  /// @param inter_byte_timeout_ms the max silence between the bytes, 0 returns
+  /// after the first bytes.
+  void SetInterByteTimeout(int32_t min_bytes, int32_t inter_byte_timeout_ms);
+
+  /// @brief Wait for the first byte up to timeout_ms, then read until size,
+  /// or until the inter byte timeout after the min bytes.
+  /// @return the size read, 0 if timeout, -1 if failed or canceled
+  int32_t ReadTimeout(uint8_t* buffer, int32_t size, int32_t timeout_ms);
+
+  /// @brief Set the max wait time of Write for the port writable
+  void set_write_timeout(int32_t write_timeout_ms) {
+    write_timeout_ms_ = write_timeout_ms;
+  }
+
+  const std::string GetName() const;
+  const ComPortDevice& GetComPortDevice() const;
+  /// @brief Get the dispatcher for the delivery counters of the listeners
+  const DeviceComDispatcher& dispatcher() const { return dispatcher_; }
+
+ private:
+  int32_t ReadAvailable(uint8_t* buffer, int32_t size);
+
+ private:
+  std::string name_;
+  ComPortDevice com_port_device_;
+  DeviceComDispatcher dispatcher_;
+  int fd_;
+  int epoll_fd_;
+  int event_fd_;
+  int32_t min_bytes_;
+  int32_t inter_byte_timeout_ms_;
+  int32_t write_timeout_ms_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_DEVICE_COM_POSIX_IMPL_H_
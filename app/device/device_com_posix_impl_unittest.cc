@@ -0,0 +1,173 @@
+/**
+ * @file device_com_posix_impl_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief device com implementation on termios and epoll unit test, the port
+ * is the slave of the pty pair and the device is simulated on the master.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/device_com_posix_impl.h"
+
+#include <gtest/gtest.h>
+#include <pty.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "app/common/crc16.h"
+#include "app/common/time_utils.h"
+#include "app/device/modbus_rtu.h"
+
+namespace anx {
+namespace device {
+
+class ComPortDevicePosixImplTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    int slave = -1;
+    char name[128] = {0};
+    ASSERT_EQ(openpty(&master_, &slave, name, nullptr, nullptr), 0);
+    ComAddressPort com_port;
+    com_port.baud_rate = 115200;
+    com_port.timeout = 200;
+    ComPortDevice com_port_device(name, &com_port);
+    device_.reset(new ComPortDevicePosixImpl("pty"));
+    ASSERT_EQ(device_->Open(com_port_device), 0);
+    /// the device keeps the slave open
+    close(slave);
+  }
+
+  void TearDown() override {
+    device_.reset();
+    close(master_);
+  }
+
+  void WriteMaster(const std::string& data) {
+    ASSERT_EQ(write(master_, data.data(), data.size()),
+              static_cast<ssize_t>(data.size()));
+  }
+
+  int master_ = -1;
+  std::unique_ptr<ComPortDevicePosixImpl> device_;
+};
+
+TEST_F(ComPortDevicePosixImplTest, WriteRead) {
+  const uint8_t request[] = {0x01, 0x03, 0x00, 0x18};
+  EXPECT_EQ(device_->Write(request, sizeof(request)), 4);
+  uint8_t buffer[16] = {0};
+  ASSERT_EQ(read(master_, buffer, sizeof(buffer)), 4);
+  EXPECT_EQ(memcmp(buffer, request, 4), 0);
+
+  EXPECT_EQ(device_->Read(buffer, sizeof(buffer)), 0);
+  EXPECT_EQ(device_->WaitReadable(10), 0);
+  WriteMaster("hello");
+  EXPECT_EQ(device_->WaitReadable(1000), 1);
+  EXPECT_EQ(device_->Read(buffer, sizeof(buffer)), 5);
+  EXPECT_EQ(std::string(reinterpret_cast<char*>(buffer), 5), "hello");
+}
+
+TEST_F(ComPortDevicePosixImplTest, WakeOnArrival) {
+  std::thread writer([this]() {
+    anx::common::sleep_ms(30);
+    WriteMaster("x");
+  });
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(device_->WaitReadable(2000), 1);
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  writer.join();
+  EXPECT_GE(elapsed, 25);
+  EXPECT_LT(elapsed, 500);
+}
+
+TEST_F(ComPortDevicePosixImplTest, InterByteTimeout) {
+  device_->SetInterByteTimeout(2, 40);
+  std::thread writer([this]() {
+    WriteMaster("abc");
+    anx::common::sleep_ms(10);
+    WriteMaster("def");
+    anx::common::sleep_ms(150);
+    WriteMaster("ghi");
+  });
+  uint8_t buffer[64] = {0};
+  EXPECT_EQ(device_->ReadTimeout(buffer, sizeof(buffer), 1000), 6);
+  EXPECT_EQ(device_->ReadTimeout(buffer, sizeof(buffer), 1000), 3);
+  writer.join();
+  EXPECT_EQ(device_->ReadTimeout(buffer, sizeof(buffer), 20), 0);
+}
+
+TEST_F(ComPortDevicePosixImplTest, CancelWait) {
+  std::thread canceler([this]() {
+    anx::common::sleep_ms(20);
+    device_->CancelWait();
+  });
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(device_->WaitReadable(5000), -1);
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  canceler.join();
+  EXPECT_LT(elapsed, 1000);
+}
+
+TEST_F(ComPortDevicePosixImplTest, ModbusRtuChannel) {
+  std::vector<uint8_t> reply = {0x01, 0x04, 0x02, 0x4D, 0x97};
+  uint16_t crc = anx::common::crc16(reply.data(), reply.size());
+  reply.push_back(crc & 0xFF);
+  reply.push_back(crc >> 8);
+  const int32_t kRequests = 20;
+  std::thread responder([this, &reply]() {
+    uint8_t buffer[64];
+    for (int32_t i = 0; i < kRequests; i++) {
+      int32_t readed = 0;
+      while (readed < 8) {
+        ssize_t ret = read(master_, buffer + readed, sizeof(buffer) - readed);
+        if (ret <= 0) {
+          return;
+        }
+        readed += static_cast<int32_t>(ret);
+      }
+      /// the response arrives in two parts
+      ASSERT_EQ(write(master_, reply.data(), 3), 3);
+      anx::common::sleep_ms(1);
+      ASSERT_EQ(write(master_, reply.data() + 3, reply.size() - 3),
+                static_cast<ssize_t>(reply.size() - 3));
+    }
+  });
+  uint8_t request[8] = {0x01, 0x04, 0x00, 0x01, 0x00, 0x01, 0x60, 0x0A};
+  ModbusRtuChannel channel(device_.get());
+  channel.Reset(115200);
+  for (int32_t i = 0; i < kRequests; i++) {
+    ModbusRtuResponse response;
+    int32_t ret = channel.Transact(request, sizeof(request), 500, &response);
+    EXPECT_EQ(ret, 0);
+    if (ret != 0) {
+      break;
+    }
+    EXPECT_EQ(response.size(), reply.size());
+    EXPECT_EQ(memcmp(response.data(), reply.data(), reply.size()), 0);
+    EXPECT_GT(channel.last_latency_us(), 0);
+    EXPECT_LT(channel.last_latency_us(), 100 * 1000);
+    if (i == kRequests / 2) {
+      channel.Start();
+    }
+  }
+  channel.Stop();
+  /// the responder reads the master until the slave is closed
+  device_->Close();
+  responder.join();
+  EXPECT_EQ(channel.framer().frames(), kRequests);
+}
+
+}  // namespace device
+}  // namespace anx
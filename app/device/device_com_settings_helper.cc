@@ -41,6 +41,19 @@ std::string DefaultDeviceComSettingsXmlFilePath(int32_t device_com_type) {
   return "";
 }
 
+std::string DefaultDeviceComSettingsXmlFilePath(int32_t device_com_type,
+                                                int32_t station) {
+  std::string default_xml =
+      DefaultDeviceComSettingsXmlFilePath(device_com_type);
+  if (default_xml.empty() || station == 0) {
+    return default_xml;
+  }
+  // com_settings_ua.xml to com_settings_ua.s2.xml
+  std::string::size_type pos = default_xml.rfind(".xml");
+  default_xml.insert(pos, ".s" + std::to_string(station));
+  return default_xml;
+}
+
 std::unique_ptr<ComSettings> LoadDeviceComSettingsWithFilePath(
     const std::string& file_path) {
   // Read the file content
@@ -60,8 +73,14 @@ std::unique_ptr<ComSettings> LoadDeviceComSettingsWithFilePath(
 
 std::unique_ptr<ComSettings> LoadDeviceComSettingsDefaultResourceWithType(
     int32_t device_com_type) {
+  return LoadDeviceComSettingsDefaultResourceWithType(device_com_type, 0);
+}
+
+std::unique_ptr<ComSettings> LoadDeviceComSettingsDefaultResourceWithType(
+    int32_t device_com_type,
+    int32_t station) {
   std::string default_xml =
-      DefaultDeviceComSettingsXmlFilePath(device_com_type);
+      DefaultDeviceComSettingsXmlFilePath(device_com_type, station);
   // get app data path
   std::string app_data_dir =
       anx::common::GetApplicationDataPath("anxi");
@@ -88,8 +107,13 @@ int32_t SaveDeviceComSettingsFile(const std::string& file_path,
 }
 
 int32_t SaveDeviceComSettingsFileDefaultPath(const ComSettings& settings) {
-  std::string default_xml =
-      DefaultDeviceComSettingsXmlFilePath(settings.GetDeviceComType());
+  return SaveDeviceComSettingsFileDefaultPath(settings, 0);
+}
+
+int32_t SaveDeviceComSettingsFileDefaultPath(const ComSettings& settings,
+                                             int32_t station) {
+  std::string default_xml = DefaultDeviceComSettingsXmlFilePath(
+      settings.GetDeviceComType(), station);
   // get app data path
   std::string app_data_dir = anx::common::GetApplicationDataPath("anxi");
   default_xml = app_data_dir + anx::common::kPathSeparator + default_xml;
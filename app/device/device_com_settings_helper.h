@@ -33,6 +33,15 @@ namespace device {
 /// @return the device com settings xml file path
 std::string DefaultDeviceComSettingsXmlFilePath(int32_t device_com_type);
 
+/// @brief Default device com settings xml file path of the station, the
+/// station 0 is the single rig of DefaultDeviceComSettingsXmlFilePath, the
+/// others are suffixed, e.g. com_settings_ua.s2.xml.
+/// @param device_com_type the device type
+/// @param station the station id
+/// @return the device com settings xml file path
+std::string DefaultDeviceComSettingsXmlFilePath(int32_t device_com_type,
+                                                int32_t station);
+
 /// @brief Load the device com settings with the file path
 /// @param file_path the file path of the device com settings file
 /// @return the device com settings pointer
@@ -49,6 +58,14 @@ std::unique_ptr<ComSettings> LoadDeviceComSettingsWithFilePath(
 std::unique_ptr<ComSettings> LoadDeviceComSettingsDefaultResourceWithType(
     int32_t device_com_type);
 
+/// @brief Load default the device com settings of the station
+/// @param device_type the device type
+/// @param station the station id
+/// @return the device com settings pointer
+std::unique_ptr<ComSettings> LoadDeviceComSettingsDefaultResourceWithType(
+    int32_t device_com_type,
+    int32_t station);
+
 /// @brief Save the device com settings file
 /// @param file_path the file path of the device com settings file
 /// @param settings the device com settings
@@ -59,6 +76,12 @@ int32_t SaveDeviceComSettingsFile(const std::string& file_path,
 /// @param settings the device com settings
 /// @return 0 if success, -1 if failed
 int32_t SaveDeviceComSettingsFileDefaultPath(const ComSettings& settings);
+/// @brief  Save the device com settings file of the station
+/// @param settings the device com settings
+/// @param station the station id
+/// @return 0 if success, -1 if failed
+int32_t SaveDeviceComSettingsFileDefaultPath(const ComSettings& settings,
+                                             int32_t station);
 
 }  // namespace device
 }  // namespace anx
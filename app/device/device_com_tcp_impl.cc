@@ -0,0 +1,738 @@
+/**
+ * @file device_com_tcp_impl.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief device com implementation on modbus tcp for the lan address
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#if defined(_WIN32)
+// winsock2.h must be included before the windows.h of thread.h
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+#include "app/device/device_com_tcp_impl.h"
+
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+#include "app/common/crc16.h"
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+#if defined(_WIN32)
+typedef SOCKET SocketHandle;
+typedef WSAPOLLFD PollFd;
+const SocketHandle kInvalidSocket = INVALID_SOCKET;
+
+/// @brief the winsock is started once for the process
+bool StartupSockets() {
+  static bool started = []() {
+    WSADATA wsa_data;
+    return WSAStartup(MAKEWORD(2, 2), &wsa_data) == 0;
+  }();
+  return started;
+}
+
+void CloseSocket(SocketHandle socket_handle) {
+  closesocket(socket_handle);
+}
+
+bool SetNonBlocking(SocketHandle socket_handle) {
+  u_long mode = 1;
+  return ioctlsocket(socket_handle, FIONBIO, &mode) == 0;
+}
+
+int32_t LastError() {
+  return WSAGetLastError();
+}
+
+bool IsWouldBlock(int32_t error) {
+  return error == WSAEWOULDBLOCK || error == WSAEINPROGRESS;
+}
+
+int PollSockets(PollFd* fds, int count, int32_t timeout_ms) {
+  return WSAPoll(fds, count, timeout_ms);
+}
+#else
+typedef int SocketHandle;
+typedef struct pollfd PollFd;
+const SocketHandle kInvalidSocket = -1;
+
+bool StartupSockets() {
+  return true;
+}
+
+void CloseSocket(SocketHandle socket_handle) {
+  close(socket_handle);
+}
+
+bool SetNonBlocking(SocketHandle socket_handle) {
+  int flags = fcntl(socket_handle, F_GETFL, 0);
+  return flags >= 0 &&
+         fcntl(socket_handle, F_SETFL, flags | O_NONBLOCK) == 0 &&
+         fcntl(socket_handle, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+int32_t LastError() {
+  return errno;
+}
+
+bool IsWouldBlock(int32_t error) {
+  return error == EAGAIN || error == EWOULDBLOCK || error == EINPROGRESS ||
+         error == EINTR;
+}
+
+int PollSockets(PollFd* fds, int count, int32_t timeout_ms) {
+  return poll(fds, count, timeout_ms);
+}
+#endif
+
+#if defined(MSG_NOSIGNAL)
+const int kSendFlags = MSG_NOSIGNAL;
+#else
+const int kSendFlags = 0;
+#endif
+
+/// @brief the byte of the wakeup to cancel the wait, the others only wake
+/// up the poll to service the socket.
+const char kWakeCancel = 'c';
+const char kWakeNudge = 'n';
+
+const int32_t kConnectTimeoutMs = 1000;
+const int32_t kResponseTimeoutMs = 1000;
+const int32_t kMaxOutstanding = 8;
+const int32_t kBackoffMinMs = 100;
+const int32_t kBackoffMaxMs = 5000;
+
+int64_t NowMillis() {
+  return anx::common::GetCurrentTimeMillis();
+}
+
+/// @brief the udp socket connected to itself on the loopback
+SocketHandle CreateWakeSocket() {
+  SocketHandle wake = socket(AF_INET, SOCK_DGRAM, 0);
+  if (wake == kInvalidSocket) {
+    return kInvalidSocket;
+  }
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  socklen_t addr_len = sizeof(addr);
+  if (bind(wake, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) !=
+          0 ||
+      getsockname(wake, reinterpret_cast<struct sockaddr*>(&addr),
+                  &addr_len) != 0 ||
+      connect(wake, reinterpret_cast<struct sockaddr*>(&addr), addr_len) !=
+          0 ||
+      !SetNonBlocking(wake)) {
+    CloseSocket(wake);
+    return kInvalidSocket;
+  }
+  return wake;
+}
+
+/// @brief Drain the wakeup bytes
+/// @return true if the wait is canceled
+bool DrainWakeSocket(SocketHandle wake) {
+  bool canceled = false;
+  char buffer[64];
+  for (;;) {
+    int readed = recv(wake, buffer, sizeof(buffer), 0);
+    if (readed <= 0) {
+      break;
+    }
+    if (std::find(buffer, buffer + readed, kWakeCancel) != buffer + readed) {
+      canceled = true;
+    }
+  }
+  return canceled;
+}
+
+bool ResolveAddress(const std::string& host, uint32_t* address) {
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* result = nullptr;
+  if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 ||
+      result == nullptr) {
+    return false;
+  }
+  *address =
+      reinterpret_cast<struct sockaddr_in*>(result->ai_addr)->sin_addr.s_addr;
+  freeaddrinfo(result);
+  return true;
+}
+}  // namespace
+
+int32_t EncodeModbusTcpAdu(const ModbusTcpAdu& adu, std::vector<uint8_t>* out) {
+  int32_t pdu_size = static_cast<int32_t>(adu.pdu.size());
+  if (pdu_size < 1 || pdu_size > kModbusTcpMaxPduSize) {
+    return -1;
+  }
+  /// the length counts the unit id and the pdu
+  uint16_t length = static_cast<uint16_t>(pdu_size + 1);
+  const uint8_t header[kModbusTcpMbapHeaderSize] = {
+      static_cast<uint8_t>(adu.transaction_id >> 8),
+      static_cast<uint8_t>(adu.transaction_id & 0xFF),
+      0x00,
+      0x00,
+      static_cast<uint8_t>(length >> 8),
+      static_cast<uint8_t>(length & 0xFF),
+      adu.unit_id};
+  out->insert(out->end(), header, header + kModbusTcpMbapHeaderSize);
+  out->insert(out->end(), adu.pdu.begin(), adu.pdu.end());
+  return kModbusTcpMbapHeaderSize + pdu_size;
+}
+
+int32_t DecodeModbusTcpAdu(const uint8_t* data,
+                           size_t size,
+                           ModbusTcpAdu* adu) {
+  if (size < static_cast<size_t>(kModbusTcpMbapHeaderSize)) {
+    return 0;
+  }
+  uint16_t protocol_id = static_cast<uint16_t>((data[2] << 8) | data[3]);
+  int32_t length = (data[4] << 8) | data[5];
+  if (protocol_id != 0 || length < 2 || length > kModbusTcpMaxPduSize + 1) {
+    return -1;
+  }
+  size_t adu_size = static_cast<size_t>(6 + length);
+  if (size < adu_size) {
+    return 0;
+  }
+  adu->transaction_id = static_cast<uint16_t>((data[0] << 8) | data[1]);
+  adu->unit_id = data[6];
+  adu->pdu.assign(data + kModbusTcpMbapHeaderSize, data + adu_size);
+  return static_cast<int32_t>(adu_size);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// clz ComPortDeviceTcpImpl
+
+ComPortDeviceTcpImpl::ComPortDeviceTcpImpl(std::string name)
+    : name_(name),
+      dispatcher_(this),
+      opened_(false),
+      state_(kDisconnected),
+      socket_(kInvalidSocket),
+      wake_socket_(kInvalidSocket),
+      address_(0),
+      port_(0),
+      connect_deadline_ms_(0),
+      reconnect_at_ms_(0),
+      backoff_ms_(kBackoffMinMs),
+      was_connected_(false),
+      next_transaction_id_(0),
+      max_outstanding_(kMaxOutstanding),
+      response_timeout_ms_(kResponseTimeoutMs),
+      connect_timeout_ms_(kConnectTimeoutMs),
+      backoff_min_ms_(kBackoffMinMs),
+      backoff_max_ms_(kBackoffMaxMs),
+      reconnects_(0),
+      timeouts_(0),
+      stale_responses_(0) {}
+
+ComPortDeviceTcpImpl::~ComPortDeviceTcpImpl() {
+  Close();
+}
+
+void ComPortDeviceTcpImpl::AddListener(DeviceComListener* listener) {
+  dispatcher_.AddListener(listener);
+}
+
+void ComPortDeviceTcpImpl::RemoveListener(DeviceComListener* listener) {
+  dispatcher_.RemoveListener(listener);
+}
+
+int32_t ComPortDeviceTcpImpl::Open(const ComPortDevice& com_port) {
+  if (com_port.GetComPort()->adrtype != 2) {
+    LOG_F(LG_ERROR) << "adrtype is not 2";
+    return -1;
+  }
+  ComAddressLan* com_adr_lan =
+      static_cast<ComAddressLan*>(com_port.GetComPort());
+  if (com_adr_lan->port <= 0 || com_adr_lan->port > 0xFFFF) {
+    LOG_F(LG_ERROR) << "port is invalid:" << com_adr_lan->port;
+    return -1;
+  }
+  Close();
+  if (!StartupSockets()) {
+    LOG_F(LG_ERROR) << "socket startup failed";
+    return -2;
+  }
+  uint32_t address = 0;
+  if (!ResolveAddress(com_adr_lan->ip, &address)) {
+    LOG_F(LG_ERROR) << "address is invalid:" << com_adr_lan->ip;
+    return -1;
+  }
+  SocketHandle wake = CreateWakeSocket();
+  if (wake == kInvalidSocket) {
+    LOG_F(LG_ERROR) << "wake socket failed error:" << LastError();
+    return -2;
+  }
+  {
+    anx::common::AutoLock lock(&mutex_);
+    com_port_device_ = com_port;
+    address_ = address;
+    port_ = htons(static_cast<uint16_t>(com_adr_lan->port));
+    wake_socket_ = wake;
+    opened_ = true;
+    was_connected_ = false;
+    backoff_ms_ = backoff_min_ms_;
+    StartConnect(NowMillis());
+  }
+  int64_t deadline_ms = NowMillis() + connect_timeout_ms_;
+  for (;;) {
+    {
+      anx::common::AutoLock lock(&mutex_);
+      Service(NowMillis());
+      if (state_ == kConnected) {
+        return 0;
+      }
+    }
+    int64_t remaining_ms = deadline_ms - NowMillis();
+    if (remaining_ms <= 0 ||
+        PollOnce(static_cast<int32_t>(remaining_ms)) < 0) {
+      break;
+    }
+  }
+  LOG_F(LG_ERROR) << "connect failed:" << com_adr_lan->ip << ":"
+                  << com_adr_lan->port;
+  Close();
+  return -3;
+}
+
+bool ComPortDeviceTcpImpl::isOpened() {
+  anx::common::AutoLock lock(&mutex_);
+  return opened_;
+}
+
+void ComPortDeviceTcpImpl::Close() {
+  anx::common::AutoLock lock(&mutex_);
+  opened_ = false;
+  if (socket_ != kInvalidSocket) {
+    CloseSocket(socket_);
+    socket_ = kInvalidSocket;
+  }
+  state_ = kDisconnected;
+  if (wake_socket_ != kInvalidSocket) {
+    /// the waiting threads see the device closed at the next poll slice
+    CloseSocket(wake_socket_);
+    wake_socket_ = kInvalidSocket;
+  }
+  pending_.clear();
+  tx_.clear();
+  rx_.clear();
+  responses_.clear();
+  rtu_out_.clear();
+}
+
+int32_t ComPortDeviceTcpImpl::Read(uint8_t* buffer, int32_t size) {
+  int32_t readed = 0;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (!opened_) {
+      return -1;
+    }
+    Service(NowMillis());
+    /// the responses as the rtu frames, unit id, pdu and crc
+    while (!responses_.empty()) {
+      const ModbusTcpAdu& adu = responses_.front();
+      size_t offset = rtu_out_.size();
+      rtu_out_.push_back(adu.unit_id);
+      rtu_out_.insert(rtu_out_.end(), adu.pdu.begin(), adu.pdu.end());
+      uint16_t crc = anx::common::crc16(
+          rtu_out_.data() + offset, static_cast<uint32_t>(1 + adu.pdu.size()));
+      rtu_out_.push_back(crc & 0xFF);
+      rtu_out_.push_back(crc >> 8);
+      responses_.pop_front();
+    }
+    readed = std::min<int32_t>(size, static_cast<int32_t>(rtu_out_.size()));
+    std::copy(rtu_out_.begin(), rtu_out_.begin() + readed, buffer);
+    rtu_out_.erase(rtu_out_.begin(), rtu_out_.begin() + readed);
+  }
+  dispatcher_.PublishReceived(buffer, readed);
+  return readed;
+}
+
+int32_t ComPortDeviceTcpImpl::Write(const uint8_t* buffer, int32_t size) {
+  if (size < 4 || size > kModbusTcpMaxPduSize + 3) {
+    LOG_F(LG_ERROR) << "frame size is invalid:" << size;
+    return -1;
+  }
+  uint16_t crc = static_cast<uint16_t>(buffer[size - 2] |
+                                       (buffer[size - 1] << 8));
+  if (anx::common::crc16(buffer, size - 2) != crc) {
+    LOG_F(LG_ERROR) << "frame crc is invalid";
+    return -1;
+  }
+  /// the crc is replaced by the tcp checksum
+  if (Send(buffer[0], buffer + 1, size - 3) < 0) {
+    return -1;
+  }
+  dispatcher_.PublishOutgoing(buffer, size);
+  return size;
+}
+
+int32_t ComPortDeviceTcpImpl::WriteRead(const uint8_t* write_buffer,
+                                        int32_t write_size,
+                                        uint8_t* read_buffer,
+                                        int32_t read_size) {
+  if (Write(write_buffer, write_size) != write_size) {
+    return -1;
+  }
+  int32_t ret = WaitReadable(response_timeout_ms_);
+  if (ret <= 0) {
+    return ret;
+  }
+  return Read(read_buffer, read_size);
+}
+
+int32_t ComPortDeviceTcpImpl::WaitReadable(int32_t timeout_ms) {
+  int64_t deadline_ms = NowMillis() + timeout_ms;
+  for (;;) {
+    {
+      anx::common::AutoLock lock(&mutex_);
+      if (!opened_) {
+        return -1;
+      }
+      Service(NowMillis());
+      if (!responses_.empty() || !rtu_out_.empty()) {
+        return 1;
+      }
+    }
+    int64_t remaining_ms = deadline_ms - NowMillis();
+    if (remaining_ms <= 0) {
+      return 0;
+    }
+    if (PollOnce(static_cast<int32_t>(remaining_ms)) < 0) {
+      return -1;
+    }
+  }
+}
+
+void ComPortDeviceTcpImpl::CancelWait() {
+  anx::common::AutoLock lock(&mutex_);
+  if (wake_socket_ != kInvalidSocket) {
+    send(wake_socket_, &kWakeCancel, 1, 0);
+  }
+}
+
+int32_t ComPortDeviceTcpImpl::Send(uint8_t unit_id,
+                                   const uint8_t* pdu,
+                                   int32_t size) {
+  if (size < 1 || size > kModbusTcpMaxPduSize) {
+    return -1;
+  }
+  anx::common::AutoLock lock(&mutex_);
+  if (!opened_) {
+    return -1;
+  }
+  int64_t now_ms = NowMillis();
+  Service(now_ms);
+  if (state_ != kConnected) {
+    return -1;
+  }
+  if (static_cast<int32_t>(pending_.size()) >= max_outstanding_) {
+    return -2;
+  }
+  ModbusTcpAdu adu;
+  do {
+    adu.transaction_id = next_transaction_id_++;
+  } while (pending_.count(adu.transaction_id) != 0);
+  adu.unit_id = unit_id;
+  adu.pdu.assign(pdu, pdu + size);
+  EncodeModbusTcpAdu(adu, &tx_);
+  pending_[adu.transaction_id] = now_ms;
+  Flush(now_ms);
+  if (!tx_.empty()) {
+    /// the poll of the other thread waits for writable too
+    Nudge();
+  }
+  return adu.transaction_id;
+}
+
+int32_t ComPortDeviceTcpImpl::Receive(ModbusTcpAdu* adu, int32_t timeout_ms) {
+  int64_t deadline_ms = NowMillis() + timeout_ms;
+  for (;;) {
+    {
+      anx::common::AutoLock lock(&mutex_);
+      if (!opened_) {
+        return -1;
+      }
+      Service(NowMillis());
+      if (!responses_.empty()) {
+        *adu = std::move(responses_.front());
+        responses_.pop_front();
+        return 1;
+      }
+    }
+    int64_t remaining_ms = deadline_ms - NowMillis();
+    if (remaining_ms <= 0) {
+      return 0;
+    }
+    if (PollOnce(static_cast<int32_t>(remaining_ms)) < 0) {
+      return -1;
+    }
+  }
+}
+
+bool ComPortDeviceTcpImpl::connected() {
+  anx::common::AutoLock lock(&mutex_);
+  return state_ == kConnected;
+}
+
+int32_t ComPortDeviceTcpImpl::outstanding() {
+  anx::common::AutoLock lock(&mutex_);
+  return static_cast<int32_t>(pending_.size());
+}
+
+const std::string ComPortDeviceTcpImpl::GetName() const {
+  return name_;
+}
+
+const ComPortDevice& ComPortDeviceTcpImpl::GetComPortDevice() const {
+  return com_port_device_;
+}
+
+void ComPortDeviceTcpImpl::Service(int64_t now_ms) {
+  if (!opened_) {
+    return;
+  }
+  if (state_ == kDisconnected && now_ms >= reconnect_at_ms_) {
+    StartConnect(now_ms);
+  }
+  if (state_ == kConnecting) {
+    PollFd fd = {};
+    fd.fd = socket_;
+    fd.events = POLLOUT;
+    int ready = PollSockets(&fd, 1, 0);
+    if (ready > 0) {
+      int error = 0;
+      socklen_t error_len = sizeof(error);
+      getsockopt(socket_, SOL_SOCKET, SO_ERROR,
+                 reinterpret_cast<char*>(&error), &error_len);
+      if (error != 0 || (fd.revents & (POLLERR | POLLHUP)) != 0) {
+        LOG_F(LG_WARN) << "connect failed error:" << error;
+        Disconnect(now_ms);
+      } else {
+        state_ = kConnected;
+        backoff_ms_ = backoff_min_ms_;
+        if (was_connected_) {
+          reconnects_++;
+          LOG_F(LG_INFO) << "reconnected:" << name_;
+        }
+        was_connected_ = true;
+      }
+    } else if (now_ms >= connect_deadline_ms_) {
+      LOG_F(LG_WARN) << "connect timeout:" << name_;
+      Disconnect(now_ms);
+    }
+  }
+  if (state_ == kConnected) {
+    Flush(now_ms);
+  }
+  if (state_ == kConnected) {
+    ReceiveAvailable(now_ms);
+  }
+  Expire(now_ms);
+}
+
+void ComPortDeviceTcpImpl::StartConnect(int64_t now_ms) {
+  SocketHandle socket_handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (socket_handle == kInvalidSocket || !SetNonBlocking(socket_handle)) {
+    LOG_F(LG_ERROR) << "socket failed error:" << LastError();
+    if (socket_handle != kInvalidSocket) {
+      CloseSocket(socket_handle);
+    }
+    socket_ = kInvalidSocket;
+    Disconnect(now_ms);
+    return;
+  }
+  /// the requests are small, send them without the nagle delay
+  int no_delay = 1;
+  setsockopt(socket_handle, IPPROTO_TCP, TCP_NODELAY,
+             reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = address_;
+  addr.sin_port = port_;
+  socket_ = socket_handle;
+  state_ = kConnecting;
+  connect_deadline_ms_ = now_ms + connect_timeout_ms_;
+  if (connect(socket_handle, reinterpret_cast<struct sockaddr*>(&addr),
+              sizeof(addr)) != 0 &&
+      !IsWouldBlock(LastError())) {
+    LOG_F(LG_WARN) << "connect failed error:" << LastError();
+    Disconnect(now_ms);
+  }
+}
+
+void ComPortDeviceTcpImpl::Disconnect(int64_t now_ms) {
+  if (socket_ != kInvalidSocket) {
+    CloseSocket(socket_);
+    socket_ = kInvalidSocket;
+  }
+  state_ = kDisconnected;
+  /// the requests sent are lost with the connection
+  timeouts_ += static_cast<int64_t>(pending_.size());
+  pending_.clear();
+  tx_.clear();
+  rx_.clear();
+  reconnect_at_ms_ = now_ms + backoff_ms_;
+  backoff_ms_ = std::min(backoff_ms_ * 2, backoff_max_ms_);
+}
+
+void ComPortDeviceTcpImpl::Flush(int64_t now_ms) {
+  size_t written = 0;
+  while (written < tx_.size()) {
+    int ret = send(socket_, reinterpret_cast<const char*>(tx_.data()) + written,
+                   static_cast<int>(tx_.size() - written), kSendFlags);
+    if (ret > 0) {
+      written += static_cast<size_t>(ret);
+      continue;
+    }
+    int32_t error = LastError();
+    if (ret < 0 && IsWouldBlock(error)) {
+      break;
+    }
+    LOG_F(LG_WARN) << "send failed error:" << error;
+    Disconnect(now_ms);
+    return;
+  }
+  tx_.erase(tx_.begin(), tx_.begin() + written);
+}
+
+void ComPortDeviceTcpImpl::ReceiveAvailable(int64_t now_ms) {
+  uint8_t buffer[1024];
+  bool closed = false;
+  for (;;) {
+    int ret = recv(socket_, reinterpret_cast<char*>(buffer), sizeof(buffer), 0);
+    if (ret > 0) {
+      rx_.insert(rx_.end(), buffer, buffer + ret);
+      continue;
+    }
+    int32_t error = LastError();
+    if (ret < 0 && IsWouldBlock(error)) {
+      break;
+    }
+    LOG_F(LG_WARN) << "connection closed error:" << (ret == 0 ? 0 : error);
+    closed = true;
+    break;
+  }
+  size_t offset = 0;
+  for (;;) {
+    ModbusTcpAdu adu;
+    int32_t consumed = DecodeModbusTcpAdu(rx_.data() + offset,
+                                          rx_.size() - offset, &adu);
+    if (consumed == 0) {
+      break;
+    }
+    if (consumed < 0) {
+      /// no resync on the stream, the connection is reset
+      LOG_F(LG_ERROR) << "mbap header is invalid";
+      Disconnect(now_ms);
+      return;
+    }
+    offset += static_cast<size_t>(consumed);
+    auto it = pending_.find(adu.transaction_id);
+    if (it == pending_.end()) {
+      stale_responses_++;
+      continue;
+    }
+    pending_.erase(it);
+    responses_.push_back(std::move(adu));
+  }
+  rx_.erase(rx_.begin(), rx_.begin() + offset);
+  /// the responses received before the close are kept
+  if (closed) {
+    Disconnect(now_ms);
+  }
+}
+
+void ComPortDeviceTcpImpl::Expire(int64_t now_ms) {
+  for (auto it = pending_.begin(); it != pending_.end();) {
+    if (now_ms - it->second >= response_timeout_ms_) {
+      timeouts_++;
+      it = pending_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void ComPortDeviceTcpImpl::Nudge() {
+  if (wake_socket_ != kInvalidSocket) {
+    send(wake_socket_, &kWakeNudge, 1, 0);
+  }
+}
+
+int32_t ComPortDeviceTcpImpl::PollOnce(int32_t max_wait_ms) {
+  PollFd fds[2] = {};
+  int count = 0;
+  int32_t wait_ms = max_wait_ms;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (!opened_ || wake_socket_ == kInvalidSocket) {
+      return -1;
+    }
+    int64_t now_ms = NowMillis();
+    fds[count].fd = wake_socket_;
+    fds[count].events = POLLIN;
+    count++;
+    if (state_ == kConnecting) {
+      fds[count].fd = socket_;
+      fds[count].events = POLLOUT;
+      count++;
+      wait_ms = static_cast<int32_t>(
+          std::min<int64_t>(wait_ms, connect_deadline_ms_ - now_ms));
+    } else if (state_ == kConnected) {
+      fds[count].fd = socket_;
+      fds[count].events = POLLIN;
+      if (!tx_.empty()) {
+        fds[count].events |= POLLOUT;
+      }
+      count++;
+    } else {
+      wait_ms = static_cast<int32_t>(
+          std::min<int64_t>(wait_ms, reconnect_at_ms_ - now_ms));
+    }
+    for (auto& it : pending_) {
+      wait_ms = static_cast<int32_t>(std::min<int64_t>(
+          wait_ms, it.second + response_timeout_ms_ - now_ms));
+    }
+  }
+  /// the socket closed by the other thread wakes up at the slice
+  wait_ms = std::max<int32_t>(0, std::min<int32_t>(wait_ms, 100));
+  int ready = PollSockets(fds, count, wait_ms);
+  if (ready > 0 && (fds[0].revents & POLLIN) != 0) {
+    anx::common::AutoLock lock(&mutex_);
+    if (wake_socket_ == kInvalidSocket || DrainWakeSocket(wake_socket_)) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace device
+}  // namespace anx
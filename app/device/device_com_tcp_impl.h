@@ -0,0 +1,208 @@
+/**
+ * @file device_com_tcp_impl.h
+ * @author hhool (hhool@outlook.com)
+ * @brief device com implementation on modbus tcp for the lan address, the
+ * devices behind the serial to ethernet gateways.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_DEVICE_COM_TCP_IMPL_H_
+#define APP_DEVICE_DEVICE_COM_TCP_IMPL_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/device/device_com.h"
+#include "app/device/device_com_dispatcher.h"
+
+namespace anx {
+namespace device {
+
+/// @brief the mbap header size, transaction id, protocol id, length and
+/// unit id.
+const int32_t kModbusTcpMbapHeaderSize = 7;
+/// @brief the max pdu size, function code and data.
+const int32_t kModbusTcpMaxPduSize = 253;
+
+/// @brief the modbus tcp application data unit
+struct ModbusTcpAdu {
+  uint16_t transaction_id = 0;
+  uint8_t unit_id = 0;
+  /// @brief the function code and the data
+  std::vector<uint8_t> pdu;
+};
+
+/// @brief Encode the adu with the mbap header
+/// @param adu the adu
+/// @param out the mbap header and the pdu appended
+/// @return the size appended, -1 if the pdu size is invalid
+int32_t EncodeModbusTcpAdu(const ModbusTcpAdu& adu, std::vector<uint8_t>* out);
+
+/// @brief Decode the first adu of the stream
+/// @param data the bytes received
+/// @param size the size of the bytes
+/// @param adu the adu decoded
+/// @return the size of the adu consumed, 0 if more bytes needed, -1 if the
+/// mbap header is invalid.
+int32_t DecodeModbusTcpAdu(const uint8_t* data,
+                           size_t size,
+                           ModbusTcpAdu* adu);
+
+/// @brief the modbus tcp client on the nonblocking socket. the requests are
+/// pipelined by the transaction id up to the max outstanding, the dropped
+/// connection is reconnected with the backoff. as DeviceComInterface the
+/// rtu frames with crc are written and read, so ModbusRtuChannel works on
+/// the gateways unchanged.
+class ComPortDeviceTcpImpl : public DeviceComInterface {
+ public:
+  ComPortDeviceTcpImpl() = delete;
+  explicit ComPortDeviceTcpImpl(std::string name);
+  virtual ~ComPortDeviceTcpImpl();
+
+ public:
+  void AddListener(DeviceComListener* listener) override;
+  void RemoveListener(DeviceComListener* listener) override;
+
+ public:
+  /// impliment DeviceComInterface
+  /// @brief Open the connection to the ComAddressLan, wait up to the connect
+  /// timeout.
+  /// @return 0 if success, -1 if the address is invalid, -2 if the socket
+  /// failed, -3 if the connect failed or timeout.
+  int32_t Open(const ComPortDevice& com_port) override;
+  bool isOpened() override;
+  void Close() override;
+  /// @brief Read the rtu frames of the responses received without wait
+  int32_t Read(uint8_t* buffer, int32_t size) override;
+  /// @brief Write the rtu frame with crc as a modbus tcp request
+  /// @return the size written, -1 if the frame is invalid, not connected or
+  /// the outstanding requests are full.
+  int32_t Write(const uint8_t* buffer, int32_t size) override;
+  /// @brief Write the rtu frame and read the response up to the response
+  /// timeout.
+  int32_t WriteRead(const uint8_t* write_buffer,
+                    int32_t write_size,
+                    uint8_t* read_buffer,
+                    int32_t read_size) override;
+  int32_t WaitReadable(int32_t timeout_ms) override;
+  void CancelWait() override;
+
+ public:
+  /// @brief Send the request without wait for the response
+  /// @param unit_id the unit id, the station behind the gateway
+  /// @param pdu the function code and the data
+  /// @param size the pdu size
+  /// @return the transaction id, -1 if the pdu is invalid or not connected,
+  /// -2 if the outstanding requests are full.
+  int32_t Send(uint8_t unit_id, const uint8_t* pdu, int32_t size);
+
+  /// @brief Receive the response of any request sent
+  /// @param adu the response, match the request by the transaction id
+  /// @param timeout_ms the max wait time
+  /// @return 1 if received, 0 if timeout, -1 if closed or canceled
+  int32_t Receive(ModbusTcpAdu* adu, int32_t timeout_ms);
+
+  /// @brief Set the max requests waiting for the responses
+  void set_max_outstanding(int32_t max_outstanding) {
+    max_outstanding_ = max_outstanding;
+  }
+  /// @brief Set the time the request is waiting for the response, the
+  /// response after is dropped as stale.
+  void set_response_timeout(int32_t response_timeout_ms) {
+    response_timeout_ms_ = response_timeout_ms;
+  }
+  void set_connect_timeout(int32_t connect_timeout_ms) {
+    connect_timeout_ms_ = connect_timeout_ms;
+  }
+  /// @brief Set the reconnect backoff, doubled after each failure from the
+  /// min to the max.
+  void set_reconnect_backoff(int32_t min_ms, int32_t max_ms) {
+    backoff_min_ms_ = min_ms;
+    backoff_max_ms_ = max_ms;
+  }
+
+  /// @brief Check the connection is established, the device stays opened
+  /// while reconnecting.
+  bool connected();
+  /// @brief Get the count of the requests waiting for the responses
+  int32_t outstanding();
+  int64_t reconnects() const { return reconnects_; }
+  /// @brief Get the count of the requests without the response in time or
+  /// lost with the connection.
+  int64_t timeouts() const { return timeouts_; }
+  /// @brief Get the count of the responses without the request waiting
+  int64_t stale_responses() const { return stale_responses_; }
+
+  const std::string GetName() const;
+  const ComPortDevice& GetComPortDevice() const;
+  /// @brief Get the dispatcher for the delivery counters of the listeners
+  const DeviceComDispatcher& dispatcher() const { return dispatcher_; }
+
+ private:
+  enum State { kDisconnected, kConnecting, kConnected };
+
+  /// @brief the methods below are called with the mutex locked
+  void Service(int64_t now_ms);
+  void StartConnect(int64_t now_ms);
+  void Disconnect(int64_t now_ms);
+  void Flush(int64_t now_ms);
+  void ReceiveAvailable(int64_t now_ms);
+  void Expire(int64_t now_ms);
+  void Nudge();
+  /// @brief Wait for the socket or the wakeup once, the mutex unlocked
+  /// @return 0 if wakeup or timeout, -1 if canceled or closed
+  int32_t PollOnce(int32_t max_wait_ms);
+
+ private:
+#if defined(_WIN32)
+  typedef uintptr_t SocketHandle;
+#else
+  typedef int SocketHandle;
+#endif
+  std::string name_;
+  ComPortDevice com_port_device_;
+  DeviceComDispatcher dispatcher_;
+  anx::common::Mutex mutex_;
+  bool opened_;
+  State state_;
+  SocketHandle socket_;
+  /// @brief the udp socket connected to itself wakes up the poll
+  SocketHandle wake_socket_;
+  /// @brief the ipv4 address and port in the network order
+  uint32_t address_;
+  uint16_t port_;
+  int64_t connect_deadline_ms_;
+  int64_t reconnect_at_ms_;
+  int32_t backoff_ms_;
+  bool was_connected_;
+  uint16_t next_transaction_id_;
+  /// @brief the transaction id to the time sent
+  std::map<uint16_t, int64_t> pending_;
+  std::vector<uint8_t> tx_;
+  std::vector<uint8_t> rx_;
+  std::deque<ModbusTcpAdu> responses_;
+  /// @brief the rtu frames not read yet of Read
+  std::vector<uint8_t> rtu_out_;
+  int32_t max_outstanding_;
+  int32_t response_timeout_ms_;
+  int32_t connect_timeout_ms_;
+  int32_t backoff_min_ms_;
+  int32_t backoff_max_ms_;
+  int64_t reconnects_;
+  int64_t timeouts_;
+  int64_t stale_responses_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_DEVICE_COM_TCP_IMPL_H_
@@ -0,0 +1,314 @@
+/**
+ * @file device_com_tcp_impl_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief device com implementation on modbus tcp unit test, the gateway is
+ * simulated by a modbus tcp server on the loopback.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/device_com_tcp_impl.h"
+
+#include <arpa/inet.h>
+#include <gtest/gtest.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "app/common/crc16.h"
+#include "app/common/file_utils.h"
+#include "app/common/module_utils.h"
+#include "app/device/device_com_factory.h"
+#include "app/device/device_com_settings.h"
+#include "app/device/device_com_settings_helper.h"
+#include "app/device/modbus_rtu.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+/// @brief the server answers the read holding registers with the register
+/// address as the value. the requests are answered in the reverse order of
+/// the batch, the connection is closed after the responses of close_after.
+class LoopbackModbusServer {
+ public:
+  LoopbackModbusServer(int32_t batch, int32_t close_after)
+      : batch_(batch), close_after_(close_after), stopped_(false) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), addr_len);
+    getsockname(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr),
+                &addr_len);
+    port_ = ntohs(addr.sin_port);
+    listen(listen_fd_, 4);
+    thread_ = std::thread([this]() { Serve(); });
+  }
+
+  ~LoopbackModbusServer() {
+    stopped_ = true;
+    thread_.join();
+    close(listen_fd_);
+  }
+
+  int32_t port() const { return port_; }
+  int32_t connections() const { return connections_; }
+
+ private:
+  bool WaitReadable(int fd) {
+    while (!stopped_) {
+      struct pollfd pfd = {fd, POLLIN, 0};
+      if (poll(&pfd, 1, 10) > 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Serve() {
+    while (WaitReadable(listen_fd_)) {
+      int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        continue;
+      }
+      connections_++;
+      ServeConnection(fd);
+      close(fd);
+    }
+  }
+
+  void ServeConnection(int fd) {
+    std::vector<uint8_t> rx;
+    std::vector<ModbusTcpAdu> batch;
+    int32_t answered = 0;
+    while (WaitReadable(fd)) {
+      uint8_t buffer[256];
+      ssize_t readed = read(fd, buffer, sizeof(buffer));
+      if (readed <= 0) {
+        return;
+      }
+      rx.insert(rx.end(), buffer, buffer + readed);
+      ModbusTcpAdu adu;
+      int32_t consumed = 0;
+      while ((consumed = DecodeModbusTcpAdu(rx.data(), rx.size(), &adu)) > 0) {
+        rx.erase(rx.begin(), rx.begin() + consumed);
+        batch.push_back(adu);
+      }
+      if (static_cast<int32_t>(batch.size()) < batch_) {
+        continue;
+      }
+      std::vector<uint8_t> tx;
+      for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+        ModbusTcpAdu response = *it;
+        response.pdu = {it->pdu[0], 0x02, it->pdu[1], it->pdu[2]};
+        EncodeModbusTcpAdu(response, &tx);
+      }
+      answered += static_cast<int32_t>(batch.size());
+      batch.clear();
+      if (write(fd, tx.data(), tx.size()) != static_cast<ssize_t>(tx.size())) {
+        return;
+      }
+      if (close_after_ > 0 && answered >= close_after_) {
+        return;
+      }
+    }
+  }
+
+  int listen_fd_;
+  int32_t port_;
+  int32_t batch_;
+  int32_t close_after_;
+  std::atomic<bool> stopped_;
+  std::atomic<int32_t> connections_{0};
+  std::thread thread_;
+};
+
+std::vector<uint8_t> ReadRegisterPdu(uint16_t address) {
+  return {0x03, static_cast<uint8_t>(address >> 8),
+          static_cast<uint8_t>(address & 0xFF), 0x00, 0x01};
+}
+
+int32_t OpenDevice(ComPortDeviceTcpImpl* device, int32_t port) {
+  ComAddressLan com_lan("127.0.0.1", port);
+  ComPortDevice com_port_device("sl2", &com_lan);
+  return device->Open(com_port_device);
+}
+}  // namespace
+
+TEST(ModbusTcpAduTest, EncodeDecode) {
+  ModbusTcpAdu adu;
+  adu.transaction_id = 0x1234;
+  adu.unit_id = 0x11;
+  adu.pdu = ReadRegisterPdu(0x006B);
+  std::vector<uint8_t> bytes;
+  ASSERT_EQ(EncodeModbusTcpAdu(adu, &bytes), 12);
+  const uint8_t expected[] = {0x12, 0x34, 0x00, 0x00, 0x00, 0x06,
+                              0x11, 0x03, 0x00, 0x6B, 0x00, 0x01};
+  EXPECT_EQ(memcmp(bytes.data(), expected, sizeof(expected)), 0);
+
+  ModbusTcpAdu decoded;
+  EXPECT_EQ(DecodeModbusTcpAdu(bytes.data(), 11, &decoded), 0);
+  ASSERT_EQ(DecodeModbusTcpAdu(bytes.data(), bytes.size(), &decoded), 12);
+  EXPECT_EQ(decoded.transaction_id, 0x1234);
+  EXPECT_EQ(decoded.unit_id, 0x11);
+  EXPECT_EQ(decoded.pdu, adu.pdu);
+
+  bytes[2] = 0x01;
+  EXPECT_EQ(DecodeModbusTcpAdu(bytes.data(), bytes.size(), &decoded), -1);
+  adu.pdu.clear();
+  EXPECT_EQ(EncodeModbusTcpAdu(adu, &bytes), -1);
+}
+
+TEST(ComPortDeviceTcpImplTest, PipelinedRequests) {
+  const int32_t kRequests = 8;
+  LoopbackModbusServer server(kRequests, 0);
+  ComPortDeviceTcpImpl device("sl2");
+  ASSERT_EQ(OpenDevice(&device, server.port()), 0);
+  EXPECT_TRUE(device.connected());
+  /// the server answers after the batch, the last request waits for the
+  /// window
+  device.set_max_outstanding(kRequests - 1);
+
+  std::map<int32_t, uint16_t> addresses;
+  for (uint16_t i = 0; i < kRequests; i++) {
+    std::vector<uint8_t> pdu = ReadRegisterPdu(0x0100 + i);
+    if (i == kRequests - 1) {
+      EXPECT_EQ(device.outstanding(), kRequests - 1);
+      EXPECT_EQ(device.Send(0x01, pdu.data(), pdu.size()), -2);
+      device.set_max_outstanding(kRequests);
+    }
+    int32_t transaction_id = device.Send(0x01, pdu.data(), pdu.size());
+    ASSERT_GE(transaction_id, 0);
+    addresses[transaction_id] = 0x0100 + i;
+  }
+
+  /// the responses arrive in the reverse order
+  for (int32_t i = 0; i < kRequests; i++) {
+    ModbusTcpAdu adu;
+    ASSERT_EQ(device.Receive(&adu, 1000), 1);
+    ASSERT_EQ(adu.pdu.size(), 4u);
+    EXPECT_EQ(adu.unit_id, 0x01);
+    EXPECT_EQ((adu.pdu[2] << 8) | adu.pdu[3], addresses[adu.transaction_id]);
+    EXPECT_EQ(adu.transaction_id, kRequests - 1 - i);
+  }
+  EXPECT_EQ(device.outstanding(), 0);
+  ModbusTcpAdu adu;
+  EXPECT_EQ(device.Receive(&adu, 20), 0);
+  EXPECT_EQ(device.timeouts(), 0);
+  EXPECT_EQ(device.stale_responses(), 0);
+}
+
+TEST(ComPortDeviceTcpImplTest, ReconnectWithBackoff) {
+  LoopbackModbusServer server(1, 2);
+  ComPortDeviceTcpImpl device("sl2");
+  device.set_reconnect_backoff(10, 40);
+  ASSERT_EQ(OpenDevice(&device, server.port()), 0);
+  device.set_response_timeout(200);
+  const int32_t kRequests = 6;
+  for (uint16_t i = 0; i < kRequests; i++) {
+    std::vector<uint8_t> pdu = ReadRegisterPdu(i);
+    /// the request sent before the close is seen is lost, sent again
+    ModbusTcpAdu adu;
+    int32_t transaction_id = -1;
+    int32_t received = 0;
+    for (int32_t retry = 0; retry < 100 && received != 1; retry++) {
+      transaction_id = device.Send(0x01, pdu.data(), pdu.size());
+      received = device.Receive(&adu, transaction_id < 0 ? 10 : 500);
+    }
+    ASSERT_EQ(received, 1);
+    EXPECT_EQ(adu.transaction_id, transaction_id);
+    EXPECT_EQ(adu.pdu[3], i);
+  }
+  EXPECT_TRUE(device.isOpened());
+  EXPECT_EQ(device.reconnects(), 2);
+  EXPECT_EQ(server.connections(), 3);
+}
+
+TEST(ComPortDeviceTcpImplTest, ConnectRefused) {
+  int32_t port = 0;
+  {
+    LoopbackModbusServer server(1, 0);
+    port = server.port();
+  }
+  ComPortDeviceTcpImpl device("sl2");
+  device.set_connect_timeout(200);
+  EXPECT_EQ(OpenDevice(&device, port), -3);
+  EXPECT_FALSE(device.isOpened());
+
+  ComAddressPort com_port;
+  ComPortDevice com_port_device("COM1", &com_port);
+  EXPECT_EQ(device.Open(com_port_device), -1);
+}
+
+TEST(ComPortDeviceTcpImplTest, ModbusRtuChannel) {
+  LoopbackModbusServer server(1, 0);
+  ComPortDeviceTcpImpl device("sl2");
+  ASSERT_EQ(OpenDevice(&device, server.port()), 0);
+  uint8_t request[8] = {0x01, 0x03, 0x00, 0x18, 0x00, 0x01, 0x04, 0x0D};
+  ModbusRtuChannel channel(&device);
+  channel.Reset(115200);
+  for (int32_t i = 0; i < 10; i++) {
+    ModbusRtuResponse response;
+    ASSERT_EQ(channel.Transact(request, sizeof(request), 500, &response), 0);
+    ASSERT_EQ(response.size(), 7u);
+    EXPECT_EQ(response.data()[0], 0x01);
+    EXPECT_EQ(response.data()[1], 0x03);
+    EXPECT_EQ(response.data()[4], 0x18);
+    EXPECT_EQ(anx::common::crc16(response.data(), 7), 0);
+    if (i == 5) {
+      channel.Start();
+    }
+  }
+  channel.Stop();
+  EXPECT_EQ(channel.framer().frames(), 10);
+
+  /// the frame with the bad crc is not sent
+  request[7] ^= 0xFF;
+  EXPECT_EQ(device.Write(request, sizeof(request)), -1);
+}
+
+TEST(ComPortDeviceTcpImplTest, FactoryLanUltrasound) {
+  /// the settings of a station of its own, the rig settings are untouched
+  const int32_t kStation = 97;
+  LoopbackModbusServer server(1, 0);
+  ComAddressLan com_lan("127.0.0.1", server.port());
+  ComSettings com_settings(kDeviceCom_Ultrasound, "", &com_lan);
+  ASSERT_EQ(SaveDeviceComSettingsFileDefaultPath(com_settings, kStation), 0);
+  std::shared_ptr<DeviceComInterface> device_com =
+      DeviceComFactory::Instance()->CreateOrGetDeviceComWithType(
+          kStation, kDeviceCom_Ultrasound, nullptr);
+  ASSERT_NE(device_com, nullptr);
+  ComPortDeviceTcpImpl* tcp_device =
+      dynamic_cast<ComPortDeviceTcpImpl*>(device_com.get());
+  ASSERT_NE(tcp_device, nullptr);
+  ASSERT_EQ(DeviceComFactory::Instance()->OpenDeviceComWithType(
+                kStation, kDeviceCom_Ultrasound),
+            0);
+  EXPECT_TRUE(tcp_device->connected());
+  uint8_t request[8] = {0x01, 0x03, 0x00, 0x18, 0x00, 0x01, 0x04, 0x0D};
+  ModbusRtuChannel channel(device_com.get());
+  channel.Reset(0);
+  ModbusRtuResponse response;
+  ASSERT_EQ(channel.Transact(request, sizeof(request), 500, &response), 0);
+  EXPECT_EQ(response.size(), 7u);
+  DeviceComFactory::Instance()->ReleaseStation(kStation);
+  anx::common::RemoveFile(anx::common::GetApplicationDataPath("anxi") +
+                          anx::common::kPathSeparator +
+                          DefaultDeviceComSettingsXmlFilePath(
+                              kDeviceCom_Ultrasound, kStation));
+}
+
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,390 @@
+/**
+ * @file device_watchdog.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the watchdog of the devices
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/device_watchdog.h"
+
+#include <algorithm>
+
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+#include "app/device/modbus_rtu.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+int64_t NowMicros() {
+  return static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+}
+}  // namespace
+
+int32_t DeviceWatchdogHeartbeatTimeoutMs(int32_t baud_rate) {
+  if (baud_rate <= 0) {
+    return kDeviceWatchdogHeartbeatTimeoutMs;
+  }
+  /// 10 bits a byte, the frames and the 3.5 characters after each of them
+  int64_t line_us = (kDeviceWatchdogHeartbeatBytes + 7) * 10 * 1000000LL /
+                    baud_rate;
+  return static_cast<int32_t>((line_us + kModbusRtuFrameTimeoutUs) / 1000 + 1);
+}
+
+std::string DeviceHealthEventTypeToString(int32_t type) {
+  switch (type) {
+    case kDeviceHealthEventLost:
+      return "lost";
+    case kDeviceHealthEventReconnectAttempt:
+      return "reconnect attempt";
+    case kDeviceHealthEventRecovered:
+      return "recovered";
+    case kDeviceHealthEventReconnectFailed:
+      return "reconnect failed";
+    default:
+      return "unkown";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// clz DeviceWatchdog
+
+DeviceWatchdog::DeviceWatchdog(const DeviceWatchdogOptions& options)
+    : options_(options), delivering_(false), events_(0) {
+  if (options_.heartbeat_timeout_ms < 0) {
+    options_.heartbeat_timeout_ms = 0;
+  }
+  if (options_.heartbeat_idle_ms < 0) {
+    options_.heartbeat_idle_ms = 0;
+  }
+  if (options_.line_budget <= 0 || options_.line_budget > 1) {
+    options_.line_budget = 0.1;
+  }
+  if (options_.heartbeat_misses < 1) {
+    options_.heartbeat_misses = 1;
+  }
+  if (options_.reconnect_attempts < 1) {
+    options_.reconnect_attempts = 1;
+  }
+  if (options_.reconnect_backoff_ms < 0) {
+    options_.reconnect_backoff_ms = 0;
+  }
+  if (options_.retry_interval_ms < 0) {
+    options_.retry_interval_ms = 0;
+  }
+}
+
+DeviceWatchdog::~DeviceWatchdog() {
+  Stop();
+}
+
+int32_t DeviceWatchdog::AddDevice(const std::string& name,
+                                  DeviceProbe* probe) {
+  anx::common::AutoLock lock(&mutex_);
+  if (thread_ != nullptr || probe == nullptr) {
+    return -1;
+  }
+  Device device;
+  device.name = name;
+  device.probe = probe;
+  devices_.push_back(device);
+  states_.push_back(kDeviceHealthIdle);
+  poll_intervals_.push_back(0);
+  return static_cast<int32_t>(devices_.size()) - 1;
+}
+
+int32_t DeviceWatchdog::Start() {
+  if (thread_ != nullptr) {
+    return -1;
+  }
+  {
+    anx::common::AutoLock lock(&mutex_);
+    stop_ = false;
+  }
+  thread_.reset(new anx::common::Thread(this));
+  thread_->start();
+  return 0;
+}
+
+void DeviceWatchdog::Stop() {
+  interrupt();
+  if (thread_ == nullptr) {
+    return;
+  }
+  if (thread_->is_current_thread()) {
+    LOG_F(LG_WARN) << "stop the device watchdog from the watchdog thread";
+    return;
+  }
+  thread_->join();
+  thread_.reset();
+}
+
+void DeviceWatchdog::SetPollInterval(int32_t device, int32_t interval_ms) {
+  anx::common::AutoLock lock(&mutex_);
+  if (device < 0 || device >= static_cast<int32_t>(poll_intervals_.size())) {
+    return;
+  }
+  poll_intervals_[device] = std::max(0, interval_ms);
+}
+
+int32_t DeviceWatchdog::state(int32_t device) {
+  anx::common::AutoLock lock(&mutex_);
+  if (device < 0 || device >= static_cast<int32_t>(states_.size())) {
+    return kDeviceHealthIdle;
+  }
+  return states_[device];
+}
+
+int64_t DeviceWatchdog::events() {
+  anx::common::AutoLock lock(&mutex_);
+  return events_;
+}
+
+void DeviceWatchdog::AddListener(DeviceWatchdogListener* listener) {
+  anx::common::AutoLock lock(&mutex_);
+  if (std::find(listeners_.begin(), listeners_.end(), listener) ==
+      listeners_.end()) {
+    listeners_.push_back(listener);
+  }
+}
+
+void DeviceWatchdog::RemoveListener(DeviceWatchdogListener* listener) {
+  anx::common::AutoLock lock(&mutex_);
+  listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), listener),
+                   listeners_.end());
+  if (thread_ != nullptr && thread_->is_current_thread()) {
+    return;
+  }
+  while (delivering_) {
+    cond_.wait(&mutex_);
+  }
+}
+
+void DeviceWatchdog::interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  stop_ = true;
+  cond_.broadcast();
+}
+
+bool DeviceWatchdog::is_interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  return stop_;
+}
+
+void DeviceWatchdog::run() {
+  /// five ticks a heartbeat timeout, the silence is noticed at most a tick
+  /// late. the derived timeout is not shorter than the frame timeout.
+  int64_t timeout_us = options_.heartbeat_timeout_ms * 1000;
+  if (timeout_us == 0) {
+    timeout_us = kModbusRtuFrameTimeoutUs;
+  }
+  const int64_t tick_us = std::max<int64_t>(1000, timeout_us / 5);
+  while (!WaitFor(tick_us)) {
+    for (size_t i = 0; i < devices_.size(); i++) {
+      Probe(static_cast<int32_t>(i), NowMicros());
+    }
+  }
+}
+
+void DeviceWatchdog::Probe(int32_t id, int64_t now_us) {
+  Device& device = devices_[id];
+  if (!device.probe->ProbeEnabled()) {
+    if (device.state != kDeviceHealthIdle) {
+      SetState(id, kDeviceHealthIdle);
+    }
+    return;
+  }
+  int64_t last_us =
+      std::max(device.last_response_us, device.probe->LastResponseUs());
+  if (device.state == kDeviceHealthIdle) {
+    /// the silence is counted from the device enabled
+    device.last_response_us = std::max(last_us, now_us);
+    device.attempts = 0;
+    device.misses = 0;
+    /// the baud rate is known after the device opened
+    device.heartbeat_timeout_ms = options_.heartbeat_timeout_ms;
+    if (device.heartbeat_timeout_ms == 0) {
+      device.heartbeat_timeout_ms =
+          DeviceWatchdogHeartbeatTimeoutMs(device.probe->ProbeBaudRate());
+    }
+    /// the line is held by the heartbeat up to the timeout
+    device.heartbeat_idle_ms = options_.heartbeat_idle_ms;
+    if (device.heartbeat_idle_ms == 0) {
+      device.heartbeat_idle_ms = static_cast<int32_t>(
+          device.heartbeat_timeout_ms / options_.line_budget);
+    }
+    SetState(id, kDeviceHealthAlive);
+    return;
+  }
+  if (device.state != kDeviceHealthAlive) {
+    if (last_us > device.lost_us) {
+      /// another user of the device got the response
+      device.last_response_us = last_us;
+      SetState(id, kDeviceHealthAlive);
+      Raise(id, kDeviceHealthEventRecovered, now_us, 0, false);
+      device.attempts = 0;
+      return;
+    }
+    Reconnect(id, now_us);
+    return;
+  }
+  if (last_us > device.last_response_us) {
+    device.misses = 0;
+  }
+  device.last_response_us = last_us;
+  int32_t poll_interval_ms = 0;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    poll_interval_ms = poll_intervals_[id];
+  }
+  int32_t ret = 0;
+  if (poll_interval_ms > 0) {
+    /// the polls are the heartbeats, the line is not read more
+    int64_t silence_budget_us =
+        (static_cast<int64_t>(options_.heartbeat_misses) * poll_interval_ms +
+         device.heartbeat_timeout_ms) *
+        1000;
+    if (now_us - last_us < silence_budget_us) {
+      device.misses = 0;
+      return;
+    }
+    ret = -3;
+  } else {
+    if (device.misses == 0 &&
+        now_us - last_us < device.heartbeat_idle_ms * 1000LL) {
+      return;
+    }
+    ret = device.probe->Heartbeat(device.heartbeat_timeout_ms);
+    now_us = NowMicros();
+    if (ret == 0) {
+      device.misses = 0;
+      device.last_response_us =
+          std::max(now_us, device.probe->LastResponseUs());
+      return;
+    }
+    last_us = std::max(last_us, device.probe->LastResponseUs());
+    if (ret > 0 || last_us > device.last_response_us) {
+      /// the other user has the line, its response tells the health
+      device.last_response_us = last_us;
+      return;
+    }
+    if (++device.misses < options_.heartbeat_misses) {
+      return;
+    }
+  }
+  LOG_F(LG_WARN) << "device " << device.name << " silent "
+                 << (now_us - last_us) / 1000 << " ms, misses:"
+                 << device.misses << " ret:" << ret;
+  device.misses = 0;
+  device.lost_us = now_us;
+  device.attempts = 0;
+  device.next_attempt_us = now_us;
+  SetState(id, kDeviceHealthLost);
+  Raise(id, kDeviceHealthEventLost, now_us, ret, false);
+  Reconnect(id, now_us);
+}
+
+void DeviceWatchdog::Reconnect(int32_t id, int64_t now_us) {
+  Device& device = devices_[id];
+  if (now_us < device.next_attempt_us) {
+    return;
+  }
+  int32_t ret = device.probe->Reconnect();
+  if (ret == 0) {
+    ret = device.probe->Heartbeat(device.heartbeat_timeout_ms);
+  }
+  device.attempts++;
+  now_us = NowMicros();
+  if (ret == 0) {
+    LOG_F(LG_INFO) << "device " << device.name << " reconnected, attempts:"
+                   << device.attempts;
+    device.last_response_us = std::max(now_us, device.probe->LastResponseUs());
+    SetState(id, kDeviceHealthAlive);
+    Raise(id, kDeviceHealthEventRecovered, now_us, 0, true);
+    device.attempts = 0;
+    return;
+  }
+  if (device.state == kDeviceHealthFailed) {
+    device.next_attempt_us = now_us + options_.retry_interval_ms * 1000;
+    return;
+  }
+  if (device.attempts < options_.reconnect_attempts) {
+    device.next_attempt_us = now_us + options_.reconnect_backoff_ms * 1000;
+    Raise(id, kDeviceHealthEventReconnectAttempt, now_us, ret, false);
+    return;
+  }
+  LOG_F(LG_ERROR) << "device " << device.name
+                  << " reconnect failed, attempts:" << device.attempts
+                  << " ret:" << ret;
+  device.next_attempt_us = options_.retry_interval_ms > 0
+                               ? now_us + options_.retry_interval_ms * 1000
+                               : INT64_MAX;
+  SetState(id, kDeviceHealthFailed);
+  Raise(id, kDeviceHealthEventReconnectFailed, now_us, ret, false);
+}
+
+void DeviceWatchdog::SetState(int32_t id, int32_t state) {
+  devices_[id].state = state;
+  anx::common::AutoLock lock(&mutex_);
+  states_[id] = state;
+}
+
+void DeviceWatchdog::Raise(int32_t id,
+                           int32_t type,
+                           int64_t now_us,
+                           int32_t error,
+                           bool reconnected) {
+  const Device& device = devices_[id];
+  DeviceHealthEvent event;
+  event.device = id;
+  event.name = device.name;
+  event.type = type;
+  event.state = device.state;
+  event.time_ms = now_us / 1000;
+  event.silence_ms = (now_us - device.last_response_us) / 1000;
+  if (type == kDeviceHealthEventRecovered) {
+    event.silence_ms = (now_us - device.lost_us) / 1000;
+  }
+  event.attempts = device.attempts;
+  event.reconnected = reconnected;
+  event.error = error;
+
+  std::vector<DeviceWatchdogListener*> listeners;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    events_++;
+    listeners = listeners_;
+    delivering_ = true;
+  }
+  for (auto listener : listeners) {
+    {
+      /// the listener may be removed by the listener called before
+      anx::common::AutoLock lock(&mutex_);
+      if (std::find(listeners_.begin(), listeners_.end(), listener) ==
+          listeners_.end()) {
+        continue;
+      }
+    }
+    listener->OnDeviceHealthEvent(this, event);
+  }
+  anx::common::AutoLock lock(&mutex_);
+  delivering_ = false;
+  cond_.broadcast();
+}
+
+bool DeviceWatchdog::WaitFor(int64_t wait_us) {
+  anx::common::AutoLock lock(&mutex_);
+  if (!stop_) {
+    cond_.wait(&mutex_, static_cast<unsigned int>(
+                            std::max<int64_t>(1, wait_us / 1000)));
+  }
+  return stop_;
+}
+
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,244 @@
+/**
+ * @file device_watchdog.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the watchdog of the devices, it tracks the last response of each
+ * device, reads the heartbeat when the line is idle and not polled, reconnects
+ * the silent devices and raises the health events.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_DEVICE_WATCHDOG_H_
+#define APP_DEVICE_DEVICE_WATCHDOG_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/common/thread.h"
+
+namespace anx {
+namespace device {
+
+/// @brief the bytes of the heartbeat on the line, the request and the
+/// response of one register read
+const int32_t kDeviceWatchdogHeartbeatBytes = 8 + 7;
+/// @brief the heartbeat timeout of the device without the baud rate, e.g. the
+/// tcp port
+const int32_t kDeviceWatchdogHeartbeatTimeoutMs = 100;
+
+/// @brief Get the heartbeat timeout of the baud rate, the frames of the
+/// heartbeat and the silences after them, with the turnaround of the device
+/// and the latency of the usb serial adapters.
+/// @param baud_rate the baud rate, 0 if unknown
+int32_t DeviceWatchdogHeartbeatTimeoutMs(int32_t baud_rate);
+
+/// @brief the device probed by the watchdog, called on the watchdog thread
+/// and the transactions of the device are serialized with the other users.
+class DeviceProbe {
+ public:
+  virtual ~DeviceProbe() = default;
+
+  /// @brief the device is opened by the user, the port may be closed by a
+  /// failed reconnect. the disabled device is not probed.
+  virtual bool ProbeEnabled() = 0;
+  /// @brief Get the baud rate of the line for the heartbeat timeout
+  /// @return the baud rate, 0 if unknown or not a serial port
+  virtual int32_t ProbeBaudRate() = 0;
+  /// @brief Get the time of the last response of the device, by any user
+  /// @return the time in microseconds, @see GetCurrentTimeMicros, 0 if none
+  virtual int64_t LastResponseUs() = 0;
+  /// @brief Read a register cheap to read, e.g. the fault code
+  /// @param timeout_ms the max wait time of the line and the response
+  /// @return 0 if success, 1 if the line is used by the other user until the
+  /// timeout, < 0 if failed
+  virtual int32_t Heartbeat(int32_t timeout_ms) = 0;
+  /// @brief Close and open the port again with the settings of the last open
+  /// @return 0 if success, < 0 if failed
+  virtual int32_t Reconnect() = 0;
+};
+
+/// @brief the health of the device
+enum DeviceHealthState {
+  /// @brief not probed, the device is not enabled
+  kDeviceHealthIdle = 0,
+  kDeviceHealthAlive = 1,
+  /// @brief the heartbeats or the polls are missed, reconnecting
+  kDeviceHealthLost = 2,
+  /// @brief the reconnect attempts are exhausted, retried at the interval
+  kDeviceHealthFailed = 3,
+};
+
+/// @brief the type of DeviceHealthEvent
+enum DeviceHealthEventType {
+  /// @brief the heartbeats or the polls of the device are missed
+  kDeviceHealthEventLost = 1,
+  /// @brief one reconnect attempt failed
+  kDeviceHealthEventReconnectAttempt = 2,
+  /// @brief the device responds again, reconnected or not
+  kDeviceHealthEventRecovered = 3,
+  /// @brief the reconnect attempts are exhausted
+  kDeviceHealthEventReconnectFailed = 4,
+};
+
+std::string DeviceHealthEventTypeToString(int32_t type);
+
+struct DeviceHealthEvent {
+  /// @brief the id of DeviceWatchdog::AddDevice
+  int32_t device = -1;
+  std::string name;
+  /// @brief @see DeviceHealthEventType
+  int32_t type = 0;
+  /// @brief @see DeviceHealthState after the event
+  int32_t state = kDeviceHealthIdle;
+  /// @brief the time of the event in milliseconds
+  int64_t time_ms = 0;
+  /// @brief the time since the last response
+  int64_t silence_ms = 0;
+  /// @brief the reconnect attempts of the loss
+  int32_t attempts = 0;
+  /// @brief the port is reopened for the recovery
+  bool reconnected = false;
+  /// @brief the result of the last heartbeat or reconnect
+  int32_t error = 0;
+};
+
+struct DeviceWatchdogOptions {
+  /// @brief the max wait time of the heartbeat, 0 follows the baud rate of
+  /// the device, @see DeviceWatchdogHeartbeatTimeoutMs
+  int32_t heartbeat_timeout_ms = 0;
+  /// @brief the heartbeat is read after the idle, 0 keeps the heartbeats
+  /// within the line budget
+  int32_t heartbeat_idle_ms = 0;
+  /// @brief the max share of the line used by the heartbeats, the polls have
+  /// their own, @see AdaptivePollerOptions::line_budget
+  double line_budget = 0.1;
+  /// @brief the consecutive heartbeats failed, or the poll intervals without
+  /// a response, noticed as lost
+  int32_t heartbeat_misses = 3;
+  /// @brief the reconnect attempts of one loss
+  int32_t reconnect_attempts = 3;
+  /// @brief the wait between the reconnect attempts
+  int32_t reconnect_backoff_ms = 100;
+  /// @brief the interval of the reconnect after the attempts are exhausted,
+  /// 0 retries no more.
+  int32_t retry_interval_ms = 2000;
+};
+
+class DeviceWatchdog;
+
+class DeviceWatchdogListener {
+ public:
+  virtual ~DeviceWatchdogListener() = default;
+
+  /// @brief On the health event, called on the thread of the watchdog
+  virtual void OnDeviceHealthEvent(DeviceWatchdog* watchdog,
+                                   const DeviceHealthEvent& event) = 0;
+};
+
+////////////////////////////////////////////////////////////
+// clz DeviceWatchdog
+/// @brief one thread probes all the devices. the silence is measured from
+/// the last response of any user of the device, the heartbeat is read only
+/// when the line is idle and the device is not polled. the polled device is
+/// lost when the polls get no response for the misses, the others when the
+/// heartbeats fail for the misses. the heartbeat waiting the transaction of
+/// the other user until its timeout is not a miss.
+class DeviceWatchdog : public anx::common::Runnable {
+ public:
+  explicit DeviceWatchdog(const DeviceWatchdogOptions& options);
+  ~DeviceWatchdog() override;
+
+  DeviceWatchdog(const DeviceWatchdog&) = delete;
+  DeviceWatchdog& operator=(const DeviceWatchdog&) = delete;
+
+ public:
+  /// @brief Add the device before Start
+  /// @param name the name for the events and the log
+  /// @param probe the probe, not owned, outlives the watchdog thread
+  /// @return the device id, -1 if started or the probe is null
+  int32_t AddDevice(const std::string& name, DeviceProbe* probe);
+
+  /// @brief Start the watchdog thread
+  /// @return 0 if success, -1 if started
+  int32_t Start();
+  /// @brief Stop the watchdog thread, the reconnect in progress is finished
+  void Stop();
+
+  /// @brief Set the interval of the device polled by the user, the heartbeats
+  /// are not read while polled, called from any thread.
+  /// @param interval_ms the max interval of the polls, 0 if not polled
+  void SetPollInterval(int32_t device, int32_t interval_ms);
+
+  /// @brief Get the health of the device
+  /// @return @see DeviceHealthState, kDeviceHealthIdle if the id is invalid
+  int32_t state(int32_t device);
+  /// @brief Get the count of the events raised
+  int64_t events();
+
+  void AddListener(DeviceWatchdogListener* listener);
+  /// @brief Remove the listener, after it returns the listener is not called
+  /// any more, it may be called from the listener itself.
+  void RemoveListener(DeviceWatchdogListener* listener);
+
+  const DeviceWatchdogOptions& options() const { return options_; }
+
+  void interrupt() override;
+  bool is_interrupt() override;
+
+ protected:
+  void run() override;
+
+ private:
+  struct Device {
+    std::string name;
+    DeviceProbe* probe = nullptr;
+    int32_t state = kDeviceHealthIdle;
+    /// @brief the last response seen, by the users or the heartbeats
+    int64_t last_response_us = 0;
+    /// @brief the options of the baud rate when the device is enabled
+    int32_t heartbeat_timeout_ms = 0;
+    int32_t heartbeat_idle_ms = 0;
+    /// @brief the consecutive heartbeats failed
+    int32_t misses = 0;
+    /// @brief the time of the loss
+    int64_t lost_us = 0;
+    int32_t attempts = 0;
+    /// @brief the time of the next reconnect attempt
+    int64_t next_attempt_us = 0;
+  };
+  /// @brief Probe the device once
+  void Probe(int32_t id, int64_t now_us);
+  /// @brief Reconnect the lost device if the attempt is due
+  void Reconnect(int32_t id, int64_t now_us);
+  void SetState(int32_t id, int32_t state);
+  void Raise(int32_t id, int32_t type, int64_t now_us, int32_t error,
+             bool reconnected);
+  /// @brief Wait for the time or the stop
+  /// @return true if stopped
+  bool WaitFor(int64_t wait_us);
+
+ private:
+  DeviceWatchdogOptions options_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  /// @brief the devices are used by the thread of the watchdog only after
+  /// Start, the states are read by the others under the mutex.
+  std::vector<Device> devices_;
+  std::vector<int32_t> states_;
+  std::vector<int32_t> poll_intervals_;
+  std::vector<DeviceWatchdogListener*> listeners_;
+  bool delivering_;
+  int64_t events_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_DEVICE_WATCHDOG_H_
@@ -0,0 +1,302 @@
+/**
+ * @file device_watchdog_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the device watchdog unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/device_watchdog.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+int64_t NowMicros() {
+  return static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+}
+
+/// @brief the device answers while responding, the reconnect makes it
+/// responding if reconnectable. the busy line is held by the other user.
+class FakeProbe : public DeviceProbe {
+ public:
+  FakeProbe()
+      : enabled(true),
+        responding(true),
+        busy(false),
+        reconnectable(false),
+        last_response_us(0),
+        heartbeats(0),
+        reconnects(0) {}
+
+  bool ProbeEnabled() override { return enabled; }
+  int32_t ProbeBaudRate() override { return 9600; }
+  int64_t LastResponseUs() override { return last_response_us; }
+  int32_t Heartbeat(int32_t timeout_ms) override {
+    heartbeats++;
+    if (busy) {
+      anx::common::sleep_ms(std::min(timeout_ms, 10));
+      return 1;
+    }
+    if (!responding) {
+      anx::common::sleep_ms(std::min(timeout_ms, 10));
+      return -3;
+    }
+    last_response_us = NowMicros();
+    return 0;
+  }
+  int32_t Reconnect() override {
+    reconnects++;
+    if (!reconnectable) {
+      return -2;
+    }
+    responding = true;
+    return 0;
+  }
+
+  std::atomic<bool> enabled;
+  std::atomic<bool> responding;
+  std::atomic<bool> busy;
+  std::atomic<bool> reconnectable;
+  std::atomic<int64_t> last_response_us;
+  std::atomic<int32_t> heartbeats;
+  std::atomic<int32_t> reconnects;
+};
+
+class EventListener : public DeviceWatchdogListener {
+ public:
+  void OnDeviceHealthEvent(DeviceWatchdog* watchdog,
+                           const DeviceHealthEvent& event) override {
+    anx::common::AutoLock lock(&mutex_);
+    events_.push_back(event);
+  }
+  std::vector<DeviceHealthEvent> events() {
+    anx::common::AutoLock lock(&mutex_);
+    return events_;
+  }
+  /// @brief Wait for the event of the type
+  /// @return true if got in the timeout
+  bool WaitFor(int32_t type, int32_t timeout_ms, DeviceHealthEvent* event) {
+    int64_t deadline_ms = anx::common::GetCurrentTimeMillis() + timeout_ms;
+    while (anx::common::GetCurrentTimeMillis() < deadline_ms) {
+      for (const auto& item : events()) {
+        if (item.type == type) {
+          *event = item;
+          return true;
+        }
+      }
+      anx::common::sleep_ms(1);
+    }
+    return false;
+  }
+
+ private:
+  anx::common::Mutex mutex_;
+  std::vector<DeviceHealthEvent> events_;
+};
+
+DeviceWatchdogOptions Budget(int32_t heartbeat_ms) {
+  DeviceWatchdogOptions options;
+  options.heartbeat_timeout_ms = heartbeat_ms;
+  options.heartbeat_idle_ms = heartbeat_ms;
+  options.heartbeat_misses = 3;
+  options.reconnect_attempts = 3;
+  options.reconnect_backoff_ms = 20;
+  options.retry_interval_ms = 100;
+  return options;
+}
+}  // namespace
+
+TEST(DeviceWatchdogTest, HeartbeatTimeoutOfBaudRate) {
+  EXPECT_EQ(DeviceWatchdogHeartbeatTimeoutMs(0),
+            kDeviceWatchdogHeartbeatTimeoutMs);
+  /// 22 bytes at 9600 is 22.9 ms
+  EXPECT_EQ(DeviceWatchdogHeartbeatTimeoutMs(9600), 73);
+  EXPECT_EQ(DeviceWatchdogHeartbeatTimeoutMs(115200), 52);
+  /// the idle keeps the heartbeats within the line budget
+  DeviceWatchdog watchdog((DeviceWatchdogOptions()));
+  FakeProbe probe;
+  int32_t id = watchdog.AddDevice("ultra", &probe);
+  ASSERT_EQ(watchdog.Start(), 0);
+  anx::common::sleep_ms(500);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthAlive);
+  EXPECT_EQ(probe.heartbeats, 0);
+  watchdog.Stop();
+}
+
+TEST(DeviceWatchdogTest, HeartbeatOnlyWhenIdle) {
+  DeviceWatchdog watchdog(Budget(50));
+  FakeProbe probe;
+  EXPECT_EQ(watchdog.AddDevice("null", nullptr), -1);
+  int32_t id = watchdog.AddDevice("ultra", &probe);
+  ASSERT_EQ(id, 0);
+  EventListener listener;
+  watchdog.AddListener(&listener);
+  /// the user of the device keeps the line busy
+  probe.last_response_us = NowMicros();
+  ASSERT_EQ(watchdog.Start(), 0);
+  EXPECT_EQ(watchdog.Start(), -1);
+  EXPECT_EQ(watchdog.AddDevice("late", &probe), -1);
+  for (int32_t i = 0; i < 40; i++) {
+    probe.last_response_us = NowMicros();
+    anx::common::sleep_ms(5);
+  }
+  EXPECT_EQ(probe.heartbeats, 0);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthAlive);
+  /// the line is idle, the heartbeats keep the device alive
+  anx::common::sleep_ms(300);
+  EXPECT_GT(probe.heartbeats, 0);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthAlive);
+  watchdog.Stop();
+  watchdog.RemoveListener(&listener);
+  EXPECT_TRUE(listener.events().empty());
+  EXPECT_EQ(watchdog.events(), 0);
+}
+
+TEST(DeviceWatchdogTest, DetectsSilenceAndReconnects) {
+  DeviceWatchdog watchdog(Budget(50));
+  FakeProbe probe;
+  int32_t id = watchdog.AddDevice("ultra", &probe);
+  EventListener listener;
+  watchdog.AddListener(&listener);
+  ASSERT_EQ(watchdog.Start(), 0);
+  anx::common::sleep_ms(100);
+  int64_t silent_ms = anx::common::GetCurrentTimeMillis();
+  int32_t heartbeats = probe.heartbeats;
+  probe.responding = false;
+  DeviceHealthEvent lost;
+  ASSERT_TRUE(listener.WaitFor(kDeviceHealthEventLost, 1000, &lost));
+  EXPECT_EQ(lost.device, id);
+  EXPECT_EQ(lost.name, "ultra");
+  EXPECT_GE(lost.silence_ms, 50);
+  /// the misses are consecutive
+  EXPECT_GE(probe.heartbeats - heartbeats, 3);
+  /// the idle and the misses with the ticks and the slack
+  EXPECT_LT(lost.time_ms - silent_ms, 300);
+  DeviceHealthEvent failed;
+  ASSERT_TRUE(
+      listener.WaitFor(kDeviceHealthEventReconnectFailed, 1000, &failed));
+  EXPECT_EQ(failed.attempts, 3);
+  EXPECT_EQ(failed.state, kDeviceHealthFailed);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthFailed);
+  /// the device is back, the retry reconnects it
+  probe.reconnectable = true;
+  DeviceHealthEvent recovered;
+  ASSERT_TRUE(
+      listener.WaitFor(kDeviceHealthEventRecovered, 1000, &recovered));
+  EXPECT_TRUE(recovered.reconnected);
+  EXPECT_EQ(recovered.state, kDeviceHealthAlive);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthAlive);
+  watchdog.Stop();
+  watchdog.RemoveListener(&listener);
+  std::vector<DeviceHealthEvent> events = listener.events();
+  int32_t attempts = 0;
+  for (const auto& event : events) {
+    if (event.type == kDeviceHealthEventReconnectAttempt) {
+      attempts++;
+    }
+  }
+  EXPECT_EQ(attempts, 2);
+  EXPECT_EQ(events.front().type, kDeviceHealthEventLost);
+  EXPECT_EQ(events.back().type, kDeviceHealthEventRecovered);
+}
+
+TEST(DeviceWatchdogTest, RecoversByOtherUserResponse) {
+  DeviceWatchdogOptions options = Budget(50);
+  options.reconnect_backoff_ms = 1000;
+  DeviceWatchdog watchdog(options);
+  FakeProbe probe;
+  int32_t id = watchdog.AddDevice("ultra", &probe);
+  EventListener listener;
+  watchdog.AddListener(&listener);
+  probe.responding = false;
+  ASSERT_EQ(watchdog.Start(), 0);
+  DeviceHealthEvent event;
+  ASSERT_TRUE(listener.WaitFor(kDeviceHealthEventLost, 1000, &event));
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthLost);
+  /// the transaction of the sampling gets the response
+  probe.last_response_us = NowMicros();
+  ASSERT_TRUE(listener.WaitFor(kDeviceHealthEventRecovered, 500, &event));
+  EXPECT_FALSE(event.reconnected);
+  EXPECT_EQ(event.attempts, 1);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthAlive);
+  watchdog.Stop();
+  watchdog.RemoveListener(&listener);
+}
+
+TEST(DeviceWatchdogTest, PolledDeviceSkipsHeartbeats) {
+  DeviceWatchdog watchdog(Budget(20));
+  FakeProbe probe;
+  int32_t id = watchdog.AddDevice("ultra", &probe);
+  EventListener listener;
+  watchdog.AddListener(&listener);
+  watchdog.SetPollInterval(id, 40);
+  ASSERT_EQ(watchdog.Start(), 0);
+  for (int32_t i = 0; i < 10; i++) {
+    probe.last_response_us = NowMicros();
+    anx::common::sleep_ms(30);
+  }
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthAlive);
+  /// the polls stop getting the responses
+  int64_t silent_ms = anx::common::GetCurrentTimeMillis();
+  DeviceHealthEvent lost;
+  ASSERT_TRUE(listener.WaitFor(kDeviceHealthEventLost, 1000, &lost));
+  /// the misses of the poll interval and the heartbeat timeout
+  EXPECT_GE(lost.time_ms - silent_ms, 3 * 40 + 20 - 30);
+  EXPECT_EQ(probe.heartbeats, 0);
+  watchdog.Stop();
+  watchdog.RemoveListener(&listener);
+}
+
+TEST(DeviceWatchdogTest, BusyLineIsNotMissed) {
+  DeviceWatchdog watchdog(Budget(20));
+  FakeProbe probe;
+  int32_t id = watchdog.AddDevice("ultra", &probe);
+  ASSERT_EQ(watchdog.Start(), 0);
+  probe.busy = true;
+  anx::common::sleep_ms(300);
+  EXPECT_GT(probe.heartbeats, 3);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthAlive);
+  watchdog.Stop();
+  EXPECT_EQ(watchdog.events(), 0);
+}
+
+TEST(DeviceWatchdogTest, DisabledDeviceIsNotProbed) {
+  DeviceWatchdog watchdog(Budget(20));
+  FakeProbe probe;
+  probe.enabled = false;
+  probe.responding = false;
+  int32_t id = watchdog.AddDevice("ultra", &probe);
+  ASSERT_EQ(watchdog.Start(), 0);
+  anx::common::sleep_ms(100);
+  EXPECT_EQ(probe.heartbeats, 0);
+  EXPECT_EQ(probe.reconnects, 0);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthIdle);
+  EXPECT_EQ(watchdog.state(id + 1), kDeviceHealthIdle);
+  /// the silence is counted from the device enabled
+  probe.responding = true;
+  probe.enabled = true;
+  anx::common::sleep_ms(100);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthAlive);
+  EXPECT_GT(probe.heartbeats, 0);
+  probe.enabled = false;
+  anx::common::sleep_ms(50);
+  EXPECT_EQ(watchdog.state(id), kDeviceHealthIdle);
+  watchdog.Stop();
+  EXPECT_EQ(watchdog.events(), 0);
+}
+
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,125 @@
+/**
+ * @file modbus_register_cache.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the cache of the modbus holding registers
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/modbus_register_cache.h"
+
+namespace anx {
+namespace device {
+
+ModbusRegisterCache::ModbusRegisterCache() {}
+
+ModbusRegisterCache::~ModbusRegisterCache() {}
+
+void ModbusRegisterCache::SetPolicy(uint16_t address,
+                                    RegisterCachePolicy policy,
+                                    int64_t max_age_ms) {
+  anx::common::AutoLock lock(&mutex_);
+  Entry& entry = entries_[address];
+  entry.policy = policy;
+  entry.max_age_ms = max_age_ms;
+  entry.valid = false;
+  entry.generation++;
+}
+
+bool ModbusRegisterCache::Lookup(uint16_t address,
+                                 int64_t now_ms,
+                                 int32_t* value) {
+  anx::common::AutoLock lock(&mutex_);
+  auto it = entries_.find(address);
+  if (it == entries_.end() || it->second.policy == kRegisterCacheNone) {
+    return false;
+  }
+  Entry& entry = it->second;
+  if (entry.valid && entry.policy == kRegisterCacheMaxAge &&
+      now_ms - entry.stored_ms >= entry.max_age_ms) {
+    entry.valid = false;
+  }
+  if (!entry.valid) {
+    stats_.misses++;
+    return false;
+  }
+  stats_.hits++;
+  *value = entry.value;
+  return true;
+}
+
+uint64_t ModbusRegisterCache::generation(uint16_t address) {
+  anx::common::AutoLock lock(&mutex_);
+  auto it = entries_.find(address);
+  return it != entries_.end() ? it->second.generation : 0;
+}
+
+bool ModbusRegisterCache::Store(uint16_t address,
+                                int32_t value,
+                                int64_t now_ms,
+                                uint64_t generation) {
+  anx::common::AutoLock lock(&mutex_);
+  auto it = entries_.find(address);
+  if (it == entries_.end() || it->second.policy == kRegisterCacheNone) {
+    return false;
+  }
+  /// the read raced with a write or an invalidation, the value is stale
+  if (it->second.generation != generation) {
+    return false;
+  }
+  it->second.valid = true;
+  it->second.value = value;
+  it->second.stored_ms = now_ms;
+  return true;
+}
+
+void ModbusRegisterCache::Write(uint16_t address,
+                                int32_t value,
+                                int64_t now_ms) {
+  anx::common::AutoLock lock(&mutex_);
+  stats_.writes++;
+  auto it = entries_.find(address);
+  if (it == entries_.end() || it->second.policy == kRegisterCacheNone) {
+    return;
+  }
+  it->second.generation++;
+  it->second.valid = true;
+  it->second.value = value;
+  it->second.stored_ms = now_ms;
+}
+
+void ModbusRegisterCache::Invalidate(uint16_t address) {
+  anx::common::AutoLock lock(&mutex_);
+  auto it = entries_.find(address);
+  if (it == entries_.end()) {
+    return;
+  }
+  /// the reads in flight are dropped even if the register is not valid
+  it->second.generation++;
+  if (it->second.valid) {
+    it->second.valid = false;
+    stats_.invalidations++;
+  }
+}
+
+void ModbusRegisterCache::InvalidateAll() {
+  anx::common::AutoLock lock(&mutex_);
+  for (auto& it : entries_) {
+    it.second.generation++;
+    if (it.second.valid) {
+      it.second.valid = false;
+      stats_.invalidations++;
+    }
+  }
+}
+
+RegisterCacheStats ModbusRegisterCache::stats() {
+  anx::common::AutoLock lock(&mutex_);
+  return stats_;
+}
+
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,108 @@
+/**
+ * @file modbus_register_cache.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the cache of the modbus holding registers, the registers changed
+ * only by the writes are read from the device once.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_MODBUS_REGISTER_CACHE_H_
+#define APP_DEVICE_MODBUS_REGISTER_CACHE_H_
+
+#include <stdint.h>
+
+#include <map>
+
+#include "app/common/thread.h"
+
+namespace anx {
+namespace device {
+
+/// @brief the staleness policy of the register
+enum RegisterCachePolicy {
+  /// @brief not cached, read from the device every time
+  kRegisterCacheNone = 0,
+  /// @brief valid until written or invalidated
+  kRegisterCacheUntilInvalidated = 1,
+  /// @brief valid for the max age after read or written
+  kRegisterCacheMaxAge = 2,
+};
+
+/// @brief the counters of the cache
+struct RegisterCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  /// @brief the values stored by the writes
+  int64_t writes = 0;
+  int64_t invalidations = 0;
+};
+
+class ModbusRegisterCache {
+ public:
+  ModbusRegisterCache();
+  ~ModbusRegisterCache();
+
+ public:
+  /// @brief Set the policy of the register, the registers without the policy
+  /// are not cached.
+  /// @param address the register address
+  /// @param policy the staleness policy
+  /// @param max_age_ms the max age of kRegisterCacheMaxAge
+  void SetPolicy(uint16_t address,
+                 RegisterCachePolicy policy,
+                 int64_t max_age_ms = 0);
+
+  /// @brief Lookup the value of the register
+  /// @param address the register address
+  /// @param now_ms the current time
+  /// @param value the value cached
+  /// @return true if hit, the miss is counted only for the cached registers
+  bool Lookup(uint16_t address, int64_t now_ms, int32_t* value);
+
+  /// @brief Get the generation of the register, changed by the writes and
+  /// the invalidations. taken before the device read and passed to Store.
+  uint64_t generation(uint16_t address);
+
+  /// @brief Store the value read from the device
+  /// @param generation the generation before the read, the value read is
+  /// dropped if the register was written or invalidated meanwhile
+  /// @return true if stored
+  bool Store(uint16_t address,
+             int32_t value,
+             int64_t now_ms,
+             uint64_t generation);
+
+  /// @brief Store the value written to the device, write through
+  void Write(uint16_t address, int32_t value, int64_t now_ms);
+
+  /// @brief Invalidate the register, e.g. the write failed
+  void Invalidate(uint16_t address);
+
+  /// @brief Invalidate all the registers, e.g. the device reconnected
+  void InvalidateAll();
+
+  RegisterCacheStats stats();
+
+ private:
+  struct Entry {
+    RegisterCachePolicy policy = kRegisterCacheNone;
+    int64_t max_age_ms = 0;
+    bool valid = false;
+    int32_t value = 0;
+    int64_t stored_ms = 0;
+    uint64_t generation = 0;
+  };
+
+  anx::common::Mutex mutex_;
+  std::map<uint16_t, Entry> entries_;
+  RegisterCacheStats stats_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_MODBUS_REGISTER_CACHE_H_
@@ -0,0 +1,112 @@
+/**
+ * @file modbus_register_cache_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the cache of the modbus holding registers unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/modbus_register_cache.h"
+
+#include <gtest/gtest.h>
+
+namespace anx {
+namespace device {
+
+TEST(ModbusRegisterCacheTest, UncachedRegister) {
+  ModbusRegisterCache cache;
+  int32_t value = 0;
+  cache.Store(0x18, 50, 0, cache.generation(0x18));
+  EXPECT_FALSE(cache.Lookup(0x18, 0, &value));
+  cache.SetPolicy(0x19, kRegisterCacheNone);
+  cache.Store(0x19, 10, 0, cache.generation(0x19));
+  EXPECT_FALSE(cache.Lookup(0x19, 0, &value));
+  RegisterCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 0);
+  EXPECT_EQ(stats.misses, 0);
+}
+
+TEST(ModbusRegisterCacheTest, HitAfterStore) {
+  ModbusRegisterCache cache;
+  cache.SetPolicy(0x18, kRegisterCacheUntilInvalidated);
+  int32_t value = 0;
+  EXPECT_FALSE(cache.Lookup(0x18, 0, &value));
+  cache.Store(0x18, 50, 0, cache.generation(0x18));
+  EXPECT_TRUE(cache.Lookup(0x18, 1000000, &value));
+  EXPECT_EQ(value, 50);
+  RegisterCacheStats stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 1);
+}
+
+TEST(ModbusRegisterCacheTest, MaxAgeExpires) {
+  ModbusRegisterCache cache;
+  cache.SetPolicy(0x03, kRegisterCacheMaxAge, 100);
+  int32_t value = 0;
+  cache.Store(0x03, 20000, 1000, cache.generation(0x03));
+  EXPECT_TRUE(cache.Lookup(0x03, 1099, &value));
+  EXPECT_EQ(value, 20000);
+  EXPECT_FALSE(cache.Lookup(0x03, 1100, &value));
+  /// expired stays expired until stored again
+  EXPECT_FALSE(cache.Lookup(0x03, 1000, &value));
+  cache.Store(0x03, 20100, 1100, cache.generation(0x03));
+  EXPECT_TRUE(cache.Lookup(0x03, 1150, &value));
+  EXPECT_EQ(value, 20100);
+}
+
+TEST(ModbusRegisterCacheTest, WriteThrough) {
+  ModbusRegisterCache cache;
+  cache.SetPolicy(0x19, kRegisterCacheUntilInvalidated);
+  cache.Store(0x19, 10, 0, cache.generation(0x19));
+  cache.Write(0x19, 20, 0);
+  int32_t value = 0;
+  EXPECT_TRUE(cache.Lookup(0x19, 0, &value));
+  EXPECT_EQ(value, 20);
+  EXPECT_EQ(cache.stats().writes, 1);
+}
+
+TEST(ModbusRegisterCacheTest, Invalidate) {
+  ModbusRegisterCache cache;
+  cache.SetPolicy(0x18, kRegisterCacheUntilInvalidated);
+  cache.SetPolicy(0x19, kRegisterCacheUntilInvalidated);
+  cache.Store(0x18, 50, 0, cache.generation(0x18));
+  cache.Store(0x19, 10, 0, cache.generation(0x19));
+  int32_t value = 0;
+  cache.Invalidate(0x18);
+  EXPECT_FALSE(cache.Lookup(0x18, 0, &value));
+  EXPECT_TRUE(cache.Lookup(0x19, 0, &value));
+  cache.InvalidateAll();
+  EXPECT_FALSE(cache.Lookup(0x19, 0, &value));
+  /// invalid registers are not counted again
+  cache.InvalidateAll();
+  EXPECT_EQ(cache.stats().invalidations, 2);
+}
+
+TEST(ModbusRegisterCacheTest, StaleReadDropped) {
+  ModbusRegisterCache cache;
+  cache.SetPolicy(0x18, kRegisterCacheUntilInvalidated);
+  int32_t value = 0;
+  /// the write lands between the device read and the store
+  uint64_t generation = cache.generation(0x18);
+  EXPECT_FALSE(cache.Lookup(0x18, 0, &value));
+  cache.Invalidate(0x18);
+  cache.Write(0x18, 80, 0);
+  EXPECT_FALSE(cache.Store(0x18, 50, 0, generation));
+  EXPECT_TRUE(cache.Lookup(0x18, 0, &value));
+  EXPECT_EQ(value, 80);
+  /// the invalidation of the invalid register drops the read too
+  cache.InvalidateAll();
+  generation = cache.generation(0x18);
+  cache.Invalidate(0x18);
+  EXPECT_FALSE(cache.Store(0x18, 50, 0, generation));
+  EXPECT_FALSE(cache.Lookup(0x18, 0, &value));
+  EXPECT_TRUE(cache.Store(0x18, 60, 0, cache.generation(0x18)));
+  EXPECT_TRUE(cache.Lookup(0x18, 0, &value));
+  EXPECT_EQ(value, 60);
+}
+
+}  // namespace device
+}  // namespace anx
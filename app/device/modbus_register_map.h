@@ -0,0 +1,314 @@
+/**
+ * @file modbus_register_map.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the typed description of the modbus registers, the request frames
+ * and their crc are generated at compile time and the responses are decoded
+ * into the typed values.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_MODBUS_REGISTER_MAP_H_
+#define APP_DEVICE_MODBUS_REGISTER_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <type_traits>
+
+#include "app/common/crc16.h"
+
+namespace anx {
+namespace device {
+
+/// @brief the function codes of the modbus
+const uint8_t kModbusReadCoils = 0x01;
+const uint8_t kModbusReadHoldingRegisters = 0x03;
+const uint8_t kModbusReadInputRegisters = 0x04;
+const uint8_t kModbusWriteSingleCoil = 0x05;
+const uint8_t kModbusWriteSingleRegister = 0x06;
+/// @brief the flag of the function code of the exception response
+const uint8_t kModbusExceptionFlag = 0x80;
+
+/// @brief the table of the register, decides the function codes
+enum ModbusTable {
+  /// @brief read by 01, written by 05 with 0xFF00 or 0x0000
+  kModbusCoil = 0,
+  /// @brief read by 04, read only
+  kModbusInputRegister = 1,
+  /// @brief read by 03, written by 06
+  kModbusHoldingRegister = 2,
+};
+
+/// @brief the access of the register
+enum ModbusAccess {
+  kModbusRead = 1,
+  kModbusWrite = 2,
+  kModbusReadWrite = 3,
+};
+
+/// @brief the request frame of the read and the single write, station,
+/// function, address, count or value and the crc low byte first.
+struct ModbusRtuRequest {
+  uint8_t bytes[8];
+
+  const uint8_t* data() const { return bytes; }
+  static constexpr size_t size() { return 8; }
+  constexpr uint8_t operator[](size_t index) const { return bytes[index]; }
+  /// @brief Get the crc, e.g. static_assert it against the device manual
+  constexpr uint16_t crc() const {
+    return static_cast<uint16_t>(bytes[6] | (bytes[7] << 8));
+  }
+};
+
+namespace internal {
+constexpr uint16_t Crc16ModbusOf(uint16_t crc) {
+  return crc;
+}
+
+template <typename... Bytes>
+constexpr uint16_t Crc16ModbusOf(uint16_t crc, uint8_t byte, Bytes... bytes) {
+  return Crc16ModbusOf(anx::common::internal::Crc16ModbusBits(
+                           static_cast<uint16_t>(crc ^ byte), 8),
+                       bytes...);
+}
+
+constexpr ModbusRtuRequest MakeRequest(uint8_t station,
+                                       uint8_t function,
+                                       uint8_t address_hi,
+                                       uint8_t address_lo,
+                                       uint8_t value_hi,
+                                       uint8_t value_lo) {
+  return ModbusRtuRequest{
+      {station, function, address_hi, address_lo, value_hi, value_lo,
+       static_cast<uint8_t>(
+           Crc16ModbusOf(anx::common::kCrc16ModbusInit, station, function,
+                         address_hi, address_lo, value_hi, value_lo) &
+           0xFF),
+       static_cast<uint8_t>(
+           Crc16ModbusOf(anx::common::kCrc16ModbusInit, station, function,
+                         address_hi, address_lo, value_hi, value_lo) >>
+           8)}};
+}
+
+constexpr bool RequestEquals(const ModbusRtuRequest& request,
+                             const uint8_t (&bytes)[8],
+                             size_t index = 0) {
+  return index == 8 || (request[index] == bytes[index] &&
+                        RequestEquals(request, bytes, index + 1));
+}
+}  // namespace internal
+
+/// @brief Make the request frame with the crc, constexpr so the constant
+/// requests are built at compile time.
+/// @param station the station address
+/// @param function the function code
+/// @param address the register address
+/// @param value the count of the read or the value of the write
+constexpr ModbusRtuRequest MakeModbusRtuRequest(uint8_t station,
+                                                uint8_t function,
+                                                uint16_t address,
+                                                uint16_t value) {
+  return internal::MakeRequest(station, function,
+                               static_cast<uint8_t>(address >> 8),
+                               static_cast<uint8_t>(address & 0xFF),
+                               static_cast<uint8_t>(value >> 8),
+                               static_cast<uint8_t>(value & 0xFF));
+}
+
+/// @brief Check the request is the bytes, e.g. static_assert the request
+/// against the frame of the device manual.
+constexpr bool ModbusRtuRequestEquals(const ModbusRtuRequest& request,
+                                      const uint8_t (&bytes)[8]) {
+  return internal::RequestEquals(request, bytes);
+}
+
+////////////////////////////////////////////////////////////
+// clz ModbusRegister
+/// @brief the description of one register
+/// @tparam Table the table of the register
+/// @tparam Address the register address
+/// @tparam T the value type
+/// @tparam Access the access of the register
+/// @tparam Raw the type of the 16 bits word, int16_t for the signed
+/// registers, bool for the coils
+/// @tparam ScaleNum the value is raw * ScaleNum / ScaleDen
+/// @tparam ScaleDen the value is raw * ScaleNum / ScaleDen
+template <ModbusTable Table,
+          uint16_t Address,
+          typename T,
+          ModbusAccess Access = kModbusRead,
+          typename Raw = uint16_t,
+          int32_t ScaleNum = 1,
+          int32_t ScaleDen = 1>
+struct ModbusRegister {
+  static_assert(ScaleNum != 0 && ScaleDen != 0, "the scale is zero");
+  static_assert(Table != kModbusCoil || std::is_same<Raw, bool>::value,
+                "the coil is bool");
+  static_assert(Table != kModbusInputRegister || Access == kModbusRead,
+                "the input register is read only");
+  static_assert(std::is_arithmetic<T>::value, "the value is arithmetic");
+
+  typedef T value_type;
+
+  static constexpr ModbusTable table() { return Table; }
+  static constexpr uint16_t address() { return Address; }
+
+  static constexpr uint8_t read_function() {
+    return Table == kModbusCoil
+               ? kModbusReadCoils
+               : (Table == kModbusInputRegister ? kModbusReadInputRegisters
+                                                : kModbusReadHoldingRegisters);
+  }
+  static constexpr uint8_t write_function() {
+    return Table == kModbusCoil ? kModbusWriteSingleCoil
+                                : kModbusWriteSingleRegister;
+  }
+
+  /// @brief Decode the word of the response into the value
+  static constexpr T Decode(uint16_t raw) {
+    return static_cast<T>(static_cast<T>(static_cast<Raw>(raw)) * ScaleNum /
+                          ScaleDen);
+  }
+
+  /// @brief Encode the value into the word of the write, rounded to the
+  /// nearest word.
+  static constexpr uint16_t Encode(T value) {
+    return Table == kModbusCoil
+               ? static_cast<uint16_t>(value ? 0xFF00 : 0x0000)
+               : static_cast<uint16_t>(static_cast<int32_t>(
+                     value * ScaleDen / ScaleNum +
+                     (value * ScaleDen / ScaleNum < 0 ? -0.5 : 0.5)));
+  }
+
+  /// @brief Get the request to read the register
+  static constexpr ModbusRtuRequest ReadRequest(uint8_t station) {
+    static_assert(Access & kModbusRead, "the register is not readable");
+    return MakeModbusRtuRequest(station, read_function(), Address, 1);
+  }
+
+  /// @brief Get the request to write the value, the response is the echo
+  static constexpr ModbusRtuRequest WriteRequest(uint8_t station, T value) {
+    static_assert(Access & kModbusWrite, "the register is not writable");
+    return MakeModbusRtuRequest(station, write_function(), Address,
+                                Encode(value));
+  }
+
+  /// @brief Parse the response of ReadRequest, the crc is checked by the
+  /// framer.
+  /// @param data the response frame
+  /// @param size the response size
+  /// @param station the station of the request
+  /// @param value the value decoded
+  /// @return 0 if success, -1 if the response is invalid, -2 if the response
+  /// is the exception
+  static int32_t ParseReadResponse(const uint8_t* data,
+                                   size_t size,
+                                   uint8_t station,
+                                   T* value) {
+    if (data == nullptr || size < 5 || data[0] != station) {
+      return -1;
+    }
+    if (data[1] == (read_function() | kModbusExceptionFlag)) {
+      return -2;
+    }
+    if (data[1] != read_function()) {
+      return -1;
+    }
+    if (Table == kModbusCoil) {
+      if (data[2] != 1 || size < 6) {
+        return -1;
+      }
+      *value = Decode(data[3] & 0x01);
+      return 0;
+    }
+    if (data[2] != 2 || size < 7) {
+      return -1;
+    }
+    *value = Decode(static_cast<uint16_t>((data[3] << 8) | data[4]));
+    return 0;
+  }
+
+  /// @brief Parse the response of WriteRequest, the echo of the request
+  /// @return 0 if success, -1 if the response is not the echo, -2 if the
+  /// response is the exception
+  static int32_t ParseWriteResponse(const uint8_t* data,
+                                    size_t size,
+                                    const ModbusRtuRequest& request) {
+    if (data != nullptr && size >= 2 && data[0] == request[0] &&
+        data[1] == (request[1] | kModbusExceptionFlag)) {
+      return -2;
+    }
+    if (data == nullptr || size < ModbusRtuRequest::size()) {
+      return -1;
+    }
+    for (size_t i = 0; i < ModbusRtuRequest::size(); i++) {
+      if (data[i] != request[i]) {
+        return -1;
+      }
+    }
+    return 0;
+  }
+};
+
+////////////////////////////////////////////////////////////
+// clz ModbusRegisterBlock
+/// @brief the registers from First to Last read by one request
+template <typename First, typename Last>
+struct ModbusRegisterBlock {
+  static_assert(First::table() == Last::table(), "the tables differ");
+  static_assert(First::table() != kModbusCoil, "the coils are not supported");
+  static_assert(First::address() <= Last::address(), "the block is empty");
+  static_assert(Last::address() - First::address() < 125,
+                "the block is longer than 125 registers");
+
+  static constexpr uint16_t count() {
+    return static_cast<uint16_t>(Last::address() - First::address() + 1);
+  }
+
+  /// @brief Get the request to read the block
+  static constexpr ModbusRtuRequest ReadRequest(uint8_t station) {
+    return MakeModbusRtuRequest(station, First::read_function(),
+                                First::address(), count());
+  }
+
+  /// @brief Check the response of ReadRequest before Get
+  /// @return 0 if success, -1 if the response is invalid, -2 if the response
+  /// is the exception
+  static int32_t ParseReadResponse(const uint8_t* data,
+                                   size_t size,
+                                   uint8_t station) {
+    if (data == nullptr || size < 5 || data[0] != station) {
+      return -1;
+    }
+    if (data[1] == (First::read_function() | kModbusExceptionFlag)) {
+      return -2;
+    }
+    if (data[1] != First::read_function() || data[2] != count() * 2 ||
+        size < static_cast<size_t>(count() * 2 + 5)) {
+      return -1;
+    }
+    return 0;
+  }
+
+  /// @brief Get the value of the register in the response checked
+  template <typename Register>
+  static typename Register::value_type Get(const uint8_t* data) {
+    static_assert(Register::table() == First::table(),
+                  "the register is not in the table of the block");
+    static_assert(Register::address() >= First::address() &&
+                      Register::address() <= Last::address(),
+                  "the register is not in the block");
+    const uint8_t* word =
+        data + 3 + (Register::address() - First::address()) * 2;
+    return Register::Decode(static_cast<uint16_t>((word[0] << 8) | word[1]));
+  }
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_MODBUS_REGISTER_MAP_H_
@@ -0,0 +1,154 @@
+/**
+ * @file modbus_register_map_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the typed description of the modbus registers unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/modbus_register_map.h"
+
+#include <gtest/gtest.h>
+
+namespace anx {
+namespace device {
+
+namespace {
+typedef ModbusRegister<kModbusCoil, 0x0002, bool, kModbusWrite, bool> Switch;
+typedef ModbusRegister<kModbusInputRegister, 0x0001, int32_t> CurrentFreq;
+typedef ModbusRegister<kModbusHoldingRegister,
+                       0x0018,
+                       int32_t,
+                       kModbusReadWrite>
+    Amplitude;
+/// 0.1 s a count
+typedef ModbusRegister<kModbusHoldingRegister,
+                       0x0019,
+                       double,
+                       kModbusReadWrite,
+                       uint16_t,
+                       1,
+                       10>
+    WedingTime;
+typedef ModbusRegister<kModbusHoldingRegister,
+                       0x0020,
+                       int32_t,
+                       kModbusRead,
+                       int16_t>
+    Offset;
+typedef ModbusRegister<kModbusHoldingRegister, 0x0000, int32_t> FirstRated;
+typedef ModbusRegister<kModbusHoldingRegister, 0x0003, int32_t> MaxFreq;
+typedef ModbusRegister<kModbusHoldingRegister, 0x0004, int32_t> LastRated;
+
+constexpr uint8_t kStopFrame[8] = {0x01, 0x05, 0x00, 0x02,
+                                   0x00, 0x00, 0x6C, 0x0A};
+constexpr uint8_t kReadFreqFrame[8] = {0x01, 0x04, 0x00, 0x01,
+                                       0x00, 0x01, 0x60, 0x0A};
+constexpr uint8_t kWriteAmplitudeFrame[8] = {0x01, 0x06, 0x00, 0x18,
+                                             0x00, 0x14, 0x09, 0xC2};
+constexpr uint8_t kWriteWedingTimeFrame[8] = {0x01, 0x06, 0x00, 0x19,
+                                              0x00, 0xC8, 0x59, 0x9B};
+constexpr uint8_t kReadRatedFrame[8] = {0x01, 0x03, 0x00, 0x00,
+                                        0x00, 0x05, 0x85, 0xC9};
+
+/// the frames are generated and checked at compile time
+static_assert(ModbusRtuRequestEquals(Switch::WriteRequest(0x01, false),
+                                     kStopFrame),
+              "stop frame");
+static_assert(ModbusRtuRequestEquals(CurrentFreq::ReadRequest(0x01),
+                                     kReadFreqFrame),
+              "read freq frame");
+static_assert(ModbusRtuRequestEquals(Amplitude::WriteRequest(0x01, 20),
+                                     kWriteAmplitudeFrame),
+              "write amplitude frame");
+static_assert(ModbusRtuRequestEquals(WedingTime::WriteRequest(0x01, 20.0),
+                                     kWriteWedingTimeFrame),
+              "write weding time frame");
+static_assert(
+    ModbusRtuRequestEquals(
+        ModbusRegisterBlock<FirstRated, LastRated>::ReadRequest(0x01),
+        kReadRatedFrame),
+    "read rated block frame");
+}  // namespace
+
+TEST(ModbusRegisterMapTest, CrcMatchesRuntime) {
+  const ModbusRtuRequest request = Amplitude::ReadRequest(0x07);
+  EXPECT_EQ(request.crc(), anx::common::crc16(request.data(), 6));
+  EXPECT_EQ(request[0], 0x07);
+  EXPECT_EQ(request[1], kModbusReadHoldingRegisters);
+}
+
+TEST(ModbusRegisterMapTest, ParseReadResponse) {
+  const uint8_t response[] = {0x01, 0x04, 0x02, 0x4D, 0x97, 0xCD, 0xCE};
+  int32_t freq = 0;
+  EXPECT_EQ(CurrentFreq::ParseReadResponse(response, sizeof(response), 0x01,
+                                           &freq),
+            0);
+  EXPECT_EQ(freq, 0x4D97);
+  /// the other station
+  EXPECT_EQ(CurrentFreq::ParseReadResponse(response, sizeof(response), 0x02,
+                                           &freq),
+            -1);
+  /// the holding register is read by 03
+  EXPECT_EQ(Amplitude::ParseReadResponse(response, sizeof(response), 0x01,
+                                         &freq),
+            -1);
+  const uint8_t exception[] = {0x01, 0x84, 0x02, 0xC2, 0xC1};
+  EXPECT_EQ(CurrentFreq::ParseReadResponse(exception, sizeof(exception), 0x01,
+                                           &freq),
+            -2);
+  EXPECT_EQ(CurrentFreq::ParseReadResponse(response, 4, 0x01, &freq), -1);
+}
+
+TEST(ModbusRegisterMapTest, ScaledAndSigned) {
+  const uint8_t time[] = {0x01, 0x03, 0x02, 0x00, 0xC8, 0x00, 0x00};
+  double weding_time = 0;
+  EXPECT_EQ(WedingTime::ParseReadResponse(time, sizeof(time), 0x01,
+                                          &weding_time),
+            0);
+  EXPECT_DOUBLE_EQ(weding_time, 20.0);
+  EXPECT_EQ(WedingTime::Encode(0.25), 3);
+  EXPECT_EQ(WedingTime::Encode(99.9), 999);
+
+  const uint8_t offset[] = {0x01, 0x03, 0x02, 0xFF, 0xFE, 0x00, 0x00};
+  int32_t value = 0;
+  EXPECT_EQ(Offset::ParseReadResponse(offset, sizeof(offset), 0x01, &value),
+            0);
+  EXPECT_EQ(value, -2);
+}
+
+TEST(ModbusRegisterMapTest, ParseWriteResponse) {
+  const ModbusRtuRequest request = Switch::WriteRequest(0x01, true);
+  EXPECT_EQ(Switch::ParseWriteResponse(request.data(), request.size(),
+                                       request),
+            0);
+  uint8_t echo[8];
+  for (size_t i = 0; i < sizeof(echo); i++) {
+    echo[i] = request[i];
+  }
+  echo[4] = 0x00;
+  EXPECT_EQ(Switch::ParseWriteResponse(echo, sizeof(echo), request), -1);
+  const uint8_t exception[] = {0x01, 0x85, 0x03, 0x02, 0x91};
+  EXPECT_EQ(Switch::ParseWriteResponse(exception, sizeof(exception), request),
+            -2);
+}
+
+TEST(ModbusRegisterMapTest, BlockRead) {
+  typedef ModbusRegisterBlock<FirstRated, LastRated> Rated;
+  EXPECT_EQ(Rated::count(), 5);
+  const uint8_t response[] = {0x01, 0x03, 0x0A, 0x4D, 0x62, 0x00, 0x64,
+                              0x05, 0xDC, 0x50, 0x14, 0x4B, 0x00, 0x00,
+                              0x00};
+  ASSERT_EQ(Rated::ParseReadResponse(response, sizeof(response), 0x01), 0);
+  EXPECT_EQ(Rated::Get<FirstRated>(response), 0x4D62);
+  EXPECT_EQ(Rated::Get<MaxFreq>(response), 0x5014);
+  EXPECT_EQ(Rated::Get<LastRated>(response), 0x4B00);
+  EXPECT_EQ(Rated::ParseReadResponse(response, sizeof(response) - 1, 0x01),
+            -1);
+}
+
+}  // namespace device
+}  // namespace anx
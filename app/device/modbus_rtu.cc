@@ -0,0 +1,440 @@
+/**
+ * @file modbus_rtu.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief modbus rtu frame assembler and request response channel
+ * implementation
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/modbus_rtu.h"
+
+#include <algorithm>
+
+#include "app/common/crc16.h"
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+#include "app/device/device_com.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+/// @brief the bytes of the frame start to get the frame length
+const size_t kFrameHeadSize = 11;
+
+/// @brief the max wait time of the io thread for the bytes
+const int32_t kIoWaitMs = 100;
+
+int64_t NowMicros() {
+  return static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+}
+
+/// @brief 3.5 characters of 11 bits, fixed 1750us above 19200 baud
+int64_t SilenceMicros(int32_t baud_rate) {
+  if (baud_rate <= 0 || baud_rate > 19200) {
+    return 1750;
+  }
+  return (35 * 11 * 1000000LL) / (10LL * baud_rate);
+}
+}  // namespace
+
+////////////////////////////////////////////////////////////
+// clz ModbusRtuFramer
+ModbusRtuFramer::ModbusRtuFramer(SerialRxRing* ring,
+                                 int32_t baud_rate,
+                                 bool response)
+    : ring_(ring),
+      response_(response),
+      station_(0),
+      silence_us_(SilenceMicros(baud_rate)),
+      frame_timeout_us_(kModbusRtuFrameTimeoutUs),
+      resyncing_(false),
+      frames_(0),
+      crc_errors_(0),
+      dropped_frames_(0),
+      dropped_bytes_(0) {}
+
+ModbusRtuFramer::~ModbusRtuFramer() {}
+
+int32_t ModbusRtuFramer::FrameLength(const uint8_t* data,
+                                     size_t size,
+                                     bool response) {
+  if (size < 2) {
+    return 0;
+  }
+  uint8_t function = data[1];
+  if (function & 0x80) {
+    /// exception response, address function exception crc
+    return response ? 5 : -1;
+  }
+  if (response) {
+    switch (function) {
+      case 0x01:
+      case 0x02:
+      case 0x03:
+      case 0x04:
+      case 0x11:
+      case 0x17:
+        return size < 3 ? 0 : 5 + data[2];
+      case 0x05:
+      case 0x06:
+      case 0x08:
+      case 0x0F:
+      case 0x10:
+        return 8;
+      case 0x07:
+        return 5;
+      default:
+        return -1;
+    }
+  }
+  switch (function) {
+    case 0x01:
+    case 0x02:
+    case 0x03:
+    case 0x04:
+    case 0x05:
+    case 0x06:
+    case 0x08:
+      return 8;
+    case 0x07:
+    case 0x11:
+      return 4;
+    case 0x0F:
+    case 0x10:
+      return size < 7 ? 0 : 9 + data[6];
+    case 0x17:
+      return size < 11 ? 0 : 13 + data[10];
+    default:
+      return -1;
+  }
+}
+
+int32_t ModbusRtuFramer::Next(int64_t now_us,
+                              int64_t last_byte_us,
+                              ModbusRtuFrame* frame) {
+  bool silent = now_us - last_byte_us >= silence_us_;
+  bool timed_out = now_us - last_byte_us >= frame_timeout_us_;
+  while (true) {
+    size_t size = ring_->size();
+    if (size == 0) {
+      return 0;
+    }
+    if (station_ != 0 && ring_->At(0) != station_) {
+      Drop(1);
+      continue;
+    }
+    uint8_t head[kFrameHeadSize];
+    size_t head_size = std::min(size, kFrameHeadSize);
+    for (size_t i = 0; i < head_size; i++) {
+      head[i] = ring_->At(i);
+    }
+    int32_t length = FrameLength(head, head_size, response_);
+    if (length > static_cast<int32_t>(kModbusRtuMaxFrameSize)) {
+      Drop(1);
+      continue;
+    }
+    if (length > 0) {
+      if (size < static_cast<size_t>(length)) {
+        /// the length may be read from the garbage, look for the frame after
+        size_t offset = (resyncing_ || silent) ? FindFrame(size) : 0;
+        if (offset > 0) {
+          Drop(offset);
+          continue;
+        }
+        if (!timed_out) {
+          return 0;
+        }
+        /// the frame is cut
+        dropped_frames_++;
+        Drop(size);
+        return 0;
+      }
+      const uint8_t* data = ring_->Peek(0, length);
+      if (anx::common::crc16(data, length) == 0) {
+        frame->data_ = data;
+        frame->size_ = length;
+        frames_++;
+        resyncing_ = false;
+        return 1;
+      }
+      /// count the frame once, the following bytes are tried one by one
+      if (!resyncing_) {
+        crc_errors_++;
+        resyncing_ = true;
+      }
+      Drop(1);
+      continue;
+    }
+    /// unknown function code, the frame is the bytes before the silence
+    if (!silent) {
+      return 0;
+    }
+    size_t offset = FindFrame(size);
+    if (offset > 0) {
+      Drop(offset);
+      continue;
+    }
+    size_t frame_size = std::min(size, kModbusRtuMaxFrameSize);
+    if (frame_size >= kModbusRtuMinFrameSize) {
+      const uint8_t* data = ring_->Peek(0, frame_size);
+      if (anx::common::crc16(data, static_cast<uint32_t>(frame_size)) == 0) {
+        frame->data_ = data;
+        frame->size_ = frame_size;
+        frames_++;
+        resyncing_ = false;
+        return 1;
+      }
+    }
+    dropped_frames_++;
+    Drop(frame_size);
+  }
+}
+
+void ModbusRtuFramer::Release(const ModbusRtuFrame& frame) {
+  ring_->Consume(frame.size());
+}
+
+void ModbusRtuFramer::Reset() {
+  dropped_bytes_ += ring_->Clear();
+  resyncing_ = false;
+}
+
+void ModbusRtuFramer::set_baud_rate(int32_t baud_rate) {
+  silence_us_ = SilenceMicros(baud_rate);
+}
+
+size_t ModbusRtuFramer::FindFrame(size_t size) const {
+  uint8_t head[kFrameHeadSize];
+  for (size_t offset = 1; offset + kModbusRtuMinFrameSize <= size; offset++) {
+    if (station_ != 0 && ring_->At(offset) != station_) {
+      continue;
+    }
+    size_t head_size = std::min(size - offset, kFrameHeadSize);
+    for (size_t i = 0; i < head_size; i++) {
+      head[i] = ring_->At(offset + i);
+    }
+    int32_t length = FrameLength(head, head_size, response_);
+    if (length <= 0 || length > static_cast<int32_t>(kModbusRtuMaxFrameSize) ||
+        offset + length > size) {
+      continue;
+    }
+    const uint8_t* data = ring_->Peek(offset, length);
+    if (anx::common::crc16(data, length) == 0) {
+      return offset;
+    }
+  }
+  return 0;
+}
+
+void ModbusRtuFramer::Drop(size_t size) {
+  ring_->Consume(size);
+  dropped_bytes_ += size;
+}
+
+////////////////////////////////////////////////////////////
+// clz ModbusRtuResponse
+ModbusRtuResponse::ModbusRtuResponse() : channel_(nullptr) {}
+
+ModbusRtuResponse::~ModbusRtuResponse() {
+  Reset();
+}
+
+void ModbusRtuResponse::Reset() {
+  if (channel_ != nullptr) {
+    channel_->Release(frame_);
+    channel_ = nullptr;
+  }
+  frame_ = ModbusRtuFrame();
+}
+
+////////////////////////////////////////////////////////////
+// clz ModbusRtuChannel
+ModbusRtuChannel::ModbusRtuChannel(DeviceComInterface* port_device,
+                                   size_t ring_capacity)
+    : port_device_(port_device),
+      ring_(ring_capacity),
+      framer_(&ring_, 9600),
+      stopped_(true),
+      last_rx_us_(0),
+      overflow_bytes_(0),
+      last_response_us_(0),
+      late_frames_(0),
+      last_latency_us_(0) {}
+
+ModbusRtuChannel::~ModbusRtuChannel() {
+  Stop();
+}
+
+void ModbusRtuChannel::Start() {
+  if (thread_ != nullptr) {
+    return;
+  }
+  stopped_ = false;
+  thread_.reset(new anx::common::Thread(this));
+  thread_->start();
+}
+
+void ModbusRtuChannel::Stop() {
+  if (thread_ == nullptr) {
+    return;
+  }
+  interrupt();
+  port_device_->CancelWait();
+  thread_->join();
+  thread_.reset();
+}
+
+void ModbusRtuChannel::Reset(int32_t baud_rate) {
+  anx::common::AutoLock lock(&transact_mutex_);
+  framer_.set_baud_rate(baud_rate);
+  framer_.Reset();
+}
+
+int32_t ModbusRtuChannel::Reopen(const ComPortDevice& com_port,
+                                 int32_t baud_rate) {
+  anx::common::AutoLock lock(&transact_mutex_);
+  /// the io thread reads the port only, it is stopped under the lock
+  bool threaded = thread_ != nullptr;
+  Stop();
+  port_device_->Close();
+  int32_t ret = port_device_->Open(com_port);
+  framer_.set_baud_rate(baud_rate);
+  framer_.Reset();
+  if (ret != 0) {
+    LOG_F(LG_ERROR) << "reopen failed ret:" << ret;
+    return -1;
+  }
+  if (threaded) {
+    Start();
+  }
+  return 0;
+}
+
+int32_t ModbusRtuChannel::Transact(const uint8_t* request,
+                                   size_t size,
+                                   int32_t timeout_ms,
+                                   ModbusRtuResponse* response) {
+  if (request == nullptr || size < kModbusRtuMinFrameSize ||
+      size > kModbusRtuMaxFrameSize || response == nullptr) {
+    return -1;
+  }
+  response->Reset();
+  /// the wait of the transaction of the other user is within the timeout
+  int64_t deadline_ms = NowMicros() / 1000 + timeout_ms;
+  while (!transact_mutex_.try_lock()) {
+    if (NowMicros() / 1000 >= deadline_ms) {
+      return -4;
+    }
+    anx::common::sleep_ms(1);
+  }
+  bool threaded = thread_ != nullptr;
+  if (!threaded) {
+    Pump();
+  }
+  /// drop the late responses of the previous requests
+  ModbusRtuFrame frame;
+  while (framer_.Next(NowMicros(), last_rx_us_, &frame) == 1) {
+    framer_.Release(frame);
+    late_frames_++;
+  }
+  framer_.Reset();
+
+  int32_t written = port_device_->Write(request, static_cast<int32_t>(size));
+  if (written != static_cast<int32_t>(size)) {
+    LOG_F(LG_ERROR) << "write failed written:" << written;
+    transact_mutex_.unlock();
+    return -2;
+  }
+  int64_t write_us = NowMicros();
+  int32_t silence_ms =
+      static_cast<int32_t>(std::max<int64_t>(1, framer_.silence_us() / 1000));
+  while (true) {
+    if (!threaded) {
+      Pump();
+    }
+    while (framer_.Next(NowMicros(), last_rx_us_, &frame) == 1) {
+      if (frame.data()[0] == request[0] &&
+          (frame.data()[1] & 0x7F) == request[1]) {
+        last_latency_us_ = last_rx_us_ - write_us;
+        last_response_us_ = last_rx_us_.load();
+        /// the channel is unlocked when the response is released
+        response->channel_ = this;
+        response->frame_ = frame;
+        return 0;
+      }
+      framer_.Release(frame);
+      late_frames_++;
+    }
+    int64_t remaining_ms = deadline_ms - NowMicros() / 1000;
+    if (remaining_ms <= 0) {
+      break;
+    }
+    int32_t wait_ms =
+        static_cast<int32_t>(std::min<int64_t>(remaining_ms, silence_ms));
+    if (threaded) {
+      anx::common::AutoLock lock(&rx_mutex_);
+      rx_cond_.wait(&rx_mutex_, wait_ms);
+    } else if (port_device_->WaitReadable(wait_ms) == -2) {
+      anx::common::sleep_ms(1);
+    }
+  }
+  transact_mutex_.unlock();
+  return -3;
+}
+
+void ModbusRtuChannel::run() {
+  while (!is_interrupt()) {
+    int32_t ret = port_device_->WaitReadable(kIoWaitMs);
+    if (ret == 0) {
+      continue;
+    }
+    if (Pump() > 0) {
+      anx::common::AutoLock lock(&rx_mutex_);
+      rx_cond_.broadcast();
+    } else if (ret != 1) {
+      /// the port can't wait, poll it
+      anx::common::sleep_ms(1);
+    }
+  }
+}
+
+void ModbusRtuChannel::Release(const ModbusRtuFrame& frame) {
+  framer_.Release(frame);
+  transact_mutex_.unlock();
+}
+
+int32_t ModbusRtuChannel::Pump() {
+  int32_t total = 0;
+  while (true) {
+    size_t span_size = 0;
+    uint8_t* span = ring_.WritableSpan(&span_size);
+    if (span == nullptr) {
+      /// the ring is full, keep the port buffer from holding the stale bytes
+      uint8_t discard[64];
+      int32_t readed = port_device_->Read(discard, sizeof(discard));
+      if (readed > 0) {
+        overflow_bytes_ += readed;
+      }
+      break;
+    }
+    int32_t readed = port_device_->Read(span, static_cast<int32_t>(span_size));
+    if (readed <= 0) {
+      break;
+    }
+    ring_.Commit(readed);
+    last_rx_us_ = NowMicros();
+    total += readed;
+    if (static_cast<size_t>(readed) < span_size) {
+      break;
+    }
+  }
+  return total;
+}
+
+}  // namespace device
+}  // namespace anx
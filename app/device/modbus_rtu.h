@@ -0,0 +1,256 @@
+/**
+ * @file modbus_rtu.h
+ * @author hhool (hhool@outlook.com)
+ * @brief modbus rtu frame assembler and request response channel. the bytes
+ * received are filled into the SerialRxRing, the frames are delimited by the
+ * length rules of the function code and by the 3.5 characters silence, and
+ * handed out as the views of the ring.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_MODBUS_RTU_H_
+#define APP_DEVICE_MODBUS_RTU_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+#include "app/common/thread.h"
+#include "app/device/serial_rx_ring.h"
+
+namespace anx {
+namespace device {
+
+class ComPortDevice;
+class DeviceComInterface;
+
+/// @brief the min modbus rtu frame size, address + function + crc
+const size_t kModbusRtuMinFrameSize = 4;
+/// @brief the max modbus rtu frame size
+const size_t kModbusRtuMaxFrameSize = 256;
+/// @brief the max gap inside the frame of the known length, longer than the
+/// 3.5 characters for the latency of the usb serial adapters
+const int64_t kModbusRtuFrameTimeoutUs = 50 * 1000;
+
+/// @brief the view of the frame in the ring
+class ModbusRtuFrame {
+ public:
+  ModbusRtuFrame() : data_(nullptr), size_(0) {}
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  friend class ModbusRtuFramer;
+  const uint8_t* data_;
+  size_t size_;
+};
+
+////////////////////////////////////////////////////////////
+// clz ModbusRtuFramer
+class ModbusRtuFramer {
+ public:
+  /// @brief Constructor
+  /// @param ring the ring to read, the framer is the only consumer
+  /// @param baud_rate the baud rate for the silence between the frames
+  /// @param response true if the frames are the responses to the master,
+  /// false if the frames are the requests, e.g. the capture of the master
+  ModbusRtuFramer(SerialRxRing* ring, int32_t baud_rate, bool response = true);
+  ~ModbusRtuFramer();
+
+ public:
+  /// @brief Get the next frame
+  /// @param now_us the current time in microseconds
+  /// @param last_byte_us the time of the last byte received in microseconds
+  /// @param frame the frame view, valid until Release
+  /// @return 1 if a frame is ready, 0 if more bytes are needed
+  int32_t Next(int64_t now_us, int64_t last_byte_us, ModbusRtuFrame* frame);
+
+  /// @brief Release the frame returned by Next, must be called before the
+  /// next Next.
+  void Release(const ModbusRtuFrame& frame);
+
+  /// @brief Drop all the bytes received
+  void Reset();
+
+  /// @brief Set the baud rate
+  void set_baud_rate(int32_t baud_rate);
+
+  /// @brief Only accept the frames of the station, 0 accepts all
+  void set_station(uint8_t station) { station_ = station; }
+
+  /// @brief Get the silence between the frames in microseconds
+  int64_t silence_us() const { return silence_us_; }
+
+  /// @brief Set the max gap inside the frame of the known length
+  void set_frame_timeout_us(int64_t frame_timeout_us) {
+    frame_timeout_us_ = frame_timeout_us;
+  }
+  int64_t frame_timeout_us() const { return frame_timeout_us_; }
+
+  /// @brief Get the count of the frames delimited
+  int64_t frames() const { return frames_; }
+  /// @brief Get the count of the frames failed the crc check
+  int64_t crc_errors() const { return crc_errors_; }
+  /// @brief Get the count of the incomplete or unknown frames dropped at the
+  /// silence
+  int64_t dropped_frames() const { return dropped_frames_; }
+  /// @brief Get the count of the bytes dropped to resync
+  int64_t dropped_bytes() const { return dropped_bytes_; }
+
+  /// @brief Get the frame length by the function code
+  /// @param data the bytes of the frame start
+  /// @param size the size of the bytes
+  /// @param response true if the frame is the response
+  /// @return the frame length, 0 if more bytes are needed, -1 if the
+  /// function code is unknown and the frame is delimited by the silence.
+  static int32_t FrameLength(const uint8_t* data, size_t size, bool response);
+
+ private:
+  /// @brief Find the complete frame with the good crc after the first byte
+  /// @return the offset of the frame, 0 if not found
+  size_t FindFrame(size_t size) const;
+  void Drop(size_t size);
+
+ private:
+  SerialRxRing* ring_;
+  bool response_;
+  uint8_t station_;
+  int64_t silence_us_;
+  int64_t frame_timeout_us_;
+  bool resyncing_;
+  int64_t frames_;
+  int64_t crc_errors_;
+  int64_t dropped_frames_;
+  int64_t dropped_bytes_;
+};
+
+class ModbusRtuChannel;
+
+/// @brief the response of ModbusRtuChannel::Transact, the view of the frame
+/// in the ring, the frame is released and the channel is unlocked on Reset or
+/// destruction.
+class ModbusRtuResponse {
+ public:
+  ModbusRtuResponse();
+  ~ModbusRtuResponse();
+
+  ModbusRtuResponse(const ModbusRtuResponse&) = delete;
+  ModbusRtuResponse& operator=(const ModbusRtuResponse&) = delete;
+
+  const uint8_t* data() const { return frame_.data(); }
+  size_t size() const { return frame_.size(); }
+
+  /// @brief Release the frame
+  void Reset();
+
+ private:
+  friend class ModbusRtuChannel;
+  ModbusRtuChannel* channel_;
+  ModbusRtuFrame frame_;
+};
+
+////////////////////////////////////////////////////////////
+// clz ModbusRtuChannel
+/// @brief the modbus rtu request and response on the DeviceComInterface.
+/// after Start an io thread fills the ring, without Start the bytes are read
+/// on the thread calling Transact so the DeviceComListener callbacks stay on
+/// that thread. both wait in DeviceComInterface::WaitReadable when the port
+/// supports it.
+class ModbusRtuChannel : public anx::common::Runnable {
+ public:
+  /// @brief Constructor
+  /// @param port_device the port device, not owned
+  /// @param ring_capacity the capacity of the receive ring
+  explicit ModbusRtuChannel(DeviceComInterface* port_device,
+                            size_t ring_capacity = 4096);
+  ~ModbusRtuChannel() override;
+
+ public:
+  /// @brief Start the io thread
+  void Start();
+  /// @brief Stop the io thread
+  void Stop();
+
+  /// @brief Drop the bytes received and set the baud rate, e.g. the port is
+  /// reopened.
+  void Reset(int32_t baud_rate);
+
+  /// @brief Close and open the port between the transactions, the io thread
+  /// is restarted if started, e.g. the device is reconnected.
+  /// @param com_port the port settings
+  /// @param baud_rate the baud rate, @see Reset
+  /// @return 0 if success, -1 if the port open failed
+  int32_t Reopen(const ComPortDevice& com_port, int32_t baud_rate);
+
+  /// @brief Write the request and wait for the response of the station and
+  /// the function code of the request, the late responses of the previous
+  /// requests are dropped.
+  /// @param request the request frame with crc
+  /// @param size the request size
+  /// @param timeout_ms the max wait time of the response, including the wait
+  /// for the transaction of the other user
+  /// @param response the response frame
+  /// @return 0 if success, -1 if the request is invalid, -2 if the write
+  /// failed, -3 if timeout, -4 if the channel is busy until the timeout
+  int32_t Transact(const uint8_t* request,
+                   size_t size,
+                   int32_t timeout_ms,
+                   ModbusRtuResponse* response);
+
+  /// @brief Get the framer for the counters
+  const ModbusRtuFramer& framer() const { return framer_; }
+
+  /// @brief Get the count of the late frames dropped
+  int64_t late_frames() const { return late_frames_; }
+
+  /// @brief Get the time from the request written to the last byte of the
+  /// response received of the last Transact
+  int64_t last_latency_us() const { return last_latency_us_; }
+
+  /// @brief Get the time of the last byte of the last response received,
+  /// 0 if none, read by any thread, e.g. the watchdog of the device.
+  int64_t last_response_us() const { return last_response_us_; }
+
+  /// @brief Get the count of the bytes lost for the ring full
+  int64_t overflow_bytes() const { return overflow_bytes_; }
+
+  void interrupt() override { stopped_ = true; }
+  bool is_interrupt() override { return stopped_; }
+
+ protected:
+  void run() override;
+
+ private:
+  friend class ModbusRtuResponse;
+  void Release(const ModbusRtuFrame& frame);
+  /// @brief Read the bytes available into the ring
+  /// @return the size read
+  int32_t Pump();
+
+ private:
+  DeviceComInterface* port_device_;
+  SerialRxRing ring_;
+  ModbusRtuFramer framer_;
+  anx::common::Mutex transact_mutex_;
+  anx::common::Mutex rx_mutex_;
+  anx::common::Condition rx_cond_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  std::atomic<bool> stopped_;
+  std::atomic<int64_t> last_rx_us_;
+  std::atomic<int64_t> overflow_bytes_;
+  std::atomic<int64_t> last_response_us_;
+  int64_t late_frames_;
+  int64_t last_latency_us_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_MODBUS_RTU_H_
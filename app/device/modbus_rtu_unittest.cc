@@ -0,0 +1,342 @@
+/**
+ * @file modbus_rtu_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief modbus rtu frame assembler and serial receive ring unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "app/common/crc16.h"
+#include "app/common/thread.h"
+#include "app/common/time_utils.h"
+#include "app/device/device_com.h"
+#include "app/device/modbus_rtu.h"
+#include "app/device/serial_rx_ring.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+std::vector<uint8_t> MakeFrame(std::vector<uint8_t> frame) {
+  uint16_t crc = anx::common::crc16(frame.data(), frame.size());
+  frame.push_back(crc & 0xFF);
+  frame.push_back(crc >> 8);
+  return frame;
+}
+
+/// @brief the port answers the requests with the responses queued, the
+/// bytes are read back in chunks of the chunk size.
+class FakePortDevice : public DeviceComInterface {
+ public:
+  void AddListener(DeviceComListener* listener) override {}
+  void RemoveListener(DeviceComListener* listener) override {}
+  int32_t Open(const ComPortDevice& com_port) override {
+    opens_++;
+    return open_result_;
+  }
+  bool isOpened() override { return true; }
+  void Close() override { closes_++; }
+  int32_t Read(uint8_t* buffer, int32_t size) override {
+    anx::common::AutoLock lock(&mutex_);
+    int32_t readed = std::min<int32_t>(size, chunk_size_);
+    readed = std::min<int32_t>(readed, static_cast<int32_t>(rx_.size()));
+    for (int32_t i = 0; i < readed; i++) {
+      buffer[i] = rx_.front();
+      rx_.pop_front();
+    }
+    return readed;
+  }
+  int32_t Write(const uint8_t* buffer, int32_t size) override {
+    anx::common::AutoLock lock(&mutex_);
+    requests_.push_back(std::vector<uint8_t>(buffer, buffer + size));
+    if (!responses_.empty()) {
+      rx_.insert(rx_.end(), responses_.front().begin(),
+                 responses_.front().end());
+      responses_.pop_front();
+    }
+    return size;
+  }
+  int32_t WriteRead(const uint8_t* write_buffer,
+                    int32_t write_size,
+                    uint8_t* read_buffer,
+                    int32_t read_size) override {
+    return 0;
+  }
+
+  void Receive(const std::vector<uint8_t>& data) {
+    anx::common::AutoLock lock(&mutex_);
+    rx_.insert(rx_.end(), data.begin(), data.end());
+  }
+
+  anx::common::Mutex mutex_;
+  std::deque<uint8_t> rx_;
+  std::deque<std::vector<uint8_t>> responses_;
+  std::vector<std::vector<uint8_t>> requests_;
+  int32_t chunk_size_ = 3;
+  int32_t open_result_ = 0;
+  int32_t opens_ = 0;
+  int32_t closes_ = 0;
+};
+}  // namespace
+
+TEST(SerialRxRingTest, MirroredView) {
+  SerialRxRing ring(100, 16);
+  EXPECT_EQ(ring.capacity(), 128u);
+  std::vector<uint8_t> data(120);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<uint8_t>(i);
+  }
+  EXPECT_EQ(ring.Write(data.data(), data.size()), 120u);
+  ring.Consume(120);
+  /// the next 16 bytes wrap at 128
+  EXPECT_EQ(ring.Write(data.data(), 16), 16u);
+  const uint8_t* view = ring.Peek(0, 16);
+  ASSERT_NE(view, nullptr);
+  EXPECT_EQ(memcmp(view, data.data(), 16), 0);
+  EXPECT_EQ(ring.At(10), 10);
+  EXPECT_EQ(ring.Peek(0, 17), nullptr);
+  EXPECT_EQ(ring.Peek(1, 16), nullptr);
+
+  size_t span_size = 0;
+  ASSERT_NE(ring.WritableSpan(&span_size), nullptr);
+  EXPECT_EQ(span_size, 112u);
+  EXPECT_EQ(ring.Write(data.data(), 120), 112u);
+  EXPECT_EQ(ring.free_size(), 0u);
+  EXPECT_EQ(ring.WritableSpan(&span_size), nullptr);
+  EXPECT_EQ(ring.Clear(), 128u);
+  EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(ModbusRtuFramerTest, ConcatenatedAndSplitFrames) {
+  SerialRxRing ring(64);
+  ModbusRtuFramer framer(&ring, 115200);
+  std::vector<uint8_t> a = MakeFrame({0x01, 0x03, 0x02, 0x00, 0x64});
+  std::vector<uint8_t> b = MakeFrame({0x01, 0x06, 0x00, 0x18, 0x00, 0x14});
+  std::vector<uint8_t> c = MakeFrame({0x01, 0x83, 0x02});
+  std::vector<uint8_t> stream;
+  stream.insert(stream.end(), a.begin(), a.end());
+  stream.insert(stream.end(), b.begin(), b.end());
+  stream.insert(stream.end(), c.begin(), c.end());
+  ModbusRtuFrame frame;
+  std::vector<size_t> sizes;
+  /// the bytes arrive one by one without the silence
+  for (size_t i = 0; i < stream.size(); i++) {
+    ring.Write(&stream[i], 1);
+    while (framer.Next(0, 0, &frame) == 1) {
+      sizes.push_back(frame.size());
+      framer.Release(frame);
+    }
+  }
+  ASSERT_EQ(sizes.size(), 3u);
+  EXPECT_EQ(sizes[0], a.size());
+  EXPECT_EQ(sizes[1], b.size());
+  EXPECT_EQ(sizes[2], 5u);
+  EXPECT_EQ(framer.frames(), 3);
+  EXPECT_EQ(framer.crc_errors(), 0);
+  EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(ModbusRtuFramerTest, ResyncAfterGarbage) {
+  SerialRxRing ring(64);
+  ModbusRtuFramer framer(&ring, 9600);
+  std::vector<uint8_t> a = MakeFrame({0x01, 0x04, 0x02, 0x4D, 0x97});
+  std::vector<uint8_t> stream = {0x01, 0x04, 0x02, 0x11, 0x22, 0x33, 0x44};
+  stream.insert(stream.end(), a.begin(), a.end());
+  ring.Write(stream.data(), stream.size());
+  ModbusRtuFrame frame;
+  ASSERT_EQ(framer.Next(0, 0, &frame), 1);
+  ASSERT_EQ(frame.size(), a.size());
+  EXPECT_EQ(memcmp(frame.data(), a.data(), a.size()), 0);
+  framer.Release(frame);
+  EXPECT_EQ(framer.crc_errors(), 1);
+  EXPECT_EQ(framer.dropped_bytes(), 7);
+
+  /// the frame cut is dropped after the frame timeout
+  ring.Write(a.data(), 4);
+  EXPECT_EQ(framer.Next(framer.silence_us(), 0, &frame), 0);
+  EXPECT_EQ(ring.size(), 4u);
+  EXPECT_EQ(framer.Next(framer.frame_timeout_us(), 0, &frame), 0);
+  EXPECT_EQ(ring.size(), 0u);
+  EXPECT_EQ(framer.dropped_frames(), 1);
+}
+
+TEST(ModbusRtuFramerTest, UnknownFunctionBySilence) {
+  SerialRxRing ring(64);
+  ModbusRtuFramer framer(&ring, 19200);
+  std::vector<uint8_t> a = MakeFrame({0x01, 0x2B, 0x0E, 0x01, 0x00});
+  ring.Write(a.data(), a.size());
+  ModbusRtuFrame frame;
+  EXPECT_EQ(framer.Next(0, 0, &frame), 0);
+  ASSERT_EQ(framer.Next(framer.silence_us(), 0, &frame), 1);
+  EXPECT_EQ(frame.size(), a.size());
+  framer.Release(frame);
+
+  framer.set_station(0x02);
+  ring.Write(a.data(), a.size());
+  EXPECT_EQ(framer.Next(framer.silence_us(), 0, &frame), 0);
+  EXPECT_EQ(ring.size(), 0u);
+}
+
+TEST(ModbusRtuFramerTest, RequestLength) {
+  std::vector<uint8_t> write_multiple =
+      MakeFrame({0x01, 0x10, 0x00, 0x01, 0x00, 0x02, 0x04, 1, 2, 3, 4});
+  EXPECT_EQ(ModbusRtuFramer::FrameLength(write_multiple.data(), 6, false), 0);
+  EXPECT_EQ(ModbusRtuFramer::FrameLength(write_multiple.data(), 7, false),
+            static_cast<int32_t>(write_multiple.size()));
+  EXPECT_EQ(ModbusRtuFramer::FrameLength(write_multiple.data(), 7, true), 8);
+}
+
+TEST(ModbusRtuChannelTest, Transact) {
+  FakePortDevice port;
+  ModbusRtuChannel channel(&port);
+  channel.Reset(115200);
+  std::vector<uint8_t> request =
+      MakeFrame({0x01, 0x04, 0x00, 0x01, 0x00, 0x01});
+  std::vector<uint8_t> late = MakeFrame({0x01, 0x03, 0x02, 0x00, 0x14});
+  std::vector<uint8_t> reply = MakeFrame({0x01, 0x04, 0x02, 0x4D, 0x97});
+  std::vector<uint8_t> answer = late;
+  answer.push_back(0xFF);
+  answer.insert(answer.end(), reply.begin(), reply.end());
+  port.responses_.push_back(answer);
+  {
+    ModbusRtuResponse response;
+    ASSERT_EQ(channel.Transact(request.data(), request.size(), 100, &response),
+              0);
+    ASSERT_EQ(response.size(), reply.size());
+    EXPECT_EQ(memcmp(response.data(), reply.data(), reply.size()), 0);
+  }
+  EXPECT_EQ(channel.late_frames(), 1);
+  ASSERT_EQ(port.requests_.size(), 1u);
+  EXPECT_EQ(port.requests_[0], request);
+
+  /// no response
+  ModbusRtuResponse response;
+  EXPECT_EQ(channel.Transact(request.data(), request.size(), 20, &response),
+            -3);
+  EXPECT_EQ(response.size(), 0u);
+  EXPECT_EQ(channel.Transact(request.data(), 2, 20, &response), -1);
+
+  /// the late bytes of the previous request are dropped before the write
+  port.chunk_size_ = 64;
+  port.Receive(late);
+  port.responses_.push_back(reply);
+  ASSERT_EQ(channel.Transact(request.data(), request.size(), 100, &response),
+            0);
+  EXPECT_EQ(response.size(), reply.size());
+  response.Reset();
+  EXPECT_EQ(channel.late_frames(), 2);
+}
+
+TEST(ModbusRtuChannelTest, TransactThreaded) {
+  FakePortDevice port;
+  port.chunk_size_ = 1;
+  ModbusRtuChannel channel(&port);
+  channel.Reset(115200);
+  channel.Start();
+  for (int32_t i = 0; i < 50; i++) {
+    std::vector<uint8_t> request =
+        MakeFrame({0x01, 0x03, 0x00, 0x18, 0x00, 0x01});
+    std::vector<uint8_t> reply =
+        MakeFrame({0x01, 0x03, 0x02, 0x00, static_cast<uint8_t>(i)});
+    {
+      anx::common::AutoLock lock(&port.mutex_);
+      port.responses_.push_back(reply);
+    }
+    ModbusRtuResponse response;
+    ASSERT_EQ(channel.Transact(request.data(), request.size(), 500, &response),
+              0);
+    ASSERT_EQ(response.size(), reply.size());
+    EXPECT_EQ(response.data()[4], i);
+  }
+  channel.Stop();
+  EXPECT_EQ(channel.framer().frames(), 50);
+  EXPECT_EQ(channel.framer().crc_errors(), 0);
+}
+
+TEST(ModbusRtuChannelTest, TransactBusy) {
+  FakePortDevice port;
+  port.chunk_size_ = 64;
+  ModbusRtuChannel channel(&port);
+  channel.Reset(115200);
+  std::vector<uint8_t> request =
+      MakeFrame({0x01, 0x04, 0x00, 0x02, 0x00, 0x01});
+  std::vector<uint8_t> reply = MakeFrame({0x01, 0x04, 0x02, 0x00, 0x00});
+  port.responses_.push_back(reply);
+  ModbusRtuResponse held;
+  ASSERT_EQ(channel.Transact(request.data(), request.size(), 100, &held), 0);
+  /// the wait for the response held is within the timeout
+  int32_t ret = 0;
+  int64_t elapsed_ms = 0;
+  std::thread thread([&]() {
+    int64_t start_ms = anx::common::GetCurrentTimeMillis();
+    ModbusRtuResponse response;
+    ret = channel.Transact(request.data(), request.size(), 30, &response);
+    elapsed_ms = anx::common::GetCurrentTimeMillis() - start_ms;
+  });
+  thread.join();
+  EXPECT_EQ(ret, -4);
+  EXPECT_GE(elapsed_ms, 30);
+  EXPECT_LT(elapsed_ms, 200);
+  EXPECT_EQ(port.requests_.size(), 1u);
+  held.Reset();
+  port.responses_.push_back(reply);
+  ModbusRtuResponse response;
+  EXPECT_EQ(channel.Transact(request.data(), request.size(), 100, &response),
+            0);
+}
+
+TEST(ModbusRtuChannelTest, Reopen) {
+  FakePortDevice port;
+  port.chunk_size_ = 64;
+  ModbusRtuChannel channel(&port);
+  channel.Reset(115200);
+  EXPECT_EQ(channel.last_response_us(), 0);
+  std::vector<uint8_t> request =
+      MakeFrame({0x01, 0x04, 0x00, 0x02, 0x00, 0x01});
+  std::vector<uint8_t> reply = MakeFrame({0x01, 0x04, 0x02, 0x00, 0x00});
+  port.responses_.push_back(reply);
+  {
+    ModbusRtuResponse response;
+    ASSERT_EQ(channel.Transact(request.data(), request.size(), 100, &response),
+              0);
+  }
+  int64_t last_response_us = channel.last_response_us();
+  EXPECT_GT(last_response_us, 0);
+
+  /// the bytes of the port before the reopen are dropped
+  port.Receive(reply);
+  int64_t silence_us = channel.framer().silence_us();
+  ComPortDevice com_port;
+  EXPECT_EQ(channel.Reopen(com_port, 9600), 0);
+  EXPECT_EQ(port.closes_, 1);
+  EXPECT_EQ(port.opens_, 1);
+  EXPECT_GT(channel.framer().silence_us(), silence_us);
+  channel.Start();
+  EXPECT_EQ(channel.Reopen(com_port, 115200), 0);
+  port.responses_.push_back(reply);
+  {
+    ModbusRtuResponse response;
+    ASSERT_EQ(channel.Transact(request.data(), request.size(), 500, &response),
+              0);
+  }
+  EXPECT_EQ(channel.late_frames(), 0);
+  EXPECT_GE(channel.last_response_us(), last_response_us);
+
+  port.open_result_ = -1;
+  EXPECT_EQ(channel.Reopen(com_port, 115200), -1);
+  channel.Stop();
+}
+
+}  // namespace device
+}  // namespace anx
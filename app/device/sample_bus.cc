@@ -0,0 +1,372 @@
+/**
+ * @file sample_bus.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the sample bus fuses the streams of the sensors by the time
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/sample_bus.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+int64_t NowMicros() {
+  return static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+}
+
+/// @brief Get the first time of the grid at or after the time
+int64_t AlignUp(int64_t time_us, int64_t period_us) {
+  int64_t aligned = time_us / period_us * period_us;
+  return aligned < time_us ? aligned + period_us : aligned;
+}
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// clz SampleMerger
+
+SampleMerger::SampleMerger(const SampleBusOptions& options)
+    : options_(options), next_us_(0), dropped_(0) {
+  if (options_.period_us <= 0) {
+    options_.period_us = kSampleBusPeriodUs;
+  }
+  if (options_.max_lag_us < 0) {
+    options_.max_lag_us = 0;
+  }
+}
+
+SampleMerger::~SampleMerger() {}
+
+int32_t SampleMerger::AddSource(const SampleSourceOptions& options) {
+  if (sources_.size() >= static_cast<size_t>(kSampleBusMaxSources) ||
+      options.channels <= 0 || options.channels > kSampleBusMaxChannels) {
+    return -1;
+  }
+  Source source;
+  source.options = options;
+  sources_.push_back(source);
+  return static_cast<int32_t>(sources_.size()) - 1;
+}
+
+int32_t SampleMerger::Push(int32_t source, const SourceSample& sample) {
+  if (source < 0 || source >= sources()) {
+    return -1;
+  }
+  std::deque<SourceSample>& samples = sources_[source].samples;
+  if (!samples.empty() && sample.time_us < samples.back().time_us) {
+    dropped_++;
+    return -2;
+  }
+  samples.push_back(sample);
+  return 0;
+}
+
+size_t SampleMerger::Merge(int64_t now_us, std::vector<FusedRecord>* records) {
+  size_t count = 0;
+  if (next_us_ == 0) {
+    int64_t first_us = INT64_MAX;
+    for (const auto& source : sources_) {
+      if (!source.samples.empty()) {
+        first_us = std::min(first_us, source.samples.front().time_us);
+      }
+    }
+    if (first_us == INT64_MAX) {
+      return 0;
+    }
+    next_us_ = AlignUp(first_us, options_.period_us);
+  }
+  while (next_us_ <= now_us) {
+    int64_t time_us = next_us_;
+    bool ready = time_us <= now_us - options_.max_lag_us;
+    if (!ready) {
+      ready = true;
+      for (const auto& source : sources_) {
+        if (source.samples.empty() || source.samples.back().time_us < time_us) {
+          ready = false;
+          break;
+        }
+      }
+    }
+    if (!ready) {
+      break;
+    }
+    FusedRecord record;
+    record.time_us = time_us;
+    for (size_t i = 0; i < sources_.size(); i++) {
+      bool interpolated = false;
+      if (Fuse(sources_[i], time_us, record.values[i], &interpolated)) {
+        record.valid_mask |= 1u << i;
+        if (interpolated) {
+          record.interpolated_mask |= 1u << i;
+        }
+      }
+    }
+    next_us_ += options_.period_us;
+    if (record.valid_mask != 0) {
+      records->push_back(record);
+      count++;
+    } else {
+      /// no source for the time, skip to the next sample instead of the
+      /// records of nothing, e.g. the devices are closed.
+      int64_t resume_us = INT64_MAX;
+      for (const auto& source : sources_) {
+        if (source.samples.empty()) {
+          continue;
+        }
+        int64_t last_us = source.samples.back().time_us;
+        if (last_us > time_us) {
+          resume_us = std::min(resume_us, last_us);
+        }
+      }
+      if (resume_us == INT64_MAX) {
+        resume_us = now_us - options_.max_lag_us;
+      }
+      next_us_ = std::max(next_us_, AlignUp(resume_us, options_.period_us));
+    }
+    Prune(next_us_);
+  }
+  return count;
+}
+
+bool SampleMerger::Fuse(const Source& source,
+                        int64_t time_us,
+                        double* values,
+                        bool* interpolated) const {
+  const std::deque<SourceSample>& samples = source.samples;
+  auto next = std::upper_bound(
+      samples.begin(), samples.end(), time_us,
+      [](int64_t t, const SourceSample& sample) { return t < sample.time_us; });
+  if (next == samples.begin()) {
+    /// as of the time, the samples after the time are not used alone
+    return false;
+  }
+  const SourceSample& prev = *(next - 1);
+  if (time_us - prev.time_us > source.options.max_gap_us) {
+    return false;
+  }
+  int32_t channels = source.options.channels;
+  if (!source.options.interpolate || next == samples.end() ||
+      prev.time_us == time_us) {
+    std::copy(prev.values, prev.values + channels, values);
+    return true;
+  }
+  double ratio = static_cast<double>(time_us - prev.time_us) /
+                 static_cast<double>(next->time_us - prev.time_us);
+  for (int32_t i = 0; i < channels; i++) {
+    values[i] = prev.values[i] + (next->values[i] - prev.values[i]) * ratio;
+  }
+  *interpolated = true;
+  return true;
+}
+
+void SampleMerger::Prune(int64_t time_us) {
+  for (auto& source : sources_) {
+    /// keep the latest sample at or before the time
+    while (source.samples.size() >= 2 && source.samples[1].time_us <= time_us) {
+      source.samples.pop_front();
+    }
+  }
+}
+
+bool SampleRowOf(const FusedRecord& record,
+                 double target_mpa,
+                 double target_n,
+                 SampleRow* row) {
+  if (row == nullptr || !record.valid(kSampleSourceUltrasonic)) {
+    return false;
+  }
+  row->time_us = record.time_us;
+  row->freq = record.values[kSampleSourceUltrasonic][kSampleBusUltraFreq];
+  row->static_load_mpa = std::fabs(target_mpa);
+  if (target_n > 0 && record.valid(kSampleSourceStaticLoad)) {
+    double load_n =
+        record.values[kSampleSourceStaticLoad][kSampleBusStLoadLoad];
+    row->static_load_mpa = std::fabs(load_n * target_mpa / target_n);
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// clz SampleBus
+
+SampleBus::SampleBus(const SampleBusOptions& options)
+    : options_(options),
+      delivering_(false),
+      records_(0),
+      merger_(options),
+      sources_(0) {
+  if (options_.period_us <= 0) {
+    options_.period_us = kSampleBusPeriodUs;
+  }
+}
+
+SampleBus::~SampleBus() {
+  Stop();
+}
+
+int32_t SampleBus::AddSource(const SampleSourceOptions& options) {
+  anx::common::AutoLock lock(&mutex_);
+  if (thread_ != nullptr) {
+    return -1;
+  }
+  int32_t source = merger_.AddSource(options);
+  if (source >= 0) {
+    sources_ = merger_.sources();
+  }
+  return source;
+}
+
+int32_t SampleBus::Start() {
+  if (thread_ != nullptr) {
+    return -1;
+  }
+  {
+    anx::common::AutoLock lock(&mutex_);
+    stop_ = false;
+  }
+  thread_.reset(new anx::common::Thread(this));
+  thread_->start();
+  return 0;
+}
+
+void SampleBus::Stop() {
+  interrupt();
+  if (thread_ == nullptr) {
+    return;
+  }
+  if (thread_->is_current_thread()) {
+    LOG_F(LG_WARN) << "stop the sample bus from the merger thread";
+    return;
+  }
+  thread_->join();
+  thread_.reset();
+}
+
+int32_t SampleBus::Publish(int32_t source, const SourceSample& sample) {
+  anx::common::AutoLock lock(&mutex_);
+  if (source < 0 || source >= sources_) {
+    return -1;
+  }
+  pending_.push_back(std::make_pair(source, sample));
+  return 0;
+}
+
+void SampleBus::Subscribe(FusedRecordListener* listener) {
+  anx::common::AutoLock lock(&mutex_);
+  if (std::find(listeners_.begin(), listeners_.end(), listener) ==
+      listeners_.end()) {
+    listeners_.push_back(listener);
+  }
+}
+
+void SampleBus::Unsubscribe(FusedRecordListener* listener) {
+  anx::common::AutoLock lock(&mutex_);
+  listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), listener),
+                   listeners_.end());
+  if (thread_ != nullptr && thread_->is_current_thread()) {
+    return;
+  }
+  while (delivering_) {
+    cond_.wait(&mutex_);
+  }
+}
+
+bool SampleBus::GetLatestRecord(FusedRecord* record) {
+  return latest_.Load(record);
+}
+
+int64_t SampleBus::records() {
+  anx::common::AutoLock lock(&mutex_);
+  return records_;
+}
+
+void SampleBus::interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  stop_ = true;
+  cond_.broadcast();
+}
+
+bool SampleBus::is_interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  return stop_;
+}
+
+void SampleBus::run() {
+  /// twice a period so the record waits at most half a period more
+  const unsigned int wait_ms = static_cast<unsigned int>(
+      std::max<int64_t>(1, options_.period_us / 2000));
+  std::vector<FusedRecord> records;
+  for (;;) {
+    bool stop = false;
+    {
+      anx::common::AutoLock lock(&mutex_);
+      if (!stop_) {
+        cond_.wait(&mutex_, wait_ms);
+      }
+      stop = stop_;
+    }
+    records.clear();
+    MergePending(NowMicros(), &records);
+    if (!records.empty()) {
+      Deliver(records);
+    }
+    if (stop) {
+      break;
+    }
+  }
+}
+
+void SampleBus::MergePending(int64_t now_us,
+                             std::vector<FusedRecord>* records) {
+  std::vector<std::pair<int32_t, SourceSample>> pending;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    pending.swap(pending_);
+  }
+  for (const auto& item : pending) {
+    merger_.Push(item.first, item.second);
+  }
+  if (merger_.Merge(now_us, records) == 0) {
+    return;
+  }
+  latest_.Store(records->back());
+  anx::common::AutoLock lock(&mutex_);
+  records_ += static_cast<int64_t>(records->size());
+}
+
+void SampleBus::Deliver(const std::vector<FusedRecord>& records) {
+  std::vector<FusedRecordListener*> listeners;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    listeners = listeners_;
+    delivering_ = true;
+  }
+  for (auto listener : listeners) {
+    {
+      /// the listener may be unsubscribed by the listener called before
+      anx::common::AutoLock lock(&mutex_);
+      if (std::find(listeners_.begin(), listeners_.end(), listener) ==
+          listeners_.end()) {
+        continue;
+      }
+    }
+    listener->OnFusedRecords(this, records.data(), records.size());
+  }
+  anx::common::AutoLock lock(&mutex_);
+  delivering_ = false;
+  cond_.broadcast();
+}
+
+}  // namespace device
+}  // namespace anx
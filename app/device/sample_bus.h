@@ -0,0 +1,254 @@
+/**
+ * @file sample_bus.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the sample bus fuses the streams of the sensors by the time, the
+ * sources publish the timestamped samples and the merger thread aligns them
+ * on a time grid for the subscribers, e.g. the storage, the graphs and the
+ * detectors.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_SAMPLE_BUS_H_
+#define APP_DEVICE_SAMPLE_BUS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/common/latest_value.h"
+#include "app/common/thread.h"
+
+namespace anx {
+namespace device {
+
+/// @brief the max sources of one bus
+const int32_t kSampleBusMaxSources = 4;
+/// @brief the max channels of one source
+const int32_t kSampleBusMaxChannels = 4;
+/// @brief the default period of the fused records, 100 ms
+const int64_t kSampleBusPeriodUs = 100 * 1000;
+/// @brief the default max wait of the merger for the late sources
+const int64_t kSampleBusMaxLagUs = 500 * 1000;
+
+/// @brief the source of the ultrasonic generator, the channels are
+/// kSampleBusUltraXXX
+const int32_t kSampleSourceUltrasonic = 0;
+const int32_t kSampleBusUltraFreq = 0;
+const int32_t kSampleBusUltraPower = 1;
+/// @brief the source of the static load frame, the channels are
+/// kSampleBusStLoadXXX
+const int32_t kSampleSourceStaticLoad = 1;
+const int32_t kSampleBusStLoadLoad = 0;
+const int32_t kSampleBusStLoadPosition = 1;
+const int32_t kSampleBusStLoadExtension = 2;
+
+/// @brief one sample of one source
+struct SourceSample {
+  /// @brief the time the sample is read, @see GetCurrentTimeMicros
+  int64_t time_us = 0;
+  double values[kSampleBusMaxChannels] = {0};
+};
+
+/// @brief one record of all the sources at the same time
+struct FusedRecord {
+  int64_t time_us = 0;
+  /// @brief the bit of the source is set if its values are valid
+  uint32_t valid_mask = 0;
+  /// @brief the bit of the source is set if its values are interpolated,
+  /// else the values are of the latest sample before the time.
+  uint32_t interpolated_mask = 0;
+  double values[kSampleBusMaxSources][kSampleBusMaxChannels] = {{0}};
+
+  bool valid(int32_t source) const {
+    return (valid_mask & (1u << source)) != 0;
+  }
+};
+
+struct SampleSourceOptions {
+  std::string name;
+  int32_t channels = 1;
+  /// @brief interpolate the values between the samples, else the latest
+  /// sample before the time is used, e.g. the status bits.
+  bool interpolate = true;
+  /// @brief the max age of the sample used for the record, the source is
+  /// invalid for the record if the sample is older.
+  int64_t max_gap_us = 1000 * 1000;
+};
+
+struct SampleBusOptions {
+  /// @brief the period of the time grid of the records
+  int64_t period_us = kSampleBusPeriodUs;
+  /// @brief the record waits the late sources at most the lag, then it is
+  /// fused with the samples got.
+  int64_t max_lag_us = kSampleBusMaxLagUs;
+};
+
+////////////////////////////////////////////////////////////
+// clz SampleMerger
+/// @brief align the samples of the sources by the time, not thread safe.
+/// the record of the time t is fused when all the sources have the samples
+/// after t or t is older than the max lag.
+class SampleMerger {
+ public:
+  explicit SampleMerger(const SampleBusOptions& options);
+  ~SampleMerger();
+
+ public:
+  /// @brief Add the source
+  /// @return the source id, -1 if the sources are full or the options are
+  /// invalid
+  int32_t AddSource(const SampleSourceOptions& options);
+  /// @brief Push the sample of the source, the samples out of the time order
+  /// are dropped.
+  /// @return 0 if success, -1 if the source is invalid, -2 if dropped
+  int32_t Push(int32_t source, const SourceSample& sample);
+  /// @brief Fuse the records ready by the time
+  /// @param now_us the current time
+  /// @param records the records appended
+  /// @return the count of the records appended
+  size_t Merge(int64_t now_us, std::vector<FusedRecord>* records);
+
+  int32_t sources() const { return static_cast<int32_t>(sources_.size()); }
+  const SampleSourceOptions& source_options(int32_t source) const {
+    return sources_[source].options;
+  }
+  /// @brief Get the count of the samples dropped
+  int64_t dropped() const { return dropped_; }
+
+ private:
+  struct Source {
+    SampleSourceOptions options;
+    std::deque<SourceSample> samples;
+  };
+  /// @brief Fuse the source at the time
+  /// @return true if valid
+  bool Fuse(const Source& source, int64_t time_us, double* values,
+            bool* interpolated) const;
+  /// @brief Drop the samples not needed by the time any more
+  void Prune(int64_t time_us);
+
+ private:
+  SampleBusOptions options_;
+  std::vector<Source> sources_;
+  /// @brief the time of the next record, 0 until the first sample
+  int64_t next_us_;
+  int64_t dropped_;
+};
+
+/// @brief the values of one stored data row, taken from one record so the
+/// frequency, the static load and the time are of the same instant.
+struct SampleRow {
+  int64_t time_us = 0;
+  double freq = 0;
+  /// @brief the static load in MPa
+  double static_load_mpa = 0;
+};
+
+/// @brief Get the data row of the record
+/// @param record the record fused
+/// @param target_mpa the static load of the design in MPa
+/// @param target_n the load in N of the frame for the target_mpa, the load
+/// of the record is scaled by target_mpa / target_n. the target_mpa is used
+/// if it is not positive or the static load of the record is invalid.
+/// @param row the row got
+/// @return false if the ultrasonic values of the record are invalid
+bool SampleRowOf(const FusedRecord& record,
+                 double target_mpa,
+                 double target_n,
+                 SampleRow* row);
+
+class SampleBus;
+
+class FusedRecordListener {
+ public:
+  virtual ~FusedRecordListener() = default;
+
+  /// @brief On the records fused, called on the thread of the merger
+  /// @param bus the bus
+  /// @param records the records in time order
+  /// @param count the count of the records
+  virtual void OnFusedRecords(SampleBus* bus,
+                              const FusedRecord* records,
+                              size_t count) = 0;
+};
+
+////////////////////////////////////////////////////////////
+// clz SampleBus
+/// @brief the publishers only queue the samples, the merger thread fuses
+/// them and delivers the records to the subscribers. the sources are added
+/// before Start.
+class SampleBus : public anx::common::Runnable {
+ public:
+  explicit SampleBus(const SampleBusOptions& options);
+  ~SampleBus() override;
+
+  SampleBus(const SampleBus&) = delete;
+  SampleBus& operator=(const SampleBus&) = delete;
+
+ public:
+  /// @brief Add the source, @see SampleMerger::AddSource
+  /// @return the source id, -1 if failed or started
+  int32_t AddSource(const SampleSourceOptions& options);
+
+  /// @brief Start the merger thread
+  /// @return 0 if success, -1 if started
+  int32_t Start();
+  /// @brief Stop the merger thread, the records ready are delivered
+  void Stop();
+
+  /// @brief Publish the sample of the source, called from any thread
+  /// @return 0 if success, -1 if the source is invalid
+  int32_t Publish(int32_t source, const SourceSample& sample);
+
+  /// @brief Subscribe the records from the next batch
+  void Subscribe(FusedRecordListener* listener);
+  /// @brief Unsubscribe, after it returns the listener is not called any
+  /// more, it may be called from the listener itself.
+  void Unsubscribe(FusedRecordListener* listener);
+
+  /// @brief Get the latest record without the lock
+  /// @return true if any record is fused
+  bool GetLatestRecord(FusedRecord* record);
+  /// @brief Get the count of the records fused
+  int64_t records();
+
+  void interrupt() override;
+  bool is_interrupt() override;
+
+ protected:
+  void run() override;
+
+ private:
+  /// @brief Move the pending samples to the merger and fuse the records
+  void MergePending(int64_t now_us, std::vector<FusedRecord>* records);
+  void Deliver(const std::vector<FusedRecord>& records);
+
+ private:
+  SampleBusOptions options_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  /// @brief the samples published, moved to the merger by its thread
+  std::vector<std::pair<int32_t, SourceSample>> pending_;
+  std::vector<FusedRecordListener*> listeners_;
+  bool delivering_;
+  /// @brief stored by the thread of the merger only
+  anx::common::LatestValue<FusedRecord> latest_;
+  int64_t records_;
+  /// @brief the merger is used by the thread of the merger only
+  SampleMerger merger_;
+  int32_t sources_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_SAMPLE_BUS_H_
@@ -0,0 +1,254 @@
+/**
+ * @file sample_bus_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the sample bus unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/sample_bus.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+const int64_t kMs = 1000;
+
+SourceSample Sample(int64_t time_us, double value0, double value1 = 0) {
+  SourceSample sample;
+  sample.time_us = time_us;
+  sample.values[0] = value0;
+  sample.values[1] = value1;
+  return sample;
+}
+
+SampleSourceOptions Source(const std::string& name, int32_t channels) {
+  SampleSourceOptions options;
+  options.name = name;
+  options.channels = channels;
+  return options;
+}
+
+SampleBusOptions Grid(int64_t period_us, int64_t max_lag_us) {
+  SampleBusOptions options;
+  options.period_us = period_us;
+  options.max_lag_us = max_lag_us;
+  return options;
+}
+
+class RecordListener : public FusedRecordListener {
+ public:
+  void OnFusedRecords(SampleBus* bus,
+                      const FusedRecord* records,
+                      size_t count) override {
+    anx::common::AutoLock lock(&mutex_);
+    records_.insert(records_.end(), records, records + count);
+  }
+  std::vector<FusedRecord> records() {
+    anx::common::AutoLock lock(&mutex_);
+    return records_;
+  }
+
+ private:
+  anx::common::Mutex mutex_;
+  std::vector<FusedRecord> records_;
+};
+}  // namespace
+
+TEST(SampleMergerTest, AddSourceLimits) {
+  SampleMerger merger(Grid(100 * kMs, 0));
+  EXPECT_EQ(merger.AddSource(Source("none", 0)), -1);
+  EXPECT_EQ(merger.AddSource(Source("many", kSampleBusMaxChannels + 1)), -1);
+  for (int32_t i = 0; i < kSampleBusMaxSources; i++) {
+    EXPECT_EQ(merger.AddSource(Source("s", 1)), i);
+  }
+  EXPECT_EQ(merger.AddSource(Source("full", 1)), -1);
+  EXPECT_EQ(merger.Push(kSampleBusMaxSources, Sample(0, 0)), -1);
+}
+
+TEST(SampleMergerTest, InterpolatesBetweenSamples) {
+  SampleMerger merger(Grid(100 * kMs, 1000 * kMs));
+  int32_t ultra = merger.AddSource(Source("ultra", 2));
+  int32_t load = merger.AddSource(Source("load", 1));
+  /// the ultrasonic is slow, the load is fast and offset in time
+  EXPECT_EQ(merger.Push(ultra, Sample(1000 * kMs, 20000, 50)), 0);
+  EXPECT_EQ(merger.Push(ultra, Sample(1200 * kMs, 20100, 70)), 0);
+  for (int64_t t = 995 * kMs; t <= 1205 * kMs; t += 10 * kMs) {
+    EXPECT_EQ(merger.Push(load, Sample(t, t / kMs)), 0);
+  }
+  std::vector<FusedRecord> records;
+  EXPECT_EQ(merger.Merge(1205 * kMs, &records), 3u);
+  ASSERT_EQ(records.size(), 3u);
+  EXPECT_EQ(records[0].time_us, 1000 * kMs);
+  EXPECT_EQ(records[1].time_us, 1100 * kMs);
+  EXPECT_EQ(records[2].time_us, 1200 * kMs);
+  for (const auto& record : records) {
+    EXPECT_TRUE(record.valid(ultra));
+    EXPECT_TRUE(record.valid(load));
+    /// the load is interpolated to the time of the record
+    EXPECT_DOUBLE_EQ(record.values[load][0], record.time_us / kMs);
+  }
+  EXPECT_DOUBLE_EQ(records[0].values[ultra][0], 20000);
+  EXPECT_DOUBLE_EQ(records[1].values[ultra][0], 20050);
+  EXPECT_DOUBLE_EQ(records[1].values[ultra][1], 60);
+  EXPECT_TRUE(records[1].interpolated_mask & (1u << ultra));
+  EXPECT_FALSE(records[2].interpolated_mask & (1u << ultra));
+}
+
+TEST(SampleMergerTest, WaitsLateSourceUntilLag) {
+  SampleMerger merger(Grid(100 * kMs, 300 * kMs));
+  int32_t ultra = merger.AddSource(Source("ultra", 1));
+  int32_t load = merger.AddSource(Source("load", 1));
+  merger.Push(ultra, Sample(1000 * kMs, 1));
+  merger.Push(load, Sample(1000 * kMs, 10));
+  merger.Push(load, Sample(1150 * kMs, 25));
+  std::vector<FusedRecord> records;
+  /// the ultrasonic has no sample after 1100 ms yet
+  EXPECT_EQ(merger.Merge(1150 * kMs, &records), 1u);
+  EXPECT_EQ(merger.Merge(1399 * kMs, &records), 0u);
+  /// the lag passed, the ultrasonic is as of its latest sample
+  EXPECT_EQ(merger.Merge(1400 * kMs, &records), 1u);
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(records[1].time_us, 1100 * kMs);
+  EXPECT_TRUE(records[1].valid(ultra));
+  EXPECT_FALSE(records[1].interpolated_mask & (1u << ultra));
+  EXPECT_DOUBLE_EQ(records[1].values[ultra][0], 1);
+  EXPECT_DOUBLE_EQ(records[1].values[load][0], 20);
+}
+
+TEST(SampleMergerTest, StaleSourceIsInvalid) {
+  SampleMerger merger(Grid(100 * kMs, 0));
+  SampleSourceOptions ultra_options = Source("ultra", 1);
+  ultra_options.max_gap_us = 150 * kMs;
+  int32_t ultra = merger.AddSource(ultra_options);
+  int32_t load = merger.AddSource(Source("load", 1));
+  merger.Push(ultra, Sample(1000 * kMs, 1));
+  for (int64_t t = 1000 * kMs; t <= 1300 * kMs; t += 50 * kMs) {
+    merger.Push(load, Sample(t, 0));
+  }
+  std::vector<FusedRecord> records;
+  EXPECT_EQ(merger.Merge(1300 * kMs, &records), 4u);
+  ASSERT_EQ(records.size(), 4u);
+  EXPECT_TRUE(records[1].valid(ultra));
+  EXPECT_FALSE(records[2].valid(ultra));
+  EXPECT_FALSE(records[3].valid(ultra));
+  EXPECT_TRUE(records[3].valid(load));
+}
+
+TEST(SampleMergerTest, DropsOutOfOrderAndSkipsGaps) {
+  SampleMerger merger(Grid(100 * kMs, 0));
+  SampleSourceOptions options = Source("load", 1);
+  options.max_gap_us = 50 * kMs;
+  int32_t load = merger.AddSource(options);
+  EXPECT_EQ(merger.Push(load, Sample(1000 * kMs, 1)), 0);
+  EXPECT_EQ(merger.Push(load, Sample(900 * kMs, 1)), -2);
+  EXPECT_EQ(merger.dropped(), 1);
+  std::vector<FusedRecord> records;
+  EXPECT_EQ(merger.Merge(1000 * kMs, &records), 1u);
+  /// one hour of nothing makes no records
+  int64_t later_us = 3600 * 1000 * kMs;
+  EXPECT_EQ(merger.Merge(later_us, &records), 0u);
+  merger.Push(load, Sample(later_us + 60 * kMs, 2));
+  /// the record of 200 ms is past the gap of the sample
+  EXPECT_EQ(merger.Merge(later_us + 200 * kMs, &records), 1u);
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(records[1].time_us, later_us + 100 * kMs);
+  EXPECT_DOUBLE_EQ(records[1].values[load][0], 2);
+}
+
+TEST(SampleBusTest, RowOfOneRecord) {
+  FusedRecord record;
+  record.time_us = 300 * kMs;
+  SampleRow row;
+  EXPECT_FALSE(SampleRowOf(record, 100, 2000, &row));
+  record.valid_mask = 1u << kSampleSourceUltrasonic;
+  record.values[kSampleSourceUltrasonic][kSampleBusUltraFreq] = 20123;
+  record.values[kSampleSourceStaticLoad][kSampleBusStLoadLoad] = -1000;
+  /// the static load is not valid, the design value is used
+  ASSERT_TRUE(SampleRowOf(record, -100, 2000, &row));
+  EXPECT_EQ(row.time_us, 300 * kMs);
+  EXPECT_DOUBLE_EQ(row.freq, 20123);
+  EXPECT_DOUBLE_EQ(row.static_load_mpa, 100);
+  record.valid_mask |= 1u << kSampleSourceStaticLoad;
+  ASSERT_TRUE(SampleRowOf(record, 100, 2000, &row));
+  EXPECT_DOUBLE_EQ(row.static_load_mpa, 50);
+  ASSERT_TRUE(SampleRowOf(record, 100, 0, &row));
+  EXPECT_DOUBLE_EQ(row.static_load_mpa, 100);
+}
+
+TEST(SampleBusTest, FusesPublishedSamples) {
+  SampleBus bus(Grid(20 * kMs, 100 * kMs));
+  int32_t ultra = bus.AddSource(Source("ultra", 2));
+  int32_t load = bus.AddSource(Source("load", 3));
+  ASSERT_GE(ultra, 0);
+  ASSERT_GE(load, 0);
+  RecordListener listener;
+  bus.Subscribe(&listener);
+  ASSERT_EQ(bus.Start(), 0);
+  EXPECT_EQ(bus.Start(), -1);
+  EXPECT_EQ(bus.AddSource(Source("late", 1)), -1);
+  EXPECT_EQ(bus.Publish(3, Sample(0, 0)), -1);
+  /// the publishers on their own threads
+  class Publisher : public anx::common::Runnable {
+   public:
+    Publisher(SampleBus* bus, int32_t source, int64_t period_ms)
+        : bus_(bus), source_(source), period_ms_(period_ms) {}
+    void run() override {
+      for (int32_t i = 0; i < 20; i++) {
+        int64_t now_us =
+            static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+        bus_->Publish(source_, Sample(now_us, now_us / 1000.0, i));
+        anx::common::sleep_ms(period_ms_);
+      }
+    }
+
+   private:
+    SampleBus* bus_;
+    int32_t source_;
+    int64_t period_ms_;
+  };
+  Publisher ultra_publisher(&bus, ultra, 10);
+  Publisher load_publisher(&bus, load, 3);
+  anx::common::Thread ultra_thread(&ultra_publisher);
+  anx::common::Thread load_thread(&load_publisher);
+  ultra_thread.start();
+  load_thread.start();
+  ultra_thread.join();
+  load_thread.join();
+  anx::common::sleep_ms(150);
+  bus.Stop();
+  bus.Unsubscribe(&listener);
+  std::vector<FusedRecord> records = listener.records();
+  ASSERT_GE(records.size(), 5u);
+  EXPECT_EQ(bus.records(), static_cast<int64_t>(records.size()));
+  int32_t both = 0;
+  for (size_t i = 0; i < records.size(); i++) {
+    if (i > 0) {
+      EXPECT_EQ(records[i].time_us - records[i - 1].time_us, 20 * kMs);
+    }
+    if (records[i].valid(ultra) && records[i].valid(load) &&
+        (records[i].interpolated_mask & (1u << load))) {
+      both++;
+      /// the value is the time of the sample, interpolated to the record
+      EXPECT_NEAR(records[i].values[load][0], records[i].time_us / 1000.0,
+                  0.001);
+    }
+  }
+  EXPECT_GT(both, 0);
+  FusedRecord latest;
+  ASSERT_TRUE(bus.GetLatestRecord(&latest));
+  EXPECT_EQ(latest.time_us, records.back().time_us);
+}
+
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,111 @@
+/**
+ * @file serial_rx_ring.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief serial receive ring implementation
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/serial_rx_ring.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+namespace anx {
+namespace device {
+
+SerialRxRing::SerialRxRing(size_t capacity, size_t mirror_size)
+    : capacity_(1),
+      mask_(0),
+      mirror_size_(mirror_size),
+      write_pos_(0),
+      read_pos_(0) {
+  capacity = std::max(capacity, mirror_size);
+  while (capacity_ < capacity) {
+    capacity_ <<= 1;
+  }
+  mask_ = capacity_ - 1;
+  buffer_.resize(capacity_ + mirror_size_, 0);
+}
+
+SerialRxRing::~SerialRxRing() {}
+
+size_t SerialRxRing::size() const {
+  return static_cast<size_t>(write_pos_.load(std::memory_order_acquire) -
+                             read_pos_.load(std::memory_order_acquire));
+}
+
+size_t SerialRxRing::free_size() const {
+  return capacity_ - size();
+}
+
+uint8_t* SerialRxRing::WritableSpan(size_t* size) {
+  uint64_t write_pos = write_pos_.load(std::memory_order_relaxed);
+  uint64_t read_pos = read_pos_.load(std::memory_order_acquire);
+  size_t free_size = capacity_ - static_cast<size_t>(write_pos - read_pos);
+  size_t index = static_cast<size_t>(write_pos) & mask_;
+  *size = std::min(free_size, capacity_ - index);
+  if (*size == 0) {
+    return nullptr;
+  }
+  return &buffer_[index];
+}
+
+void SerialRxRing::Commit(size_t size) {
+  uint64_t write_pos = write_pos_.load(std::memory_order_relaxed);
+  size_t index = static_cast<size_t>(write_pos) & mask_;
+  /// mirror the bytes at the start past the end before the bytes are
+  /// published.
+  if (index < mirror_size_) {
+    size_t mirror = std::min(size, mirror_size_ - index);
+    memcpy(&buffer_[capacity_ + index], &buffer_[index], mirror);
+  }
+  write_pos_.store(write_pos + size, std::memory_order_release);
+}
+
+size_t SerialRxRing::Write(const uint8_t* data, size_t size) {
+  size_t written = 0;
+  while (written < size) {
+    size_t span_size = 0;
+    uint8_t* span = WritableSpan(&span_size);
+    if (span == nullptr) {
+      break;
+    }
+    span_size = std::min(span_size, size - written);
+    memcpy(span, data + written, span_size);
+    Commit(span_size);
+    written += span_size;
+  }
+  return written;
+}
+
+const uint8_t* SerialRxRing::Peek(size_t offset, size_t size) const {
+  if (size > mirror_size_ || offset + size > this->size()) {
+    return nullptr;
+  }
+  uint64_t read_pos = read_pos_.load(std::memory_order_relaxed);
+  return &buffer_[static_cast<size_t>(read_pos + offset) & mask_];
+}
+
+uint8_t SerialRxRing::At(size_t offset) const {
+  uint64_t read_pos = read_pos_.load(std::memory_order_relaxed);
+  return buffer_[static_cast<size_t>(read_pos + offset) & mask_];
+}
+
+void SerialRxRing::Consume(size_t size) {
+  size = std::min(size, this->size());
+  read_pos_.fetch_add(size, std::memory_order_release);
+}
+
+size_t SerialRxRing::Clear() {
+  size_t size = this->size();
+  Consume(size);
+  return size;
+}
+
+}  // namespace device
+}  // namespace anx
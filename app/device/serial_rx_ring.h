@@ -0,0 +1,98 @@
+/**
+ * @file serial_rx_ring.h
+ * @author hhool (hhool@outlook.com)
+ * @brief serial receive ring, a single producer single consumer byte ring.
+ * the bytes at the start of the ring are mirrored past the end so the frames
+ * up to the mirror size are always contiguous, the frame views are handed out
+ * without copy.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_SERIAL_RX_RING_H_
+#define APP_DEVICE_SERIAL_RX_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+namespace anx {
+namespace device {
+
+/// @brief the default mirror size, the max modbus rtu frame size
+const size_t kSerialRxRingMirrorSize = 256;
+
+class SerialRxRing {
+ public:
+  /// @brief Constructor
+  /// @param capacity the ring capacity, rounded up to the power of two and
+  /// not less than the mirror size
+  /// @param mirror_size the max size of the contiguous views
+  explicit SerialRxRing(size_t capacity,
+                        size_t mirror_size = kSerialRxRingMirrorSize);
+  ~SerialRxRing();
+
+  SerialRxRing(const SerialRxRing&) = delete;
+  SerialRxRing& operator=(const SerialRxRing&) = delete;
+
+ public:
+  size_t capacity() const { return capacity_; }
+  size_t mirror_size() const { return mirror_size_; }
+
+  /// @brief Get the size of the bytes to read
+  size_t size() const;
+
+  /// @brief Get the size of the free space
+  size_t free_size() const;
+
+  /// @brief the producer side, get the contiguous free space to fill, e.g.
+  /// the buffer of the serial port read.
+  /// @param size the size of the span
+  /// @return the span, nullptr if the ring is full
+  uint8_t* WritableSpan(size_t* size);
+
+  /// @brief the producer side, publish the bytes filled in the span
+  /// @param size the size filled, not more than the span size
+  void Commit(size_t size);
+
+  /// @brief the producer side, copy the data into the ring
+  /// @return the size copied, less than size if the ring is full
+  size_t Write(const uint8_t* data, size_t size);
+
+  /// @brief the consumer side, get the contiguous view of the bytes
+  /// @param offset the offset from the first byte to read
+  /// @param size the view size, not more than the mirror size
+  /// @return the view, nullptr if less bytes to read or size is too large.
+  /// the view is valid until the bytes are consumed.
+  const uint8_t* Peek(size_t offset, size_t size) const;
+
+  /// @brief the consumer side, get one byte
+  /// @param offset the offset from the first byte to read, less than size()
+  uint8_t At(size_t offset) const;
+
+  /// @brief the consumer side, drop the bytes read
+  /// @param size the size, not more than size()
+  void Consume(size_t size);
+
+  /// @brief the consumer side, drop all the bytes to read
+  /// @return the size dropped
+  size_t Clear();
+
+ private:
+  size_t capacity_;
+  size_t mask_;
+  size_t mirror_size_;
+  std::vector<uint8_t> buffer_;
+  std::atomic<uint64_t> write_pos_;
+  std::atomic<uint64_t> read_pos_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_SERIAL_RX_RING_H_
@@ -0,0 +1,352 @@
+/**
+ * @file station.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the station is one rig of the generator and the load frame
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/station.h"
+
+#include <utility>
+
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+#include "app/db/database_factory.h"
+
+namespace anx {
+namespace device {
+
+std::string StationShardPathname(const std::string& db_filepathname,
+                                 int32_t station) {
+  if (db_filepathname.empty() || station == 0) {
+    return db_filepathname;
+  }
+  std::string suffix = ".s" + std::to_string(station);
+  std::string::size_type separator = db_filepathname.find_last_of("/\\");
+  std::string::size_type dot = db_filepathname.rfind('.');
+  if (dot == std::string::npos ||
+      (separator != std::string::npos && dot < separator)) {
+    return db_filepathname + suffix;
+  }
+  std::string shard = db_filepathname;
+  shard.insert(dot, suffix);
+  return shard;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// clz Station
+
+Station::Station(const StationOptions& options)
+    : options_(options),
+      running_(nullptr),
+      busy_since_ms_(0),
+      exited_(false),
+      detached_(false),
+      runs_(0),
+      overruns_(0) {}
+
+Station::~Station() {
+  Stop(0);
+}
+
+int32_t Station::Start() {
+  if (thread_ != nullptr) {
+    return -1;
+  }
+  if (!options_.db_filepathname.empty()) {
+    std::string shard =
+        StationShardPathname(options_.db_filepathname, options_.id);
+    db_ = anx::db::DatabaseFactory::Instance()->CreateOrGetDatabasePool(shard);
+    if (db_ == nullptr) {
+      LOG_F(LG_ERROR) << "station:" << options_.id
+                      << " open database shard failed:" << shard;
+      return -2;
+    }
+  }
+  LOG_F(LG_INFO) << "station:" << options_.id << " name:" << options_.name;
+  stop_ = false;
+  exited_ = false;
+  thread_.reset(new anx::common::Thread(this));
+  thread_->start();
+  return 0;
+}
+
+bool Station::Stop(int32_t timeout_ms) {
+  interrupt();
+  /// the blocking io of the devices returns
+  for (auto& it : devices()) {
+    it->CancelWait();
+    it->Close();
+  }
+  if (thread_ == nullptr) {
+    return true;
+  }
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (detached_) {
+      return exited_;
+    }
+    int64_t deadline_ms = anx::common::GetCurrentTimeMillis() + timeout_ms;
+    while (!exited_) {
+      int64_t remaining_ms = deadline_ms - anx::common::GetCurrentTimeMillis();
+      if (timeout_ms > 0 && remaining_ms <= 0) {
+        break;
+      }
+      cond_.wait(&mutex_,
+                 timeout_ms > 0 ? static_cast<unsigned int>(remaining_ms) : 0);
+    }
+    if (!exited_) {
+      LOG_F(LG_ERROR) << "station:" << options_.id << " hung, the task "
+                      << running_ << " is running since " << busy_since_ms_;
+      thread_->detach();
+      detached_ = true;
+      return false;
+    }
+  }
+  thread_->join();
+  thread_.reset();
+  return true;
+}
+
+void Station::AttachDevice(std::shared_ptr<DeviceComInterface> device) {
+  anx::common::AutoLock lock(&mutex_);
+  devices_.push_back(device);
+}
+
+void Station::AddTask(StationTask* task, int32_t period_ms) {
+  anx::common::AutoLock lock(&mutex_);
+  Task& it = tasks_[task];
+  it.period_ms = period_ms > 0 ? period_ms : 1;
+  it.next_ms = anx::common::GetCurrentTimeMillis();
+  cond_.broadcast();
+}
+
+void Station::RemoveTask(StationTask* task) {
+  anx::common::AutoLock lock(&mutex_);
+  tasks_.erase(task);
+  if (thread_ != nullptr && thread_->is_current_thread()) {
+    return;
+  }
+  while (running_ == task) {
+    cond_.wait(&mutex_);
+  }
+}
+
+std::vector<std::shared_ptr<DeviceComInterface>> Station::devices() {
+  anx::common::AutoLock lock(&mutex_);
+  return devices_;
+}
+
+int64_t Station::busy_since_ms() {
+  anx::common::AutoLock lock(&mutex_);
+  return busy_since_ms_;
+}
+
+bool Station::exited() {
+  anx::common::AutoLock lock(&mutex_);
+  return exited_;
+}
+
+int64_t Station::runs() {
+  anx::common::AutoLock lock(&mutex_);
+  return runs_;
+}
+
+int64_t Station::overruns() {
+  anx::common::AutoLock lock(&mutex_);
+  return overruns_;
+}
+
+void Station::interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  stop_ = true;
+  cond_.broadcast();
+}
+
+bool Station::is_interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  return stop_;
+}
+
+void Station::run() {
+  for (;;) {
+    StationTask* task = nullptr;
+    int64_t now_ms = 0;
+    {
+      anx::common::AutoLock lock(&mutex_);
+      while (!stop_) {
+        now_ms = anx::common::GetCurrentTimeMillis();
+        auto due = tasks_.end();
+        for (auto it = tasks_.begin(); it != tasks_.end(); ++it) {
+          if (due == tasks_.end() || it->second.next_ms < due->second.next_ms) {
+            due = it;
+          }
+        }
+        if (due == tasks_.end()) {
+          cond_.wait(&mutex_);
+        } else if (due->second.next_ms > now_ms) {
+          cond_.wait(&mutex_,
+                     static_cast<unsigned int>(due->second.next_ms - now_ms));
+        } else {
+          task = due->first;
+          break;
+        }
+      }
+      if (task == nullptr) {
+        break;
+      }
+      running_ = task;
+      busy_since_ms_ = now_ms;
+    }
+    task->OnStationTask(this, now_ms);
+    anx::common::AutoLock lock(&mutex_);
+    running_ = nullptr;
+    busy_since_ms_ = 0;
+    runs_++;
+    auto it = tasks_.find(task);
+    if (it != tasks_.end()) {
+      Task& next = it->second;
+      next.next_ms += next.period_ms;
+      int64_t done_ms = anx::common::GetCurrentTimeMillis();
+      if (next.next_ms <= done_ms) {
+        /// skip the missed periods instead of running back to back
+        int64_t missed = (done_ms - next.next_ms) / next.period_ms + 1;
+        overruns_ += missed;
+        next.next_ms += missed * next.period_ms;
+      }
+    }
+    cond_.broadcast();
+  }
+  anx::common::AutoLock lock(&mutex_);
+  exited_ = true;
+  cond_.broadcast();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// clz StationManager
+
+StationManager::StationManager(int32_t thread_budget)
+    : thread_budget_(thread_budget) {}
+
+StationManager::~StationManager() {
+  std::map<int32_t, std::shared_ptr<Station>> stations;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    stations.swap(stations_);
+  }
+  for (auto& it : stations) {
+    if (!it.second->Stop(kStationStopTimeoutMs)) {
+      hung_.push_back(it.second);
+    }
+  }
+  anx::common::AutoLock lock(&mutex_);
+  ReapHung();
+  for (auto& it : hung_) {
+    /// the thread may still run the station, leaked on purpose
+    new std::shared_ptr<Station>(std::move(it));
+  }
+}
+
+int32_t StationManager::AddStation(const StationOptions& options) {
+  std::shared_ptr<Station> station;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (stations_.find(options.id) != stations_.end()) {
+      return -1;
+    }
+    ReapHung();
+    if (static_cast<int32_t>(stations_.size() + hung_.size()) >=
+        thread_budget_) {
+      LOG_F(LG_WARN) << "station:" << options.id << " thread budget "
+                     << thread_budget_ << " used up, hung:" << hung_.size();
+      return -2;
+    }
+    station = std::make_shared<Station>(options);
+    stations_[options.id] = station;
+  }
+  if (station->Start() != 0) {
+    anx::common::AutoLock lock(&mutex_);
+    stations_.erase(options.id);
+    return -3;
+  }
+  return 0;
+}
+
+std::shared_ptr<Station> StationManager::GetStation(int32_t id) {
+  anx::common::AutoLock lock(&mutex_);
+  auto it = stations_.find(id);
+  if (it == stations_.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+int32_t StationManager::RemoveStation(int32_t id, int32_t timeout_ms) {
+  std::shared_ptr<Station> station;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    auto it = stations_.find(id);
+    if (it == stations_.end()) {
+      return -1;
+    }
+    station = it->second;
+    stations_.erase(it);
+  }
+  if (station->Stop(timeout_ms)) {
+    return 0;
+  }
+  anx::common::AutoLock lock(&mutex_);
+  hung_.push_back(station);
+  return -2;
+}
+
+std::vector<int32_t> StationManager::StationIds() {
+  anx::common::AutoLock lock(&mutex_);
+  std::vector<int32_t> ids;
+  for (auto& it : stations_) {
+    ids.push_back(it.first);
+  }
+  return ids;
+}
+
+std::vector<int32_t> StationManager::StalledStations(int64_t now_ms,
+                                                     int64_t threshold_ms) {
+  std::vector<std::shared_ptr<Station>> stations;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    for (auto& it : stations_) {
+      stations.push_back(it.second);
+    }
+  }
+  std::vector<int32_t> stalled;
+  for (auto& it : stations) {
+    int64_t busy_since_ms = it->busy_since_ms();
+    if (busy_since_ms != 0 && now_ms - busy_since_ms >= threshold_ms) {
+      stalled.push_back(it->id());
+    }
+  }
+  return stalled;
+}
+
+int32_t StationManager::threads_in_use() {
+  anx::common::AutoLock lock(&mutex_);
+  ReapHung();
+  return static_cast<int32_t>(stations_.size() + hung_.size());
+}
+
+void StationManager::ReapHung() {
+  for (auto it = hung_.begin(); it != hung_.end();) {
+    if ((*it)->exited()) {
+      it = hung_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,203 @@
+/**
+ * @file station.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the station is one rig of the generator and the load frame, the
+ * stations run on their own threads with their own devices and database
+ * shards, so a hung port of one rig doesn't stall the others.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_STATION_H_
+#define APP_DEVICE_STATION_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/device/device_com.h"
+
+namespace anx {
+namespace db {
+class DatabasePool;
+}  // namespace db
+}  // namespace anx
+
+namespace anx {
+namespace device {
+
+/// @brief the max stations of one process by default
+const int32_t kStationMaxCount = 8;
+/// @brief the max wait time of the thread of the station to stop
+const int32_t kStationStopTimeoutMs = 3000;
+
+class Station;
+
+/// @brief the periodic task of the station, e.g. sample the devices and
+/// store the samples.
+class StationTask {
+ public:
+  virtual ~StationTask() {}
+
+  /// @brief Run on the thread of the station, the blocking io of the
+  /// devices of the station is allowed.
+  /// @param station the station
+  /// @param now_ms the time the task is run
+  virtual void OnStationTask(Station* station, int64_t now_ms) = 0;
+};
+
+struct StationOptions {
+  /// @brief the station id, 0 is the single rig
+  int32_t id = 0;
+  std::string name;
+  /// @brief the database file of the stations, each station opens its shard
+  /// @see StationShardPathname. empty for no database.
+  std::string db_filepathname;
+};
+
+/// @brief Get the database shard of the station, the station 0 keeps the
+/// file, the others are suffixed, e.g. anxi.db to anxi.s2.db.
+std::string StationShardPathname(const std::string& db_filepathname,
+                                 int32_t station);
+
+////////////////////////////////////////////////////////////
+// clz Station
+/// @brief the scheduler thread of the station runs the tasks by their
+/// periods, the missed periods are skipped and counted as the overruns.
+class Station : public anx::common::Runnable {
+ public:
+  explicit Station(const StationOptions& options);
+  ~Station() override;
+
+  Station(const Station&) = delete;
+  Station& operator=(const Station&) = delete;
+
+ public:
+  /// @brief Open the database shard and start the thread
+  /// @return 0 if success, -1 if started, -2 if the database shard failed
+  int32_t Start();
+
+  /// @brief Stop the thread, the devices attached are canceled and closed so
+  /// the blocking io returns.
+  /// @param timeout_ms the max wait time of the thread, 0 waits forever
+  /// @return true if the thread exited, false if the thread is hung, the
+  /// thread is detached and the station must not be destroyed until exited.
+  bool Stop(int32_t timeout_ms);
+
+  /// @brief Attach the device of the station, closed on Stop
+  void AttachDevice(std::shared_ptr<DeviceComInterface> device);
+
+  /// @brief Add the task run every period, the first run is at once
+  void AddTask(StationTask* task, int32_t period_ms);
+
+  /// @brief Remove the task, wait for the task running unless called from
+  /// the task itself.
+  void RemoveTask(StationTask* task);
+
+  int32_t id() const { return options_.id; }
+  const std::string& name() const { return options_.name; }
+  std::vector<std::shared_ptr<DeviceComInterface>> devices();
+  /// @brief Get the database shard, nullptr if no database
+  std::shared_ptr<anx::db::DatabasePool> database() const { return db_; }
+
+  /// @brief Get the time the running task started, 0 if idle
+  int64_t busy_since_ms();
+  /// @brief Check the thread has exited
+  bool exited();
+  /// @brief Get the count of the tasks run
+  int64_t runs();
+  /// @brief Get the count of the periods skipped for the late tasks
+  int64_t overruns();
+
+  void interrupt() override;
+  bool is_interrupt() override;
+
+ protected:
+  void run() override;
+
+ private:
+  struct Task {
+    int32_t period_ms;
+    int64_t next_ms;
+  };
+
+ private:
+  StationOptions options_;
+  std::shared_ptr<anx::db::DatabasePool> db_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  std::map<StationTask*, Task> tasks_;
+  std::vector<std::shared_ptr<DeviceComInterface>> devices_;
+  StationTask* running_;
+  int64_t busy_since_ms_;
+  bool exited_;
+  /// @brief the thread is detached by Stop for hung
+  bool detached_;
+  int64_t runs_;
+  int64_t overruns_;
+};
+
+////////////////////////////////////////////////////////////
+// clz StationManager
+/// @brief the stations of the process share the thread budget, a station
+/// takes one thread. the hung station keeps its thread in the budget until
+/// the thread exits.
+class StationManager {
+ public:
+  explicit StationManager(int32_t thread_budget = kStationMaxCount);
+  ~StationManager();
+
+  StationManager(const StationManager&) = delete;
+  StationManager& operator=(const StationManager&) = delete;
+
+ public:
+  /// @brief Add and start the station
+  /// @return 0 if success, -1 if the id exists, -2 if the thread budget is
+  /// used up, -3 if the station failed to start
+  int32_t AddStation(const StationOptions& options);
+
+  /// @brief Get the station, nullptr if not found
+  std::shared_ptr<Station> GetStation(int32_t id);
+
+  /// @brief Stop and remove the station
+  /// @param timeout_ms the max wait time of the thread of the station
+  /// @return 0 if success, -1 if not found, -2 if the station is hung, it's
+  /// removed and its thread is left running.
+  int32_t RemoveStation(int32_t id,
+                        int32_t timeout_ms = kStationStopTimeoutMs);
+
+  /// @brief Get the ids of the stations
+  std::vector<int32_t> StationIds();
+
+  /// @brief Get the stations running a task longer than the threshold, e.g.
+  /// the port is hung.
+  std::vector<int32_t> StalledStations(int64_t now_ms, int64_t threshold_ms);
+
+  int32_t thread_budget() const { return thread_budget_; }
+  /// @brief Get the threads of the stations and of the hung stations
+  int32_t threads_in_use();
+
+ private:
+  /// @brief Drop the hung stations exited, called with the mutex locked
+  void ReapHung();
+
+ private:
+  int32_t thread_budget_;
+  anx::common::Mutex mutex_;
+  std::map<int32_t, std::shared_ptr<Station>> stations_;
+  /// @brief the stations removed with the thread still running
+  std::vector<std::shared_ptr<Station>> hung_;
+};
+
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_STATION_H_
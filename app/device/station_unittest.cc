@@ -0,0 +1,175 @@
+/**
+ * @file station_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the station is one rig of the generator and the load frame unit
+ * test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/station.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+
+namespace {
+class CountTask : public StationTask {
+ public:
+  explicit CountTask(int32_t work_ms = 0) : work_ms_(work_ms) {}
+  void OnStationTask(Station* station, int64_t now_ms) override {
+    if (work_ms_ > 0) {
+      anx::common::sleep_ms(work_ms_);
+    }
+    runs_++;
+  }
+  int32_t work_ms_;
+  std::atomic<int32_t> runs_{0};
+};
+
+/// @brief the task hangs until released, e.g. the port never answers
+class HangTask : public StationTask {
+ public:
+  void OnStationTask(Station* station, int64_t now_ms) override {
+    entered_ = true;
+    while (!released_) {
+      anx::common::sleep_ms(1);
+    }
+  }
+  std::atomic<bool> entered_{false};
+  std::atomic<bool> released_{false};
+};
+
+StationOptions MakeOptions(int32_t id) {
+  StationOptions options;
+  options.id = id;
+  options.name = "station" + std::to_string(id);
+  return options;
+}
+
+bool WaitFor(const std::atomic<bool>& flag, int32_t timeout_ms) {
+  for (int32_t i = 0; i < timeout_ms && !flag; i++) {
+    anx::common::sleep_ms(1);
+  }
+  return flag;
+}
+}  // namespace
+
+TEST(StationTest, ShardPathname) {
+  EXPECT_EQ(StationShardPathname("db/anxi.db", 0), "db/anxi.db");
+  EXPECT_EQ(StationShardPathname("db/anxi.db", 2), "db/anxi.s2.db");
+  EXPECT_EQ(StationShardPathname("db.dir\\anxi", 3), "db.dir\\anxi.s3");
+  EXPECT_EQ(StationShardPathname("", 3), "");
+}
+
+TEST(StationTest, TasksRunByPeriod) {
+  Station station(MakeOptions(1));
+  CountTask fast;
+  CountTask slow;
+  station.AddTask(&fast, 10);
+  station.AddTask(&slow, 50);
+  ASSERT_EQ(station.Start(), 0);
+  EXPECT_EQ(station.Start(), -1);
+  anx::common::sleep_ms(300);
+  station.RemoveTask(&fast);
+  int32_t fast_runs = fast.runs_;
+  anx::common::sleep_ms(50);
+  EXPECT_EQ(fast.runs_, fast_runs);
+  EXPECT_TRUE(station.Stop(kStationStopTimeoutMs));
+  EXPECT_TRUE(station.exited());
+  EXPECT_GE(fast_runs, 15);
+  EXPECT_LE(fast_runs, 32);
+  EXPECT_GE(slow.runs_, 4);
+  EXPECT_LE(slow.runs_, 8);
+}
+
+TEST(StationTest, OverrunsSkipped) {
+  Station station(MakeOptions(1));
+  CountTask late(35);
+  station.AddTask(&late, 10);
+  ASSERT_EQ(station.Start(), 0);
+  anx::common::sleep_ms(200);
+  EXPECT_TRUE(station.Stop(kStationStopTimeoutMs));
+  EXPECT_GT(station.overruns(), 0);
+  EXPECT_LE(late.runs_, 7);
+}
+
+TEST(StationManagerTest, Budget) {
+  StationManager manager(2);
+  EXPECT_EQ(manager.AddStation(MakeOptions(1)), 0);
+  EXPECT_EQ(manager.AddStation(MakeOptions(1)), -1);
+  EXPECT_EQ(manager.AddStation(MakeOptions(2)), 0);
+  EXPECT_EQ(manager.AddStation(MakeOptions(3)), -2);
+  EXPECT_EQ(manager.threads_in_use(), 2);
+  EXPECT_EQ(manager.StationIds(), std::vector<int32_t>({1, 2}));
+  EXPECT_EQ(manager.RemoveStation(1), 0);
+  EXPECT_EQ(manager.RemoveStation(1), -1);
+  EXPECT_EQ(manager.GetStation(1), nullptr);
+  EXPECT_EQ(manager.AddStation(MakeOptions(3)), 0);
+}
+
+TEST(StationManagerTest, HungStationIsolated) {
+  const int32_t kStations = 4;
+  /// the tasks outlive the stations
+  HangTask hang;
+  std::vector<std::unique_ptr<CountTask>> counts;
+  StationManager manager(kStations);
+  for (int32_t i = 0; i < kStations; i++) {
+    ASSERT_EQ(manager.AddStation(MakeOptions(i)), 0);
+    if (i == 1) {
+      manager.GetStation(i)->AddTask(&hang, 10);
+    } else {
+      counts.emplace_back(new CountTask());
+      manager.GetStation(i)->AddTask(counts.back().get(), 10);
+    }
+  }
+  ASSERT_TRUE(WaitFor(hang.entered_, 1000));
+  anx::common::sleep_ms(200);
+  for (auto& it : counts) {
+    EXPECT_GE(it->runs_, 10);
+  }
+  int64_t now_ms = anx::common::GetCurrentTimeMillis();
+  EXPECT_EQ(manager.StalledStations(now_ms, 100), std::vector<int32_t>({1}));
+
+  /// the hung station keeps its thread in the budget
+  EXPECT_EQ(manager.RemoveStation(1, 50), -2);
+  EXPECT_EQ(manager.threads_in_use(), kStations);
+  EXPECT_EQ(manager.AddStation(MakeOptions(5)), -2);
+  hang.released_ = true;
+  for (int32_t i = 0; i < 1000 && manager.threads_in_use() == kStations;
+       i++) {
+    anx::common::sleep_ms(1);
+  }
+  EXPECT_EQ(manager.threads_in_use(), kStations - 1);
+  EXPECT_EQ(manager.AddStation(MakeOptions(5)), 0);
+}
+
+TEST(StationManagerTest, StationsScale) {
+  const int32_t kWorkMs = 5;
+  const int32_t kPeriodMs = 10;
+  std::vector<std::unique_ptr<CountTask>> counts;
+  StationManager manager(kStationMaxCount);
+  for (int32_t i = 0; i < kStationMaxCount; i++) {
+    ASSERT_EQ(manager.AddStation(MakeOptions(i)), 0);
+    counts.emplace_back(new CountTask(kWorkMs));
+    manager.GetStation(i)->AddTask(counts.back().get(), kPeriodMs);
+  }
+  anx::common::sleep_ms(300);
+  /// the blocking work of the stations overlaps, each keeps its period
+  for (auto& it : counts) {
+    EXPECT_GE(it->runs_, 300 / kPeriodMs / 2);
+  }
+}
+
+}  // namespace device
+}  // namespace anx
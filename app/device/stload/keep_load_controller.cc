@@ -0,0 +1,338 @@
+/**
+ * @file keep_load_controller.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the keep load controller holds the load of the static load frame
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/stload/keep_load_controller.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+#include "app/device/device_exp_load_static_settings.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+namespace {
+double Clamp(double value, double limit) {
+  return std::max(-limit, std::min(limit, value));
+}
+
+bool IsActive(KeepLoadState state) {
+  return state == kKeepLoadApproach || state == kKeepLoadRegulate ||
+         state == kKeepLoadHold;
+}
+}  // namespace
+
+KeepLoadOptions KeepLoadOptionsFromSettings(const DeviceLoadStatic& settings) {
+  KeepLoadOptions options;
+  options.target_n = fabs(static_cast<double>(settings.retention_));
+  /// the up moves to the negative load
+  options.direction = settings.direct_ == 1 ? -1 : 1;
+  double threshold_n = fabs(static_cast<double>(settings.threshold_));
+  options.threshold_n = std::min(threshold_n, options.target_n);
+  if (settings.speed_ > 0) {
+    options.max_speed_mm_per_s = settings.speed_ / 60.0;
+  }
+  options.keep_duration_ms =
+      static_cast<int64_t>(settings.keep_load_duration_ * 1000);
+  return options;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// clz KeepLoadController
+
+KeepLoadController::KeepLoadController(StaticLoadDevice* device,
+                                       StaticLoadActuator* actuator,
+                                       const KeepLoadOptions& options)
+    : device_(device),
+      actuator_(actuator),
+      options_(options),
+      listener_(nullptr),
+      has_sample_(false),
+      state_start_ms_(0),
+      command_ms_(0),
+      integral_(0),
+      previous_load_(0) {
+  if (options_.threshold_n <= 0 || options_.threshold_n > options_.target_n) {
+    options_.threshold_n = options_.target_n;
+  }
+  if (options_.loop_rate_hz <= 0) {
+    options_.loop_rate_hz = kKeepLoadLoopRateHz;
+  }
+}
+
+KeepLoadController::~KeepLoadController() {
+  Stop();
+}
+
+int32_t KeepLoadController::Start() {
+  if (thread_ != nullptr) {
+    return -1;
+  }
+  if (options_.target_n <= 0 || options_.approach_speed_mm_per_s <= 0 ||
+      options_.max_speed_mm_per_s <= 0) {
+    return -2;
+  }
+  {
+    anx::common::AutoLock lock(&mutex_);
+    stop_ = false;
+    has_sample_ = false;
+    status_ = KeepLoadStatus();
+  }
+  LOG_F(LG_INFO) << "keep load target:" << options_.target_n
+                 << " direction:" << options_.direction
+                 << " threshold:" << options_.threshold_n
+                 << " keep duration:" << options_.keep_duration_ms;
+  device_->AddListener(this);
+  thread_.reset(new anx::common::Thread(this));
+  thread_->start();
+  return 0;
+}
+
+void KeepLoadController::Stop() {
+  interrupt();
+  if (thread_ == nullptr) {
+    return;
+  }
+  thread_->join();
+  thread_.reset();
+  device_->RemoveListener(this);
+  if (IsActive(state())) {
+    actuator_->StopRun();
+    SetState(kKeepLoadStopped, kKeepLoadFaultNone,
+             anx::common::GetCurrentTimeMillis());
+  }
+}
+
+KeepLoadState KeepLoadController::state() {
+  anx::common::AutoLock lock(&mutex_);
+  return status_.state;
+}
+
+KeepLoadStatus KeepLoadController::status() {
+  anx::common::AutoLock lock(&mutex_);
+  return status_;
+}
+
+void KeepLoadController::interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  stop_ = true;
+  cond_.broadcast();
+}
+
+bool KeepLoadController::is_interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  return stop_;
+}
+
+void KeepLoadController::OnStaticLoadSamples(StaticLoadDevice* device,
+                                             const StaticLoadSample* samples,
+                                             size_t count) {
+  if (count == 0) {
+    return;
+  }
+  anx::common::AutoLock lock(&mutex_);
+  sample_ = samples[count - 1];
+  has_sample_ = true;
+}
+
+void KeepLoadController::run() {
+  const int64_t period_us = 1000000 / options_.loop_rate_hz;
+  int64_t now_ms = anx::common::GetCurrentTimeMillis();
+  SetState(kKeepLoadApproach, kKeepLoadFaultNone, now_ms);
+  int64_t next_us = static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+  for (;;) {
+    {
+      anx::common::AutoLock lock(&mutex_);
+      while (!stop_) {
+        int64_t remaining_us =
+            next_us - static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+        if (remaining_us < 1000) {
+          break;
+        }
+        cond_.wait(&mutex_, static_cast<unsigned int>(remaining_us / 1000));
+      }
+      if (stop_) {
+        break;
+      }
+    }
+    if (!Tick(anx::common::GetCurrentTimeMillis())) {
+      break;
+    }
+    next_us += period_us;
+    int64_t now_us = static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+    if (next_us <= now_us) {
+      next_us = now_us + period_us;
+    }
+  }
+}
+
+bool KeepLoadController::Tick(int64_t now_ms) {
+  StaticLoadSample sample;
+  bool has_sample = false;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    sample = sample_;
+    has_sample = has_sample_;
+  }
+  KeepLoadState state = this->state();
+  int64_t sample_ms = sample.time_us / 1000;
+  int64_t since_ms = has_sample ? sample_ms : state_start_ms_;
+  if (now_ms - since_ms > options_.sample_timeout_ms) {
+    actuator_->StopRun();
+    SetState(kKeepLoadFault, kKeepLoadFaultNoSample, now_ms);
+    return false;
+  }
+  if (!has_sample) {
+    return true;
+  }
+  /// the load in the direction of the target
+  double load = options_.direction * sample.load;
+  double velocity = 0;
+  if (state == kKeepLoadApproach) {
+    if (load >= options_.threshold_n) {
+      integral_ = 0;
+      previous_load_ = load;
+      SetState(kKeepLoadRegulate, kKeepLoadFaultNone, now_ms);
+      state = kKeepLoadRegulate;
+    } else if (now_ms - state_start_ms_ > options_.approach_timeout_ms) {
+      actuator_->StopRun();
+      SetState(kKeepLoadFault, kKeepLoadFaultApproachTimeout, now_ms);
+      return false;
+    } else {
+      velocity = options_.approach_speed_mm_per_s;
+    }
+  }
+  if (state == kKeepLoadRegulate || state == kKeepLoadHold) {
+    double error = options_.target_n - load;
+    velocity = Regulate(load, 1.0 / options_.loop_rate_hz);
+    if (state == kKeepLoadRegulate && fabs(error) <= options_.hysteresis_n) {
+      SetState(kKeepLoadHold, kKeepLoadFaultNone, now_ms);
+      state = kKeepLoadHold;
+    } else if (state == kKeepLoadRegulate &&
+               now_ms - state_start_ms_ > options_.settle_timeout_ms) {
+      actuator_->StopRun();
+      SetState(kKeepLoadFault, kKeepLoadFaultSettleTimeout, now_ms);
+      return false;
+    }
+    if (state == kKeepLoadHold && options_.keep_duration_ms > 0 &&
+        now_ms - state_start_ms_ >= options_.keep_duration_ms) {
+      actuator_->StopRun();
+      SetState(kKeepLoadDone, kKeepLoadFaultNone, now_ms);
+      return false;
+    }
+  }
+  if (Command(options_.direction * velocity, now_ms) != 0) {
+    actuator_->StopRun();
+    SetState(kKeepLoadFault, kKeepLoadFaultActuator, now_ms);
+    return false;
+  }
+  anx::common::AutoLock lock(&mutex_);
+  status_.load = sample.load;
+  return true;
+}
+
+double KeepLoadController::Regulate(double load, double dt_s) {
+  double error = options_.target_n - load;
+  /// on the measurement, no kick when the band is entered
+  double derivative = -(load - previous_load_) / dt_s;
+  previous_load_ = load;
+  if (fabs(error) <= options_.hysteresis_n) {
+    return 0;
+  }
+  if (fabs(error) > options_.bang_band_n) {
+    /// bang-bang out of the band, the integral restarts in the band
+    integral_ = 0;
+    return error > 0 ? options_.max_speed_mm_per_s
+                     : -options_.max_speed_mm_per_s;
+  }
+  double velocity = options_.kp * error + options_.ki * integral_ +
+                    options_.kd * derivative;
+  if (fabs(velocity) < options_.max_speed_mm_per_s) {
+    /// no windup while saturated
+    integral_ += error * dt_s;
+  }
+  return Clamp(velocity, options_.max_speed_mm_per_s);
+}
+
+int32_t KeepLoadController::Command(double velocity, int64_t now_ms) {
+  double previous = 0;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    previous = status_.velocity;
+  }
+  if (velocity == 0) {
+    if (previous != 0) {
+      actuator_->StopRun();
+      anx::common::AutoLock lock(&mutex_);
+      status_.velocity = 0;
+      status_.commands++;
+    }
+    return 0;
+  }
+  bool renew = now_ms - command_ms_ >= options_.lease_s * 1000 / 2;
+  bool changed = (velocity > 0) != (previous > 0) ||
+                 fabs(velocity - previous) > 0.1 * fabs(previous);
+  if (!renew && !changed) {
+    return 0;
+  }
+  StaticLoadCommand command;
+  command.control = kStaticLoadCtrlPosi;
+  command.end = kStaticLoadEndTime;
+  command.speed = fabs(velocity);
+  command.value = options_.lease_s;
+  command.direction = velocity > 0 ? 1 : -1;
+  int32_t ret = actuator_->Carry200(command);
+  if (ret != 0) {
+    LOG_F(LG_ERROR) << "keep load command failed:" << ret;
+    return ret;
+  }
+  command_ms_ = now_ms;
+  anx::common::AutoLock lock(&mutex_);
+  status_.velocity = velocity;
+  status_.commands++;
+  return 0;
+}
+
+void KeepLoadController::SetState(KeepLoadState state,
+                                  KeepLoadFault fault,
+                                  int64_t now_ms) {
+  KeepLoadStatus status;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (status_.state == state) {
+      return;
+    }
+    status_.state = state;
+    status_.fault = fault;
+    if (state == kKeepLoadHold) {
+      status_.hold_start_ms = now_ms;
+    }
+    if (!IsActive(state)) {
+      status_.velocity = 0;
+    }
+    status = status_;
+  }
+  state_start_ms_ = now_ms;
+  LOG_F(state == kKeepLoadFault ? LG_ERROR : LG_INFO)
+      << "keep load state:" << state << " fault:" << fault
+      << " load:" << status.load;
+  if (listener_ != nullptr) {
+    listener_->OnKeepLoadStateChanged(this, status);
+  }
+}
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,208 @@
+/**
+ * @file keep_load_controller.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the keep load controller holds the load of the static load frame on
+ * its own thread, the control latency doesn't depend on the window messages.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_STLOAD_KEEP_LOAD_CONTROLLER_H_
+#define APP_DEVICE_STLOAD_KEEP_LOAD_CONTROLLER_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "app/common/thread.h"
+#include "app/device/stload/static_load_device.h"
+
+namespace anx {
+namespace device {
+class DeviceLoadStatic;
+}  // namespace device
+}  // namespace anx
+
+namespace anx {
+namespace device {
+namespace stload {
+
+/// @brief the default rate of the control loop
+const int32_t kKeepLoadLoopRateHz = 200;
+
+enum KeepLoadState {
+  kKeepLoadIdle = 0,
+  /// @brief move by the position control until the load reaches the
+  /// threshold
+  kKeepLoadApproach = 1,
+  /// @brief regulate the load to the target
+  kKeepLoadRegulate = 2,
+  /// @brief the target reached, hold it for the keep duration
+  kKeepLoadHold = 3,
+  /// @brief the keep duration passed, the actuator is stopped
+  kKeepLoadDone = 4,
+  /// @brief stopped by Stop
+  kKeepLoadStopped = 5,
+  /// @brief stopped by the fault
+  kKeepLoadFault = 6,
+};
+
+enum KeepLoadFault {
+  kKeepLoadFaultNone = 0,
+  kKeepLoadFaultApproachTimeout = 1,
+  kKeepLoadFaultSettleTimeout = 2,
+  /// @brief the samples are older than the sample timeout
+  kKeepLoadFaultNoSample = 3,
+  /// @brief the command of the actuator failed
+  kKeepLoadFaultActuator = 4,
+};
+
+struct KeepLoadOptions {
+  /// @brief the load kept, the retention of the settings
+  double target_n = 0;
+  /// @brief 1 the load is positive, -1 the load is negative, e.g. up
+  int32_t direction = 1;
+  /// @brief the load switching the approach to the regulation, the target
+  /// if 0.
+  double threshold_n = 0;
+  /// @brief the speed of the approach
+  double approach_speed_mm_per_s = 2.0 / 60.0;
+  /// @brief the max speed of the regulation
+  double max_speed_mm_per_s = 2.0 / 60.0;
+  /// @brief the error out of the band moves by the max speed, the PID
+  /// regulates in the band.
+  double bang_band_n = 50;
+  /// @brief the error in the hysteresis holds the actuator
+  double hysteresis_n = 2;
+  /// @brief the gains of the PID, mm/s per N
+  double kp = 0.0005;
+  double ki = 0.0002;
+  double kd = 0;
+  /// @brief the time the target is kept, 0 keeps until Stop
+  int64_t keep_duration_ms = 0;
+  int32_t loop_rate_hz = kKeepLoadLoopRateHz;
+  int64_t approach_timeout_ms = 120 * 1000;
+  /// @brief the max time of the regulation to reach the hysteresis
+  int64_t settle_timeout_ms = 30 * 1000;
+  /// @brief the max age of the sample
+  int64_t sample_timeout_ms = 500;
+  /// @brief the end time of the move command, the actuator stops by itself
+  /// if the loop stops commanding.
+  double lease_s = 0.5;
+};
+
+/// @brief Get the options of the keep load settings
+/// @param settings the static load settings
+/// @return the options, the speed of the settings is mm/min
+KeepLoadOptions KeepLoadOptionsFromSettings(const DeviceLoadStatic& settings);
+
+struct KeepLoadStatus {
+  KeepLoadState state = kKeepLoadIdle;
+  KeepLoadFault fault = kKeepLoadFaultNone;
+  /// @brief the load of the latest sample
+  double load = 0;
+  /// @brief the velocity commanded, signed
+  double velocity = 0;
+  /// @brief the time the hold started, 0 if not held
+  int64_t hold_start_ms = 0;
+  /// @brief the count of the commands of the actuator
+  int64_t commands = 0;
+};
+
+class KeepLoadController;
+
+class KeepLoadListener {
+ public:
+  virtual ~KeepLoadListener() = default;
+
+  /// @brief On the state changed, called on the thread of the controller,
+  /// the window posts it to itself.
+  virtual void OnKeepLoadStateChanged(KeepLoadController* controller,
+                                      const KeepLoadStatus& status) = 0;
+};
+
+////////////////////////////////////////////////////////////
+// clz KeepLoadController
+/// @brief the loop approaches the target by the position control, then
+/// regulates the load with the bang-bang out of the band and the PID in the
+/// band. the moves are the commands of the time end so the actuator stops if
+/// the loop stops.
+class KeepLoadController : public anx::common::Runnable,
+                           public StaticLoadListener {
+ public:
+  /// @brief Constructor
+  /// @param device the device of the samples, not owned
+  /// @param actuator the actuator of the commands, not owned
+  /// @param options the options
+  KeepLoadController(StaticLoadDevice* device,
+                     StaticLoadActuator* actuator,
+                     const KeepLoadOptions& options);
+  ~KeepLoadController() override;
+
+  KeepLoadController(const KeepLoadController&) = delete;
+  KeepLoadController& operator=(const KeepLoadController&) = delete;
+
+ public:
+  /// @brief Start the loop
+  /// @return 0 if success, -1 if started, -2 if the options are invalid
+  int32_t Start();
+  /// @brief Stop the loop and the actuator, the state is kKeepLoadStopped
+  /// unless done or fault.
+  void Stop();
+
+  /// @brief Set the listener of the state, set before Start
+  void SetListener(KeepLoadListener* listener) { listener_ = listener; }
+
+  KeepLoadState state();
+  KeepLoadStatus status();
+  const KeepLoadOptions& options() const { return options_; }
+
+  void interrupt() override;
+  bool is_interrupt() override;
+
+ protected:
+  // impliment StaticLoadListener
+  void OnStaticLoadSamples(StaticLoadDevice* device,
+                           const StaticLoadSample* samples,
+                           size_t count) override;
+
+  void run() override;
+
+ private:
+  /// @brief Run one period of the loop
+  /// @return true if the loop goes on
+  bool Tick(int64_t now_ms);
+  /// @brief Get the velocity of the regulation in the direction of the load
+  /// @param load the load in the direction of the target
+  double Regulate(double load, double dt_s);
+  /// @brief Command the velocity, the same velocity is renewed by the lease
+  /// @return 0 if success
+  int32_t Command(double velocity, int64_t now_ms);
+  void SetState(KeepLoadState state, KeepLoadFault fault, int64_t now_ms);
+
+ private:
+  StaticLoadDevice* device_;
+  StaticLoadActuator* actuator_;
+  KeepLoadOptions options_;
+  KeepLoadListener* listener_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  KeepLoadStatus status_;
+  StaticLoadSample sample_;
+  bool has_sample_;
+  /// @brief the states of the loop thread
+  int64_t state_start_ms_;
+  int64_t command_ms_;
+  double integral_;
+  double previous_load_;
+};
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_STLOAD_KEEP_LOAD_CONTROLLER_H_
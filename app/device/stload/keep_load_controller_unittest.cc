@@ -0,0 +1,194 @@
+/**
+ * @file keep_load_controller_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the keep load controller unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/stload/keep_load_controller.h"
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/common/time_utils.h"
+#include "app/device/stload/static_load_simulator.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+namespace {
+StaticLoadOptions SimulatorSampling() {
+  StaticLoadOptions options;
+  options.sample_rate_hz = 1000;
+  options.batch_size = 1;
+  return options;
+}
+
+KeepLoadOptions FastOptions(double target_n, int32_t direction) {
+  KeepLoadOptions options;
+  options.target_n = target_n;
+  options.direction = direction;
+  options.approach_speed_mm_per_s = 0.5;
+  options.max_speed_mm_per_s = 0.5;
+  options.kp = 0.002;
+  options.ki = 0.001;
+  options.approach_timeout_ms = 5000;
+  options.settle_timeout_ms = 5000;
+  return options;
+}
+
+class StateListener : public KeepLoadListener {
+ public:
+  void OnKeepLoadStateChanged(KeepLoadController* controller,
+                              const KeepLoadStatus& status) override {
+    anx::common::AutoLock lock(&mutex_);
+    states_.push_back(status.state);
+  }
+  std::vector<KeepLoadState> states() {
+    anx::common::AutoLock lock(&mutex_);
+    return states_;
+  }
+
+ private:
+  anx::common::Mutex mutex_;
+  std::vector<KeepLoadState> states_;
+};
+
+/// @brief Wait the state of the controller
+/// @return true if the state is reached before the timeout
+bool WaitState(KeepLoadController* controller,
+               KeepLoadState state,
+               int64_t timeout_ms) {
+  int64_t end_ms = anx::common::GetCurrentTimeMillis() + timeout_ms;
+  while (anx::common::GetCurrentTimeMillis() < end_ms) {
+    if (controller->state() == state) {
+      return true;
+    }
+    anx::common::sleep_ms(5);
+  }
+  return controller->state() == state;
+}
+}  // namespace
+
+TEST(KeepLoadControllerTest, InvalidOptions) {
+  StaticLoadSimulator simulator(SimulatorSampling(),
+                                StaticLoadSimulatorOptions());
+  KeepLoadController controller(&simulator, &simulator, KeepLoadOptions());
+  EXPECT_EQ(controller.Start(), -2);
+  EXPECT_EQ(controller.state(), kKeepLoadIdle);
+}
+
+TEST(KeepLoadControllerTest, ReachesAndHoldsTarget) {
+  StaticLoadSimulator simulator(SimulatorSampling(),
+                                StaticLoadSimulatorOptions());
+  ASSERT_EQ(simulator.Open(), 0);
+  ASSERT_EQ(simulator.StartSampling(), 0);
+  KeepLoadOptions options = FastOptions(300, 1);
+  options.threshold_n = 250;
+  options.keep_duration_ms = 300;
+  StateListener listener;
+  KeepLoadController controller(&simulator, &simulator, options);
+  controller.SetListener(&listener);
+  ASSERT_EQ(controller.Start(), 0);
+  EXPECT_EQ(controller.Start(), -1);
+  ASSERT_TRUE(WaitState(&controller, kKeepLoadHold, 5000));
+  StaticLoadSample sample;
+  ASSERT_TRUE(simulator.GetLatestSample(&sample));
+  EXPECT_NEAR(sample.load, 300, 10);
+  ASSERT_TRUE(WaitState(&controller, kKeepLoadDone, 2000));
+  KeepLoadStatus status = controller.status();
+  EXPECT_EQ(status.fault, kKeepLoadFaultNone);
+  EXPECT_GT(status.hold_start_ms, 0);
+  EXPECT_GT(status.commands, 0);
+  controller.Stop();
+  /// done is kept by Stop
+  EXPECT_EQ(controller.state(), kKeepLoadDone);
+  std::vector<KeepLoadState> states = listener.states();
+  ASSERT_GE(states.size(), 4u);
+  EXPECT_EQ(states.front(), kKeepLoadApproach);
+  EXPECT_EQ(states[1], kKeepLoadRegulate);
+  EXPECT_EQ(states.back(), kKeepLoadDone);
+  simulator.Close();
+}
+
+TEST(KeepLoadControllerTest, NegativeDirection) {
+  StaticLoadSimulator simulator(SimulatorSampling(),
+                                StaticLoadSimulatorOptions());
+  ASSERT_EQ(simulator.Open(), 0);
+  ASSERT_EQ(simulator.StartSampling(), 0);
+  KeepLoadController controller(&simulator, &simulator,
+                                FastOptions(200, -1));
+  ASSERT_EQ(controller.Start(), 0);
+  ASSERT_TRUE(WaitState(&controller, kKeepLoadHold, 5000));
+  StaticLoadSample sample;
+  ASSERT_TRUE(simulator.GetLatestSample(&sample));
+  EXPECT_NEAR(sample.load, -200, 10);
+  controller.Stop();
+  EXPECT_EQ(controller.state(), kKeepLoadStopped);
+  simulator.Close();
+}
+
+TEST(KeepLoadControllerTest, StopStopsActuator) {
+  StaticLoadSimulator simulator(SimulatorSampling(),
+                                StaticLoadSimulatorOptions());
+  ASSERT_EQ(simulator.Open(), 0);
+  ASSERT_EQ(simulator.StartSampling(), 0);
+  KeepLoadOptions options = FastOptions(1000, 1);
+  options.approach_speed_mm_per_s = 0.01;
+  KeepLoadController controller(&simulator, &simulator, options);
+  ASSERT_EQ(controller.Start(), 0);
+  ASSERT_TRUE(WaitState(&controller, kKeepLoadApproach, 1000));
+  anx::common::sleep_ms(50);
+  EXPECT_TRUE(simulator.running());
+  controller.Stop();
+  EXPECT_EQ(controller.state(), kKeepLoadStopped);
+  EXPECT_FALSE(simulator.running());
+  simulator.Close();
+}
+
+TEST(KeepLoadControllerTest, NoSampleFault) {
+  StaticLoadSimulator simulator(SimulatorSampling(),
+                                StaticLoadSimulatorOptions());
+  ASSERT_EQ(simulator.Open(), 0);
+  KeepLoadOptions options = FastOptions(300, 1);
+  options.sample_timeout_ms = 100;
+  KeepLoadController controller(&simulator, &simulator, options);
+  ASSERT_EQ(controller.Start(), 0);
+  ASSERT_TRUE(WaitState(&controller, kKeepLoadFault, 2000));
+  EXPECT_EQ(controller.status().fault, kKeepLoadFaultNoSample);
+  controller.Stop();
+  EXPECT_EQ(controller.state(), kKeepLoadFault);
+  simulator.Close();
+}
+
+TEST(KeepLoadControllerTest, ActuatorFault) {
+  StaticLoadSimulator simulator(SimulatorSampling(),
+                                StaticLoadSimulatorOptions());
+  ASSERT_EQ(simulator.Open(), 0);
+  ASSERT_EQ(simulator.StartSampling(), 0);
+  /// the samples are delivered, the commands of the closed simulator fail
+  StaticLoadReplayDevice replay(SimulatorSampling(),
+                                std::vector<StaticLoadSample>(1));
+  ASSERT_EQ(replay.Open(), 0);
+  ASSERT_EQ(replay.StartSampling(), 0);
+  simulator.Close();
+  KeepLoadController controller(&replay, &simulator, FastOptions(300, 1));
+  ASSERT_EQ(controller.Start(), 0);
+  ASSERT_TRUE(WaitState(&controller, kKeepLoadFault, 2000));
+  EXPECT_EQ(controller.status().fault, kKeepLoadFaultActuator);
+  controller.Stop();
+  replay.Close();
+}
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
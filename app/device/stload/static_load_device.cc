@@ -0,0 +1,246 @@
+/**
+ * @file static_load_device.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the static load device samples the load frame on its own thread
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/stload/static_load_device.h"
+
+#include <algorithm>
+
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+namespace {
+int64_t NowMicros() {
+  return static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+}
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// clz StaticLoadDevice
+
+StaticLoadDevice::StaticLoadDevice(const StaticLoadOptions& options)
+    : options_(options),
+      delivering_(false),
+      samples_(0),
+      read_failures_(0),
+      overruns_(0) {
+  if (options_.sample_rate_hz <= 0) {
+    options_.sample_rate_hz = kStaticLoadSampleRateHz;
+  }
+  if (options_.batch_size <= 0) {
+    options_.batch_size = 1;
+  }
+}
+
+StaticLoadDevice::~StaticLoadDevice() {
+  StopSampling();
+}
+
+int32_t StaticLoadDevice::StartSampling() {
+  if (thread_ != nullptr) {
+    return -1;
+  }
+  {
+    anx::common::AutoLock lock(&mutex_);
+    stop_ = false;
+  }
+  thread_.reset(new anx::common::Thread(this));
+  thread_->start();
+  return 0;
+}
+
+void StaticLoadDevice::StopSampling() {
+  interrupt();
+  if (thread_ == nullptr) {
+    return;
+  }
+  if (thread_->is_current_thread()) {
+    LOG_F(LG_WARN) << "stop sampling from the sampling thread";
+    return;
+  }
+  thread_->join();
+  thread_.reset();
+}
+
+bool StaticLoadDevice::sampling() {
+  anx::common::AutoLock lock(&mutex_);
+  return thread_ != nullptr && !stop_;
+}
+
+void StaticLoadDevice::AddListener(StaticLoadListener* listener) {
+  anx::common::AutoLock lock(&mutex_);
+  if (std::find(listeners_.begin(), listeners_.end(), listener) ==
+      listeners_.end()) {
+    listeners_.push_back(listener);
+  }
+}
+
+void StaticLoadDevice::RemoveListener(StaticLoadListener* listener) {
+  anx::common::AutoLock lock(&mutex_);
+  listeners_.erase(std::remove(listeners_.begin(), listeners_.end(), listener),
+                   listeners_.end());
+  if (thread_ != nullptr && thread_->is_current_thread()) {
+    return;
+  }
+  while (delivering_) {
+    cond_.wait(&mutex_);
+  }
+}
+
+bool StaticLoadDevice::GetLatestSample(StaticLoadSample* sample) {
+  return latest_.Load(sample);
+}
+
+int64_t StaticLoadDevice::samples() {
+  anx::common::AutoLock lock(&mutex_);
+  return samples_;
+}
+
+int64_t StaticLoadDevice::read_failures() {
+  anx::common::AutoLock lock(&mutex_);
+  return read_failures_;
+}
+
+int64_t StaticLoadDevice::overruns() {
+  anx::common::AutoLock lock(&mutex_);
+  return overruns_;
+}
+
+void StaticLoadDevice::interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  stop_ = true;
+  cond_.broadcast();
+}
+
+bool StaticLoadDevice::is_interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  return stop_;
+}
+
+void StaticLoadDevice::run() {
+  const int64_t period_us = 1000000 / options_.sample_rate_hz;
+  const size_t batch_size = static_cast<size_t>(options_.batch_size);
+  std::vector<StaticLoadSample> batch;
+  batch.reserve(batch_size);
+  int64_t next_us = NowMicros();
+  for (;;) {
+    {
+      anx::common::AutoLock lock(&mutex_);
+      while (!stop_) {
+        int64_t remaining_us = next_us - NowMicros();
+        if (remaining_us < 1000) {
+          break;
+        }
+        cond_.wait(&mutex_, static_cast<unsigned int>(remaining_us / 1000));
+      }
+      if (stop_) {
+        break;
+      }
+    }
+    StaticLoadSample sample;
+    int32_t ret = ReadSample(&sample);
+    int64_t now_us = NowMicros();
+    next_us += period_us;
+    {
+      anx::common::AutoLock lock(&mutex_);
+      if (ret == 0) {
+        sample.time_us = now_us;
+        latest_.Store(sample);
+        samples_++;
+      } else {
+        read_failures_++;
+      }
+      if (next_us <= now_us) {
+        /// skip the missed periods instead of reading back to back
+        int64_t missed = (now_us - next_us) / period_us + 1;
+        overruns_ += missed;
+        next_us += missed * period_us;
+      }
+    }
+    if (ret != 0) {
+      continue;
+    }
+    batch.push_back(sample);
+    if (batch.size() >= batch_size) {
+      Deliver(batch);
+      batch.clear();
+    }
+  }
+  if (!batch.empty()) {
+    Deliver(batch);
+  }
+}
+
+void StaticLoadDevice::Deliver(const std::vector<StaticLoadSample>& batch) {
+  std::vector<StaticLoadListener*> listeners;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    listeners = listeners_;
+    delivering_ = true;
+  }
+  for (auto listener : listeners) {
+    {
+      /// the listener may be removed by the listener called before
+      anx::common::AutoLock lock(&mutex_);
+      if (std::find(listeners_.begin(), listeners_.end(), listener) ==
+          listeners_.end()) {
+        continue;
+      }
+    }
+    listener->OnStaticLoadSamples(this, batch.data(), batch.size());
+  }
+  anx::common::AutoLock lock(&mutex_);
+  delivering_ = false;
+  cond_.broadcast();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// clz StaticLoadReplayDevice
+
+StaticLoadReplayDevice::StaticLoadReplayDevice(
+    const StaticLoadOptions& options,
+    const std::vector<StaticLoadSample>& samples)
+    : StaticLoadDevice(options), samples_(samples), next_(0), opened_(false) {}
+
+StaticLoadReplayDevice::~StaticLoadReplayDevice() {
+  StopSampling();
+}
+
+int32_t StaticLoadReplayDevice::Open() {
+  if (samples_.empty()) {
+    return -1;
+  }
+  StopSampling();
+  next_ = 0;
+  opened_ = true;
+  return 0;
+}
+
+void StaticLoadReplayDevice::Close() {
+  StopSampling();
+  opened_ = false;
+}
+
+int32_t StaticLoadReplayDevice::ReadSample(StaticLoadSample* sample) {
+  if (!opened_) {
+    return -1;
+  }
+  *sample = samples_[next_];
+  next_ = (next_ + 1) % samples_.size();
+  return 0;
+}
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,236 @@
+/**
+ * @file static_load_device.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the static load device samples the load frame on its own thread and
+ * delivers the timestamped samples in batches to the listeners, the sampling
+ * is not paced by the message pump of the window.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_STLOAD_STATIC_LOAD_DEVICE_H_
+#define APP_DEVICE_STLOAD_STATIC_LOAD_DEVICE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "app/common/latest_value.h"
+#include "app/common/thread.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+/// @brief the default sample rate of the static load device
+const int32_t kStaticLoadSampleRateHz = 100;
+/// @brief the default samples of one batch delivered to the listeners
+const int32_t kStaticLoadBatchSize = 10;
+
+/// @brief one sample of the static load device
+struct StaticLoadSample {
+  /// @brief the time the sample is read, @see GetCurrentTimeMicros
+  int64_t time_us = 0;
+  /// @brief load value in N unit
+  double load = 0;
+  /// @brief position value in mm unit
+  double position = 0;
+  /// @brief extension value in mm unit
+  double extension = 0;
+  /// @brief status value of the st load
+  uint32_t status = 0;
+};
+
+struct StaticLoadOptions {
+  /// @brief the samples read per second
+  int32_t sample_rate_hz = kStaticLoadSampleRateHz;
+  /// @brief the samples of one batch, the batch not full is delivered when
+  /// the sampling stops.
+  int32_t batch_size = kStaticLoadBatchSize;
+};
+
+/// @brief the control of the command, the values of CTRL_XXXX
+enum StaticLoadControl {
+  kStaticLoadCtrlLoad = 0,
+  kStaticLoadCtrlExtn = 1,
+  kStaticLoadCtrlPosi = 2,
+};
+
+/// @brief the end condition of the command, the values of END_XXXX of the
+/// version 1 dll
+enum StaticLoadEnd {
+  kStaticLoadEndLoad = 0,
+  kStaticLoadEndExtn = 1,
+  kStaticLoadEndPosi = 2,
+  kStaticLoadEndTime = 3,
+};
+
+/// @brief the status bits of the sample, the values of DSP_XXXX
+const uint32_t kStaticLoadStatusRun = 0x2;
+const uint32_t kStaticLoadStatusCmdEnd = 0x40;
+const uint32_t kStaticLoadStatusLoadCtrl = 0x100;
+const uint32_t kStaticLoadStatusExtnCtrl = 0x200;
+const uint32_t kStaticLoadStatusPosiCtrl = 0x400;
+
+/// @brief the arguments of Carry200
+struct StaticLoadCommand {
+  int32_t control = kStaticLoadCtrlPosi;
+  int32_t end = kStaticLoadEndPosi;
+  /// @brief mm/s for the position and the extension control, N/s for the
+  /// load control
+  double speed = 0;
+  /// @brief the end value, relative mm of END_POSI and END_EXTN, N of
+  /// END_LOAD and s of END_TIME. the sign is the direction of the move.
+  double value = 0;
+  /// @brief DIR_UP 1, DIR_DOWN -1 or DIR_NO 0 for the sign of the value
+  int32_t direction = 0;
+  /// @brief the load kept by the load control with END_TIME
+  double keep_value = 0;
+  /// @brief KP_DEST 0 keeps keep_value, KP_CURR 1 keeps the current load
+  int32_t keep_datum = 1;
+};
+
+////////////////////////////////////////////////////////////
+// clz StaticLoadActuator
+/// @brief the commands of the actuator of the load frame
+class StaticLoadActuator {
+ public:
+  virtual ~StaticLoadActuator() = default;
+
+  /// @brief Run the command, the command running is replaced
+  /// @return 0 if success, negative if failed
+  virtual int32_t Carry200(const StaticLoadCommand& command) = 0;
+  /// @brief Stop the command, the actuator stops
+  virtual void StopRun() = 0;
+  /// @brief Zero the extension, the position, the load and the time of the
+  /// samples at the current state
+  virtual void Tare() = 0;
+};
+
+class StaticLoadDevice;
+
+class StaticLoadListener {
+ public:
+  virtual ~StaticLoadListener() = default;
+
+  /// @brief On the batch of the samples, called on the sampling thread, the
+  /// listener of the window copies what it needs and posts to the window.
+  /// @param device the device
+  /// @param samples the samples in time order
+  /// @param count the count of the samples
+  virtual void OnStaticLoadSamples(StaticLoadDevice* device,
+                                   const StaticLoadSample* samples,
+                                   size_t count) = 0;
+};
+
+////////////////////////////////////////////////////////////
+// clz StaticLoadDevice
+/// @brief the backend implements Open, Close and ReadSample, the sampling
+/// thread reads the samples by the sample rate. the missed periods are
+/// skipped and counted as the overruns.
+class StaticLoadDevice : public anx::common::Runnable {
+ public:
+  explicit StaticLoadDevice(const StaticLoadOptions& options);
+  /// @brief the backend calls StopSampling in its destructor, ReadSample is
+  /// pure virtual here.
+  ~StaticLoadDevice() override;
+
+  StaticLoadDevice(const StaticLoadDevice&) = delete;
+  StaticLoadDevice& operator=(const StaticLoadDevice&) = delete;
+
+ public:
+  /// @brief Open the device
+  /// @return 0 if success, negative if failed
+  virtual int32_t Open() = 0;
+  /// @brief Close the device, the sampling is stopped first
+  virtual void Close() = 0;
+
+  /// @brief Start the sampling thread
+  /// @return 0 if success, -1 if started
+  int32_t StartSampling();
+  /// @brief Stop the sampling thread, the batch not full is delivered
+  void StopSampling();
+  bool sampling();
+
+  /// @brief Add the listener, called from the next batch
+  void AddListener(StaticLoadListener* listener);
+  /// @brief Remove the listener, after it returns the listener is not called
+  /// any more, it may be called from the listener itself.
+  void RemoveListener(StaticLoadListener* listener);
+
+  /// @brief Get the latest sample without the lock, e.g. the window refresh
+  /// @return true if any sample is read
+  bool GetLatestSample(StaticLoadSample* sample);
+
+  const StaticLoadOptions& options() const { return options_; }
+  /// @brief Get the count of the samples read
+  int64_t samples();
+  /// @brief Get the count of the reads failed
+  int64_t read_failures();
+  /// @brief Get the count of the periods skipped for the late reads
+  int64_t overruns();
+
+  void interrupt() override;
+  bool is_interrupt() override;
+
+ protected:
+  /// @brief Read one sample on the sampling thread, the time is filled by the
+  /// caller.
+  /// @return 0 if success, negative if failed, the failed read is skipped
+  virtual int32_t ReadSample(StaticLoadSample* sample) = 0;
+
+  void run() override;
+
+ private:
+  void Deliver(const std::vector<StaticLoadSample>& batch);
+
+ private:
+  StaticLoadOptions options_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  std::vector<StaticLoadListener*> listeners_;
+  /// @brief the listeners of the batch delivering
+  bool delivering_;
+  /// @brief stored by the sampling thread only
+  anx::common::LatestValue<StaticLoadSample> latest_;
+  int64_t samples_;
+  int64_t read_failures_;
+  int64_t overruns_;
+};
+
+////////////////////////////////////////////////////////////
+// clz StaticLoadReplayDevice
+/// @brief the device replays the samples recorded in a loop, the times are of
+/// the replay. e.g. the tests and the platforms without the st load dll.
+class StaticLoadReplayDevice : public StaticLoadDevice {
+ public:
+  StaticLoadReplayDevice(const StaticLoadOptions& options,
+                         const std::vector<StaticLoadSample>& samples);
+  ~StaticLoadReplayDevice() override;
+
+ public:
+  /// @return 0 if success, -1 if no samples
+  int32_t Open() override;
+  void Close() override;
+
+ protected:
+  /// @return 0 if success, -1 if closed
+  int32_t ReadSample(StaticLoadSample* sample) override;
+
+ private:
+  std::vector<StaticLoadSample> samples_;
+  size_t next_;
+  bool opened_;
+};
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_STLOAD_STATIC_LOAD_DEVICE_H_
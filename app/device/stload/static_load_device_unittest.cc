@@ -0,0 +1,157 @@
+/**
+ * @file static_load_device_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the static load device unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/stload/static_load_device.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+namespace {
+class BatchListener : public StaticLoadListener {
+ public:
+  void OnStaticLoadSamples(StaticLoadDevice* device,
+                           const StaticLoadSample* samples,
+                           size_t count) override {
+    anx::common::AutoLock lock(&mutex_);
+    batches_.push_back(count);
+    samples_.insert(samples_.end(), samples, samples + count);
+  }
+  std::vector<size_t> batches() {
+    anx::common::AutoLock lock(&mutex_);
+    return batches_;
+  }
+  std::vector<StaticLoadSample> samples() {
+    anx::common::AutoLock lock(&mutex_);
+    return samples_;
+  }
+
+ private:
+  anx::common::Mutex mutex_;
+  std::vector<size_t> batches_;
+  std::vector<StaticLoadSample> samples_;
+};
+
+/// @brief the listener removes itself from the first batch
+class OnceListener : public StaticLoadListener {
+ public:
+  void OnStaticLoadSamples(StaticLoadDevice* device,
+                           const StaticLoadSample* samples,
+                           size_t count) override {
+    calls_++;
+    device->RemoveListener(this);
+  }
+  std::atomic<int32_t> calls_{0};
+};
+
+std::vector<StaticLoadSample> MakeRamp(int32_t count) {
+  std::vector<StaticLoadSample> samples;
+  for (int32_t i = 0; i < count; i++) {
+    StaticLoadSample sample;
+    sample.load = i * 10.0;
+    sample.position = i * 0.1;
+    samples.push_back(sample);
+  }
+  return samples;
+}
+}  // namespace
+
+TEST(StaticLoadDeviceTest, OpenWithoutSamples) {
+  StaticLoadReplayDevice device(StaticLoadOptions(), {});
+  EXPECT_EQ(device.Open(), -1);
+}
+
+TEST(StaticLoadDeviceTest, SamplesInBatches) {
+  StaticLoadOptions options;
+  options.sample_rate_hz = 500;
+  options.batch_size = 10;
+  StaticLoadReplayDevice device(options, MakeRamp(4));
+  BatchListener listener;
+  device.AddListener(&listener);
+  ASSERT_EQ(device.Open(), 0);
+  ASSERT_EQ(device.StartSampling(), 0);
+  EXPECT_EQ(device.StartSampling(), -1);
+  EXPECT_TRUE(device.sampling());
+  anx::common::sleep_ms(200);
+  device.Close();
+  EXPECT_FALSE(device.sampling());
+
+  std::vector<size_t> batches = listener.batches();
+  std::vector<StaticLoadSample> samples = listener.samples();
+  ASSERT_GE(batches.size(), 2u);
+  for (size_t i = 0; i + 1 < batches.size(); i++) {
+    EXPECT_EQ(batches[i], 10u);
+  }
+  /// the batch not full is delivered on stop
+  EXPECT_LE(batches.back(), 10u);
+  EXPECT_EQ(static_cast<int64_t>(samples.size()), device.samples());
+  EXPECT_GE(samples.size(), 50u);
+  EXPECT_LE(samples.size(), 110u);
+  for (size_t i = 0; i < samples.size(); i++) {
+    EXPECT_DOUBLE_EQ(samples[i].load, (i % 4) * 10.0);
+    if (i > 0) {
+      EXPECT_GE(samples[i].time_us, samples[i - 1].time_us);
+    }
+  }
+  StaticLoadSample latest;
+  ASSERT_TRUE(device.GetLatestSample(&latest));
+  EXPECT_EQ(latest.time_us, samples.back().time_us);
+}
+
+TEST(StaticLoadDeviceTest, RemoveListenerFromListener) {
+  StaticLoadOptions options;
+  options.sample_rate_hz = 1000;
+  options.batch_size = 1;
+  StaticLoadReplayDevice device(options, MakeRamp(2));
+  OnceListener once;
+  BatchListener listener;
+  device.AddListener(&once);
+  device.AddListener(&listener);
+  ASSERT_EQ(device.Open(), 0);
+  ASSERT_EQ(device.StartSampling(), 0);
+  anx::common::sleep_ms(50);
+  device.RemoveListener(&listener);
+  size_t batches = listener.batches().size();
+  anx::common::sleep_ms(20);
+  EXPECT_EQ(listener.batches().size(), batches);
+  device.StopSampling();
+  EXPECT_EQ(once.calls_, 1);
+  EXPECT_GT(batches, 0u);
+}
+
+TEST(StaticLoadDeviceTest, ReadFailuresSkipped) {
+  StaticLoadOptions options;
+  options.sample_rate_hz = 1000;
+  StaticLoadReplayDevice device(options, MakeRamp(2));
+  BatchListener listener;
+  device.AddListener(&listener);
+  /// not opened, every read fails
+  ASSERT_EQ(device.StartSampling(), 0);
+  anx::common::sleep_ms(50);
+  device.StopSampling();
+  EXPECT_GT(device.read_failures(), 0);
+  EXPECT_EQ(device.samples(), 0);
+  EXPECT_TRUE(listener.batches().empty());
+  StaticLoadSample latest;
+  EXPECT_FALSE(device.GetLatestSample(&latest));
+}
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,104 @@
+/**
+ * @file static_load_dll_device.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the static load device of the st load dll
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/stload/static_load_dll_device.h"
+
+#include "app/common/logger.h"
+#include "app/device/stload/stload_helper.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+StaticLoadDllDevice::StaticLoadDllDevice(const StaticLoadOptions& options)
+    : StaticLoadDevice(options), opened_(false) {}
+
+StaticLoadDllDevice::~StaticLoadDllDevice() {
+  StopSampling();
+}
+
+int32_t StaticLoadDllDevice::Open() {
+  const stload_api& api = STLoadHelper::st_load_loader_.st_api_;
+  if (STLoadLoader::handle_ == nullptr || api.before_get_sample == nullptr ||
+      api.get_load == nullptr || api.after_get_sample == nullptr) {
+    LOG_F(LG_ERROR) << "st load dll is not loaded";
+    return -1;
+  }
+  opened_ = true;
+  return 0;
+}
+
+void StaticLoadDllDevice::Close() {
+  StopSampling();
+  opened_ = false;
+}
+
+int32_t StaticLoadDllDevice::Carry200(const StaticLoadCommand& command) {
+  if (!opened_) {
+    return -1;
+  }
+  const stload_api& api = STLoadHelper::st_load_loader_.st_api_;
+  anx::common::AutoLock lock(&api_mutex_);
+  if (api.carry_200 == nullptr ||
+      !api.carry_200(command.control, command.end,
+                     static_cast<float>(command.speed),
+                     static_cast<float>(command.value), 0, true,
+                     command.direction, static_cast<float>(command.keep_value),
+                     command.keep_datum, 0)) {
+    LOG_F(LG_ERROR) << "carry_200 error";
+    return -2;
+  }
+  return 0;
+}
+
+void StaticLoadDllDevice::StopRun() {
+  const stload_api& api = STLoadHelper::st_load_loader_.st_api_;
+  anx::common::AutoLock lock(&api_mutex_);
+  if (api.stop_run != nullptr) {
+    api.stop_run();
+  }
+}
+
+void StaticLoadDllDevice::Tare() {
+  const stload_api& api = STLoadHelper::st_load_loader_.st_api_;
+  anx::common::AutoLock lock(&api_mutex_);
+  if (api.tare_ext1 != nullptr) {
+    api.tare_ext1();
+  }
+  if (api.tare_posi != nullptr) {
+    api.tare_posi();
+  }
+  if (api.tare_load != nullptr) {
+    api.tare_load();
+  }
+  if (api.tare_time != nullptr) {
+    api.tare_time();
+  }
+}
+
+int32_t StaticLoadDllDevice::ReadSample(StaticLoadSample* sample) {
+  if (!opened_) {
+    return -1;
+  }
+  const stload_api& api = STLoadHelper::st_load_loader_.st_api_;
+  anx::common::AutoLock lock(&api_mutex_);
+  api.before_get_sample();
+  sample->load = api.get_load();
+  sample->position = api.get_posi();
+  sample->extension = api.get_extn();
+  sample->status = api.get_test_status();
+  api.after_get_sample();
+  return 0;
+}
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
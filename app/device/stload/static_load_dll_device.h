@@ -0,0 +1,60 @@
+/**
+ * @file static_load_dll_device.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the static load device of the st load dll, the samples are read by
+ * the sampling thread instead of the DLLMSG of the window.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_STLOAD_STATIC_LOAD_DLL_DEVICE_H_
+#define APP_DEVICE_STLOAD_STATIC_LOAD_DLL_DEVICE_H_
+
+#include <atomic>
+
+#include "app/common/thread.h"
+#include "app/device/stload/static_load_device.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+////////////////////////////////////////////////////////////
+// clz StaticLoadDllDevice
+/// @brief the dll is loaded and set online by STLoadHelper, the device reads
+/// the samples and runs the commands. the samples are read on the sampling
+/// thread and the commands come from the keep load thread and the window, the
+/// dll calls of all the threads are serialized by the device.
+class StaticLoadDllDevice : public StaticLoadDevice, public StaticLoadActuator {
+ public:
+  explicit StaticLoadDllDevice(const StaticLoadOptions& options);
+  ~StaticLoadDllDevice() override;
+
+ public:
+  /// @return 0 if success, -1 if the dll is not loaded
+  int32_t Open() override;
+  void Close() override;
+
+  /// @return 0 if success, -1 if closed, -2 if the dll failed
+  int32_t Carry200(const StaticLoadCommand& command) override;
+  void StopRun() override;
+  void Tare() override;
+
+ protected:
+  /// @return 0 if success, -1 if closed
+  int32_t ReadSample(StaticLoadSample* sample) override;
+
+ private:
+  std::atomic<bool> opened_;
+  /// @brief the dll is not thread safe, held across every dll call
+  anx::common::Mutex api_mutex_;
+};
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_STLOAD_STATIC_LOAD_DLL_DEVICE_H_
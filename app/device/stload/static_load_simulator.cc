@@ -0,0 +1,278 @@
+/**
+ * @file static_load_simulator.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the simulator of the static load frame
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/stload/static_load_simulator.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+namespace {
+double Clamp(double value, double limit) {
+  return std::max(-limit, std::min(limit, value));
+}
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// clz StaticLoadModel
+
+StaticLoadModel::StaticLoadModel(const StaticLoadSimulatorOptions& options)
+    : options_(options),
+      stiffness_(options.specimen_stiffness_n_per_mm *
+                 options.frame_stiffness_n_per_mm /
+                 (options.specimen_stiffness_n_per_mm +
+                  options.frame_stiffness_n_per_mm)),
+      running_(false),
+      command_end_(false),
+      position_(0),
+      velocity_(0),
+      elapsed_s_(0),
+      start_position_(0),
+      start_extension_(0),
+      load_setpoint_(0),
+      tare_load_(0),
+      tare_position_(0),
+      tare_extension_(0),
+      random_(options.seed),
+      noise_(0, options.load_noise_n > 0 ? options.load_noise_n : 1) {}
+
+StaticLoadModel::~StaticLoadModel() {}
+
+int32_t StaticLoadModel::Carry(const StaticLoadCommand& command) {
+  if (command.control < kStaticLoadCtrlLoad ||
+      command.control > kStaticLoadCtrlPosi ||
+      command.end < kStaticLoadEndLoad || command.end > kStaticLoadEndTime ||
+      command.speed < 0) {
+    return -1;
+  }
+  command_ = command;
+  running_ = true;
+  command_end_ = false;
+  elapsed_s_ = 0;
+  start_position_ = position_;
+  start_extension_ = extension();
+  load_setpoint_ = load();
+  if (command_.control == kStaticLoadCtrlLoad &&
+      command_.end == kStaticLoadEndTime && command_.keep_datum == 0) {
+    load_setpoint_ = command_.keep_value;
+  }
+  return 0;
+}
+
+void StaticLoadModel::Stop() {
+  running_ = false;
+}
+
+void StaticLoadModel::Tare() {
+  tare_load_ = load();
+  tare_position_ = position_;
+  tare_extension_ = extension();
+}
+
+void StaticLoadModel::Step(double dt_s) {
+  while (dt_s > 0) {
+    double step_s = std::min(dt_s, kStaticLoadModelStepS);
+    Integrate(step_s);
+    dt_s -= step_s;
+  }
+}
+
+StaticLoadSample StaticLoadModel::Sample() {
+  StaticLoadSample sample;
+  sample.load = load() - tare_load_;
+  if (options_.load_noise_n > 0) {
+    sample.load += noise_(random_);
+  }
+  sample.position = position_ - tare_position_;
+  sample.extension = extension() - tare_extension_;
+  if (running_) {
+    sample.status |= kStaticLoadStatusRun;
+  }
+  if (command_end_) {
+    sample.status |= kStaticLoadStatusCmdEnd;
+  }
+  if (command_.control == kStaticLoadCtrlLoad) {
+    sample.status |= kStaticLoadStatusLoadCtrl;
+  } else if (command_.control == kStaticLoadCtrlExtn) {
+    sample.status |= kStaticLoadStatusExtnCtrl;
+  } else {
+    sample.status |= kStaticLoadStatusPosiCtrl;
+  }
+  return sample;
+}
+
+double StaticLoadModel::load() const {
+  return stiffness_ * position_ +
+         options_.specimen_damping_n_s_per_mm * velocity_;
+}
+
+double StaticLoadModel::extension() const {
+  return stiffness_ * position_ / options_.specimen_stiffness_n_per_mm;
+}
+
+void StaticLoadModel::Integrate(double dt_s) {
+  double command_velocity = CommandVelocity(dt_s);
+  velocity_ += Clamp(command_velocity - velocity_,
+                     options_.max_accel_mm_per_s2 * dt_s);
+  position_ += velocity_ * dt_s;
+  if (!running_) {
+    return;
+  }
+  elapsed_s_ += dt_s;
+  if (EndReached()) {
+    running_ = false;
+    command_end_ = true;
+  }
+}
+
+double StaticLoadModel::CommandVelocity(double dt_s) {
+  if (!running_) {
+    return 0;
+  }
+  double velocity = 0;
+  if (command_.control == kStaticLoadCtrlPosi) {
+    velocity = Direction() * command_.speed;
+  } else if (command_.control == kStaticLoadCtrlExtn) {
+    /// the extension is the part of the move on the specimen
+    velocity = Direction() * command_.speed *
+               options_.specimen_stiffness_n_per_mm / stiffness_;
+  } else {
+    if (command_.end != kStaticLoadEndTime) {
+      /// the setpoint ramps to the target by the speed
+      double error = command_.value - load_setpoint_;
+      load_setpoint_ += command_.speed > 0
+                            ? Clamp(error, command_.speed * dt_s)
+                            : error;
+    }
+    velocity =
+        options_.load_gain_per_s * (load_setpoint_ - load()) / stiffness_;
+  }
+  return Clamp(velocity, options_.max_speed_mm_per_s);
+}
+
+bool StaticLoadModel::EndReached() const {
+  switch (command_.end) {
+    case kStaticLoadEndTime:
+      return elapsed_s_ >= fabs(command_.value);
+    case kStaticLoadEndPosi:
+      return Direction() * (position_ - start_position_) >=
+             fabs(command_.value);
+    case kStaticLoadEndExtn:
+      return Direction() * (extension() - start_extension_) >=
+             fabs(command_.value);
+    default:
+      break;
+  }
+  if (command_.control == kStaticLoadCtrlLoad) {
+    /// the load settled, the damping part is gone when the actuator stops
+    return load_setpoint_ == command_.value &&
+           fabs(stiffness_ * position_ - command_.value) <=
+               options_.load_tolerance_n;
+  }
+  return Direction() * load() >= fabs(command_.value);
+}
+
+double StaticLoadModel::Direction() const {
+  if (command_.direction != 0) {
+    return command_.direction > 0 ? 1 : -1;
+  }
+  return command_.value < 0 ? -1 : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// clz StaticLoadSimulator
+
+StaticLoadSimulator::StaticLoadSimulator(
+    const StaticLoadOptions& options,
+    const StaticLoadSimulatorOptions& simulator_options)
+    : StaticLoadDevice(options),
+      simulator_options_(simulator_options),
+      model_(simulator_options),
+      opened_(false),
+      last_us_(0) {}
+
+StaticLoadSimulator::~StaticLoadSimulator() {
+  StopSampling();
+}
+
+int32_t StaticLoadSimulator::Open() {
+  anx::common::AutoLock lock(&mutex_);
+  model_ = StaticLoadModel(simulator_options_);
+  opened_ = true;
+  last_us_ = static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+  return 0;
+}
+
+void StaticLoadSimulator::Close() {
+  StopSampling();
+  anx::common::AutoLock lock(&mutex_);
+  opened_ = false;
+}
+
+int32_t StaticLoadSimulator::Carry200(const StaticLoadCommand& command) {
+  anx::common::AutoLock lock(&mutex_);
+  if (!opened_) {
+    return -2;
+  }
+  StepToNow();
+  return model_.Carry(command);
+}
+
+void StaticLoadSimulator::StopRun() {
+  anx::common::AutoLock lock(&mutex_);
+  if (!opened_) {
+    return;
+  }
+  StepToNow();
+  model_.Stop();
+}
+
+void StaticLoadSimulator::Tare() {
+  anx::common::AutoLock lock(&mutex_);
+  if (!opened_) {
+    return;
+  }
+  StepToNow();
+  model_.Tare();
+}
+
+bool StaticLoadSimulator::running() {
+  anx::common::AutoLock lock(&mutex_);
+  return model_.running();
+}
+
+int32_t StaticLoadSimulator::ReadSample(StaticLoadSample* sample) {
+  anx::common::AutoLock lock(&mutex_);
+  if (!opened_) {
+    return -1;
+  }
+  StepToNow();
+  *sample = model_.Sample();
+  return 0;
+}
+
+void StaticLoadSimulator::StepToNow() {
+  int64_t now_us = static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+  if (now_us > last_us_) {
+    model_.Step((now_us - last_us_) / 1000000.0);
+  }
+  last_us_ = now_us;
+}
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
@@ -0,0 +1,159 @@
+/**
+ * @file static_load_simulator.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the simulator of the static load frame, the specimen is a spring
+ * and damper in series with the frame, the actuator is limited by its speed
+ * and acceleration and runs the commands of Carry200.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_DEVICE_STLOAD_STATIC_LOAD_SIMULATOR_H_
+#define APP_DEVICE_STLOAD_STATIC_LOAD_SIMULATOR_H_
+
+#include <stdint.h>
+
+#include <random>
+
+#include "app/common/thread.h"
+#include "app/device/stload/static_load_device.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+/// @brief the max time of one integration step of the model
+const double kStaticLoadModelStepS = 0.0005;
+
+struct StaticLoadSimulatorOptions {
+  /// @brief the stiffness of the specimen
+  double specimen_stiffness_n_per_mm = 2000;
+  /// @brief the damping of the specimen
+  double specimen_damping_n_s_per_mm = 20;
+  /// @brief the stiffness of the frame in series with the specimen
+  double frame_stiffness_n_per_mm = 50000;
+  /// @brief the max speed of the actuator, 300 mm/min
+  double max_speed_mm_per_s = 5;
+  /// @brief the max acceleration of the actuator
+  double max_accel_mm_per_s2 = 50;
+  /// @brief the gain of the load control, the load error is closed in about
+  /// 1 / gain seconds.
+  double load_gain_per_s = 20;
+  /// @brief the tolerance of the load control reaching the target
+  double load_tolerance_n = 1;
+  /// @brief the standard deviation of the noise of the load, 0 for none
+  double load_noise_n = 0;
+  /// @brief the seed of the noise, the runs with the same seed are the same
+  uint32_t seed = 1;
+};
+
+////////////////////////////////////////////////////////////
+// clz StaticLoadModel
+/// @brief the model stepped by the time, not thread safe. the load is
+/// positive for the move of the positive direction.
+class StaticLoadModel {
+ public:
+  explicit StaticLoadModel(const StaticLoadSimulatorOptions& options);
+  ~StaticLoadModel();
+
+ public:
+  /// @brief Run the command from the current state
+  /// @return 0 if success, -1 if the command is invalid
+  int32_t Carry(const StaticLoadCommand& command);
+  /// @brief Stop the command, the actuator decelerates to stop
+  void Stop();
+  /// @brief Zero the load, the position and the extension of the samples at
+  /// the current state, the state of the model is kept
+  void Tare();
+  /// @brief Step the model by the time, split into kStaticLoadModelStepS
+  void Step(double dt_s);
+
+  /// @brief Get the sample of the current state less the tare, the time is
+  /// not set
+  StaticLoadSample Sample();
+
+  double position() const { return position_; }
+  double velocity() const { return velocity_; }
+  /// @brief Get the load without the noise
+  double load() const;
+  double extension() const;
+  bool running() const { return running_; }
+  /// @brief Get the time run of the command
+  double elapsed_s() const { return elapsed_s_; }
+
+ private:
+  void Integrate(double dt_s);
+  double CommandVelocity(double dt_s);
+  bool EndReached() const;
+  double Direction() const;
+
+ private:
+  StaticLoadSimulatorOptions options_;
+  /// @brief the stiffness of the specimen and the frame in series
+  double stiffness_;
+  StaticLoadCommand command_;
+  bool running_;
+  bool command_end_;
+  double position_;
+  double velocity_;
+  double elapsed_s_;
+  double start_position_;
+  double start_extension_;
+  /// @brief the load setpoint of the load control
+  double load_setpoint_;
+  /// @brief the tare of the samples
+  double tare_load_;
+  double tare_position_;
+  double tare_extension_;
+  std::mt19937 random_;
+  std::normal_distribution<double> noise_;
+};
+
+////////////////////////////////////////////////////////////
+// clz StaticLoadSimulator
+/// @brief the static load device of the model, the model is stepped by the
+/// time between the samples.
+class StaticLoadSimulator : public StaticLoadDevice,
+                            public StaticLoadActuator {
+ public:
+  StaticLoadSimulator(const StaticLoadOptions& options,
+                      const StaticLoadSimulatorOptions& simulator_options);
+  ~StaticLoadSimulator() override;
+
+ public:
+  /// @brief Reset the model, the actuator is at 0 and the load is 0
+  int32_t Open() override;
+  void Close() override;
+
+  /// @brief Run the command, @see StaticLoadModel::Carry
+  /// @return 0 if success, -1 if the command is invalid, -2 if closed
+  int32_t Carry200(const StaticLoadCommand& command) override;
+  void StopRun() override;
+  void Tare() override;
+  /// @brief Check the command is running
+  bool running();
+
+ protected:
+  /// @return 0 if success, -1 if closed
+  int32_t ReadSample(StaticLoadSample* sample) override;
+
+ private:
+  /// @brief Step the model to now, called with the mutex locked
+  void StepToNow();
+
+ private:
+  StaticLoadSimulatorOptions simulator_options_;
+  anx::common::Mutex mutex_;
+  StaticLoadModel model_;
+  bool opened_;
+  int64_t last_us_;
+};
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
+
+#endif  // APP_DEVICE_STLOAD_STATIC_LOAD_SIMULATOR_H_
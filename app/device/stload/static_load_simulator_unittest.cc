@@ -0,0 +1,245 @@
+/**
+ * @file static_load_simulator_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the simulator of the static load frame unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/device/stload/static_load_simulator.h"
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/common/time_utils.h"
+
+namespace anx {
+namespace device {
+namespace stload {
+
+namespace {
+const double kTickS = 0.001;
+
+/// @brief Step the model until the command ends
+/// @return the time stepped
+double RunToEnd(StaticLoadModel* model, double timeout_s) {
+  double time_s = 0;
+  while (model->running() && time_s < timeout_s) {
+    model->Step(kTickS);
+    time_s += kTickS;
+  }
+  return time_s;
+}
+
+class SampleListener : public StaticLoadListener {
+ public:
+  void OnStaticLoadSamples(StaticLoadDevice* device,
+                           const StaticLoadSample* samples,
+                           size_t count) override {
+    anx::common::AutoLock lock(&mutex_);
+    samples_.insert(samples_.end(), samples, samples + count);
+  }
+  std::vector<StaticLoadSample> samples() {
+    anx::common::AutoLock lock(&mutex_);
+    return samples_;
+  }
+
+ private:
+  anx::common::Mutex mutex_;
+  std::vector<StaticLoadSample> samples_;
+};
+}  // namespace
+
+TEST(StaticLoadModelTest, InvalidCommand) {
+  StaticLoadModel model((StaticLoadSimulatorOptions()));
+  StaticLoadCommand command;
+  command.control = 3;
+  EXPECT_EQ(model.Carry(command), -1);
+  command.control = kStaticLoadCtrlPosi;
+  command.speed = -1;
+  EXPECT_EQ(model.Carry(command), -1);
+  EXPECT_FALSE(model.running());
+}
+
+TEST(StaticLoadModelTest, PositionControlSpeedLimited) {
+  StaticLoadSimulatorOptions options;
+  StaticLoadModel model(options);
+  StaticLoadCommand command;
+  command.control = kStaticLoadCtrlPosi;
+  command.end = kStaticLoadEndPosi;
+  command.speed = 10;
+  command.value = 2;
+  ASSERT_EQ(model.Carry(command), 0);
+  double max_velocity = 0;
+  double time_s = 0;
+  while (model.running() && time_s < 5) {
+    model.Step(kTickS);
+    time_s += kTickS;
+    max_velocity = std::max(max_velocity, fabs(model.velocity()));
+  }
+  EXPECT_FALSE(model.running());
+  EXPECT_LE(max_velocity, options.max_speed_mm_per_s + 1e-9);
+  /// 2 mm at 5 mm/s with the acceleration of 0.1 s
+  EXPECT_GE(time_s, 0.4);
+  EXPECT_LE(time_s, 0.6);
+  EXPECT_NE(model.Sample().status & kStaticLoadStatusCmdEnd, 0u);
+  model.Step(1);
+  EXPECT_EQ(model.velocity(), 0);
+  EXPECT_GE(model.position(), 2);
+  /// the overshoot of the deceleration
+  EXPECT_LE(model.position(), 2.3);
+  EXPECT_NEAR(model.load(),
+              model.position() * options.specimen_stiffness_n_per_mm *
+                  options.frame_stiffness_n_per_mm /
+                  (options.specimen_stiffness_n_per_mm +
+                   options.frame_stiffness_n_per_mm),
+              1e-6);
+  EXPECT_LT(model.extension(), model.position());
+}
+
+TEST(StaticLoadModelTest, PositionControlToLoad) {
+  StaticLoadModel model((StaticLoadSimulatorOptions()));
+  StaticLoadCommand command;
+  command.control = kStaticLoadCtrlPosi;
+  command.end = kStaticLoadEndLoad;
+  command.speed = 2.0 / 60.0;
+  command.value = -50;
+  ASSERT_EQ(model.Carry(command), 0);
+  RunToEnd(&model, 10);
+  EXPECT_FALSE(model.running());
+  EXPECT_LE(model.load(), -50);
+  EXPECT_GE(model.load(), -52);
+  EXPECT_LT(model.position(), 0);
+}
+
+TEST(StaticLoadModelTest, TareZeroesSamples) {
+  StaticLoadSimulatorOptions options;
+  options.load_noise_n = 0;
+  StaticLoadModel model(options);
+  StaticLoadCommand command;
+  command.control = kStaticLoadCtrlPosi;
+  command.end = kStaticLoadEndLoad;
+  command.speed = 2.0 / 60.0;
+  command.value = -50;
+  ASSERT_EQ(model.Carry(command), 0);
+  RunToEnd(&model, 10);
+  /// the actuator is at rest
+  model.Step(1);
+  StaticLoadSample sample = model.Sample();
+  EXPECT_LT(sample.load, -49);
+  model.Tare();
+  sample = model.Sample();
+  EXPECT_NEAR(sample.load, 0, 1e-9);
+  EXPECT_NEAR(sample.position, 0, 1e-9);
+  EXPECT_NEAR(sample.extension, 0, 1e-9);
+  /// the state of the model is kept
+  EXPECT_LT(model.load(), -49);
+}
+
+TEST(StaticLoadModelTest, LoadControlReachesTarget) {
+  StaticLoadSimulatorOptions options;
+  StaticLoadModel model(options);
+  StaticLoadCommand command;
+  command.control = kStaticLoadCtrlLoad;
+  command.end = kStaticLoadEndLoad;
+  command.speed = 1000;
+  command.value = 500;
+  ASSERT_EQ(model.Carry(command), 0);
+  double time_s = RunToEnd(&model, 5);
+  EXPECT_FALSE(model.running());
+  /// the setpoint ramps by the speed
+  EXPECT_GE(time_s, 0.5);
+  EXPECT_NEAR(model.load(), 500, options.load_tolerance_n);
+}
+
+TEST(StaticLoadModelTest, KeepLoad) {
+  StaticLoadSimulatorOptions options;
+  StaticLoadModel model(options);
+  StaticLoadCommand command;
+  command.control = kStaticLoadCtrlPosi;
+  command.end = kStaticLoadEndLoad;
+  command.speed = 1;
+  command.value = 300;
+  ASSERT_EQ(model.Carry(command), 0);
+  RunToEnd(&model, 10);
+  model.Step(0.5);
+  double kept = model.load();
+
+  /// keep the current load for 2 s, e.g. the keep load button
+  command.control = kStaticLoadCtrlLoad;
+  command.end = kStaticLoadEndTime;
+  command.value = 2;
+  command.keep_datum = 1;
+  ASSERT_EQ(model.Carry(command), 0);
+  double time_s = 0;
+  while (model.running() && time_s < 5) {
+    model.Step(kTickS);
+    time_s += kTickS;
+    ASSERT_NEAR(model.load(), kept, options.load_tolerance_n);
+  }
+  EXPECT_NEAR(time_s, 2, 2 * kTickS);
+
+  /// keep the load given
+  command.keep_datum = 0;
+  command.keep_value = 200;
+  ASSERT_EQ(model.Carry(command), 0);
+  RunToEnd(&model, 5);
+  EXPECT_NEAR(model.load(), 200, options.load_tolerance_n);
+}
+
+TEST(StaticLoadModelTest, NoiseBySeed) {
+  StaticLoadSimulatorOptions options;
+  options.load_noise_n = 0.5;
+  StaticLoadModel model1(options);
+  StaticLoadModel model2(options);
+  double sum = 0;
+  for (int32_t i = 0; i < 100; i++) {
+    StaticLoadSample sample = model1.Sample();
+    EXPECT_EQ(sample.load, model2.Sample().load);
+    sum += fabs(sample.load);
+  }
+  EXPECT_GT(sum, 0);
+  EXPECT_LT(sum / 100, 2);
+}
+
+TEST(StaticLoadSimulatorTest, SamplesAtRate) {
+  StaticLoadOptions options;
+  options.sample_rate_hz = 1000;
+  options.batch_size = 50;
+  StaticLoadSimulator simulator(options, StaticLoadSimulatorOptions());
+  SampleListener listener;
+  simulator.AddListener(&listener);
+  StaticLoadCommand command;
+  command.speed = 5;
+  command.value = 100;
+  EXPECT_EQ(simulator.Carry200(command), -2);
+  ASSERT_EQ(simulator.Open(), 0);
+  ASSERT_EQ(simulator.StartSampling(), 0);
+  ASSERT_EQ(simulator.Carry200(command), 0);
+  anx::common::sleep_ms(300);
+  EXPECT_TRUE(simulator.running());
+  simulator.StopRun();
+  EXPECT_FALSE(simulator.running());
+  simulator.Close();
+
+  std::vector<StaticLoadSample> samples = listener.samples();
+  EXPECT_GE(samples.size(), 200u);
+  EXPECT_LE(samples.size(), 320u);
+  for (size_t i = 1; i < samples.size(); i++) {
+    EXPECT_GE(samples[i].position, samples[i - 1].position);
+  }
+  ASSERT_FALSE(samples.empty());
+  EXPECT_GT(samples.back().position, 0.5);
+  EXPECT_LT(samples.back().position, 5 * 0.35);
+}
+
+}  // namespace stload
+}  // namespace device
+}  // namespace anx
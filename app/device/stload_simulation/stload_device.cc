@@ -20,6 +20,7 @@
 #include "app/common/thread.h"
 #include "app/device/device_com_factory.h"
 #include "app/device/device_com_settings.h"
+#include "app/device/stload/static_load_simulator.h"
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -35,7 +36,6 @@ pthread_t g_thread;
 #endif
 
 std::unique_ptr<anx::common::Mutex> g_mutex;
-std::unique_ptr<anx::common::Thread> g_thread;
 std::shared_ptr<anx::device::DeviceComInterface> g_device_com_sl_;
 
 #if 0
@@ -45,40 +45,28 @@ static int32_t LOG_LEVEL = LG_SENSITIVE;
 #endif
 
 namespace {
-class Worker : public anx::common::Runnable {
+/// @brief post the sample message to the dest window for the batch
+class SampleNotifier : public anx::device::stload::StaticLoadListener {
  public:
-  Worker() {}
-  ~Worker() override {}
-
-  void run() override {
-    while (true) {
-      anx::common::AutoLock lock(&mutex_);
-      printf("Worker\n");
+  void OnStaticLoadSamples(anx::device::stload::StaticLoadDevice* device,
+                           const anx::device::stload::StaticLoadSample* samples,
+                           size_t count) override {
 #if defined(_WIN32)
-      if (g_dest_wnd != nullptr) {
-        // Send message to dest window
-        PostMessage(g_dest_wnd, DLLMSG, 0, DLL_SAMPLE);
-      }
-      // Sleep 40ms
-      Sleep(40);
-#else
-      // unimplemented
-      // Sleep 40ms
-      usleep(40 * 1000);
-#endif
-      // check if thread should be stopped
-      if (is_interrupt()) {
-        break;
-      }
+    if (g_dest_wnd != nullptr) {
+      // Send message to dest window
+      PostMessage(g_dest_wnd, DLLMSG, 0, DLL_SAMPLE);
     }
+#endif
   }
-
- private:
-  anx::common::Mutex mutex_;
 };
-}  // namespace
 
-std::unique_ptr<Worker> g_worker;
+SampleNotifier g_notifier;
+/// @brief the simulator of the load frame, the samples are read at the rate
+/// of OnLine.
+std::unique_ptr<anx::device::stload::StaticLoadSimulator> g_simulator;
+/// @brief the sample of BeforeGetSample read by the getters
+anx::device::stload::StaticLoadSample g_sample;
+}  // namespace
 
 BOOL CALL SetDestWnd(HWND dest_wnd) {
   g_dest_wnd = dest_wnd;
@@ -156,23 +144,32 @@ BOOL CALL OnLine(long channelNo,  // NOLINT
                  int dataBlockSize,
                  BOOL isAE) {
   LOG_F(LOG_LEVEL) << "OnLine";
-  if (g_thread.get() != nullptr) {
+  if (g_simulator.get() != nullptr) {
     return FALSE;
   }
-  g_worker.reset(new Worker());
-  g_thread.reset(new anx::common::Thread(g_worker.get()));
-  g_thread->start();
+  anx::device::stload::StaticLoadOptions options;
+  if (rate > 0) {
+    options.sample_rate_hz = rate;
+  }
+  /// one sample message per batch like the 40 ms of the dll
+  options.batch_size = options.sample_rate_hz / 25 > 0
+                           ? options.sample_rate_hz / 25
+                           : 1;
+  g_simulator.reset(new anx::device::stload::StaticLoadSimulator(
+      options, anx::device::stload::StaticLoadSimulatorOptions()));
+  g_simulator->AddListener(&g_notifier);
+  g_simulator->Open();
+  g_simulator->StartSampling();
   return TRUE;
 }
 
 BOOL CALL OffLine() {
   LOG_F(LOG_LEVEL) << "OffLine";
-  if (g_thread.get() == nullptr) {
+  if (g_simulator.get() == nullptr) {
     return FALSE;
   }
-  g_worker->interrupt();
-  g_thread->join();
-  g_thread.reset();
+  g_simulator->Close();
+  g_simulator.reset();
   return TRUE;
 }
 
@@ -188,7 +185,18 @@ BOOL CALL Carry200(long control,  // NOLINT
                    long TestModle   // NOLINT /* 0* */
 ) {                                 // NOLINT
   LOG_F(LOG_LEVEL) << "Carry200";
-  return TRUE;
+  if (g_simulator.get() == nullptr) {
+    return FALSE;
+  }
+  anx::device::stload::StaticLoadCommand command;
+  command.control = control;
+  command.end = end;
+  command.speed = speed;
+  command.value = value;
+  command.direction = dir;
+  command.keep_value = keepvalue;
+  command.keep_datum = keepdatum;
+  return g_simulator->Carry200(command) == 0 ? TRUE : FALSE;
 }
 
 BOOL CALL Carry210(long lOpen) {  // NOLINT
@@ -198,11 +206,18 @@ BOOL CALL Carry210(long lOpen) {  // NOLINT
 
 BOOL CALL StopRun() {
   LOG_F(LOG_LEVEL) << "StopRun";
+  if (g_simulator.get() != nullptr) {
+    g_simulator->StopRun();
+  }
   return TRUE;
 }
 
 BOOL CALL BeforeGetSample() {
   LOG_F(LOG_LEVEL) << "BeforeGetSample";
+  if (g_simulator.get() == nullptr ||
+      !g_simulator->GetLatestSample(&g_sample)) {
+    g_sample = anx::device::stload::StaticLoadSample();
+  }
   return TRUE;
 }
 
@@ -223,17 +238,17 @@ BOOL CALL SetResolve(long channel,  // NOLINT
 
 double CALL GetLoad() {
   LOG_F(LOG_LEVEL) << "GetLoad";
-  return 0.0;
+  return g_sample.load;
 }
 
 double CALL GetPosi() {
   LOG_F(LOG_LEVEL) << "GetPosi";
-  return 0.0;
+  return g_sample.position;
 }
 
 double CALL GetExtn() {
   LOG_F(LOG_LEVEL) << "GetExtn";
-  return 0.0;
+  return g_sample.extension;
 }
 
 double CALL GetExt1() {
@@ -248,7 +263,7 @@ double CALL GetTestTime() {
 
 DWORD CALL GetTestStatus() {
   LOG_F(LOG_LEVEL) << "GetTestStatus";
-  return 0;
+  return g_sample.status;
 }
 
 BOOL CALL TareLoad() {
@@ -13,16 +13,189 @@
 
 #include <iostream>
 
-#include "app/common/crc16.h"
 #include "app/common/logger.h"
 #include "app/common/time_utils.h"
+#include "app/device/modbus_register_map.h"
+#include "app/device/modbus_rtu.h"
 
 namespace anx {
 namespace device {
 
+namespace {
+/// @brief the max wait time of the response frame
+const int32_t kUltraResponseTimeoutMs = 100;
+/// @brief the station of the generator
+const uint8_t kUltraStation = 0x01;
+
+/// @brief the register map of the generator
+/// the coil starts and stops the ultrasonic
+typedef ModbusRegister<kModbusCoil, 0x0002, bool, kModbusWrite, bool>
+    UltraSwitch;
+typedef ModbusRegister<kModbusInputRegister, 0x0000, int32_t>
+    UltraCurrentPower;
+typedef ModbusRegister<kModbusInputRegister, 0x0001, int32_t> UltraCurrentFreq;
+typedef ModbusRegister<kModbusInputRegister, 0x0002, int32_t> UltraFaultCode;
+typedef ModbusRegister<kModbusHoldingRegister, 0x0000, int32_t>
+    UltraFreqAtMachineOn;
+typedef ModbusRegister<kModbusHoldingRegister, 0x0001, int32_t>
+    UltraSoftTimeAtMachineOn;
+typedef ModbusRegister<kModbusHoldingRegister, 0x0002, int32_t> UltraMaxPower;
+typedef ModbusRegister<kModbusHoldingRegister, 0x0003, int32_t> UltraMaxFreq;
+typedef ModbusRegister<kModbusHoldingRegister, 0x0004, int32_t> UltraMinFreq;
+typedef ModbusRegister<kModbusHoldingRegister,
+                       0x0018,
+                       int32_t,
+                       kModbusReadWrite>
+    UltraAmplitude;
+typedef ModbusRegister<kModbusHoldingRegister,
+                       0x0019,
+                       int32_t,
+                       kModbusReadWrite>
+    UltraWedingTime;
+
+/// the frames of the generator manual
+static_assert(UltraSwitch::WriteRequest(kUltraStation, true).crc() == 0xFA2D,
+              "01 05 00 02 FF 00 2D FA");
+static_assert(UltraSwitch::WriteRequest(kUltraStation, false).crc() == 0x0A6C,
+              "01 05 00 02 00 00 6C 0A");
+static_assert(UltraFaultCode::ReadRequest(kUltraStation).crc() == 0x0A90,
+              "01 04 00 02 00 01 90 0A");
+static_assert(UltraCurrentFreq::ReadRequest(kUltraStation).crc() == 0x0A60,
+              "01 04 00 01 00 01 60 0A");
+static_assert(UltraCurrentPower::ReadRequest(kUltraStation).crc() == 0xCA31,
+              "01 04 00 00 00 01 31 CA");
+static_assert(UltraAmplitude::ReadRequest(kUltraStation).crc() == 0x0D04,
+              "01 03 00 18 00 01 04 0D");
+static_assert(UltraWedingTime::ReadRequest(kUltraStation).crc() == 0xCD55,
+              "01 03 00 19 00 01 55 CD");
+static_assert(UltraMaxFreq::ReadRequest(kUltraStation).crc() == 0x0A74,
+              "01 03 00 03 00 01 74 0A");
+static_assert(UltraMinFreq::ReadRequest(kUltraStation).crc() == 0xCBC5,
+              "01 03 00 04 00 01 C5 CB");
+static_assert(UltraMaxPower::ReadRequest(kUltraStation).crc() == 0xCA25,
+              "01 03 00 02 00 01 25 CA");
+static_assert(UltraFreqAtMachineOn::ReadRequest(kUltraStation).crc() ==
+                  0x0A84,
+              "01 03 00 00 00 01 84 0A");
+static_assert(UltraSoftTimeAtMachineOn::ReadRequest(kUltraStation).crc() ==
+                  0xCAD5,
+              "01 03 00 01 00 01 D5 CA");
+
+/// @brief the rated parameters are changed on the panel of the generator
+/// too, they are read again after the max age.
+const int64_t kRatedRegisterMaxAgeMs = 60 * 1000;
+
+/// @brief Read the register of the generator
+/// @return 0 if success, -2 if the write failed, -3 if the response timeout,
+/// -4 if the response is invalid
+template <typename Register>
+int32_t ReadRegister(ModbusRtuChannel* channel,
+                     typename Register::value_type* value,
+                     int32_t timeout_ms = kUltraResponseTimeoutMs) {
+  const ModbusRtuRequest request = Register::ReadRequest(kUltraStation);
+  ModbusRtuResponse response;
+  int32_t ret = channel->Transact(request.data(), request.size(), timeout_ms,
+                                  &response);
+  if (ret == -2) {
+    LOG_F(LG_ERROR) << "write failed address:" << Register::address();
+    return -2;
+  }
+  if (ret != 0) {
+    LOG_F(LG_ERROR) << "read failed ret: " << ret
+                    << " address:" << Register::address();
+    return -3;
+  }
+  ret = Register::ParseReadResponse(response.data(), response.size(),
+                                    kUltraStation, value);
+  if (ret != 0) {
+    LOG_F(LG_ERROR) << "invalid response ret: " << ret
+                    << " address:" << Register::address();
+    return -4;
+  }
+  return 0;
+}
+
+/// @brief Write the register of the generator
+/// @return 0 if success, -2 if the write failed, -3 if the response timeout,
+/// -4 if the response is not the echo
+template <typename Register>
+int32_t WriteRegister(ModbusRtuChannel* channel,
+                      typename Register::value_type value) {
+  const ModbusRtuRequest request =
+      Register::WriteRequest(kUltraStation, value);
+  ModbusRtuResponse response;
+  int32_t ret = channel->Transact(request.data(), request.size(),
+                                  kUltraResponseTimeoutMs, &response);
+  if (ret == -2) {
+    LOG_F(LG_ERROR) << "write failed address:" << Register::address();
+    return -2;
+  }
+  if (ret != 0) {
+    LOG_F(LG_ERROR) << "read failed ret: " << ret
+                    << " address:" << Register::address();
+    return -3;
+  }
+  ret = Register::ParseWriteResponse(response.data(), response.size(),
+                                     request);
+  if (ret != 0) {
+    LOG_F(LG_ERROR) << "invalid response ret: " << ret
+                    << " address:" << Register::address();
+    return -4;
+  }
+  return 0;
+}
+
+/// @brief Read the holding register of the generator through the cache
+/// @return the value, -1 .. -4 as ReadRegister, -5 if the value is out of
+/// range
+template <typename Register>
+int32_t ReadCachedRegister(ModbusRtuChannel* channel,
+                           ModbusRegisterCache* cache,
+                           int32_t min_value,
+                           int32_t max_value) {
+  int64_t now_ms = anx::common::GetCurrentTimeMillis();
+  /// taken before the read, a write or an invalidation landing during the
+  /// read keeps the value read out of the cache
+  uint64_t generation = cache->generation(Register::address());
+  int32_t value = 0;
+  if (cache->Lookup(Register::address(), now_ms, &value)) {
+    return value;
+  }
+  int32_t ret = ReadRegister<Register>(channel, &value);
+  if (ret != 0) {
+    return ret;
+  }
+  if (value < min_value || value > max_value) {
+    LOG_F(LG_ERROR) << "value out of range: " << value
+                    << " address:" << Register::address();
+    return -5;
+  }
+  cache->Store(Register::address(), value, now_ms, generation);
+  return value;
+}
+}  // namespace
+
 UltraDevice::UltraDevice(DeviceComInterface* port_device)
-    : port_device_(port_device), is_ultra_started_(false) {
+    : port_device_(port_device),
+      channel_(new ModbusRtuChannel(port_device)),
+      is_ultra_started_(false),
+      baud_rate_(0) {
   LOG_F(LG_SENSITIVE) << "UltraDevice::UltraDevice";
+  /// the amplitude and the weding time change only by the writes
+  register_cache_.SetPolicy(UltraAmplitude::address(),
+                            kRegisterCacheUntilInvalidated);
+  register_cache_.SetPolicy(UltraWedingTime::address(),
+                            kRegisterCacheUntilInvalidated);
+  register_cache_.SetPolicy(UltraFreqAtMachineOn::address(),
+                            kRegisterCacheMaxAge, kRatedRegisterMaxAgeMs);
+  register_cache_.SetPolicy(UltraSoftTimeAtMachineOn::address(),
+                            kRegisterCacheMaxAge, kRatedRegisterMaxAgeMs);
+  register_cache_.SetPolicy(UltraMaxPower::address(), kRegisterCacheMaxAge,
+                            kRatedRegisterMaxAgeMs);
+  register_cache_.SetPolicy(UltraMaxFreq::address(), kRegisterCacheMaxAge,
+                            kRatedRegisterMaxAgeMs);
+  register_cache_.SetPolicy(UltraMinFreq::address(), kRegisterCacheMaxAge,
+                            kRatedRegisterMaxAgeMs);
   port_device_->AttachDeviceNode(this);
 }
 
@@ -48,16 +221,47 @@ int32_t UltraDevice::Open(const anx::device::ComSettings& com_settings) {
     LOG_F(LG_ERROR) << "port device open failed";
     return -2;
   }
+  int32_t baud_rate = 0;
+  if (com_port_device.GetComPort()->adrtype == 1) {
+    baud_rate =
+        static_cast<ComAddressPort*>(com_port_device.GetComPort())->baud_rate;
+  }
+  channel_->Reset(baud_rate);
+  /// the generator may be another one or power cycled
+  register_cache_.InvalidateAll();
 
+  anx::common::AutoLock lock(&reopen_mutex_);
+  com_port_device_.reset(new ComPortDevice(com_port_device.GetComName(),
+                                           com_port_device.GetComPort()));
+  baud_rate_ = baud_rate;
   return 0;
 }
 
 void UltraDevice::Close() {
   LOG_F(LG_SENSITIVE);
+  {
+    /// waits the reconnect in progress, the port is not reopened after
+    anx::common::AutoLock lock(&reopen_mutex_);
+    com_port_device_.reset();
+  }
   if (port_device_ != nullptr) {
     port_device_->Close();
   }
   is_ultra_started_ = false;
+  register_cache_.InvalidateAll();
+}
+
+int32_t UltraDevice::GetBaudRate() {
+  anx::common::AutoLock lock(&reopen_mutex_);
+  return com_port_device_ != nullptr ? baud_rate_ : 0;
+}
+
+void UltraDevice::InvalidateRegisterCache() {
+  register_cache_.InvalidateAll();
+}
+
+RegisterCacheStats UltraDevice::GetRegisterCacheStats() {
+  return register_cache_.stats();
 }
 
 bool UltraDevice::isOpened() {
@@ -76,33 +280,9 @@ int32_t UltraDevice::StartUltra() {
     return -1;
   }
   LOG_F(LG_INFO);
-  uint8_t hex[8] = {0x01, 0x05, 0x00, 0x02, 0xFF, 0x00, 0x2D, 0xFA};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "write failed";
-    return -2;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 8) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 8) {
-    LOG_F(LG_ERROR) << "read failed readed: " << readed << " less than 8";
-    return -3;
-  }
-  if (memcmp(hex, hex_res, 8) != 0) {
-    return -4;
+  int32_t ret = WriteRegister<UltraSwitch>(channel_.get(), true);
+  if (ret != 0) {
+    return ret;
   }
   is_ultra_started_ = true;
   return 0;
@@ -115,34 +295,9 @@ int32_t UltraDevice::StopUltra() {
     return -1;
   }
   LOG_F(LG_INFO);
-  uint8_t hex[8] = {0x01, 0x05, 0x00, 0x02, 0x00, 0x00, 0x6C, 0x0A};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "write failed";
-    return -2;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 8) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 8) {
-    LOG_F(LG_ERROR) << "read failed readed: " << readed << " less than 8";
-    return -3;
-  }
-  if (memcmp(hex, hex_res, 8) != 0) {
-    LOG_F(LG_ERROR) << "memcmp failed";
-    return -4;
+  int32_t ret = WriteRegister<UltraSwitch>(channel_.get(), false);
+  if (ret != 0) {
+    return ret;
   }
   is_ultra_started_ = false;
   return 0;
@@ -164,33 +319,11 @@ int32_t UltraDevice::GetFaultCode() {
     return -1;
   }
 
-  uint8_t hex[8] = {0x01, 0x04, 0x00, 0x02, 0x00, 0x01, 0x90, 0x0A};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "write failed";
-    return -2;
+  int32_t fault_code = 0;
+  int32_t ret = ReadRegister<UltraFaultCode>(channel_.get(), &fault_code);
+  if (ret != 0) {
+    return ret;
   }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "read failed readed: " << readed << " less than 7";
-    return -3;
-  }
-  /// get fault code
-  int32_t fault_code = hex_res[3] * 256 + hex_res[4];
   return fault_code;
 }
 
@@ -200,33 +333,11 @@ int32_t UltraDevice::GetCurrentFreq() {
     return -1;
   }
 
-  uint8_t hex[8] = {0x01, 0x04, 0x00, 0x01, 0x00, 0x01, 0x60, 0x0A};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "written < 8";
-    return -2;
+  int32_t freq = 0;
+  int32_t ret = ReadRegister<UltraCurrentFreq>(channel_.get(), &freq);
+  if (ret != 0) {
+    return ret;
   }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "readed < 7";
-    return -3;
-  }
-  /// get freq
-  int32_t freq = hex_res[3] * 256 + hex_res[4];
 #if 0
   return 20 * 1000;
 #else
@@ -240,32 +351,11 @@ int32_t UltraDevice::GetCurrentPower() {
     return -1;
   }
 
-  uint8_t hex[8] = {0x01, 0x04, 0x00, 0x00, 0x00, 0x01, 0x31, 0xCA};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "written < 8";
-    return -2;
+  int32_t power = 0;
+  int32_t ret = ReadRegister<UltraCurrentPower>(channel_.get(), &power);
+  if (ret != 0) {
+    return ret;
   }
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "readed < 7";
-    return -3;
-  }
-  /// get power
-  int32_t power = hex_res[3] * 256 + hex_res[4];
   return power;
 }
 
@@ -279,40 +369,15 @@ int32_t UltraDevice::SetAmplitude(int32_t amplitude) {
     LOG_F(LG_ERROR) << "amplitude out of range";
     return -2;
   }
-  // trans to hex
-  uint8_t hex[8] = {0x01, 0x06, 0x00, 0x18, 0x00};
-  hex[5] = amplitude;
-  uint16_t crc = anx::common::crc16(hex, 6);
-  hex[6] = crc & 0xFF;
-  hex[7] = (crc & 0xFF00) >> 8;
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written != 8) {
-    LOG_F(LG_ERROR) << "written != 8";
-    return -3;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 8) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 8) {
-    LOG_F(LG_ERROR) << "readed < 8";
-    return -4;
-  }
-  if (memcmp(hex, hex_res, 8) != 0) {
-    LOG_F(LG_ERROR) << "memcmp(hex, hex_res, 8) != 0";
-    return -5;
+  /// the register is unknown until the write is acknowledged
+  register_cache_.Invalidate(UltraAmplitude::address());
+  int32_t ret = WriteRegister<UltraAmplitude>(channel_.get(), amplitude);
+  if (ret != 0) {
+    /// -2 is the amplitude out of range
+    return ret - 1;
   }
+  register_cache_.Write(UltraAmplitude::address(), amplitude,
+                        anx::common::GetCurrentTimeMillis());
   return 0;
 }
 
@@ -321,43 +386,8 @@ int32_t UltraDevice::GetAmplitude() {
     LOG_F(LG_ERROR) << "port_device_ is nullptr";
     return -1;
   }
-
-  uint8_t hex[8] = {0x01, 0x03, 0x00, 0x18, 0x00, 0x01, 0x04, 0x0D};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written != 8) {
-    LOG_F(LG_ERROR) << "written != 8";
-    return -2;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "readed < 7";
-    return -3;
-  }
-  if (hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02) {
-    LOG_F(LG_ERROR)
-        << "hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02";
-    return -4;
-  }
-  int32_t value = hex_res[4];
-  if (value < 1 || value > 100) {
-    LOG_F(LG_ERROR) << "value out of range";
-    return -5;
-  }
-  return value;
+  return ReadCachedRegister<UltraAmplitude>(channel_.get(), &register_cache_,
+                                            1, 100);
 }
 
 int32_t UltraDevice::SetWedingTime(int32_t time_sec) {
@@ -369,39 +399,15 @@ int32_t UltraDevice::SetWedingTime(int32_t time_sec) {
     LOG_F(LG_ERROR) << "time_sec out of range";
     return -2;
   }
-  uint8_t hex[8] = {0x01, 0x06, 0x00, 0x19, 0x00};
-  hex[5] = time_sec;
-  uint16_t crc = anx::common::crc16(hex, 6);
-  hex[6] = crc & 0xFF;
-  hex[7] = (crc & 0xFF00) >> 8;
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "written < 8";
-    return -3;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 8) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 8) {
-    LOG_F(LG_ERROR) << "readed < 8";
-    return -4;
-  }
-  if (memcmp(hex, hex_res, 8) != 0) {
-    LOG_F(LG_ERROR) << "memcmp(hex, hex_res, 8) != 0";
-    return -5;
+  /// the register is unknown until the write is acknowledged
+  register_cache_.Invalidate(UltraWedingTime::address());
+  int32_t ret = WriteRegister<UltraWedingTime>(channel_.get(), time_sec);
+  if (ret != 0) {
+    /// -2 is the time out of range
+    return ret - 1;
   }
+  register_cache_.Write(UltraWedingTime::address(), time_sec,
+                        anx::common::GetCurrentTimeMillis());
   return 0;
 }
 
@@ -410,44 +416,8 @@ int32_t UltraDevice::GetWedingTime() {
     LOG_F(LG_ERROR) << "port_device_ is nullptr";
     return -1;
   }
-
-  uint8_t hex[8] = {0x01, 0x03, 0x00, 0x19, 0x00, 0x01, 0x55, 0xCD};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "written < 8";
-    return -2;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "readed < 7";
-    return -3;
-  }
-  if (hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02) {
-    LOG_F(LG_ERROR)
-        << "hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02";
-    return -4;
-  }
-  // value is pos 3 and 4
-  int32_t value = hex_res[3] * 256 + hex_res[4];
-  if (value < 0 || value > 999) {
-    LOG_F(LG_ERROR) << "value out of range";
-    return -5;
-  }
-  return value;
+  return ReadCachedRegister<UltraWedingTime>(channel_.get(), &register_cache_,
+                                             0, 999);
 }
 
 int32_t UltraDevice::GetMaxFreq() {
@@ -455,44 +425,8 @@ int32_t UltraDevice::GetMaxFreq() {
     LOG_F(LG_ERROR) << "port_device_ is nullptr";
     return -1;
   }
-
-  uint8_t hex[8] = {0x01, 0x03, 0x00, 0x03, 0x00, 0x01, 0x74, 0x0A};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "written < 8";
-    return -2;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "readed < 7";
-    return -3;
-  }
-  if (hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02) {
-    LOG_F(LG_ERROR)
-        << "hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02";
-    return -4;
-  }
-  // value is pos 3 and 4
-  int32_t value = hex_res[3] * 256 + hex_res[4];
-  if (value < 1 || value > 0xEFFF) {
-    LOG_F(LG_ERROR) << "value out of range";
-    return -5;
-  }
-  return value;
+  return ReadCachedRegister<UltraMaxFreq>(channel_.get(), &register_cache_, 1,
+                                          0xEFFF);
 }
 
 int32_t UltraDevice::GetMinFreq() {
@@ -500,42 +434,8 @@ int32_t UltraDevice::GetMinFreq() {
     LOG_F(LG_ERROR) << "port_device_ is nullptr";
     return -1;
   }
-
-  uint8_t hex[8] = {0x01, 0x03, 0x00, 0x04, 0x00, 0x01, 0xC5, 0xCB};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "written < 8";
-    return -2;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "readed < 7";
-    return -3;
-  }
-  if (hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02) {
-    return -4;
-  }
-  // value is pos 3 and 4
-  int32_t value = hex_res[3] * 256 + hex_res[4];
-  if (value < 1 || value > 0xEFFF) {
-    LOG_F(LG_ERROR) << "value out of range";
-    return -5;
-  }
-  return value;
+  return ReadCachedRegister<UltraMinFreq>(channel_.get(), &register_cache_, 1,
+                                          0xEFFF);
 }
 
 int32_t UltraDevice::GetMaxPower() {
@@ -543,44 +443,8 @@ int32_t UltraDevice::GetMaxPower() {
     LOG_F(LG_ERROR) << "port_device_ is nullptr";
     return -1;
   }
-
-  uint8_t hex[8] = {0x01, 0x03, 0x00, 0x02, 0x00, 0x01, 0x25, 0xCA};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written <= 0) {
-    LOG_F(LG_ERROR) << "written <= 0";
-    return -2;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "readed < 7";
-    return -3;
-  }
-  if (hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02) {
-    LOG_F(LG_ERROR)
-        << "hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02";
-    return -4;
-  }
-  // value is pos 3 and 4
-  int32_t value = hex_res[3] * 256 + hex_res[4];
-  if (value < 1 || value > 0xEFFF) {
-    LOG_F(LG_ERROR) << "value out of range";
-    return -5;
-  }
-  return value;
+  return ReadCachedRegister<UltraMaxPower>(channel_.get(), &register_cache_, 1,
+                                           0xEFFF);
 }
 
 int32_t UltraDevice::GetFreqAtMachineOn() {
@@ -588,44 +452,8 @@ int32_t UltraDevice::GetFreqAtMachineOn() {
     LOG_F(LG_ERROR) << "port_device_ is nullptr";
     return -1;
   }
-
-  uint8_t hex[8] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x01, 0x84, 0x0A};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "written < 8";
-    return -2;
-  }
-
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "readed < 7";
-    return -3;
-  }
-  if (hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02) {
-    LOG_F(LG_ERROR)
-        << "hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02";
-    return -4;
-  }
-  // value is pos 3 and 4
-  int32_t value = hex_res[3] * 256 + hex_res[4];
-  if (value < 1 || value > 0xEFFF) {
-    LOG_F(LG_ERROR) << "value out of range";
-    return -5;
-  }
-  return value;
+  return ReadCachedRegister<UltraFreqAtMachineOn>(
+      channel_.get(), &register_cache_, 1, 0xEFFF);
 }
 
 int32_t UltraDevice::GetSoftTimeAtMachineOn() {
@@ -633,44 +461,57 @@ int32_t UltraDevice::GetSoftTimeAtMachineOn() {
     LOG_F(LG_ERROR) << "port_device_ is nullptr";
     return -1;
   }
+  return ReadCachedRegister<UltraSoftTimeAtMachineOn>(
+      channel_.get(), &register_cache_, 1, 0xEFFF);
+}
 
-  uint8_t hex[8] = {0x01, 0x03, 0x00, 0x01, 0x00, 0x01, 0xD5, 0xCA};
-  int32_t written = port_device_->Write(hex, sizeof(hex));
-  if (written < 8) {
-    LOG_F(LG_ERROR) << "written < 8";
-    return -2;
-  }
+bool UltraDevice::ProbeEnabled() {
+  anx::common::AutoLock lock(&reopen_mutex_);
+  return com_port_device_ != nullptr;
+}
 
-  uint8_t hex_res[64] = {0};
-  int32_t try_count = 0;
-  int32_t readed = 0;
-  while (try_count < 10) {
-    int32_t r = port_device_->Read(hex_res + readed, sizeof(hex_res) - readed);
-    if (r > 0) {
-      readed += r;
-    }
-    if (readed >= 7) {
-      break;
-    }
-    try_count++;
-    anx::common::sleep_ms(10);
-  }
-  if (readed < 7) {
-    LOG_F(LG_ERROR) << "readed < 7";
-    return -3;
+int32_t UltraDevice::ProbeBaudRate() {
+  return GetBaudRate();
+}
+
+int64_t UltraDevice::LastResponseUs() {
+  return channel_->last_response_us();
+}
+
+int32_t UltraDevice::Heartbeat(int32_t timeout_ms) {
+  if (port_device_ == nullptr) {
+    LOG_F(LG_ERROR) << "port_device_ is nullptr";
+    return -1;
   }
-  if (hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02) {
-    LOG_F(LG_ERROR)
-        << "hex_res[0] != 0x01 || hex_res[1] != 0x03 || hex_res[2] != 0x02";
-    return -4;
+  const ModbusRtuRequest request = UltraFaultCode::ReadRequest(kUltraStation);
+  ModbusRtuResponse response;
+  int32_t ret = channel_->Transact(request.data(), request.size(), timeout_ms,
+                                   &response);
+  if (ret == -4) {
+    /// the transaction of the other user is in progress
+    return 1;
+  }
+  if (ret != 0) {
+    return ret;
+  }
+  int32_t fault_code = 0;
+  ret = UltraFaultCode::ParseReadResponse(response.data(), response.size(),
+                                          kUltraStation, &fault_code);
+  return ret == 0 ? 0 : -4;
+}
+
+int32_t UltraDevice::Reconnect() {
+  anx::common::AutoLock lock(&reopen_mutex_);
+  if (port_device_ == nullptr || com_port_device_ == nullptr) {
+    return -1;
   }
-  // value is pos 3 and 4
-  int32_t value = hex_res[3] * 256 + hex_res[4];
-  if (value < 1 || value > 0xEFFF) {
-    LOG_F(LG_ERROR) << "value out of range";
-    return -5;
+  LOG_F(LG_WARN) << "reconnect " << com_port_device_->GetComName();
+  if (channel_->Reopen(*com_port_device_, baud_rate_) != 0) {
+    return -2;
   }
-  return value;
+  /// the generator may be power cycled
+  register_cache_.InvalidateAll();
+  return 0;
 }
 }  // namespace device
 }  // namespace anx
@@ -12,14 +12,20 @@
 #ifndef APP_DEVICE_ULTRASONIC_ULTRA_DEVICE_H_
 #define APP_DEVICE_ULTRASONIC_ULTRA_DEVICE_H_
 
+#include <memory>
 #include <string>
+
 #include "app/device/device_com.h"
+#include "app/common/thread.h"
 #include "app/device/device_com_settings.h"
+#include "app/device/device_watchdog.h"
+#include "app/device/modbus_register_cache.h"
 
 namespace anx {
 namespace device {
 class ComPortDevice;
-class UltraDevice : public DeviceNode {
+class ModbusRtuChannel;
+class UltraDevice : public DeviceNode, public DeviceProbe {
  public:
   explicit UltraDevice(DeviceComInterface* com_port_device);
   ~UltraDevice();
@@ -38,14 +44,22 @@ class UltraDevice : public DeviceNode {
   /// @brief  Check device is open
   /// @return true is open, false is close
   bool isOpened();
+  /// @brief  Get the baud rate of Open
+  /// @return the baud rate, 0 if closed or not a serial port
+  int32_t GetBaudRate();
+  /// @brief  Invalidate the holding registers cached, the next Get reads the
+  /// device. Open and Close invalidate them too.
+  void InvalidateRegisterCache();
+  /// @brief  Get the hit and miss counters of the holding registers cached
+  RegisterCacheStats GetRegisterCacheStats();
   /// @brief  Start ultra
   /// send: 01 05 00 02 FF 00 2D FA
   /// response: 01 05 00 02 FF 00 2D FA
   /// @return success 0, failed -1
   int32_t StartUltra();
   /// @brief  Stop ultra
-  /// send: 01 05 00 02 00 00 8C 0A
-  /// response: 01 05 00 02 00 00 8C 0A
+  /// send: 01 05 00 02 00 00 6C 0A
+  /// response: 01 05 00 02 00 00 6C 0A
   /// @return success 0, failed -1
   int32_t StopUltra();
   /// @brief  Check ultra is started
@@ -69,8 +83,8 @@ class UltraDevice : public DeviceNode {
   /// @return current power or error < 0
   int32_t GetCurrentPower();
   /// @brief  Set ultra amplitude [20, 100]
-  /// send: 01 06 00 18 00 14 90 C2
-  /// receive: 01 06 00 18 00 14 90 C2
+  /// send: 01 06 00 18 00 14 09 C2
+  /// receive: 01 06 00 18 00 14 09 C2
   /// amplitude is 0x14 = 20
   /// @param amplitude  [20, 100]
   /// @return success 0, failed -1
@@ -130,9 +144,33 @@ class UltraDevice : public DeviceNode {
   /// value: 0x0064 = 100
   int32_t GetSoftTimeAtMachineOn();
 
+  // impliment anx::device::DeviceProbe
+  /// @brief  the device is probed from Open to Close
+  bool ProbeEnabled() override;
+  /// @brief  the baud rate of Open, @see GetBaudRate
+  int32_t ProbeBaudRate() override;
+  int64_t LastResponseUs() override;
+  /// @brief  Read the fault code
+  /// @return success 0, 1 if the channel is busy until the timeout, < 0 as
+  /// ReadRegister
+  int32_t Heartbeat(int32_t timeout_ms) override;
+  /// @brief  Reopen the port with the settings of Open, the registers cached
+  /// are invalidated.
+  /// @return success 0, -1 if closed, -2 if the port open failed
+  int32_t Reconnect() override;
+
  private:
   DeviceComInterface* port_device_;
+  /// @brief the responses are delimited as the modbus rtu frames
+  std::unique_ptr<ModbusRtuChannel> channel_;
+  /// @brief the holding registers read or written, see the policies in the
+  /// constructor.
+  ModbusRegisterCache register_cache_;
   bool is_ultra_started_;
+  /// @brief the settings of Open for Reconnect, null after Close
+  anx::common::Mutex reopen_mutex_;
+  std::unique_ptr<ComPortDevice> com_port_device_;
+  int32_t baud_rate_;
 };
 
 }  // namespace device
@@ -0,0 +1,1105 @@
+/**
+ * @file docx_report.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief in process docx report generator. the report template package is
+ * opened with zlib, the summary fields and the data table are streamed into
+ * word/document.xml, the series into the charts, and the report is written
+ * in one pass over the parts.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/expdata/docx_report.h"
+
+#include <time.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#include "app/common/logger.h"
+#include "app/expdata/xml_stream_writer.h"
+#include "app/expdata/zip_file.h"
+
+namespace anx {
+namespace expdata {
+
+namespace {
+
+const char kDocumentPart[] = "word/document.xml";
+const char kDataTableField[] = "${ExpDataTable}";
+
+/// @brief the table with single borders and the header row repeated on
+/// every page.
+const char kTableStart[] =
+    "<w:tbl><w:tblPr><w:tblW w:w=\"0\" w:type=\"auto\"/><w:tblBorders>"
+    "<w:top w:val=\"single\" w:sz=\"4\" w:space=\"0\" w:color=\"auto\"/>"
+    "<w:left w:val=\"single\" w:sz=\"4\" w:space=\"0\" w:color=\"auto\"/>"
+    "<w:bottom w:val=\"single\" w:sz=\"4\" w:space=\"0\" w:color=\"auto\"/>"
+    "<w:right w:val=\"single\" w:sz=\"4\" w:space=\"0\" w:color=\"auto\"/>"
+    "<w:insideH w:val=\"single\" w:sz=\"4\" w:space=\"0\" w:color=\"auto\"/>"
+    "<w:insideV w:val=\"single\" w:sz=\"4\" w:space=\"0\" w:color=\"auto\"/>"
+    "</w:tblBorders></w:tblPr>";
+const char kTableEnd[] = "</w:tbl>";
+const char kHeaderRowStart[] = "<w:tr><w:trPr><w:tblHeader/></w:trPr>";
+const char kRowStart[] = "<w:tr>";
+const char kRowEnd[] = "</w:tr>";
+const char kCellStart[] = "<w:tc><w:p><w:r><w:t>";
+const char kCellEnd[] = "</w:t></w:r></w:p></w:tc>";
+const char kEmptyParagraph[] = "<w:p/>";
+
+const char* kDataTableHeader[] = {"id", "cycle_count", "KHz", "MPa", "μm"};
+
+const char kChartPartPrefix[] = "word/charts/chart";
+
+/// @brief the columns of the data table, the order of kDataTableHeader
+enum DataColumn {
+  kColumnNone = -1,
+  kColumnId = 0,
+  kColumnCycleCount,
+  kColumnKHz,
+  kColumnMPa,
+  kColumnUm,
+  kColumnCount
+};
+
+/// @brief the labels of the data columns in the templates, normalized
+const char* const kColumnLabels[kColumnCount][4] = {
+    {"id", "序号", "编号", nullptr},
+    {"cycle_count", "循环次数", "循环周次", "cyclecount"},
+    {"khz", "频率", "谐振频率", nullptr},
+    {"mpa", "应力", "静载", nullptr},
+    {"μm", "um", "振幅", nullptr}};
+
+/// @brief the labels of the summary fields in the templates, normalized, the
+/// order of SummaryFields.
+const char* const kFieldLabels[][4] = {
+    {"starttime", "开始时间", "试验开始时间", "实验开始时间"},
+    {"endtime", "结束时间", "试验结束时间", "实验结束时间"},
+    {"experimentname", "试验名称", "实验名称", nullptr},
+    {"elasticmodulus", "弹性模量", nullptr, nullptr},
+    {"density", "密度", nullptr, nullptr},
+    {"maxstress", "最大应力", "应力最大值", nullptr},
+    {"ratioofstress", "应力比", nullptr, nullptr},
+    {"cyclecount", "循环次数", "循环周次", nullptr},
+    {"bottomamplitude", "底部振幅", "振幅", nullptr}};
+
+std::string TimeToString(int64_t time) {
+  time_t t = static_cast<time_t>(time);
+  struct tm tm;
+#if defined(_WIN32)
+  localtime_s(&tm, &t);
+#else
+  localtime_r(&t, &tm);
+#endif
+  char buffer[32];
+  strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+  return buffer;
+}
+
+template <typename T>
+std::string ToString(T value) {
+  std::ostringstream out;
+  out << value;
+  return out.str();
+}
+
+/// @brief the name and value pairs of the summary
+std::vector<std::pair<std::string, std::string>> SummaryFields(
+    const ExperimentReport& report) {
+  std::vector<std::pair<std::string, std::string>> fields;
+  fields.push_back(
+      std::make_pair("StartTime", TimeToString(report.start_time_)));
+  fields.push_back(std::make_pair("EndTime", TimeToString(report.end_time_)));
+  fields.push_back(std::make_pair("ExperimentName", report.experiment_name_));
+  fields.push_back(
+      std::make_pair("ElasticModulus", ToString(report.elastic_modulus_)));
+  fields.push_back(std::make_pair("Density", ToString(report.density_)));
+  fields.push_back(std::make_pair("MaxStress", ToString(report.max_stress_)));
+  fields.push_back(
+      std::make_pair("RatioOfStress", ToString(report.ratio_stress_)));
+  fields.push_back(std::make_pair("CycleCount", ToString(report.cycle_count_)));
+  fields.push_back(
+      std::make_pair("BottomAmplitude", ToString(report.amplitude_)));
+  return fields;
+}
+
+std::string EscapeXml(const std::string& text) {
+  std::string out;
+  out.reserve(text.size());
+  for (char c : text) {
+    switch (c) {
+      case '&':
+        out += "&amp;";
+        break;
+      case '<':
+        out += "&lt;";
+        break;
+      case '>':
+        out += "&gt;";
+        break;
+      case '"':
+        out += "&quot;";
+        break;
+      default:
+        out += c;
+        break;
+    }
+  }
+  return out;
+}
+
+void WriteMarkup(XmlStreamWriter* xml, const char* markup) {
+  xml->Raw(markup, strlen(markup));
+}
+
+void WriteCell(XmlStreamWriter* xml, const char* text, size_t size) {
+  xml->Raw(kCellStart, sizeof(kCellStart) - 1);
+  xml->Text(text, size);
+  xml->Raw(kCellEnd, sizeof(kCellEnd) - 1);
+}
+
+void WriteCell(XmlStreamWriter* xml, const std::string& text) {
+  WriteCell(xml, text.data(), text.size());
+}
+
+void AppendUnsigned(std::string* out, uint64_t value) {
+  char digits[24];
+  int32_t n = 0;
+  do {
+    digits[n++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (n > 0) {
+    out->push_back(digits[--n]);
+  }
+}
+
+/// @brief append the value with the fixed decimals like "%.*f", the digits
+/// are produced by integer math, the snprintf takes most of the time of
+/// the large tables.
+void AppendFixed(std::string* out, double value, int32_t decimals) {
+  static const double kScales[] = {1, 10, 100, 1e3, 1e4, 1e5, 1e6};
+  double scaled = std::fabs(value) * kScales[decimals];
+  if (!(scaled < 9e15)) {
+    char cell[64];
+    int size = snprintf(cell, sizeof(cell), "%.*f", decimals, value);
+    out->append(cell, size > 0 ? size : 0);
+    return;
+  }
+  uint64_t fixed = static_cast<uint64_t>(std::llround(scaled));
+  uint64_t scale = static_cast<uint64_t>(kScales[decimals]);
+  if (value < 0 && fixed != 0) {
+    out->push_back('-');
+  }
+  AppendUnsigned(out, fixed / scale);
+  if (decimals > 0) {
+    out->push_back('.');
+    uint64_t fraction = fixed % scale;
+    for (uint64_t digit = scale / 10; digit > 0; digit /= 10) {
+      out->push_back(static_cast<char>('0' + fraction / digit % 10));
+    }
+  }
+}
+
+/// @brief append the value of the column of the row
+void AppendValue(std::string* out, int32_t column, const ExperimentData& data) {
+  switch (column) {
+    case kColumnId:
+      AppendUnsigned(out, data.id_);
+      break;
+    case kColumnCycleCount:
+      AppendUnsigned(out, data.cycle_count_);
+      break;
+    case kColumnKHz:
+      AppendFixed(out, data.KHz_, 3);
+      break;
+    case kColumnMPa:
+      AppendFixed(out, data.MPa_, 6);
+      break;
+    case kColumnUm:
+      AppendFixed(out, data.um_, 2);
+      break;
+    default:
+      break;
+  }
+}
+
+/// @brief the markup around the value of one cell of the data table
+struct CellMarkup {
+  int32_t column;
+  std::string start;
+  std::string end;
+};
+
+void AppendRow(std::string* out,
+               const std::vector<CellMarkup>& cells,
+               const ExperimentData& data) {
+  out->append(kRowStart, sizeof(kRowStart) - 1);
+  for (auto& cell : cells) {
+    out->append(cell.start);
+    AppendValue(out, cell.column, data);
+    out->append(cell.end);
+  }
+  out->append(kRowEnd, sizeof(kRowEnd) - 1);
+}
+
+/// @brief Check the tag at the pos is the tag and not a longer one, e.g.
+/// <w:r> and not <w:rPr>.
+bool IsTagAt(const std::string& xml, size_t pos, const std::string& tag) {
+  size_t next = pos + tag.size();
+  if (xml.compare(pos, tag.size(), tag) != 0 || next >= xml.size()) {
+    return false;
+  }
+  char c = xml[next];
+  return c == '>' || c == ' ' || c == '/';
+}
+
+/// @brief Find the element of the tag in [pos, limit), the nested elements
+/// of the same tag are skipped.
+/// @return true if found, [*begin, *end) is the element
+bool FindElement(const std::string& xml,
+                 const std::string& tag,
+                 size_t pos,
+                 size_t limit,
+                 size_t* begin,
+                 size_t* end) {
+  const std::string open = "<" + tag;
+  const std::string close = "</" + tag + ">";
+  size_t start = pos;
+  for (;;) {
+    start = xml.find(open, start);
+    if (start == std::string::npos || start >= limit) {
+      return false;
+    }
+    if (IsTagAt(xml, start, open)) {
+      break;
+    }
+    start += open.size();
+  }
+  size_t gt = xml.find('>', start);
+  if (gt == std::string::npos) {
+    return false;
+  }
+  if (xml[gt - 1] == '/') {
+    *begin = start;
+    *end = gt + 1;
+    return *end <= limit;
+  }
+  int32_t depth = 1;
+  size_t cursor = gt + 1;
+  while (depth > 0) {
+    size_t next_open = xml.find(open, cursor);
+    size_t next_close = xml.find(close, cursor);
+    if (next_close == std::string::npos) {
+      return false;
+    }
+    if (next_open != std::string::npos && next_open < next_close) {
+      size_t next_gt = xml.find('>', next_open);
+      if (IsTagAt(xml, next_open, open) && next_gt != std::string::npos &&
+          xml[next_gt - 1] != '/') {
+        depth++;
+      }
+      cursor = next_open + open.size();
+      continue;
+    }
+    depth--;
+    cursor = next_close + close.size();
+  }
+  *begin = start;
+  *end = cursor;
+  return *end <= limit;
+}
+
+/// @brief Get the elements of the tag in [pos, limit) at the top level
+std::vector<std::pair<size_t, size_t>> FindElements(const std::string& xml,
+                                                    const std::string& tag,
+                                                    size_t pos,
+                                                    size_t limit) {
+  std::vector<std::pair<size_t, size_t>> elements;
+  size_t begin = 0;
+  size_t end = 0;
+  while (FindElement(xml, tag, pos, limit, &begin, &end)) {
+    elements.push_back(std::make_pair(begin, end));
+    pos = end;
+  }
+  return elements;
+}
+
+/// @brief Get the first element of the tag in [pos, limit), empty if none
+std::string ElementOf(const std::string& xml,
+                      const std::string& tag,
+                      size_t pos,
+                      size_t limit) {
+  size_t begin = 0;
+  size_t end = 0;
+  if (!FindElement(xml, tag, pos, limit, &begin, &end)) {
+    return std::string();
+  }
+  return xml.substr(begin, end - begin);
+}
+
+/// @brief Get the text of the runs <w:t> or the values <c:v> in [pos, limit)
+std::string TextOf(const std::string& xml,
+                   const std::string& tag,
+                   size_t pos,
+                   size_t limit) {
+  std::string text;
+  for (auto& element : FindElements(xml, tag, pos, limit)) {
+    size_t gt = xml.find('>', element.first);
+    if (xml[gt - 1] == '/') {
+      continue;
+    }
+    size_t close = element.second - tag.size() - 3;
+    text.append(xml, gt + 1, close - gt - 1);
+  }
+  return text;
+}
+
+/// @brief Normalize the label, the spaces, the colon and the unit in the
+/// brackets at the end are removed and the ascii letters are lower case,
+/// e.g. "频率 (kHz)：" to "频率".
+std::string NormalizeLabel(std::string label) {
+  static const char* const kTrailers[] = {":", "\xEF\xBC\x9A", " ",
+                                          "\xE3\x80\x80", "\t"};
+  std::string out;
+  for (;;) {
+    bool trimmed = false;
+    for (auto trailer : kTrailers) {
+      size_t size = strlen(trailer);
+      if (label.size() >= size &&
+          label.compare(label.size() - size, size, trailer) == 0) {
+        label.resize(label.size() - size);
+        trimmed = true;
+      }
+    }
+    if (!label.empty() && label.back() == ')') {
+      size_t open = label.rfind('(');
+      if (open != std::string::npos) {
+        label.resize(open);
+        trimmed = true;
+      }
+    } else if (label.size() >= 3 &&
+               label.compare(label.size() - 3, 3, "\xEF\xBC\x89") == 0) {
+      size_t open = label.rfind("\xEF\xBC\x88");
+      if (open != std::string::npos) {
+        label.resize(open);
+        trimmed = true;
+      }
+    }
+    if (!trimmed) {
+      break;
+    }
+  }
+  for (char c : label) {
+    if (c == ' ' || c == '\t') {
+      continue;
+    }
+    out.push_back((c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a')
+                                         : c);
+  }
+  return out;
+}
+
+template <size_t N>
+int32_t IndexOfLabel(const char* const (&labels)[N][4],
+                     const std::string& label) {
+  for (size_t i = 0; i < N; i++) {
+    for (auto name : labels[i]) {
+      if (name != nullptr && label == name) {
+        return static_cast<int32_t>(i);
+      }
+    }
+  }
+  return -1;
+}
+
+/// @brief Get the markup of the cell value from the cell of the template,
+/// the properties of the cell, the paragraph and the run are kept.
+CellMarkup CellMarkupOf(const std::string& xml,
+                        size_t begin,
+                        size_t end,
+                        int32_t column,
+                        bool with_run_properties) {
+  CellMarkup markup;
+  markup.column = column;
+  markup.start = xml.substr(begin, xml.find('>', begin) + 1 - begin);
+  markup.start += ElementOf(xml, "w:tcPr", begin, end);
+  markup.start += "<w:p>";
+  size_t p_begin = 0;
+  size_t p_end = 0;
+  if (FindElement(xml, "w:p", begin, end, &p_begin, &p_end)) {
+    markup.start += ElementOf(xml, "w:pPr", p_begin, p_end);
+  }
+  markup.start += "<w:r>";
+  if (with_run_properties) {
+    markup.start += ElementOf(xml, "w:rPr", begin, end);
+  }
+  markup.start += "<w:t>";
+  markup.end = "</w:t></w:r></w:p></w:tc>";
+  return markup;
+}
+
+/// @brief Find the data table of the template by the labels of its header
+/// row, the header cells are all labels and the cycle count is one of them.
+/// @param head_end the end of the header row, the rows go after it
+/// @param tail_begin the end of the rows of the template, they are dropped
+/// @param cells the markup of the cells of the rows, of the first row after
+/// the header if any.
+/// @return true if found
+bool FindDataTable(const std::string& xml,
+                   size_t* head_end,
+                   size_t* tail_begin,
+                   std::vector<CellMarkup>* cells) {
+  for (auto& table : FindElements(xml, "w:tbl", 0, xml.size())) {
+    auto rows = FindElements(xml, "w:tr", table.first, table.second);
+    if (rows.empty()) {
+      continue;
+    }
+    auto header = FindElements(xml, "w:tc", rows[0].first, rows[0].second);
+    std::vector<int32_t> columns;
+    int32_t matched = 0;
+    bool with_cycle_count = false;
+    bool with_empty = false;
+    for (auto& cell : header) {
+      std::string label =
+          NormalizeLabel(TextOf(xml, "w:t", cell.first, cell.second));
+      int32_t column = IndexOfLabel(kColumnLabels, label);
+      columns.push_back(column);
+      matched += (column != kColumnNone) ? 1 : 0;
+      with_cycle_count |= (column == kColumnCycleCount);
+      with_empty |= label.empty();
+    }
+    if (matched < 2 || !with_cycle_count || with_empty) {
+      continue;
+    }
+    auto style = header;
+    bool with_run_properties = false;
+    if (rows.size() > 1) {
+      auto sample = FindElements(xml, "w:tc", rows[1].first, rows[1].second);
+      if (sample.size() == header.size()) {
+        style = sample;
+        with_run_properties = true;
+      }
+    }
+    cells->clear();
+    for (size_t i = 0; i < style.size(); i++) {
+      cells->push_back(CellMarkupOf(xml, style[i].first, style[i].second,
+                                    columns[i], with_run_properties));
+    }
+    *head_end = rows[0].second;
+    *tail_begin = rows.back().second;
+    return true;
+  }
+  return false;
+}
+
+/// @brief the sink of the document part in the zip file
+class ZipEntrySink : public XmlStreamSink {
+ public:
+  explicit ZipEntrySink(ZipFileWriter* zip) : zip_(zip) {}
+
+  int32_t Write(const char* data, size_t size) override {
+    return zip_->WriteEntry(data, size);
+  }
+
+ private:
+  ZipFileWriter* zip_;
+};
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// clz VectorRowSource
+VectorRowSource::VectorRowSource(const std::vector<ExperimentData>* exp_data)
+    : exp_data_(exp_data), index_(0) {}
+
+VectorRowSource::~VectorRowSource() {}
+
+int32_t VectorRowSource::Next(ExperimentData* data) {
+  if (exp_data_ == nullptr || index_ >= exp_data_->size()) {
+    return 0;
+  }
+  *data = (*exp_data_)[index_++];
+  return 1;
+}
+
+int32_t VectorRowSource::Progress() {
+  if (exp_data_ == nullptr || exp_data_->empty()) {
+    return 100;
+  }
+  return static_cast<int32_t>(index_ * 100 / exp_data_->size());
+}
+
+int32_t VectorRowSource::Rewind() {
+  index_ = 0;
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz CsvRowSource
+CsvRowSource::CsvRowSource() : file_(nullptr), file_size_(0), read_size_(0) {}
+
+CsvRowSource::~CsvRowSource() {
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+int32_t CsvRowSource::Open(const std::string& file_pathname) {
+  if (file_ != nullptr) {
+    fclose(file_);
+  }
+  file_ = fopen(file_pathname.c_str(), "rb");
+  if (file_ == nullptr) {
+    LOG_F(LG_ERROR) << "open file failed:" << file_pathname;
+    return -1;
+  }
+  fseek(file_, 0, SEEK_END);
+  file_size_ = ftell(file_);
+  SkipHeader();
+  return 0;
+}
+
+void CsvRowSource::SkipHeader() {
+  fseek(file_, 0, SEEK_SET);
+  read_size_ = 0;
+  char line[256];
+  if (fgets(line, sizeof(line), file_) != nullptr) {
+    read_size_ += strlen(line);
+  }
+}
+
+int32_t CsvRowSource::Next(ExperimentData* data) {
+  if (file_ == nullptr) {
+    return -1;
+  }
+  char line[256];
+  while (fgets(line, sizeof(line), file_) != nullptr) {
+    read_size_ += strlen(line);
+    /// id,cycle_count,KHz,MPa,μm
+    char* p = line;
+    char* end = nullptr;
+    data->id_ = strtoull(p, &end, 10);
+    if (end == p || *end != ',') {
+      continue;
+    }
+    p = end + 1;
+    data->cycle_count_ = strtoull(p, &end, 10);
+    if (end == p || *end != ',') {
+      continue;
+    }
+    p = end + 1;
+    data->KHz_ = strtod(p, &end);
+    if (end == p || *end != ',') {
+      continue;
+    }
+    p = end + 1;
+    data->MPa_ = strtod(p, &end);
+    if (end == p || *end != ',') {
+      continue;
+    }
+    p = end + 1;
+    data->um_ = strtod(p, &end);
+    if (end == p) {
+      continue;
+    }
+    return 1;
+  }
+  return ferror(file_) ? -2 : 0;
+}
+
+int32_t CsvRowSource::Progress() {
+  if (file_size_ <= 0) {
+    return 100;
+  }
+  return static_cast<int32_t>(read_size_ * 100 / file_size_);
+}
+
+int32_t CsvRowSource::Rewind() {
+  if (file_ == nullptr) {
+    return -1;
+  }
+  clearerr(file_);
+  SkipHeader();
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz DocxReportGenerator
+
+/// @brief the cache of the values of one series, the content [begin, end)
+/// is replaced by the points of the column.
+struct DocxReportGenerator::ChartSeries {
+  size_t begin;
+  size_t end;
+  int32_t column;
+  /// @brief the <c:formatCode> of the cache, kept before the points
+  std::string format_code;
+};
+
+DocxReportGenerator::DocxReportGenerator(
+    const std::string& template_pathname,
+    const ExperimentReport& report,
+    std::unique_ptr<ReportRowSource> rows,
+    const std::string& file_pathname)
+    : template_pathname_(template_pathname),
+      report_(report),
+      rows_(std::move(rows)),
+      file_pathname_(file_pathname),
+      listener_(nullptr),
+      canceled_(false),
+      result_(0),
+      percent_(-1),
+      passes_(1),
+      pass_(0),
+      row_count_(0) {}
+
+DocxReportGenerator::~DocxReportGenerator() {
+  interrupt();
+  Join();
+}
+
+int32_t DocxReportGenerator::Generate() {
+  percent_ = -1;
+  passes_ = 1;
+  pass_ = 0;
+  row_count_ = 0;
+  ZipFileReader reader;
+  int32_t ret = reader.Open(template_pathname_);
+  if (ret != 0) {
+    return ret;
+  }
+  const ZipEntry* document_entry = reader.FindEntry(kDocumentPart);
+  std::string document;
+  if (document_entry == nullptr ||
+      reader.ReadEntry(*document_entry, &document) != 0) {
+    LOG_F(LG_ERROR) << "invalid docx template:" << template_pathname_;
+    return -2;
+  }
+  /// @note the charts are read first, the count of the points is written
+  /// before the points of the series.
+  std::map<std::string, std::pair<std::string, std::vector<ChartSeries>>>
+      charts;
+  for (auto& entry : reader.entries()) {
+    if (entry.name_.compare(0, sizeof(kChartPartPrefix) - 1,
+                            kChartPartPrefix) != 0) {
+      continue;
+    }
+    std::string chart;
+    if (reader.ReadEntry(entry, &chart) != 0) {
+      LOG_F(LG_ERROR) << "invalid docx chart:" << entry.name_;
+      return -2;
+    }
+    std::vector<ChartSeries> series = ChartSeriesOf(chart);
+    if (series.empty()) {
+      continue;
+    }
+    passes_ += static_cast<int32_t>(series.size());
+    charts[entry.name_] = std::make_pair(std::move(chart), std::move(series));
+  }
+  if (!charts.empty()) {
+    passes_++;
+    ret = CountRows();
+    if (ret != 0) {
+      return ret;
+    }
+  }
+  /// @note write to the temp file and rename at the end, the report file is
+  /// never seen half written.
+  std::string temp_pathname = file_pathname_ + ".part";
+  /// the repeated table markup deflates well at the fastest level.
+  ZipFileWriter zip(1);
+  if (zip.Open(temp_pathname) != 0) {
+    return -3;
+  }
+  for (auto& entry : reader.entries()) {
+    auto chart = charts.find(entry.name_);
+    if (entry.name_ == kDocumentPart) {
+      ret = WriteDocument(document, &zip);
+    } else if (chart != charts.end()) {
+      ret = WriteChart(entry.name_, chart->second.first, chart->second.second,
+                       &zip);
+    } else {
+      ret = zip.CopyEntry(reader, entry) == 0 ? 0 : -3;
+    }
+    if (ret != 0) {
+      break;
+    }
+  }
+  if (zip.Close() != 0 && ret == 0) {
+    ret = -3;
+  }
+  if (ret != 0) {
+    remove(temp_pathname.c_str());
+    return ret;
+  }
+  remove(file_pathname_.c_str());
+  if (rename(temp_pathname.c_str(), file_pathname_.c_str()) != 0) {
+    LOG_F(LG_ERROR) << "rename failed:" << file_pathname_;
+    remove(temp_pathname.c_str());
+    return -3;
+  }
+  ReportProgress(100);
+  return 0;
+}
+
+void DocxReportGenerator::Start() {
+  Join();
+  canceled_ = false;
+  thread_.reset(new anx::common::Thread(this));
+  thread_->start();
+}
+
+void DocxReportGenerator::Join() {
+  if (thread_ != nullptr) {
+    thread_->join();
+    thread_.reset();
+  }
+}
+
+void DocxReportGenerator::run() {
+  result_ = Generate();
+  if (listener_ != nullptr) {
+    listener_->OnReportFinished(result_, file_pathname_);
+  }
+}
+
+std::vector<DocxReportGenerator::ChartSeries>
+DocxReportGenerator::ChartSeriesOf(const std::string& chart) {
+  static const char* const kCaches[] = {"c:numCache", "c:numLit",
+                                        "c:strCache", "c:strLit"};
+  /// @brief Get the cache of the first element of the tags in [pos, limit)
+  auto cache_of = [&chart](const char* const (&tags)[2], size_t pos,
+                           size_t limit, int32_t column,
+                           ChartSeries* series) {
+    size_t begin = 0;
+    size_t end = 0;
+    if (!FindElement(chart, tags[0], pos, limit, &begin, &end) &&
+        !FindElement(chart, tags[1], pos, limit, &begin, &end)) {
+      return false;
+    }
+    for (auto tag : kCaches) {
+      size_t cache_begin = 0;
+      size_t cache_end = 0;
+      if (!FindElement(chart, tag, begin, end, &cache_begin, &cache_end)) {
+        continue;
+      }
+      size_t gt = chart.find('>', cache_begin);
+      if (chart[gt - 1] == '/') {
+        return false;
+      }
+      series->begin = gt + 1;
+      series->end = cache_end - strlen(tag) - 3;
+      series->column = column;
+      series->format_code =
+          ElementOf(chart, "c:formatCode", series->begin, series->end);
+      return true;
+    }
+    return false;
+  };
+  static const char* const kXTags[2] = {"c:xVal", "c:cat"};
+  static const char* const kYTags[2] = {"c:yVal", "c:val"};
+  std::vector<ChartSeries> series;
+  for (auto& ser : FindElements(chart, "c:ser", 0, chart.size())) {
+    size_t tx_begin = 0;
+    size_t tx_end = 0;
+    if (!FindElement(chart, "c:tx", ser.first, ser.second, &tx_begin,
+                     &tx_end)) {
+      continue;
+    }
+    int32_t column = IndexOfLabel(
+        kColumnLabels, NormalizeLabel(TextOf(chart, "c:v", tx_begin, tx_end)));
+    if (column != kColumnKHz && column != kColumnMPa && column != kColumnUm) {
+      continue;
+    }
+    ChartSeries x;
+    ChartSeries y;
+    bool with_x = cache_of(kXTags, ser.first, ser.second, kColumnCycleCount, &x);
+    if (!cache_of(kYTags, ser.first, ser.second, column, &y)) {
+      continue;
+    }
+    if (with_x && x.begin < y.begin) {
+      series.push_back(x);
+    }
+    series.push_back(y);
+    if (with_x && x.begin > y.begin) {
+      series.push_back(x);
+    }
+  }
+  return series;
+}
+
+int32_t DocxReportGenerator::CountRows() {
+  ExperimentData data;
+  int32_t ret = 0;
+  row_count_ = 0;
+  while ((ret = rows_->Next(&data)) > 0) {
+    if ((++row_count_ & 0x3FF) == 0) {
+      if (is_interrupt()) {
+        return -5;
+      }
+      ReportPassProgress();
+    }
+  }
+  if (ret < 0 || rows_->Rewind() != 0) {
+    LOG_F(LG_ERROR) << "read rows failed:" << ret;
+    return -4;
+  }
+  pass_++;
+  return 0;
+}
+
+int32_t DocxReportGenerator::WriteDocument(const std::string& document,
+                                           ZipFileWriter* zip) {
+  /// @note split the template around the data rows. the paragraph of the
+  /// field is replaced by the table, or the rows go after the header of the
+  /// data table of the template. else the table goes to the end of the body
+  /// before the last section properties.
+  std::string head;
+  std::string tail;
+  std::vector<CellMarkup> cells;
+  bool with_table = true;
+  bool appended = false;
+  size_t head_end = 0;
+  size_t tail_begin = 0;
+  size_t field_pos = document.find(kDataTableField);
+  if (field_pos != std::string::npos) {
+    size_t p_start = document.rfind("<w:p>", field_pos);
+    size_t p_attr = document.rfind("<w:p ", field_pos);
+    if (p_start == std::string::npos ||
+        (p_attr != std::string::npos && p_attr > p_start)) {
+      p_start = p_attr;
+    }
+    size_t p_end = document.find("</w:p>", field_pos);
+    if (p_start == std::string::npos || p_end == std::string::npos) {
+      return -2;
+    }
+    head = document.substr(0, p_start);
+    tail = document.substr(p_end + 6);
+  } else if (FindDataTable(document, &head_end, &tail_begin, &cells)) {
+    head = document.substr(0, head_end);
+    tail = document.substr(tail_begin);
+    with_table = false;
+  } else {
+    size_t body_end = document.rfind("</w:body>");
+    if (body_end == std::string::npos) {
+      return -2;
+    }
+    size_t sect = document.rfind("<w:sectPr", body_end);
+    size_t body_start = document.find("<w:body>");
+    size_t split =
+        (sect != std::string::npos && body_start != std::string::npos &&
+         sect > body_start)
+            ? sect
+            : body_end;
+    head = document.substr(0, split);
+    tail = document.substr(split);
+    appended = true;
+  }
+  if (cells.empty()) {
+    for (int32_t column = 0; column < kColumnCount; column++) {
+      cells.push_back({column, kCellStart, kCellEnd});
+    }
+  }
+  int32_t filled = FillFieldCells(&head) + FillFieldCells(&tail);
+  ReplaceFields(&head);
+  ReplaceFields(&tail);
+  /// the template without the summary fields gets the summary table
+  bool with_summary = appended && filled == 0;
+
+  if (zip->BeginEntry(kDocumentPart) != 0) {
+    return -3;
+  }
+  ZipEntrySink sink(zip);
+  XmlStreamWriter xml(&sink);
+  xml.Raw(head);
+  if (with_summary) {
+    WriteMarkup(&xml, kTableStart);
+    for (auto& field : SummaryFields(report_)) {
+      WriteMarkup(&xml, kRowStart);
+      WriteCell(&xml, field.first);
+      WriteCell(&xml, field.second);
+      WriteMarkup(&xml, kRowEnd);
+    }
+    WriteMarkup(&xml, kTableEnd);
+    WriteMarkup(&xml, kEmptyParagraph);
+  }
+  if (with_table) {
+    WriteMarkup(&xml, kTableStart);
+    WriteMarkup(&xml, kHeaderRowStart);
+    for (auto name : kDataTableHeader) {
+      WriteCell(&xml, name, strlen(name));
+    }
+    WriteMarkup(&xml, kRowEnd);
+  }
+  if (rows_->Rewind() != 0) {
+    return -4;
+  }
+  ExperimentData data;
+  std::string row;
+  int32_t ret = 0;
+  int64_t count = 0;
+  while ((ret = rows_->Next(&data)) > 0) {
+    /// @note the numbers need no escape, the row is formatted at once.
+    row.clear();
+    AppendRow(&row, cells, data);
+    xml.Raw(row);
+    if ((++count & 0x3FF) == 0) {
+      if (is_interrupt()) {
+        return -5;
+      }
+      if (xml.status() != 0) {
+        return -3;
+      }
+      ReportPassProgress();
+    }
+  }
+  if (ret < 0) {
+    LOG_F(LG_ERROR) << "read rows failed:" << ret;
+    return -4;
+  }
+  pass_++;
+  if (with_table) {
+    WriteMarkup(&xml, kTableEnd);
+  }
+  if (appended) {
+    /// the body doesn't end with a table
+    WriteMarkup(&xml, kEmptyParagraph);
+  }
+  xml.Raw(tail);
+  if (xml.Flush() != 0 || zip->EndEntry() != 0) {
+    return -3;
+  }
+  return 0;
+}
+
+int32_t DocxReportGenerator::WriteChart(const std::string& name,
+                                        const std::string& chart,
+                                        const std::vector<ChartSeries>& series,
+                                        ZipFileWriter* zip) {
+  if (zip->BeginEntry(name) != 0) {
+    return -3;
+  }
+  ZipEntrySink sink(zip);
+  XmlStreamWriter xml(&sink);
+  ExperimentData data;
+  std::string point;
+  size_t pos = 0;
+  for (auto& cache : series) {
+    xml.Raw(chart.data() + pos, cache.begin - pos);
+    xml.Raw(cache.format_code);
+    point.assign("<c:ptCount val=\"");
+    AppendUnsigned(&point, static_cast<uint64_t>(row_count_));
+    point.append("\"/>");
+    xml.Raw(point);
+    if (rows_->Rewind() != 0) {
+      return -4;
+    }
+    int32_t ret = 0;
+    int64_t index = 0;
+    while (index < row_count_ && (ret = rows_->Next(&data)) > 0) {
+      point.assign("<c:pt idx=\"");
+      AppendUnsigned(&point, static_cast<uint64_t>(index));
+      point.append("\"><c:v>");
+      AppendValue(&point, cache.column, data);
+      point.append("</c:v></c:pt>");
+      xml.Raw(point);
+      if ((++index & 0x3FF) == 0) {
+        if (is_interrupt()) {
+          return -5;
+        }
+        if (xml.status() != 0) {
+          return -3;
+        }
+        ReportPassProgress();
+      }
+    }
+    if (ret < 0) {
+      LOG_F(LG_ERROR) << "read rows failed:" << ret;
+      return -4;
+    }
+    pass_++;
+    pos = cache.end;
+  }
+  xml.Raw(chart.data() + pos, chart.size() - pos);
+  if (xml.Flush() != 0 || zip->EndEntry() != 0) {
+    return -3;
+  }
+  return 0;
+}
+
+int32_t DocxReportGenerator::FillFieldCells(std::string* xml) const {
+  struct Replacement {
+    size_t begin;
+    size_t end;
+    std::string cell;
+  };
+  std::vector<std::pair<std::string, std::string>> fields =
+      SummaryFields(report_);
+  std::vector<Replacement> replacements;
+  for (auto& row : FindElements(*xml, "w:tr", 0, xml->size())) {
+    auto cells = FindElements(*xml, "w:tc", row.first, row.second);
+    std::vector<std::string> labels;
+    for (auto& cell : cells) {
+      labels.push_back(
+          NormalizeLabel(TextOf(*xml, "w:t", cell.first, cell.second)));
+    }
+    for (size_t i = 0; i + 1 < cells.size(); i++) {
+      int32_t field = IndexOfLabel(kFieldLabels, labels[i]);
+      /// the cell next to the label is the value, unless it is a label too,
+      /// e.g. the header of the data table.
+      if (field < 0 || IndexOfLabel(kFieldLabels, labels[i + 1]) >= 0 ||
+          IndexOfLabel(kColumnLabels, labels[i + 1]) >= 0) {
+        continue;
+      }
+      const std::pair<size_t, size_t>& value = cells[i + 1];
+      CellMarkup markup =
+          CellMarkupOf(*xml, value.first, value.second, kColumnNone, true);
+      replacements.push_back(
+          {value.first, value.second,
+           markup.start + EscapeXml(fields[field].second) + markup.end});
+      i++;
+    }
+  }
+  for (auto it = replacements.rbegin(); it != replacements.rend(); ++it) {
+    xml->replace(it->begin, it->end - it->begin, it->cell);
+  }
+  return static_cast<int32_t>(replacements.size());
+}
+
+void DocxReportGenerator::ReplaceFields(std::string* xml) const {
+  for (auto& field : SummaryFields(report_)) {
+    std::string name = "${" + field.first + "}";
+    std::string value = EscapeXml(field.second);
+    size_t pos = 0;
+    while ((pos = xml->find(name, pos)) != std::string::npos) {
+      xml->replace(pos, name.size(), value);
+      pos += value.size();
+    }
+  }
+}
+
+void DocxReportGenerator::ReportPassProgress() {
+  ReportProgress((pass_ * 100 + rows_->Progress()) * 99 / (passes_ * 100));
+}
+
+void DocxReportGenerator::ReportProgress(int32_t percent) {
+  if (percent == percent_) {
+    return;
+  }
+  percent_ = percent;
+  if (listener_ != nullptr) {
+    listener_->OnReportProgress(percent);
+  }
+}
+
+}  // namespace expdata
+}  // namespace anx
@@ -0,0 +1,205 @@
+/**
+ * @file docx_report.h
+ * @author hhool (hhool@outlook.com)
+ * @brief in process docx report generator. the report template package is
+ * opened with zlib, the summary fields and the data table are streamed into
+ * word/document.xml and the report is written in one pass.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_EXPDATA_DOCX_REPORT_H_
+#define APP_EXPDATA_DOCX_REPORT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/expdata/experiment_data_base.h"
+
+namespace anx {
+namespace expdata {
+
+class ZipFileWriter;
+
+/// @brief the rows of the report data table
+class ReportRowSource {
+ public:
+  ReportRowSource() = default;
+  virtual ~ReportRowSource() = default;
+
+  /// @brief Read the next row
+  /// @param data the row
+  /// @return 1 if a row is read, 0 if no more rows, < 0 if failed
+  virtual int32_t Next(ExperimentData* data) = 0;
+
+  /// @brief Get the progress of the rows read
+  /// @return 0 - 100
+  virtual int32_t Progress() = 0;
+
+  /// @brief Rewind to the first row, the rows are read again for the series
+  /// of the charts.
+  /// @return 0 if success, < 0 if failed
+  virtual int32_t Rewind() = 0;
+};
+
+/// @brief the rows in memory
+class VectorRowSource : public ReportRowSource {
+ public:
+  explicit VectorRowSource(const std::vector<ExperimentData>* exp_data);
+  ~VectorRowSource() override;
+
+  int32_t Next(ExperimentData* data) override;
+  int32_t Progress() override;
+  int32_t Rewind() override;
+
+ private:
+  const std::vector<ExperimentData>* exp_data_;
+  size_t index_;
+};
+
+/// @brief the rows of the csv file written by
+/// SaveExperimentDataToCsvWithDefaultPath, read line by line.
+class CsvRowSource : public ReportRowSource {
+ public:
+  CsvRowSource();
+  ~CsvRowSource() override;
+
+  /// @brief Open the csv file and skip the header line
+  /// @return 0 if success, -1 if the file can't be opened
+  int32_t Open(const std::string& file_pathname);
+
+  int32_t Next(ExperimentData* data) override;
+  int32_t Progress() override;
+  int32_t Rewind() override;
+
+ private:
+  /// @brief Skip the header line
+  void SkipHeader();
+
+ private:
+  FILE* file_;
+  int64_t file_size_;
+  int64_t read_size_;
+};
+
+/// @brief the progress and result of the report generation, the callbacks
+/// are called on the generating thread.
+class DocxReportListener {
+ public:
+  DocxReportListener() = default;
+  virtual ~DocxReportListener() = default;
+
+  /// @brief On the progress changed
+  /// @param percent 0 - 100
+  virtual void OnReportProgress(int32_t percent) = 0;
+
+  /// @brief On the report finished, see DocxReportGenerator::Generate
+  virtual void OnReportFinished(int32_t result,
+                                const std::string& file_pathname) = 0;
+};
+
+/// @brief generate the docx report from the template.
+/// the summary is filled into the tables of word/document.xml by the labels,
+/// the value goes to the cell next to the label cell, e.g. 开始时间, 结束时间,
+/// 试验名称, 弹性模量, 密度, 最大应力, 应力比, 循环次数 and 底部振幅, the
+/// units in the brackets and the colons of the labels are ignored. the
+/// fields as ${StartTime}, ${ExperimentName}, ${CycleCount} ... are replaced
+/// too.
+/// the rows go to the table of the template with the header of the data
+/// columns, e.g. 循环次数 and 频率(kHz), the rows after the header are the
+/// style of the rows. or the paragraph with ${ExpDataTable} is replaced by
+/// the data table. else the summary and the data table are appended to the
+/// body.
+/// the series of the charts word/charts/chartN.xml named by the data columns
+/// are streamed from the rows as the table, the x values are the cycle
+/// counts. the other parts of the template are copied without recompress.
+class DocxReportGenerator : public anx::common::Runnable {
+ public:
+  /// @brief Constructor
+  /// @param template_pathname the docx template file path name
+  /// @param report the experiment report
+  /// @param rows the rows of the data table
+  /// @param file_pathname the docx file path name to write
+  DocxReportGenerator(const std::string& template_pathname,
+                      const ExperimentReport& report,
+                      std::unique_ptr<ReportRowSource> rows,
+                      const std::string& file_pathname);
+  ~DocxReportGenerator() override;
+
+ public:
+  /// @brief Set the listener, must be set before Generate or Start
+  void set_listener(DocxReportListener* listener) { listener_ = listener; }
+
+  /// @brief Generate the report on the calling thread
+  /// @return 0 if success, -1 if the template can't be read, -2 if the
+  /// template is not a docx package, -3 if the report can't be written,
+  /// -4 if the rows read failed, -5 if canceled
+  int32_t Generate();
+
+  /// @brief Generate the report on a worker thread, the result is reported
+  /// by DocxReportListener::OnReportFinished
+  void Start();
+
+  /// @brief Wait for the worker thread
+  void Join();
+
+  /// @brief Cancel the generation, the partial file is removed
+  void interrupt() override { canceled_ = true; }
+  bool is_interrupt() override { return canceled_; }
+
+  /// @brief Get the result of the last generation
+  int32_t result() const { return result_; }
+
+ protected:
+  void run() override;
+
+ private:
+  struct ChartSeries;
+
+  /// @brief Get the caches of the series of the chart named by the data
+  /// columns, in the order of the chart.
+  static std::vector<ChartSeries> ChartSeriesOf(const std::string& chart);
+  int32_t WriteDocument(const std::string& document, ZipFileWriter* zip);
+  /// @brief Write the chart part with the series streamed from the rows
+  int32_t WriteChart(const std::string& name,
+                     const std::string& chart,
+                     const std::vector<ChartSeries>& series,
+                     ZipFileWriter* zip);
+  /// @brief Count the rows for the points of the series
+  int32_t CountRows();
+  /// @brief Fill the summary into the cells next to the labels
+  /// @return the count of the fields filled
+  int32_t FillFieldCells(std::string* xml) const;
+  void ReplaceFields(std::string* xml) const;
+  /// @brief Report the progress of the rows of the current pass
+  void ReportPassProgress();
+  void ReportProgress(int32_t percent);
+
+ private:
+  std::string template_pathname_;
+  ExperimentReport report_;
+  std::unique_ptr<ReportRowSource> rows_;
+  std::string file_pathname_;
+  DocxReportListener* listener_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  std::atomic<bool> canceled_;
+  std::atomic<int32_t> result_;
+  int32_t percent_;
+  /// @brief the passes over the rows, the table and the series of the charts
+  int32_t passes_;
+  int32_t pass_;
+  int64_t row_count_;
+};
+
+}  // namespace expdata
+}  // namespace anx
+
+#endif  // APP_EXPDATA_DOCX_REPORT_H_
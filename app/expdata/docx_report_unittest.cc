@@ -0,0 +1,316 @@
+/**
+ * @file docx_report_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief docx report generator unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "app/common/file_utils.h"
+#include "app/common/module_utils.h"
+#include "app/expdata/docx_report.h"
+#include "app/expdata/experiment_data_base.h"
+#include "app/expdata/xml_stream_writer.h"
+#include "app/expdata/zip_file.h"
+
+namespace anx {
+namespace expdata {
+
+namespace {
+const char kContentTypes[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
+    "<Types "
+    "xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+    "<Override PartName=\"/word/document.xml\" "
+    "ContentType=\"application/"
+    "vnd.openxmlformats-officedocument.wordprocessingml.document.main+xml\"/>"
+    "</Types>";
+const char kDocumentHead[] =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
+    "<w:document "
+    "xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\">"
+    "<w:body>";
+const char kDocumentTail[] =
+    "<w:sectPr><w:pgSz w:w=\"11906\" w:h=\"16838\"/></w:sectPr>"
+    "</w:body></w:document>";
+
+class StringSink : public XmlStreamSink {
+ public:
+  int32_t Write(const char* data, size_t size) override {
+    data_.append(data, size);
+    writes_++;
+    return 0;
+  }
+  std::string data_;
+  int32_t writes_ = 0;
+};
+
+class TestListener : public DocxReportListener {
+ public:
+  void OnReportProgress(int32_t percent) override {
+    progress_.push_back(percent);
+  }
+  void OnReportFinished(int32_t result,
+                        const std::string& file_pathname) override {
+    result_ = result;
+    file_pathname_ = file_pathname;
+  }
+  std::vector<int32_t> progress_;
+  int32_t result_ = 1;
+  std::string file_pathname_;
+};
+}  // namespace
+
+class DocxReportTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    folder_ = anx::common::GetModuleDir() + anx::common::kPathSeparator +
+              "expdata_unittest";
+    anx::common::MakeSureFolderPathExist(FileName("x"));
+    report_.start_time_ = 1723348800;
+    report_.end_time_ = 1723352400;
+    report_.experiment_name_ = "fatigue <A&B>";
+    report_.max_stress_ = 200;
+    report_.cycle_count_ = 1000000;
+    for (uint64_t i = 1; i <= 5000; i++) {
+      ExperimentData data;
+      data.id_ = i;
+      data.cycle_count_ = i * 1000;
+      data.KHz_ = 20.0 + i * 0.0001;
+      data.MPa_ = 100.5;
+      data.um_ = 12.25;
+      exp_data_.push_back(data);
+    }
+  }
+
+  std::string FileName(const std::string& name) {
+    return folder_ + anx::common::kPathSeparator + name;
+  }
+
+  void WriteTemplate(const std::string& file_pathname,
+                     const std::string& body) {
+    ZipFileWriter writer;
+    ASSERT_EQ(writer.Open(file_pathname), 0);
+    ASSERT_EQ(writer.AddEntry("[Content_Types].xml", kContentTypes), 0);
+    ASSERT_EQ(writer.AddEntry("word/document.xml",
+                              kDocumentHead + body + kDocumentTail),
+              0);
+    ASSERT_EQ(writer.AddEntry("word/media/logo.bin", std::string(100, 'x')),
+              0);
+    ASSERT_EQ(writer.Close(), 0);
+  }
+
+  std::string ReadDocument(const std::string& file_pathname) {
+    ZipFileReader reader;
+    std::string document;
+    EXPECT_EQ(reader.Open(file_pathname), 0);
+    EXPECT_EQ(reader.entries().size(), 3u);
+    const ZipEntry* entry = reader.FindEntry("word/document.xml");
+    EXPECT_NE(entry, nullptr);
+    if (entry != nullptr) {
+      EXPECT_EQ(reader.ReadEntry(*entry, &document), 0);
+    }
+    return document;
+  }
+
+  std::string folder_;
+  ExperimentReport report_;
+  std::vector<ExperimentData> exp_data_;
+};
+
+TEST(XmlStreamWriterTest, Escape) {
+  StringSink sink;
+  XmlStreamWriter xml(&sink, 16);
+  xml.StartElement("a");
+  xml.Attribute("v", "1\"<2>&");
+  xml.StartElement("b");
+  xml.EndElement();
+  xml.Element("c", "x<y&z>");
+  xml.EndElement();
+  EXPECT_EQ(xml.depth(), 0u);
+  EXPECT_EQ(xml.Flush(), 0);
+  EXPECT_EQ(sink.data_,
+            "<a v=\"1&quot;&lt;2&gt;&amp;\"><b/><c>x&lt;y&amp;z&gt;</c></a>");
+  EXPECT_GT(sink.writes_, 1);
+}
+
+TEST_F(DocxReportTest, GenerateWithFields) {
+  std::string template_pathname = FileName("fields_template.docx");
+  std::string file_pathname = FileName("fields.docx");
+  WriteTemplate(template_pathname,
+                "<w:p><w:r><w:t>${ExperimentName} ${CycleCount}</w:t></w:r>"
+                "</w:p><w:p w:rsidR=\"1\"><w:r><w:t>${ExpDataTable}</w:t>"
+                "</w:r></w:p><w:p><w:r><w:t>${MaxStress}</w:t></w:r></w:p>");
+  std::unique_ptr<ReportRowSource> rows(new VectorRowSource(&exp_data_));
+  DocxReportGenerator generator(template_pathname, report_, std::move(rows),
+                                file_pathname);
+  TestListener listener;
+  generator.set_listener(&listener);
+  ASSERT_EQ(generator.Generate(), 0);
+  ASSERT_FALSE(listener.progress_.empty());
+  EXPECT_EQ(listener.progress_.back(), 100);
+
+  std::string document = ReadDocument(file_pathname);
+  EXPECT_NE(document.find("fatigue &lt;A&amp;B&gt; 1000000"),
+            std::string::npos);
+  EXPECT_NE(document.find("<w:t>200</w:t>"), std::string::npos);
+  EXPECT_EQ(document.find("${"), std::string::npos);
+  EXPECT_EQ(document.find("w:rsidR"), std::string::npos);
+  EXPECT_NE(document.find("<w:t>5000000</w:t>"), std::string::npos);
+  EXPECT_NE(document.find("<w:t>20.500</w:t>"), std::string::npos);
+  EXPECT_NE(document.find("<w:t>100.500000</w:t>"), std::string::npos);
+  EXPECT_NE(document.find("<w:t>12.25</w:t>"), std::string::npos);
+  /// the table comes before the paragraph after the field
+  EXPECT_LT(document.find("</w:tbl>"), document.rfind("<w:t>200</w:t>"));
+  anx::common::RemoveFile(template_pathname);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(DocxReportTest, GenerateAppendToBody) {
+  std::string template_pathname = FileName("append_template.docx");
+  std::string csv_pathname = FileName("append.csv");
+  std::string file_pathname = FileName("append.docx");
+  WriteTemplate(template_pathname, "<w:p><w:r><w:t>report</w:t></w:r></w:p>");
+  ASSERT_TRUE(anx::common::WriteFile(
+      csv_pathname,
+      "id,cycle_count,KHz,MPa,μm\n1,100,20.100,150.000000,3.50\n"
+      "2,200,20.200,151.000000,3.60\n",
+      true));
+  std::unique_ptr<CsvRowSource> rows(new CsvRowSource());
+  ASSERT_EQ(rows->Open(csv_pathname), 0);
+  DocxReportGenerator generator(template_pathname, report_, std::move(rows),
+                                file_pathname);
+  TestListener listener;
+  generator.set_listener(&listener);
+  generator.Start();
+  generator.Join();
+  EXPECT_EQ(listener.result_, 0);
+  EXPECT_EQ(listener.file_pathname_, file_pathname);
+
+  std::string document = ReadDocument(file_pathname);
+  EXPECT_NE(document.find("<w:t>ExperimentName</w:t>"), std::string::npos);
+  EXPECT_NE(document.find("<w:t>151.000000</w:t>"), std::string::npos);
+  /// the section properties stay the last element of the body
+  EXPECT_LT(document.rfind("</w:tbl>"), document.find("<w:sectPr>"));
+  anx::common::RemoveFile(template_pathname);
+  anx::common::RemoveFile(csv_pathname);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(DocxReportTest, GenerateIntoTemplateTables) {
+  std::string template_pathname = FileName("tables_template.docx");
+  std::string file_pathname = FileName("tables.docx");
+  const char kChart[] =
+      "<c:chartSpace><c:chart><c:plotArea><c:scatterChart><c:ser>"
+      "<c:tx><c:strRef><c:f>Sheet1!$B$1</c:f><c:strCache><c:ptCount val=\"1\"/>"
+      "<c:pt idx=\"0\"><c:v>频率(kHz)</c:v></c:pt></c:strCache></c:strRef>"
+      "</c:tx><c:xVal><c:numRef><c:f>Sheet1!$A$2:$A$3</c:f><c:numCache>"
+      "<c:formatCode>General</c:formatCode><c:ptCount val=\"2\"/>"
+      "<c:pt idx=\"0\"><c:v>1</c:v></c:pt></c:numCache></c:numRef></c:xVal>"
+      "<c:yVal><c:numRef><c:f>Sheet1!$B$2:$B$3</c:f><c:numCache>"
+      "<c:formatCode>General</c:formatCode><c:ptCount val=\"2\"/>"
+      "<c:pt idx=\"0\"><c:v>2</c:v></c:pt></c:numCache></c:numRef></c:yVal>"
+      "</c:ser></c:scatterChart><c:valAx/></c:plotArea></c:chart>"
+      "</c:chartSpace>";
+  {
+    ZipFileWriter writer;
+    ASSERT_EQ(writer.Open(template_pathname), 0);
+    ASSERT_EQ(writer.AddEntry("[Content_Types].xml", kContentTypes), 0);
+    ASSERT_EQ(writer.AddEntry("word/charts/chart1.xml", kChart), 0);
+    ASSERT_EQ(
+        writer.AddEntry(
+            "word/document.xml",
+            std::string(kDocumentHead) +
+                "<w:tbl><w:tr><w:tc><w:p><w:r><w:t>试验名称：</w:t></w:r></w:p>"
+                "</w:tc><w:tc><w:tcPr><w:tcW w:w=\"3000\"/></w:tcPr><w:p/>"
+                "</w:tc><w:tc><w:p><w:r><w:t>最大应力(MPa)</w:t></w:r></w:p>"
+                "</w:tc><w:tc><w:p><w:r><w:t>-</w:t></w:r></w:p></w:tc>"
+                "</w:tr></w:tbl>"
+                "<w:tbl><w:tr><w:tc><w:p><w:r><w:t>循环次数</w:t></w:r></w:p>"
+                "</w:tc><w:tc><w:p><w:r><w:t>频率 (kHz)</w:t></w:r></w:p>"
+                "</w:tc><w:tc><w:p><w:r><w:t>振幅(μm)</w:t></w:r></w:p>"
+                "</w:tc></w:tr><w:tr><w:tc><w:p><w:pPr><w:jc "
+                "w:val=\"center\"/></w:pPr><w:r><w:rPr><w:sz w:val=\"18\"/>"
+                "</w:rPr><w:t>0</w:t></w:r></w:p></w:tc><w:tc><w:p/></w:tc>"
+                "<w:tc><w:p/></w:tc></w:tr></w:tbl><w:p/>" +
+                kDocumentTail),
+        0);
+    ASSERT_EQ(writer.Close(), 0);
+  }
+  std::unique_ptr<ReportRowSource> rows(new VectorRowSource(&exp_data_));
+  DocxReportGenerator generator(template_pathname, report_, std::move(rows),
+                                file_pathname);
+  TestListener listener;
+  generator.set_listener(&listener);
+  ASSERT_EQ(generator.Generate(), 0);
+  EXPECT_EQ(listener.progress_.back(), 100);
+  for (size_t i = 1; i < listener.progress_.size(); i++) {
+    EXPECT_GE(listener.progress_[i], listener.progress_[i - 1]);
+  }
+
+  ZipFileReader reader;
+  ASSERT_EQ(reader.Open(file_pathname), 0);
+  std::string document;
+  ASSERT_EQ(reader.ReadEntry(*reader.FindEntry("word/document.xml"), &document),
+            0);
+  /// the values go to the cells next to the labels with their properties
+  EXPECT_NE(document.find("<w:tcPr><w:tcW w:w=\"3000\"/></w:tcPr><w:p><w:r>"
+                          "<w:t>fatigue &lt;A&amp;B&gt;</w:t>"),
+            std::string::npos);
+  EXPECT_NE(document.find("<w:t>200</w:t>"), std::string::npos);
+  EXPECT_EQ(document.find("<w:t>-</w:t>"), std::string::npos);
+  /// the rows take the style of the row after the header, no table appended
+  EXPECT_EQ(document.find("<w:t>ExperimentName</w:t>"), std::string::npos);
+  EXPECT_EQ(document.find("<w:t>0</w:t>"), std::string::npos);
+  EXPECT_NE(document.find("<w:tr><w:tc><w:p><w:pPr><w:jc w:val=\"center\"/>"
+                          "</w:pPr><w:r><w:rPr><w:sz w:val=\"18\"/></w:rPr>"
+                          "<w:t>5000000</w:t></w:r></w:p></w:tc><w:tc><w:p>"
+                          "<w:r><w:t>20.500</w:t></w:r></w:p></w:tc><w:tc>"
+                          "<w:p><w:r><w:t>12.25</w:t></w:r></w:p></w:tc></w:tr>"
+                          "</w:tbl>"),
+            std::string::npos);
+  EXPECT_EQ(document.find("100.500000"), std::string::npos);
+
+  /// the series are streamed from the rows
+  std::string chart;
+  ASSERT_EQ(reader.ReadEntry(*reader.FindEntry("word/charts/chart1.xml"),
+                             &chart),
+            0);
+  EXPECT_NE(chart.find("<c:numCache><c:formatCode>General</c:formatCode>"
+                       "<c:ptCount val=\"5000\"/><c:pt idx=\"0\"><c:v>1000"
+                       "</c:v></c:pt>"),
+            std::string::npos);
+  EXPECT_NE(chart.find("<c:pt idx=\"4999\"><c:v>5000000</c:v></c:pt>"
+                       "</c:numCache>"),
+            std::string::npos);
+  EXPECT_NE(chart.find("<c:pt idx=\"4999\"><c:v>20.500</c:v></c:pt>"
+                       "</c:numCache></c:numRef></c:yVal>"),
+            std::string::npos);
+  EXPECT_NE(chart.find("<c:v>频率(kHz)</c:v>"), std::string::npos);
+  EXPECT_NE(chart.find("</c:ser></c:scatterChart><c:valAx/>"),
+            std::string::npos);
+  anx::common::RemoveFile(template_pathname);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(DocxReportTest, GenerateInvalidTemplate) {
+  std::string file_pathname = FileName("invalid.docx");
+  std::unique_ptr<ReportRowSource> rows(new VectorRowSource(&exp_data_));
+  DocxReportGenerator generator(FileName("none.docx"), report_,
+                                std::move(rows), file_pathname);
+  EXPECT_EQ(generator.Generate(), -1);
+  EXPECT_FALSE(anx::common::FileExists(file_pathname));
+}
+
+}  // namespace expdata
+}  // namespace anx
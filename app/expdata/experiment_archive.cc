@@ -0,0 +1,1114 @@
+/**
+ * @file experiment_archive.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief compressed archive of the finished experiment data.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/expdata/experiment_archive.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "app/common/file_utils.h"
+#include "app/common/logger.h"
+#include "app/common/time_utils.h"
+#include "app/db/database_cursor.h"
+#include "app/db/database_helper.h"
+
+namespace anx {
+namespace expdata {
+
+const char* kExperimentArchiveExtension = ".anxa";
+
+namespace {
+
+/// @note file layout, all the numbers are little endian.
+/// header: magic "ANXA", u16 version, u16 reserved
+/// blocks: the deflated column blocks of the chunks
+/// index: u32 table count, per table: str name, u16 column count, per column:
+///   str name, u8 type; u64 row count, u32 chunk count, per chunk: u64 first
+///   row, u32 row count, per column: u64 offset, u32 compressed size, u32 raw
+///   size, u32 crc32, f64 min, f64 max
+/// trailer: u64 index offset, u32 index size, u32 index crc32, magic "ANXA"
+const char kMagic[4] = {'A', 'N', 'X', 'A'};
+const uint16_t kVersion = 1;
+const size_t kHeaderSize = 8;
+const size_t kTrailerSize = 20;
+
+const char* kArchiveTables[] = {"exp_data_graph", "exp_data_list"};
+
+/// @brief Get the columns of the table from the schema of the database
+/// @return true if success, the columns are empty if the table not exists
+bool TableColumns(const std::string& db_filepathname,
+                  const std::string& table_name,
+                  std::vector<ArchiveColumn>* columns) {
+  std::string sql_str = "PRAGMA table_info(" + table_name + ");";
+  std::vector<std::map<std::string, std::string>> result;
+  if (!anx::db::helper::QueryDataBase(db_filepathname, table_name, sql_str,
+                                      &result)) {
+    return false;
+  }
+  columns->clear();
+  for (auto& row : result) {
+    ArchiveColumn::Type type = row["type"] == "INTEGER"
+                                   ? ArchiveColumn::kInteger
+                                   : ArchiveColumn::kReal;
+    columns->push_back(ArchiveColumn(row["name"], type));
+  }
+  return true;
+}
+
+void PutU8(std::vector<uint8_t>* out, uint8_t value) {
+  out->push_back(value);
+}
+
+void PutU16(std::vector<uint8_t>* out, uint16_t value) {
+  for (int32_t i = 0; i < 2; i++) {
+    out->push_back(static_cast<uint8_t>(value >> (i * 8)));
+  }
+}
+
+void PutU32(std::vector<uint8_t>* out, uint32_t value) {
+  for (int32_t i = 0; i < 4; i++) {
+    out->push_back(static_cast<uint8_t>(value >> (i * 8)));
+  }
+}
+
+void PutU64(std::vector<uint8_t>* out, uint64_t value) {
+  for (int32_t i = 0; i < 8; i++) {
+    out->push_back(static_cast<uint8_t>(value >> (i * 8)));
+  }
+}
+
+void PutF64(std::vector<uint8_t>* out, double value) {
+  uint64_t bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  PutU64(out, bits);
+}
+
+void PutString(std::vector<uint8_t>* out, const std::string& value) {
+  PutU16(out, static_cast<uint16_t>(value.size()));
+  out->insert(out->end(), value.begin(), value.end());
+}
+
+void PutVarint(std::vector<uint8_t>* out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+/// @brief bounds checked reader of a byte buffer
+class ByteReader {
+ public:
+  ByteReader(const uint8_t* data, size_t size)
+      : data_(data), size_(size), pos_(0), failed_(false) {}
+
+  bool failed() const { return failed_; }
+  bool eof() const { return pos_ >= size_; }
+
+  uint64_t Get(int32_t bytes) {
+    if (failed_ || size_ - pos_ < static_cast<size_t>(bytes)) {
+      failed_ = true;
+      return 0;
+    }
+    uint64_t value = 0;
+    for (int32_t i = 0; i < bytes; i++) {
+      value |= static_cast<uint64_t>(data_[pos_ + i]) << (i * 8);
+    }
+    pos_ += bytes;
+    return value;
+  }
+  uint8_t GetU8() { return static_cast<uint8_t>(Get(1)); }
+  uint16_t GetU16() { return static_cast<uint16_t>(Get(2)); }
+  uint32_t GetU32() { return static_cast<uint32_t>(Get(4)); }
+  uint64_t GetU64() { return Get(8); }
+  double GetF64() {
+    uint64_t bits = GetU64();
+    double value = 0.0;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+  std::string GetString() {
+    uint16_t size = GetU16();
+    if (failed_ || size_ - pos_ < size) {
+      failed_ = true;
+      return std::string();
+    }
+    std::string value(reinterpret_cast<const char*>(data_ + pos_), size);
+    pos_ += size;
+    return value;
+  }
+  uint64_t GetVarint() {
+    uint64_t value = 0;
+    for (int32_t shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= size_) {
+        break;
+      }
+      uint8_t byte = data_[pos_++];
+      value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    failed_ = true;
+    return 0;
+  }
+
+ private:
+  const uint8_t* data_;
+  size_t size_;
+  size_t pos_;
+  bool failed_;
+};
+
+uint64_t ZigZag(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t UnZigZag(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/// @brief integers are stored as zigzag varint of the delta to the previous
+/// value, ids and cycles grow by a nearly constant step and deflate well.
+void EncodeIntegers(const std::vector<int64_t>& values,
+                    std::vector<uint8_t>* out) {
+  int64_t pre = 0;
+  for (auto value : values) {
+    PutVarint(out, ZigZag(static_cast<int64_t>(static_cast<uint64_t>(value) -
+                                               static_cast<uint64_t>(pre))));
+    pre = value;
+  }
+}
+
+bool DecodeIntegers(const std::vector<uint8_t>& raw,
+                    uint32_t count,
+                    std::vector<int64_t>* values) {
+  ByteReader reader(raw.data(), raw.size());
+  int64_t pre = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    uint64_t delta = static_cast<uint64_t>(UnZigZag(reader.GetVarint()));
+    pre = static_cast<int64_t>(static_cast<uint64_t>(pre) + delta);
+    values->push_back(pre);
+  }
+  return !reader.failed() && reader.eof();
+}
+
+/// @brief reals are xored with the previous value, the sign, exponent and
+/// high mantissa bits of slow changing samples cancel out. the xored words
+/// are split into byte planes, most significant plane first, so the zero
+/// bytes form long runs for deflate.
+void EncodeReals(const std::vector<double>& values,
+                 std::vector<uint8_t>* out) {
+  size_t count = values.size();
+  std::vector<uint64_t> xored(count);
+  uint64_t pre = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint64_t bits = 0;
+    memcpy(&bits, &values[i], sizeof(bits));
+    xored[i] = bits ^ pre;
+    pre = bits;
+  }
+  size_t base = out->size();
+  out->resize(base + count * 8);
+  for (int32_t plane = 0; plane < 8; plane++) {
+    int32_t shift = (7 - plane) * 8;
+    uint8_t* dst = out->data() + base + plane * count;
+    for (size_t i = 0; i < count; i++) {
+      dst[i] = static_cast<uint8_t>(xored[i] >> shift);
+    }
+  }
+}
+
+bool DecodeReals(const std::vector<uint8_t>& raw,
+                 uint32_t count,
+                 std::vector<double>* values) {
+  if (raw.size() != static_cast<size_t>(count) * 8) {
+    return false;
+  }
+  uint64_t pre = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    uint64_t xored = 0;
+    for (int32_t plane = 0; plane < 8; plane++) {
+      xored = (xored << 8) | raw[plane * count + i];
+    }
+    uint64_t bits = xored ^ pre;
+    pre = bits;
+    double value = 0.0;
+    memcpy(&value, &bits, sizeof(value));
+    values->push_back(value);
+  }
+  return true;
+}
+
+int32_t SeekFile(FILE* file, uint64_t offset) {
+#if defined(_WIN32) || defined(_WIN64)
+  return _fseeki64(file, static_cast<int64_t>(offset), SEEK_SET);
+#else
+  return fseeko(file, static_cast<off_t>(offset), SEEK_SET);
+#endif
+}
+
+int64_t FileSize(FILE* file) {
+#if defined(_WIN32) || defined(_WIN64)
+  if (_fseeki64(file, 0, SEEK_END) != 0) {
+    return -1;
+  }
+  return _ftelli64(file);
+#else
+  if (fseeko(file, 0, SEEK_END) != 0) {
+    return -1;
+  }
+  return static_cast<int64_t>(ftello(file));
+#endif
+}
+
+bool ReadAt(FILE* file,
+            uint64_t offset,
+            size_t size,
+            std::vector<uint8_t>* out) {
+  out->resize(size);
+  if (SeekFile(file, offset) != 0) {
+    return false;
+  }
+  return size == 0 || fread(out->data(), 1, size, file) == size;
+}
+
+uint32_t Crc32(const std::vector<uint8_t>& bytes) {
+  return static_cast<uint32_t>(
+      crc32(crc32(0L, Z_NULL, 0), bytes.data(),
+            static_cast<uInt>(bytes.size())));
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ArchiveColumn
+ArchiveColumn::ArchiveColumn() : type_(kReal) {}
+
+ArchiveColumn::ArchiveColumn(const std::string& name, Type type)
+    : name_(name), type_(type) {}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ArchiveValue
+ArchiveValue::ArchiveValue() : integer_(0), real_(0.0) {}
+
+ArchiveValue::ArchiveValue(int32_t value)
+    : integer_(value), real_(static_cast<double>(value)) {}
+
+ArchiveValue::ArchiveValue(int64_t value)
+    : integer_(value), real_(static_cast<double>(value)) {}
+
+ArchiveValue::ArchiveValue(double value)
+    : integer_(static_cast<int64_t>(value)), real_(value) {}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ArchiveColumnData
+ArchiveColumnData::ArchiveColumnData() : type_(ArchiveColumn::kReal) {}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ArchiveBlock
+ArchiveBlock::ArchiveBlock()
+    : offset_(0),
+      compressed_size_(0),
+      raw_size_(0),
+      crc32_(0),
+      min_(0.0),
+      max_(0.0) {}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ArchiveChunk
+ArchiveChunk::ArchiveChunk() : first_row_(0), row_count_(0) {}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ArchiveTable
+ArchiveTable::ArchiveTable() : row_count_(0) {}
+
+int32_t ArchiveTable::ColumnIndex(const std::string& name) const {
+  for (size_t i = 0; i < columns_.size(); i++) {
+    if (columns_[i].name_ == name) {
+      return static_cast<int32_t>(i);
+    }
+  }
+  return -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ExperimentArchiveWriter
+const uint32_t ExperimentArchiveWriter::kDefaultChunkRows;
+
+ExperimentArchiveWriter::ExperimentArchiveWriter(uint32_t chunk_rows,
+                                                 int32_t level)
+    : chunk_rows_(chunk_rows > 0 ? chunk_rows : kDefaultChunkRows),
+      level_(level),
+      file_(nullptr),
+      offset_(0),
+      pending_rows_(0) {}
+
+ExperimentArchiveWriter::~ExperimentArchiveWriter() {
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+int32_t ExperimentArchiveWriter::Open(const std::string& file_pathname) {
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+  if (!anx::common::MakeSureFolderPathExist(file_pathname)) {
+    LOG_F(LG_ERROR) << "Failed to make sure folder path exist: "
+                    << file_pathname;
+    return -1;
+  }
+  file_ = fopen(file_pathname.c_str(), "wb");
+  if (file_ == nullptr) {
+    LOG_F(LG_ERROR) << "Failed to open file: " << file_pathname;
+    return -1;
+  }
+  tables_.clear();
+  pending_rows_ = 0;
+  offset_ = 0;
+  std::vector<uint8_t> header(kMagic, kMagic + sizeof(kMagic));
+  PutU16(&header, kVersion);
+  PutU16(&header, 0);
+  return WriteBytes(header) == 0 ? 0 : -1;
+}
+
+int32_t ExperimentArchiveWriter::BeginTable(
+    const std::string& name,
+    const std::vector<ArchiveColumn>& columns) {
+  if (file_ == nullptr) {
+    return -1;
+  }
+  if (columns.empty() || columns.size() > 0xFFFF) {
+    return -2;
+  }
+  if (FlushChunk() != 0) {
+    return -3;
+  }
+  ArchiveTable table;
+  table.name_ = name;
+  table.columns_ = columns;
+  tables_.push_back(table);
+  integers_.assign(columns.size(), std::vector<int64_t>());
+  reals_.assign(columns.size(), std::vector<double>());
+  pending_rows_ = 0;
+  return 0;
+}
+
+int32_t ExperimentArchiveWriter::AppendRow(
+    const std::vector<ArchiveValue>& row) {
+  if (file_ == nullptr || tables_.empty()) {
+    return -1;
+  }
+  const ArchiveTable& table = tables_.back();
+  if (row.size() != table.columns_.size()) {
+    return -2;
+  }
+  for (size_t i = 0; i < row.size(); i++) {
+    if (table.columns_[i].type_ == ArchiveColumn::kInteger) {
+      integers_[i].push_back(row[i].integer_);
+    } else {
+      reals_[i].push_back(row[i].real_);
+    }
+  }
+  pending_rows_++;
+  if (pending_rows_ >= chunk_rows_) {
+    return FlushChunk();
+  }
+  return 0;
+}
+
+int32_t ExperimentArchiveWriter::Close() {
+  if (file_ == nullptr) {
+    return -1;
+  }
+  int32_t ret = FlushChunk();
+  std::vector<uint8_t> index;
+  PutU32(&index, static_cast<uint32_t>(tables_.size()));
+  for (auto& table : tables_) {
+    PutString(&index, table.name_);
+    PutU16(&index, static_cast<uint16_t>(table.columns_.size()));
+    for (auto& column : table.columns_) {
+      PutString(&index, column.name_);
+      PutU8(&index, static_cast<uint8_t>(column.type_));
+    }
+    PutU64(&index, table.row_count_);
+    PutU32(&index, static_cast<uint32_t>(table.chunks_.size()));
+    for (auto& chunk : table.chunks_) {
+      PutU64(&index, chunk.first_row_);
+      PutU32(&index, chunk.row_count_);
+      for (auto& block : chunk.blocks_) {
+        PutU64(&index, block.offset_);
+        PutU32(&index, block.compressed_size_);
+        PutU32(&index, block.raw_size_);
+        PutU32(&index, block.crc32_);
+        PutF64(&index, block.min_);
+        PutF64(&index, block.max_);
+      }
+    }
+  }
+  std::vector<uint8_t> trailer;
+  PutU64(&trailer, offset_);
+  PutU32(&trailer, static_cast<uint32_t>(index.size()));
+  PutU32(&trailer, Crc32(index));
+  trailer.insert(trailer.end(), kMagic, kMagic + sizeof(kMagic));
+  if (ret == 0 && (WriteBytes(index) != 0 || WriteBytes(trailer) != 0)) {
+    ret = -3;
+  }
+  if (fclose(file_) != 0 && ret == 0) {
+    ret = -3;
+  }
+  file_ = nullptr;
+  tables_.clear();
+  return ret;
+}
+
+int32_t ExperimentArchiveWriter::FlushChunk() {
+  if (tables_.empty() || pending_rows_ == 0) {
+    return 0;
+  }
+  ArchiveTable& table = tables_.back();
+  ArchiveChunk chunk;
+  chunk.first_row_ = table.row_count_;
+  chunk.row_count_ = pending_rows_;
+  std::vector<uint8_t> raw;
+  std::vector<uint8_t> compressed;
+  for (size_t i = 0; i < table.columns_.size(); i++) {
+    ArchiveBlock block;
+    raw.clear();
+    if (table.columns_[i].type_ == ArchiveColumn::kInteger) {
+      auto& values = integers_[i];
+      auto minmax = std::minmax_element(values.begin(), values.end());
+      block.min_ = static_cast<double>(*minmax.first);
+      block.max_ = static_cast<double>(*minmax.second);
+      EncodeIntegers(values, &raw);
+      values.clear();
+    } else {
+      auto& values = reals_[i];
+      auto minmax = std::minmax_element(values.begin(), values.end());
+      block.min_ = *minmax.first;
+      block.max_ = *minmax.second;
+      EncodeReals(values, &raw);
+      values.clear();
+    }
+    uLongf compressed_size = compressBound(static_cast<uLong>(raw.size()));
+    compressed.resize(compressed_size);
+    int ret = compress2(compressed.data(), &compressed_size, raw.data(),
+                        static_cast<uLong>(raw.size()), level_);
+    if (ret != Z_OK) {
+      LOG_F(LG_ERROR) << "Failed to compress block: " << ret;
+      return -3;
+    }
+    compressed.resize(compressed_size);
+    block.offset_ = offset_;
+    block.compressed_size_ = static_cast<uint32_t>(compressed_size);
+    block.raw_size_ = static_cast<uint32_t>(raw.size());
+    block.crc32_ = Crc32(compressed);
+    if (WriteBytes(compressed) != 0) {
+      return -3;
+    }
+    chunk.blocks_.push_back(block);
+  }
+  table.row_count_ += pending_rows_;
+  table.chunks_.push_back(chunk);
+  pending_rows_ = 0;
+  return 0;
+}
+
+int32_t ExperimentArchiveWriter::WriteBytes(const std::vector<uint8_t>& bytes) {
+  if (bytes.empty()) {
+    return 0;
+  }
+  if (fwrite(bytes.data(), 1, bytes.size(), file_) != bytes.size()) {
+    LOG_F(LG_ERROR) << "Failed to write archive";
+    return -3;
+  }
+  offset_ += bytes.size();
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ExperimentArchiveReader
+ExperimentArchiveReader::ExperimentArchiveReader()
+    : file_(nullptr), blocks_decompressed_(0) {}
+
+ExperimentArchiveReader::~ExperimentArchiveReader() {
+  Close();
+}
+
+int32_t ExperimentArchiveReader::Open(const std::string& file_pathname) {
+  Close();
+  file_ = fopen(file_pathname.c_str(), "rb");
+  if (file_ == nullptr) {
+    LOG_F(LG_ERROR) << "Failed to open file: " << file_pathname;
+    return -1;
+  }
+  int64_t file_size = FileSize(file_);
+  std::vector<uint8_t> bytes;
+  if (file_size < static_cast<int64_t>(kHeaderSize + kTrailerSize) ||
+      !ReadAt(file_, 0, kHeaderSize, &bytes) ||
+      memcmp(bytes.data(), kMagic, sizeof(kMagic)) != 0 ||
+      !ReadAt(file_, file_size - kTrailerSize, kTrailerSize, &bytes) ||
+      memcmp(bytes.data() + 16, kMagic, sizeof(kMagic)) != 0) {
+    LOG_F(LG_ERROR) << "Not an experiment archive: " << file_pathname;
+    Close();
+    return -2;
+  }
+  ByteReader trailer(bytes.data(), bytes.size());
+  uint64_t index_offset = trailer.GetU64();
+  uint32_t index_size = trailer.GetU32();
+  uint32_t index_crc32 = trailer.GetU32();
+  if (index_offset + index_size + kTrailerSize !=
+          static_cast<uint64_t>(file_size) ||
+      !ReadAt(file_, index_offset, index_size, &bytes) ||
+      Crc32(bytes) != index_crc32) {
+    LOG_F(LG_ERROR) << "Corrupted archive index: " << file_pathname;
+    Close();
+    return -2;
+  }
+  ByteReader index(bytes.data(), bytes.size());
+  uint32_t table_count = index.GetU32();
+  for (uint32_t t = 0; t < table_count && !index.failed(); t++) {
+    ArchiveTable table;
+    table.name_ = index.GetString();
+    uint16_t column_count = index.GetU16();
+    for (uint16_t c = 0; c < column_count && !index.failed(); c++) {
+      ArchiveColumn column;
+      column.name_ = index.GetString();
+      column.type_ = index.GetU8() == ArchiveColumn::kInteger
+                         ? ArchiveColumn::kInteger
+                         : ArchiveColumn::kReal;
+      table.columns_.push_back(column);
+    }
+    table.row_count_ = index.GetU64();
+    uint32_t chunk_count = index.GetU32();
+    for (uint32_t k = 0; k < chunk_count && !index.failed(); k++) {
+      ArchiveChunk chunk;
+      chunk.first_row_ = index.GetU64();
+      chunk.row_count_ = index.GetU32();
+      for (uint16_t c = 0; c < column_count && !index.failed(); c++) {
+        ArchiveBlock block;
+        block.offset_ = index.GetU64();
+        block.compressed_size_ = index.GetU32();
+        block.raw_size_ = index.GetU32();
+        block.crc32_ = index.GetU32();
+        block.min_ = index.GetF64();
+        block.max_ = index.GetF64();
+        chunk.blocks_.push_back(block);
+      }
+      table.chunks_.push_back(chunk);
+    }
+    tables_.push_back(table);
+  }
+  if (index.failed()) {
+    LOG_F(LG_ERROR) << "Corrupted archive index: " << file_pathname;
+    Close();
+    return -2;
+  }
+  blocks_decompressed_ = 0;
+  return 0;
+}
+
+void ExperimentArchiveReader::Close() {
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+  tables_.clear();
+}
+
+const ArchiveTable* ExperimentArchiveReader::FindTable(
+    const std::string& name) const {
+  for (auto& table : tables_) {
+    if (table.name_ == name) {
+      return &table;
+    }
+  }
+  return nullptr;
+}
+
+int32_t ExperimentArchiveReader::ReadRows(
+    const std::string& table_name,
+    uint64_t first_row,
+    uint64_t count,
+    const std::vector<std::string>& columns,
+    std::map<std::string, ArchiveColumnData>* result) {
+  if (file_ == nullptr || result == nullptr) {
+    return -1;
+  }
+  const ArchiveTable* table = FindTable(table_name);
+  if (table == nullptr) {
+    return -2;
+  }
+  std::vector<int32_t> indexes;
+  int32_t ret = ResolveColumns(*table, columns, &indexes);
+  if (ret != 0) {
+    return ret;
+  }
+  result->clear();
+  for (auto index : indexes) {
+    (*result)[table->columns_[index].name_].type_ =
+        table->columns_[index].type_;
+  }
+  uint64_t end_row = first_row + std::min(count, table->row_count_);
+  for (auto& chunk : table->chunks_) {
+    uint64_t chunk_end = chunk.first_row_ + chunk.row_count_;
+    if (chunk_end <= first_row || chunk.first_row_ >= end_row) {
+      continue;
+    }
+    size_t begin = static_cast<size_t>(
+        std::max(first_row, chunk.first_row_) - chunk.first_row_);
+    size_t end =
+        static_cast<size_t>(std::min(end_row, chunk_end) - chunk.first_row_);
+    for (auto index : indexes) {
+      ArchiveColumnData data;
+      ret = ReadBlock(*table, chunk, index, &data);
+      if (ret != 0) {
+        return ret;
+      }
+      ArchiveColumnData& out = (*result)[table->columns_[index].name_];
+      if (data.type_ == ArchiveColumn::kInteger) {
+        out.integers_.insert(out.integers_.end(),
+                             data.integers_.begin() + begin,
+                             data.integers_.begin() + end);
+      } else {
+        out.reals_.insert(out.reals_.end(), data.reals_.begin() + begin,
+                          data.reals_.begin() + end);
+      }
+    }
+  }
+  return 0;
+}
+
+int32_t ExperimentArchiveReader::ReadPage(
+    const std::string& table_name,
+    uint64_t first_row,
+    uint64_t count,
+    std::vector<std::map<std::string, std::string>>* rows) {
+  if (rows == nullptr) {
+    return -1;
+  }
+  rows->clear();
+  std::map<std::string, ArchiveColumnData> result;
+  int32_t ret = ReadRows(table_name, first_row, count, {}, &result);
+  if (ret != 0) {
+    return ret;
+  }
+  size_t row_count = result.empty() ? 0 : result.begin()->second.size();
+  rows->resize(row_count);
+  char text[32];
+  for (auto& iter : result) {
+    const ArchiveColumnData& data = iter.second;
+    for (size_t i = 0; i < row_count; i++) {
+      if (data.type_ == ArchiveColumn::kInteger) {
+        (*rows)[i][iter.first] = std::to_string(data.integers_[i]);
+      } else {
+        /// the digits of the double round trip
+        snprintf(text, sizeof(text), "%.17g", data.reals_[i]);
+        (*rows)[i][iter.first] = text;
+      }
+    }
+  }
+  return 0;
+}
+
+int32_t ExperimentArchiveReader::ReadRange(
+    const std::string& table_name,
+    const std::string& key,
+    double min,
+    double max,
+    const std::vector<std::string>& columns,
+    std::map<std::string, ArchiveColumnData>* result) {
+  if (file_ == nullptr || result == nullptr) {
+    return -1;
+  }
+  const ArchiveTable* table = FindTable(table_name);
+  if (table == nullptr) {
+    return -2;
+  }
+  int32_t key_index = table->ColumnIndex(key);
+  std::vector<int32_t> indexes;
+  int32_t ret = ResolveColumns(*table, columns, &indexes);
+  if (key_index < 0 || ret != 0) {
+    return -2;
+  }
+  result->clear();
+  for (auto index : indexes) {
+    (*result)[table->columns_[index].name_].type_ =
+        table->columns_[index].type_;
+  }
+  for (auto& chunk : table->chunks_) {
+    const ArchiveBlock& key_block = chunk.blocks_[key_index];
+    if (key_block.max_ < min || key_block.min_ > max) {
+      continue;
+    }
+    ArchiveColumnData key_data;
+    ret = ReadBlock(*table, chunk, key_index, &key_data);
+    if (ret != 0) {
+      return ret;
+    }
+    std::vector<size_t> rows;
+    for (size_t i = 0; i < key_data.size(); i++) {
+      double value = key_data.AsReal(i);
+      if (value >= min && value <= max) {
+        rows.push_back(i);
+      }
+    }
+    if (rows.empty()) {
+      continue;
+    }
+    for (auto index : indexes) {
+      ArchiveColumnData data;
+      if (index == key_index) {
+        data = key_data;
+      } else {
+        ret = ReadBlock(*table, chunk, index, &data);
+        if (ret != 0) {
+          return ret;
+        }
+      }
+      ArchiveColumnData& out = (*result)[table->columns_[index].name_];
+      for (auto row : rows) {
+        if (data.type_ == ArchiveColumn::kInteger) {
+          out.integers_.push_back(data.integers_[row]);
+        } else {
+          out.reals_.push_back(data.reals_[row]);
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+int32_t ExperimentArchiveReader::ResolveColumns(
+    const ArchiveTable& table,
+    const std::vector<std::string>& columns,
+    std::vector<int32_t>* indexes) {
+  indexes->clear();
+  if (columns.empty()) {
+    for (size_t i = 0; i < table.columns_.size(); i++) {
+      indexes->push_back(static_cast<int32_t>(i));
+    }
+    return 0;
+  }
+  for (auto& column : columns) {
+    int32_t index = table.ColumnIndex(column);
+    if (index < 0) {
+      LOG_F(LG_ERROR) << "Column not found: " << column;
+      return -2;
+    }
+    indexes->push_back(index);
+  }
+  return 0;
+}
+
+int32_t ExperimentArchiveReader::ReadBlock(const ArchiveTable& table,
+                                           const ArchiveChunk& chunk,
+                                           int32_t column,
+                                           ArchiveColumnData* data) {
+  const ArchiveBlock& block = chunk.blocks_[column];
+  std::vector<uint8_t> compressed;
+  if (!ReadAt(file_, block.offset_, block.compressed_size_, &compressed) ||
+      Crc32(compressed) != block.crc32_) {
+    LOG_F(LG_ERROR) << "Failed to read block of " << table.name_;
+    return -3;
+  }
+  std::vector<uint8_t> raw(block.raw_size_);
+  uLongf raw_size = block.raw_size_;
+  int ret = uncompress(raw.data(), &raw_size, compressed.data(),
+                       static_cast<uLong>(compressed.size()));
+  if (ret != Z_OK || raw_size != block.raw_size_) {
+    LOG_F(LG_ERROR) << "Failed to uncompress block of " << table.name_;
+    return -3;
+  }
+  blocks_decompressed_++;
+  data->type_ = table.columns_[column].type_;
+  data->integers_.clear();
+  data->reals_.clear();
+  bool decoded = false;
+  if (data->type_ == ArchiveColumn::kInteger) {
+    data->integers_.reserve(chunk.row_count_);
+    decoded = DecodeIntegers(raw, chunk.row_count_, &data->integers_);
+  } else {
+    data->reals_.reserve(chunk.row_count_);
+    decoded = DecodeReals(raw, chunk.row_count_, &data->reals_);
+  }
+  if (!decoded) {
+    LOG_F(LG_ERROR) << "Failed to decode block of " << table.name_;
+    return -3;
+  }
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// helper function
+int32_t ArchiveExperimentDataBase(const std::string& db_filepathname,
+                                  const std::string& archive_pathname) {
+  if (!anx::common::FileExists(db_filepathname)) {
+    LOG_F(LG_ERROR) << "Database not found: " << db_filepathname;
+    return -1;
+  }
+  ExperimentArchiveWriter writer;
+  if (writer.Open(archive_pathname) != 0) {
+    return -2;
+  }
+  for (auto table_name : kArchiveTables) {
+    /// @note the columns of the schema, the INTEGER columns are integers and
+    /// the others are reals. the table dropped or never created has none.
+    std::vector<ArchiveColumn> columns;
+    if (!TableColumns(db_filepathname, table_name, &columns)) {
+      writer.Close();
+      return -1;
+    }
+    if (columns.empty()) {
+      continue;
+    }
+    if (writer.BeginTable(table_name, columns) != 0) {
+      return -2;
+    }
+    anx::db::DatabaseCursor cursor(db_filepathname, table_name);
+    std::vector<std::map<std::string, std::string>> result;
+    int64_t after_id = 0;
+    while (true) {
+      if (!cursor.NextPage(after_id, ExperimentArchiveWriter::kDefaultChunkRows,
+                           &result)) {
+        writer.Close();
+        return -1;
+      }
+      if (result.empty()) {
+        break;
+      }
+      for (auto& row : result) {
+        std::vector<ArchiveValue> values;
+        for (auto& column : columns) {
+          const std::string& text = row[column.name_];
+          if (column.type_ == ArchiveColumn::kInteger) {
+            values.push_back(ArchiveValue(static_cast<int64_t>(
+                text.empty() ? 0 : std::stoll(text))));
+          } else {
+            values.push_back(
+                ArchiveValue(text.empty() ? 0.0 : std::stod(text)));
+          }
+        }
+        if (writer.AppendRow(values) != 0) {
+          return -2;
+        }
+      }
+      after_id = cursor.last_id();
+    }
+  }
+  if (writer.Close() != 0) {
+    return -2;
+  }
+  /// @note check the archive index before the database may be removed.
+  return CheckExperimentArchive(db_filepathname, archive_pathname);
+}
+
+int32_t CheckExperimentArchive(const std::string& db_filepathname,
+                               const std::string& archive_pathname) {
+  if (!anx::common::FileExists(db_filepathname)) {
+    return -1;
+  }
+  ExperimentArchiveReader reader;
+  if (reader.Open(archive_pathname) != 0) {
+    return -3;
+  }
+  for (auto table_name : kArchiveTables) {
+    std::vector<ArchiveColumn> columns;
+    if (!TableColumns(db_filepathname, table_name, &columns)) {
+      return -1;
+    }
+    if (columns.empty()) {
+      continue;
+    }
+    std::string sql_str = "SELECT COUNT(*) AS count FROM ";
+    sql_str += table_name;
+    sql_str += ";";
+    std::vector<std::map<std::string, std::string>> result;
+    if (!anx::db::helper::QueryDataBase(db_filepathname, table_name, sql_str,
+                                        &result) ||
+        result.empty()) {
+      return -1;
+    }
+    const ArchiveTable* table = reader.FindTable(table_name);
+    if (table == nullptr ||
+        table->row_count_ != std::stoull(result[0]["count"]) ||
+        table->columns_.size() != columns.size()) {
+      LOG_F(LG_ERROR) << "Archive check failed: " << archive_pathname;
+      return -3;
+    }
+  }
+  return 0;
+}
+
+bool FindExperimentArchive(const std::string& db_name,
+                           std::string* archive_pathname) {
+  std::string db_filepathname;
+  if (anx::db::helper::DatabasePathname(db_name, &db_filepathname) != 0 ||
+      anx::common::FileExists(db_filepathname)) {
+    return false;
+  }
+  std::string pathname = db_filepathname + kExperimentArchiveExtension;
+  if (!anx::common::FileExists(pathname)) {
+    return false;
+  }
+  if (archive_pathname != nullptr) {
+    *archive_pathname = pathname;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ExperimentArchiver
+ExperimentArchiver* ExperimentArchiver::instance_ = nullptr;
+
+ExperimentArchiver* ExperimentArchiver::Instance() {
+  if (instance_ == nullptr) {
+    instance_ = new ExperimentArchiver();
+  }
+  return instance_;
+}
+
+void ExperimentArchiver::ReleaseInstance() {
+  if (instance_ != nullptr) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+ExperimentArchiver::ExperimentArchiver()
+    : busy_(false), archived_count_(0), failed_count_(0) {}
+
+ExperimentArchiver::~ExperimentArchiver() {
+  Stop();
+}
+
+void ExperimentArchiver::Post(const std::string& db_name, bool remove_source) {
+  anx::common::AutoLock lock(&mutex_);
+  Job job;
+  job.db_name_ = db_name;
+  job.remove_source_ = remove_source;
+  jobs_.push_back(job);
+  if (thread_ == nullptr) {
+    Start();
+  }
+  cond_.signal();
+}
+
+bool ExperimentArchiver::WaitIdle(int32_t timeout_ms) {
+  int64_t deadline_ms = anx::common::GetCurrentTimeMillis() + timeout_ms;
+  anx::common::AutoLock lock(&mutex_);
+  while (!jobs_.empty() || busy_) {
+    if (timeout_ms <= 0) {
+      idle_cond_.wait(&mutex_);
+      continue;
+    }
+    int64_t remain_ms = deadline_ms - anx::common::GetCurrentTimeMillis();
+    if (remain_ms <= 0) {
+      return false;
+    }
+    idle_cond_.wait(&mutex_, static_cast<unsigned int>(remain_ms));
+  }
+  return true;
+}
+
+int64_t ExperimentArchiver::archived_count() {
+  anx::common::AutoLock lock(&mutex_);
+  return archived_count_;
+}
+
+int64_t ExperimentArchiver::failed_count() {
+  anx::common::AutoLock lock(&mutex_);
+  return failed_count_;
+}
+
+void ExperimentArchiver::run() {
+  while (true) {
+    Job job;
+    {
+      anx::common::AutoLock lock(&mutex_);
+      while (jobs_.empty() && !is_interrupt()) {
+        cond_.wait(&mutex_);
+      }
+      if (is_interrupt()) {
+        break;
+      }
+      job = jobs_.front();
+      jobs_.pop_front();
+      busy_ = true;
+    }
+    std::string db_filepathname;
+    int32_t ret = -1;
+    if (anx::db::helper::DatabasePathname(job.db_name_, &db_filepathname) ==
+        0) {
+      std::string archive_pathname =
+          db_filepathname + kExperimentArchiveExtension;
+      int64_t start_time_ms = anx::common::GetCurrentTimeMillis();
+      /// the archive of the run written on the stop is kept if it checks.
+      ret = -1;
+      if (job.remove_source_ && anx::common::FileExists(archive_pathname)) {
+        ret = CheckExperimentArchive(db_filepathname, archive_pathname);
+      }
+      if (ret != 0) {
+        ret = ArchiveExperimentDataBase(db_filepathname, archive_pathname);
+      }
+      /// the archive reads through its own pool keyed by the file path name.
+      anx::db::helper::CloseDataBase(db_filepathname);
+      LOG_F(LG_INFO) << "archive " << db_filepathname << " ret:" << ret
+                     << " cost:"
+                     << anx::common::GetCurrentTimeMillis() - start_time_ms
+                     << "ms";
+      if (ret == 0 && job.remove_source_) {
+        anx::db::helper::CloseDataBase(job.db_name_);
+        anx::db::helper::ClearDatabaseFile(job.db_name_);
+      }
+    }
+    {
+      anx::common::AutoLock lock(&mutex_);
+      if (ret == 0) {
+        archived_count_++;
+      } else {
+        failed_count_++;
+      }
+      busy_ = false;
+      idle_cond_.broadcast();
+    }
+  }
+}
+
+void ExperimentArchiver::Start() {
+  stop_ = false;
+  thread_.reset(new anx::common::Thread(this));
+  thread_->start();
+}
+
+void ExperimentArchiver::Stop() {
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (thread_ == nullptr) {
+      return;
+    }
+    interrupt();
+    cond_.signal();
+  }
+  thread_->join();
+  thread_.reset();
+}
+
+}  // namespace expdata
+}  // namespace anx
@@ -0,0 +1,347 @@
+/**
+ * @file experiment_archive.h
+ * @author hhool (hhool@outlook.com)
+ * @brief compressed archive of the finished experiment data. the tables of an
+ * experiment database are stored column by column in chunks, every column of
+ * a chunk is delta encoded and deflated on its own, and a chunk index at the
+ * end of the file lets the reader decompress only the chunks a query touches.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_EXPDATA_EXPERIMENT_ARCHIVE_H_
+#define APP_EXPDATA_EXPERIMENT_ARCHIVE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/common/thread.h"
+
+namespace anx {
+namespace expdata {
+
+/// @brief the file extension of the experiment archive
+extern const char* kExperimentArchiveExtension;
+
+/// @brief the column of an archive table
+class ArchiveColumn {
+ public:
+  enum Type { kInteger = 0, kReal = 1 };
+
+  ArchiveColumn();
+  ArchiveColumn(const std::string& name, Type type);
+
+ public:
+  std::string name_;
+  Type type_;
+};
+
+/// @brief one value of an archive row
+class ArchiveValue {
+ public:
+  ArchiveValue();
+  ArchiveValue(int32_t value);  // NOLINT
+  ArchiveValue(int64_t value);  // NOLINT
+  ArchiveValue(double value);   // NOLINT
+
+ public:
+  int64_t integer_;
+  double real_;
+};
+
+/// @brief the values of one column read from the archive, integers_ for the
+/// integer column and reals_ for the real column.
+class ArchiveColumnData {
+ public:
+  ArchiveColumnData();
+
+ public:
+  ArchiveColumn::Type type_;
+  std::vector<int64_t> integers_;
+  std::vector<double> reals_;
+
+  size_t size() const {
+    return type_ == ArchiveColumn::kInteger ? integers_.size() : reals_.size();
+  }
+  double AsReal(size_t i) const {
+    return type_ == ArchiveColumn::kInteger ? static_cast<double>(integers_[i])
+                                            : reals_[i];
+  }
+};
+
+/// @brief the index entry of one column block of a chunk
+class ArchiveBlock {
+ public:
+  ArchiveBlock();
+
+ public:
+  uint64_t offset_;
+  uint32_t compressed_size_;
+  uint32_t raw_size_;
+  uint32_t crc32_;
+  double min_;
+  double max_;
+};
+
+/// @brief the index entry of one chunk of a table
+class ArchiveChunk {
+ public:
+  ArchiveChunk();
+
+ public:
+  uint64_t first_row_;
+  uint32_t row_count_;
+  std::vector<ArchiveBlock> blocks_;
+};
+
+/// @brief the index of one table of the archive
+class ArchiveTable {
+ public:
+  ArchiveTable();
+
+  /// @brief Get the column index by name
+  /// @return the column index, -1 if not found
+  int32_t ColumnIndex(const std::string& name) const;
+
+ public:
+  std::string name_;
+  std::vector<ArchiveColumn> columns_;
+  uint64_t row_count_;
+  std::vector<ArchiveChunk> chunks_;
+};
+
+/// @brief write the archive file table by table, rows are buffered until a
+/// chunk is full and then the chunk is encoded and written.
+class ExperimentArchiveWriter {
+ public:
+  /// @brief Constructor
+  /// @param chunk_rows the rows of one chunk
+  /// @param level the deflate level 0 - 9
+  explicit ExperimentArchiveWriter(uint32_t chunk_rows = kDefaultChunkRows,
+                                   int32_t level = 6);
+  ~ExperimentArchiveWriter();
+
+  ExperimentArchiveWriter(const ExperimentArchiveWriter&) = delete;
+  ExperimentArchiveWriter& operator=(const ExperimentArchiveWriter&) = delete;
+
+ public:
+  /// @brief Open the archive file to write, the file is truncated
+  /// @return 0 if success, -1 if the file can't be opened
+  int32_t Open(const std::string& file_pathname);
+
+  /// @brief Begin a new table, the previous table is ended
+  /// @return 0 if success, -1 if not opened, -2 if the columns are invalid
+  int32_t BeginTable(const std::string& name,
+                     const std::vector<ArchiveColumn>& columns);
+
+  /// @brief Append a row to the current table
+  /// @param row the values in the column order
+  /// @return 0 if success, -1 if no table, -2 if the value count mismatch,
+  /// -3 if write failed
+  int32_t AppendRow(const std::vector<ArchiveValue>& row);
+
+  /// @brief Write the chunk index and close the file
+  /// @return 0 if success, -1 if not opened, -3 if write failed
+  int32_t Close();
+
+  /// @brief the default rows of one chunk
+  static const uint32_t kDefaultChunkRows = 4096;
+
+ private:
+  int32_t FlushChunk();
+  int32_t WriteBytes(const std::vector<uint8_t>& bytes);
+
+ private:
+  uint32_t chunk_rows_;
+  int32_t level_;
+  FILE* file_;
+  uint64_t offset_;
+  std::vector<ArchiveTable> tables_;
+  std::vector<std::vector<int64_t>> integers_;
+  std::vector<std::vector<double>> reals_;
+  uint32_t pending_rows_;
+};
+
+/// @brief read the archive file, the chunk index is loaded on open and the
+/// column blocks are read and decompressed on demand.
+class ExperimentArchiveReader {
+ public:
+  ExperimentArchiveReader();
+  ~ExperimentArchiveReader();
+
+  ExperimentArchiveReader(const ExperimentArchiveReader&) = delete;
+  ExperimentArchiveReader& operator=(const ExperimentArchiveReader&) = delete;
+
+ public:
+  /// @brief Open the archive file and load the chunk index
+  /// @return 0 if success, -1 if the file can't be opened, -2 if the file is
+  /// not an archive or the index is corrupted
+  int32_t Open(const std::string& file_pathname);
+
+  /// @brief Close the archive file
+  void Close();
+
+  /// @brief Get the tables of the archive
+  const std::vector<ArchiveTable>& tables() const { return tables_; }
+
+  /// @brief Get the table by name
+  /// @return the table, nullptr if not found
+  const ArchiveTable* FindTable(const std::string& name) const;
+
+  /// @brief Read the rows [first_row, first_row + count) of the columns
+  /// @param table the table name
+  /// @param first_row the first row
+  /// @param count the max row count
+  /// @param columns the column names, all the columns if empty
+  /// @param result the column values by column name
+  /// @return 0 if success, -1 if not opened, -2 if the table or a column is
+  /// not found, -3 if read or decompress failed
+  int32_t ReadRows(const std::string& table,
+                   uint64_t first_row,
+                   uint64_t count,
+                   const std::vector<std::string>& columns,
+                   std::map<std::string, ArchiveColumnData>* result);
+
+  /// @brief Read the rows with min <= key column value <= max, the chunks out
+  /// of the range are skipped by the min max of the index.
+  /// @param table the table name
+  /// @param key the key column name, e.g. date, cycle, id
+  /// @param min the min value of the key
+  /// @param max the max value of the key
+  /// @param columns the column names, all the columns if empty
+  /// @param result the column values by column name
+  /// @return 0 if success, -1 if not opened, -2 if the table or a column is
+  /// not found, -3 if read or decompress failed
+  int32_t ReadRange(const std::string& table,
+                    const std::string& key,
+                    double min,
+                    double max,
+                    const std::vector<std::string>& columns,
+                    std::map<std::string, ArchiveColumnData>* result);
+
+  /// @brief Read the rows [first_row, first_row + count) of all the columns
+  /// as the text rows of the database, e.g. the rows of a page of
+  /// anx::db::DatabaseCursor
+  /// @param table the table name
+  /// @param first_row the first row
+  /// @param count the max row count
+  /// @param rows the rows, the values by column name
+  /// @return 0 if success, -1 if not opened, -2 if the table is not found,
+  /// -3 if read or decompress failed
+  int32_t ReadPage(const std::string& table,
+                   uint64_t first_row,
+                   uint64_t count,
+                   std::vector<std::map<std::string, std::string>>* rows);
+
+  /// @brief Get the count of the column blocks decompressed since open
+  int64_t blocks_decompressed() const { return blocks_decompressed_; }
+
+ private:
+  int32_t ResolveColumns(const ArchiveTable& table,
+                         const std::vector<std::string>& columns,
+                         std::vector<int32_t>* indexes);
+  int32_t ReadBlock(const ArchiveTable& table,
+                    const ArchiveChunk& chunk,
+                    int32_t column,
+                    ArchiveColumnData* data);
+
+ private:
+  FILE* file_;
+  std::vector<ArchiveTable> tables_;
+  int64_t blocks_decompressed_;
+};
+
+/// @brief Archive the exp_data_graph and exp_data_list tables of the
+/// experiment database file, the columns and the types of the schema of the
+/// tables are kept, also for the empty tables.
+/// @param db_filepathname the experiment database file path name
+/// @param archive_pathname the archive file path name
+/// @return 0 if success, -1 if the database can't be read, -2 if the archive
+/// can't be written, -3 if the archive check failed
+int32_t ArchiveExperimentDataBase(const std::string& db_filepathname,
+                                  const std::string& archive_pathname);
+
+/// @brief Check the archive holds the tables of the experiment database
+/// file with all the rows, e.g. before the database file is removed.
+/// @return 0 if success, -1 if the database can't be read, -3 if the archive
+/// can't be read or misses rows
+int32_t CheckExperimentArchive(const std::string& db_filepathname,
+                               const std::string& archive_pathname);
+
+/// @brief Get the archive of the experiment database of the run archived,
+/// the database file is removed after the archive.
+/// @param db_name the experiment database name, see
+/// anx::db::helper::DatabasePathname
+/// @param archive_pathname the archive file path name
+/// @return true if the database file is gone and the archive exists
+bool FindExperimentArchive(const std::string& db_name,
+                           std::string* archive_pathname);
+
+/// @brief archive the finished experiment databases on a background thread
+class ExperimentArchiver : public anx::common::Runnable {
+ public:
+  ExperimentArchiver();
+  ~ExperimentArchiver() override;
+
+ public:
+  static ExperimentArchiver* Instance();
+  static void ReleaseInstance();
+
+  /// @brief Post the experiment database to archive, the archive is written
+  /// beside the database file with kExperimentArchiveExtension.
+  /// @param db_name the experiment database name, see
+  /// anx::db::helper::DatabasePathname
+  /// @param remove_source remove the database file after the archive is
+  /// checked, the archive written before is kept if it checks. the database
+  /// must not be read any more, e.g. it's not the current experiment
+  /// database.
+  void Post(const std::string& db_name, bool remove_source);
+
+  /// @brief Wait until all posted jobs are done
+  /// @param timeout_ms the max wait time, <= 0 wait forever
+  /// @return true if all jobs are done
+  bool WaitIdle(int32_t timeout_ms);
+
+  /// @brief Get the count of the archives written
+  int64_t archived_count();
+
+  /// @brief Get the count of the archive jobs failed
+  int64_t failed_count();
+
+ protected:
+  void run() override;
+
+ private:
+  class Job {
+   public:
+    std::string db_name_;
+    bool remove_source_;
+  };
+  void Start();
+  void Stop();
+
+ private:
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  anx::common::Condition idle_cond_;
+  std::deque<Job> jobs_;
+  bool busy_;
+  int64_t archived_count_;
+  int64_t failed_count_;
+  std::unique_ptr<anx::common::Thread> thread_;
+
+  static ExperimentArchiver* instance_;
+};
+
+}  // namespace expdata
+}  // namespace anx
+
+#endif  // APP_EXPDATA_EXPERIMENT_ARCHIVE_H_
@@ -0,0 +1,260 @@
+/**
+ * @file experiment_archive_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief experiment archive unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "app/common/file_utils.h"
+#include "app/common/module_utils.h"
+#include "app/db/database.h"
+#include "app/db/database_factory.h"
+#include "app/db/database_helper.h"
+#include "app/expdata/experiment_archive.h"
+
+namespace anx {
+namespace expdata {
+class ExperimentArchiveTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    folder_ = anx::common::GetModuleDir() + anx::common::kPathSeparator +
+              "expdata_unittest";
+    anx::common::MakeSureFolderPathExist(FileName("x"));
+  }
+  void TearDown() override {
+    ExperimentArchiver::ReleaseInstance();
+    anx::db::DatabaseFactory::Instance()->CloseAllDatabase();
+  }
+
+  std::string FileName(const std::string& name) {
+    return folder_ + anx::common::kPathSeparator + name;
+  }
+
+  /// @brief write rows id 1..n, cycle id * 10, kHz 20 + id / 1000 and date
+  /// id * 0.01 in chunks of chunk_rows.
+  void WriteSample(const std::string& file_pathname,
+                   int32_t n,
+                   uint32_t chunk_rows) {
+    ExperimentArchiveWriter writer(chunk_rows);
+    ASSERT_EQ(writer.Open(file_pathname), 0);
+    std::vector<ArchiveColumn> columns;
+    columns.push_back(ArchiveColumn("id", ArchiveColumn::kInteger));
+    columns.push_back(ArchiveColumn("cycle", ArchiveColumn::kInteger));
+    columns.push_back(ArchiveColumn("kHz", ArchiveColumn::kReal));
+    columns.push_back(ArchiveColumn("date", ArchiveColumn::kReal));
+    ASSERT_EQ(writer.BeginTable("amp", columns), 0);
+    for (int32_t i = 1; i <= n; i++) {
+      std::vector<ArchiveValue> row;
+      row.push_back(ArchiveValue(i));
+      row.push_back(ArchiveValue(static_cast<int64_t>(i) * 10));
+      row.push_back(ArchiveValue(20.0 + i / 1000.0));
+      row.push_back(ArchiveValue(i * 0.01));
+      ASSERT_EQ(writer.AppendRow(row), 0);
+    }
+    ASSERT_EQ(writer.Close(), 0);
+  }
+
+  std::string folder_;
+};
+
+TEST_F(ExperimentArchiveTest, RoundTrip) {
+  std::string file_pathname = FileName("round_trip.anxa");
+  WriteSample(file_pathname, 1000, 256);
+  ExperimentArchiveReader reader;
+  ASSERT_EQ(reader.Open(file_pathname), 0);
+  const ArchiveTable* table = reader.FindTable("amp");
+  ASSERT_NE(table, nullptr);
+  EXPECT_EQ(table->row_count_, 1000u);
+  EXPECT_EQ(table->chunks_.size(), 4u);
+  EXPECT_EQ(table->columns_.size(), 4u);
+
+  std::map<std::string, ArchiveColumnData> result;
+  ASSERT_EQ(reader.ReadRows("amp", 0, 1000, {}, &result), 0);
+  ASSERT_EQ(result["id"].integers_.size(), 1000u);
+  ASSERT_EQ(result["kHz"].reals_.size(), 1000u);
+  for (int32_t i = 0; i < 1000; i++) {
+    EXPECT_EQ(result["id"].integers_[i], i + 1);
+    EXPECT_EQ(result["cycle"].integers_[i], (i + 1) * 10);
+    EXPECT_EQ(result["kHz"].reals_[i], 20.0 + (i + 1) / 1000.0);
+    EXPECT_EQ(result["date"].reals_[i], (i + 1) * 0.01);
+  }
+  reader.Close();
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentArchiveTest, ReadRowsAcrossChunks) {
+  std::string file_pathname = FileName("rows.anxa");
+  WriteSample(file_pathname, 1000, 100);
+  ExperimentArchiveReader reader;
+  ASSERT_EQ(reader.Open(file_pathname), 0);
+  std::map<std::string, ArchiveColumnData> result;
+  ASSERT_EQ(reader.ReadRows("amp", 250, 100, {"id"}, &result), 0);
+  EXPECT_EQ(result.size(), 1u);
+  ASSERT_EQ(result["id"].integers_.size(), 100u);
+  EXPECT_EQ(result["id"].integers_.front(), 251);
+  EXPECT_EQ(result["id"].integers_.back(), 350);
+  /// rows 250 - 349 touch the chunks 2 and 3
+  EXPECT_EQ(reader.blocks_decompressed(), 2);
+
+  ASSERT_EQ(reader.ReadRows("amp", 950, 100, {"cycle"}, &result), 0);
+  EXPECT_EQ(result["cycle"].integers_.size(), 50u);
+  EXPECT_EQ(reader.ReadRows("amp", 0, 1, {"none"}, &result), -2);
+  EXPECT_EQ(reader.ReadRows("none", 0, 1, {}, &result), -2);
+  reader.Close();
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentArchiveTest, ReadRangeSkipChunks) {
+  std::string file_pathname = FileName("range.anxa");
+  WriteSample(file_pathname, 1000, 100);
+  ExperimentArchiveReader reader;
+  ASSERT_EQ(reader.Open(file_pathname), 0);
+  std::map<std::string, ArchiveColumnData> result;
+  ASSERT_EQ(
+      reader.ReadRange("amp", "date", 1.205, 1.505, {"id", "kHz"}, &result),
+      0);
+  ASSERT_EQ(result["id"].integers_.size(), 30u);
+  EXPECT_EQ(result["id"].integers_.front(), 121);
+  EXPECT_EQ(result["id"].integers_.back(), 150);
+  EXPECT_EQ(result["kHz"].reals_.front(), 20.121);
+  /// only the chunk 2 is read, the key, id and kHz blocks
+  EXPECT_EQ(reader.blocks_decompressed(), 3);
+  reader.Close();
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentArchiveTest, CorruptedIndex) {
+  std::string file_pathname = FileName("corrupted.anxa");
+  WriteSample(file_pathname, 100, 50);
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  /// flip a byte of the index before the trailer
+  content[content.size() - 24] ^= 0x5A;
+  ASSERT_TRUE(anx::common::WriteFile(file_pathname, content, true));
+  ExperimentArchiveReader reader;
+  EXPECT_EQ(reader.Open(file_pathname), -2);
+  ASSERT_TRUE(anx::common::WriteFile(file_pathname, "not an archive", true));
+  EXPECT_EQ(reader.Open(file_pathname), -2);
+  EXPECT_EQ(reader.Open(FileName("none.anxa")), -1);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentArchiveTest, ArchiveExperimentDataBase) {
+  std::string db_name = FileName("exp_archive.db");
+  anx::db::helper::ClearDatabaseFile(db_name);
+  ASSERT_TRUE(anx::db::helper::CreateExperimentDataTables(db_name));
+  for (int32_t i = 1; i <= 5000; i++) {
+    std::vector<anx::db::DatabaseValue> params;
+    params.push_back(anx::db::DatabaseValue(i * 100));
+    params.push_back(anx::db::DatabaseValue(20.0 + (i % 7) * 0.001));
+    params.push_back(anx::db::DatabaseValue(100.0));
+    params.push_back(anx::db::DatabaseValue(i * 0.5));
+    params.push_back(anx::db::DatabaseValue(i % 2));
+    params.push_back(anx::db::DatabaseValue(i * 0.02));
+    ASSERT_TRUE(anx::db::helper::InsertDataTable(
+        db_name, anx::db::helper::kTableExpDataGraph,
+        anx::db::helper::sql::kInsertTableExpDataGraphSqlPrepared, params));
+  }
+  anx::db::helper::CloseDataBase(db_name);
+
+  ExperimentArchiver::Instance()->Post(db_name, true);
+  ASSERT_TRUE(ExperimentArchiver::Instance()->WaitIdle(10000));
+  EXPECT_EQ(ExperimentArchiver::Instance()->archived_count(), 1);
+  EXPECT_EQ(ExperimentArchiver::Instance()->failed_count(), 0);
+  EXPECT_FALSE(anx::common::FileExists(db_name));
+
+  std::string archive_pathname = db_name + kExperimentArchiveExtension;
+  ExperimentArchiveReader reader;
+  ASSERT_EQ(reader.Open(archive_pathname), 0);
+  const ArchiveTable* graph = reader.FindTable("exp_data_graph");
+  ASSERT_NE(graph, nullptr);
+  EXPECT_EQ(graph->row_count_, 5000u);
+  const ArchiveTable* list = reader.FindTable("exp_data_list");
+  ASSERT_NE(list, nullptr);
+  EXPECT_EQ(list->row_count_, 0u);
+  /// the schema of the empty table is kept
+  ASSERT_EQ(list->columns_.size(), 6u);
+  EXPECT_EQ(list->columns_[2].name_, "kHz");
+  EXPECT_EQ(list->columns_[2].type_, ArchiveColumn::kReal);
+  EXPECT_EQ(graph->columns_[graph->ColumnIndex("state")].type_,
+            ArchiveColumn::kInteger);
+  std::map<std::string, ArchiveColumnData> result;
+  ASSERT_EQ(reader.ReadRange("exp_data_graph", "cycle", 250000, 250000, {},
+                             &result),
+            0);
+  ASSERT_EQ(result["id"].integers_.size(), 1u);
+  EXPECT_EQ(result["id"].integers_[0], 2500);
+  EXPECT_EQ(result["state"].integers_[0], 0);
+  EXPECT_EQ(result["μm"].reals_[0], 1250.0);
+  EXPECT_EQ(result["date"].reals_[0], 2500 * 0.02);
+  std::vector<std::map<std::string, std::string>> rows;
+  ASSERT_EQ(reader.ReadPage("exp_data_graph", 2499, 2, &rows), 0);
+  ASSERT_EQ(rows.size(), 2u);
+  EXPECT_EQ(rows[0]["id"], "2500");
+  EXPECT_EQ(rows[0]["cycle"], "250000");
+  EXPECT_EQ(std::stod(rows[1]["date"]), 2501 * 0.02);
+  reader.Close();
+  anx::common::RemoveFile(archive_pathname);
+
+  /// the missing database is reported as failed
+  ExperimentArchiver::Instance()->Post(db_name, false);
+  ASSERT_TRUE(ExperimentArchiver::Instance()->WaitIdle(10000));
+  EXPECT_EQ(ExperimentArchiver::Instance()->failed_count(), 1);
+}
+
+TEST_F(ExperimentArchiveTest, RemoveSourceAfterCheck) {
+  std::string db_name = FileName("exp_archive_keep.db");
+  anx::db::helper::ClearDatabaseFile(db_name);
+  ASSERT_TRUE(anx::db::helper::CreateExperimentDataTables(db_name));
+  std::vector<anx::db::DatabaseValue> params;
+  params.push_back(anx::db::DatabaseValue(100));
+  params.push_back(anx::db::DatabaseValue(20.0));
+  params.push_back(anx::db::DatabaseValue(100.0));
+  params.push_back(anx::db::DatabaseValue(0.5));
+  params.push_back(anx::db::DatabaseValue(0.02));
+  ASSERT_TRUE(anx::db::helper::InsertDataTable(
+      db_name, anx::db::helper::kTableExpDataList,
+      anx::db::helper::sql::kInsertTableExpDataListSqlPrepared, params));
+  anx::db::helper::CloseDataBase(db_name);
+  std::string archive_pathname = db_name + kExperimentArchiveExtension;
+
+  /// the archive of the stop, the database is still read
+  ExperimentArchiver::Instance()->Post(db_name, false);
+  ASSERT_TRUE(ExperimentArchiver::Instance()->WaitIdle(10000));
+  EXPECT_TRUE(anx::common::FileExists(db_name));
+  EXPECT_FALSE(FindExperimentArchive(db_name, nullptr));
+  EXPECT_EQ(CheckExperimentArchive(db_name, archive_pathname), 0);
+
+  /// a row after the archive, the archive misses it and is written again
+  ASSERT_TRUE(anx::db::helper::InsertDataTable(
+      db_name, anx::db::helper::kTableExpDataList,
+      anx::db::helper::sql::kInsertTableExpDataListSqlPrepared, params));
+  anx::db::helper::CloseDataBase(db_name);
+  EXPECT_EQ(CheckExperimentArchive(db_name, archive_pathname), -3);
+  ExperimentArchiver::Instance()->Post(db_name, true);
+  ASSERT_TRUE(ExperimentArchiver::Instance()->WaitIdle(10000));
+  EXPECT_EQ(ExperimentArchiver::Instance()->archived_count(), 2);
+  EXPECT_FALSE(anx::common::FileExists(db_name));
+  std::string found_pathname;
+  ASSERT_TRUE(FindExperimentArchive(db_name, &found_pathname));
+  EXPECT_EQ(found_pathname, archive_pathname);
+  ExperimentArchiveReader reader;
+  ASSERT_EQ(reader.Open(archive_pathname), 0);
+  ASSERT_NE(reader.FindTable("exp_data_list"), nullptr);
+  EXPECT_EQ(reader.FindTable("exp_data_list")->row_count_, 2u);
+  reader.Close();
+  anx::common::RemoveFile(archive_pathname);
+}
+
+}  // namespace expdata
+}  // namespace anx
@@ -0,0 +1,680 @@
+/**
+ * @file experiment_arrow.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the columnar export of the experiment data in the arrow ipc file
+ * format.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/expdata/experiment_arrow.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+
+#include "app/common/file_utils.h"
+#include "app/common/logger.h"
+#include "app/db/database_cursor.h"
+#include "app/db/database_helper.h"
+#include "app/expdata/experiment_data_base.h"
+
+namespace anx {
+namespace expdata {
+
+const char* kExperimentArrowExtension = ".arrow";
+
+namespace {
+
+/// @note file layout, see the arrow columnar format specification.
+/// magic "ARROW1" with 2 bytes padding
+/// messages: u32 0xFFFFFFFF, i32 metadata size, the flatbuffer of the
+///   Message padded to 8 bytes, the body. the schema first and the record
+///   batches after, the end of stream marker at last.
+/// footer: the flatbuffer of the Footer, i32 footer size, magic "ARROW1"
+const char kMagic[6] = {'A', 'R', 'R', 'O', 'W', '1'};
+const uint32_t kContinuation = 0xFFFFFFFF;
+/// @brief the buffers of the body are aligned to 64 bytes
+const size_t kBufferAlignment = 64;
+
+/// @brief the enums and the field ids of Schema.fbs, Message.fbs and
+/// File.fbs
+const int16_t kMetadataV5 = 4;
+const uint8_t kTypeInt = 2;
+const uint8_t kTypeFloatingPoint = 3;
+const uint8_t kTypeTimestamp = 10;
+const int16_t kPrecisionDouble = 2;
+const int16_t kTimeUnitMillisecond = 1;
+const uint8_t kMessageHeaderSchema = 1;
+const uint8_t kMessageHeaderRecordBatch = 3;
+
+/// @brief the days between 1899-12-30 of the variant time and 1970-01-01
+const double kVariantTimeUnixEpoch = 25569.0;
+const double kMillisecondsPerDay = 86400000.0;
+
+void PutU16(std::string* out, uint16_t value) {
+  for (int32_t i = 0; i < 2; i++) {
+    out->push_back(static_cast<char>(value >> (i * 8)));
+  }
+}
+
+void PutU32(std::string* out, uint32_t value) {
+  for (int32_t i = 0; i < 4; i++) {
+    out->push_back(static_cast<char>(value >> (i * 8)));
+  }
+}
+
+void PutU64(std::string* out, uint64_t value) {
+  for (int32_t i = 0; i < 8; i++) {
+    out->push_back(static_cast<char>(value >> (i * 8)));
+  }
+}
+
+void PutF64(std::string* out, double value) {
+  uint64_t bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  PutU64(out, bits);
+}
+
+void SetU32(std::string* out, size_t pos, uint32_t value) {
+  for (int32_t i = 0; i < 4; i++) {
+    (*out)[pos + i] = static_cast<char>(value >> (i * 8));
+  }
+}
+
+void Pad(std::string* out, size_t alignment) {
+  while (out->size() % alignment != 0) {
+    out->push_back('\0');
+  }
+}
+
+////////////////////////////////////////////////////////////
+// clz FlatNode
+/// @brief an object of the flatbuffer, built as a tree and written front to
+/// back. the vtable is written before the table and the children after the
+/// table, so every uoffset points forward as the format requires. the
+/// alignments are relative to the start of the flatbuffer.
+class FlatNode {
+ public:
+  enum Kind { kTable, kOffsetVector, kStructVector, kString };
+
+  static std::unique_ptr<FlatNode> Table() {
+    return std::unique_ptr<FlatNode>(new FlatNode(kTable));
+  }
+
+  static std::unique_ptr<FlatNode> String(const std::string& text) {
+    std::unique_ptr<FlatNode> node(new FlatNode(kString));
+    node->bytes_ = text;
+    return node;
+  }
+
+  static std::unique_ptr<FlatNode> OffsetVector() {
+    return std::unique_ptr<FlatNode>(new FlatNode(kOffsetVector));
+  }
+
+  /// @param bytes the structs of 8 bytes alignment
+  static std::unique_ptr<FlatNode> StructVector(const std::string& bytes,
+                                                uint32_t count) {
+    std::unique_ptr<FlatNode> node(new FlatNode(kStructVector));
+    node->bytes_ = bytes;
+    node->count_ = count;
+    return node;
+  }
+
+  /// @brief Add the scalar field of the table
+  /// @param size 1, 2, 4 or 8 bytes
+  FlatNode* AddScalar(int32_t id, uint64_t value, int32_t size) {
+    Field field;
+    field.id_ = id;
+    field.size_ = size;
+    field.value_ = value;
+    fields_.push_back(std::move(field));
+    return this;
+  }
+
+  /// @brief Add the offset field of the table
+  FlatNode* AddChild(int32_t id, std::unique_ptr<FlatNode> child) {
+    Field field;
+    field.id_ = id;
+    field.size_ = 4;
+    field.child_ = std::move(child);
+    fields_.push_back(std::move(field));
+    return this;
+  }
+
+  /// @brief Add the element of the offset vector
+  FlatNode* AddElement(std::unique_ptr<FlatNode> child) {
+    elements_.push_back(std::move(child));
+    return this;
+  }
+
+  /// @brief Write the node at the end of out
+  /// @return the position of the node
+  size_t Write(std::string* out) const {
+    switch (kind_) {
+      case kTable:
+        return WriteTable(out);
+      case kOffsetVector: {
+        Pad(out, 4);
+        size_t pos = out->size();
+        PutU32(out, static_cast<uint32_t>(elements_.size()));
+        out->append(elements_.size() * 4, '\0');
+        for (size_t i = 0; i < elements_.size(); i++) {
+          size_t slot = pos + 4 + i * 4;
+          size_t child = elements_[i]->Write(out);
+          SetU32(out, slot, static_cast<uint32_t>(child - slot));
+        }
+        return pos;
+      }
+      case kStructVector: {
+        /// the structs after the length are aligned to 8
+        while ((out->size() + 4) % 8 != 0) {
+          out->push_back('\0');
+        }
+        size_t pos = out->size();
+        PutU32(out, count_);
+        out->append(bytes_);
+        return pos;
+      }
+      default: {
+        Pad(out, 4);
+        size_t pos = out->size();
+        PutU32(out, static_cast<uint32_t>(bytes_.size()));
+        out->append(bytes_);
+        out->push_back('\0');
+        return pos;
+      }
+    }
+  }
+
+  /// @brief Get the flatbuffer with the node as the root
+  std::string Finish() const {
+    std::string out(4, '\0');
+    size_t root = Write(&out);
+    SetU32(&out, 0, static_cast<uint32_t>(root));
+    Pad(&out, 8);
+    return out;
+  }
+
+ private:
+  class Field {
+   public:
+    int32_t id_ = 0;
+    int32_t size_ = 0;
+    uint64_t value_ = 0;
+    std::unique_ptr<FlatNode> child_;
+  };
+
+  explicit FlatNode(Kind kind) : kind_(kind), count_(0) {}
+
+  size_t WriteTable(std::string* out) const {
+    /// the larger fields first, the table starts 8 bytes aligned
+    std::vector<size_t> order(fields_.size());
+    for (size_t i = 0; i < order.size(); i++) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      return fields_[a].size_ > fields_[b].size_;
+    });
+    std::vector<uint16_t> offsets(fields_.size(), 0);
+    size_t table_size = 4;
+    int32_t max_id = -1;
+    for (size_t i : order) {
+      size_t size = static_cast<size_t>(fields_[i].size_);
+      table_size = (table_size + size - 1) / size * size;
+      offsets[i] = static_cast<uint16_t>(table_size);
+      table_size += size;
+      max_id = std::max(max_id, fields_[i].id_);
+    }
+    std::vector<uint16_t> vtable(max_id + 1, 0);
+    for (size_t i = 0; i < fields_.size(); i++) {
+      vtable[fields_[i].id_] = offsets[i];
+    }
+    Pad(out, 2);
+    size_t vtable_pos = out->size();
+    PutU16(out, static_cast<uint16_t>(4 + vtable.size() * 2));
+    PutU16(out, static_cast<uint16_t>(table_size));
+    for (uint16_t offset : vtable) {
+      PutU16(out, offset);
+    }
+    Pad(out, 8);
+    size_t table_pos = out->size();
+    out->append(table_size, '\0');
+    /// the vtable is at the table position minus the soffset
+    SetU32(out, table_pos, static_cast<uint32_t>(table_pos - vtable_pos));
+    for (size_t i = 0; i < fields_.size(); i++) {
+      if (fields_[i].child_ != nullptr) {
+        continue;
+      }
+      for (int32_t b = 0; b < fields_[i].size_; b++) {
+        (*out)[table_pos + offsets[i] + b] =
+            static_cast<char>(fields_[i].value_ >> (b * 8));
+      }
+    }
+    for (size_t i = 0; i < fields_.size(); i++) {
+      if (fields_[i].child_ == nullptr) {
+        continue;
+      }
+      size_t slot = table_pos + offsets[i];
+      size_t child = fields_[i].child_->Write(out);
+      SetU32(out, slot, static_cast<uint32_t>(child - slot));
+    }
+    return table_pos;
+  }
+
+ private:
+  Kind kind_;
+  std::vector<Field> fields_;
+  std::vector<std::unique_ptr<FlatNode>> elements_;
+  std::string bytes_;
+  uint32_t count_;
+};
+
+std::unique_ptr<FlatNode> BuildKeyValues(
+    const std::vector<ArrowMetadata>& metadata) {
+  std::unique_ptr<FlatNode> key_values = FlatNode::OffsetVector();
+  for (const auto& item : metadata) {
+    std::unique_ptr<FlatNode> key_value = FlatNode::Table();
+    key_value->AddChild(0, FlatNode::String(item.first));
+    key_value->AddChild(1, FlatNode::String(item.second));
+    key_values->AddElement(std::move(key_value));
+  }
+  return key_values;
+}
+
+/// @brief the Field table of the column
+std::unique_ptr<FlatNode> BuildField(const ArrowColumn& column) {
+  std::unique_ptr<FlatNode> type = FlatNode::Table();
+  uint8_t type_type = kTypeInt;
+  switch (column.type_) {
+    case ArrowColumn::kInt32:
+      type->AddScalar(0, 32, 4)->AddScalar(1, 1, 1);
+      break;
+    case ArrowColumn::kInt64:
+      type->AddScalar(0, 64, 4)->AddScalar(1, 1, 1);
+      break;
+    case ArrowColumn::kFloat64:
+      type_type = kTypeFloatingPoint;
+      type->AddScalar(0, kPrecisionDouble, 2);
+      break;
+    case ArrowColumn::kTimestampMs:
+      type_type = kTypeTimestamp;
+      type->AddScalar(0, kTimeUnitMillisecond, 2);
+      break;
+  }
+  std::unique_ptr<FlatNode> field = FlatNode::Table();
+  field->AddChild(0, FlatNode::String(column.name_));
+  field->AddScalar(1, 0, 1);
+  field->AddScalar(2, type_type, 1);
+  field->AddChild(3, std::move(type));
+  field->AddChild(5, FlatNode::OffsetVector());
+  return field;
+}
+
+std::unique_ptr<FlatNode> BuildSchema(
+    const std::vector<ArrowColumn>& columns,
+    const std::vector<ArrowMetadata>& metadata) {
+  std::unique_ptr<FlatNode> fields = FlatNode::OffsetVector();
+  for (const auto& column : columns) {
+    fields->AddElement(BuildField(column));
+  }
+  std::unique_ptr<FlatNode> schema = FlatNode::Table();
+  /// endianness little
+  schema->AddScalar(0, 0, 2);
+  schema->AddChild(1, std::move(fields));
+  schema->AddChild(2, BuildKeyValues(metadata));
+  return schema;
+}
+
+std::unique_ptr<FlatNode> BuildMessage(uint8_t header_type,
+                                       std::unique_ptr<FlatNode> header,
+                                       int64_t body_length) {
+  std::unique_ptr<FlatNode> message = FlatNode::Table();
+  message->AddScalar(0, kMetadataV5, 2);
+  message->AddScalar(1, header_type, 1);
+  message->AddChild(2, std::move(header));
+  message->AddScalar(3, static_cast<uint64_t>(body_length), 8);
+  return message;
+}
+
+std::string DoubleToString(double value) {
+  std::ostringstream out;
+  out << std::setprecision(15) << value;
+  return out.str();
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////
+// clz ArrowColumn
+ArrowColumn::ArrowColumn() : type_(kFloat64) {}
+
+ArrowColumn::ArrowColumn(const std::string& name, Type type)
+    : name_(name), type_(type) {}
+
+////////////////////////////////////////////////////////////
+// clz ArrowValue
+ArrowValue::ArrowValue() : integer_(0), real_(0) {}
+
+ArrowValue::ArrowValue(int32_t value) : integer_(value), real_(value) {}
+
+ArrowValue::ArrowValue(int64_t value)
+    : integer_(value), real_(static_cast<double>(value)) {}
+
+ArrowValue::ArrowValue(double value)
+    : integer_(static_cast<int64_t>(value)), real_(value) {}
+
+////////////////////////////////////////////////////////////
+// clz ArrowFileWriter
+const uint32_t ArrowFileWriter::kDefaultBatchRows;
+
+ArrowFileWriter::ArrowFileWriter(uint32_t batch_rows)
+    : batch_rows_(batch_rows > 0 ? batch_rows : kDefaultBatchRows),
+      file_(nullptr),
+      offset_(0),
+      pending_rows_(0),
+      rows_(0) {}
+
+ArrowFileWriter::~ArrowFileWriter() {
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+int32_t ArrowFileWriter::Open(const std::string& file_pathname,
+                              const std::vector<ArrowColumn>& columns,
+                              const std::vector<ArrowMetadata>& metadata) {
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+  if (columns.empty()) {
+    return -2;
+  }
+  if (!anx::common::MakeSureFolderPathExist(file_pathname)) {
+    LOG_F(LG_ERROR) << "Failed to make sure folder path exist: "
+                    << file_pathname;
+    return -1;
+  }
+  file_ = fopen(file_pathname.c_str(), "wb");
+  if (file_ == nullptr) {
+    LOG_F(LG_ERROR) << "Failed to open file: " << file_pathname;
+    return -1;
+  }
+  columns_ = columns;
+  metadata_ = metadata;
+  values_.assign(columns.size(), std::string());
+  pending_rows_ = 0;
+  rows_ = 0;
+  offset_ = 0;
+  blocks_.clear();
+  std::string magic(kMagic, sizeof(kMagic));
+  magic.append(2, '\0');
+  if (WriteBytes(magic) != 0) {
+    return -3;
+  }
+  std::string schema =
+      BuildMessage(kMessageHeaderSchema, BuildSchema(columns_, metadata_), 0)
+          ->Finish();
+  Block block;
+  return WriteMessage(schema, std::string(), &block);
+}
+
+int32_t ArrowFileWriter::AppendRow(const std::vector<ArrowValue>& row) {
+  if (file_ == nullptr) {
+    return -1;
+  }
+  if (row.size() != columns_.size()) {
+    return -2;
+  }
+  for (size_t i = 0; i < row.size(); i++) {
+    switch (columns_[i].type_) {
+      case ArrowColumn::kInt32:
+        PutU32(&values_[i], static_cast<uint32_t>(row[i].integer_));
+        break;
+      case ArrowColumn::kFloat64:
+        PutF64(&values_[i], row[i].real_);
+        break;
+      default:
+        PutU64(&values_[i], static_cast<uint64_t>(row[i].integer_));
+        break;
+    }
+  }
+  pending_rows_++;
+  rows_++;
+  if (pending_rows_ >= batch_rows_) {
+    return FlushBatch();
+  }
+  return 0;
+}
+
+int32_t ArrowFileWriter::Close() {
+  if (file_ == nullptr) {
+    return -1;
+  }
+  int32_t ret = FlushBatch();
+  if (ret == 0) {
+    /// the end of stream marker
+    std::string eos;
+    PutU32(&eos, kContinuation);
+    PutU32(&eos, 0);
+    ret = WriteBytes(eos);
+  }
+  if (ret == 0) {
+    std::string blocks;
+    for (const auto& block : blocks_) {
+      PutU64(&blocks, static_cast<uint64_t>(block.offset_));
+      PutU32(&blocks, static_cast<uint32_t>(block.metadata_length_));
+      PutU32(&blocks, 0);
+      PutU64(&blocks, static_cast<uint64_t>(block.body_length_));
+    }
+    std::unique_ptr<FlatNode> footer = FlatNode::Table();
+    footer->AddScalar(0, kMetadataV5, 2);
+    footer->AddChild(1, BuildSchema(columns_, metadata_));
+    footer->AddChild(2, FlatNode::StructVector(std::string(), 0));
+    footer->AddChild(3, FlatNode::StructVector(
+                            blocks, static_cast<uint32_t>(blocks_.size())));
+    std::string bytes = footer->Finish();
+    PutU32(&bytes, static_cast<uint32_t>(bytes.size()));
+    bytes.append(kMagic, sizeof(kMagic));
+    ret = WriteBytes(bytes);
+  }
+  if (fclose(file_) != 0 && ret == 0) {
+    ret = -3;
+  }
+  file_ = nullptr;
+  values_.clear();
+  return ret;
+}
+
+int32_t ArrowFileWriter::FlushBatch() {
+  if (pending_rows_ == 0) {
+    return 0;
+  }
+  /// per column the validity buffer of no nulls and the values buffer
+  std::string body;
+  std::string nodes;
+  std::string buffers;
+  for (size_t i = 0; i < columns_.size(); i++) {
+    PutU64(&nodes, pending_rows_);
+    PutU64(&nodes, 0);
+    PutU64(&buffers, body.size());
+    PutU64(&buffers, 0);
+    PutU64(&buffers, body.size());
+    PutU64(&buffers, values_[i].size());
+    body.append(values_[i]);
+    Pad(&body, kBufferAlignment);
+    values_[i].clear();
+  }
+  std::unique_ptr<FlatNode> batch = FlatNode::Table();
+  batch->AddScalar(0, pending_rows_, 8);
+  batch->AddChild(
+      1, FlatNode::StructVector(nodes, static_cast<uint32_t>(columns_.size())));
+  batch->AddChild(2, FlatNode::StructVector(
+                         buffers, static_cast<uint32_t>(columns_.size() * 2)));
+  std::string message =
+      BuildMessage(kMessageHeaderRecordBatch, std::move(batch),
+                   static_cast<int64_t>(body.size()))
+          ->Finish();
+  pending_rows_ = 0;
+  Block block;
+  int32_t ret = WriteMessage(message, body, &block);
+  if (ret == 0) {
+    blocks_.push_back(block);
+  }
+  return ret;
+}
+
+int32_t ArrowFileWriter::WriteMessage(const std::string& metadata,
+                                      const std::string& body,
+                                      Block* block) {
+  block->offset_ = offset_;
+  std::string prefix;
+  PutU32(&prefix, kContinuation);
+  /// the metadata is padded so the body starts at the aligned offset
+  size_t size = metadata.size();
+  while ((offset_ + 8 + size) % kBufferAlignment != 0) {
+    size += 8;
+  }
+  PutU32(&prefix, static_cast<uint32_t>(size));
+  std::string padded = metadata;
+  padded.append(size - metadata.size(), '\0');
+  block->metadata_length_ = static_cast<int32_t>(8 + size);
+  block->body_length_ = static_cast<int64_t>(body.size());
+  if (WriteBytes(prefix) != 0 || WriteBytes(padded) != 0 ||
+      WriteBytes(body) != 0) {
+    return -3;
+  }
+  return 0;
+}
+
+int32_t ArrowFileWriter::WriteBytes(const std::string& bytes) {
+  if (bytes.empty()) {
+    return 0;
+  }
+  if (fwrite(bytes.data(), 1, bytes.size(), file_) != bytes.size()) {
+    LOG_F(LG_ERROR) << "Failed to write the arrow file";
+    return -3;
+  }
+  offset_ += static_cast<int64_t>(bytes.size());
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// helper function
+std::vector<ArrowMetadata> ExperimentReportArrowMetadata(
+    const ExperimentReport& exp_report) {
+  std::vector<ArrowMetadata> metadata;
+  metadata.push_back(
+      ArrowMetadata("StartTime", std::to_string(exp_report.start_time_)));
+  metadata.push_back(
+      ArrowMetadata("EndTime", std::to_string(exp_report.end_time_)));
+  metadata.push_back(
+      ArrowMetadata("ExperimentName", exp_report.experiment_name_));
+  metadata.push_back(ArrowMetadata(
+      "ElasticModulus", DoubleToString(exp_report.elastic_modulus_)));
+  metadata.push_back(
+      ArrowMetadata("Density", DoubleToString(exp_report.density_)));
+  metadata.push_back(
+      ArrowMetadata("MaxStress", DoubleToString(exp_report.max_stress_)));
+  metadata.push_back(
+      ArrowMetadata("RatioOfStress", DoubleToString(exp_report.ratio_stress_)));
+  metadata.push_back(
+      ArrowMetadata("CycleCount", std::to_string(exp_report.cycle_count_)));
+  metadata.push_back(
+      ArrowMetadata("BottomAmplitude", DoubleToString(exp_report.amplitude_)));
+  metadata.push_back(
+      ArrowMetadata("IntermittentExp", std::to_string(exp_report.exp_type_)));
+  metadata.push_back(ArrowMetadata(
+      "ExcitationTime", std::to_string(exp_report.excitation_time_)));
+  metadata.push_back(
+      ArrowMetadata("IntervalTime", std::to_string(exp_report.interval_time_)));
+  metadata.push_back(
+      ArrowMetadata("ExpMode", std::to_string(exp_report.exp_mode_)));
+  return metadata;
+}
+
+int32_t SaveExperimentDataToArrow(const ExperimentReport& exp_report,
+                                  const std::string& db_name,
+                                  const std::string& table,
+                                  const std::string& file_pathname) {
+  std::vector<std::map<std::string, std::string>> result;
+  std::string sql_str = "PRAGMA table_info(" + table + ");";
+  if (!anx::db::helper::QueryDataBase(db_name, table, sql_str, &result) ||
+      result.empty()) {
+    LOG_F(LG_ERROR) << "Failed to read table: " << table;
+    return -1;
+  }
+  /// @note the date of the exp data tables is the variant time of the local
+  /// time, stored as the timestamp without the time zone.
+  std::vector<ArrowColumn> columns;
+  for (auto& row : result) {
+    const std::string& name = row["name"];
+    ArrowColumn::Type type = ArrowColumn::kFloat64;
+    if (name == "date") {
+      type = ArrowColumn::kTimestampMs;
+    } else if (name == "state") {
+      type = ArrowColumn::kInt32;
+    } else if (row["type"] == "INTEGER") {
+      type = ArrowColumn::kInt64;
+    }
+    columns.push_back(ArrowColumn(name, type));
+  }
+  ArrowFileWriter writer;
+  if (writer.Open(file_pathname, columns,
+                  ExperimentReportArrowMetadata(exp_report)) != 0) {
+    return -2;
+  }
+  anx::db::DatabaseCursor cursor(db_name, table);
+  int64_t after_id = 0;
+  while (true) {
+    if (!cursor.NextPage(after_id, ArrowFileWriter::kDefaultBatchRows / 4,
+                         &result)) {
+      writer.Close();
+      anx::common::RemoveFile(file_pathname);
+      return -1;
+    }
+    if (result.empty()) {
+      break;
+    }
+    for (auto& row : result) {
+      std::vector<ArrowValue> values;
+      for (auto& column : columns) {
+        const std::string& text = row[column.name_];
+        double real = text.empty() ? 0.0 : strtod(text.c_str(), nullptr);
+        if (column.type_ == ArrowColumn::kTimestampMs) {
+          values.push_back(ArrowValue(static_cast<int64_t>(std::llround(
+              (real - kVariantTimeUnixEpoch) * kMillisecondsPerDay))));
+        } else if (column.type_ == ArrowColumn::kFloat64) {
+          values.push_back(ArrowValue(real));
+        } else {
+          values.push_back(ArrowValue(static_cast<int64_t>(
+              text.empty() ? 0 : strtoll(text.c_str(), nullptr, 10))));
+        }
+      }
+      if (writer.AppendRow(values) != 0) {
+        writer.Close();
+        anx::common::RemoveFile(file_pathname);
+        return -2;
+      }
+    }
+    after_id = cursor.last_id();
+  }
+  if (writer.Close() != 0) {
+    anx::common::RemoveFile(file_pathname);
+    return -2;
+  }
+  return 0;
+}
+
+}  // namespace expdata
+}  // namespace anx
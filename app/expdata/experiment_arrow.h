@@ -0,0 +1,157 @@
+/**
+ * @file experiment_arrow.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the columnar export of the experiment data in the arrow ipc file
+ * format, feather v2. the columns are written as uncompressed record batches
+ * with the buffers aligned to 64 bytes, the file is memory mapped by pyarrow
+ * without parsing. the flatbuffers of the metadata are built in place, no
+ * arrow or flatbuffers library is needed.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_EXPDATA_EXPERIMENT_ARROW_H_
+#define APP_EXPDATA_EXPERIMENT_ARROW_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace anx {
+namespace expdata {
+
+class ExperimentReport;
+
+/// @brief the file extension of the arrow file
+extern const char* kExperimentArrowExtension;
+
+/// @brief the column of the arrow file, no nulls
+class ArrowColumn {
+ public:
+  enum Type {
+    kInt32 = 0,
+    kInt64 = 1,
+    kFloat64 = 2,
+    /// @brief the milliseconds of the timestamp without the time zone
+    kTimestampMs = 3,
+  };
+
+  ArrowColumn();
+  ArrowColumn(const std::string& name, Type type);
+
+ public:
+  std::string name_;
+  Type type_;
+};
+
+/// @brief one value of an arrow row, integer_ for the integer and the
+/// timestamp column and real_ for the float column.
+class ArrowValue {
+ public:
+  ArrowValue();
+  ArrowValue(int32_t value);  // NOLINT
+  ArrowValue(int64_t value);  // NOLINT
+  ArrowValue(double value);   // NOLINT
+
+ public:
+  int64_t integer_;
+  double real_;
+};
+
+/// @brief the key and the value of the schema metadata
+typedef std::pair<std::string, std::string> ArrowMetadata;
+
+/// @brief write the arrow ipc file, the rows are buffered by column until a
+/// batch is full and then written as one record batch. Close writes the
+/// footer, the file without the footer is not readable.
+class ArrowFileWriter {
+ public:
+  /// @brief Constructor
+  /// @param batch_rows the rows of one record batch
+  explicit ArrowFileWriter(uint32_t batch_rows = kDefaultBatchRows);
+  ~ArrowFileWriter();
+
+  ArrowFileWriter(const ArrowFileWriter&) = delete;
+  ArrowFileWriter& operator=(const ArrowFileWriter&) = delete;
+
+ public:
+  /// @brief Open the file to write and write the schema, the file is
+  /// truncated
+  /// @param columns the columns of the schema
+  /// @param metadata the metadata of the schema
+  /// @return 0 if success, -1 if the file can't be opened, -2 if the columns
+  /// are invalid, -3 if write failed
+  int32_t Open(const std::string& file_pathname,
+               const std::vector<ArrowColumn>& columns,
+               const std::vector<ArrowMetadata>& metadata);
+
+  /// @brief Append a row
+  /// @param row the values in the column order
+  /// @return 0 if success, -1 if not opened, -2 if the value count mismatch,
+  /// -3 if write failed
+  int32_t AppendRow(const std::vector<ArrowValue>& row);
+
+  /// @brief Write the last batch and the footer and close the file
+  /// @return 0 if success, -1 if not opened, -3 if write failed
+  int32_t Close();
+
+  /// @brief Get the rows appended
+  int64_t rows() const { return rows_; }
+
+  /// @brief the default rows of one record batch
+  static const uint32_t kDefaultBatchRows = 65536;
+
+ private:
+  class Block {
+   public:
+    int64_t offset_;
+    int32_t metadata_length_;
+    int64_t body_length_;
+  };
+  int32_t FlushBatch();
+  /// @brief Write the encapsulated message, the body starts at the 64 bytes
+  /// aligned offset of the file.
+  int32_t WriteMessage(const std::string& metadata,
+                       const std::string& body,
+                       Block* block);
+  int32_t WriteBytes(const std::string& bytes);
+
+ private:
+  uint32_t batch_rows_;
+  FILE* file_;
+  int64_t offset_;
+  std::vector<ArrowColumn> columns_;
+  std::vector<ArrowMetadata> metadata_;
+  /// @brief the little endian values of the batch by column
+  std::vector<std::string> values_;
+  uint32_t pending_rows_;
+  int64_t rows_;
+  std::vector<Block> blocks_;
+};
+
+/// @brief Get the fields of the report as the schema metadata
+std::vector<ArrowMetadata> ExperimentReportArrowMetadata(
+    const ExperimentReport& exp_report);
+
+/// @brief Save the exp data table of the database to the arrow file, the
+/// report is stored as the schema metadata. id, cycle and the integers are
+/// int64, state is int32, date is the timestamp of the local time and the
+/// others are float64.
+/// @param db_name the database name, see helper::QueryDataBase
+/// @param table the exp data table, e.g. exp_data_list
+/// @return int32_t 0 if success, -1 if the table can't be read, -2 if the
+/// file can't be written
+int32_t SaveExperimentDataToArrow(const ExperimentReport& exp_report,
+                                  const std::string& db_name,
+                                  const std::string& table,
+                                  const std::string& file_pathname);
+
+}  // namespace expdata
+}  // namespace anx
+
+#endif  // APP_EXPDATA_EXPERIMENT_ARROW_H_
@@ -0,0 +1,224 @@
+/**
+ * @file experiment_arrow_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief experiment arrow unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "app/common/file_utils.h"
+#include "app/common/module_utils.h"
+#include "app/db/database_factory.h"
+#include "app/db/database_helper.h"
+#include "app/expdata/experiment_arrow.h"
+#include "app/expdata/experiment_data_base.h"
+
+namespace anx {
+namespace expdata {
+namespace {
+template <typename T>
+T ReadAt(const std::string& content, size_t pos) {
+  T value;
+  memcpy(&value, content.data() + pos, sizeof(T));
+  return value;
+}
+
+/// @brief Get the position of the field of the flatbuffer table
+/// @return the position, 0 if the field is absent
+size_t FlatField(const std::string& content, size_t table, int32_t id) {
+  size_t vtable = table - ReadAt<int32_t>(content, table);
+  uint16_t vtable_size = ReadAt<uint16_t>(content, vtable);
+  if (4 + id * 2 >= vtable_size) {
+    return 0;
+  }
+  uint16_t offset = ReadAt<uint16_t>(content, vtable + 4 + id * 2);
+  return offset == 0 ? 0 : table + offset;
+}
+
+/// @brief the encapsulated record batch of the arrow file
+class Batch {
+ public:
+  int64_t length_ = 0;
+  size_t body_ = 0;
+};
+
+/// @brief Read the messages after the schema until the end of stream
+/// @return the footer position, 0 if the file is invalid
+size_t ReadBatches(const std::string& content, std::vector<Batch>* batches) {
+  if (content.size() < 20 || content.compare(0, 8, "ARROW1\0\0", 8) != 0 ||
+      content.compare(content.size() - 6, 6, "ARROW1") != 0) {
+    return 0;
+  }
+  size_t pos = 8;
+  while (pos + 8 <= content.size()) {
+    EXPECT_EQ(ReadAt<uint32_t>(content, pos), 0xFFFFFFFFu);
+    int32_t size = ReadAt<int32_t>(content, pos + 4);
+    if (size == 0) {
+      return pos + 8;
+    }
+    std::string message = content.substr(pos + 8, size);
+    size_t root = ReadAt<uint32_t>(message, 0);
+    int64_t body_length = ReadAt<int64_t>(message, FlatField(message, root, 3));
+    Batch batch;
+    batch.body_ = pos + 8 + size;
+    /// the body starts 64 bytes aligned
+    EXPECT_EQ(batch.body_ % 64, 0u);
+    if (message[FlatField(message, root, 1)] == 3) {
+      size_t header_field = FlatField(message, root, 2);
+      size_t header = header_field + ReadAt<uint32_t>(message, header_field);
+      batch.length_ = ReadAt<int64_t>(message, FlatField(message, header, 0));
+      batches->push_back(batch);
+    }
+    pos = batch.body_ + body_length;
+  }
+  return 0;
+}
+}  // namespace
+
+class ExperimentArrowTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    folder_ = anx::common::GetModuleDir() + anx::common::kPathSeparator +
+              "expdata_unittest";
+    anx::common::MakeSureFolderPathExist(FileName("x"));
+  }
+  void TearDown() override {
+    anx::db::DatabaseFactory::Instance()->CloseAllDatabase();
+  }
+
+  std::string FileName(const std::string& name) {
+    return folder_ + anx::common::kPathSeparator + name;
+  }
+
+  std::string folder_;
+};
+
+TEST_F(ExperimentArrowTest, WriteBatchesAligned) {
+  std::string file_pathname = FileName("batches.arrow");
+  std::vector<ArrowColumn> columns;
+  columns.push_back(ArrowColumn("id", ArrowColumn::kInt64));
+  columns.push_back(ArrowColumn("state", ArrowColumn::kInt32));
+  columns.push_back(ArrowColumn("kHz", ArrowColumn::kFloat64));
+  columns.push_back(ArrowColumn("date", ArrowColumn::kTimestampMs));
+  std::vector<ArrowMetadata> metadata;
+  metadata.push_back(ArrowMetadata("ExperimentName", "batches"));
+  ArrowFileWriter writer(3);
+  ASSERT_EQ(writer.Open(file_pathname, columns, metadata), 0);
+  for (int32_t i = 1; i <= 7; i++) {
+    std::vector<ArrowValue> row;
+    row.push_back(ArrowValue(static_cast<int64_t>(i)));
+    row.push_back(ArrowValue(i % 2));
+    row.push_back(ArrowValue(20.0 + i / 1000.0));
+    row.push_back(ArrowValue(static_cast<int64_t>(1700000000000) + i));
+    ASSERT_EQ(writer.AppendRow(row), 0);
+  }
+  EXPECT_EQ(writer.rows(), 7);
+  ASSERT_EQ(writer.Close(), 0);
+
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  std::vector<Batch> batches;
+  size_t footer = ReadBatches(content, &batches);
+  ASSERT_GT(footer, 0u);
+  /// the footer size is before the trailing magic
+  EXPECT_EQ(footer + ReadAt<int32_t>(content, content.size() - 10),
+            content.size() - 10);
+  EXPECT_NE(content.find("ExperimentName"), std::string::npos);
+  ASSERT_EQ(batches.size(), 3u);
+  EXPECT_EQ(batches[0].length_, 3);
+  EXPECT_EQ(batches[2].length_, 1);
+  /// the values buffers of the columns are 64 bytes aligned in the body
+  size_t body = batches[1].body_;
+  EXPECT_EQ(ReadAt<int64_t>(content, body), 4);
+  EXPECT_EQ(ReadAt<int64_t>(content, body + 16), 6);
+  EXPECT_EQ(ReadAt<int32_t>(content, body + 64), 0);
+  EXPECT_EQ(ReadAt<int32_t>(content, body + 64 + 4), 1);
+  EXPECT_DOUBLE_EQ(ReadAt<double>(content, body + 128), 20.004);
+  EXPECT_EQ(ReadAt<int64_t>(content, body + 192), 1700000000004);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentArrowTest, EmptyAndInvalid) {
+  std::string file_pathname = FileName("empty.arrow");
+  ArrowFileWriter writer;
+  std::vector<ArrowValue> row;
+  row.push_back(ArrowValue(1));
+  EXPECT_EQ(writer.AppendRow(row), -1);
+  EXPECT_EQ(writer.Close(), -1);
+  std::vector<ArrowColumn> columns;
+  EXPECT_EQ(writer.Open(file_pathname, columns, {}), -2);
+  columns.push_back(ArrowColumn("id", ArrowColumn::kInt64));
+  columns.push_back(ArrowColumn("kHz", ArrowColumn::kFloat64));
+  ASSERT_EQ(writer.Open(file_pathname, columns, {}), 0);
+  EXPECT_EQ(writer.AppendRow(row), -2);
+  ASSERT_EQ(writer.Close(), 0);
+  /// the file without the batches is valid
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  std::vector<Batch> batches;
+  EXPECT_GT(ReadBatches(content, &batches), 0u);
+  EXPECT_TRUE(batches.empty());
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentArrowTest, SaveExperimentDataToArrow) {
+  std::string db_name = FileName("exp_arrow.db");
+  anx::db::helper::ClearDatabaseFile(db_name);
+  ASSERT_TRUE(anx::db::helper::CreateExperimentDataTables(db_name));
+  for (int32_t i = 1; i <= 1000; i++) {
+    std::vector<anx::db::DatabaseValue> params;
+    params.push_back(anx::db::DatabaseValue(i * 100));
+    params.push_back(anx::db::DatabaseValue(20.0 + (i % 7) * 0.001));
+    params.push_back(anx::db::DatabaseValue(100.0));
+    params.push_back(anx::db::DatabaseValue(i * 0.5));
+    params.push_back(anx::db::DatabaseValue(i % 2));
+    /// the variant time of 2024-01-01 00:00:00 and i seconds
+    params.push_back(anx::db::DatabaseValue(45292.0 + i / 86400.0));
+    ASSERT_TRUE(anx::db::helper::InsertDataTable(
+        db_name, anx::db::helper::kTableExpDataGraph,
+        anx::db::helper::sql::kInsertTableExpDataGraphSqlPrepared, params));
+  }
+  ExperimentReport report;
+  report.start_time_ = 1704067200;
+  report.experiment_name_ = "arrow";
+  std::string file_pathname = FileName("exp_arrow.arrow");
+  ASSERT_EQ(SaveExperimentDataToArrow(report, db_name,
+                                      anx::db::helper::kTableExpDataGraph,
+                                      file_pathname),
+            0);
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  EXPECT_NE(content.find("1704067200"), std::string::npos);
+  std::vector<Batch> batches;
+  ASSERT_GT(ReadBatches(content, &batches), 0u);
+  ASSERT_EQ(batches.size(), 1u);
+  ASSERT_EQ(batches[0].length_, 1000);
+  /// id, cycle, kHz, MPa, μm, state and date, 8000 bytes per int64 column
+  size_t body = batches[0].body_;
+  EXPECT_EQ(ReadAt<int64_t>(content, body + 8), 2);
+  EXPECT_EQ(ReadAt<int64_t>(content, body + 8000 + 8), 200);
+  EXPECT_DOUBLE_EQ(ReadAt<double>(content, body + 4 * 8000 + 8), 1.0);
+  EXPECT_EQ(ReadAt<int32_t>(content, body + 5 * 8000 + 4), 0);
+  /// the state column is 4000 bytes padded to 4032
+  EXPECT_EQ(ReadAt<int64_t>(content, body + 5 * 8000 + 4032 + 8),
+            1704067202000);
+  anx::common::RemoveFile(file_pathname);
+
+  EXPECT_EQ(SaveExperimentDataToArrow(report, db_name, "no_table",
+                                      file_pathname),
+            -1);
+  EXPECT_FALSE(anx::common::FileExists(file_pathname));
+  anx::db::helper::ClearDatabaseFile(db_name);
+}
+
+}  // namespace expdata
+}  // namespace anx
@@ -15,6 +15,7 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #if defined(WIN32)
@@ -29,6 +30,7 @@ extern "C" {
 #include "app/common/num_string_convert.hpp"
 #include "app/common/string_utils.h"
 #include "app/expdata/LibOb_strptime.h"
+#include "app/expdata/docx_report.h"
 
 #include "third_party/tinyxml2/source/tinyxml2.h"
 
@@ -107,6 +109,18 @@ int32_t SaveExperimentDataToCsvWithDefaultPath(
     const ExperimentReport& exp_report,
     const std::vector<anx::expdata::ExperimentData>& exp_data,
     std::string* file_pathname) {
+  std::string default_csv;
+  if (ExperimentDataCsvDefaultPathname(exp_report, &default_csv) != 0) {
+    return -1;
+  }
+  if (file_pathname != nullptr) {
+    *file_pathname = default_csv;
+  }
+  return SaveExperimentDataFile(default_csv, exp_data);
+}
+
+int32_t ExperimentDataCsvDefaultPathname(const ExperimentReport& exp_report,
+                                         std::string* file_pathname) {
   // format file name as start_time_stop_time.csv
   // represent as 2024-08-11_12-00-00_2024-08-11_12-00-00.csv
   std::string start_time_str = TimeToString(exp_report.start_time_);
@@ -123,14 +137,18 @@ int32_t SaveExperimentDataToCsvWithDefaultPath(
     return -1;
   }
 
-  default_csv = app_data_dir + anx::common::kPathSeparator + default_csv;
-  if (file_pathname != nullptr) {
-    *file_pathname = default_csv;
-  }
-  return SaveExperimentDataFile(default_csv, exp_data);
+  *file_pathname = app_data_dir + anx::common::kPathSeparator + default_csv;
+  return 0;
 }
 ////////////////////////////////////////////////////////////////////////////////
-ExperimentFileSummary::ExperimentFileSummary() {}
+ExperimentFileSummary::ExperimentFileSummary()
+    : start_time_(0),
+      end_time_(0),
+      cycle_count_(0),
+      duration_(0),
+      final_khz_(0),
+      rows_(0),
+      file_size_(0) {}
 ExperimentFileSummary::~ExperimentFileSummary() {}
 
 namespace {
@@ -226,28 +244,6 @@ int32_t TraverseExpDataFolder(
 
 ////////////////////////////////////////////////////////////////////////////////
 namespace {
-int32_t win_system(const std::string& cmd, const std::string& par) {
-  DWORD ReturnValue = -1;
-  SHELLEXECUTEINFOA ShExecInfo = {0};
-  ShExecInfo.cbSize = sizeof(SHELLEXECUTEINFO);
-  ShExecInfo.fMask = SEE_MASK_NOCLOSEPROCESS;
-  ShExecInfo.hwnd = NULL;
-  ShExecInfo.lpVerb = NULL;
-  ShExecInfo.lpFile = cmd.c_str();
-  ShExecInfo.lpParameters = par.c_str();
-  ShExecInfo.lpDirectory = NULL;
-  ShExecInfo.nShow = SW_HIDE;
-  ShExecInfo.hInstApp = NULL;
-  if (!ShellExecuteExA(&ShExecInfo)) {
-    return -1;
-  }
-  WaitForSingleObject(ShExecInfo.hProcess, INFINITE);
-  if (!GetExitCodeProcess(ShExecInfo.hProcess, &ReturnValue)) {
-    return -2;
-  }
-  return ReturnValue;
-}
-
 void MakeFolderPathByDate(const std::string& root,
                           struct tm tm,
                           std::string* folder_pathname) {
@@ -451,37 +447,26 @@ int32_t SaveExperimentReportToXmlWithDefaultPath(
   return 0;
 }
 
-int32_t SaveReportToDocxWithDefaultPath(const ExperimentReport& exp_report,
-                                        const std::string& cvs_file_pathname,
-                                        std::string* file_pathname,
-                                        int32_t path_rules) {
-  // 1. generate xml file with experiment final result and experiment
-  // parameters.
-  // 2. generate csv file with the experiment data.
-  // 3. call program `todocx` with 1 and 2 to generate the final report docx
-  // file.
-  // 4. remove the temp xml and csv file.
+namespace {
+/// @brief make the report folder and the docx file path name
+/// @return 0 if success, -1 if the folder can't be made, -4 if the time is
+/// invalid, -5 if the date folder can't be made
+int32_t ReportDocxPathname(const ExperimentReport& exp_report,
+                           int32_t path_rules,
+                           std::string* template_file,
+                           std::string* file_pathname) {
   // get module path
   std::string app_data_dir = anx::common::GetApplicationDataPath("anxi");
-  // generate xml file, save to the module dir
-  //// copy file to the expreport dir under the module dir
   std::string exp_report_dir =
       app_data_dir + anx::common::kPathSeparator + "expreport";
   if (!anx::common::MakeSureFolderPathExist(exp_report_dir)) {
     LOG_F(LG_ERROR) << "make sure folder path exist failed:" << exp_report_dir;
     return -1;
   }
-  std::string xml_file =
-      exp_report_dir + anx::common::kPathSeparator + "summary.xml";
-  std::string xml_content = exp_report.ToXml();
-  if (!anx::common::WriteFile(xml_file, xml_content, true)) {
-    LOG_F(LG_ERROR) << "write file failed:" << xml_file;
-    return -2;
-  }
-  //// template file is in the app data dir
-  std::string template_file_src =
-      anx::common::GetModuleDir() + anx::common::kPathSeparator + "template" +
-      anx::common::kPathSeparator + "3th_report_template.docx";
+  //// template file is in the module dir
+  *template_file = anx::common::GetModuleDir() + anx::common::kPathSeparator +
+                   "template" + anx::common::kPathSeparator +
+                   "3th_report_template.docx";
   struct tm tm;
   /// @note convert start time to tm struct
   time_t time_point = exp_report.start_time_;
@@ -494,7 +479,7 @@ int32_t SaveReportToDocxWithDefaultPath(const ExperimentReport& exp_report,
 #ifdef _WIN32
   if (localtime_s(&tm, &time_point) != 0)
 #else
-  if (!localtime_r(&start_time, &tm))
+  if (!localtime_r(&time_point, &tm))
 #endif
   {
     LOG_F(LG_ERROR) << "localtime failed";
@@ -513,45 +498,85 @@ int32_t SaveReportToDocxWithDefaultPath(const ExperimentReport& exp_report,
       TimeToString(exp_report.start_time_, "%Y-%m-%d_%H-%M-%S") + "_" +
       TimeToString(exp_report.end_time_, "%Y-%m-%d_%H-%M-%S") + "+" +
       exp_report.experiment_name_ + ".docx";
-  std::string template_file_to =
+  std::string to_file_pathname =
       root_folder_path + anx::common::kPathSeparator + to_file_name;
+  *file_pathname =
+      anx::common::WString2String(anx::common::UTF8ToUnicode(to_file_pathname));
+  return 0;
+}
 
-  //// copy the template file to the expreport dir force overwrite
-  std::string src = template_file_src;
-  std::string to =
-      anx::common::WString2String(anx::common::UTF8ToUnicode(template_file_to));
-  if (!anx::common::CCopyFile(src.c_str(), to.c_str())) {
-    LOG_F(LG_ERROR) << "copy file failed:" << template_file_to;
-    return -6;
+int32_t SaveReportToDocx(const ExperimentReport& exp_report,
+                         std::unique_ptr<ReportRowSource> rows,
+                         std::string* file_pathname,
+                         int32_t path_rules) {
+  std::string template_file;
+  std::string to;
+  int32_t ret =
+      ReportDocxPathname(exp_report, path_rules, &template_file, &to);
+  if (ret != 0) {
+    return ret;
   }
-
-  /// @note start todocx program with args
-  ///       todocx.exe -j summary.xml -i input.csv -t template.docx
-  std::string todocx =
-      anx::common::GetModuleDir() + anx::common::kPathSeparator + "todocx.exe";
-  std::string args =
-      "-s " + xml_file + " -i " + cvs_file_pathname + " -t " + to;
-  std::string cmd = todocx + " " + args;
-  /// @note call the todocx program that is console program, hide the console
-  /// window wait for the program to finish, get result from the program and
-  /// remove the temp xml and csv file.
-  int ret;
-#if defined(_WIN32)
-  ret = win_system(todocx, args);
-#else
-  ret = system(cmd.c_str());
-#endif
+  /// @note the report is generated in process from the template, the
+  /// summary and the rows are streamed into the document part.
+  DocxReportGenerator generator(template_file, exp_report, std::move(rows),
+                                to);
+  ret = generator.Generate();
   if (ret != 0) {
-    LOG_F(LG_ERROR) << "call todocx failed:" << ret << " " << cmd;
+    LOG_F(LG_ERROR) << "generate docx report failed:" << ret << " " << to;
     return -7;  // NOLINT
   }
-  // remove the temp xml and csv file
-  remove(xml_file.c_str());
   if (file_pathname != nullptr) {
     *file_pathname = to;
   }
   return 0;
 }
+}  // namespace
+
+int32_t SaveReportToDocxWithDefaultPath(const ExperimentReport& exp_report,
+                                        const std::string& cvs_file_pathname,
+                                        std::string* file_pathname,
+                                        int32_t path_rules) {
+  std::unique_ptr<CsvRowSource> rows(new CsvRowSource());
+  if (rows->Open(cvs_file_pathname) != 0) {
+    return -2;
+  }
+  return SaveReportToDocx(exp_report, std::move(rows), file_pathname,
+                          path_rules);
+}
+
+int32_t StartReportToDocxWithDefaultPath(
+    const ExperimentReport& exp_report,
+    const std::string& cvs_file_pathname,
+    DocxReportListener* listener,
+    std::unique_ptr<DocxReportGenerator>* generator,
+    int32_t path_rules) {
+  std::unique_ptr<CsvRowSource> rows(new CsvRowSource());
+  if (rows->Open(cvs_file_pathname) != 0) {
+    return -2;
+  }
+  std::string template_file;
+  std::string to;
+  int32_t ret =
+      ReportDocxPathname(exp_report, path_rules, &template_file, &to);
+  if (ret != 0) {
+    return ret;
+  }
+  generator->reset(
+      new DocxReportGenerator(template_file, exp_report, std::move(rows), to));
+  (*generator)->set_listener(listener);
+  (*generator)->Start();
+  return 0;
+}
+
+int32_t SaveReportToDocxWithDefaultPath(
+    const ExperimentReport& exp_report,
+    const std::vector<anx::expdata::ExperimentData>& exp_data,
+    std::string* file_pathname,
+    int32_t path_rules) {
+  std::unique_ptr<ReportRowSource> rows(new VectorRowSource(&exp_data));
+  return SaveReportToDocx(exp_report, std::move(rows), file_pathname,
+                          path_rules);
+}
 
 }  // namespace expdata
 }  // namespace anx
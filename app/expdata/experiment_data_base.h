@@ -18,6 +18,8 @@
 
 namespace anx {
 namespace expdata {
+class DocxReportGenerator;
+class DocxReportListener;
 class ExperimentReport;
 class ExperimentData {
  public:
@@ -41,6 +43,14 @@ int32_t SaveExperimentDataToCsvWithDefaultPath(
     const std::vector<anx::expdata::ExperimentData>& exp_data,
     std::string* file_pathname = nullptr);
 
+/// @brief Get the default csv file path name of the experiment, the folder
+/// is made if not exist.
+/// @param exp_report the experiment report
+/// @param file_pathname the csv file path name
+/// @return int32_t 0 if success, -1 if the folder can't be made
+int32_t ExperimentDataCsvDefaultPathname(const ExperimentReport& exp_report,
+                                         std::string* file_pathname);
+
 class ExperimentFileSummary {
  public:
   ExperimentFileSummary();
@@ -50,6 +60,15 @@ class ExperimentFileSummary {
   std::string file_name_;
   uint64_t start_time_;
   uint64_t end_time_;
+  /// @brief the summary of the record, see ExperimentRecordIndex
+  int64_t cycle_count_;
+  /// @brief the duration in seconds
+  int64_t duration_;
+  /// @brief the frequency of the last data row, unit: kHz
+  double final_khz_;
+  int64_t rows_;
+  /// @brief the size of the csv file in bytes
+  int64_t file_size_;
 };
 
 /// @brief Traverse the directory expdata folder and get all the csv files
@@ -129,16 +148,45 @@ int32_t SaveExperimentReportToXmlWithDefaultPath(
     const ExperimentReport& exp_report,
     std::string* file_pathname = nullptr);
 
-/// @brief Save the report to the docx file
+/// @brief Save the report to the docx file, the report is generated from the
+/// template in process, see DocxReportGenerator.
 /// @param exp_report the experiment report
-/// @param cvs_file_pathname the csv file path name
+/// @param cvs_file_pathname the csv file path name of the data rows
 /// @param file_pathname the file path name of the docx file
-/// @return int32_t 0 if success, -1 if failed
+/// @return int32_t 0 if success, -2 if the csv file can't be read, -7 if the
+/// report generation failed, other negative if the folder can't be made
 int32_t SaveReportToDocxWithDefaultPath(const ExperimentReport& exp_report,
                                         const std::string& cvs_file_pathname,
                                         std::string* file_pathname = nullptr,
                                         int32_t path_rules = 2);
 
+/// @brief Start the report of the csv file on the worker thread of the
+/// generator, the progress and the result are reported to the listener on
+/// the worker thread, see DocxReportGenerator::Start.
+/// @param listener the listener of the generator, not owned
+/// @param generator the generator started, joined or destroyed by the caller
+/// after DocxReportListener::OnReportFinished
+/// @return int32_t 0 if started, -2 if the csv file can't be read, other
+/// negative if the folder can't be made
+int32_t StartReportToDocxWithDefaultPath(
+    const ExperimentReport& exp_report,
+    const std::string& cvs_file_pathname,
+    DocxReportListener* listener,
+    std::unique_ptr<DocxReportGenerator>* generator,
+    int32_t path_rules = 2);
+
+/// @brief Save the report to the docx file with the data rows in memory
+/// @param exp_report the experiment report
+/// @param exp_data the data rows
+/// @param file_pathname the file path name of the docx file
+/// @return int32_t 0 if success, -7 if the report generation failed, other
+/// negative if the folder can't be made
+int32_t SaveReportToDocxWithDefaultPath(
+    const ExperimentReport& exp_report,
+    const std::vector<anx::expdata::ExperimentData>& exp_data,
+    std::string* file_pathname = nullptr,
+    int32_t path_rules = 2);
+
 }  // namespace expdata
 }  // namespace anx
 
@@ -0,0 +1,578 @@
+/**
+ * @file experiment_export.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the bulk export of the experiment data tables.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/expdata/experiment_export.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#include <json/json.h>
+
+#include "app/common/file_utils.h"
+#include "app/common/logger.h"
+#include "app/db/database_cursor.h"
+#include "app/db/database_helper.h"
+#include "app/expdata/experiment_archive.h"
+
+namespace anx {
+namespace expdata {
+
+namespace {
+
+/// @note binary layout, all the numbers are little endian.
+/// header: magic "ANXB", u16 version, u16 column count, per column: u16 name
+///   size, name, u8 type 0 integer 1 real; u64 row count
+/// rows: per column i64 or f64
+const char kBinaryMagic[4] = {'A', 'N', 'X', 'B'};
+const uint16_t kBinaryVersion = 1;
+
+const char kCsvHeader[] = "id,cycle_count,KHz,MPa,μm\n";
+/// @brief the columns of the csv and the precisions of the reals, the same
+/// as SaveExperimentDataFile
+const char* kCsvColumns[] = {"id", "cycle", "kHz", "MPa", "μm"};
+const int32_t kCsvPrecisions[] = {-1, -1, 3, 6, 2};
+
+const int32_t kMaxThreads = 8;
+
+void PutU16(std::string* out, uint16_t value) {
+  for (int32_t i = 0; i < 2; i++) {
+    out->push_back(static_cast<char>(value >> (i * 8)));
+  }
+}
+
+void PutU64(std::string* out, uint64_t value) {
+  for (int32_t i = 0; i < 8; i++) {
+    out->push_back(static_cast<char>(value >> (i * 8)));
+  }
+}
+
+void PutF64(std::string* out, double value) {
+  uint64_t bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  PutU64(out, bits);
+}
+
+int64_t ToInt64(const std::string& text) {
+  return text.empty() ? 0 : strtoll(text.c_str(), nullptr, 10);
+}
+
+double ToDouble(const std::string& text) {
+  return text.empty() ? 0.0 : strtod(text.c_str(), nullptr);
+}
+
+void AppendFixed(std::string* out, double value, int32_t precision) {
+  char buffer[64];
+  int size = snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+  if (size > 0) {
+    out->append(buffer, std::min(static_cast<size_t>(size), sizeof(buffer)));
+  }
+}
+
+/// @brief the real of sqlite is printed with %!.15g, a json number unless
+/// it is Inf or empty for the null.
+bool IsJsonNumber(const std::string& text) {
+  if (text.empty()) {
+    return false;
+  }
+  char* end = nullptr;
+  double value = strtod(text.c_str(), &end);
+  return *end == '\0' && std::isfinite(value) &&
+         (text[0] == '-' || (text[0] >= '0' && text[0] <= '9'));
+}
+
+/// @brief the json value of the column, null for the null of sqlite
+Json::Value ToJsonValue(const std::string& text, bool integer) {
+  if (text.empty()) {
+    return Json::Value(Json::nullValue);
+  }
+  if (integer) {
+    return Json::Value(static_cast<Json::Int64>(ToInt64(text)));
+  }
+  if (IsJsonNumber(text)) {
+    return Json::Value(ToDouble(text));
+  }
+  return Json::Value(text);
+}
+
+/// @brief the writer of one row object a line, the reals with the digits
+/// of sqlite
+std::unique_ptr<Json::StreamWriter> NewJsonRowWriter() {
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  builder["emitUTF8"] = true;
+  builder["precision"] = 15;
+  return std::unique_ptr<Json::StreamWriter>(builder.newStreamWriter());
+}
+
+}  // namespace
+
+const char* ExperimentExportExtension(int32_t format) {
+  switch (format) {
+    case kExportFormatJson:
+      return ".json";
+    case kExportFormatBinary:
+      return ".anxb";
+    default:
+      return ".csv";
+  }
+}
+
+////////////////////////////////////////////////////////////
+// clz ExperimentExporter::Chunk
+class ExperimentExporter::Chunk {
+ public:
+  Chunk() : seq_(0), row_count_(0) {}
+
+ public:
+  int64_t seq_;
+  int64_t row_count_;
+  std::vector<std::map<std::string, std::string>> rows_;
+  std::string bytes_;
+};
+
+////////////////////////////////////////////////////////////
+// clz ExperimentExporter::Worker
+class ExperimentExporter::Worker : public anx::common::Runnable {
+ public:
+  Worker(ExperimentExporter* exporter, bool writer)
+      : exporter_(exporter), writer_(writer) {}
+
+  void run() override {
+    if (writer_) {
+      exporter_->WriteLoop();
+    } else {
+      exporter_->FormatLoop();
+    }
+  }
+
+ private:
+  ExperimentExporter* exporter_;
+  bool writer_;
+};
+
+////////////////////////////////////////////////////////////
+// clz ExperimentExporter
+ExperimentExporter::ExperimentExporter(const ExperimentExportOptions& options)
+    : options_(options),
+      threads_(options.threads),
+      max_chunks_(options.max_chunks),
+      listener_(nullptr),
+      chunks_in_flight_(0),
+      peak_chunks_(0),
+      read_chunks_(0),
+      written_chunks_(0),
+      read_done_(false),
+      exporting_(false),
+      cancelled_(false),
+      result_(0),
+      rows_(0),
+      total_rows_(0),
+      file_(nullptr),
+      file_offset_(0),
+      row_count_offset_(-1) {
+  if (threads_ <= 0) {
+    /// @note the reader and the writer have the threads of their own.
+    int32_t cores = static_cast<int32_t>(std::thread::hardware_concurrency());
+    threads_ = std::min(kMaxThreads, std::max(1, cores - 2));
+  }
+  if (max_chunks_ <= 0) {
+    max_chunks_ = threads_ * 2;
+  }
+  if (options_.chunk_rows <= 0) {
+    options_.chunk_rows = 4096;
+  }
+  if (options_.write_buffer_size <= 0) {
+    options_.write_buffer_size = 4 * 1024 * 1024;
+  }
+}
+
+ExperimentExporter::~ExperimentExporter() {}
+
+int32_t ExperimentExporter::Export(const std::string& db_name,
+                                   const std::string& table,
+                                   const std::string& file_pathname) {
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (exporting_) {
+      return -1;
+    }
+    exporting_ = true;
+    raw_chunks_.clear();
+    formatted_chunks_.clear();
+    chunks_in_flight_ = 0;
+    peak_chunks_ = 0;
+    read_chunks_ = 0;
+    written_chunks_ = 0;
+    read_done_ = false;
+    cancelled_ = false;
+    result_ = 0;
+    rows_ = 0;
+  }
+  /// the columns of the table in the order of the schema
+  std::vector<std::map<std::string, std::string>> result;
+  std::string sql_str = "PRAGMA table_info(" + table + ");";
+  anx::db::DatabaseCursor cursor(db_name, table);
+  columns_.clear();
+  integer_columns_.clear();
+  int64_t total_rows = -2;
+  /// @note the run archived is read from the archive, its database file is
+  /// removed.
+  std::string archive_pathname;
+  std::unique_ptr<ExperimentArchiveReader> archive;
+  if (FindExperimentArchive(db_name, &archive_pathname)) {
+    archive.reset(new ExperimentArchiveReader());
+    const ArchiveTable* archive_table = nullptr;
+    if (archive->Open(archive_pathname) == 0) {
+      archive_table = archive->FindTable(table);
+    }
+    if (archive_table != nullptr) {
+      for (auto& column : archive_table->columns_) {
+        columns_.push_back(column.name_);
+        integer_columns_.push_back(column.type_ == ArchiveColumn::kInteger);
+      }
+      total_rows = static_cast<int64_t>(archive_table->row_count_);
+    }
+  } else if (anx::db::helper::QueryDataBase(db_name, table, sql_str,
+                                             &result)) {
+    for (auto& row : result) {
+      columns_.push_back(row["name"]);
+      integer_columns_.push_back(row["type"] == "INTEGER");
+    }
+    total_rows = columns_.empty() ? -2 : cursor.MaxId();
+  }
+  if (total_rows < 0) {
+    LOG_F(LG_ERROR) << "Failed to read table: " << table;
+    anx::common::AutoLock lock(&mutex_);
+    exporting_ = false;
+    return -2;
+  }
+  total_rows_ = total_rows;
+  file_ = fopen(file_pathname.c_str(), "wb");
+  if (file_ == nullptr) {
+    LOG_F(LG_ERROR) << "Failed to open: " << file_pathname;
+    anx::common::AutoLock lock(&mutex_);
+    exporting_ = false;
+    return -1;
+  }
+  buffer_.clear();
+  buffer_.reserve(options_.write_buffer_size);
+  file_offset_ = 0;
+  row_count_offset_ = -1;
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::unique_ptr<anx::common::Thread>> threads;
+  workers.emplace_back(new Worker(this, true));
+  for (int32_t i = 0; i < threads_; i++) {
+    workers.emplace_back(new Worker(this, false));
+  }
+  for (auto& worker : workers) {
+    threads.emplace_back(new anx::common::Thread(worker.get()));
+    threads.back()->start();
+  }
+
+  /// the reader stage, one range scan from the last id per page
+  int64_t after_id = 0;
+  uint64_t archive_row = 0;
+  while (true) {
+    {
+      anx::common::AutoLock lock(&mutex_);
+      while (chunks_in_flight_ >= max_chunks_ && !is_stopped()) {
+        cond_.wait(&mutex_);
+      }
+      if (is_stopped()) {
+        break;
+      }
+    }
+    std::unique_ptr<Chunk> chunk(new Chunk());
+    if (archive != nullptr) {
+      if (archive->ReadPage(table, archive_row, options_.chunk_rows,
+                            &chunk->rows_) != 0) {
+        Fail(-2);
+        break;
+      }
+      archive_row += chunk->rows_.size();
+    } else if (!cursor.NextPage(after_id, options_.chunk_rows,
+                                &chunk->rows_)) {
+      Fail(-2);
+      break;
+    }
+    if (chunk->rows_.empty()) {
+      break;
+    }
+    after_id = cursor.last_id();
+    chunk->row_count_ = static_cast<int64_t>(chunk->rows_.size());
+    anx::common::AutoLock lock(&mutex_);
+    chunk->seq_ = read_chunks_++;
+    raw_chunks_.push_back(std::move(chunk));
+    chunks_in_flight_++;
+    peak_chunks_ = std::max(peak_chunks_, chunks_in_flight_);
+    cond_.broadcast();
+  }
+  {
+    anx::common::AutoLock lock(&mutex_);
+    read_done_ = true;
+    cond_.broadcast();
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  fclose(file_);
+  file_ = nullptr;
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+
+  anx::common::AutoLock lock(&mutex_);
+  raw_chunks_.clear();
+  formatted_chunks_.clear();
+  exporting_ = false;
+  int32_t ret = cancelled_ ? -4 : result_;
+  if (ret != 0) {
+    LOG_F(LG_WARN) << "Export " << table << " failed:" << ret;
+    anx::common::RemoveFile(file_pathname);
+  }
+  return ret;
+}
+
+void ExperimentExporter::Cancel() {
+  anx::common::AutoLock lock(&mutex_);
+  if (exporting_) {
+    cancelled_ = true;
+    cond_.broadcast();
+  }
+}
+
+void ExperimentExporter::SetListener(ExperimentExportListener* listener) {
+  listener_ = listener;
+}
+
+int64_t ExperimentExporter::rows() {
+  anx::common::AutoLock lock(&mutex_);
+  return rows_;
+}
+
+int64_t ExperimentExporter::peak_chunks() {
+  anx::common::AutoLock lock(&mutex_);
+  return peak_chunks_;
+}
+
+void ExperimentExporter::FormatLoop() {
+  while (true) {
+    std::unique_ptr<Chunk> chunk;
+    {
+      anx::common::AutoLock lock(&mutex_);
+      while (raw_chunks_.empty() && !read_done_ && !is_stopped()) {
+        cond_.wait(&mutex_);
+      }
+      if (raw_chunks_.empty() || is_stopped()) {
+        return;
+      }
+      chunk = std::move(raw_chunks_.front());
+      raw_chunks_.pop_front();
+    }
+    FormatChunk(chunk.get());
+    anx::common::AutoLock lock(&mutex_);
+    int64_t seq = chunk->seq_;
+    formatted_chunks_[seq] = std::move(chunk);
+    cond_.broadcast();
+  }
+}
+
+void ExperimentExporter::WriteLoop() {
+  if (WriteBytes(FormatHead()) != 0) {
+    Fail(-3);
+    return;
+  }
+  while (true) {
+    std::unique_ptr<Chunk> chunk;
+    {
+      anx::common::AutoLock lock(&mutex_);
+      while (!is_stopped() &&
+             formatted_chunks_.find(written_chunks_) ==
+                 formatted_chunks_.end() &&
+             !(read_done_ && written_chunks_ == read_chunks_)) {
+        cond_.wait(&mutex_);
+      }
+      if (is_stopped()) {
+        return;
+      }
+      auto it = formatted_chunks_.find(written_chunks_);
+      if (it == formatted_chunks_.end()) {
+        /// all the pages read are written
+        break;
+      }
+      chunk = std::move(it->second);
+      formatted_chunks_.erase(it);
+    }
+    int32_t ret = WriteBytes(chunk->bytes_);
+    int64_t row_count = chunk->row_count_;
+    chunk.reset();
+    int64_t rows = 0;
+    {
+      anx::common::AutoLock lock(&mutex_);
+      chunks_in_flight_--;
+      written_chunks_++;
+      rows_ += row_count;
+      rows = rows_;
+      cond_.broadcast();
+    }
+    if (ret != 0) {
+      Fail(-3);
+      return;
+    }
+    if (listener_ != nullptr) {
+      listener_->OnExportProgress(this, rows, total_rows_);
+    }
+  }
+  if (WriteBytes(FormatTail()) != 0 || FlushBuffer() != 0) {
+    Fail(-3);
+    return;
+  }
+  if (row_count_offset_ >= 0) {
+    /// the row count of the binary header is known at the end
+    std::string row_count;
+    PutU64(&row_count, static_cast<uint64_t>(rows()));
+    if (fseek(file_, static_cast<long>(row_count_offset_),  // NOLINT
+              SEEK_SET) != 0 ||
+        fwrite(row_count.data(), 1, row_count.size(), file_) !=
+            row_count.size()) {
+      Fail(-3);
+      return;
+    }
+  }
+  if (fflush(file_) != 0) {
+    Fail(-3);
+  }
+}
+
+void ExperimentExporter::FormatChunk(Chunk* chunk) {
+  std::string& out = chunk->bytes_;
+  if (options_.format == kExportFormatCsv) {
+    out.reserve(chunk->rows_.size() * 48);
+    for (auto& row : chunk->rows_) {
+      for (size_t i = 0; i < 5; i++) {
+        const std::string& text = row[kCsvColumns[i]];
+        if (kCsvPrecisions[i] < 0) {
+          out += std::to_string(ToInt64(text));
+        } else {
+          AppendFixed(&out, ToDouble(text), kCsvPrecisions[i]);
+        }
+        out.push_back(i == 4 ? '\n' : ',');
+      }
+    }
+  } else if (options_.format == kExportFormatJson) {
+    std::unique_ptr<Json::StreamWriter> writer = NewJsonRowWriter();
+    std::ostringstream stream;
+    for (size_t r = 0; r < chunk->rows_.size(); r++) {
+      auto& row = chunk->rows_[r];
+      if (chunk->seq_ != 0 || r != 0) {
+        stream << ',';
+      }
+      stream << '\n';
+      Json::Value value(Json::objectValue);
+      for (size_t i = 0; i < columns_.size(); i++) {
+        value[columns_[i]] =
+            ToJsonValue(row[columns_[i]], integer_columns_[i]);
+      }
+      writer->write(value, &stream);
+    }
+    out = stream.str();
+  } else {
+    out.reserve(chunk->rows_.size() * columns_.size() * 8);
+    for (auto& row : chunk->rows_) {
+      for (size_t i = 0; i < columns_.size(); i++) {
+        const std::string& text = row[columns_[i]];
+        if (integer_columns_[i]) {
+          PutU64(&out, static_cast<uint64_t>(ToInt64(text)));
+        } else {
+          PutF64(&out, ToDouble(text));
+        }
+      }
+    }
+  }
+  /// the page read is freed before it waits for the writer
+  std::vector<std::map<std::string, std::string>>().swap(chunk->rows_);
+}
+
+std::string ExperimentExporter::FormatHead() {
+  std::string head;
+  if (options_.format == kExportFormatCsv) {
+    head = kCsvHeader;
+  } else if (options_.format == kExportFormatJson) {
+    head = "[";
+  } else {
+    head.append(kBinaryMagic, sizeof(kBinaryMagic));
+    PutU16(&head, kBinaryVersion);
+    PutU16(&head, static_cast<uint16_t>(columns_.size()));
+    for (size_t i = 0; i < columns_.size(); i++) {
+      PutU16(&head, static_cast<uint16_t>(columns_[i].size()));
+      head += columns_[i];
+      head.push_back(integer_columns_[i] ? 0 : 1);
+    }
+    row_count_offset_ = file_offset_ + static_cast<int64_t>(head.size());
+    PutU64(&head, 0);
+  }
+  return head;
+}
+
+std::string ExperimentExporter::FormatTail() {
+  return options_.format == kExportFormatJson ? "\n]\n" : std::string();
+}
+
+int32_t ExperimentExporter::WriteBytes(const std::string& bytes) {
+  file_offset_ += static_cast<int64_t>(bytes.size());
+  if (buffer_.size() + bytes.size() <= buffer_.capacity()) {
+    buffer_ += bytes;
+    return 0;
+  }
+  if (FlushBuffer() != 0) {
+    return -3;
+  }
+  if (bytes.size() >= buffer_.capacity()) {
+    /// the large page is written at once without the copy
+    if (fwrite(bytes.data(), 1, bytes.size(), file_) != bytes.size()) {
+      return -3;
+    }
+    return 0;
+  }
+  buffer_ += bytes;
+  return 0;
+}
+
+int32_t ExperimentExporter::FlushBuffer() {
+  if (buffer_.empty()) {
+    return 0;
+  }
+  size_t written = fwrite(buffer_.data(), 1, buffer_.size(), file_);
+  bool ok = written == buffer_.size();
+  buffer_.clear();
+  return ok ? 0 : -3;
+}
+
+void ExperimentExporter::Fail(int32_t result) {
+  anx::common::AutoLock lock(&mutex_);
+  if (result_ == 0) {
+    result_ = result;
+  }
+  cond_.broadcast();
+}
+
+bool ExperimentExporter::is_stopped() {
+  return cancelled_ || result_ != 0;
+}
+
+}  // namespace expdata
+}  // namespace anx
@@ -0,0 +1,172 @@
+/**
+ * @file experiment_export.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the bulk export of the experiment data tables to the csv, json or
+ * binary file. the rows are read in pages, formatted on the worker threads
+ * and written in order through a large buffer, the pages in flight are
+ * bounded so the memory doesn't grow with the rows of the table.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_EXPDATA_EXPERIMENT_EXPORT_H_
+#define APP_EXPDATA_EXPERIMENT_EXPORT_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/common/thread.h"
+
+namespace anx {
+namespace expdata {
+
+/// @brief the format of the export file
+enum ExperimentExportFormat {
+  /// @brief the csv of SaveExperimentDataToCsvWithDefaultPath, the columns
+  /// id, cycle_count, KHz, MPa and μm
+  kExportFormatCsv = 0,
+  /// @brief an array of the row objects with all the columns of the table,
+  /// one object a line written by jsoncpp, the keys in the name order
+  kExportFormatJson = 1,
+  /// @brief the little endian rows of all the columns, see
+  /// experiment_export.cc for the layout
+  kExportFormatBinary = 2,
+};
+
+/// @brief Get the file extension of the format, e.g. ".csv"
+const char* ExperimentExportExtension(int32_t format);
+
+struct ExperimentExportOptions {
+  /// @brief @see ExperimentExportFormat
+  int32_t format = kExportFormatCsv;
+  /// @brief the rows of one page read
+  int32_t chunk_rows = 4096;
+  /// @brief the threads of the format stage, 0 follows the cores
+  int32_t threads = 0;
+  /// @brief the pages read and not yet written, 0 is twice the threads
+  int32_t max_chunks = 0;
+  /// @brief the size of the write buffer
+  int32_t write_buffer_size = 4 * 1024 * 1024;
+};
+
+class ExperimentExporter;
+
+/// @brief the progress of the export, called on the writer thread
+class ExperimentExportListener {
+ public:
+  virtual ~ExperimentExportListener() = default;
+
+  /// @brief On the rows written
+  /// @param rows the rows written
+  /// @param total_rows the max id of the table, the rows of the table
+  /// without the rows deleted
+  virtual void OnExportProgress(ExperimentExporter* exporter,
+                                int64_t rows,
+                                int64_t total_rows) = 0;
+};
+
+////////////////////////////////////////////////////////////
+// clz ExperimentExporter
+/// @brief the export runs in three stages. the caller thread reads the pages
+/// of the table in id order, the workers parse and format the pages in
+/// parallel, and the writer thread writes the formatted pages in the order
+/// read. the reader waits when max_chunks pages are in flight.
+class ExperimentExporter {
+ public:
+  explicit ExperimentExporter(const ExperimentExportOptions& options);
+  ~ExperimentExporter();
+
+  ExperimentExporter(const ExperimentExporter&) = delete;
+  ExperimentExporter& operator=(const ExperimentExporter&) = delete;
+
+ public:
+  /// @brief Export the table to the file, blocks until the export is done.
+  /// the table of the run archived is read from its archive, see
+  /// FindExperimentArchive.
+  /// @param db_name the database name, see helper::QueryDataBase
+  /// @param table the table with the id primary key, e.g. exp_data_list
+  /// @param file_pathname the file to write, truncated. the file is removed
+  /// if the export failed or cancelled.
+  /// @return 0 if success, -1 if the file can't be opened or exporting, -2
+  /// if the table can't be read, -3 if write failed, -4 if cancelled
+  int32_t Export(const std::string& db_name,
+                 const std::string& table,
+                 const std::string& file_pathname);
+
+  /// @brief Cancel the export in progress, called from any thread
+  void Cancel();
+
+  /// @brief Set the listener before Export, not owned
+  void SetListener(ExperimentExportListener* listener);
+
+  /// @brief Get the rows written by the last export
+  int64_t rows();
+  /// @brief Get the max pages in flight of the last export
+  int64_t peak_chunks();
+
+  const ExperimentExportOptions& options() const { return options_; }
+
+ private:
+  class Chunk;
+  class Worker;
+
+  /// @brief the format stage, run by the workers
+  void FormatLoop();
+  /// @brief the ordered write stage, run by the writer
+  void WriteLoop();
+  void FormatChunk(Chunk* chunk);
+  std::string FormatHead();
+  std::string FormatTail();
+  /// @brief Write the bytes through the buffer
+  /// @return 0 if success, -3 if write failed
+  int32_t WriteBytes(const std::string& bytes);
+  int32_t FlushBuffer();
+  /// @brief Stop the stages with the result, the first result is kept
+  void Fail(int32_t result);
+  /// @brief cancelled or failed, called under the mutex
+  bool is_stopped();
+
+ private:
+  ExperimentExportOptions options_;
+  int32_t threads_;
+  int32_t max_chunks_;
+  ExperimentExportListener* listener_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  /// @brief the pages read and not formatted
+  std::deque<std::unique_ptr<Chunk>> raw_chunks_;
+  /// @brief the pages formatted and not written, by the sequence
+  std::map<int64_t, std::unique_ptr<Chunk>> formatted_chunks_;
+  int64_t chunks_in_flight_;
+  int64_t peak_chunks_;
+  int64_t read_chunks_;
+  int64_t written_chunks_;
+  bool read_done_;
+  bool exporting_;
+  bool cancelled_;
+  int32_t result_;
+  int64_t rows_;
+  int64_t total_rows_;
+  /// @brief the columns of the table in the output order, set before the
+  /// stages start
+  std::vector<std::string> columns_;
+  std::vector<bool> integer_columns_;
+  /// @brief used by the writer only
+  FILE* file_;
+  std::string buffer_;
+  int64_t file_offset_;
+  int64_t row_count_offset_;
+};
+
+}  // namespace expdata
+}  // namespace anx
+
+#endif  // APP_EXPDATA_EXPERIMENT_EXPORT_H_
@@ -0,0 +1,272 @@
+/**
+ * @file experiment_export_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief experiment export unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "app/common/file_utils.h"
+#include "app/common/module_utils.h"
+#include "app/common/num_string_convert.hpp"
+#include "app/db/database_factory.h"
+#include "app/db/database_helper.h"
+#include "app/expdata/experiment_archive.h"
+#include "app/expdata/experiment_export.h"
+
+namespace anx {
+namespace expdata {
+namespace {
+class ProgressListener : public ExperimentExportListener {
+ public:
+  explicit ProgressListener(bool cancel) : cancel_(cancel) {}
+
+  void OnExportProgress(ExperimentExporter* exporter,
+                        int64_t rows,
+                        int64_t total_rows) override {
+    calls_++;
+    last_rows_ = rows;
+    total_rows_ = total_rows;
+    if (cancel_) {
+      exporter->Cancel();
+    }
+  }
+
+  bool cancel_;
+  int32_t calls_ = 0;
+  int64_t last_rows_ = 0;
+  int64_t total_rows_ = 0;
+};
+}  // namespace
+
+class ExperimentExportTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    folder_ = anx::common::GetModuleDir() + anx::common::kPathSeparator +
+              "expdata_unittest";
+    anx::common::MakeSureFolderPathExist(FileName("x"));
+    db_name_ = FileName("exp_export.db");
+    anx::db::helper::ClearDatabaseFile(db_name_);
+    ASSERT_TRUE(anx::db::helper::CreateExperimentDataTables(db_name_));
+  }
+  void TearDown() override {
+    anx::db::DatabaseFactory::Instance()->CloseAllDatabase();
+    anx::db::helper::ClearDatabaseFile(db_name_);
+  }
+
+  std::string FileName(const std::string& name) {
+    return folder_ + anx::common::kPathSeparator + name;
+  }
+
+  /// @brief write rows id 1..n of the list, cycle id * 100, kHz 20 + id %
+  /// 7 / 1000, MPa 100 and μm id / 2, date id / 50
+  void WriteList(int32_t n) {
+    ASSERT_TRUE(anx::db::helper::ExecuteDataBase(db_name_, "BEGIN;"));
+    for (int32_t i = 1; i <= n; i++) {
+      std::vector<anx::db::DatabaseValue> params;
+      params.push_back(anx::db::DatabaseValue(i * 100));
+      params.push_back(anx::db::DatabaseValue(20.0 + (i % 7) * 0.001));
+      params.push_back(anx::db::DatabaseValue(100.0));
+      params.push_back(anx::db::DatabaseValue(i * 0.5));
+      params.push_back(anx::db::DatabaseValue(i * 0.02));
+      ASSERT_TRUE(anx::db::helper::InsertDataTable(
+          db_name_, anx::db::helper::kTableExpDataList,
+          anx::db::helper::sql::kInsertTableExpDataListSqlPrepared, params));
+    }
+    ASSERT_TRUE(anx::db::helper::ExecuteDataBase(db_name_, "COMMIT;"));
+  }
+
+  /// @brief the csv of SaveExperimentDataFile for the rows of WriteList
+  std::string ExpectedCsv(int32_t n) {
+    std::string csv = "id,cycle_count,KHz,MPa,μm\n";
+    for (int32_t i = 1; i <= n; i++) {
+      csv += std::to_string(i) + "," + std::to_string(i * 100) + "," +
+             anx::common::to_string_with_precision(20.0 + (i % 7) * 0.001,
+                                                   3) +
+             "," + anx::common::to_string_with_precision(100.0, 6) + "," +
+             anx::common::to_string_with_precision(i * 0.5, 2) + "\n";
+    }
+    return csv;
+  }
+
+  ExperimentExportOptions Options(int32_t format) {
+    ExperimentExportOptions options;
+    options.format = format;
+    options.chunk_rows = 100;
+    options.threads = 3;
+    options.max_chunks = 4;
+    options.write_buffer_size = 4096;
+    return options;
+  }
+
+  std::string folder_;
+  std::string db_name_;
+};
+
+TEST_F(ExperimentExportTest, ExportCsvInOrder) {
+  WriteList(3000);
+  std::string file_pathname = FileName("export.csv");
+  ExperimentExporter exporter(Options(kExportFormatCsv));
+  ProgressListener listener(false);
+  exporter.SetListener(&listener);
+  ASSERT_EQ(exporter.Export(db_name_, anx::db::helper::kTableExpDataList,
+                            file_pathname),
+            0);
+  EXPECT_EQ(exporter.rows(), 3000);
+  /// the pages in flight are bounded
+  EXPECT_GE(exporter.peak_chunks(), 1);
+  EXPECT_LE(exporter.peak_chunks(), 4);
+  EXPECT_EQ(listener.calls_, 30);
+  EXPECT_EQ(listener.last_rows_, 3000);
+  EXPECT_EQ(listener.total_rows_, 3000);
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  EXPECT_EQ(content, ExpectedCsv(3000));
+  anx::common::RemoveFile(file_pathname);
+
+  /// the empty table has the header only
+  ExperimentExporter graph(Options(kExportFormatCsv));
+  ASSERT_EQ(graph.Export(db_name_, anx::db::helper::kTableExpDataGraph,
+                         file_pathname),
+            0);
+  EXPECT_EQ(graph.rows(), 0);
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  EXPECT_EQ(content, "id,cycle_count,KHz,MPa,μm\n");
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentExportTest, ExportArchivedRun) {
+  WriteList(1000);
+  anx::db::helper::CloseDataBase(db_name_);
+  ExperimentArchiver::Instance()->Post(db_name_, true);
+  ASSERT_TRUE(ExperimentArchiver::Instance()->WaitIdle(10000));
+  ExperimentArchiver::ReleaseInstance();
+  ASSERT_FALSE(anx::common::FileExists(db_name_));
+  std::string archive_pathname = db_name_ + kExperimentArchiveExtension;
+  ASSERT_TRUE(anx::common::FileExists(archive_pathname));
+
+  /// the rows of the run are read from the archive
+  std::string file_pathname = FileName("export_archive.csv");
+  ExperimentExporter exporter(Options(kExportFormatCsv));
+  ASSERT_EQ(exporter.Export(db_name_, anx::db::helper::kTableExpDataList,
+                            file_pathname),
+            0);
+  EXPECT_EQ(exporter.rows(), 1000);
+  EXPECT_FALSE(anx::common::FileExists(db_name_));
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  EXPECT_EQ(content, ExpectedCsv(1000));
+  anx::common::RemoveFile(file_pathname);
+  anx::common::RemoveFile(archive_pathname);
+}
+
+TEST_F(ExperimentExportTest, ExportJson) {
+  WriteList(250);
+  /// the text of the real column is a string with the control characters
+  /// escaped
+  ASSERT_TRUE(anx::db::helper::ExecuteDataBase(
+      db_name_,
+      "UPDATE exp_data_list SET date = 'a' || char(1) || '\"b' WHERE id = 2;"));
+  std::string file_pathname = FileName("export.json");
+  ExperimentExporter exporter(Options(kExportFormatJson));
+  ASSERT_EQ(exporter.Export(db_name_, anx::db::helper::kTableExpDataList,
+                            file_pathname),
+            0);
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  EXPECT_EQ(content.substr(0, 2), "[\n");
+  EXPECT_EQ(content.substr(content.size() - 3), "\n]\n");
+  EXPECT_NE(content.find("\n{\"MPa\":100.0,\"cycle\":100,\"date\":0.02,"
+                         "\"id\":1,\"kHz\":20.001,\"μm\":0.5},"),
+            std::string::npos);
+  EXPECT_NE(content.find("\"date\":\"a\\u0001\\\"b\",\"id\":2,"),
+            std::string::npos);
+  EXPECT_NE(content.find("\"cycle\":25000,\"date\":5.0,\"id\":250,"),
+            std::string::npos);
+  size_t objects = 0;
+  for (char c : content) {
+    objects += c == '{' ? 1 : 0;
+  }
+  EXPECT_EQ(objects, 250u);
+  EXPECT_EQ(content.find(",\n]"), std::string::npos);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentExportTest, ExportBinary) {
+  WriteList(250);
+  std::string file_pathname = FileName("export.anxb");
+  ExperimentExporter exporter(Options(kExportFormatBinary));
+  ASSERT_EQ(exporter.Export(db_name_, anx::db::helper::kTableExpDataList,
+                            file_pathname),
+            0);
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  std::string head;
+  head.append("ANXB", 4);
+  head.append("\x01\x00\x06\x00", 4);
+  const char* names[] = {"id", "cycle", "kHz", "MPa", "μm", "date"};
+  for (size_t i = 0; i < 6; i++) {
+    head.push_back(static_cast<char>(strlen(names[i])));
+    head.push_back('\0');
+    head += names[i];
+    head.push_back(i < 2 ? '\0' : '\x01');
+  }
+  ASSERT_GT(content.size(), head.size() + 8);
+  EXPECT_EQ(content.substr(0, head.size()), head);
+  uint64_t row_count = 0;
+  memcpy(&row_count, content.data() + head.size(), 8);
+  EXPECT_EQ(row_count, 250u);
+  size_t rows_offset = head.size() + 8;
+  EXPECT_EQ(content.size(), rows_offset + 250u * 6 * 8);
+  /// the row 100
+  const char* row = content.data() + rows_offset + 99 * 6 * 8;
+  int64_t id = 0;
+  int64_t cycle = 0;
+  double um = 0;
+  memcpy(&id, row, 8);
+  memcpy(&cycle, row + 8, 8);
+  memcpy(&um, row + 32, 8);
+  EXPECT_EQ(id, 100);
+  EXPECT_EQ(cycle, 10000);
+  EXPECT_DOUBLE_EQ(um, 50.0);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentExportTest, CancelAndFailure) {
+  WriteList(2000);
+  std::string file_pathname = FileName("cancel.csv");
+  ExperimentExporter exporter(Options(kExportFormatCsv));
+  ProgressListener listener(true);
+  exporter.SetListener(&listener);
+  EXPECT_EQ(exporter.Export(db_name_, anx::db::helper::kTableExpDataList,
+                            file_pathname),
+            -4);
+  EXPECT_LT(exporter.rows(), 2000);
+  EXPECT_FALSE(anx::common::FileExists(file_pathname));
+
+  /// the exporter is reused after the cancel
+  exporter.SetListener(nullptr);
+  EXPECT_EQ(exporter.Export(db_name_, anx::db::helper::kTableExpDataList,
+                            file_pathname),
+            0);
+  EXPECT_EQ(exporter.rows(), 2000);
+  anx::common::RemoveFile(file_pathname);
+
+  EXPECT_EQ(exporter.Export(db_name_, "no_table", file_pathname), -2);
+  EXPECT_EQ(exporter.Export(db_name_, anx::db::helper::kTableExpDataList,
+                            FileName("none") + anx::common::kPathSeparator +
+                                "cancel.csv"),
+            -1);
+}
+
+}  // namespace expdata
+}  // namespace anx
@@ -0,0 +1,439 @@
+/**
+ * @file experiment_journal.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the checkpoint journal of the running experiment
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/expdata/experiment_journal.h"
+
+#include <zlib.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <vector>
+
+#include "app/common/logger.h"
+
+namespace anx {
+namespace expdata {
+
+const char* kExperimentJournalFileName = "exp_journal.anxj";
+
+const uint32_t ExperimentJournal::kRecordSize;
+const uint32_t ExperimentJournal::kDefaultCapacity;
+const int32_t ExperimentJournal::kDefaultSyncIntervalMs;
+
+namespace {
+
+/// @note record layout, all the numbers are little endian.
+/// magic "ANXJ", u32 crc32 of the bytes after the crc32, u64 sequence, the
+/// fields of ExperimentCheckpoint in the order of the declaration, bool as
+/// u8, zero padded to kRecordSize. the sequence starts from 1, the record of
+/// the sequence is at the slot (sequence - 1) % capacity.
+const char kMagic[4] = {'A', 'N', 'X', 'J'};
+const size_t kCrcOffset = 4;
+const size_t kSequenceOffset = 8;
+const size_t kFieldsOffset = 16;
+
+/// @brief the fixed size record in the memory
+class Record {
+ public:
+  Record() : data_(ExperimentJournal::kRecordSize, 0), pos_(0) {}
+
+  uint8_t* data() { return data_.data(); }
+  const uint8_t* data() const { return data_.data(); }
+
+  void Seek(size_t pos) { pos_ = pos; }
+  void Put(uint64_t value, int32_t bytes) {
+    for (int32_t i = 0; i < bytes; i++) {
+      data_[pos_++] = static_cast<uint8_t>(value >> (i * 8));
+    }
+  }
+  uint64_t Get(int32_t bytes) {
+    uint64_t value = 0;
+    for (int32_t i = 0; i < bytes; i++) {
+      value |= static_cast<uint64_t>(data_[pos_++]) << (i * 8);
+    }
+    return value;
+  }
+  uint32_t Crc32() const {
+    return static_cast<uint32_t>(
+        crc32(crc32(0L, Z_NULL, 0), data_.data() + kSequenceOffset,
+              static_cast<uInt>(data_.size() - kSequenceOffset)));
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+  size_t pos_;
+};
+
+void EncodeRecord(uint64_t sequence,
+                  const ExperimentCheckpoint& checkpoint,
+                  Record* record) {
+  record->Seek(kSequenceOffset);
+  record->Put(sequence, 8);
+  record->Put(checkpoint.time_ms_, 8);
+  record->Put(checkpoint.exp_state_, 4);
+  record->Put(checkpoint.clip_state_, 4);
+  record->Put(checkpoint.exp_db_start_time_ms_, 8);
+  record->Put(checkpoint.initial_frequency_, 4);
+  record->Put(checkpoint.initial_power_, 4);
+  record->Put(checkpoint.cur_total_cycle_count_, 8);
+  record->Put(checkpoint.pre_total_cycle_count_, 8);
+  record->Put(checkpoint.pre_total_data_table_no_, 4);
+  record->Put(checkpoint.pre_exp_start_offset_ms_, 8);
+  record->Put(checkpoint.pre_clip_paused_ms_, 8);
+  record->Put(checkpoint.exp_data_pre_duration_exponential_, 8);
+  record->Put(checkpoint.start_time_pos_has_deal_ ? 1 : 0, 1);
+  record->Put(checkpoint.graph_start_offset_ms_, 8);
+  record->Put(checkpoint.graph_time_interval_num_, 8);
+  record->Put(checkpoint.graph_data_table_no_, 4);
+  record->Put(checkpoint.list_start_offset_ms_, 8);
+  record->Put(checkpoint.list_time_interval_num_, 8);
+  record->Put(checkpoint.list_pre_sample_offset_ms_, 8);
+  record->Put(checkpoint.list_freq_total_count_, 8);
+  record->Put(checkpoint.list_data_table_no_, 4);
+  record->Put(checkpoint.paused_offset_ms_, 8);
+  memcpy(record->data(), kMagic, sizeof(kMagic));
+  record->Seek(kCrcOffset);
+  record->Put(record->Crc32(), 4);
+}
+
+/// @return the sequence of the record, 0 if the record is not valid
+uint64_t DecodeRecord(Record* record, ExperimentCheckpoint* checkpoint) {
+  if (memcmp(record->data(), kMagic, sizeof(kMagic)) != 0) {
+    return 0;
+  }
+  record->Seek(kCrcOffset);
+  if (record->Get(4) != record->Crc32()) {
+    return 0;
+  }
+  uint64_t sequence = record->Get(8);
+  checkpoint->time_ms_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->exp_state_ = static_cast<int32_t>(record->Get(4));
+  checkpoint->clip_state_ = static_cast<int32_t>(record->Get(4));
+  checkpoint->exp_db_start_time_ms_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->initial_frequency_ = static_cast<int32_t>(record->Get(4));
+  checkpoint->initial_power_ = static_cast<int32_t>(record->Get(4));
+  checkpoint->cur_total_cycle_count_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->pre_total_cycle_count_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->pre_total_data_table_no_ = static_cast<int32_t>(record->Get(4));
+  checkpoint->pre_exp_start_offset_ms_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->pre_clip_paused_ms_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->exp_data_pre_duration_exponential_ =
+      static_cast<int64_t>(record->Get(8));
+  checkpoint->start_time_pos_has_deal_ = record->Get(1) != 0;
+  checkpoint->graph_start_offset_ms_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->graph_time_interval_num_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->graph_data_table_no_ = static_cast<int32_t>(record->Get(4));
+  checkpoint->list_start_offset_ms_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->list_time_interval_num_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->list_pre_sample_offset_ms_ =
+      static_cast<int64_t>(record->Get(8));
+  checkpoint->list_freq_total_count_ = static_cast<int64_t>(record->Get(8));
+  checkpoint->list_data_table_no_ = static_cast<int32_t>(record->Get(4));
+  checkpoint->paused_offset_ms_ = static_cast<int64_t>(record->Get(8));
+  return sequence;
+}
+
+/// @brief Scan the records of the file for the last valid one, the file is
+/// of the ring size and read at once.
+/// @return the sequence of the last record, 0 if none
+uint64_t ScanLast(FILE* file,
+                  uint32_t capacity,
+                  ExperimentCheckpoint* checkpoint) {
+  std::vector<uint8_t> bytes(
+      static_cast<size_t>(capacity) * ExperimentJournal::kRecordSize);
+  fseek(file, 0, SEEK_SET);
+  if (fread(bytes.data(), 1, bytes.size(), file) != bytes.size()) {
+    return 0;
+  }
+  uint64_t last_sequence = 0;
+  Record record;
+  ExperimentCheckpoint decoded;
+  for (uint32_t i = 0; i < capacity; i++) {
+    memcpy(record.data(), bytes.data() + i * ExperimentJournal::kRecordSize,
+           ExperimentJournal::kRecordSize);
+    uint64_t sequence = DecodeRecord(&record, &decoded);
+    if (sequence > last_sequence) {
+      last_sequence = sequence;
+      *checkpoint = decoded;
+    }
+  }
+  return last_sequence;
+}
+
+int64_t FileSize(FILE* file) {
+  if (fseek(file, 0, SEEK_END) != 0) {
+    return -1;
+  }
+  return static_cast<int64_t>(ftell(file));
+}
+
+int32_t FileNo(FILE* file) {
+#if defined(_WIN32) || defined(_WIN64)
+  return _fileno(file);
+#else
+  return fileno(file);
+#endif
+}
+
+/// @brief Sync the data of the file written to the os to the disk
+bool SyncFileNo(int32_t fd) {
+#if defined(_WIN32) || defined(_WIN64)
+  return _commit(fd) == 0;
+#else
+  return fsync(fd) == 0;
+#endif
+}
+
+}  // namespace
+
+ExperimentCheckpoint::ExperimentCheckpoint()
+    : time_ms_(0),
+      exp_state_(0),
+      clip_state_(0),
+      exp_db_start_time_ms_(0),
+      initial_frequency_(0),
+      initial_power_(0),
+      cur_total_cycle_count_(0),
+      pre_total_cycle_count_(0),
+      pre_total_data_table_no_(0),
+      pre_exp_start_offset_ms_(0),
+      pre_clip_paused_ms_(0),
+      exp_data_pre_duration_exponential_(0),
+      start_time_pos_has_deal_(false),
+      graph_start_offset_ms_(0),
+      graph_time_interval_num_(0),
+      graph_data_table_no_(0),
+      list_start_offset_ms_(0),
+      list_time_interval_num_(0),
+      list_pre_sample_offset_ms_(0),
+      list_freq_total_count_(0),
+      list_data_table_no_(0),
+      paused_offset_ms_(0) {}
+
+int64_t ExperimentCheckpoint::OffsetOf(int64_t time_ms,
+                                       int64_t checkpoint_time_ms) {
+  if (time_ms <= 0) {
+    return 0;
+  }
+  /// the time of the checkpoint itself is kept apart from the time not set.
+  int64_t offset_ms = time_ms - checkpoint_time_ms;
+  return offset_ms < 0 ? offset_ms : -1;
+}
+
+int64_t ExperimentCheckpoint::TimeOf(int64_t offset_ms, int64_t now_ms) {
+  if (offset_ms == 0) {
+    return 0;
+  }
+  return now_ms + offset_ms;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// clz ExperimentJournal
+
+ExperimentJournal::ExperimentJournal(uint32_t capacity,
+                                     int32_t sync_interval_ms)
+    : capacity_(capacity > 0 ? capacity : kDefaultCapacity),
+      sync_interval_ms_(sync_interval_ms),
+      file_(nullptr),
+      fd_(-1),
+      sequence_(0),
+      synced_sequence_(0),
+      has_last_(false) {}
+
+ExperimentJournal::~ExperimentJournal() {
+  Close();
+}
+
+int32_t ExperimentJournal::Open(const std::string& file_pathname) {
+  anx::common::AutoLock sync_lock(&sync_mutex_);
+  anx::common::AutoLock lock(&mutex_);
+  if (file_ != nullptr) {
+    return -1;
+  }
+  const int64_t file_size = static_cast<int64_t>(capacity_) * kRecordSize;
+  FILE* file = fopen(file_pathname.c_str(), "r+b");
+  uint64_t sequence = 0;
+  ExperimentCheckpoint last;
+  if (file != nullptr && FileSize(file) == file_size) {
+    sequence = ScanLast(file, capacity_, &last);
+  } else {
+    /// @note the ring is written in full once, the appends after only
+    /// overwrite the records and never grow the file.
+    if (file != nullptr) {
+      fclose(file);
+    }
+    file = fopen(file_pathname.c_str(), "w+b");
+    if (file == nullptr) {
+      LOG_F(LG_ERROR) << "Failed to open journal: " << file_pathname;
+      return -2;
+    }
+    std::vector<uint8_t> zeros(static_cast<size_t>(file_size), 0);
+    if (fwrite(zeros.data(), 1, zeros.size(), file) != zeros.size() ||
+        fflush(file) != 0 || !SyncFileNo(FileNo(file))) {
+      LOG_F(LG_ERROR) << "Failed to preallocate journal: " << file_pathname;
+      fclose(file);
+      return -3;
+    }
+  }
+  file_ = file;
+  fd_ = FileNo(file);
+  sequence_ = sequence;
+  synced_sequence_ = sequence;
+  has_last_ = sequence > 0;
+  last_ = last;
+  stop_ = false;
+  if (sync_interval_ms_ > 0) {
+    thread_.reset(new anx::common::Thread(this));
+    thread_->start();
+  }
+  return 0;
+}
+
+void ExperimentJournal::Close() {
+  interrupt();
+  if (thread_ != nullptr) {
+    thread_->join();
+    thread_.reset();
+  }
+  SyncFile();
+  anx::common::AutoLock sync_lock(&sync_mutex_);
+  anx::common::AutoLock lock(&mutex_);
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+    fd_ = -1;
+  }
+}
+
+int32_t ExperimentJournal::Append(const ExperimentCheckpoint& checkpoint) {
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (file_ == nullptr) {
+      return -1;
+    }
+    uint64_t sequence = sequence_ + 1;
+    Record record;
+    EncodeRecord(sequence, checkpoint, &record);
+    long offset = static_cast<long>((sequence - 1) % capacity_) *  // NOLINT
+                  static_cast<long>(kRecordSize);                  // NOLINT
+    if (fseek(file_, offset, SEEK_SET) != 0 ||
+        fwrite(record.data(), 1, kRecordSize, file_) != kRecordSize ||
+        fflush(file_) != 0) {
+      LOG_F(LG_ERROR) << "Failed to append journal, sequence:" << sequence;
+      return -2;
+    }
+    sequence_ = sequence;
+    has_last_ = true;
+    last_ = checkpoint;
+  }
+  if (sync_interval_ms_ <= 0) {
+    return Sync();
+  }
+  return 0;
+}
+
+int32_t ExperimentJournal::Sync() {
+  return SyncFile();
+}
+
+bool ExperimentJournal::last_checkpoint(ExperimentCheckpoint* checkpoint) {
+  anx::common::AutoLock lock(&mutex_);
+  if (!has_last_) {
+    return false;
+  }
+  *checkpoint = last_;
+  return true;
+}
+
+uint64_t ExperimentJournal::sequence() {
+  anx::common::AutoLock lock(&mutex_);
+  return sequence_;
+}
+
+uint64_t ExperimentJournal::synced_sequence() {
+  anx::common::AutoLock lock(&mutex_);
+  return synced_sequence_;
+}
+
+int32_t ExperimentJournal::ReadLast(const std::string& file_pathname,
+                                    ExperimentCheckpoint* checkpoint) {
+  FILE* file = fopen(file_pathname.c_str(), "rb");
+  if (file == nullptr) {
+    return -1;
+  }
+  int64_t file_size = FileSize(file);
+  uint64_t sequence = 0;
+  if (file_size >= kRecordSize) {
+    sequence = ScanLast(file, static_cast<uint32_t>(file_size / kRecordSize),
+                        checkpoint);
+  }
+  fclose(file);
+  return sequence > 0 ? 0 : -2;
+}
+
+void ExperimentJournal::interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  stop_ = true;
+  cond_.broadcast();
+}
+
+bool ExperimentJournal::is_interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  return stop_;
+}
+
+void ExperimentJournal::run() {
+  while (!WaitFor(sync_interval_ms_)) {
+    SyncFile();
+  }
+}
+
+int32_t ExperimentJournal::SyncFile() {
+  anx::common::AutoLock sync_lock(&sync_mutex_);
+  int32_t fd = -1;
+  uint64_t sequence = 0;
+  {
+    anx::common::AutoLock lock(&mutex_);
+    if (file_ == nullptr) {
+      return -1;
+    }
+    if (sequence_ == synced_sequence_) {
+      return 0;
+    }
+    fd = fd_;
+    sequence = sequence_;
+  }
+  /// the records are flushed to the os by the appends, the sync goes on
+  /// beside the appends.
+  if (!SyncFileNo(fd)) {
+    LOG_F(LG_ERROR) << "Failed to sync journal, sequence:" << sequence;
+    return -2;
+  }
+  anx::common::AutoLock lock(&mutex_);
+  synced_sequence_ = sequence;
+  return 0;
+}
+
+bool ExperimentJournal::WaitFor(int32_t wait_ms) {
+  anx::common::AutoLock lock(&mutex_);
+  if (!stop_) {
+    cond_.wait(&mutex_, static_cast<unsigned int>(wait_ms));
+  }
+  return stop_;
+}
+
+}  // namespace expdata
+}  // namespace anx
@@ -0,0 +1,170 @@
+/**
+ * @file experiment_journal.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the checkpoint journal of the running experiment. the accounting
+ * state of the run is appended every tick as a fixed size record into a
+ * preallocated ring file, the records are synced to the disk in batches and
+ * the last valid record restores the run after a crash or a power loss.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_EXPDATA_EXPERIMENT_JOURNAL_H_
+#define APP_EXPDATA_EXPERIMENT_JOURNAL_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "app/common/thread.h"
+
+namespace anx {
+namespace expdata {
+
+/// @brief the file name of the experiment journal
+extern const char* kExperimentJournalFileName;
+
+/// @brief the accounting state of the running experiment, the counters of
+/// the second page and the sample infos of the graph and the list.
+/// @note the times of the run are kept as the offsets from time_ms_, the
+/// clock of the run starts again after a reboot, see OffsetOf and TimeOf.
+class ExperimentCheckpoint {
+ public:
+  ExperimentCheckpoint();
+
+  /// @brief Get the offset of the time of the run from the checkpoint time
+  /// @param time_ms the time of the run, 0 if not set
+  /// @param checkpoint_time_ms the time of the checkpoint, see time_ms_
+  /// @return the offset below 0, 0 if the time is not set
+  static int64_t OffsetOf(int64_t time_ms, int64_t checkpoint_time_ms);
+  /// @brief Get the time of the offset re-based on the clock now
+  /// @param offset_ms the offset, see OffsetOf
+  /// @param now_ms the time now of the clock of the run
+  /// @return the time of the run, 0 if the offset is of the time not set
+  static int64_t TimeOf(int64_t offset_ms, int64_t now_ms);
+
+ public:
+  /// @brief the time of the checkpoint in milliseconds of the clock of the
+  /// run, anx::common::GetCurrentTimeMillis
+  int64_t time_ms_;
+  /// @brief the exp state, stop, start or pause
+  int32_t exp_state_;
+  /// @brief the state of the exp clip, 1 start, 2 pause
+  int32_t clip_state_;
+  /// @brief the start time of the exp database of the run, the wall clock
+  /// time of the database name, it is not an offset
+  int64_t exp_db_start_time_ms_;
+  int32_t initial_frequency_;
+  int32_t initial_power_;
+  int64_t cur_total_cycle_count_;
+  int64_t pre_total_cycle_count_;
+  int32_t pre_total_data_table_no_;
+  /// @brief the offset of the start time, see OffsetOf
+  int64_t pre_exp_start_offset_ms_;
+  int64_t pre_clip_paused_ms_;
+  int64_t exp_data_pre_duration_exponential_;
+  bool start_time_pos_has_deal_;
+  /// @brief the sample info of the graph, the start time as the offset
+  int64_t graph_start_offset_ms_;
+  int64_t graph_time_interval_num_;
+  int32_t graph_data_table_no_;
+  /// @brief the sample info of the list, the times as the offsets
+  int64_t list_start_offset_ms_;
+  int64_t list_time_interval_num_;
+  int64_t list_pre_sample_offset_ms_;
+  int64_t list_freq_total_count_;
+  int32_t list_data_table_no_;
+  /// @brief the offset of the time the exp is paused at, see OffsetOf
+  int64_t paused_offset_ms_;
+};
+
+////////////////////////////////////////////////////////////
+// clz ExperimentJournal
+/// @brief the records are appended in a ring of the capacity, each record
+/// carries the sequence and the crc32, the torn record is skipped on read.
+/// the appends only write the record to the file, the thread syncs the file
+/// at the interval, Sync syncs at once, e.g. on the stop or the suspend.
+class ExperimentJournal : public anx::common::Runnable {
+ public:
+  /// @brief Constructor
+  /// @param capacity the records of the ring
+  /// @param sync_interval_ms the interval of the syncs, 0 syncs every append
+  explicit ExperimentJournal(uint32_t capacity = kDefaultCapacity,
+                             int32_t sync_interval_ms = kDefaultSyncIntervalMs);
+  ~ExperimentJournal() override;
+
+  ExperimentJournal(const ExperimentJournal&) = delete;
+  ExperimentJournal& operator=(const ExperimentJournal&) = delete;
+
+ public:
+  /// @brief Open the journal file, the file is created and preallocated if
+  /// not exists or of another capacity. the appends follow the last valid
+  /// record of the file.
+  /// @return 0 if success, -1 if opened, -2 if the file can't be opened, -3
+  /// if the file can't be preallocated
+  int32_t Open(const std::string& file_pathname);
+  /// @brief Sync and close the journal
+  void Close();
+  /// @brief Append the checkpoint
+  /// @return 0 if success, -1 if not opened, -2 if the write failed
+  int32_t Append(const ExperimentCheckpoint& checkpoint);
+  /// @brief Sync the records appended to the disk now
+  /// @return 0 if success, -1 if not opened, -2 if the sync failed
+  int32_t Sync();
+  /// @brief Get the last checkpoint, read on Open or appended
+  /// @return true if any
+  bool last_checkpoint(ExperimentCheckpoint* checkpoint);
+  /// @brief Get the sequence of the last record, 0 if none
+  uint64_t sequence();
+  /// @brief Get the sequence of the last record synced
+  uint64_t synced_sequence();
+
+  /// @brief Read the last valid checkpoint of the journal file
+  /// @return 0 if success, -1 if the file can't be read, -2 if no valid
+  /// record
+  static int32_t ReadLast(const std::string& file_pathname,
+                          ExperimentCheckpoint* checkpoint);
+
+  void interrupt() override;
+  bool is_interrupt() override;
+
+  /// @brief the size of one record in the file
+  static const uint32_t kRecordSize = 192;
+  static const uint32_t kDefaultCapacity = 1024;
+  static const int32_t kDefaultSyncIntervalMs = 1000;
+
+ protected:
+  void run() override;
+
+ private:
+  /// @brief Sync the file out of the lock, the appends go on meanwhile
+  int32_t SyncFile();
+  /// @brief Wait for the time or the stop
+  /// @return true if stopped
+  bool WaitFor(int32_t wait_ms);
+
+ private:
+  uint32_t capacity_;
+  int32_t sync_interval_ms_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  anx::common::Mutex mutex_;
+  anx::common::Condition cond_;
+  FILE* file_;
+  /// @brief the descriptor of the file, synced out of the lock
+  int32_t fd_;
+  uint64_t sequence_;
+  uint64_t synced_sequence_;
+  bool has_last_;
+  ExperimentCheckpoint last_;
+  /// @brief the syncs of the thread and of the callers are serialized
+  anx::common::Mutex sync_mutex_;
+};
+
+}  // namespace expdata
+}  // namespace anx
+
+#endif  // APP_EXPDATA_EXPERIMENT_JOURNAL_H_
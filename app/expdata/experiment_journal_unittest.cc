@@ -0,0 +1,230 @@
+/**
+ * @file experiment_journal_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief experiment journal unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "app/common/file_utils.h"
+#include "app/common/module_utils.h"
+#include "app/common/time_utils.h"
+#include "app/expdata/experiment_journal.h"
+
+namespace anx {
+namespace expdata {
+class ExperimentJournalTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    folder_ = anx::common::GetModuleDir() + anx::common::kPathSeparator +
+              "expdata_unittest";
+    anx::common::MakeSureFolderPathExist(FileName("x"));
+  }
+
+  std::string FileName(const std::string& name) {
+    return folder_ + anx::common::kPathSeparator + name;
+  }
+
+  /// @brief the checkpoint of the tick, the counters follow the tick
+  ExperimentCheckpoint Checkpoint(int64_t tick) {
+    ExperimentCheckpoint checkpoint;
+    checkpoint.time_ms_ = 1700000000000 + tick * 100;
+    checkpoint.exp_state_ = 1;
+    checkpoint.clip_state_ = 2;
+    checkpoint.exp_db_start_time_ms_ = 1700000000000;
+    checkpoint.initial_frequency_ = 20000;
+    checkpoint.initial_power_ = -3;
+    checkpoint.cur_total_cycle_count_ = tick * 20000;
+    checkpoint.pre_total_cycle_count_ = tick * 20000 - 7;
+    checkpoint.pre_total_data_table_no_ = static_cast<int32_t>(tick);
+    checkpoint.pre_exp_start_offset_ms_ = -tick * 100;
+    checkpoint.pre_clip_paused_ms_ = 1500;
+    checkpoint.exp_data_pre_duration_exponential_ = tick * 5;
+    checkpoint.start_time_pos_has_deal_ = true;
+    checkpoint.graph_start_offset_ms_ = -tick * 100 - 1;
+    checkpoint.graph_time_interval_num_ = tick / 20;
+    checkpoint.graph_data_table_no_ = static_cast<int32_t>(tick / 20);
+    checkpoint.list_start_offset_ms_ = -tick * 100 + 2;
+    checkpoint.list_time_interval_num_ = tick / 10;
+    checkpoint.list_pre_sample_offset_ms_ = -tick * 10;
+    checkpoint.list_freq_total_count_ = tick * 3;
+    checkpoint.list_data_table_no_ = static_cast<int32_t>(tick / 10);
+    checkpoint.paused_offset_ms_ = -tick;
+    return checkpoint;
+  }
+
+  void ExpectCheckpoint(const ExperimentCheckpoint& expected,
+                        const ExperimentCheckpoint& actual) {
+    EXPECT_EQ(expected.time_ms_, actual.time_ms_);
+    EXPECT_EQ(expected.exp_state_, actual.exp_state_);
+    EXPECT_EQ(expected.clip_state_, actual.clip_state_);
+    EXPECT_EQ(expected.exp_db_start_time_ms_, actual.exp_db_start_time_ms_);
+    EXPECT_EQ(expected.initial_frequency_, actual.initial_frequency_);
+    EXPECT_EQ(expected.initial_power_, actual.initial_power_);
+    EXPECT_EQ(expected.cur_total_cycle_count_, actual.cur_total_cycle_count_);
+    EXPECT_EQ(expected.pre_total_cycle_count_, actual.pre_total_cycle_count_);
+    EXPECT_EQ(expected.pre_total_data_table_no_,
+              actual.pre_total_data_table_no_);
+    EXPECT_EQ(expected.pre_exp_start_offset_ms_,
+              actual.pre_exp_start_offset_ms_);
+    EXPECT_EQ(expected.pre_clip_paused_ms_, actual.pre_clip_paused_ms_);
+    EXPECT_EQ(expected.exp_data_pre_duration_exponential_,
+              actual.exp_data_pre_duration_exponential_);
+    EXPECT_EQ(expected.start_time_pos_has_deal_,
+              actual.start_time_pos_has_deal_);
+    EXPECT_EQ(expected.graph_start_offset_ms_, actual.graph_start_offset_ms_);
+    EXPECT_EQ(expected.graph_time_interval_num_,
+              actual.graph_time_interval_num_);
+    EXPECT_EQ(expected.graph_data_table_no_, actual.graph_data_table_no_);
+    EXPECT_EQ(expected.list_start_offset_ms_, actual.list_start_offset_ms_);
+    EXPECT_EQ(expected.list_time_interval_num_,
+              actual.list_time_interval_num_);
+    EXPECT_EQ(expected.list_pre_sample_offset_ms_,
+              actual.list_pre_sample_offset_ms_);
+    EXPECT_EQ(expected.list_freq_total_count_, actual.list_freq_total_count_);
+    EXPECT_EQ(expected.list_data_table_no_, actual.list_data_table_no_);
+    EXPECT_EQ(expected.paused_offset_ms_, actual.paused_offset_ms_);
+  }
+
+  std::string folder_;
+};
+
+TEST_F(ExperimentJournalTest, OffsetRebasedOnClock) {
+  /// the run started 5 s before the checkpoint, the clock starts again
+  /// after a reboot.
+  int64_t offset_ms = ExperimentCheckpoint::OffsetOf(995000, 1000000);
+  EXPECT_EQ(offset_ms, -5000);
+  EXPECT_EQ(ExperimentCheckpoint::TimeOf(offset_ms, 30000), 25000);
+  /// the time not set stays not set
+  EXPECT_EQ(ExperimentCheckpoint::OffsetOf(0, 1000000), 0);
+  EXPECT_EQ(ExperimentCheckpoint::TimeOf(0, 30000), 0);
+  /// the time of the checkpoint itself is set
+  EXPECT_LT(ExperimentCheckpoint::OffsetOf(1000000, 1000000), 0);
+}
+
+TEST_F(ExperimentJournalTest, RoundTrip) {
+  std::string file_pathname = FileName("round_trip.anxj");
+  anx::common::RemoveFile(file_pathname);
+  ExperimentJournal journal(16, 0);
+  ASSERT_EQ(journal.Open(file_pathname), 0);
+  EXPECT_EQ(journal.Open(file_pathname), -1);
+  ExperimentCheckpoint checkpoint;
+  EXPECT_FALSE(journal.last_checkpoint(&checkpoint));
+  for (int64_t tick = 1; tick <= 5; tick++) {
+    ASSERT_EQ(journal.Append(Checkpoint(tick)), 0);
+  }
+  EXPECT_EQ(journal.sequence(), 5u);
+  EXPECT_EQ(journal.synced_sequence(), 5u);
+  ASSERT_TRUE(journal.last_checkpoint(&checkpoint));
+  ExpectCheckpoint(Checkpoint(5), checkpoint);
+  journal.Close();
+  EXPECT_EQ(journal.Append(Checkpoint(6)), -1);
+
+  ExperimentCheckpoint read;
+  ASSERT_EQ(ExperimentJournal::ReadLast(file_pathname, &read), 0);
+  ExpectCheckpoint(Checkpoint(5), read);
+  EXPECT_EQ(ExperimentJournal::ReadLast(FileName("none.anxj"), &read), -1);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentJournalTest, RingWrapAndReopen) {
+  std::string file_pathname = FileName("ring.anxj");
+  anx::common::RemoveFile(file_pathname);
+  {
+    ExperimentJournal journal(8, 0);
+    ASSERT_EQ(journal.Open(file_pathname), 0);
+    for (int64_t tick = 1; tick <= 21; tick++) {
+      ASSERT_EQ(journal.Append(Checkpoint(tick)), 0);
+    }
+  }
+  /// the file never grows over the ring
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  EXPECT_EQ(content.size(), 8u * ExperimentJournal::kRecordSize);
+
+  ExperimentJournal journal(8, 0);
+  ASSERT_EQ(journal.Open(file_pathname), 0);
+  EXPECT_EQ(journal.sequence(), 21u);
+  ExperimentCheckpoint checkpoint;
+  ASSERT_TRUE(journal.last_checkpoint(&checkpoint));
+  ExpectCheckpoint(Checkpoint(21), checkpoint);
+  ASSERT_EQ(journal.Append(Checkpoint(22)), 0);
+  EXPECT_EQ(journal.sequence(), 22u);
+  journal.Close();
+  ASSERT_EQ(ExperimentJournal::ReadLast(file_pathname, &checkpoint), 0);
+  ExpectCheckpoint(Checkpoint(22), checkpoint);
+
+  /// another capacity starts a new ring
+  ExperimentJournal other(4, 0);
+  ASSERT_EQ(other.Open(file_pathname), 0);
+  EXPECT_EQ(other.sequence(), 0u);
+  other.Close();
+  EXPECT_EQ(ExperimentJournal::ReadLast(file_pathname, &checkpoint), -2);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentJournalTest, TornRecordSkipped) {
+  std::string file_pathname = FileName("torn.anxj");
+  anx::common::RemoveFile(file_pathname);
+  {
+    ExperimentJournal journal(8, 0);
+    ASSERT_EQ(journal.Open(file_pathname), 0);
+    for (int64_t tick = 1; tick <= 3; tick++) {
+      ASSERT_EQ(journal.Append(Checkpoint(tick)), 0);
+    }
+  }
+  std::string content;
+  ASSERT_TRUE(anx::common::ReadFile(file_pathname, &content, true));
+  /// the record 3 is half written
+  size_t offset = 2 * ExperimentJournal::kRecordSize;
+  content[offset + 40] ^= 0x5A;
+  ASSERT_TRUE(anx::common::WriteFile(file_pathname, content, true));
+
+  ExperimentCheckpoint checkpoint;
+  ASSERT_EQ(ExperimentJournal::ReadLast(file_pathname, &checkpoint), 0);
+  ExpectCheckpoint(Checkpoint(2), checkpoint);
+  ExperimentJournal journal(8, 0);
+  ASSERT_EQ(journal.Open(file_pathname), 0);
+  EXPECT_EQ(journal.sequence(), 2u);
+  /// the next append overwrites the torn record
+  ASSERT_EQ(journal.Append(Checkpoint(4)), 0);
+  journal.Close();
+  ASSERT_EQ(ExperimentJournal::ReadLast(file_pathname, &checkpoint), 0);
+  ExpectCheckpoint(Checkpoint(4), checkpoint);
+
+  ASSERT_TRUE(anx::common::WriteFile(file_pathname, "not a journal", true));
+  EXPECT_EQ(ExperimentJournal::ReadLast(file_pathname, &checkpoint), -2);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ExperimentJournalTest, SyncInBatches) {
+  std::string file_pathname = FileName("batch.anxj");
+  anx::common::RemoveFile(file_pathname);
+  ExperimentJournal journal(64, 20);
+  ASSERT_EQ(journal.Open(file_pathname), 0);
+  for (int64_t tick = 1; tick <= 10; tick++) {
+    ASSERT_EQ(journal.Append(Checkpoint(tick)), 0);
+  }
+  /// the appends don't wait for the syncs
+  EXPECT_EQ(journal.sequence(), 10u);
+  for (int32_t i = 0; i < 100 && journal.synced_sequence() < 10u; i++) {
+    anx::common::sleep_ms(10);
+  }
+  EXPECT_EQ(journal.synced_sequence(), 10u);
+  ASSERT_EQ(journal.Append(Checkpoint(11)), 0);
+  EXPECT_EQ(journal.Sync(), 0);
+  EXPECT_EQ(journal.synced_sequence(), 11u);
+  journal.Close();
+  EXPECT_EQ(journal.Sync(), -1);
+  anx::common::RemoveFile(file_pathname);
+}
+
+}  // namespace expdata
+}  // namespace anx
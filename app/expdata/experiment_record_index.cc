@@ -0,0 +1,509 @@
+/**
+ * @file experiment_record_index.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief the persistent index of the experiment records
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/expdata/experiment_record_index.h"
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "app/common/file_utils.h"
+#include "app/common/logger.h"
+#include "app/common/module_utils.h"
+#include "app/common/string_utils.h"
+#include "app/db/database_helper.h"
+
+namespace anx {
+namespace expdata {
+
+const char* kExperimentRecordIndexName = "record_index.db";
+
+namespace {
+
+const char kTableExpRecord[] = "exp_record";
+const char kCreateTableExpRecordSql[] =
+    "CREATE TABLE IF NOT EXISTS exp_record (file_name TEXT PRIMARY KEY, "
+    "start_time INTEGER, end_time INTEGER, cycle_count INTEGER, duration "
+    "INTEGER, final_khz REAL, row_count INTEGER, file_size INTEGER, "
+    "modified_time INTEGER)";
+const char kCreateIndexExpRecordStartTimeSql[] =
+    "CREATE INDEX IF NOT EXISTS idx_exp_record_start_time ON exp_record "
+    "(start_time)";
+const char kReplaceExpRecordSqlPrepared[] =
+    "INSERT OR REPLACE INTO exp_record (file_name, start_time, end_time, "
+    "cycle_count, duration, final_khz, row_count, file_size, modified_time) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)";
+const char kDeleteExpRecordSqlPrepared[] =
+    "DELETE FROM exp_record WHERE file_name = ?";
+const char kQueryExpRecordStatSql[] =
+    "SELECT file_name, file_size, modified_time FROM exp_record";
+const char kQueryExpRecordStatSqlPrepared[] =
+    "SELECT file_size, modified_time FROM exp_record WHERE file_name = ?";
+const char kQueryExpRecordSqlPrepared[] =
+    "SELECT * FROM exp_record WHERE start_time >= ? AND end_time <= ? "
+    "ORDER BY start_time DESC";
+
+const char kCsvExtension[] = ".csv";
+const char kXmlExtension[] = ".xml";
+
+/// @brief the interval of the watch to check the stop
+const int32_t kWatchPollMs = 200;
+
+/// @brief the tail of the csv read for the last row
+const int64_t kCsvTailSize = 4096;
+
+bool EndsWith(const std::string& value, const std::string& suffix) {
+  return value.size() >= suffix.size() &&
+         value.compare(value.size() - suffix.size(), suffix.size(), suffix) ==
+             0;
+}
+
+/// @brief Get the base name of the record file, empty if not a record file
+std::string RecordBaseName(const std::string& file_name) {
+  if (EndsWith(file_name, kCsvExtension) ||
+      EndsWith(file_name, kXmlExtension)) {
+    return file_name.substr(0, file_name.size() - 4);
+  }
+  return std::string();
+}
+
+bool StatFile(const std::string& file_pathname,
+              int64_t* file_size,
+              int64_t* modified_time) {
+#if defined(_WIN32) || defined(_WIN64)
+  struct _stat64 st;
+  if (_wstat64(anx::common::String2WString(file_pathname).c_str(), &st) !=
+      0) {
+    return false;
+  }
+#else
+  struct stat st;
+  if (stat(file_pathname.c_str(), &st) != 0) {
+    return false;
+  }
+#endif
+  *file_size = static_cast<int64_t>(st.st_size);
+  *modified_time = static_cast<int64_t>(st.st_mtime);
+  return true;
+}
+
+/// @brief Read the last row of the csv file, only the tail of the file is
+/// read. the row is id,cycle_count,KHz,MPa,μm.
+/// @return true if any row
+bool ReadLastCsvRow(const std::string& file_pathname,
+                    int64_t* rows,
+                    double* khz) {
+  FILE* file = fopen(file_pathname.c_str(), "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  int64_t file_size = static_cast<int64_t>(ftell(file));
+  int64_t offset = file_size > kCsvTailSize ? file_size - kCsvTailSize : 0;
+  std::string tail(static_cast<size_t>(file_size - offset), '\0');
+  fseek(file, static_cast<long>(offset), SEEK_SET);  // NOLINT
+  size_t read = fread(&tail[0], 1, tail.size(), file);
+  fclose(file);
+  tail.resize(read);
+  while (!tail.empty() && (tail.back() == '\n' || tail.back() == '\r')) {
+    tail.pop_back();
+  }
+  std::string::size_type line_pos = tail.find_last_of('\n');
+  std::string line =
+      line_pos == std::string::npos ? tail : tail.substr(line_pos + 1);
+  std::vector<std::string> values = anx::common::Split(line, ",");
+  if (values.size() < 3) {
+    return false;
+  }
+  char* end = nullptr;
+  int64_t id = strtoll(values[0].c_str(), &end, 10);
+  if (end == values[0].c_str()) {
+    /// the header only
+    return false;
+  }
+  *rows = id;
+  *khz = strtod(values[2].c_str(), nullptr);
+  return true;
+}
+
+int64_t ToInt64(const std::string& value) {
+  return strtoll(value.c_str(), nullptr, 10);
+}
+
+}  // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+// clz ExperimentRecordIndex
+ExperimentRecordIndex* ExperimentRecordIndex::instance_ = nullptr;
+
+ExperimentRecordIndex* ExperimentRecordIndex::Instance() {
+  if (instance_ == nullptr) {
+    std::string folder = anx::common::GetApplicationDataPath("anxi") +
+                         anx::common::kPathSeparator + "expdata";
+    instance_ = new ExperimentRecordIndex(folder);
+    instance_->Open(true);
+  }
+  return instance_;
+}
+
+void ExperimentRecordIndex::ReleaseInstance() {
+  if (instance_ != nullptr) {
+    delete instance_;
+    instance_ = nullptr;
+  }
+}
+
+ExperimentRecordIndex::ExperimentRecordIndex(const std::string& folder)
+    : folder_(folder),
+      index_db_name_(folder + anx::common::kPathSeparator +
+                     kExperimentRecordIndexName),
+      opened_(false),
+      synced_(false),
+      parsed_count_(0) {}
+
+ExperimentRecordIndex::~ExperimentRecordIndex() {
+  Close();
+}
+
+int32_t ExperimentRecordIndex::Open(bool watch) {
+  if (is_opened()) {
+    return -1;
+  }
+  if (!anx::common::MakeSureFolderPathExist(index_db_name_)) {
+    LOG_F(LG_ERROR) << "Failed to make folder: " << folder_;
+    return -2;
+  }
+  std::vector<std::string> sqls;
+  sqls.push_back(kCreateTableExpRecordSql);
+  sqls.push_back(kCreateIndexExpRecordStartTimeSql);
+  if (!anx::db::helper::InitializeDataBase(index_db_name_, sqls)) {
+    LOG_F(LG_ERROR) << "Failed to open record index: " << index_db_name_;
+    return -3;
+  }
+  {
+    anx::common::AutoLock lock(&mutex_);
+    opened_ = true;
+    synced_ = false;
+    parsed_count_ = 0;
+    stop_ = false;
+  }
+  if (watch) {
+    thread_.reset(new anx::common::Thread(this));
+    thread_->start();
+  } else {
+    Sync();
+  }
+  return 0;
+}
+
+void ExperimentRecordIndex::Close() {
+  interrupt();
+  if (thread_ != nullptr) {
+    thread_->join();
+    thread_.reset();
+  }
+  anx::common::AutoLock index_lock(&index_mutex_);
+  anx::common::AutoLock lock(&mutex_);
+  if (opened_) {
+    anx::db::helper::CloseDataBase(index_db_name_);
+    opened_ = false;
+  }
+}
+
+int32_t ExperimentRecordIndex::Sync() {
+  anx::common::AutoLock index_lock(&index_mutex_);
+  if (!is_opened()) {
+    return -1;
+  }
+  std::vector<std::string> csv_file_names;
+  if (!anx::common::GetFilesInFolder(folder_, kCsvExtension,
+                                     &csv_file_names)) {
+    return -2;
+  }
+  std::vector<std::map<std::string, std::string>> result;
+  if (!anx::db::helper::QueryDataBase(index_db_name_, kTableExpRecord,
+                                      kQueryExpRecordStatSql, &result)) {
+    return -2;
+  }
+  std::map<std::string, std::pair<int64_t, int64_t>> indexed;
+  for (auto& row : result) {
+    indexed[row["file_name"]] = std::make_pair(ToInt64(row["file_size"]),
+                                               ToInt64(row["modified_time"]));
+  }
+  /// the changes of one sync are committed at once
+  anx::db::helper::ExecuteDataBase(index_db_name_, "BEGIN");
+  std::set<std::string> seen;
+  for (const auto& csv_file_name : csv_file_names) {
+    if (!EndsWith(csv_file_name, kCsvExtension)) {
+      continue;
+    }
+    std::string base = RecordBaseName(csv_file_name);
+    std::string csv_pathname =
+        folder_ + anx::common::kPathSeparator + csv_file_name;
+    std::string xml_pathname =
+        folder_ + anx::common::kPathSeparator + base + kXmlExtension;
+    int64_t file_size = 0;
+    int64_t modified_time = 0;
+    int64_t xml_size = 0;
+    int64_t xml_modified_time = 0;
+    if (!StatFile(csv_pathname, &file_size, &modified_time) ||
+        !StatFile(xml_pathname, &xml_size, &xml_modified_time)) {
+      continue;
+    }
+    modified_time = std::max(modified_time, xml_modified_time);
+    seen.insert(csv_file_name);
+    auto iter = indexed.find(csv_file_name);
+    if (iter != indexed.end() && iter->second.first == file_size &&
+        iter->second.second == modified_time) {
+      continue;
+    }
+    IndexRecord(csv_file_name, file_size, modified_time);
+  }
+  for (auto& iter : indexed) {
+    if (seen.find(iter.first) == seen.end()) {
+      RemoveRecord(iter.first);
+    }
+  }
+  anx::db::helper::ExecuteDataBase(index_db_name_, "COMMIT");
+  anx::common::AutoLock lock(&mutex_);
+  synced_ = true;
+  return 0;
+}
+
+int32_t ExperimentRecordIndex::Refresh(const std::string& file_name) {
+  anx::common::AutoLock index_lock(&index_mutex_);
+  if (!is_opened()) {
+    return -1;
+  }
+  std::string base = RecordBaseName(file_name);
+  if (base.empty()) {
+    return 0;
+  }
+  std::string csv_file_name = base + kCsvExtension;
+  std::string csv_pathname =
+      folder_ + anx::common::kPathSeparator + csv_file_name;
+  std::string xml_pathname =
+      folder_ + anx::common::kPathSeparator + base + kXmlExtension;
+  int64_t file_size = 0;
+  int64_t modified_time = 0;
+  int64_t xml_size = 0;
+  int64_t xml_modified_time = 0;
+  if (!StatFile(csv_pathname, &file_size, &modified_time) ||
+      !StatFile(xml_pathname, &xml_size, &xml_modified_time)) {
+    return RemoveRecord(csv_file_name);
+  }
+  modified_time = std::max(modified_time, xml_modified_time);
+  std::vector<anx::db::DatabaseValue> params;
+  params.push_back(csv_file_name);
+  std::vector<std::map<std::string, std::string>> result;
+  if (anx::db::helper::QueryDataBase(index_db_name_, kTableExpRecord,
+                                     kQueryExpRecordStatSqlPrepared, params,
+                                     &result) &&
+      result.size() == 1 && ToInt64(result[0]["file_size"]) == file_size &&
+      ToInt64(result[0]["modified_time"]) == modified_time) {
+    return 0;
+  }
+  return IndexRecord(csv_file_name, file_size, modified_time);
+}
+
+int32_t ExperimentRecordIndex::Query(
+    int64_t start_time,
+    int64_t end_time,
+    std::vector<ExperimentFileSummary>* summarys) {
+  if (!is_opened()) {
+    return -1;
+  }
+  /// the sync of the thread is in progress, e.g. the dialog opened at the
+  /// startup. the sync waits for it and stats the folder once more only.
+  if (!is_synced()) {
+    Sync();
+  }
+  std::vector<anx::db::DatabaseValue> params;
+  params.push_back(start_time);
+  params.push_back(end_time);
+  std::vector<std::map<std::string, std::string>> result;
+  if (!anx::db::helper::QueryDataBase(index_db_name_, kTableExpRecord,
+                                      kQueryExpRecordSqlPrepared, params,
+                                      &result)) {
+    return -2;
+  }
+  for (auto& row : result) {
+    ExperimentFileSummary summary;
+    summary.file_name_ = row["file_name"];
+    summary.start_time_ = static_cast<uint64_t>(ToInt64(row["start_time"]));
+    summary.end_time_ = static_cast<uint64_t>(ToInt64(row["end_time"]));
+    summary.cycle_count_ = ToInt64(row["cycle_count"]);
+    summary.duration_ = ToInt64(row["duration"]);
+    summary.final_khz_ = strtod(row["final_khz"].c_str(), nullptr);
+    summary.rows_ = ToInt64(row["row_count"]);
+    summary.file_size_ = ToInt64(row["file_size"]);
+    summarys->push_back(summary);
+  }
+  return 0;
+}
+
+int64_t ExperimentRecordIndex::parsed_count() {
+  anx::common::AutoLock lock(&mutex_);
+  return parsed_count_;
+}
+
+void ExperimentRecordIndex::interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  stop_ = true;
+}
+
+bool ExperimentRecordIndex::is_interrupt() {
+  anx::common::AutoLock lock(&mutex_);
+  return stop_;
+}
+
+void ExperimentRecordIndex::run() {
+  Sync();
+#if defined(_WIN32) || defined(_WIN64)
+  HANDLE handle = FindFirstChangeNotification(
+      anx::common::String2WString(folder_).c_str(), FALSE,
+      FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE |
+          FILE_NOTIFY_CHANGE_LAST_WRITE);
+  if (handle == INVALID_HANDLE_VALUE) {
+    LOG_F(LG_ERROR) << "Failed to watch folder: " << folder_;
+    return;
+  }
+  /// @note the notification carries no file name, the sync stats the files
+  /// and parses the records changed only.
+  while (!is_interrupt()) {
+    if (WaitForSingleObject(handle, kWatchPollMs) != WAIT_OBJECT_0) {
+      continue;
+    }
+    Sync();
+    if (!FindNextChangeNotification(handle)) {
+      LOG_F(LG_ERROR) << "Failed to watch folder: " << folder_;
+      break;
+    }
+  }
+  FindCloseChangeNotification(handle);
+#elif defined(__linux__)
+  int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0 ||
+      inotify_add_watch(fd, folder_.c_str(),
+                        IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                            IN_DELETE) < 0) {
+    LOG_F(LG_ERROR) << "Failed to watch folder: " << folder_;
+    if (fd >= 0) {
+      close(fd);
+    }
+    return;
+  }
+  std::vector<char> buffer(16 * 1024);
+  while (!is_interrupt()) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    if (poll(&pfd, 1, kWatchPollMs) <= 0) {
+      continue;
+    }
+    ssize_t size = read(fd, buffer.data(), buffer.size());
+    if (size <= 0) {
+      continue;
+    }
+    bool overflow = false;
+    std::set<std::string> file_names;
+    for (ssize_t pos = 0; pos < size;) {
+      const struct inotify_event* event =
+          reinterpret_cast<const struct inotify_event*>(buffer.data() + pos);
+      if (event->mask & IN_Q_OVERFLOW) {
+        overflow = true;
+      } else if (event->len > 0) {
+        file_names.insert(event->name);
+      }
+      pos += sizeof(struct inotify_event) + event->len;
+    }
+    if (overflow) {
+      Sync();
+      continue;
+    }
+    for (const auto& file_name : file_names) {
+      Refresh(file_name);
+    }
+  }
+  close(fd);
+#endif
+}
+
+int32_t ExperimentRecordIndex::IndexRecord(const std::string& csv_file_name,
+                                           int64_t file_size,
+                                           int64_t modified_time) {
+  std::string base = RecordBaseName(csv_file_name);
+  ExperimentReport report;
+  if (LoadExperimentReportWithFilePath(
+          folder_ + anx::common::kPathSeparator + base + kXmlExtension,
+          &report) != 0) {
+    return RemoveRecord(csv_file_name);
+  }
+  int64_t rows = 0;
+  double final_khz = 0;
+  ReadLastCsvRow(folder_ + anx::common::kPathSeparator + csv_file_name, &rows,
+                 &final_khz);
+  std::vector<anx::db::DatabaseValue> params;
+  params.push_back(csv_file_name);
+  params.push_back(report.start_time_);
+  params.push_back(report.end_time_);
+  params.push_back(report.cycle_count_);
+  params.push_back(report.end_time_ - report.start_time_);
+  params.push_back(final_khz);
+  params.push_back(rows);
+  params.push_back(file_size);
+  params.push_back(modified_time);
+  {
+    anx::common::AutoLock lock(&mutex_);
+    parsed_count_++;
+  }
+  if (!anx::db::helper::InsertDataTable(index_db_name_, kTableExpRecord,
+                                        kReplaceExpRecordSqlPrepared, params)) {
+    LOG_F(LG_ERROR) << "Failed to index record: " << csv_file_name;
+    return -2;
+  }
+  return 0;
+}
+
+int32_t ExperimentRecordIndex::RemoveRecord(const std::string& csv_file_name) {
+  std::vector<anx::db::DatabaseValue> params;
+  params.push_back(csv_file_name);
+  if (!anx::db::helper::InsertDataTable(index_db_name_, kTableExpRecord,
+                                        kDeleteExpRecordSqlPrepared, params)) {
+    return -2;
+  }
+  return 0;
+}
+
+bool ExperimentRecordIndex::is_opened() {
+  anx::common::AutoLock lock(&mutex_);
+  return opened_;
+}
+
+bool ExperimentRecordIndex::is_synced() {
+  anx::common::AutoLock lock(&mutex_);
+  return synced_;
+}
+
+}  // namespace expdata
+}  // namespace anx
@@ -0,0 +1,121 @@
+/**
+ * @file experiment_record_index.h
+ * @author hhool (hhool@outlook.com)
+ * @brief the persistent index of the experiment records of the expdata
+ * folder, the csv files with the xml reports. the summary of each record is
+ * parsed once and kept in a sqlite table, the folder is watched and the
+ * records changed are parsed again only.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_EXPDATA_EXPERIMENT_RECORD_INDEX_H_
+#define APP_EXPDATA_EXPERIMENT_RECORD_INDEX_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "app/common/thread.h"
+#include "app/expdata/experiment_data_base.h"
+
+namespace anx {
+namespace expdata {
+
+/// @brief the database file name of the index in the expdata folder
+extern const char* kExperimentRecordIndexName;
+
+////////////////////////////////////////////////////////////
+// clz ExperimentRecordIndex
+/// @brief the record of the csv file is indexed with the size and the
+/// modified time of the file, the sync lists the folder and parses only the
+/// records of another size or time. the csv without the xml report is not
+/// indexed and left as is. the thread syncs the folder on Open and follows
+/// the changes of the folder, inotify on linux and the change notification
+/// on windows.
+class ExperimentRecordIndex : public anx::common::Runnable {
+ public:
+  /// @brief Constructor
+  /// @param folder the absolute path of the folder of the records
+  explicit ExperimentRecordIndex(const std::string& folder);
+  ~ExperimentRecordIndex() override;
+
+  ExperimentRecordIndex(const ExperimentRecordIndex&) = delete;
+  ExperimentRecordIndex& operator=(const ExperimentRecordIndex&) = delete;
+
+ public:
+  /// @brief Get the index of the expdata folder of the application data
+  /// path, opened and watched on the first call.
+  static ExperimentRecordIndex* Instance();
+  static void ReleaseInstance();
+
+  /// @brief Open the index database in the folder
+  /// @param watch true to sync and watch the folder in the thread, false to
+  /// sync the folder now.
+  /// @return 0 if success, -1 if opened, -2 if the folder can't be made, -3
+  /// if the index database can't be opened
+  int32_t Open(bool watch);
+  /// @brief Stop the watch and close the index database
+  void Close();
+  /// @brief Sync the index with the records of the folder
+  /// @return 0 if success, -1 if not opened, -2 if the folder can't be listed
+  int32_t Sync();
+  /// @brief Index the record of the file again now, e.g. on the exp stop.
+  /// the record is removed from the index if the files are removed.
+  /// @param file_name the csv or the xml file name of the record in the
+  /// folder
+  /// @return 0 if success, -1 if not opened, -2 if the index failed
+  int32_t Refresh(const std::string& file_name);
+  /// @brief Query the records started from the start time and ended before
+  /// the end time, the latest first. the query before the first sync of the
+  /// folder is done waits for it, the list is not partial.
+  /// @param start_time the start time in seconds
+  /// @param end_time the end time in seconds
+  /// @param summarys the records
+  /// @return 0 if success, -1 if not opened, -2 if the query failed
+  int32_t Query(int64_t start_time,
+                int64_t end_time,
+                std::vector<ExperimentFileSummary>* summarys);
+
+  /// @brief Get the count of the records parsed since Open
+  int64_t parsed_count();
+  const std::string& folder() const { return folder_; }
+
+  void interrupt() override;
+  bool is_interrupt() override;
+
+ protected:
+  void run() override;
+
+ private:
+  /// @brief Index the record of the csv file with the stat of the file
+  int32_t IndexRecord(const std::string& csv_file_name,
+                      int64_t file_size,
+                      int64_t modified_time);
+  int32_t RemoveRecord(const std::string& csv_file_name);
+  bool is_opened();
+  bool is_synced();
+
+ private:
+  std::string folder_;
+  std::string index_db_name_;
+  std::unique_ptr<anx::common::Thread> thread_;
+  anx::common::Mutex mutex_;
+  bool opened_;
+  /// @brief the folder is synced once since Open
+  bool synced_;
+  int64_t parsed_count_;
+  /// @brief the syncs of the thread and the refreshes of the callers are
+  /// serialized
+  anx::common::Mutex index_mutex_;
+
+  static ExperimentRecordIndex* instance_;
+};
+
+}  // namespace expdata
+}  // namespace anx
+
+#endif  // APP_EXPDATA_EXPERIMENT_RECORD_INDEX_H_
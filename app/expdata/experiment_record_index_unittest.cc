@@ -0,0 +1,183 @@
+/**
+ * @file experiment_record_index_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief experiment record index unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "app/common/file_utils.h"
+#include "app/common/module_utils.h"
+#include "app/common/time_utils.h"
+#include "app/db/database_factory.h"
+#include "app/expdata/experiment_data_base.h"
+#include "app/expdata/experiment_record_index.h"
+
+namespace anx {
+namespace expdata {
+class ExperimentRecordIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    folder_ = anx::common::GetModuleDir() + anx::common::kPathSeparator +
+              "expdata_unittest" + anx::common::kPathSeparator +
+              "record_index";
+    anx::common::MakeSureFolderPathExist(FileName("x.db"));
+    Clear();
+  }
+  void TearDown() override {
+    anx::db::DatabaseFactory::Instance()->CloseAllDatabase();
+    Clear();
+  }
+
+  std::string FileName(const std::string& name) {
+    return folder_ + anx::common::kPathSeparator + name;
+  }
+
+  void Clear() {
+    std::vector<std::string> files;
+    anx::common::GetFilesInFolder(folder_, &files);
+    for (const auto& file : files) {
+      anx::common::RemoveFile(FileName(file));
+    }
+  }
+
+  /// @brief write the xml report and the csv of rows, the name of the
+  /// record is start_end as the exp stop does.
+  std::string WriteRecord(int64_t start_time, int64_t end_time, int32_t rows) {
+    ExperimentReport report;
+    report.start_time_ = start_time;
+    report.end_time_ = end_time;
+    report.cycle_count_ = rows * 1000;
+    std::string base =
+        std::to_string(start_time) + "_" + std::to_string(end_time);
+    EXPECT_TRUE(
+        anx::common::WriteFile(FileName(base + ".xml"), report.ToXml(), true));
+    WriteCsv(base + ".csv", rows);
+    return base + ".csv";
+  }
+
+  void WriteCsv(const std::string& file_name, int32_t rows) {
+    std::string csv = "id,cycle_count,KHz,MPa,um\n";
+    for (int32_t i = 1; i <= rows; i++) {
+      csv += std::to_string(i) + "," + std::to_string(i * 1000) + "," +
+             std::to_string(20 + i) + ".500,1.0,2.0\n";
+    }
+    EXPECT_TRUE(anx::common::WriteFile(FileName(file_name), csv, true));
+  }
+
+  std::vector<ExperimentFileSummary> QueryAll(ExperimentRecordIndex* index) {
+    std::vector<ExperimentFileSummary> summarys;
+    EXPECT_EQ(index->Query(0, INT64_MAX, &summarys), 0);
+    return summarys;
+  }
+
+  std::string folder_;
+};
+
+TEST_F(ExperimentRecordIndexTest, SyncOnceAndReopen) {
+  WriteRecord(1700000000, 1700000600, 3);
+  WriteRecord(1700001000, 1700001060, 5);
+  WriteRecord(1700002000, 1700009200, 1);
+  /// the csv without the report is not indexed and not removed
+  WriteCsv("orphan.csv", 2);
+  {
+    ExperimentRecordIndex index(folder_);
+    ASSERT_EQ(index.Open(false), 0);
+    EXPECT_EQ(index.Open(false), -1);
+    EXPECT_EQ(index.parsed_count(), 3);
+    std::vector<ExperimentFileSummary> summarys = QueryAll(&index);
+    ASSERT_EQ(summarys.size(), 3u);
+    /// the latest first
+    EXPECT_EQ(summarys[0].start_time_, 1700002000u);
+    EXPECT_EQ(summarys[1].file_name_, "1700001000_1700001060.csv");
+    EXPECT_EQ(summarys[1].end_time_, 1700001060u);
+    EXPECT_EQ(summarys[1].duration_, 60);
+    EXPECT_EQ(summarys[1].cycle_count_, 5000);
+    EXPECT_EQ(summarys[1].rows_, 5);
+    EXPECT_DOUBLE_EQ(summarys[1].final_khz_, 25.5);
+    EXPECT_GT(summarys[1].file_size_, 0);
+    EXPECT_TRUE(anx::common::FileExists(FileName("orphan.csv")));
+  }
+  /// the index persists, nothing is parsed again
+  ExperimentRecordIndex index(folder_);
+  ASSERT_EQ(index.Open(false), 0);
+  EXPECT_EQ(index.parsed_count(), 0);
+  EXPECT_EQ(QueryAll(&index).size(), 3u);
+
+  std::vector<ExperimentFileSummary> summarys;
+  ASSERT_EQ(index.Query(1700000500, 1700002000, &summarys), 0);
+  ASSERT_EQ(summarys.size(), 1u);
+  EXPECT_EQ(summarys[0].start_time_, 1700001000u);
+}
+
+TEST_F(ExperimentRecordIndexTest, SyncChangedRecordsOnly) {
+  std::string first = WriteRecord(1700000000, 1700000600, 3);
+  std::string second = WriteRecord(1700001000, 1700001060, 5);
+  WriteRecord(1700002000, 1700009200, 1);
+  ExperimentRecordIndex index(folder_);
+  ASSERT_EQ(index.Open(false), 0);
+  EXPECT_EQ(index.parsed_count(), 3);
+
+  WriteCsv(first, 7);
+  anx::common::RemoveFile(FileName(second));
+  ASSERT_EQ(index.Sync(), 0);
+  EXPECT_EQ(index.parsed_count(), 4);
+  std::vector<ExperimentFileSummary> summarys = QueryAll(&index);
+  ASSERT_EQ(summarys.size(), 2u);
+  EXPECT_EQ(summarys[1].file_name_, first);
+  EXPECT_EQ(summarys[1].rows_, 7);
+  EXPECT_DOUBLE_EQ(summarys[1].final_khz_, 27.5);
+}
+
+TEST_F(ExperimentRecordIndexTest, RefreshOnStop) {
+  ExperimentRecordIndex index(folder_);
+  ASSERT_EQ(index.Open(false), 0);
+  EXPECT_EQ(QueryAll(&index).size(), 0u);
+  std::string file_name = WriteRecord(1700000000, 1700000600, 3);
+  ASSERT_EQ(index.Refresh(file_name), 0);
+  EXPECT_EQ(index.parsed_count(), 1);
+  /// the record unchanged is not parsed again
+  ASSERT_EQ(index.Refresh(file_name), 0);
+  EXPECT_EQ(index.parsed_count(), 1);
+  EXPECT_EQ(QueryAll(&index).size(), 1u);
+  anx::common::RemoveFile(FileName(file_name));
+  ASSERT_EQ(index.Refresh(file_name), 0);
+  EXPECT_EQ(QueryAll(&index).size(), 0u);
+  index.Close();
+  EXPECT_EQ(index.Refresh(file_name), -1);
+}
+
+TEST_F(ExperimentRecordIndexTest, WatchFolder) {
+  for (int32_t i = 0; i < 20; i++) {
+    WriteRecord(1600000000 + i * 1000, 1600000600 + i * 1000, 3);
+  }
+  ExperimentRecordIndex index(folder_);
+  ASSERT_EQ(index.Open(true), 0);
+  /// the first query waits for the sync of the thread
+  EXPECT_EQ(QueryAll(&index).size(), 20u);
+  anx::common::RemoveFile(FileName("1600000000_1600000600.csv"));
+  for (int32_t i = 0; i < 200 && QueryAll(&index).size() > 19u; i++) {
+    anx::common::sleep_ms(10);
+  }
+  EXPECT_EQ(QueryAll(&index).size(), 19u);
+  WriteRecord(1700001000, 1700001060, 5);
+  for (int32_t i = 0; i < 200 && QueryAll(&index).size() < 20u; i++) {
+    anx::common::sleep_ms(10);
+  }
+  std::vector<ExperimentFileSummary> summarys = QueryAll(&index);
+  ASSERT_EQ(summarys.size(), 20u);
+  EXPECT_EQ(summarys[0].rows_, 5);
+  index.Close();
+}
+
+}  // namespace expdata
+}  // namespace anx
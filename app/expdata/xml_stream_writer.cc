@@ -0,0 +1,145 @@
+/**
+ * @file xml_stream_writer.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief forward only xml writer, the markup is buffered and handed to the
+ * sink in blocks, no document tree is built.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/expdata/xml_stream_writer.h"
+
+#include <cstring>
+
+namespace anx {
+namespace expdata {
+
+XmlStreamWriter::XmlStreamWriter(XmlStreamSink* sink, size_t block_size)
+    : sink_(sink),
+      block_size_(block_size),
+      start_tag_open_(false),
+      status_(0) {
+  buffer_.reserve(block_size_ + 1024);
+}
+
+XmlStreamWriter::~XmlStreamWriter() {}
+
+void XmlStreamWriter::Raw(const std::string& markup) {
+  Raw(markup.data(), markup.size());
+}
+
+void XmlStreamWriter::Raw(const char* markup, size_t size) {
+  CloseStartTag();
+  buffer_.append(markup, size);
+  MaybeFlush();
+}
+
+void XmlStreamWriter::StartElement(const char* name) {
+  CloseStartTag();
+  buffer_ += '<';
+  buffer_ += name;
+  elements_.push_back(name);
+  start_tag_open_ = true;
+}
+
+void XmlStreamWriter::Attribute(const char* name, const std::string& value) {
+  if (!start_tag_open_) {
+    return;
+  }
+  buffer_ += ' ';
+  buffer_ += name;
+  buffer_ += "=\"";
+  Escape(value.data(), value.size(), true);
+  buffer_ += '"';
+}
+
+void XmlStreamWriter::Text(const std::string& text) {
+  Text(text.data(), text.size());
+}
+
+void XmlStreamWriter::Text(const char* text, size_t size) {
+  CloseStartTag();
+  Escape(text, size, false);
+  MaybeFlush();
+}
+
+void XmlStreamWriter::EndElement() {
+  if (elements_.empty()) {
+    return;
+  }
+  if (start_tag_open_) {
+    buffer_ += "/>";
+    start_tag_open_ = false;
+  } else {
+    buffer_ += "</";
+    buffer_ += elements_.back();
+    buffer_ += '>';
+  }
+  elements_.pop_back();
+  MaybeFlush();
+}
+
+void XmlStreamWriter::Element(const char* name, const std::string& text) {
+  StartElement(name);
+  Text(text);
+  EndElement();
+}
+
+int32_t XmlStreamWriter::Flush() {
+  CloseStartTag();
+  if (!buffer_.empty() && status_ == 0) {
+    status_ = sink_->Write(buffer_.data(), buffer_.size());
+  }
+  buffer_.clear();
+  return status_;
+}
+
+void XmlStreamWriter::CloseStartTag() {
+  if (start_tag_open_) {
+    buffer_ += '>';
+    start_tag_open_ = false;
+  }
+}
+
+void XmlStreamWriter::Escape(const char* text, size_t size, bool attribute) {
+  /// @note copy the runs without special characters at once, the numbers of
+  /// the data tables have none.
+  size_t run = 0;
+  for (size_t i = 0; i < size; i++) {
+    const char* entity = nullptr;
+    switch (text[i]) {
+      case '&':
+        entity = "&amp;";
+        break;
+      case '<':
+        entity = "&lt;";
+        break;
+      case '>':
+        entity = "&gt;";
+        break;
+      case '"':
+        entity = attribute ? "&quot;" : nullptr;
+        break;
+      default:
+        break;
+    }
+    if (entity != nullptr) {
+      buffer_.append(text + run, i - run);
+      buffer_ += entity;
+      run = i + 1;
+    }
+  }
+  buffer_.append(text + run, size - run);
+}
+
+void XmlStreamWriter::MaybeFlush() {
+  if (buffer_.size() >= block_size_ && !start_tag_open_) {
+    Flush();
+  }
+}
+
+}  // namespace expdata
+}  // namespace anx
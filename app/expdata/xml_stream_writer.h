@@ -0,0 +1,96 @@
+/**
+ * @file xml_stream_writer.h
+ * @author hhool (hhool@outlook.com)
+ * @brief forward only xml writer, the markup is buffered and handed to the
+ * sink in blocks, no document tree is built.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_EXPDATA_XML_STREAM_WRITER_H_
+#define APP_EXPDATA_XML_STREAM_WRITER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace anx {
+namespace expdata {
+
+/// @brief the output of the XmlStreamWriter
+class XmlStreamSink {
+ public:
+  XmlStreamSink() = default;
+  virtual ~XmlStreamSink() = default;
+
+  /// @brief Write the markup block
+  /// @return 0 if success, otherwise failed
+  virtual int32_t Write(const char* data, size_t size) = 0;
+};
+
+class XmlStreamWriter {
+ public:
+  /// @brief Constructor
+  /// @param sink the output, must outlive the writer
+  /// @param block_size the buffered size before the block is written
+  explicit XmlStreamWriter(XmlStreamSink* sink, size_t block_size = 64 * 1024);
+  ~XmlStreamWriter();
+
+  XmlStreamWriter(const XmlStreamWriter&) = delete;
+  XmlStreamWriter& operator=(const XmlStreamWriter&) = delete;
+
+ public:
+  /// @brief Write the markup as is, e.g. the declaration or a template part
+  void Raw(const std::string& markup);
+  void Raw(const char* markup, size_t size);
+
+  /// @brief Start the element, the attributes may follow
+  /// @param name the element name, kept until the element ends, e.g. a
+  /// string literal
+  void StartElement(const char* name);
+
+  /// @brief Add the attribute to the element just started
+  void Attribute(const char* name, const std::string& value);
+
+  /// @brief Write the escaped text content
+  void Text(const std::string& text);
+  void Text(const char* text, size_t size);
+
+  /// @brief End the last started element, an element without content is
+  /// closed as <name/>
+  void EndElement();
+
+  /// @brief Write the whole element <name>text</name>
+  void Element(const char* name, const std::string& text);
+
+  /// @brief Write the buffered markup to the sink
+  /// @return 0 if success, the first error of the sink otherwise
+  int32_t Flush();
+
+  /// @brief Get the first error of the sink, 0 if no error
+  int32_t status() const { return status_; }
+
+  /// @brief Get the count of the open elements
+  size_t depth() const { return elements_.size(); }
+
+ private:
+  void CloseStartTag();
+  void Escape(const char* text, size_t size, bool attribute);
+  void MaybeFlush();
+
+ private:
+  XmlStreamSink* sink_;
+  size_t block_size_;
+  std::string buffer_;
+  std::vector<const char*> elements_;
+  bool start_tag_open_;
+  int32_t status_;
+};
+
+}  // namespace expdata
+}  // namespace anx
+
+#endif  // APP_EXPDATA_XML_STREAM_WRITER_H_
@@ -0,0 +1,498 @@
+/**
+ * @file zip_file.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief minimal zip file reader and streaming writer on zlib, enough for the
+ * office open xml packages.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include "app/expdata/zip_file.h"
+
+#include <zlib.h>
+
+#include <time.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "app/common/file_utils.h"
+#include "app/common/logger.h"
+
+namespace anx {
+namespace expdata {
+
+namespace {
+
+const uint32_t kLocalHeaderSignature = 0x04034b50;
+const uint32_t kDataDescriptorSignature = 0x08074b50;
+const uint32_t kCentralHeaderSignature = 0x02014b50;
+const uint32_t kEndOfCentralSignature = 0x06054b50;
+const size_t kLocalHeaderSize = 30;
+const size_t kCentralHeaderSize = 46;
+const size_t kEndOfCentralSize = 22;
+const uint16_t kMethodStored = 0;
+const uint16_t kMethodDeflated = 8;
+const uint16_t kFlagDataDescriptor = 0x0008;
+const uint16_t kFlagUtf8 = 0x0800;
+const uint16_t kVersionNeeded = 20;
+const size_t kBufferSize = 64 * 1024;
+
+uint16_t GetU16(const char* p) {
+  const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+  return static_cast<uint16_t>(u[0] | (u[1] << 8));
+}
+
+uint32_t GetU32(const char* p) {
+  const unsigned char* u = reinterpret_cast<const unsigned char*>(p);
+  return static_cast<uint32_t>(u[0]) | (static_cast<uint32_t>(u[1]) << 8) |
+         (static_cast<uint32_t>(u[2]) << 16) |
+         (static_cast<uint32_t>(u[3]) << 24);
+}
+
+void PutU16(std::string* out, uint16_t value) {
+  out->push_back(static_cast<char>(value & 0xFF));
+  out->push_back(static_cast<char>(value >> 8));
+}
+
+void PutU32(std::string* out, uint32_t value) {
+  for (int32_t i = 0; i < 4; i++) {
+    out->push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+  }
+}
+
+/// @brief the ms-dos time and date of now
+void DosDateTime(uint16_t* dos_time, uint16_t* dos_date) {
+  time_t now = time(nullptr);
+  struct tm tm;
+#if defined(_WIN32)
+  localtime_s(&tm, &now);
+#else
+  localtime_r(&now, &tm);
+#endif
+  *dos_time = static_cast<uint16_t>((tm.tm_hour << 11) | (tm.tm_min << 5) |
+                                    (tm.tm_sec / 2));
+  int32_t year = tm.tm_year + 1900 < 1980 ? 0 : tm.tm_year + 1900 - 1980;
+  *dos_date = static_cast<uint16_t>((year << 9) | ((tm.tm_mon + 1) << 5) |
+                                    tm.tm_mday);
+}
+
+}  // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ZipEntry
+ZipEntry::ZipEntry()
+    : method_(kMethodStored),
+      flags_(0),
+      time_(0),
+      date_(0),
+      crc32_(0),
+      compressed_size_(0),
+      size_(0),
+      local_header_offset_(0) {}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ZipFileReader
+ZipFileReader::ZipFileReader() {}
+
+ZipFileReader::~ZipFileReader() {}
+
+int32_t ZipFileReader::Open(const std::string& file_pathname) {
+  content_.clear();
+  entries_.clear();
+  if (!anx::common::ReadFile(file_pathname, &content_, true)) {
+    LOG_F(LG_ERROR) << "read file failed:" << file_pathname;
+    return -1;
+  }
+  /// @note the end of central directory record is at the end of the file
+  /// followed by a comment up to 64 KiB.
+  if (content_.size() < kEndOfCentralSize) {
+    return -2;
+  }
+  size_t eocd = std::string::npos;
+  size_t lowest = content_.size() > kEndOfCentralSize + 0xFFFF
+                      ? content_.size() - kEndOfCentralSize - 0xFFFF
+                      : 0;
+  for (size_t pos = content_.size() - kEndOfCentralSize + 1; pos-- > lowest;) {
+    if (GetU32(&content_[pos]) == kEndOfCentralSignature) {
+      eocd = pos;
+      break;
+    }
+  }
+  if (eocd == std::string::npos) {
+    LOG_F(LG_ERROR) << "not a zip file:" << file_pathname;
+    return -2;
+  }
+  uint16_t count = GetU16(&content_[eocd + 10]);
+  uint32_t cd_size = GetU32(&content_[eocd + 12]);
+  uint32_t cd_offset = GetU32(&content_[eocd + 16]);
+  if (cd_offset == 0xFFFFFFFF || static_cast<uint64_t>(cd_offset) + cd_size >
+                                     static_cast<uint64_t>(eocd)) {
+    LOG_F(LG_ERROR) << "unsupported zip file:" << file_pathname;
+    return -2;
+  }
+  size_t pos = cd_offset;
+  for (uint16_t i = 0; i < count; i++) {
+    if (pos + kCentralHeaderSize > eocd ||
+        GetU32(&content_[pos]) != kCentralHeaderSignature) {
+      entries_.clear();
+      return -2;
+    }
+    ZipEntry entry;
+    entry.flags_ = GetU16(&content_[pos + 8]);
+    entry.method_ = GetU16(&content_[pos + 10]);
+    entry.time_ = GetU16(&content_[pos + 12]);
+    entry.date_ = GetU16(&content_[pos + 14]);
+    entry.crc32_ = GetU32(&content_[pos + 16]);
+    entry.compressed_size_ = GetU32(&content_[pos + 20]);
+    entry.size_ = GetU32(&content_[pos + 24]);
+    uint16_t name_size = GetU16(&content_[pos + 28]);
+    uint16_t extra_size = GetU16(&content_[pos + 30]);
+    uint16_t comment_size = GetU16(&content_[pos + 32]);
+    entry.local_header_offset_ = GetU32(&content_[pos + 42]);
+    if (pos + kCentralHeaderSize + name_size > eocd) {
+      entries_.clear();
+      return -2;
+    }
+    entry.name_ = content_.substr(pos + kCentralHeaderSize, name_size);
+    entries_.push_back(entry);
+    pos += kCentralHeaderSize + name_size + extra_size + comment_size;
+  }
+  return 0;
+}
+
+const ZipEntry* ZipFileReader::FindEntry(const std::string& name) const {
+  for (auto& entry : entries_) {
+    if (entry.name_ == name) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+int32_t ZipFileReader::RawEntry(const ZipEntry& entry,
+                                const char** data,
+                                uint32_t* size) const {
+  size_t pos = entry.local_header_offset_;
+  if (pos + kLocalHeaderSize > content_.size() ||
+      GetU32(&content_[pos]) != kLocalHeaderSignature) {
+    return -2;
+  }
+  size_t data_pos = pos + kLocalHeaderSize + GetU16(&content_[pos + 26]) +
+                    GetU16(&content_[pos + 28]);
+  if (data_pos + entry.compressed_size_ > content_.size()) {
+    return -2;
+  }
+  *data = content_.data() + data_pos;
+  *size = entry.compressed_size_;
+  return 0;
+}
+
+int32_t ZipFileReader::ReadEntry(const ZipEntry& entry,
+                                 std::string* data) const {
+  const char* raw = nullptr;
+  uint32_t raw_size = 0;
+  if (RawEntry(entry, &raw, &raw_size) != 0) {
+    return -2;
+  }
+  if (entry.method_ == kMethodStored) {
+    data->assign(raw, raw_size);
+  } else if (entry.method_ == kMethodDeflated && entry.size_ == 0) {
+    data->clear();
+  } else if (entry.method_ == kMethodDeflated) {
+    data->resize(entry.size_);
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+      return -3;
+    }
+    stream.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(raw));  // NOLINT
+    stream.avail_in = raw_size;
+    stream.next_out = reinterpret_cast<Bytef*>(&(*data)[0]);
+    stream.avail_out = entry.size_;
+    int ret = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    if (ret != Z_STREAM_END || stream.total_out != entry.size_) {
+      LOG_F(LG_ERROR) << "inflate failed:" << entry.name_;
+      return -3;
+    }
+  } else {
+    LOG_F(LG_ERROR) << "unsupported method:" << entry.method_;
+    return -3;
+  }
+  uint32_t crc = static_cast<uint32_t>(
+      crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data->data()),
+            static_cast<uInt>(data->size())));
+  if (crc != entry.crc32_) {
+    LOG_F(LG_ERROR) << "crc32 mismatch:" << entry.name_;
+    return -3;
+  }
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// clz ZipFileWriter
+ZipFileWriter::ZipFileWriter(int32_t level)
+    : level_(level),
+      file_(nullptr),
+      offset_(0),
+      stream_(new z_stream()),
+      streaming_(false),
+      stream_size_(0),
+      buffer_(kBufferSize) {}
+
+ZipFileWriter::~ZipFileWriter() {
+  if (streaming_) {
+    deflateEnd(stream_.get());
+  }
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+int32_t ZipFileWriter::Open(const std::string& file_pathname) {
+  if (file_ != nullptr) {
+    return -1;
+  }
+  file_ = fopen(file_pathname.c_str(), "wb");
+  if (file_ == nullptr) {
+    LOG_F(LG_ERROR) << "open file failed:" << file_pathname;
+    return -1;
+  }
+  offset_ = 0;
+  entries_.clear();
+  return 0;
+}
+
+int32_t ZipFileWriter::AddEntry(const std::string& name,
+                                const std::string& data) {
+  int32_t ret = BeginEntry(name);
+  if (ret != 0) {
+    return ret;
+  }
+  ret = WriteEntry(data.data(), data.size());
+  if (ret != 0) {
+    return ret;
+  }
+  return EndEntry();
+}
+
+int32_t ZipFileWriter::CopyEntry(const ZipFileReader& reader,
+                                 const ZipEntry& entry) {
+  if (file_ == nullptr) {
+    return -1;
+  }
+  if (streaming_ && EndEntry() != 0) {
+    return -3;
+  }
+  const char* raw = nullptr;
+  uint32_t raw_size = 0;
+  if (reader.RawEntry(entry, &raw, &raw_size) != 0) {
+    return -2;
+  }
+  if (offset_ > 0xFFFFFFFF) {
+    return -3;
+  }
+  ZipEntry copy = entry;
+  copy.flags_ &= ~kFlagDataDescriptor;
+  copy.local_header_offset_ = static_cast<uint32_t>(offset_);
+  if (WriteLocalHeader(copy) != 0 || WriteBytes(raw, raw_size) != 0) {
+    return -3;
+  }
+  entries_.push_back(copy);
+  return 0;
+}
+
+int32_t ZipFileWriter::BeginEntry(const std::string& name) {
+  if (file_ == nullptr) {
+    return -1;
+  }
+  if (streaming_ && EndEntry() != 0) {
+    return -3;
+  }
+  if (offset_ > 0xFFFFFFFF) {
+    LOG_F(LG_ERROR) << "zip file exceeds 4 GiB";
+    return -3;
+  }
+  ZipEntry entry;
+  entry.name_ = name;
+  entry.method_ = kMethodDeflated;
+  entry.flags_ = kFlagDataDescriptor | kFlagUtf8;
+  DosDateTime(&entry.time_, &entry.date_);
+  entry.local_header_offset_ = static_cast<uint32_t>(offset_);
+  if (WriteLocalHeader(entry) != 0) {
+    return -3;
+  }
+  memset(stream_.get(), 0, sizeof(z_stream));
+  if (deflateInit2(stream_.get(), level_, Z_DEFLATED, -MAX_WBITS, 8,
+                   Z_DEFAULT_STRATEGY) != Z_OK) {
+    return -3;
+  }
+  entry.crc32_ = static_cast<uint32_t>(crc32(0L, Z_NULL, 0));
+  entries_.push_back(entry);
+  streaming_ = true;
+  stream_size_ = 0;
+  return 0;
+}
+
+int32_t ZipFileWriter::WriteEntry(const char* data, size_t size) {
+  if (!streaming_) {
+    return -1;
+  }
+  stream_size_ += size;
+  if (stream_size_ > 0xFFFFFFFF) {
+    LOG_F(LG_ERROR) << "zip entry exceeds 4 GiB:" << entries_.back().name_;
+    return -3;
+  }
+  ZipEntry& entry = entries_.back();
+  const Bytef* in = reinterpret_cast<const Bytef*>(data);
+  while (size > 0) {
+    uInt chunk = static_cast<uInt>(
+        std::min<size_t>(size, std::numeric_limits<uInt>::max()));
+    entry.crc32_ = static_cast<uint32_t>(crc32(entry.crc32_, in, chunk));
+    stream_->next_in = const_cast<Bytef*>(in);  // NOLINT
+    stream_->avail_in = chunk;
+    if (Deflate(Z_NO_FLUSH) != 0) {
+      return -3;
+    }
+    in += chunk;
+    size -= chunk;
+  }
+  return 0;
+}
+
+int32_t ZipFileWriter::EndEntry() {
+  if (!streaming_) {
+    return -1;
+  }
+  stream_->next_in = nullptr;
+  stream_->avail_in = 0;
+  int32_t ret = Deflate(Z_FINISH);
+  uint64_t compressed_size = stream_->total_out;
+  deflateEnd(stream_.get());
+  streaming_ = false;
+  if (ret != 0 || compressed_size > 0xFFFFFFFF) {
+    return -3;
+  }
+  ZipEntry& entry = entries_.back();
+  entry.compressed_size_ = static_cast<uint32_t>(compressed_size);
+  entry.size_ = static_cast<uint32_t>(stream_size_);
+  std::string descriptor;
+  PutU32(&descriptor, kDataDescriptorSignature);
+  PutU32(&descriptor, entry.crc32_);
+  PutU32(&descriptor, entry.compressed_size_);
+  PutU32(&descriptor, entry.size_);
+  return WriteBytes(descriptor.data(), descriptor.size());
+}
+
+int32_t ZipFileWriter::Close() {
+  if (file_ == nullptr) {
+    return -1;
+  }
+  int32_t ret = 0;
+  if (streaming_ && EndEntry() != 0) {
+    ret = -3;
+  }
+  uint64_t cd_offset = offset_;
+  std::string cd;
+  for (auto& entry : entries_) {
+    PutU32(&cd, kCentralHeaderSignature);
+    PutU16(&cd, kVersionNeeded);
+    PutU16(&cd, kVersionNeeded);
+    PutU16(&cd, entry.flags_);
+    PutU16(&cd, entry.method_);
+    PutU16(&cd, entry.time_);
+    PutU16(&cd, entry.date_);
+    PutU32(&cd, entry.crc32_);
+    PutU32(&cd, entry.compressed_size_);
+    PutU32(&cd, entry.size_);
+    PutU16(&cd, static_cast<uint16_t>(entry.name_.size()));
+    PutU16(&cd, 0);
+    PutU16(&cd, 0);
+    PutU16(&cd, 0);
+    PutU16(&cd, 0);
+    PutU32(&cd, 0);
+    PutU32(&cd, entry.local_header_offset_);
+    cd += entry.name_;
+  }
+  std::string eocd;
+  PutU32(&eocd, kEndOfCentralSignature);
+  PutU16(&eocd, 0);
+  PutU16(&eocd, 0);
+  PutU16(&eocd, static_cast<uint16_t>(entries_.size()));
+  PutU16(&eocd, static_cast<uint16_t>(entries_.size()));
+  PutU32(&eocd, static_cast<uint32_t>(cd.size()));
+  PutU32(&eocd, static_cast<uint32_t>(cd_offset));
+  PutU16(&eocd, 0);
+  if (ret == 0 &&
+      (cd_offset > 0xFFFFFFFF || entries_.size() > 0xFFFF ||
+       WriteBytes(cd.data(), cd.size()) != 0 ||
+       WriteBytes(eocd.data(), eocd.size()) != 0)) {
+    ret = -3;
+  }
+  if (fclose(file_) != 0 && ret == 0) {
+    ret = -3;
+  }
+  file_ = nullptr;
+  entries_.clear();
+  return ret;
+}
+
+int32_t ZipFileWriter::WriteLocalHeader(const ZipEntry& entry) {
+  std::string header;
+  PutU32(&header, kLocalHeaderSignature);
+  PutU16(&header, kVersionNeeded);
+  PutU16(&header, entry.flags_);
+  PutU16(&header, entry.method_);
+  PutU16(&header, entry.time_);
+  PutU16(&header, entry.date_);
+  /// @note the crc and sizes follow the data in the data descriptor
+  bool descriptor = (entry.flags_ & kFlagDataDescriptor) != 0;
+  PutU32(&header, descriptor ? 0 : entry.crc32_);
+  PutU32(&header, descriptor ? 0 : entry.compressed_size_);
+  PutU32(&header, descriptor ? 0 : entry.size_);
+  PutU16(&header, static_cast<uint16_t>(entry.name_.size()));
+  PutU16(&header, 0);
+  header += entry.name_;
+  return WriteBytes(header.data(), header.size());
+}
+
+int32_t ZipFileWriter::WriteBytes(const void* data, size_t size) {
+  if (size == 0) {
+    return 0;
+  }
+  if (fwrite(data, 1, size, file_) != size) {
+    LOG_F(LG_ERROR) << "write zip file failed";
+    return -3;
+  }
+  offset_ += size;
+  return 0;
+}
+
+int32_t ZipFileWriter::Deflate(int flush) {
+  do {
+    stream_->next_out = buffer_.data();
+    stream_->avail_out = static_cast<uInt>(buffer_.size());
+    int ret = deflate(stream_.get(), flush);
+    if (ret == Z_STREAM_ERROR) {
+      return -3;
+    }
+    size_t have = buffer_.size() - stream_->avail_out;
+    if (WriteBytes(buffer_.data(), have) != 0) {
+      return -3;
+    }
+    if (flush == Z_FINISH && ret == Z_STREAM_END) {
+      return 0;
+    }
+  } while (stream_->avail_out == 0 || flush == Z_FINISH);
+  return 0;
+}
+
+}  // namespace expdata
+}  // namespace anx
@@ -0,0 +1,143 @@
+/**
+ * @file zip_file.h
+ * @author hhool (hhool@outlook.com)
+ * @brief minimal zip file reader and streaming writer on zlib, enough for the
+ * office open xml packages.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef APP_EXPDATA_ZIP_FILE_H_
+#define APP_EXPDATA_ZIP_FILE_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct z_stream_s;
+
+namespace anx {
+namespace expdata {
+
+/// @brief the entry of the zip central directory
+class ZipEntry {
+ public:
+  ZipEntry();
+
+ public:
+  std::string name_;
+  uint16_t method_;
+  uint16_t flags_;
+  uint16_t time_;
+  uint16_t date_;
+  uint32_t crc32_;
+  uint32_t compressed_size_;
+  uint32_t size_;
+  uint32_t local_header_offset_;
+};
+
+/// @brief read the zip file, the whole file is loaded on open. the package
+/// templates are small, the large entries are written by the ZipFileWriter.
+class ZipFileReader {
+ public:
+  ZipFileReader();
+  ~ZipFileReader();
+
+ public:
+  /// @brief Open the zip file and load the central directory
+  /// @return 0 if success, -1 if the file can't be read, -2 if the file is
+  /// not a zip file or it's a zip64 file
+  int32_t Open(const std::string& file_pathname);
+
+  /// @brief Get the entries in the central directory order
+  const std::vector<ZipEntry>& entries() const { return entries_; }
+
+  /// @brief Get the entry by name
+  /// @return the entry, nullptr if not found
+  const ZipEntry* FindEntry(const std::string& name) const;
+
+  /// @brief Read and uncompress the entry
+  /// @return 0 if success, -2 if the entry is invalid, -3 if the method is
+  /// not supported or the data is corrupted
+  int32_t ReadEntry(const ZipEntry& entry, std::string* data) const;
+
+  /// @brief Get the raw compressed data of the entry
+  /// @return 0 if success, -2 if the entry is invalid
+  int32_t RawEntry(const ZipEntry& entry,
+                   const char** data,
+                   uint32_t* size) const;
+
+ private:
+  std::string content_;
+  std::vector<ZipEntry> entries_;
+};
+
+/// @brief write the zip file in one pass. the streamed entries are deflated
+/// on the fly with a data descriptor after the data, so the size of an entry
+/// doesn't need to be known up front.
+class ZipFileWriter {
+ public:
+  /// @brief Constructor
+  /// @param level the deflate level 0 - 9
+  explicit ZipFileWriter(int32_t level = 6);
+  ~ZipFileWriter();
+
+  ZipFileWriter(const ZipFileWriter&) = delete;
+  ZipFileWriter& operator=(const ZipFileWriter&) = delete;
+
+ public:
+  /// @brief Open the zip file to write, the file is truncated
+  /// @return 0 if success, -1 if the file can't be opened
+  int32_t Open(const std::string& file_pathname);
+
+  /// @brief Add an entry with the whole data
+  /// @return 0 if success, -1 if not opened, -3 if write failed
+  int32_t AddEntry(const std::string& name, const std::string& data);
+
+  /// @brief Copy the entry of the reader without recompress
+  /// @return 0 if success, -1 if not opened, -2 if the entry is invalid,
+  /// -3 if write failed
+  int32_t CopyEntry(const ZipFileReader& reader, const ZipEntry& entry);
+
+  /// @brief Begin a streamed entry, the previous streamed entry is ended
+  /// @return 0 if success, -1 if not opened, -3 if write failed
+  int32_t BeginEntry(const std::string& name);
+
+  /// @brief Write data to the streamed entry
+  /// @return 0 if success, -1 if no entry, -3 if write failed or the entry
+  /// exceeds 4 GiB
+  int32_t WriteEntry(const char* data, size_t size);
+
+  /// @brief End the streamed entry
+  /// @return 0 if success, -1 if no entry, -3 if write failed
+  int32_t EndEntry();
+
+  /// @brief Write the central directory and close the file
+  /// @return 0 if success, -1 if not opened, -3 if write failed
+  int32_t Close();
+
+ private:
+  int32_t WriteLocalHeader(const ZipEntry& entry);
+  int32_t WriteBytes(const void* data, size_t size);
+  int32_t Deflate(int flush);
+
+ private:
+  int32_t level_;
+  FILE* file_;
+  uint64_t offset_;
+  std::vector<ZipEntry> entries_;
+  std::unique_ptr<z_stream_s> stream_;
+  bool streaming_;
+  uint64_t stream_size_;
+  std::vector<unsigned char> buffer_;
+};
+
+}  // namespace expdata
+}  // namespace anx
+
+#endif  // APP_EXPDATA_ZIP_FILE_H_
@@ -0,0 +1,114 @@
+/**
+ * @file zip_file_unittest.cc
+ * @author hhool (hhool@outlook.com)
+ * @brief zip file reader and writer unit test
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+
+#include "app/common/file_utils.h"
+#include "app/common/module_utils.h"
+#include "app/expdata/zip_file.h"
+
+namespace anx {
+namespace expdata {
+class ZipFileTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    folder_ = anx::common::GetModuleDir() + anx::common::kPathSeparator +
+              "expdata_unittest";
+    anx::common::MakeSureFolderPathExist(FileName("x"));
+  }
+
+  std::string FileName(const std::string& name) {
+    return folder_ + anx::common::kPathSeparator + name;
+  }
+
+  std::string folder_;
+};
+
+TEST_F(ZipFileTest, WriteRead) {
+  std::string file_pathname = FileName("write_read.zip");
+  std::string large;
+  for (int32_t i = 0; i < 100000; i++) {
+    large += std::to_string(i) + ",";
+  }
+  ZipFileWriter writer;
+  ASSERT_EQ(writer.Open(file_pathname), 0);
+  ASSERT_EQ(writer.AddEntry("a.txt", "hello zip"), 0);
+  ASSERT_EQ(writer.AddEntry("empty.txt", ""), 0);
+  ASSERT_EQ(writer.BeginEntry("dir/large.txt"), 0);
+  for (size_t pos = 0; pos < large.size(); pos += 1000) {
+    ASSERT_EQ(writer.WriteEntry(large.data() + pos,
+                                std::min<size_t>(1000, large.size() - pos)),
+              0);
+  }
+  ASSERT_EQ(writer.EndEntry(), 0);
+  ASSERT_EQ(writer.Close(), 0);
+
+  ZipFileReader reader;
+  ASSERT_EQ(reader.Open(file_pathname), 0);
+  ASSERT_EQ(reader.entries().size(), 3u);
+  std::string data;
+  ASSERT_NE(reader.FindEntry("a.txt"), nullptr);
+  ASSERT_EQ(reader.ReadEntry(*reader.FindEntry("a.txt"), &data), 0);
+  EXPECT_EQ(data, "hello zip");
+  ASSERT_EQ(reader.ReadEntry(*reader.FindEntry("empty.txt"), &data), 0);
+  EXPECT_TRUE(data.empty());
+  const ZipEntry* entry = reader.FindEntry("dir/large.txt");
+  ASSERT_NE(entry, nullptr);
+  EXPECT_LT(entry->compressed_size_, entry->size_);
+  ASSERT_EQ(reader.ReadEntry(*entry, &data), 0);
+  EXPECT_EQ(data, large);
+  EXPECT_EQ(reader.FindEntry("none"), nullptr);
+  anx::common::RemoveFile(file_pathname);
+}
+
+TEST_F(ZipFileTest, CopyEntry) {
+  std::string src_pathname = FileName("copy_src.zip");
+  std::string dst_pathname = FileName("copy_dst.zip");
+  ZipFileWriter writer;
+  ASSERT_EQ(writer.Open(src_pathname), 0);
+  ASSERT_EQ(writer.AddEntry("a.txt", std::string(4096, 'a')), 0);
+  ASSERT_EQ(writer.AddEntry("b.txt", "b"), 0);
+  ASSERT_EQ(writer.Close(), 0);
+
+  ZipFileReader src;
+  ASSERT_EQ(src.Open(src_pathname), 0);
+  ZipFileWriter copy;
+  ASSERT_EQ(copy.Open(dst_pathname), 0);
+  ASSERT_EQ(copy.CopyEntry(src, *src.FindEntry("a.txt")), 0);
+  ASSERT_EQ(copy.AddEntry("c.txt", "c"), 0);
+  ASSERT_EQ(copy.Close(), 0);
+
+  ZipFileReader dst;
+  ASSERT_EQ(dst.Open(dst_pathname), 0);
+  ASSERT_EQ(dst.entries().size(), 2u);
+  std::string data;
+  ASSERT_EQ(dst.ReadEntry(*dst.FindEntry("a.txt"), &data), 0);
+  EXPECT_EQ(data, std::string(4096, 'a'));
+  ASSERT_EQ(dst.ReadEntry(*dst.FindEntry("c.txt"), &data), 0);
+  EXPECT_EQ(data, "c");
+  anx::common::RemoveFile(src_pathname);
+  anx::common::RemoveFile(dst_pathname);
+}
+
+TEST_F(ZipFileTest, OpenInvalid) {
+  std::string file_pathname = FileName("invalid.zip");
+  ASSERT_TRUE(anx::common::WriteFile(file_pathname, "not a zip file", true));
+  ZipFileReader reader;
+  EXPECT_EQ(reader.Open(file_pathname), -2);
+  EXPECT_EQ(reader.Open(FileName("none.zip")), -1);
+  anx::common::RemoveFile(file_pathname);
+}
+
+}  // namespace expdata
+}  // namespace anx
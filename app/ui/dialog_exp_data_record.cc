@@ -19,6 +19,7 @@
 #include "app/common/module_utils.h"
 #include "app/common/string_utils.h"
 #include "app/expdata/experiment_data_base.h"
+#include "app/expdata/experiment_record_index.h"
 #include "app/ui/ui_constants.h"
 
 DUI_BEGIN_MESSAGE_MAP(anx::ui::DialogExpDataRecord, DuiLib::WindowImplBase)
@@ -122,10 +123,9 @@ void DialogExpDataRecord::InitWindow() {
       ::MakeDelegate(this, &DialogExpDataRecord::OnOpenFolderButtonClick);
   btn_to_report_->OnNotify +=
       ::MakeDelegate(this, &DialogExpDataRecord::OnToReportButtonClick);
-  /// Traverse the directory expdata folder and get all the csv files
-  anx::expdata::TraverseExpDataFolder(&exp_data_summary_list_);
-  /// revert summarys
-  std::reverse(exp_data_summary_list_.begin(), exp_data_summary_list_.end());
+  /// the records of the index, the latest first
+  anx::expdata::ExperimentRecordIndex::Instance()->Query(
+      0, INT64_MAX, &exp_data_summary_list_);
   exp_data_list_ = static_cast<DuiLib::CListUI*>(
       this->m_PaintManager.FindControl(_T("exp_data_record_list")));
   for (const auto& summary : exp_data_summary_list_) {
@@ -252,24 +252,16 @@ bool DialogExpDataRecord::OnRefreshButtonClick(void* msg) {
   uint64_t end_time_unix = SystemTimeToUnixTime(end_time);
   exp_data_summary_list_.clear();
 
-  /// find the data from exp_data_summary_list_ to new list by the time
-  /// Traverse the directory expdata folder and get all the csv files
-  anx::expdata::TraverseExpDataFolder(&exp_data_summary_list_);
-  /// revert summarys
-  std::reverse(exp_data_summary_list_.begin(), exp_data_summary_list_.end());
-  std::vector<anx::expdata::ExperimentFileSummary> new_list;
-  for (const auto& summary : exp_data_summary_list_) {
-    if (summary.start_time_ >= start_time_unix &&
-        summary.end_time_ <= end_time_unix) {
-      new_list.push_back(summary);
-    }
-  }
-  /// no need revert new list
+  /// query the records of the time from the index, the latest first. the
+  /// items of the list follow the summarys one by one.
+  anx::expdata::ExperimentRecordIndex::Instance()->Query(
+      static_cast<int64_t>(start_time_unix),
+      static_cast<int64_t>(end_time_unix), &exp_data_summary_list_);
   DuiLib::CListUI* pList = static_cast<DuiLib::CListUI*>(
       this->m_PaintManager.FindControl(_T("exp_data_record_list")));
   pList->RemoveAll();
 
-  for (const auto& summary : new_list) {
+  for (const auto& summary : exp_data_summary_list_) {
     CListContainerElementUI* new_node = new CListContainerElementUI;
     new_node->SetAttributeList(
         _T("height=\"22\" width=\"360\" align=\"left\""));
@@ -30,6 +30,7 @@
 #include "app/device/device_com_settings_helper.h"
 #include "app/device/device_exp_data_sample_settings.h"
 #include "app/device/device_exp_load_static_settings.h"
+#include "app/device/stload/static_load_dll_device.h"
 #include "app/device/stload/stload_helper.h"
 #include "app/device/ultrasonic/ultra_helper.h"
 #include "app/esolution/solution_design.h"
@@ -63,6 +64,27 @@ namespace ui {
 namespace {
 const int32_t kTimerCurrentTimeMsgId = 1;
 const int32_t kTimerCurrentTimePeriod = 50;
+
+/// @brief Create the bus of the ultrasonic and the static load samples
+std::unique_ptr<anx::device::SampleBus> CreateSampleBus() {
+  std::unique_ptr<anx::device::SampleBus> bus(
+      new anx::device::SampleBus(anx::device::SampleBusOptions()));
+  anx::device::SampleSourceOptions ultra;
+  ultra.name = "ultrasonic";
+  ultra.channels = 2;
+  /// the generator is read by the sampling timer of the page
+  ultra.max_gap_us = 2 * 1000 * 1000;
+  anx::device::SampleSourceOptions stload;
+  stload.name = "static_load";
+  stload.channels = 3;
+  stload.max_gap_us = 500 * 1000;
+  int32_t ultra_source = bus->AddSource(ultra);
+  int32_t stload_source = bus->AddSource(stload);
+  assert(ultra_source == anx::device::kSampleSourceUltrasonic);
+  assert(stload_source == anx::device::kSampleSourceStaticLoad);
+  bus->Start();
+  return bus;
+}
 }  // namespace
 
 WorkWindow::WorkWindow(DuiLib::WindowImplBase* pOwner, int32_t solution_type)
@@ -72,6 +94,22 @@ WorkWindow::WorkWindow(DuiLib::WindowImplBase* pOwner, int32_t solution_type)
       anx::device::DeviceComFactory::Instance()->CreateOrGetDeviceComWithType(
           anx::device::kDeviceCom_Ultrasound, this);
   ultra_device_.reset(new anx::device::UltraDevice(device_com_ul.get()));
+  device_watchdog_.reset(
+      new anx::device::DeviceWatchdog(anx::device::DeviceWatchdogOptions()));
+  ultra_watchdog_id_ =
+      device_watchdog_->AddDevice("ultrasonic", ultra_device_.get());
+  device_watchdog_->AddListener(this);
+  device_watchdog_->Start();
+  sample_bus_ = CreateSampleBus();
+  station_manager_.reset(new anx::device::StationManager());
+  anx::device::StationOptions station_options;
+  station_options.name = "rig";
+  if (station_manager_->AddStation(station_options) == 0) {
+    station_ = station_manager_->GetStation(station_options.id);
+    station_->AttachDevice(device_com_ul);
+  } else {
+    LOG_F(LG_ERROR) << "station start failed:" << station_options.name;
+  }
   is_device_stload_connected_ = false;
   is_device_ultra_connected_ = false;
 
@@ -91,6 +129,10 @@ WorkWindow::WorkWindow(DuiLib::WindowImplBase* pOwner, int32_t solution_type)
   std::vector<std::string> sqls;
   sqls.push_back(anx::db::helper::sql::kCreateTableExpDataGraphSqlFormat);
   sqls.push_back(anx::db::helper::sql::kCreateTableExpDataListSqlFormat);
+  sqls.push_back(anx::db::helper::sql::kCreateIndexExpDataGraphDateSqlFormat);
+  sqls.push_back(anx::db::helper::sql::kCreateIndexExpDataGraphCycleSqlFormat);
+  sqls.push_back(anx::db::helper::sql::kCreateIndexExpDataListDateSqlFormat);
+  sqls.push_back(anx::db::helper::sql::kCreateIndexExpDataListCycleSqlFormat);
   sqls.push_back(anx::db::helper::sql::kCreateTableSendDataSqlFormat);
   sqls.push_back(anx::db::helper::sql::kCreateTableNotificationSqlFormat);
   sqls.push_back(anx::db::helper::sql::kCreateTableSendNotifySqlFormat);
@@ -157,6 +199,9 @@ WorkWindow::WorkWindow(DuiLib::WindowImplBase* pOwner, int32_t solution_type)
 }
 
 WorkWindow::~WorkWindow() {
+  /// the watchdog probes the ultra device and posts to the window
+  device_watchdog_->RemoveListener(this);
+  device_watchdog_->Stop();
   solution_design_base_->Dispose();
   for (auto& tab_main_page : tab_main_pages_) {
     DuiLib::CDuiString name(
@@ -186,6 +231,11 @@ WorkWindow::~WorkWindow() {
     tab_main_pages_.erase(it);
   }
 
+  /// the pages stopped the poll, the station closes the port of the rig
+  StopUltraPolling();
+  station_.reset();
+  station_manager_->RemoveStation(0);
+
   work_window_status_bar_virtual_wnd_->Unbind();
   work_window_status_bar_virtual_wnd_ = nullptr;
   WorkWindowStatusBar* work_window_status_bar =
@@ -275,10 +325,6 @@ void WorkWindow::InitWindow() {
       m_PaintManager.FindControl(_T("args_area_name_static_shift_mm")));
   btn_args_area_value_static_shift_mm_ = static_cast<CButtonUI*>(
       m_PaintManager.FindControl(_T("args_area_value_static_shift_mm")));
-  BOOL ret =
-      anx::device::stload::STLoadHelper::st_load_loader_.st_api_.set_dest_wnd(
-          this->GetHWND());
-  LOG_F(LG_INFO) << "set dest wnd ret:" << ret;
 }
 
 void WorkWindow::OnFinalMessage(HWND hWnd) {
@@ -593,25 +639,54 @@ LRESULT WorkWindow::OnNcHitTest(UINT uMsg,
 }
 
 LRESULT WorkWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) {
+  if (uMsg == DEVICE_HEALTH_MSG) {
+    std::vector<anx::device::DeviceHealthEvent> events;
+    {
+      anx::common::AutoLock lock(&device_health_mutex_);
+      events.swap(device_health_events_);
+    }
+    for (auto& event : events) {
+      LOG_F(LG_INFO) << "device " << event.name << " "
+                     << anx::device::DeviceHealthEventTypeToString(event.type)
+                     << " silence_ms:" << event.silence_ms
+                     << " attempts:" << event.attempts
+                     << " error:" << event.error;
+      DuiLib::TNotifyUI msg;
+      msg.pSender = this->h_layout_args_area_;
+      msg.sType = kValueChanged;
+      ENMsgStruct enmsg;
+      enmsg.type_ = enmsg_type_device_health;
+      enmsg.ptr_ = &event;
+      msg.wParam = reinterpret_cast<WPARAM>(&enmsg);
+      tab_main_pages_["WorkWindowSecondPage"]->NotifyPump(msg);
+    }
+    return 0;
+  }
+  if (uMsg == DOCX_REPORT_MSG) {
+    ENMsgDocxReport report;
+    report.finished_ = wParam != 0;
+    report.percent_ = report.finished_ ? 100 : static_cast<int32_t>(lParam);
+    report.result_ = report.finished_ ? static_cast<int32_t>(lParam) : 0;
+    DuiLib::TNotifyUI msg;
+    msg.pSender = this->h_layout_args_area_;
+    msg.sType = kValueChanged;
+    ENMsgStruct enmsg;
+    enmsg.type_ = enmsg_type_docx_report;
+    enmsg.ptr_ = &report;
+    msg.wParam = reinterpret_cast<WPARAM>(&enmsg);
+    tab_main_pages_["WorkWindowSecondPage"]->NotifyPump(msg);
+    return 0;
+  }
   if (uMsg == DLLMSG) {
     if (lParam == DLL_SAMPLE) {
-      anx::device::stload::STLoadHelper::st_load_loader_.st_api_
-          .before_get_sample();
-      double load =
-          anx::device::stload::STLoadHelper::st_load_loader_.st_api_.get_load();
-      double pos =
-          anx::device::stload::STLoadHelper::st_load_loader_.st_api_.get_posi();
-      double exten =
-          anx::device::stload::STLoadHelper::st_load_loader_.st_api_.get_extn();
-      uint32_t status = anx::device::stload::STLoadHelper::st_load_loader_
-                            .st_api_.get_test_status();
-      anx::device::stload::STLoadHelper::st_load_loader_.st_api_
-          .after_get_sample();
-
-      if (anx::device::stload::STLoadHelper::Is_Stload_Simulation()) {
-        pos = static_cast<double>(rand() % 100) * 1.0f;
-        load = static_cast<double>(rand() % 100) * 1.0f;
+      static_load_sample_posted_ = false;
+      anx::device::stload::StaticLoadSample sample;
+      if (static_load_device_ == nullptr ||
+          !static_load_device_->GetLatestSample(&sample)) {
+        return 0;
       }
+      double load = sample.load;
+      double pos = sample.position;
       float target_load_n = -1;
       float target_load_pos = -1;
       std::unique_ptr<anx::device::DeviceLoadStaticSettings> lss;
@@ -688,14 +763,10 @@ LRESULT WorkWindow::HandleMessage(UINT uMsg, WPARAM wParam, LPARAM lParam) {
       msg.pSender = this->h_layout_args_area_;
       msg.sType = kValueChanged;
 
+      /// the pages read the sample of GetStaticLoadSample, no address of
+      /// the stack is passed to them.
       ENMsgStruct enmsg;
-
-      anx::device::stload::STResult result;
-      result.load_ = load;
-      result.pos_ = pos;
-      result.status_ = status;
-
-      enmsg.ptr_ = &result;
+      enmsg.ptr_ = nullptr;
       enmsg.type_ = enmsg_type_stload_value_cur;
       msg.wParam = reinterpret_cast<WPARAM>(&enmsg);
       tab_main_pages_["WorkWindowThirdPage"]->NotifyPump(msg);
@@ -947,6 +1018,7 @@ void WorkWindow::OnMenuDeviceConnectClicked(DuiLib::TNotifyUI& msg) {
   }
   if (ret == 0) {
     is_device_stload_connected_ = true;
+    StartStaticLoadSampling();
   } else if (ret < 0) {
     is_device_stload_connected_ = false;
     anx::ui::DialogCommon::ShowDialog(
@@ -963,9 +1035,7 @@ void WorkWindow::OnMenuDeviceDisconnectClicked(DuiLib::TNotifyUI& msg) {
 }
 
 bool WorkWindow::IsDeviceComInterfaceConnected() const {
-  return (ultra_device_ != nullptr && ultra_device_->isOpened() &&
-          is_device_ultra_connected_) ||
-         (is_device_stload_connected_);
+  return IsULDeviceComInterfaceConnected() || (is_device_stload_connected_);
 }
 
 bool WorkWindow::IsSLDeviceComInterfaceConnected() const {
@@ -973,10 +1043,17 @@ bool WorkWindow::IsSLDeviceComInterfaceConnected() const {
 }
 
 bool WorkWindow::IsULDeviceComInterfaceConnected() const {
-  return ultra_device_ != nullptr && ultra_device_->isOpened() &&
+  /// the port is closed for a while when the watchdog reconnects it
+  return ultra_device_ != nullptr &&
+         (ultra_device_->isOpened() ||
+          ULDeviceHealth() == anx::device::kDeviceHealthLost) &&
          is_device_ultra_connected_;
 }
 
+int32_t WorkWindow::ULDeviceHealth() const {
+  return device_watchdog_->state(ultra_watchdog_id_);
+}
+
 int32_t WorkWindow::OpenDeviceCom(int32_t device_type) {
   if (device_type == anx::device::kDeviceCom_Ultrasound) {
     if (!ultra_device_->isOpened()) {
@@ -1084,6 +1161,7 @@ void WorkWindow::CloseDeviceCom(int32_t device_type) {
     }
   } else if (device_type == anx::device::kDeviceCom_StaticLoad) {
     LOG_F(LG_INFO) << "CloseDeviceCom StaticLoad";
+    StopStaticLoadSampling();
     if (anx::device::stload::STLoadHelper::st_load_loader_.st_api_.stop_run !=
         nullptr) {
       anx::device::stload::STLoadHelper::st_load_loader_.st_api_.stop_run();
@@ -1101,6 +1179,211 @@ void WorkWindow::CloseDeviceCom(int32_t device_type) {
   }
 }
 
+void WorkWindow::StartStaticLoadSampling() {
+  StopStaticLoadSampling();
+  anx::device::stload::StaticLoadOptions options;
+  anx::device::stload::StaticLoadDllDevice* device =
+      new anx::device::stload::StaticLoadDllDevice(options);
+  static_load_device_.reset(device);
+  static_load_actuator_ = device;
+  static_load_device_->AddListener(this);
+  if (static_load_device_->Open() != 0 ||
+      static_load_device_->StartSampling() != 0) {
+    LOG_F(LG_ERROR) << "start static load sampling failed";
+    static_load_device_.reset();
+    static_load_actuator_ = nullptr;
+  }
+}
+
+void WorkWindow::StopStaticLoadSampling() {
+  StopKeepLoad();
+  if (static_load_device_ == nullptr) {
+    return;
+  }
+  static_load_device_->RemoveListener(this);
+  static_load_device_->Close();
+  static_load_device_.reset();
+  static_load_actuator_ = nullptr;
+}
+
+int32_t WorkWindow::StartKeepLoad(
+    const anx::device::DeviceLoadStatic& settings) {
+  StopKeepLoad();
+  if (static_load_device_ == nullptr || !static_load_device_->sampling()) {
+    LOG_F(LG_ERROR) << "static load is not sampling";
+    return -1;
+  }
+  keep_load_controller_.reset(new anx::device::stload::KeepLoadController(
+      static_load_device_.get(), static_load_actuator_,
+      anx::device::stload::KeepLoadOptionsFromSettings(settings)));
+  keep_load_controller_->SetListener(this);
+  if (keep_load_controller_->Start() != 0) {
+    LOG_F(LG_ERROR) << "start keep load failed";
+    keep_load_controller_.reset();
+    return -2;
+  }
+  return 0;
+}
+
+void WorkWindow::StopKeepLoad() {
+  if (keep_load_controller_ == nullptr) {
+    return;
+  }
+  keep_load_controller_->Stop();
+  keep_load_controller_.reset();
+}
+
+anx::device::stload::KeepLoadState WorkWindow::KeepLoadState() {
+  if (keep_load_controller_ == nullptr) {
+    return anx::device::stload::kKeepLoadIdle;
+  }
+  return keep_load_controller_->state();
+}
+
+int32_t WorkWindow::CarryStaticLoad(
+    const anx::device::stload::StaticLoadCommand& command) {
+  if (static_load_actuator_ != nullptr) {
+    return static_load_actuator_->Carry200(command);
+  }
+  /// @note not sampling, the window is the only caller of the dll
+  const anx::device::stload::stload_api& api =
+      anx::device::stload::STLoadHelper::st_load_loader_.st_api_;
+  if (api.carry_200 == nullptr ||
+      !api.carry_200(command.control, command.end,
+                     static_cast<float>(command.speed),
+                     static_cast<float>(command.value), 0, true,
+                     command.direction, static_cast<float>(command.keep_value),
+                     command.keep_datum, 0)) {
+    LOG_F(LG_ERROR) << "carry_200 error";
+    return -2;
+  }
+  return 0;
+}
+
+void WorkWindow::StopStaticLoadRun() {
+  if (static_load_actuator_ != nullptr) {
+    static_load_actuator_->StopRun();
+    return;
+  }
+  const anx::device::stload::stload_api& api =
+      anx::device::stload::STLoadHelper::st_load_loader_.st_api_;
+  if (api.stop_run != nullptr) {
+    api.stop_run();
+  }
+}
+
+void WorkWindow::TareStaticLoad() {
+  if (static_load_actuator_ != nullptr) {
+    static_load_actuator_->Tare();
+    return;
+  }
+  const anx::device::stload::stload_api& api =
+      anx::device::stload::STLoadHelper::st_load_loader_.st_api_;
+  if (api.tare_ext1 != nullptr) {
+    api.tare_ext1();
+  }
+  if (api.tare_posi != nullptr) {
+    api.tare_posi();
+  }
+  if (api.tare_load != nullptr) {
+    api.tare_load();
+  }
+  if (api.tare_time != nullptr) {
+    api.tare_time();
+  }
+}
+
+void WorkWindow::OnStaticLoadSamples(
+    anx::device::stload::StaticLoadDevice* device,
+    const anx::device::stload::StaticLoadSample* samples,
+    size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    anx::device::SourceSample sample;
+    sample.time_us = samples[i].time_us;
+    sample.values[anx::device::kSampleBusStLoadLoad] = samples[i].load;
+    sample.values[anx::device::kSampleBusStLoadPosition] = samples[i].position;
+    sample.values[anx::device::kSampleBusStLoadExtension] =
+        samples[i].extension;
+    sample_bus_->Publish(anx::device::kSampleSourceStaticLoad, sample);
+  }
+  /// the window reads the latest sample, one message is pending at most
+  if (!static_load_sample_posted_.exchange(true)) {
+    ::PostMessage(this->GetHWND(), DLLMSG, 0, DLL_SAMPLE);
+  }
+}
+
+void WorkWindow::StartUltraPolling(int32_t interval_ms) {
+  if (station_ == nullptr) {
+    LOG_F(LG_ERROR) << "no station to poll the ultrasonic";
+    return;
+  }
+  if (interval_ms == ultra_poll_interval_ms_) {
+    return;
+  }
+  ultra_poll_interval_ms_ = interval_ms;
+  station_->AddTask(this, interval_ms);
+}
+
+void WorkWindow::StopUltraPolling() {
+  if (station_ == nullptr || ultra_poll_interval_ms_ == 0) {
+    return;
+  }
+  ultra_poll_interval_ms_ = 0;
+  station_->RemoveTask(this);
+}
+
+bool WorkWindow::GetUltraReadout(UltraReadout* readout) {
+  return ultra_readout_.Load(readout);
+}
+
+bool WorkWindow::GetStaticLoadSample(
+    anx::device::stload::StaticLoadSample* sample) {
+  if (static_load_device_ == nullptr) {
+    return false;
+  }
+  return static_load_device_->GetLatestSample(sample);
+}
+
+void WorkWindow::OnStationTask(anx::device::Station* station,
+                               int64_t now_ms) {
+  /// the watchdog reconnects the device, the reads wait for it
+  if (ULDeviceHealth() >= anx::device::kDeviceHealthLost) {
+    return;
+  }
+  UltraReadout readout;
+  readout.freq = ultra_device_->GetCurrentFreq();
+  readout.power = ultra_device_->GetCurrentPower();
+  readout.time_ms = anx::common::GetCurrentTimeMillis();
+  if (readout.freq >= 0 && readout.power >= 0) {
+    anx::device::SourceSample sample;
+    sample.time_us = static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+    sample.values[anx::device::kSampleBusUltraFreq] = readout.freq;
+    sample.values[anx::device::kSampleBusUltraPower] = readout.power;
+    sample_bus_->Publish(anx::device::kSampleSourceUltrasonic, sample);
+  }
+  ultra_readout_.Store(readout);
+}
+
+void WorkWindow::OnKeepLoadStateChanged(
+    anx::device::stload::KeepLoadController* controller,
+    const anx::device::stload::KeepLoadStatus& status) {
+  /// the pages check the state with the next sample, e.g. the fault of no
+  /// sample has no sample to deliver.
+  if (!static_load_sample_posted_.exchange(true)) {
+    ::PostMessage(this->GetHWND(), DLLMSG, 0, DLL_SAMPLE);
+  }
+}
+
+void WorkWindow::OnDeviceHealthEvent(
+    anx::device::DeviceWatchdog* watchdog,
+    const anx::device::DeviceHealthEvent& event) {
+  {
+    anx::common::AutoLock lock(&device_health_mutex_);
+    device_health_events_.push_back(event);
+  }
+  ::PostMessage(this->GetHWND(), DEVICE_HEALTH_MSG, 0, 0);
+}
+
 void WorkWindow::UpdateExpError(int32_t code, const std::string& message) {
   is_exp_state_ = kExpStateUnvalid;
 
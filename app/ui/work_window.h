@@ -12,11 +12,19 @@
 #ifndef APP_UI_WORK_WINDOW_H_
 #define APP_UI_WORK_WINDOW_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "app/common/latest_value.h"
 #include "app/device/device_com.h"
+#include "app/device/device_watchdog.h"
+#include "app/device/sample_bus.h"
+#include "app/device/station.h"
+#include "app/device/stload/keep_load_controller.h"
+#include "app/device/stload/static_load_device.h"
 #include "app/device/ultrasonic/ultra_device.h"
 #include "app/expdata/experiment_data_base.h"
 #include "app/ui/ui_virtual_wnd_base.h"
@@ -28,11 +36,20 @@
 // for DUI_DECLARE_MESSAGE_MAP
 using namespace DuiLib;  // NOLINT
 
+/// @brief the health events of the device watchdog are queued, the message
+/// is posted to the work window to handle them.
+#define DEVICE_HEALTH_MSG WM_USER + 4010
+/// @brief the docx report generator thread posts the message to the work
+/// window, wParam is 1 if finished and 0 if progress, lParam is the result
+/// or the percent.
+#define DOCX_REPORT_MSG WM_USER + 4011
+
 namespace anx {
 namespace device {
 class DeviceComInterface;
 class DeviceComListener;
 class DeviceExpDataSampleSettings;
+class DeviceLoadStatic;
 }  // namespace device
 namespace esolution {
 class SolutionDesign;
@@ -45,6 +62,14 @@ class WorkWindowStatusBar;
 class WorkWindowSecondPage;
 class WorkWindowSecondPageData;
 class WorkWindowThirdPage;
+
+/// @brief the readout of the ultrasonic generator polled on the station, the
+/// values are negative if the reads failed.
+struct UltraReadout {
+  int64_t time_ms = 0;
+  int32_t freq = -1;
+  int32_t power = -1;
+};
 }  // namespace ui
 }  // namespace anx
 
@@ -52,6 +77,10 @@ namespace anx {
 namespace ui {
 class WorkWindow : public DuiLib::WindowImplBase,
                    public anx::device::DeviceComListener,
+                   public anx::device::stload::StaticLoadListener,
+                   public anx::device::stload::KeepLoadListener,
+                   public anx::device::DeviceWatchdogListener,
+                   public anx::device::StationTask,
                    public anx::ui::UIExpStateBase {
  public:
   explicit WorkWindow(DuiLib::WindowImplBase* pOwner, int32_t solution_type);
@@ -141,12 +170,51 @@ class WorkWindow : public DuiLib::WindowImplBase,
   bool IsSLDeviceComInterfaceConnected() const;
   /// @brief is ul device com interface connected
   bool IsULDeviceComInterfaceConnected() const;
+  /// @brief Get the health of the ul device of the watchdog
+  /// @return @see anx::device::DeviceHealthState
+  int32_t ULDeviceHealth() const;
   /// @brief Open device com interface
   int32_t OpenDeviceCom(int32_t device_type);
   /// @brief Close all device com interface
   void CloseDeviceCom(int32_t device_type);
+  /// @brief Start sampling the static load device connected
+  void StartStaticLoadSampling();
+  /// @brief Stop sampling the static load device, the keep load is stopped
+  void StopStaticLoadSampling();
+  /// @brief Start keeping the load of the settings on the control thread
+  /// @return 0 if success, -1 if the static load is not sampling, -2 if the
+  /// settings are invalid
+  int32_t StartKeepLoad(const anx::device::DeviceLoadStatic& settings);
+  /// @brief Stop keeping the load, the actuator is stopped
+  void StopKeepLoad();
+  /// @brief Get the state of the keep load, kKeepLoadIdle if not started
+  anx::device::stload::KeepLoadState KeepLoadState();
+  /// @brief Run the command of the static load through the actuator, the
+  /// dll calls are serialized with the sampling and the keep load threads.
+  /// @return 0 if success, negative if failed
+  int32_t CarryStaticLoad(const anx::device::stload::StaticLoadCommand& command);
+  /// @brief Stop the command of the static load through the actuator
+  void StopStaticLoadRun();
+  /// @brief Zero the readings of the static load through the actuator
+  void TareStaticLoad();
   /// @brief exp_state get
   int32_t ExpState() const { return is_exp_state_; }
+  /// @brief the bus of the samples of the ultrasonic and the static load,
+  /// the sources are kSampleSourceUltrasonic and kSampleSourceStaticLoad.
+  anx::device::SampleBus* sample_bus() { return sample_bus_.get(); }
+  /// @brief Poll the ultrasonic generator on the thread of the station, the
+  /// readouts are published to the bus and kept for GetUltraReadout.
+  /// @param interval_ms the poll interval, the poll is retimed if running
+  void StartUltraPolling(int32_t interval_ms);
+  /// @brief Stop the poll, the poll running is waited
+  void StopUltraPolling();
+  /// @brief Get the latest readout of the poll
+  /// @return true if any readout is polled
+  bool GetUltraReadout(UltraReadout* readout);
+  /// @brief Get the latest sample of the static load device, the pages read
+  /// it on enmsg_type_stload_value_cur.
+  /// @return true if any sample is read
+  bool GetStaticLoadSample(anx::device::stload::StaticLoadSample* sample);
  protected:
   // impliment anx::device::DeviceComListener;
   void OnDataReceived(anx::device::DeviceComInterface* device,
@@ -164,6 +232,24 @@ class WorkWindow : public DuiLib::WindowImplBase,
     }
   }
 
+  // impliment anx::device::stload::StaticLoadListener
+  void OnStaticLoadSamples(anx::device::stload::StaticLoadDevice* device,
+                           const anx::device::stload::StaticLoadSample* samples,
+                           size_t count) override;
+
+  // impliment anx::device::stload::KeepLoadListener
+  void OnKeepLoadStateChanged(
+      anx::device::stload::KeepLoadController* controller,
+      const anx::device::stload::KeepLoadStatus& status) override;
+
+  // impliment anx::device::DeviceWatchdogListener
+  void OnDeviceHealthEvent(
+      anx::device::DeviceWatchdog* watchdog,
+      const anx::device::DeviceHealthEvent& event) override;
+
+  // impliment anx::device::StationTask
+  void OnStationTask(anx::device::Station* station, int64_t now_ms) override;
+
   // impliment anx::ui::UIExpStateBase
   void UpdateExpError(int32_t code, const std::string& msg) override;
 
@@ -200,6 +286,29 @@ class WorkWindow : public DuiLib::WindowImplBase,
   std::unique_ptr<anx::device::UltraDevice> ultra_device_;
   bool is_device_ultra_connected_ = false;
   bool is_device_stload_connected_ = false;
+  /// @brief probes ultra_device_, stopped before it
+  std::unique_ptr<anx::device::DeviceWatchdog> device_watchdog_;
+  int32_t ultra_watchdog_id_ = -1;
+  /// @brief the events of the watchdog thread for DEVICE_HEALTH_MSG
+  anx::common::Mutex device_health_mutex_;
+  std::vector<anx::device::DeviceHealthEvent> device_health_events_;
+  /// @brief outlives the devices publishing to it
+  std::unique_ptr<anx::device::SampleBus> sample_bus_;
+  /// @brief the rig of the window is the station 0, the blocking reads of
+  /// the ultrasonic port run on its thread and not on the window.
+  std::unique_ptr<anx::device::StationManager> station_manager_;
+  std::shared_ptr<anx::device::Station> station_;
+  /// @brief the interval of the poll, 0 if stopped
+  int32_t ultra_poll_interval_ms_ = 0;
+  anx::common::LatestValue<UltraReadout> ultra_readout_;
+  std::unique_ptr<anx::device::stload::StaticLoadDevice> static_load_device_;
+  /// @brief the actuator of static_load_device_
+  anx::device::stload::StaticLoadActuator* static_load_actuator_ = nullptr;
+  std::unique_ptr<anx::device::stload::KeepLoadController>
+      keep_load_controller_;
+  /// @brief the sample message is posted and not handled, the samples of the
+  /// sampling thread are coalesced into one message.
+  std::atomic<bool> static_load_sample_posted_{false};
   /// @brief experiment related data
   /// @brief exp status
   /// 0 - stop, 1 - start, 2 - pause, <0 - unvalid
@@ -40,8 +40,9 @@ namespace ui {
 typedef enum ENMsgType {
   enmsg_type_stload_max,
   /// @brief stload current value message
-  /// @details the message is used to update the stload current value
-  /// @see anx::device::stload::STResult
+  /// @details the message is used to update the stload current value, the
+  /// ptr_ is null, the value is read by WorkWindow::GetStaticLoadSample.
+  /// @see anx::device::stload::StaticLoadSample
   enmsg_type_stload_value_cur,
   /// @brief exp stress amplitude message
   /// @details the message is used to update the exp stress amplitude
@@ -49,6 +50,12 @@ typedef enum ENMsgType {
   enmsg_type_exp_stress_amp,
   /// @brief exp stress error message
   enmsg_type_exp_error,
+  /// @brief device health message of the watchdog
+  /// @see anx::device::DeviceHealthEvent
+  enmsg_type_device_health,
+  /// @brief docx report message of the report generator
+  /// @see anx::ui::ENMsgDocxReport
+  enmsg_type_docx_report,
 } ENMsgType;
 
 /// @brief message struct
@@ -61,6 +68,16 @@ typedef struct ENMsgStruct {
   void* ptr_;
 } ENMsgStruct;
 
+/// @brief the progress or the result of the docx report
+typedef struct ENMsgDocxReport {
+  /// @brief the report finished, the result_ is valid
+  bool finished_;
+  /// @brief the progress 0 - 100
+  int32_t percent_;
+  /// @brief the result of anx::expdata::DocxReportGenerator::Generate
+  int32_t result_;
+} ENMsgDocxReport;
+
 }  // namespace ui
 }  // namespace anx
 
@@ -11,6 +11,7 @@
 
 #include "app/ui/work_window_tab_main_second_page.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #undef max
@@ -25,6 +26,7 @@
 #include "app/common/num_string_convert.hpp"
 #include "app/common/string_utils.h"
 #include "app/common/time_utils.h"
+#include "app/db/database_cursor.h"
 #include "app/db/database_helper.h"
 #include "app/device/device_com_factory.h"
 #include "app/device/device_com_settings.h"
@@ -37,6 +39,9 @@
 #include "app/device/ultrasonic/ultra_helper.h"
 #include "app/esolution/solution_design.h"
 #include "app/esolution/solution_design_default.h"
+#include "app/common/file_utils.h"
+#include "app/expdata/experiment_archive.h"
+#include "app/expdata/experiment_journal.h"
 #include "app/ui/dialog_amplitude_calibration_settings.h"
 #include "app/ui/dialog_common.h"
 #include "app/ui/dialog_static_load_guaranteed_settings.h"
@@ -59,11 +64,23 @@ namespace ui {
 namespace {
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief sampling interval 100ms
-/// @note 10Hz sampling frequency
-/// @details 1000ms / 100ms = 10Hz sampling frequency
+/// @brief the interval of the sampling timer 100ms, the rows are stored on
+/// its grid with the latest readout polled.
+/// @note 10Hz sampling frequency at least
 const int32_t kSamplingInterval = 100;
 
+/// @brief the poll interval of the flat frequency, the unstable frequency is
+/// polled down to the floor of the line budget.
+const int32_t kPollMaxInterval = 1000;
+
+/// @brief the sampling is fast for the time after the start and the clip
+/// transitions
+const int64_t kSamplingBoostMs = 3000;
+
+/// @brief the bytes on the line of one sampling, the requests and the
+/// responses of the frequency and the power
+const int32_t kSamplingBytes = 2 * (8 + 7);
+
 /// @brief timer id for sampling
 /// @note 1
 const int32_t kTimerIdSampling = 1;
@@ -74,6 +91,13 @@ const int32_t kTimerIdRefresh = 2;
 
 /// @brief exp clip max count 10^18
 const int64_t kExpClipMaxCount = 1000000000000000000LL;
+
+/// @brief the failed reads of the ultra device wait the watchdog at most the
+/// grace time, then the exp is stopped.
+const int64_t kULReadFailedGraceMs = 1000;
+
+/// @brief the interval of the backups of the exp database kept in memory
+const int32_t kExpDataBaseBackupIntervalMs = 10000;
 }  // namespace
 
 WorkWindowSecondPage::WorkWindowSecondPage(
@@ -167,10 +191,53 @@ void WorkWindowSecondPage::OnClick(TNotifyUI& msg) {
 void WorkWindowSecondPage::OnTimer(TNotifyUI& msg) {
   uint32_t id_timer = msg.wParam;
   if (id_timer == kTimerIdSampling) {
+    if (is_exp_state_ > kExpStateStop) {
+      /// the state of the tick before, the counters follow the data received
+      WriteExpCheckpoint();
+    }
     if (is_exp_state_ != kExpStateUnvalid) {
       if (ultra_device_) {
-        cur_freq_ = ultra_device_->GetCurrentFreq();
-        cur_power_ = ultra_device_->GetCurrentPower();
+        /// the watchdog reconnects the device, the reads wait for it
+        if (pWorkWindow_->ULDeviceHealth() >= anx::device::kDeviceHealthLost) {
+          return;
+        }
+        /// the station polls the device, the tick takes the latest readout
+        UltraReadout readout;
+        if (!pWorkWindow_->GetUltraReadout(&readout)) {
+          return;
+        }
+        cur_freq_ = readout.freq;
+        cur_power_ = readout.power;
+        /// the readout of a hung read is stale, it fails as the reads
+        if (anx::common::GetCurrentTimeMillis() - readout.time_ms >
+            std::max<int64_t>(kULReadFailedGraceMs,
+                              2 * sampling_interval_ms_)) {
+          cur_freq_ = -1;
+          cur_power_ = -1;
+        }
+        if (cur_freq_ >= 0 && cur_power_ >= 0) {
+          /// the poller takes each readout once
+          if (readout.time_ms != sampling_readout_ms_) {
+            sampling_readout_ms_ = readout.time_ms;
+            UpdateSamplingInterval(readout.time_ms);
+          }
+          StoreExpData();
+        }
+        if (cur_freq_ < 0 || cur_power_ < 0) {
+          /// the watchdog probing the device reports the loss, the failed
+          /// reads stop the exp only if it does not in the grace time.
+          int64_t now_ms = anx::common::GetCurrentTimeMillis();
+          if (ul_read_failed_ms_ == 0) {
+            ul_read_failed_ms_ = now_ms;
+          }
+          if (pWorkWindow_->ULDeviceHealth() !=
+                  anx::device::kDeviceHealthIdle &&
+              now_ms - ul_read_failed_ms_ < kULReadFailedGraceMs) {
+            return;
+          }
+        } else {
+          ul_read_failed_ms_ = 0;
+        }
         if (exp_pause_stop_reason_ == kExpPauseStopReasonNone &&
             (cur_freq_ < 0 || cur_power_ < 0)) {
           LOG_F(LG_ERROR) << "exp_stop: cur_freq:" << cur_freq_
@@ -255,6 +322,7 @@ void WorkWindowSecondPage::OnTimer(TNotifyUI& msg) {
               // pause ultrasound
               LOG_F(LG_INFO) << "pause ultrasound";
               ultra_device_->StopUltra();
+              ultra_poller_->Boost(current_time_ms + kSamplingBoostMs);
               pre_total_data_table_no_ = exp_data_list_info_.exp_data_table_no_;
               pre_total_cycle_count_ = cur_total_cycle_count_;
               LOG_F(LG_INFO)
@@ -282,6 +350,7 @@ void WorkWindowSecondPage::OnTimer(TNotifyUI& msg) {
                 is_exp_state_ = kExpStateStop;
                 return;
               }
+              ultra_poller_->Boost(current_time_ms + kSamplingBoostMs);
               state_ultrasound_exp_clip_ = 1;
             }
           }
@@ -304,8 +373,14 @@ void WorkWindowSecondPage::OnValueChanged(TNotifyUI& msg) {
         return;
       }
       if (enmsg->type_ == enmsg_type_stload_value_cur) {
-        anx::device::stload::STResult* st_result =
-            reinterpret_cast<anx::device::stload::STResult*>(enmsg->ptr_);
+        anx::device::stload::StaticLoadSample sample;
+        if (!pWorkWindow_->GetStaticLoadSample(&sample)) {
+          return;
+        }
+        anx::device::stload::STResult st_result;
+        st_result.load_ = sample.load;
+        st_result.pos_ = sample.position;
+        st_result.status_ = sample.status;
         if (st_load_is_running_ == false) {
           return;
         }
@@ -314,16 +389,31 @@ void WorkWindowSecondPage::OnValueChanged(TNotifyUI& msg) {
         if (st_load_event_from_ == kSTLoadEventFromButtonUpDown) {
           return;
         }
-        LOG_F(LG_INFO) << "st_result->status_:" << st_result->status_ << " "
-                       << "st_result->load_:" << st_result->load_ << " "
-                       << "st_result->position_:" << st_result->pos_ << " "
+        /// @note the keep load of the load control runs on the control thread
+        /// of the work window, stop the action when it ends.
+        if (st_load_event_from_ == kSTLoadEventFromKeepLoadButton &&
+            lss_->ctrl_type_ == CTRL_LOAD) {
+          anx::device::stload::KeepLoadState state =
+              pWorkWindow_->KeepLoadState();
+          if (state == anx::device::stload::kKeepLoadDone ||
+              state == anx::device::stload::kKeepLoadFault ||
+              state == anx::device::stload::kKeepLoadStopped) {
+            LOG_F(LG_INFO) << "static load keep load end, state:" << state;
+            OnButtonStaticAircraftStop();
+          }
+          st_load_result_ = st_result;
+          return;
+        }
+        LOG_F(LG_INFO) << "st_result->status_:" << st_result.status_ << " "
+                       << "st_result->load_:" << st_result.load_ << " "
+                       << "st_result->position_:" << st_result.pos_ << " "
                        << "lss->threshold_:" << lss_->threshold_ << " "
                        << "lss_->retention_:" << lss_->retention_ << " "
                        << "lss_->direct_:" << lss_->direct_ << " "
                        << "lss_->speed_:" << lss_->speed_;
-        if ((st_result->status_ & DSP_CMDEND) == DSP_CMDEND) {
+        if ((st_result.status_ & DSP_CMDEND) == DSP_CMDEND) {
           LOG_F(LG_INFO) << "static load aircraft achieve the target load:"
-                         << st_result->load_;
+                         << st_result.load_;
           if (st_posi_reach_first_time_ == 0) {
             st_posi_reach_first_time_ = anx::common::GetCurrentTimeMillis();
           } else {
@@ -343,64 +433,8 @@ void WorkWindowSecondPage::OnValueChanged(TNotifyUI& msg) {
           }
         } else {
           st_posi_reach_first_time_ = 0;
-          if (st_ctrl_type_of_keep_load_current_ == CTRL_POSI) {
-            /// @note static load aircraft reach the target value for 1000
-            /// ms then stop the action.
-            LOG_F(LG_INFO) << "static load aircraft reach the target position"
-                           << " then for target load value to reach and keep";
-            float target_load_threshold = lss_->threshold_;
-            float st_result_load = fabsf(static_cast<float>(st_result->load_));
-            float bl = st_result_load / target_load_threshold;
-            if (bl >= 0.8f) {
-              LOG_F(LG_INFO) << "static load aircraft reach the target load:"
-                             << st_result->load_ << " "
-                             << "target load:" << target_load_threshold << " "
-                             << "bl:" << bl;
-              if (lss_->direct_ == 1) {
-                if (!StaticAircraftDoMoveUp()) {
-                  LOG_F(LG_ERROR) << "StaticAircraftDoMoveUp error";
-                  st_load_event_from_ = kSTLoadEventNone;
-                }
-              } else {
-                if (!StaticAircraftDoMoveDown()) {
-                  LOG_F(LG_ERROR) << "StaticAircraftDoMoveDown error";
-                  st_load_event_from_ = kSTLoadEventNone;
-                }
-              }
-            }
-          } else if (st_ctrl_type_of_keep_load_current_ == CTRL_LOAD) {
-            /// @note static load aircraft reach the target value for 1000
-            /// ms then stop the action.
-            int64_t current_time = anx::common::GetCurrentTimeMillis();
-            int64_t cur_duration =
-                current_time - st_ctrl_type_of_keep_load_current_start_time_;
-            if (cur_duration > 200) {
-              LOG_F(LG_INFO) << "static load aircraft send keep load time:"
-                             << lss_->keep_load_duration_ << " "
-                             << "target keep load:" << lss_->retention_;
-              int32_t version =
-                  anx::device::stload::STLoadHelper::STLoadVersion();
-              int32_t ctrl_type = CTRL_LOAD;
-              int32_t endtype = END_TIME_V2;
-              if (version == 1) {
-                endtype = END_TIME;
-              }
-
-              float speed = lss_->speed_ * 1.0f;
-              float end_value = lss_->keep_load_duration_ * 1.0f;
-              bool bSuccess =
-                  anx::device::stload::STLoadHelper::st_load_loader_.st_api_
-                      .carry_200(ctrl_type, endtype, speed, end_value, 0, false,
-                                 DIR_NO, 0, 1, 0);
-              if (!bSuccess) {
-                LOG_F(LG_ERROR) << "carry_200 error";
-              }
-              st_ctrl_type_of_keep_load_current_ = -1;
-              st_ctrl_type_of_keep_load_current_start_time_ = 0;
-            }
-          }
         }
-        st_load_result_ = *st_result;
+        st_load_result_ = st_result;
       } else if (enmsg->type_ == enmsg_type_exp_stress_amp) {
         anx::esolution::SolutionDesign* design =
             reinterpret_cast<anx::esolution::SolutionDesign*>(enmsg->ptr_);
@@ -434,12 +468,22 @@ void WorkWindowSecondPage::OnValueChanged(TNotifyUI& msg) {
         exp_amplitude_ = exp_amplitude;
         exp_statc_load_mpa_ = exp_statc_load_mpa;
         st_load_result_.load_ = exp_statc_load_mpa_;
+        std::unique_ptr<anx::device::DeviceLoadStaticSettings> lss =
+            anx::device::LoadDeviceLoadStaticSettingsDefaultResource();
+        exp_statc_load_n_ = (lss != nullptr) ? lss->retention_ : 0;
         if (work_window_second_page_graph_notify_pump_ != nullptr) {
           work_window_second_page_graph_notify_pump_->NotifyPump(msg);
         }
         if (work_window_second_page_data_notify_pump_ != nullptr) {
           work_window_second_page_data_notify_pump_->NotifyPump(msg);
         }
+      } else if (enmsg->type_ == enmsg_type_device_health) {
+        OnDeviceHealthEvent(
+            *reinterpret_cast<anx::device::DeviceHealthEvent*>(enmsg->ptr_));
+      } else if (enmsg->type_ == enmsg_type_docx_report) {
+        if (work_window_second_page_data_notify_pump_ != nullptr) {
+          work_window_second_page_data_notify_pump_->NotifyPump(msg);
+        }
       }
     } else if (msg.pSender->GetName() == _T("args_area_value_amplitude")) {
       if (msg.wParam == PBT_APMQUERYSUSPEND) {
@@ -677,6 +721,8 @@ void WorkWindowSecondPage::Bind() {
   UpdateExpClipTimeFromControl();
 
   RefreshExpClipTimeControl(true);
+
+  OpenExpJournal();
 }
 
 void WorkWindowSecondPage::Unbind() {
@@ -700,6 +746,9 @@ void WorkWindowSecondPage::Unbind() {
 
   /// @brief kill the timer
   paint_manager_ui_->KillTimer(btn_exp_start_, kTimerIdSampling);
+  pWorkWindow_->StopUltraPolling();
+  pWorkWindow_->device_watchdog_->SetPollInterval(
+      pWorkWindow_->ultra_watchdog_id_, 0);
   paint_manager_ui_->KillTimer(btn_exp_start_, kTimerIdRefresh);
 
   /// @note stop ultra_device
@@ -713,12 +762,31 @@ void WorkWindowSecondPage::Unbind() {
   }
 
   /// @note stop stload device
-  anx::device::stload::STLoadHelper::st_load_loader_.st_api_.stop_run();
+  pWorkWindow_->StopStaticLoadRun();
   /// direct to the settings of the static load
   /// and save it to the resource file
   lss_ = std::move(anx::device::LoadDeviceLoadStaticSettingsDefaultResource());
   lss_->direct_ = 0;
   anx::device::SaveDeviceLoadStaticSettingsDefaultResource(*lss_);
+  /// @brief finish the exp database and switch back to the default database
+  if (!exp_db_name_.empty()) {
+    anx::db::helper::FinishExperimentDataBase(
+        exp_db_name_, anx::common::GetCurrentEpochMillis());
+    exp_db_name_.clear();
+  }
+  ArchiveFinishedExpDataBase();
+  anx::db::helper::ResetCurrentExperimentDataBase();
+  /// @note the checkpoint of the run closed is of the state stopped, it is
+  /// not restored on the next start.
+  if (exp_journal_ != nullptr) {
+    if (is_exp_state_ > kExpStateStop) {
+      is_exp_state_ = kExpStateStop;
+      WriteExpCheckpoint();
+    }
+    exp_journal_->Close();
+    exp_journal_.reset();
+  }
+  pending_checkpoint_.reset();
   /// @brief drop the exp_data table
   anx::db::helper::DropDataTable(anx::db::helper::kDefaultDatabasePathname,
                                  anx::db::helper::kTableExpDataGraph);
@@ -740,8 +808,6 @@ void WorkWindowSecondPage::OnButtonStaticAircraftUp() {
     return;
   }
   st_load_is_running_ = true;
-  st_ctrl_type_of_keep_load_current_ = -1;
-  st_ctrl_type_of_keep_load_current_start_time_ = 0;
   /// update the releated button state
   btn_sa_keep_load_->SetEnabled(false);
   btn_sa_up_->SetEnabled(false);
@@ -765,8 +831,6 @@ void WorkWindowSecondPage::OnButtonStaticAircraftDown() {
     return;
   }
   st_load_is_running_ = true;
-  st_ctrl_type_of_keep_load_current_ = -1;
-  st_ctrl_type_of_keep_load_current_start_time_ = 0;
 
   /// update the releated button state
   btn_sa_keep_load_->SetEnabled(false);
@@ -796,18 +860,8 @@ void WorkWindowSecondPage::OnButtonStaticAircraftClear() {
     return;
   }
   LOG_F(LG_INFO) << "clear the data";
-  if (anx::device::stload::STLoadHelper::st_load_loader_.st_api_.tare_ext1) {
-    anx::device::stload::STLoadHelper::st_load_loader_.st_api_.tare_ext1();
-  }
-  if (anx::device::stload::STLoadHelper::st_load_loader_.st_api_.tare_posi) {
-    anx::device::stload::STLoadHelper::st_load_loader_.st_api_.tare_posi();
-  }
-  if (anx::device::stload::STLoadHelper::st_load_loader_.st_api_.tare_load) {
-    anx::device::stload::STLoadHelper::st_load_loader_.st_api_.tare_load();
-  }
-  if (anx::device::stload::STLoadHelper::st_load_loader_.st_api_.tare_time) {
-    anx::device::stload::STLoadHelper::st_load_loader_.st_api_.tare_time();
-  }
+  /// @note the dll calls are serialized with the sampling thread
+  pWorkWindow_->TareStaticLoad();
 }
 
 void WorkWindowSecondPage::OnButtonStaticAircraftKeepLoad() {
@@ -832,8 +886,13 @@ void WorkWindowSecondPage::OnButtonStaticAircraftKeepLoad() {
   // StaticAircraftStop();
   /// @brief static aircraft keep load.
   st_load_event_from_ = kSTLoadEventFromKeepLoadButton;
-  st_ctrl_type_of_keep_load_current_ = -1;
-  if (lss_->direct_ == 1) {
+  if (lss_->ctrl_type_ == CTRL_LOAD) {
+    if (pWorkWindow_->StartKeepLoad(*lss_) != 0) {
+      LOG_F(LG_ERROR) << "StartKeepLoad error";
+      st_load_event_from_ = kSTLoadEventNone;
+      return;
+    }
+  } else if (lss_->direct_ == 1) {
     if (!StaticAircraftDoMoveUp()) {
       LOG_F(LG_ERROR) << "StaticAircraftDoMoveUp error";
       st_load_event_from_ = kSTLoadEventNone;
@@ -858,19 +917,15 @@ void WorkWindowSecondPage::OnButtonStaticAircraftKeepLoad() {
 void WorkWindowSecondPage::OnButtonExpReset() {
   // reset the data
   this->pWorkWindow_->ClearArgsFreqNum();
-  // drop the exp_data table
-  anx::db::helper::DropDataTable(anx::db::helper::kDefaultDatabasePathname,
+  // drop the exp_data table of the current exp database
+  std::string exp_db_name = anx::db::helper::CurrentExperimentDataBase();
+  anx::db::helper::DropDataTable(exp_db_name,
                                  anx::db::helper::kTableExpDataGraph);
-  anx::db::helper::DropDataTable(anx::db::helper::kDefaultDatabasePathname,
+  anx::db::helper::DropDataTable(exp_db_name,
                                  anx::db::helper::kTableExpDataList);
 
-  // create the exp_data_graph table
-  std::string db_filepathname;
-  anx::db::helper::DefaultDatabasePathname(&db_filepathname);
-  auto db = anx::db::DatabaseFactory::Instance()->CreateOrGetDatabase(
-      db_filepathname);
-  db->Execute(anx::db::helper::sql::kCreateTableExpDataGraphSqlFormat);
-  db->Execute(anx::db::helper::sql::kCreateTableExpDataListSqlFormat);
+  // create the exp_data_graph and exp_data_list table
+  anx::db::helper::CreateExperimentDataTables(exp_db_name);
 
   /// @brief get the exp data sample settings and set the exp start time
   /// and exp sample interval
@@ -892,6 +947,10 @@ void WorkWindowSecondPage::OnButtonExpReset() {
   pre_exp_start_time_ms_ = 0;
   pre_total_cycle_count_ = 0;
   pre_total_data_table_no_ = 0;
+  /// the graph of the paused exp starts again on resume
+  exp_paused_time_ms_ = (is_exp_state_ == kExpStatePause)
+                            ? exp_data_graph_info_.exp_start_time_ms_
+                            : 0;
 
   if (is_exp_state_ == kExpStatePause) {
     btn_exp_resume_->SetEnabled(true);
@@ -989,6 +1048,306 @@ bool WorkWindowSecondPage::OnBtnResetExpClipSetting(void* params) {
   return false;
 }
 
+void WorkWindowSecondPage::OnDeviceHealthEvent(
+    const anx::device::DeviceHealthEvent& event) {
+  if (event.device != pWorkWindow_->ultra_watchdog_id_) {
+    return;
+  }
+  if (event.type == anx::device::kDeviceHealthEventLost) {
+    /// the watchdog reconnects at once, the run goes on if it recovers
+    LOG_F(LG_WARN) << "device lost, silence_ms:" << event.silence_ms;
+  } else if (event.type ==
+             anx::device::kDeviceHealthEventReconnectAttempt) {
+    /// the run is paused until the watchdog reconnects the device
+    if (is_exp_state_ == kExpStateStart &&
+        exp_pause_stop_reason_ == kExpPauseStopReasonNone) {
+      LOG_F(LG_WARN) << "exp_pause: device reconnect failed, attempts:"
+                     << event.attempts << " silence_ms:" << event.silence_ms;
+      exp_pause_stop_reason_ = kExpPauseStopReasonDeviceLost;
+      exp_pause();
+    }
+  } else if (event.type == anx::device::kDeviceHealthEventRecovered) {
+    if (is_exp_state_ == kExpStatePause &&
+        exp_pause_stop_reason_ == kExpPauseStopReasonDeviceLost) {
+      LOG_F(LG_INFO) << "exp_resume: device recovered, reconnected:"
+                     << event.reconnected;
+      exp_pause_stop_reason_ = kExpPauseStopReasonNone;
+      exp_resume();
+    }
+  } else if (event.type == anx::device::kDeviceHealthEventReconnectFailed) {
+    if (exp_pause_stop_reason_ == kExpPauseStopReasonDeviceLost ||
+        (is_exp_state_ == kExpStateStart &&
+         exp_pause_stop_reason_ == kExpPauseStopReasonNone)) {
+      LOG_F(LG_ERROR) << "exp_stop: device reconnect failed, attempts:"
+                      << event.attempts;
+      exp_pause_stop_reason_ = kExpPauseStopReasonUnkown;
+      exp_stop();
+      anx::ui::DialogCommon::ShowDialog(
+          *pWorkWindow_, "提示", "设备连接中断,重连失败,请检查硬件连接",
+          anx::ui::DialogCommon::kDialogCommonStyleOk);
+    }
+  }
+  CheckDeviceComConnectedStatus();
+}
+
+void WorkWindowSecondPage::StartSampling() {
+  anx::device::AdaptivePollerOptions options;
+  /// the rows hold the latest readout on the grid of the sampling timer, the
+  /// flat frequency is polled slower than the rows are stored.
+  options.max_interval_ms = kPollMaxInterval;
+  options.bytes_per_poll = kSamplingBytes;
+  int32_t baud_rate = ultra_device_->GetBaudRate();
+  if (baud_rate > 0) {
+    options.baud_rate = baud_rate;
+  }
+  options.limit = dus_.exp_frequency_fluctuations_range_;
+  ultra_poller_.reset(new anx::device::AdaptivePoller(options));
+  ultra_poller_->Reset(initial_frequency_);
+  ultra_poller_->Boost(anx::common::GetCurrentTimeMillis() + kSamplingBoostMs);
+  sampling_interval_ms_ = ultra_poller_->floor_interval_ms();
+  sampling_readout_ms_ = 0;
+  LOG_F(LG_INFO) << "poll interval:" << sampling_interval_ms_
+                 << " baud_rate:" << options.baud_rate;
+  paint_manager_ui_->SetTimer(btn_exp_start_, kTimerIdSampling,
+                              kSamplingInterval);
+  pWorkWindow_->StartUltraPolling(sampling_interval_ms_);
+  /// the sampling reads are the heartbeats of the device
+  pWorkWindow_->device_watchdog_->SetPollInterval(
+      pWorkWindow_->ultra_watchdog_id_, options.max_interval_ms);
+}
+
+void WorkWindowSecondPage::UpdateSamplingInterval(int64_t now_ms) {
+  if (ultra_poller_ == nullptr) {
+    return;
+  }
+  int32_t interval_ms = ultra_poller_->Update(
+      now_ms, static_cast<double>(cur_freq_), NextSamplingDeadlineMs(now_ms));
+  if (interval_ms == sampling_interval_ms_) {
+    return;
+  }
+  LOG_F(LG_SENSITIVE) << "poll interval:" << interval_ms
+                      << " urgency:" << ultra_poller_->urgency();
+  sampling_interval_ms_ = interval_ms;
+  pWorkWindow_->StartUltraPolling(interval_ms);
+}
+
+int64_t WorkWindowSecondPage::NextSamplingDeadlineMs(int64_t now_ms) const {
+  int64_t deadline_ms = 0;
+  int64_t start_ms = exp_data_graph_info_.exp_start_time_ms_;
+  if (dedss_ != nullptr && dedss_->sampling_start_pos_ > 0 &&
+      !start_time_pos_has_deal_) {
+    deadline_ms = start_ms + dedss_->sampling_start_pos_ * 100;
+  }
+  if (dus_.exp_clipping_enable_ == 1 && dus_.exp_clip_time_duration_ > 0 &&
+      now_ms >= start_ms) {
+    int64_t duration_ms = dus_.exp_clip_time_duration_ * 100;
+    int64_t total_ms = duration_ms + dus_.exp_clip_time_paused_ * 100;
+    int64_t time = (now_ms - start_ms) % total_ms;
+    int64_t transition_ms =
+        now_ms + (time < duration_ms ? duration_ms - time : total_ms - time);
+    if (deadline_ms <= now_ms || transition_ms < deadline_ms) {
+      deadline_ms = transition_ms;
+    }
+  }
+  return deadline_ms;
+}
+
+void WorkWindowSecondPage::OpenExpJournal() {
+  std::string journal_pathname;
+  if (anx::db::helper::DatabasePathname(
+          std::string(anx::db::helper::kExperimentDatabaseFolder) +
+              anx::common::kPathSeparator +
+              anx::expdata::kExperimentJournalFileName,
+          &journal_pathname) != 0) {
+    return;
+  }
+  anx::common::MakeSureFolderPathExist(journal_pathname);
+  exp_journal_.reset(new anx::expdata::ExperimentJournal());
+  if (exp_journal_->Open(journal_pathname) != 0) {
+    LOG_F(LG_WARN) << "Failed to open exp journal: " << journal_pathname;
+    exp_journal_.reset();
+    return;
+  }
+  /// @note the last record of the run stopped is of the state stop, the
+  /// run interrupted leaves the state start or pause.
+  anx::expdata::ExperimentCheckpoint checkpoint;
+  if (exp_journal_->last_checkpoint(&checkpoint) &&
+      (checkpoint.exp_state_ == kExpStateStart ||
+       checkpoint.exp_state_ == kExpStatePause)) {
+    LOG_F(LG_WARN) << "interrupted exp run: "
+                   << checkpoint.exp_db_start_time_ms_
+                   << " cur_total_cycle_count:"
+                   << checkpoint.cur_total_cycle_count_;
+    pending_checkpoint_.reset(
+        new anx::expdata::ExperimentCheckpoint(checkpoint));
+  }
+}
+
+void WorkWindowSecondPage::ArchiveFinishedExpDataBase() {
+  /// @note the finished exp database is read by the data pages until it's
+  /// not the current one, then the database file is replaced by the archive.
+  std::string db_name = anx::db::helper::CurrentExperimentDataBase();
+  if (db_name == anx::db::helper::kDefaultDatabasePathname) {
+    return;
+  }
+  anx::expdata::ExperimentArchiver::Instance()->Post(db_name, true);
+}
+
+void WorkWindowSecondPage::WriteExpCheckpoint() {
+  if (exp_journal_ == nullptr) {
+    return;
+  }
+  anx::expdata::ExperimentCheckpoint checkpoint;
+  checkpoint.time_ms_ = anx::common::GetCurrentTimeMillis();
+  checkpoint.exp_state_ = is_exp_state_;
+  checkpoint.clip_state_ = state_ultrasound_exp_clip_;
+  checkpoint.exp_db_start_time_ms_ = exp_db_start_time_ms_;
+  checkpoint.initial_frequency_ = initial_frequency_;
+  checkpoint.initial_power_ = initial_power_;
+  checkpoint.cur_total_cycle_count_ = cur_total_cycle_count_;
+  checkpoint.pre_total_cycle_count_ = pre_total_cycle_count_;
+  checkpoint.pre_total_data_table_no_ = pre_total_data_table_no_;
+  checkpoint.pre_exp_start_offset_ms_ =
+      anx::expdata::ExperimentCheckpoint::OffsetOf(pre_exp_start_time_ms_,
+                                                   checkpoint.time_ms_);
+  checkpoint.pre_clip_paused_ms_ = pre_clip_paused_ms_;
+  checkpoint.exp_data_pre_duration_exponential_ =
+      exp_data_pre_duration_exponential_;
+  checkpoint.start_time_pos_has_deal_ = start_time_pos_has_deal_;
+  checkpoint.graph_start_offset_ms_ =
+      anx::expdata::ExperimentCheckpoint::OffsetOf(
+          exp_data_graph_info_.exp_start_time_ms_, checkpoint.time_ms_);
+  checkpoint.graph_time_interval_num_ =
+      exp_data_graph_info_.exp_time_interval_num_;
+  checkpoint.graph_data_table_no_ = exp_data_graph_info_.exp_data_table_no_;
+  checkpoint.list_start_offset_ms_ =
+      anx::expdata::ExperimentCheckpoint::OffsetOf(
+          exp_data_list_info_.exp_start_time_ms_, checkpoint.time_ms_);
+  checkpoint.list_time_interval_num_ =
+      exp_data_list_info_.exp_time_interval_num_;
+  checkpoint.list_pre_sample_offset_ms_ =
+      anx::expdata::ExperimentCheckpoint::OffsetOf(
+          exp_data_list_info_.exp_pre_sample_timestamp_ms_,
+          checkpoint.time_ms_);
+  checkpoint.list_freq_total_count_ = exp_data_list_info_.exp_freq_total_count_;
+  checkpoint.list_data_table_no_ = exp_data_list_info_.exp_data_table_no_;
+  checkpoint.paused_offset_ms_ = anx::expdata::ExperimentCheckpoint::OffsetOf(
+      exp_paused_time_ms_, checkpoint.time_ms_);
+  if (exp_journal_->Append(checkpoint) != 0) {
+    LOG_F(LG_WARN) << "Failed to write exp checkpoint";
+  }
+}
+
+bool WorkWindowSecondPage::RestoreExpCheckpoint(
+    const anx::expdata::ExperimentCheckpoint& checkpoint) {
+  /// @note the rows of the exp database after its last backup are lost
+  /// with the crash, the row numbers are clamped to the rows on the disk.
+  if (anx::db::helper::OpenExperimentDataBase(
+          anx::db::helper::kExperimentDatabaseFolder,
+          checkpoint.exp_db_start_time_ms_, &exp_db_name_) != 0) {
+    LOG_F(LG_WARN) << "OpenExperimentDataBase failed: "
+                   << checkpoint.exp_db_start_time_ms_;
+    return false;
+  }
+  if (!anx::db::helper::MirrorExperimentDataBase(
+          exp_db_name_, kExpDataBaseBackupIntervalMs)) {
+    LOG_F(LG_WARN) << "MirrorExperimentDataBase failed: " << exp_db_name_;
+  }
+  exp_db_start_time_ms_ = checkpoint.exp_db_start_time_ms_;
+  /// @note the clock of the run starts again after a reboot, the times of
+  /// the run are re-based on the clock now, the run goes on from the time of
+  /// the checkpoint.
+  int64_t now_ms = anx::common::GetCurrentTimeMillis();
+  exp_paused_time_ms_ = anx::expdata::ExperimentCheckpoint::TimeOf(
+      checkpoint.paused_offset_ms_, now_ms);
+  if (exp_paused_time_ms_ <= 0) {
+    exp_paused_time_ms_ = now_ms;
+  }
+  cur_freq_ = initial_frequency_ = checkpoint.initial_frequency_;
+  cur_power_ = initial_power_ = checkpoint.initial_power_;
+  /// the run goes on as paused at the checkpoint, see exp_pause
+  cur_total_cycle_count_ = checkpoint.cur_total_cycle_count_;
+  pre_total_cycle_count_ = checkpoint.cur_total_cycle_count_;
+  pre_total_data_table_no_ = checkpoint.list_data_table_no_;
+  pre_exp_start_time_ms_ = anx::expdata::ExperimentCheckpoint::TimeOf(
+      checkpoint.pre_exp_start_offset_ms_, now_ms);
+  pre_clip_paused_ms_ = checkpoint.pre_clip_paused_ms_;
+  exp_data_pre_duration_exponential_ =
+      checkpoint.exp_data_pre_duration_exponential_;
+  start_time_pos_has_deal_ = checkpoint.start_time_pos_has_deal_;
+  state_ultrasound_exp_clip_ = checkpoint.clip_state_;
+
+  exp_data_graph_info_.exp_start_time_ms_ =
+      anx::expdata::ExperimentCheckpoint::TimeOf(
+          checkpoint.graph_start_offset_ms_, now_ms);
+  exp_data_graph_info_.exp_time_interval_num_ =
+      checkpoint.graph_time_interval_num_;
+  exp_data_graph_info_.exp_data_table_no_ = checkpoint.graph_data_table_no_;
+  exp_data_graph_info_.exp_sample_interval_ms_ = 2000;
+
+  dedss_ =
+      std::move(anx::device::LoadDeviceExpDataSampleSettingsDefaultResource());
+  exp_data_list_info_.exp_start_time_ms_ =
+      anx::expdata::ExperimentCheckpoint::TimeOf(
+          checkpoint.list_start_offset_ms_, now_ms);
+  exp_data_list_info_.exp_time_interval_num_ =
+      checkpoint.list_time_interval_num_;
+  exp_data_list_info_.exp_pre_sample_timestamp_ms_ =
+      anx::expdata::ExperimentCheckpoint::TimeOf(
+          checkpoint.list_pre_sample_offset_ms_, now_ms);
+  exp_data_list_info_.exp_freq_total_count_ = checkpoint.list_freq_total_count_;
+  exp_data_list_info_.exp_data_table_no_ = checkpoint.list_data_table_no_;
+  exp_data_list_info_.exp_sample_interval_ms_ =
+      dedss_->sampling_interval_ * 100;
+
+  /// the next rows follow the last rows of the tables, not the rows counted
+  /// after the backup.
+  int64_t graph_max_id =
+      anx::db::DatabaseCursor(exp_db_name_, anx::db::helper::kTableExpDataGraph)
+          .MaxId();
+  if (graph_max_id >= 0 &&
+      graph_max_id < exp_data_graph_info_.exp_data_table_no_) {
+    exp_data_graph_info_.exp_data_table_no_ =
+        static_cast<int32_t>(graph_max_id);
+  }
+  int64_t list_max_id =
+      anx::db::DatabaseCursor(exp_db_name_, anx::db::helper::kTableExpDataList)
+          .MaxId();
+  if (list_max_id >= 0 &&
+      list_max_id < exp_data_list_info_.exp_data_table_no_) {
+    exp_data_list_info_.exp_data_table_no_ =
+        static_cast<int32_t>(list_max_id);
+    pre_total_data_table_no_ = exp_data_list_info_.exp_data_table_no_;
+  }
+  LOG_F(LG_INFO) << "restored rows graph:" << graph_max_id << "/"
+                 << checkpoint.graph_data_table_no_ << " list:" << list_max_id
+                 << "/" << checkpoint.list_data_table_no_;
+
+  StartSampling();
+
+  DuiLib::TNotifyUI msg;
+  msg.sType = kClick;
+  msg.pSender = btn_exp_start_;
+  if (work_window_second_page_data_notify_pump_.get() != nullptr) {
+    work_window_second_page_data_notify_pump_->NotifyPump(msg);
+  }
+  if (work_window_second_page_graph_notify_pump_.get() != nullptr) {
+    work_window_second_page_graph_notify_pump_->NotifyPump(msg);
+  }
+  is_exp_state_ = kExpStatePause;
+  msg.pSender = btn_exp_pause_;
+  if (work_window_second_page_data_notify_pump_.get() != nullptr) {
+    work_window_second_page_data_notify_pump_->NotifyPump(msg);
+  }
+  if (work_window_second_page_graph_notify_pump_.get() != nullptr) {
+    work_window_second_page_graph_notify_pump_->NotifyPump(msg);
+  }
+  WriteExpCheckpoint();
+  LOG_F(LG_INFO) << "restored exp run: " << exp_db_name_
+                 << " cur_total_cycle_count_:" << cur_total_cycle_count_;
+  return true;
+}
+
 void WorkWindowSecondPage::CheckDeviceComConnectedStatus() {
   /// exp_start, exp_stop, exp_pause, exp_resume button state
   /// if the device com interface is connected then enable the exp_start
@@ -998,6 +1357,16 @@ void WorkWindowSecondPage::CheckDeviceComConnectedStatus() {
     if (is_exp_state_ < kExpStateStop) {
       is_exp_state_ = kExpStateStop;
     }
+    /// the interrupted run is restored once the device is back
+    if (pending_checkpoint_ != nullptr && is_exp_state_ == kExpStateStop) {
+      std::unique_ptr<anx::expdata::ExperimentCheckpoint> checkpoint =
+          std::move(pending_checkpoint_);
+      if (RestoreExpCheckpoint(*checkpoint)) {
+        anx::ui::DialogCommon::ShowDialog(
+            *pWorkWindow_, "提示", "已恢复中断的试验,请点击继续",
+            anx::ui::DialogCommon::kDialogCommonStyleOk);
+      }
+    }
     UpdateUIButton();
   } else {
     if (is_exp_state_ >= kExpStateStop) {
@@ -1406,20 +1775,41 @@ int32_t WorkWindowSecondPage::exp_start() {
 
   SaveExpClipSettingsFromControl();
 
-  /// @brief reset the database exp_data table.
-  /// @note the table name is exp_data, delete exp_data table and create a
-  /// new one.
-  anx::db::helper::DropDataTable(anx::db::helper::kDefaultDatabasePathname,
-                                 anx::db::helper::kTableExpDataGraph);
-  anx::db::helper::DropDataTable(anx::db::helper::kDefaultDatabasePathname,
-                                 anx::db::helper::kTableExpDataList);
-
-  std::string db_filepathname;
-  anx::db::helper::DefaultDatabasePathname(&db_filepathname);
-  auto db = anx::db::DatabaseFactory::Instance()->CreateOrGetDatabase(
-      db_filepathname);
-  db->Execute(anx::db::helper::sql::kCreateTableExpDataGraphSqlFormat);
-  db->Execute(anx::db::helper::sql::kCreateTableExpDataListSqlFormat);
+  /// @brief create the exp database of this exp run.
+  /// @note one database file per exp run with new exp_data tables, the
+  /// database of the previous run is kept as is.
+  if (!exp_db_name_.empty()) {
+    anx::db::helper::FinishExperimentDataBase(
+        exp_db_name_, anx::common::GetCurrentEpochMillis());
+    exp_db_name_.clear();
+  }
+  ArchiveFinishedExpDataBase();
+  /// @note the name and the catalog times of the database are of the wall
+  /// clock, they are kept across reboots. the database of the same start
+  /// time is kept, e.g. after the clock is set back, the run takes the next
+  /// free start time.
+  exp_db_start_time_ms_ = anx::common::GetCurrentEpochMillis();
+  int32_t create_result = anx::db::helper::CreateExperimentDataBase(
+      anx::db::helper::kExperimentDatabaseFolder, exp_db_start_time_ms_,
+      &exp_db_name_);
+  for (int32_t i = 0; create_result == -5 && i < 1000; i++) {
+    exp_db_start_time_ms_++;
+    create_result = anx::db::helper::CreateExperimentDataBase(
+        anx::db::helper::kExperimentDatabaseFolder, exp_db_start_time_ms_,
+        &exp_db_name_);
+  }
+  if (create_result != 0) {
+    is_exp_state_ = kExpStateUnvalid;
+    LOG_F(LG_WARN) << "CreateExperimentDataBase failed: " << create_result;
+    return -6;
+  }
+  /// @note the exp data is written and paged in memory during the run, the
+  /// file is written by the backups. the run goes on with the file if the
+  /// memory is not available.
+  if (!anx::db::helper::MirrorExperimentDataBase(
+          exp_db_name_, kExpDataBaseBackupIntervalMs)) {
+    LOG_F(LG_WARN) << "MirrorExperimentDataBase failed: " << exp_db_name_;
+  }
 
   /// @brief get the exp data sample settings and set the exp start time
   /// and exp sample interval
@@ -1475,8 +1865,8 @@ int32_t WorkWindowSecondPage::exp_start() {
 
   start_time_pos_has_deal_ = false;
   pre_clip_paused_ms_ = 0;
-  paint_manager_ui_->SetTimer(btn_exp_start_, kTimerIdSampling,
-                              kSamplingInterval);
+  exp_paused_time_ms_ = 0;
+  StartSampling();
 
   state_ultrasound_exp_clip_ = 1;
 
@@ -1491,6 +1881,7 @@ int32_t WorkWindowSecondPage::exp_start() {
   }
 
   is_exp_state_ = kExpStateStart;
+  WriteExpCheckpoint();
   LOG_F(LG_INFO);
   return 0;
 }
@@ -1512,9 +1903,16 @@ void WorkWindowSecondPage::exp_pause() {
 
   pre_total_cycle_count_ = cur_total_cycle_count_;
   pre_total_data_table_no_ = exp_data_list_info_.exp_data_table_no_;
+  exp_paused_time_ms_ = anx::common::GetCurrentTimeMillis();
   LOG_F(LG_INFO) << "cur_total_cycle_count_:" << cur_total_cycle_count_ << " "
                  << "pre_total_cycle_count_:" << pre_total_cycle_count_ << " "
                  << "pre_total_data_table_no_:" << pre_total_data_table_no_;
+  WriteExpCheckpoint();
+  /// @brief the exp data of the run so far is written to the file
+  if (!exp_db_name_.empty() &&
+      !anx::db::helper::BackupExperimentDataBase(exp_db_name_)) {
+    LOG_F(LG_WARN) << "BackupExperimentDataBase failed: " << exp_db_name_;
+  }
   DuiLib::TNotifyUI msg;
   msg.pSender = btn_exp_pause_;
   msg.sType = kClick;
@@ -1550,7 +1948,15 @@ void WorkWindowSecondPage::exp_resume() {
 
   SaveExpClipSettingsFromControl();
 
-  exp_data_list_info_.exp_start_time_ms_ = anx::common::GetCurrentTimeMillis();
+  int64_t now_ms = anx::common::GetCurrentTimeMillis();
+  /// @note the graph start is moved by the pause, the time axis of the
+  /// graph, the sampling start pos and the clip cycle go on from the pause,
+  /// the same as after the restore of the checkpoint.
+  if (exp_paused_time_ms_ > 0 && exp_data_graph_info_.exp_start_time_ms_ > 0) {
+    exp_data_graph_info_.exp_start_time_ms_ += now_ms - exp_paused_time_ms_;
+  }
+  exp_paused_time_ms_ = 0;
+  exp_data_list_info_.exp_start_time_ms_ = now_ms;
   exp_data_list_info_.exp_time_interval_num_ = 0;
   exp_data_list_info_.exp_freq_total_count_ = 0;
   dedss_ =
@@ -1561,6 +1967,11 @@ void WorkWindowSecondPage::exp_resume() {
   pre_clip_paused_ms_ = 0;
   // start the ultrasound
   ultra_device_->StartUltra();
+  if (ultra_poller_ != nullptr) {
+    ultra_poller_->Boost(anx::common::GetCurrentTimeMillis() +
+                         kSamplingBoostMs);
+  }
+  WriteExpCheckpoint();
 
   DuiLib::TNotifyUI msg;
   msg.pSender = btn_exp_resume_;
@@ -1596,6 +2007,26 @@ void WorkWindowSecondPage::exp_stop() {
 
   // stop the timer
   paint_manager_ui_->KillTimer(btn_exp_start_, kTimerIdSampling);
+  pWorkWindow_->StopUltraPolling();
+  pWorkWindow_->device_watchdog_->SetPollInterval(
+      pWorkWindow_->ultra_watchdog_id_, 0);
+
+  /// @note the stop is on the disk at once, e.g. before the system standby
+  WriteExpCheckpoint();
+  if (exp_journal_ != nullptr) {
+    exp_journal_->Sync();
+  }
+
+  /// @note the exp database is not written any more, it stays the current
+  /// exp database for the data pages until the next exp run.
+  if (!exp_db_name_.empty()) {
+    anx::db::helper::FinishExperimentDataBase(
+        exp_db_name_, anx::common::GetCurrentEpochMillis());
+    /// the finished database is kept for the data pages, the archive is
+    /// written beside it in background.
+    anx::expdata::ExperimentArchiver::Instance()->Post(exp_db_name_, false);
+    exp_db_name_.clear();
+  }
   LOG_F(LG_INFO);
 }
 
@@ -1604,8 +2035,6 @@ void WorkWindowSecondPage::exp_stop() {
 bool WorkWindowSecondPage::StaticAircraftDoMoveUp() {
   assert(lss_ != nullptr);
   assert(st_load_event_from_ != kSTLoadEventNone);
-  st_load_achieve_target_keep_duration_ms_ =
-      static_cast<int64_t>(lss_->keep_load_duration_ * 1000);
   // anx::device::stload::STLoadHelper::st_load_loader_.st_api_.set_test_dir(1);
   float speed = lss_->speed_ * 1.0f;
   /// RUN the static load, the direction is up and the speed is 2.0f / 60.0f
@@ -1619,34 +2048,26 @@ bool WorkWindowSecondPage::StaticAircraftDoMoveUp() {
     end_value = 10000.0f * -1.0f;
     speed = 50.0f / 60.0f;
   } else if (st_load_event_from_ == kSTLoadEventFromKeepLoadButton) {
-    if (lss_->ctrl_type_ == CTRL_POSI) {
-      ctrl_type = CTRL_POSI;
-      endtype = END_POSI;
-      end_value = lss_->displacement_ * -1.0f;
-      speed = speed / 60.0f;
-    } else {
-      assert(lss_->ctrl_type_ == CTRL_LOAD);
-      if (st_ctrl_type_of_keep_load_current_ < 0) {
-        st_ctrl_type_of_keep_load_current_ = CTRL_POSI;
-        ctrl_type = CTRL_POSI;
-        endtype = END_LOAD;
-        speed = 2.0f / 60.0f;
-        end_value = lss_->threshold_ * -1.0f;
-      } else {
-        st_ctrl_type_of_keep_load_current_ = CTRL_LOAD;
-        st_ctrl_type_of_keep_load_current_start_time_ =
-            anx::common::GetCurrentTimeMillis();
-      }
-    }
+    /// @note the load control is kept by the keep load controller
+    assert(lss_->ctrl_type_ == CTRL_POSI);
+    ctrl_type = CTRL_POSI;
+    endtype = END_POSI;
+    end_value = lss_->displacement_ * -1.0f;
+    speed = speed / 60.0f;
   }
   LOG_F(LG_INFO) << "carry_200:" << ctrl_type << " " << endtype << " " << speed
                  << " " << end_value;
-  bool bSuccess =
-      anx::device::stload::STLoadHelper::st_load_loader_.st_api_.carry_200(
-          ctrl_type, endtype, speed, end_value, 0, true, DIR_NO, 0, 1, 0)
-          ? true
-          : false;
-  if (!bSuccess) {
+  /// the dll calls of the sampling and the keep load threads are serialized
+  /// with the window by the actuator
+  anx::device::stload::StaticLoadCommand command;
+  command.control = ctrl_type;
+  command.end = endtype;
+  command.speed = speed;
+  command.value = end_value;
+  command.direction = DIR_NO;
+  command.keep_value = 0;
+  command.keep_datum = 1;
+  if (pWorkWindow_->CarryStaticLoad(command) != 0) {
     LOG_F(LG_ERROR) << "carry_200 error";
     return false;
   }
@@ -1657,8 +2078,6 @@ bool WorkWindowSecondPage::StaticAircraftDoMoveUp() {
 bool WorkWindowSecondPage::StaticAircraftDoMoveDown() {
   assert(lss_ != nullptr);
   assert(st_load_event_from_ != kSTLoadEventNone);
-  st_load_achieve_target_keep_duration_ms_ =
-      static_cast<int64_t>(lss_->keep_load_duration_ * 1000);
   // anx::device::stload::STLoadHelper::st_load_loader_.st_api_.set_test_dir(0);
   float speed = lss_->speed_ * 1.0f;
   int32_t ctrl_type = CTRL_LOAD;
@@ -1671,35 +2090,27 @@ bool WorkWindowSecondPage::StaticAircraftDoMoveDown() {
     end_value = 10000.0f * 1.0f;
     speed = 50.0f / 60.0f;
   } else if (st_load_event_from_ == kSTLoadEventFromKeepLoadButton) {
-    if (lss_->ctrl_type_ == CTRL_POSI) {
-      ctrl_type = CTRL_POSI;
-      endtype = END_POSI;
-      end_value = lss_->displacement_ * 1.0f;
-      speed = speed / 60.0f;
-    } else {
-      assert(lss_->ctrl_type_ == CTRL_LOAD);
-      if (st_ctrl_type_of_keep_load_current_ < 0) {
-        st_ctrl_type_of_keep_load_current_ = CTRL_POSI;
-        ctrl_type = CTRL_POSI;
-        endtype = END_LOAD;
-        speed = 2.0f / 60.0f;
-        end_value = lss_->threshold_ * 1.0f;
-      } else {
-        st_ctrl_type_of_keep_load_current_ = CTRL_LOAD;
-        st_ctrl_type_of_keep_load_current_start_time_ =
-            anx::common::GetCurrentTimeMillis();
-      }
-    }
+    /// @note the load control is kept by the keep load controller
+    assert(lss_->ctrl_type_ == CTRL_POSI);
+    ctrl_type = CTRL_POSI;
+    endtype = END_POSI;
+    end_value = lss_->displacement_ * 1.0f;
+    speed = speed / 60.0f;
   }
 
   LOG_F(LG_INFO) << "carry_200:" << ctrl_type << " " << endtype << " " << speed
                  << " " << end_value;
-  bool bSuccess =
-      anx::device::stload::STLoadHelper::st_load_loader_.st_api_.carry_200(
-          ctrl_type, endtype, speed, end_value, 0, true, DIR_NO, 0, 1, 0)
-          ? true
-          : false;
-  if (!bSuccess) {
+  /// the dll calls of the sampling and the keep load threads are serialized
+  /// with the window by the actuator
+  anx::device::stload::StaticLoadCommand command;
+  command.control = ctrl_type;
+  command.end = endtype;
+  command.speed = speed;
+  command.value = end_value;
+  command.direction = DIR_NO;
+  command.keep_value = 0;
+  command.keep_datum = 1;
+  if (pWorkWindow_->CarryStaticLoad(command) != 0) {
     LOG_F(LG_ERROR) << "carry_200 error";
     return false;
   }
@@ -1709,18 +2120,14 @@ bool WorkWindowSecondPage::StaticAircraftDoMoveDown() {
 
 bool WorkWindowSecondPage::StaticAircraftStop() {
   LOG_F(LG_INFO) << "stop the static load";
-  anx::device::stload::STLoadHelper::st_load_loader_.st_api_.stop_run();
+  pWorkWindow_->StopKeepLoad();
+  pWorkWindow_->StopStaticLoadRun();
   st_load_is_running_ = false;
   st_load_event_from_ = kSTLoadEventNone;
-  st_ctrl_type_of_keep_load_current_ = -1;
-  st_ctrl_type_of_keep_load_current_start_time_ = 0;
   return true;
 }
 
-void WorkWindowSecondPage::OnDataReceived(
-    anx::device::DeviceComInterface* device,
-    const uint8_t* data,
-    int32_t size) {
+void WorkWindowSecondPage::StoreExpData() {
   if (is_exp_state_ > kExpStateStop) {
     /////////////////////////////////////////////////////////////////////////
     /// check the exp data received reach the max cycle count
@@ -1777,11 +2184,23 @@ void WorkWindowSecondPage::OnDataReceived(
       return;
     }
     /////////////////////////////////////////////////////////////////////////
-    /// process the exp data
-    double f_cur_freq = cur_freq_ * 1.0f;
+    /// process the exp data, the values and the date of the rows are of
+    /// the latest record of the bus, the rows wait the first record.
+    anx::device::FusedRecord record;
+    anx::device::SampleRow row;
+    if (!pWorkWindow_->sample_bus()->GetLatestRecord(&record) ||
+        !anx::device::SampleRowOf(record, exp_statc_load_mpa_,
+                                  exp_statc_load_n_, &row)) {
+      LOG_F(LG_SENSITIVE) << "exp data: no record of the ultrasonic";
+      return;
+    }
+    double f_cur_freq = row.freq;
     double um = exp_amplitude_;
-    double MPa = std::fabsl(exp_statc_load_mpa_);
-    double date = anx::common::GetCurrrentSystimeAsVarTime();
+    double MPa = row.static_load_mpa;
+    int64_t now_us = static_cast<int64_t>(anx::common::GetCurrentTimeMicros());
+    exp_row_date_ = anx::common::GetCurrrentSystimeAsVarTime() -
+                    static_cast<double>(now_us - row.time_us) /
+                        (86400.0 * 1000 * 1000);
     exp_data_graph_info_.amp_freq_ = f_cur_freq;
     exp_data_graph_info_.amp_um_ = um;
     exp_data_graph_info_.stress_value_ = MPa;
@@ -1820,28 +2239,20 @@ void WorkWindowSecondPage::ProcessDataGraph() {
     // update the data to the database table amp, stress, um
     int64_t cycle_count = exp_data_graph_info_.exp_data_table_no_ *
                           static_cast<int64_t>(exp_data_graph_info_.amp_freq_);
-    double date = anx::common::GetCurrrentSystimeAsVarTime();
+    double date = exp_row_date_;
     // save to database
-    // format cycle_count, KHz, MPa, um to the sql string and insert to the
-    // database
-    std::string sql_str = ("INSERT INTO ");
-    sql_str.append(anx::db::helper::kTableExpDataGraph);
-    sql_str.append((" (cycle, KHz, MPa, μm, state, date) VALUES ("));
-    sql_str.append(std::to_string(cycle_count));
-    sql_str.append(", ");
-    sql_str.append(std::to_string(exp_data_graph_info_.amp_freq_));
-    sql_str.append(", ");
-    sql_str.append(std::to_string(exp_data_graph_info_.stress_value_));
-    sql_str.append(", ");
-    sql_str.append(std::to_string(exp_data_graph_info_.amp_um_));
-    sql_str.append(", ");
-    sql_str.append(std::to_string((is_exp_state_ == kExpStateStart) ? 1 : 0));
-    sql_str.append(", ");
-    sql_str.append(std::to_string(date));
-    sql_str.append(");");
-    anx::db::helper::InsertDataTable(anx::db::helper::kDefaultDatabasePathname,
-                                     anx::db::helper::kTableExpDataGraph,
-                                     sql_str);
+    // bind cycle_count, KHz, MPa, um to the prepared insert statement
+    std::vector<anx::db::DatabaseValue> params;
+    params.push_back(cycle_count);
+    params.push_back(exp_data_graph_info_.amp_freq_);
+    params.push_back(exp_data_graph_info_.stress_value_);
+    params.push_back(exp_data_graph_info_.amp_um_);
+    params.push_back((is_exp_state_ == kExpStateStart) ? 1 : 0);
+    params.push_back(date);
+    anx::db::helper::InsertDataTable(
+        anx::db::helper::CurrentExperimentDataBase(),
+        anx::db::helper::kTableExpDataGraph,
+        anx::db::helper::sql::kInsertTableExpDataGraphSqlPrepared, params);
   }
 }
 
@@ -1892,7 +2303,7 @@ void WorkWindowSecondPage::ProcessDataListModeLinear() {
         ///
         StoreDataListItem(
             pre_total_cycle_count_ + exp_data_list_info_.exp_freq_total_count_,
-            anx::common::GetCurrrentSystimeAsVarTime());
+            exp_row_date_);
       }
       if (need_store_count > 0) {
         exp_data_list_info_.exp_time_interval_num_ = time_interval_num;
@@ -1996,8 +2407,7 @@ void WorkWindowSecondPage::ProcessDataListModeExponential() {
           // 1. save to database
           // format cycle_count, KHz, MPa, um to the sql string and insert to
           // the database
-          StoreDataListItem(cycle_count,
-                            anx::common::GetCurrrentSystimeAsVarTime());
+          StoreDataListItem(cycle_count, exp_row_date_);
         }
         ///////////////////////////////////////////////////////////////////////
       }
@@ -2029,22 +2439,18 @@ void WorkWindowSecondPage::ProcessDataListModeExponential() {
 }
 
 void WorkWindowSecondPage::StoreDataListItem(int64_t cycle_count, double date) {
-  std::string sql_str = ("INSERT INTO ");
-  sql_str.append(anx::db::helper::kTableExpDataList);
-  sql_str.append((" (cycle, KHz, MPa, μm, date) VALUES ("));
-  sql_str.append(std::to_string(cycle_count));
-  sql_str.append(", ");
-  sql_str.append(anx::common::to_string_with_precision(
-      exp_data_list_info_.amp_freq_ * 0.001, 3));
-  sql_str.append(", ");
-  sql_str.append(std::to_string(exp_data_list_info_.stress_value_));
-  sql_str.append(", ");
-  sql_str.append(std::to_string(exp_data_list_info_.amp_um_));
-  sql_str.append(", ");
-  sql_str.append(std::to_string(date));
-  sql_str.append(");");
-  anx::db::helper::InsertDataTable(anx::db::helper::kDefaultDatabasePathname,
-                                   anx::db::helper::kTableExpDataList, sql_str);
+  /// @note the kHz is kept with 3 decimals as shown in the list.
+  std::vector<anx::db::DatabaseValue> params;
+  params.push_back(cycle_count);
+  params.push_back(std::stod(anx::common::to_string_with_precision(
+      exp_data_list_info_.amp_freq_ * 0.001, 3)));
+  params.push_back(exp_data_list_info_.stress_value_);
+  params.push_back(exp_data_list_info_.amp_um_);
+  params.push_back(date);
+  anx::db::helper::InsertDataTable(
+      anx::db::helper::CurrentExperimentDataBase(),
+      anx::db::helper::kTableExpDataList,
+      anx::db::helper::sql::kInsertTableExpDataListSqlPrepared, params);
 }
 }  // namespace ui
 }  // namespace anx
@@ -18,11 +18,14 @@
 #include <memory>
 #include <string>
 
+#include "app/device/adaptive_poller.h"
 #include "app/device/device_com.h"
 #include "app/device/device_exp_load_static_settings.h"
 #include "app/device/device_exp_ultrasound_settings.h"
+#include "app/device/device_watchdog.h"
 #include "app/device/stload/stload_helper.h"
 #include "app/device/ultrasonic/ultra_device.h"
+#include "app/expdata/experiment_journal.h"
 #include "app/ui/ui_virtual_wnd_base.h"
 
 #include "third_party\duilib\source\DuiLib\UIlib.h"
@@ -85,7 +88,34 @@ class WorkWindowSecondPage : public DuiLib::CNotifyPump,
 
  protected:
   void CheckDeviceComConnectedStatus();
+  /// @brief On the health event of the watchdog, the exp is paused when the
+  /// ultra device is lost, resumed when recovered and stopped when the
+  /// reconnect failed.
+  void OnDeviceHealthEvent(const anx::device::DeviceHealthEvent& event);
   void RefreshExpClipTimeControl(bool forced = false);
+  /// @brief Start the sampling timer at the adaptive interval of the ultra
+  /// device
+  void StartSampling();
+  /// @brief Update the poll interval of the station with the frequency
+  /// polled, the sampling timer stays on the storage grid.
+  void UpdateSamplingInterval(int64_t now_ms);
+  /// @brief Get the time of the next clip transition or of the sampling
+  /// start pos, the sampling does not pass it.
+  /// @return the time, 0 if none
+  int64_t NextSamplingDeadlineMs(int64_t now_ms) const;
+  /// @brief Open the exp journal, the checkpoint of the run interrupted by a
+  /// crash or a power loss is kept for the restore on the device connected.
+  void OpenExpJournal();
+  /// @brief Archive the finished exp database of the data pages and remove
+  /// its file, called before it's replaced as the current exp database.
+  void ArchiveFinishedExpDataBase();
+  /// @brief Append the accounting state of the exp run to the exp journal
+  void WriteExpCheckpoint();
+  /// @brief Restore the exp run of the checkpoint as paused, the exp database
+  /// of the run is opened again and the counters go on from the checkpoint.
+  /// @return true if success
+  bool RestoreExpCheckpoint(
+      const anx::expdata::ExperimentCheckpoint& checkpoint);
   void UpdateControlFromSettings();
   void SaveExpClipSettingsFromControl();
   void UpdateExpClipTimeFromControl();
@@ -113,14 +143,19 @@ class WorkWindowSecondPage : public DuiLib::CNotifyPump,
 
  protected:
   // impliment anx::device::DeviceComListener;
+  /// the responses come on the thread of the poll, the rows are stored by
+  /// the sampling timer, see StoreExpData.
   void OnDataReceived(anx::device::DeviceComInterface* device,
                       const uint8_t* data,
-                      int32_t size) override;
+                      int32_t size) override {}
   void OnDataOutgoing(anx::device::DeviceComInterface* device,
                       const uint8_t* data,
                       int32_t size) override {
     // TODO(hhool): do nothing
   }
+  /// @brief Store the rows due on the grid of the sampling timer, the rows
+  /// hold the latest record of the bus until the next poll.
+  void StoreExpData();
   void ProcessDataGraph();
   void ProcessDataListModeLinear();
   void ProcessDataListModeExponential();
@@ -139,6 +174,9 @@ class WorkWindowSecondPage : public DuiLib::CNotifyPump,
   /// @brief ultrasound exp state related
   int32_t is_exp_state_ = kExpStateUnvalid;
   int32_t exp_pause_stop_reason_ = kExpPauseStopReasonNone;
+  /// @brief the time of the first failed read of the ultra device, 0 if the
+  /// last read is ok.
+  int64_t ul_read_failed_ms_ = 0;
   int32_t user_exp_state_ = kExpStateUnvalid;
   anx::device::UltraDevice* ultra_device_;
   //////////////////////////////////////////////////////////////////////////
@@ -155,6 +193,12 @@ class WorkWindowSecondPage : public DuiLib::CNotifyPump,
   int32_t cur_freq_;
   /// @brief ultrasound current power
   int32_t cur_power_;
+  /// @brief the poll interval of the station follows the stability of the
+  /// frequency, the storage stays on the grid of the sampling timer.
+  std::unique_ptr<anx::device::AdaptivePoller> ultra_poller_;
+  int32_t sampling_interval_ms_ = 0;
+  /// @brief the time of the readout the poller is updated with
+  int64_t sampling_readout_ms_ = 0;
   //////////////////////////////////////////////////////////////////////////
   /// @brief ultrasound current total cycle count
   /// if the value is -1, then the exp is not started
@@ -177,21 +221,38 @@ class WorkWindowSecondPage : public DuiLib::CNotifyPump,
   anx::device::DeviceUltrasoundSettings dus_;
   double exp_amplitude_;
   double exp_statc_load_mpa_;
+  /// @brief the target load in N of the static load settings for the
+  /// exp_statc_load_mpa_, the measured load is scaled to MPa by them.
+  double exp_statc_load_n_ = 0;
   double exp_max_stress_MPa_;
+  /// @brief the date of the rows stored by the tick, the time of the record
+  /// the row values are taken from.
+  double exp_row_date_ = 0;
   /// @note state_ultrasound_exp_clip_ for exp clip time control
   /// 0 - stop, 1 - start, 2 - pause, <0 - unvalid
   int32_t state_ultrasound_exp_clip_;
   ExpDataInfo exp_data_graph_info_;
   ExpDataInfo exp_data_list_info_;
+  /// @brief the experiment database of the running exp, one database file
+  /// per exp run. empty if no exp database is opened for writing.
+  std::string exp_db_name_;
+  /// @brief the start time of the exp database of the running exp
+  int64_t exp_db_start_time_ms_ = 0;
+  /// @brief the checkpoint journal of the running exp, written every
+  /// sampling tick.
+  std::unique_ptr<anx::expdata::ExperimentJournal> exp_journal_;
+  /// @brief the checkpoint of the interrupted exp run to restore, nullptr if
+  /// none.
+  std::unique_ptr<anx::expdata::ExperimentCheckpoint> pending_checkpoint_;
   std::unique_ptr<anx::device::DeviceExpDataSampleSettings> dedss_;
   int64_t exp_data_pre_duration_exponential_ = 0;
   int64_t pre_clip_paused_ms_ = 0;
+  /// @brief the time the exp is paused at, 0 if not paused. the graph start
+  /// time is moved by the pause on resume.
+  int64_t exp_paused_time_ms_ = 0;
   bool start_time_pos_has_deal_ = false;
 
   std::unique_ptr<anx::device::DeviceLoadStaticSettings> lss_;
-  /// @note load achieve target keep duration time in ms
-  /// 20s default value
-  int64_t st_load_achieve_target_keep_duration_ms_ = 10 * 1000;
   /// @note Aircraft static load event from who.
   /// value -1 no event from, value 0 is from button (up and down), value 1 is
   /// from button (keep load button)
@@ -205,8 +266,6 @@ class WorkWindowSecondPage : public DuiLib::CNotifyPump,
   /// value -1 is not reach the first time point, value > 0 is reach the first
   /// time point. delay 1000ms for the aircraft stop action.
   int64_t st_posi_reach_first_time_ = 0;
-  int32_t st_ctrl_type_of_keep_load_current_ = -1;
-  int64_t st_ctrl_type_of_keep_load_current_start_time_ = 0;
   DuiLib::CTabLayoutUI* btn_tablayout_;
   DuiLib::CButtonUI* btn_tab_graph_;
   DuiLib::CButtonUI* btn_tab_data_;
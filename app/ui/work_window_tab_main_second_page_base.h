@@ -131,7 +131,7 @@ inline const std::string ExpStateToString(int32_t exp_state) {
 
 /// @brief enum exp_state pause and stop state reason code
 /// 0 - none, 1 - out frequency range, 2 - reach max cycle, 3 - reach range
-/// time end pos, 4 - system standby, 100 - unkown
+/// time end pos, 4 - system standby, 5 - device lost, 100 - unkown
 /// @note exp_pause_stop_reason_ for record the pause reason code
 /// if the exp is paused, then the pause reason code will record the pause
 /// reason code value and update the button state with the pause reason code
@@ -142,6 +142,7 @@ enum {
   kExpPauseStopReasonReachMaxCycle = 2,
   kExpPauseStopReasonReachRangeTimeEndPos = 3,
   kExpPauseStopReasonSystemStandby = 4,
+  kExpPauseStopReasonDeviceLost = 5,
   kExpPauseStopReasonUnkown = 100
 };
 
@@ -158,6 +159,8 @@ inline const std::string ExpPauseStopReasonToString(
       return "reach range time end pos";
     case kExpPauseStopReasonSystemStandby:
       return "system standby";
+    case kExpPauseStopReasonDeviceLost:
+      return "device lost";
     case kExpPauseStopReasonUnkown:
       return "unkown";
     default:
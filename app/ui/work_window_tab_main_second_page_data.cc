@@ -20,6 +20,7 @@
 #include "app/common/num_string_convert.hpp"
 #include "app/common/string_utils.h"
 #include "app/common/time_utils.h"
+#include "app/db/database_cursor.h"
 #include "app/db/database_helper.h"
 #include "app/device/device_com_factory.h"
 #include "app/device/device_com_settings.h"
@@ -27,6 +28,9 @@
 #include "app/device/device_exp_ultrasound_settings.h"
 #include "app/esolution/solution_design.h"
 #include "app/esolution/solution_design_default.h"
+#include "app/expdata/experiment_arrow.h"
+#include "app/expdata/experiment_export.h"
+#include "app/expdata/experiment_record_index.h"
 #include "app/ui/ui_constants.h"
 #include "app/ui/ui_num_string_convert.hpp"
 #include "app/ui/work_window.h"
@@ -108,9 +112,9 @@ class WorkWindowSecondPageData::ListVirtalDataView
     sql_str += " WHERE id=";
     sql_str += std::to_string(nRow + 1);
     std::vector<std::map<std::string, std::string>> result;
-    anx::db::helper::QueryDataBase(anx::db::helper::kDefaultDatabasePathname,
-                                   anx::db::helper::kTableExpDataList, sql_str,
-                                   &result);
+    anx::db::helper::QueryDataBase(
+        anx::db::helper::CurrentExperimentDataBase(),
+        anx::db::helper::kTableExpDataList, sql_str, &result);
     if (result.size() == 0) {
       return;
     }
@@ -172,6 +176,11 @@ WorkWindowSecondPageData::WorkWindowSecondPageData(
 }
 
 WorkWindowSecondPageData::~WorkWindowSecondPageData() {
+  /// the report of the last exp is finished, not canceled.
+  if (docx_report_ != nullptr) {
+    docx_report_->Join();
+    docx_report_.reset();
+  }
   dedss_.reset();
   paint_manager_ui_->RemoveNotifier(this);
 }
@@ -223,7 +232,10 @@ void WorkWindowSecondPageData::OnClick(TNotifyUI& msg) {
 void WorkWindowSecondPageData::OnValueChanged(TNotifyUI& msg) {
   if (msg.sType == DUI_MSGTYPE_VALUECHANGED) {
     if (msg.pSender->GetName() == _T("work_args_area")) {
-      // TODO(hhool): do nothing
+      ENMsgStruct* enmsg = reinterpret_cast<ENMsgStruct*>(msg.wParam);
+      if (enmsg != nullptr && enmsg->type_ == enmsg_type_docx_report) {
+        OnDocxReport(*reinterpret_cast<ENMsgDocxReport*>(enmsg->ptr_));
+      }
     } else {
       // TODO(hhool): do nothing
     }
@@ -564,30 +576,12 @@ void WorkWindowSecondPageData::ClearExpData() {
 }
 
 int32_t WorkWindowSecondPageData::ExportExpResult() {
-  std::string sql_str = "SELECT * FROM ";
-  sql_str += anx::db::helper::kTableExpDataList;
-  sql_str += " ORDER BY date ASC";
-  sql_str += ";";
-  std::vector<std::map<std::string, std::string>> result;
-  anx::db::helper::QueryDataBase(anx::db::helper::kDefaultDatabasePathname,
-                                 anx::db::helper::kTableExpDataList, sql_str,
-                                 &result);
-  if (result.size() == 0) {
+  anx::db::DatabaseCursor cursor(anx::db::helper::CurrentExperimentDataBase(),
+                                 anx::db::helper::kTableExpDataList);
+  if (cursor.MaxId() <= 0) {
     LOG_F(LG_ERROR) << "exp data is empty";
     return -1;
   }
-
-  std::vector<anx::expdata::ExperimentData> exp_datas;
-  for (auto& item : result) {
-    anx::expdata::ExperimentData data;
-    data.id_ = std::stoi(item["id"]);
-    data.cycle_count_ = std::stoi(item["cycle"]);
-    data.KHz_ = std::stod(item["kHz"]);
-    data.MPa_ = std::stod(item["MPa"]);
-    data.um_ = std::stod(item["μm"]);
-    exp_datas.push_back(data);
-  }
-
   if (pWorkWindow_->exp_report_.get() == nullptr) {
     LOG_F(LG_ERROR) << "exp report is nullptr";
     return -2;
@@ -608,21 +602,84 @@ int32_t WorkWindowSecondPageData::ExportExpResult() {
     return -3;
   }
   std::string file_pathname_csv;
-  ret = anx::expdata::SaveExperimentDataToCsvWithDefaultPath(
-      report, exp_datas, &file_pathname_csv);
+  ret = anx::expdata::ExperimentDataCsvDefaultPathname(report,
+                                                       &file_pathname_csv);
+  if (ret != 0) {
+    LOG_F(LG_ERROR) << "get exp data csv path failed";
+    return -4;
+  }
+  /// the rows are streamed from the database to the csv, the docx report
+  /// reads them back from the csv line by line.
+  anx::expdata::ExperimentExportOptions options;
+  options.format = anx::expdata::kExportFormatCsv;
+  anx::expdata::ExperimentExporter exporter(options);
+  ret = exporter.Export(anx::db::helper::CurrentExperimentDataBase(),
+                        anx::db::helper::kTableExpDataList, file_pathname_csv);
   if (ret != 0) {
     LOG_F(LG_ERROR) << "save exp data to csv failed";
     return -4;
   }
-  std::string file_pathname_docx;
-  ret = anx::expdata::SaveReportToDocxWithDefaultPath(report, file_pathname_csv,
-                                                      &file_pathname_docx);
+  /// the columns of the run beside the csv for the analysis in pyarrow
+  std::string file_pathname_arrow =
+      file_pathname_csv.substr(0, file_pathname_csv.size() - 4) +
+      anx::expdata::kExperimentArrowExtension;
+  if (anx::expdata::SaveExperimentDataToArrow(
+          report, anx::db::helper::CurrentExperimentDataBase(),
+          anx::db::helper::kTableExpDataList, file_pathname_arrow) != 0) {
+    LOG_F(LG_WARN) << "save exp data to arrow failed";
+  }
+  /// index the record now, the record dialog lists it on the next open.
+  std::string::size_type name_pos = file_pathname_csv.find_last_of("\\/");
+  anx::expdata::ExperimentRecordIndex::Instance()->Refresh(
+      name_pos == std::string::npos ? file_pathname_csv
+                                    : file_pathname_csv.substr(name_pos + 1));
+  /// the docx report is generated on its own thread, the report of the last
+  /// exp is waited for if it's still running.
+  if (docx_report_ != nullptr) {
+    docx_report_->Join();
+    docx_report_.reset();
+  }
+  docx_report_finished_ = false;
+  ret = anx::expdata::StartReportToDocxWithDefaultPath(
+      report, file_pathname_csv, this, &docx_report_);
   if (ret != 0) {
-    LOG_F(LG_ERROR) << "save report to docx failed";
+    LOG_F(LG_ERROR) << "start report to docx failed:" << ret;
     return -5;
   }
   return 0;
 }
 
+void WorkWindowSecondPageData::OnReportProgress(int32_t percent) {
+  ::PostMessage(pWorkWindow_->GetHWND(), DOCX_REPORT_MSG, 0, percent);
+}
+
+void WorkWindowSecondPageData::OnReportFinished(
+    int32_t result,
+    const std::string& file_pathname) {
+  if (result != 0) {
+    LOG_F(LG_ERROR) << "save report to docx failed:" << result << " "
+                    << file_pathname;
+  } else {
+    LOG_F(LG_INFO) << "save report to docx:" << file_pathname;
+  }
+  docx_report_finished_ = true;
+  ::PostMessage(pWorkWindow_->GetHWND(), DOCX_REPORT_MSG, 1, result);
+}
+
+void WorkWindowSecondPageData::OnDocxReport(const ENMsgDocxReport& report) {
+  if (!report.finished_) {
+    if (report.percent_ % 10 == 0) {
+      LOG_F(LG_INFO) << "docx report progress:" << report.percent_;
+    }
+    return;
+  }
+  /// @note the message of the report joined by the next ExportExpResult is
+  /// late, the report running now is not finished.
+  if (docx_report_ != nullptr && docx_report_finished_) {
+    docx_report_->Join();
+    docx_report_.reset();
+  }
+}
+
 }  // namespace ui
 }  // namespace anx
@@ -15,14 +15,17 @@
 #include "app/ui/work_window_tab_main_second_page_base.h"
 
 #include <time.h>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "app/device/device_com.h"
 #include "app/device/ultrasonic/ultra_device.h"
+#include "app/expdata/docx_report.h"
 #include "app/expdata/experiment_data_base.h"
 #include "app/ui/ui_virtual_wnd_base.h"
+#include "app/ui/work_window_tab_main_page_base.h"
 
 #include "third_party\duilib\source\DuiLib\UIlib.h"
 
@@ -45,7 +48,8 @@ namespace ui {
 class WorkWindowSecondPageData : public DuiLib::CNotifyPump,
                                  public DuiLib::INotifyUI,
                                  public UIVirtualWndBase,
-                                 public anx::device::DeviceComListener {
+                                 public anx::device::DeviceComListener,
+                                 public anx::expdata::DocxReportListener {
  public:
   WorkWindowSecondPageData(WorkWindow* pWorkWindow,
                            DuiLib::CPaintManagerUI* paint_manager_ui,
@@ -91,6 +95,15 @@ class WorkWindowSecondPageData : public DuiLib::CNotifyPump,
     // TODO(hhool): do nothing
   }
 
+ protected:
+  // impliment anx::expdata::DocxReportListener, called on the generator
+  // thread and posted to the work window as DOCX_REPORT_MSG.
+  void OnReportProgress(int32_t percent) override;
+  void OnReportFinished(int32_t result,
+                        const std::string& file_pathname) override;
+  /// @brief On DOCX_REPORT_MSG of the work window
+  void OnDocxReport(const ENMsgDocxReport& report);
+
  protected:
   void OnExpStart();
   void OnExpStop();
@@ -138,6 +151,11 @@ class WorkWindowSecondPageData : public DuiLib::CNotifyPump,
 
   /// @brief reset the sample setting
   DuiLib::CButtonUI* btn_sample_reset_;
+
+  /// @brief the docx report of the last exp, generated on its own thread
+  std::unique_ptr<anx::expdata::DocxReportGenerator> docx_report_;
+  /// @brief docx_report_ finished and not yet joined
+  std::atomic<bool> docx_report_finished_{false};
 };
 }  // namespace ui
 }  // namespace anx
@@ -18,6 +18,7 @@
 #include "app/common/logger.h"
 #include "app/common/string_utils.h"
 #include "app/common/time_utils.h"
+#include "app/db/database_cursor.h"
 #include "app/db/database_helper.h"
 #include "app/device/device_com_factory.h"
 #include "app/device/device_com_settings.h"
@@ -57,19 +58,12 @@ namespace {
 std::vector<std::map<std::string, std::string>> QueryExpDataItemById(
     int32_t id,
     int32_t item_count) {
-  std::string sql_str = " SELECT* FROM ";
-  sql_str += anx::db::helper::kTableExpDataGraph;
-  sql_str += " WHERE ";
-  sql_str += " id >= ";
-  sql_str += std::to_string(id);
-  sql_str += " ORDER BY date ASC";
-  sql_str += " LIMIT ";
-  sql_str += std::to_string(item_count);
-  sql_str += ";";
+  /// @note keyset page from the id, the cost doesn't depend on the position
+  /// of the page in the table.
   std::vector<std::map<std::string, std::string>> result;
-  anx::db::helper::QueryDataBase(anx::db::helper::kDefaultDatabasePathname,
-                                 anx::db::helper::kTableExpDataGraph, sql_str,
-                                 &result);
+  anx::db::DatabaseCursor cursor(anx::db::helper::CurrentExperimentDataBase(),
+                                 anx::db::helper::kTableExpDataGraph);
+  cursor.NextPage(id - 1, item_count, &result);
   return result;
 }
 
@@ -188,9 +182,7 @@ void WorkWindowSecondPageGraph::OnValueChanged(TNotifyUI& msg) {
         return;
       }
       if (enmsg->type_ == enmsg_type_stload_value_cur) {
-        anx::device::stload::STResult* st_result =
-            reinterpret_cast<anx::device::stload::STResult*>(enmsg->ptr_);
-
+        // TODO(hhool): do nothing
       } else if (enmsg->type_ == enmsg_type_exp_stress_amp) {
         anx::esolution::SolutionDesign* design =
             reinterpret_cast<anx::esolution::SolutionDesign*>(enmsg->ptr_);
@@ -268,10 +260,13 @@ bool WorkWindowSecondPageGraph::OnChkGraphAlwaysShowNewChange(void* param) {
           page_graph_amplitude_ctrl_->GetCurrentDataSampleCountOfOneGraphPlot();
       int32_t data_sample_count =
           minutes_to_data_sample_count(graphctrl_sample_total_minutes);
+      /// @note step to the last page aligned with the current start no.
       int32_t id = exp_data_graph_info_->exp_data_view_current_start_no_;
-      while (id + data_sample_count <
-             exp_data_graph_info_->exp_data_table_no_) {
-        id += data_sample_count;
+      int32_t remain_count =
+          exp_data_graph_info_->exp_data_table_no_ - id - data_sample_count;
+      if (remain_count > 0 && data_sample_count > 0) {
+        id += ((remain_count + data_sample_count - 1) / data_sample_count) *
+              data_sample_count;
       }
       std::vector<std::map<std::string, std::string>> result =
           QueryExpDataItemById(
@@ -38,6 +38,7 @@
 
 DUI_BEGIN_MESSAGE_MAP(anx::ui::WorkWindowThirdPage, DuiLib::CNotifyPump)
 DUI_ON_MSGTYPE(DUI_MSGTYPE_CLICK, OnClick)
+DUI_ON_MSGTYPE(DUI_MSGTYPE_SELECTCHANGED, OnSelectChanged)
 DUI_ON_MSGTYPE(DUI_MSGTYPE_TIMER, OnTimer)
 DUI_ON_MSGTYPE(DUI_MSGTYPE_VALUECHANGED, OnValueChanged)
 DUI_END_MESSAGE_MAP()
@@ -257,9 +258,22 @@ void WorkWindowThirdPage::OnClick(TNotifyUI& msg) {
   }
 }
 
+void WorkWindowThirdPage::OnSelectChanged(TNotifyUI& msg) {
+  if (msg.pSender == check_box_display_send_ ||
+      msg.pSender == check_box_display_stop_recv_notify_) {
+    UpdateDisplayOptions();
+  }
+}
+
+void WorkWindowThirdPage::UpdateDisplayOptions() {
+  display_send_ = check_box_display_send_->IsSelected();
+  stop_recv_notify_ = check_box_display_stop_recv_notify_->IsSelected();
+}
+
 void WorkWindowThirdPage::OnTimer(TNotifyUI& msg) {
   if (msg.wParam == kTimerID) {
     UpdateControlFromSettings();
+    UpdateListItemCount();
   } else {
     // TODO(hhool): do nothing
   }
@@ -273,16 +287,18 @@ void WorkWindowThirdPage::OnValueChanged(TNotifyUI& msg) {
         return;
       }
       if (enmsg->type_ == enmsg_type_stload_value_cur) {
-        anx::device::stload::STResult* st_result =
-            reinterpret_cast<anx::device::stload::STResult*>(enmsg->ptr_);
+        anx::device::stload::StaticLoadSample sample;
+        if (!pWorkWindow_->GetStaticLoadSample(&sample)) {
+          return;
+        }
         // update the label_displacement_ with random value
-        double pos = st_result->pos_;
+        double pos = sample.position;
         // format the number keep 1 decimal
         std::string num_pos_str = anx::common::to_string_with_precision(pos, 1);
         label_displacement_->SetText(
             anx::common::String2WString(num_pos_str).c_str());
         // update the label_strength_ with random value
-        double load = st_result->load_;
+        double load = sample.load;
         std::string num_load_str =
             anx::common::to_string_with_precision(load, 1);
         label_strength_->SetText(
@@ -333,6 +349,7 @@ void WorkWindowThirdPage::Bind() {
   check_box_display_stop_recv_notify_ =
       static_cast<CCheckBoxUI*>(paint_manager_ui_->FindControl(
           _T("tab_page_three_right_stop_recv_output")));
+  UpdateDisplayOptions();
 
   list_send_ = static_cast<CListUI*>(
       paint_manager_ui_->FindControl(_T("tab_page_three_list_send")));
@@ -394,12 +411,30 @@ void WorkWindowThirdPage::UpdateControlFromSettings() {
   set_value_to_edit(edit_retention_, lss->retention_);
 }
 
+void WorkWindowThirdPage::UpdateListItemCount() {
+  uint32_t send_table_no = send_table_no_;
+  if (send_table_shown_ != send_table_no) {
+    send_table_shown_ = send_table_no;
+    list_send_->SetVirtualItemCount(send_table_no);
+  }
+  uint32_t recv_table_no = recv_table_no_;
+  if (recv_table_shown_ != recv_table_no) {
+    recv_table_shown_ = recv_table_no;
+    list_recv_->SetVirtualItemCount(recv_table_no);
+  }
+  uint32_t recv_notify_table_no = recv_notify_table_no_;
+  if (recv_notify_table_shown_ != recv_notify_table_no) {
+    recv_notify_table_shown_ = recv_notify_table_no;
+    list_recv_notify_->SetVirtualItemCount(recv_notify_table_no);
+  }
+}
+
 void WorkWindowThirdPage::OnDataReceived(
     anx::device::DeviceComInterface* device,
     const uint8_t* data,
     int32_t size) {
   // TODO(hhool): review the implementation
-  if (!check_box_display_stop_recv_notify_->IsSelected()) {
+  if (!stop_recv_notify_) {
     std::string hex_str;
     hex_str = anx::common::ByteArrayToHexString(data, size);
     recv_notify_table_no_++;
@@ -416,10 +451,8 @@ void WorkWindowThirdPage::OnDataReceived(
     anx::db::helper::InsertDataTable(anx::db::helper::kDefaultDatabasePathname,
                                      anx::db::helper::kTableNotification,
                                      sql_str);
-
-    list_recv_notify_->SetVirtualItemCount(recv_notify_table_no_);
   }
-  if (check_box_display_send_->IsSelected()) {
+  if (display_send_) {
     std::string hex_str;
     hex_str = anx::common::ByteArrayToHexString(data, size);
     recv_table_no_++;
@@ -437,8 +470,6 @@ void WorkWindowThirdPage::OnDataReceived(
     anx::db::helper::InsertDataTable(anx::db::helper::kDefaultDatabasePathname,
                                      anx::db::helper::kTableSendNotify,
                                      sql_str);
-
-    list_recv_->SetVirtualItemCount(recv_table_no_);
   }
 }
 
@@ -446,7 +477,7 @@ void WorkWindowThirdPage::OnDataOutgoing(
     anx::device::DeviceComInterface* device,
     const uint8_t* data,
     int32_t size) {
-  if (check_box_display_send_->IsSelected()) {
+  if (display_send_) {
     std::string hex_str;
     hex_str = anx::common::ByteArrayToHexString(data, size);
     send_table_no_++;
@@ -463,7 +494,6 @@ void WorkWindowThirdPage::OnDataOutgoing(
     sql_str += ")";
     anx::db::helper::InsertDataTable(anx::db::helper::kDefaultDatabasePathname,
                                      anx::db::helper::kTableSendData, sql_str);
-    list_send_->SetVirtualItemCount(send_table_no_);
   }
 }
 
@@ -12,6 +12,7 @@
 #ifndef APP_UI_WORK_WINDOW_TAB_MAIN_THIRD_PAGE_H_
 #define APP_UI_WORK_WINDOW_TAB_MAIN_THIRD_PAGE_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -51,9 +52,10 @@ class WorkWindowThirdPage : public DuiLib::CNotifyPump,
 
  public:
   DUI_DECLARE_MESSAGE_MAP()
-  void OnClick(TNotifyUI& msg);         // NOLINT
-  void OnTimer(TNotifyUI& msg);         // NOLINT
-  void OnValueChanged(TNotifyUI& msg);  // NOLINT
+  void OnClick(TNotifyUI& msg);          // NOLINT
+  void OnSelectChanged(TNotifyUI& msg);  // NOLINT
+  void OnTimer(TNotifyUI& msg);          // NOLINT
+  void OnValueChanged(TNotifyUI& msg);   // NOLINT
 
  public:
   // implement the base class UIVirtualWndBase virtual function
@@ -62,9 +64,19 @@ class WorkWindowThirdPage : public DuiLib::CNotifyPump,
 
  protected:
   void UpdateControlFromSettings();
+  /// @brief Update the lists with the rows inserted by the listener
+  void UpdateListItemCount();
+  /// @brief Cache the check boxes for the listener thread, the listener
+  /// doesn't touch the controls.
+  void UpdateDisplayOptions();
 
  protected:
   // impliment anx::device::DeviceComListener;
+  /// the rows are inserted to the database on the listener thread, the
+  /// device io never waits for the database.
+  anx::device::DeviceComDelivery Delivery() const override {
+    return anx::device::kDeviceComDeliveryAsync;
+  }
   void OnDataReceived(anx::device::DeviceComInterface* device,
                       const uint8_t* data,
                       int32_t size) override;
@@ -76,9 +88,13 @@ class WorkWindowThirdPage : public DuiLib::CNotifyPump,
   WorkWindow* pWorkWindow_;
   DuiLib::CPaintManagerUI* paint_manager_ui_;
   anx::device::UltraDevice* ultra_device_;
-  uint32_t send_table_no_ = 0;
-  uint32_t recv_table_no_ = 0;
-  uint32_t recv_notify_table_no_ = 0;
+  std::atomic<uint32_t> send_table_no_{0};
+  std::atomic<uint32_t> recv_table_no_{0};
+  std::atomic<uint32_t> recv_notify_table_no_{0};
+  /// @brief the counts set to the lists on the ui thread
+  uint32_t send_table_shown_ = 0;
+  uint32_t recv_table_shown_ = 0;
+  uint32_t recv_notify_table_shown_ = 0;
 
   COptionUI* opt_direct_up_;
   COptionUI* opt_direct_down_;
@@ -90,6 +106,9 @@ class WorkWindowThirdPage : public DuiLib::CNotifyPump,
   CLabelUI* label_strength_;
   CCheckBoxUI* check_box_display_send_;
   CCheckBoxUI* check_box_display_stop_recv_notify_;
+  /// @brief the check box states read by the listener thread
+  std::atomic<bool> display_send_{false};
+  std::atomic<bool> stop_recv_notify_{false};
 
   CListUI* list_send_;
   CListUI* list_recv_;